@@ -2,6 +2,14 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h> // memcpy
+#include <algorithm> // stable_sort
+#include <atomic>
+#include <chrono> // brotli_dict
+#include <functional>
+#include <map> // nvcomp_lz4
+#include <mutex> // --alloc=arena
+#include <thread>
+#include <vector>
 
 #ifndef MAX
     #define MAX(a,b) ((a)>(b))?(a):(b)
@@ -17,18 +25,391 @@ int64_t lzbench_memcpy(char *inbuf, size_t insize, char *outbuf, size_t outsize,
     return insize;
 }
 
+// stored data of memcpy and of codecs that always fail
+size_t lzbench_copy_bound(size_t insize)
+{
+    return insize;
+}
+
 int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t , size_t, char* )
 {
     return 0;
 }
 
 
+/*
+ * Ceilings of memcpy: other copy idioms over the whole buffer, and copies in pieces of # bytes (the level) like the
+ * match and literal copies of LZ decoders. The AVX variants are skipped on CPUs without them, see codec_isas.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#include <immintrin.h>
+
+int64_t lzbench_memcpy_movsb(char *inbuf, size_t insize, char *outbuf, size_t, size_t, size_t, char*)
+{
+    void *dst = outbuf;
+    const void *src = inbuf;
+    size_t n = insize;
+    __asm__ __volatile__("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+    return insize;
+}
+
+// 32 or 64-byte vectors, nt = streaming stores to an aligned destination that bypass the caches
+template<bool nt> static __attribute__((target("avx2"))) int64_t copy_avx2(char *inbuf, size_t insize, char *outbuf)
+{
+    size_t pos = nt ? MIN(insize, (size_t)(-(uintptr_t)outbuf & 31)) : 0;
+    memcpy(outbuf, inbuf, pos);
+    for ( ; pos + 32 <= insize; pos += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(inbuf + pos));
+        if (nt) _mm256_stream_si256((__m256i*)(outbuf + pos), v);
+        else _mm256_storeu_si256((__m256i*)(outbuf + pos), v);
+    }
+    if (nt) _mm_sfence();
+    memcpy(outbuf + pos, inbuf + pos, insize - pos);
+    return insize;
+}
+
+template<bool nt> static __attribute__((target("avx512f"))) int64_t copy_avx512(char *inbuf, size_t insize, char *outbuf)
+{
+    size_t pos = nt ? MIN(insize, (size_t)(-(uintptr_t)outbuf & 63)) : 0;
+    memcpy(outbuf, inbuf, pos);
+    for ( ; pos + 64 <= insize; pos += 64)
+    {
+        __m512i v = _mm512_loadu_si512(inbuf + pos);
+        if (nt) _mm512_stream_si512((__m512i*)(outbuf + pos), v);
+        else _mm512_storeu_si512(outbuf + pos, v);
+    }
+    if (nt) _mm_sfence();
+    memcpy(outbuf + pos, inbuf + pos, insize - pos);
+    return insize;
+}
+
+int64_t lzbench_memcpy_avx2(char *inbuf, size_t insize, char *outbuf, size_t, size_t, size_t, char*) { return copy_avx2<false>(inbuf, insize, outbuf); }
+int64_t lzbench_memcpy_avx2nt(char *inbuf, size_t insize, char *outbuf, size_t, size_t, size_t, char*) { return copy_avx2<true>(inbuf, insize, outbuf); }
+int64_t lzbench_memcpy_avx512(char *inbuf, size_t insize, char *outbuf, size_t, size_t, size_t, char*) { return copy_avx512<false>(inbuf, insize, outbuf); }
+int64_t lzbench_memcpy_avx512nt(char *inbuf, size_t insize, char *outbuf, size_t, size_t, size_t, char*) { return copy_avx512<true>(inbuf, insize, outbuf); }
+#endif
+
+// the compressor keeps the level and memcpy_short has it as the size of pieces, 8, 16, 32 and 64 are inlined
+template<size_t N> static int64_t copy_pieces(char *inbuf, size_t insize, char *outbuf, size_t piece)
+{
+    size_t pos = 0, n = N ? N : piece;
+    for ( ; pos + n <= insize; pos += n)
+    {
+        memcpy(outbuf + pos, inbuf + pos, N ? N : piece);
+#ifdef __GNUC__
+        __asm__ __volatile__("" : : : "memory"); // the loop is not turned into a single memcpy
+#endif
+    }
+    memcpy(outbuf + pos, inbuf + pos, insize - pos);
+    return insize;
+}
+
+int64_t lzbench_memcpy_short(char *inbuf, size_t insize, char *outbuf, size_t, size_t level, size_t, char*)
+{
+    switch (level)
+    {
+        case 8: return copy_pieces<8>(inbuf, insize, outbuf, 8);
+        case 16: return copy_pieces<16>(inbuf, insize, outbuf, 16);
+        case 32: return copy_pieces<32>(inbuf, insize, outbuf, 32);
+        case 64: return copy_pieces<64>(inbuf, insize, outbuf, 64);
+        default: return copy_pieces<0>(inbuf, insize, outbuf, level ? level : insize);
+    }
+}
+
+// level = size of pieces (0 = the whole buffer at once) of the byte copy of the decoder of blosclz
+#ifndef BENCH_REMOVE_BLOSCLZ
+extern "C"
+{
+	#include "blosclz/fastcopy.h"
+}
+
+int64_t lzbench_memcpy_fastcopy(char *inbuf, size_t insize, char *outbuf, size_t, size_t level, size_t, char*)
+{
+    size_t piece = level ? level : (1U << 30), pos;
+    for (pos = 0; pos < insize; pos += piece)
+        fastcopy((unsigned char*)outbuf + pos, (const unsigned char*)inbuf + pos, (unsigned)MIN(piece, insize - pos));
+    return insize;
+}
+#endif
+
+
+/*
+ * counting allocator for codecs that accept custom allocation functions, the size and the arena of the block
+ * (NULL = malloc) are stored in front of every block
+ */
+#define LZBENCH_MEM_HEADER 16 // keeps the alignment of malloc
+#define LZBENCH_ARENA_MIN (1 << 20)
+
+static std::atomic<int64_t> mem_current(0), mem_peak(0);
+static std::atomic<uint64_t> mem_allocs(0);
+
+/*
+ * --alloc=arena: blocks are cut from an arena of the thread instead of malloc and a free only counts. The arena is
+ * rewound when all of its blocks are freed, between calls of codecs that set up their state in every call, and chunks
+ * added when it overflowed are merged into one. Arenas of finished threads are given to new threads.
+ */
+struct lzbench_arena_t
+{
+    std::vector<char*> chunks; // blocks are cut from the last one
+    size_t size, top, total; // of the last chunk and of all chunks
+    std::atomic<int64_t> live; // blocks not freed, also by other threads
+};
+
+struct lzbench_arena_holder_t
+{
+    lzbench_arena_t* arena = NULL;
+    ~lzbench_arena_holder_t();
+};
+
+int lzbench_mem_arena = 0;
+static std::mutex arena_mutex;
+static std::vector<lzbench_arena_t*> arena_spare;
+static thread_local lzbench_arena_holder_t thread_arena;
+
+lzbench_arena_holder_t::~lzbench_arena_holder_t()
+{
+    if (!arena) return;
+    std::lock_guard<std::mutex> lock(arena_mutex);
+    arena_spare.push_back(arena);
+}
+
+static char* lzbench_arena_alloc(size_t size)
+{
+    lzbench_arena_t* arena = thread_arena.arena;
+    if (!arena)
+    {
+        std::lock_guard<std::mutex> lock(arena_mutex);
+        if (arena_spare.empty())
+        {
+            arena = new lzbench_arena_t;
+            arena->size = arena->top = arena->total = 0;
+            arena->live = 0;
+        }
+        else
+            arena = arena_spare.back(), arena_spare.pop_back();
+        thread_arena.arena = arena;
+    }
+
+    if (arena->live.load() == 0)
+    {
+        if (arena->chunks.size() > 1)
+        {
+            for (size_t i = 0; i < arena->chunks.size(); i++) free(arena->chunks[i]);
+            arena->chunks.clear();
+            arena->size = 0;
+            char* chunk = (char*) malloc(arena->total);
+            if (chunk) arena->chunks.push_back(chunk), arena->size = arena->total;
+            arena->total = arena->size;
+        }
+        arena->top = 0;
+    }
+
+    size = (size + LZBENCH_MEM_HEADER - 1) & ~(size_t)(LZBENCH_MEM_HEADER - 1);
+    if (arena->chunks.empty() || arena->top + size > arena->size)
+    {
+        size_t grow = MAX(MAX(arena->size * 2, size), (size_t)LZBENCH_ARENA_MIN);
+        char* chunk = (char*) malloc(grow);
+        if (!chunk) return NULL;
+        arena->chunks.push_back(chunk);
+        arena->size = grow;
+        arena->top = 0;
+        arena->total += grow;
+    }
+    char* ptr = arena->chunks.back() + arena->top;
+    arena->top += size;
+    arena->live++;
+    *(lzbench_arena_t**)(ptr + sizeof(size_t)) = arena;
+    return ptr;
+}
+
+void* lzbench_mem_alloc(size_t size)
+{
+    char* ptr = lzbench_mem_arena ? lzbench_arena_alloc(size + LZBENCH_MEM_HEADER) : (char*) malloc(size + LZBENCH_MEM_HEADER);
+    if (!ptr) return NULL;
+    *(size_t*)ptr = size;
+    if (!lzbench_mem_arena) *(lzbench_arena_t**)(ptr + sizeof(size_t)) = NULL;
+    int64_t current = mem_current.fetch_add(size) + size;
+    int64_t peak = mem_peak.load();
+    while (current > peak && !mem_peak.compare_exchange_weak(peak, current)) {}
+    mem_allocs++;
+    return ptr + LZBENCH_MEM_HEADER;
+}
+
+void lzbench_mem_free(void* ptr)
+{
+    if (!ptr) return;
+    char* base = (char*)ptr - LZBENCH_MEM_HEADER;
+    lzbench_arena_t* arena = *(lzbench_arena_t**)(base + sizeof(size_t));
+    mem_current -= *(size_t*)base;
+    if (arena) arena->live--;
+    else free(base);
+}
+
+size_t lzbench_mem_size(void* ptr)
+{
+    return ptr ? *(size_t*)((char*)ptr - LZBENCH_MEM_HEADER) : 0;
+}
+
+void lzbench_mem_stats(int64_t* current, int64_t* peak, uint64_t* allocs)
+{
+    if (current) *current = mem_current.load();
+    if (peak) *peak = mem_peak.load();
+    if (allocs) *allocs = mem_allocs.load();
+}
+
+void lzbench_mem_reset_peak()
+{
+    mem_peak = mem_current.load();
+}
+
+
+/* 0 = init functions of codecs with reusable contexts return NULL and the contexts are set up in every call */
+int lzbench_context_reuse = 1;
+
+/* dictionary of --dict given to init of codecs with dictionaries and the reference of --delta for delta codecs, NULL = none */
+const char* lzbench_dict = NULL;
+size_t lzbench_dict_size = 0;
+
+/* codec options of -e for the current codec and level, set by lzbench_test_with_params() */
+thread_local codec_options_t lzbench_options = { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 };
+
+void lzbench_reset_options(codec_options_t* options)
+{
+    int* fields = (int*)options;
+    for (size_t i = 0; i < sizeof(codec_options_t) / sizeof(int); i++)
+        fields[i] = -1;
+}
+
+/*
+ * Blocks of codecs without a reset of their state (brotli, bzip2) kept between calls, a freed block is
+ * given to the next allocation of the same size. Blocks are allocated with the counting allocator.
+ */
+#define LZBENCH_POOL_BLOCKS 64
+
+struct lzbench_pool_t
+{
+    void* ptr[LZBENCH_POOL_BLOCKS];
+    size_t size[LZBENCH_POOL_BLOCKS];
+    bool used[LZBENCH_POOL_BLOCKS];
+};
+
+lzbench_pool_t* lzbench_pool_create()
+{
+    return (lzbench_pool_t*)calloc(1, sizeof(lzbench_pool_t));
+}
+
+void* lzbench_pool_alloc(lzbench_pool_t* pool, size_t size)
+{
+    int slot = -1;
+    for (int i=0; i<LZBENCH_POOL_BLOCKS; i++)
+    {
+        if (pool->ptr[i] && !pool->used[i] && pool->size[i] == size) { pool->used[i] = true; return pool->ptr[i]; }
+        if (slot < 0 && !pool->used[i]) slot = i; // empty or unused of another size
+    }
+    void* ptr = lzbench_mem_alloc(size);
+    if (!ptr || slot < 0) return ptr; // not kept
+    lzbench_mem_free(pool->ptr[slot]);
+    pool->ptr[slot] = ptr;
+    pool->size[slot] = size;
+    pool->used[slot] = true;
+    return ptr;
+}
+
+void lzbench_pool_free(lzbench_pool_t* pool, void* ptr)
+{
+    for (int i=0; i<LZBENCH_POOL_BLOCKS; i++)
+        if (pool->ptr[i] == ptr && ptr) { pool->used[i] = false; return; }
+    lzbench_mem_free(ptr);
+}
+
+void lzbench_pool_destroy(lzbench_pool_t* pool)
+{
+    if (!pool) return;
+    for (int i=0; i<LZBENCH_POOL_BLOCKS; i++)
+        lzbench_mem_free(pool->ptr[i]);
+    free(pool);
+}
+
+
+// runs block(i, thread) for all blocks on # threads of a multi-threaded codec, the calling thread is thread 0
+static void lzbench_run_blocks(int threads, uint32_t blocks, const std::function<void(uint32_t, int)>& block)
+{
+    std::atomic<uint32_t> next(0);
+    std::vector<std::thread> workers;
+    auto worker = [&](int t) {
+        for (uint32_t i; (i = next++) < blocks; ) block(i, t);
+    };
+
+    for (int t = 1; t < threads && t < (int)blocks; t++)
+        workers.push_back(std::thread(worker, t));
+    worker(0);
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+
+/*
+ * entropy-stage codecs (huff0_1x, huff0_4x, fse and lzfse_fse) code blocks of ENTROPY_BLOCK bytes, each with a 32-bit
+ * header of the size of its payload in the low 24 bits and its type on top, the size of a decoded block is implied.
+ * An encoder returns 0 for a block that is stored and 1 for a run of out[0], like HUF_compress().
+ */
+#define ENTROPY_BLOCK (128 << 10)
+enum { ENTROPY_CODED = 0, ENTROPY_RAW, ENTROPY_RLE };
+typedef size_t (*entropy_encode_t)(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t param, char* workmem);
+typedef bool (*entropy_decode_t)(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t param, char* workmem);
+
+static int64_t entropy_blocks_compress(entropy_encode_t encode, char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t param, char* workmem)
+{
+    uint8_t* out = (uint8_t*)outbuf;
+    size_t outpos = 0;
+    if (!workmem) return 0;
+    for (size_t pos = 0; pos < insize; pos += ENTROPY_BLOCK)
+    {
+        size_t size = MIN(insize - pos, (size_t)ENTROPY_BLOCK);
+        if (outpos + 4 + size > outsize) return 0;
+        size_t len = encode((uint8_t*)inbuf + pos, size, out + outpos + 4, outsize - outpos - 4, param, workmem);
+        uint32_t type = len == 1 ? ENTROPY_RLE : len == 0 || len >= size ? ENTROPY_RAW : ENTROPY_CODED;
+        if (type == ENTROPY_RAW) memcpy(out + outpos + 4, inbuf + pos, len = size);
+        out[outpos] = (uint8_t)len, out[outpos + 1] = (uint8_t)(len >> 8), out[outpos + 2] = (uint8_t)(len >> 16), out[outpos + 3] = (uint8_t)type;
+        outpos += 4 + len;
+    }
+    return outpos;
+}
+
+static int64_t entropy_blocks_decompress(entropy_decode_t decode, char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t param, char* workmem)
+{
+    const uint8_t* in = (const uint8_t*)inbuf;
+    size_t inpos = 0;
+    if (!workmem) return 0;
+    for (size_t pos = 0; pos < outsize; pos += ENTROPY_BLOCK)
+    {
+        size_t size = MIN(outsize - pos, (size_t)ENTROPY_BLOCK);
+        if (inpos + 4 > insize) return 0;
+        size_t len = in[inpos] | (in[inpos + 1] << 8) | (in[inpos + 2] << 16);
+        uint8_t type = in[inpos + 3];
+        inpos += 4;
+        if (inpos + len > insize) return 0;
+        if (type == ENTROPY_RAW && len == size) memcpy(outbuf + pos, in + inpos, size);
+        else if (type == ENTROPY_RLE && len == 1) memset(outbuf + pos, in[inpos], size);
+        else if (type != ENTROPY_CODED || !decode(in + inpos, len, (uint8_t*)outbuf + pos, size, param, workmem)) return 0;
+        inpos += len;
+    }
+    return outsize;
+}
+
+
 #ifndef BENCH_REMOVE_BLOSCLZ
-#include "blosclz/blosclz.h"
+extern "C"
+{
+	#include "blosclz/blosclz.h"
+}
+
+#include "filters.h"
 
 int64_t lzbench_blosclz_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
 {
-    return blosclz_compress(level, inbuf, insize, outbuf, outsize);
+    return blosclz_compress(level, inbuf, insize, outbuf, outsize, NULL);
 }
 
 int64_t lzbench_blosclz_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t , size_t, char*)
@@ -36,6 +417,92 @@ int64_t lzbench_blosclz_decompress(char *inbuf, size_t insize, char *outbuf, siz
     return blosclz_decompress(inbuf, insize, outbuf, outsize);
 }
 
+// blosclzmt: threads, bytes of an element, 0 = no shuffle, 1 = byte shuffle, 2 = bit shuffle, block size in bytes (0 = by level)
+int lzbench_blosclzmt_threads = 1;
+int lzbench_blosclzmt_typesize = 4;
+int lzbench_blosclzmt_shuffle = 1;
+size_t lzbench_blosclzmt_block_size = 0;
+
+/*
+ * The scheme of a Blosc chunk: blocks are shuffled by the element size and compressed with blosclz independently
+ * by the threads. The output is the element size, the shuffle and the block size (32-bit) and the compressed size
+ * of every block (32-bit, 0 = stored unshuffled) followed by the blocks.
+ */
+int64_t lzbench_blosclzmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+    size_t block_size = lzbench_blosclzmt_block_size ? lzbench_blosclzmt_block_size : (level <= 3) ? 32 * 1024 : (level <= 6) ? 64 * 1024 : 256 * 1024;
+    uint32_t blocks = (uint32_t)((insize + block_size - 1) / block_size), header = 4 * (3 + blocks);
+    char* tmp = (char*)malloc((size_t)blocks * 2 * block_size);
+    std::vector<int64_t> sizes(blocks, 0);
+    lzbench_filter_t filter = { lzbench_blosclzmt_shuffle == 2 ? FILTER_BITSHUFFLE : FILTER_SHUFFLE, lzbench_blosclzmt_typesize };
+
+    if (!tmp || outsize < header) { free(tmp); return 0; }
+    lzbench_run_blocks(lzbench_blosclzmt_threads, blocks, [&](uint32_t i, int) {
+        size_t size = insize - (size_t)i * block_size < block_size ? insize - (size_t)i * block_size : block_size;
+        char *src = inbuf + (size_t)i * block_size, *out = tmp + (size_t)i * 2 * block_size;
+        if (lzbench_blosclzmt_shuffle) {
+            lzbench_filter_forward(filter, (const uint8_t*)src, (uint8_t*)out + block_size, size);
+            src = out + block_size;
+        }
+        sizes[i] = (size < 16) ? 0 : blosclz_compress(level, src, (int)size, out, (int)size - 1, NULL);
+    });
+
+    uint32_t value = (uint32_t)block_size;
+    size_t pos = header;
+    outbuf[0] = (char)lzbench_blosclzmt_typesize;
+    outbuf[1] = (char)lzbench_blosclzmt_shuffle;
+    outbuf[2] = outbuf[3] = 0;
+    memcpy(outbuf + 4, &value, 4);
+    for (uint32_t i = 0; i < blocks && pos != 0; i++)
+    {
+        size_t size = insize - (size_t)i * block_size < block_size ? insize - (size_t)i * block_size : block_size;
+        size_t csize = sizes[i] > 0 ? (size_t)sizes[i] : size;
+        if (pos + csize > outsize) { pos = 0; break; }
+        value = sizes[i] > 0 ? (uint32_t)sizes[i] : 0;
+        memcpy(outbuf + 12 + 4 * i, &value, 4);
+        memcpy(outbuf + pos, sizes[i] > 0 ? tmp + (size_t)i * 2 * block_size : inbuf + (size_t)i * block_size, csize);
+        pos += csize;
+    }
+    free(tmp);
+    return pos;
+}
+
+int64_t lzbench_blosclzmt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint32_t block_size;
+    if (insize < 12) return 0;
+    memcpy(&block_size, inbuf + 4, 4);
+    if (block_size == 0) return 0;
+
+    uint32_t blocks = (uint32_t)((outsize + block_size - 1) / block_size);
+    int shuffle = inbuf[1];
+    lzbench_filter_t filter = { shuffle == 2 ? FILTER_BITSHUFFLE : FILTER_SHUFFLE, (int)(uint8_t)inbuf[0] };
+    std::vector<size_t> offsets(blocks + 1);
+    std::vector<uint32_t> csizes(blocks);
+    std::atomic<bool> error(false);
+    char* tmp = shuffle ? (char*)malloc((size_t)blocks * block_size) : NULL;
+
+    if (insize < 4 * (3 + (size_t)blocks) || (shuffle && !tmp) || filter.width < 1 || filter.width > FILTER_MAX_WIDTH) { free(tmp); return 0; }
+    offsets[0] = 4 * (3 + (size_t)blocks);
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        size_t size = outsize - (size_t)i * block_size < block_size ? outsize - (size_t)i * block_size : block_size;
+        memcpy(&csizes[i], inbuf + 12 + 4 * i, 4);
+        offsets[i + 1] = offsets[i] + (csizes[i] ? csizes[i] : size);
+        if (offsets[i + 1] > insize) { free(tmp); return 0; }
+    }
+    lzbench_run_blocks(lzbench_blosclzmt_threads, blocks, [&](uint32_t i, int) {
+        size_t size = outsize - (size_t)i * block_size < block_size ? outsize - (size_t)i * block_size : block_size;
+        char *dst = outbuf + (size_t)i * block_size;
+        if (!csizes[i]) { memcpy(dst, inbuf + offsets[i], size); return; }
+        char *out = shuffle ? tmp + (size_t)i * block_size : dst;
+        if (blosclz_decompress(inbuf + offsets[i], (int)csizes[i], out, (int)size) != (int)size) { error = true; return; }
+        if (shuffle) lzbench_filter_inverse(filter, (const uint8_t*)out, (uint8_t*)dst, size);
+    });
+    free(tmp);
+    return error ? 0 : outsize;
+}
+
 #endif // BENCH_REMOVE_BLOSCLZ
 
 
@@ -75,17 +542,199 @@ int64_t lzbench_brieflz_decompress(char *inbuf, size_t insize, char *outbuf, siz
 #include "brotli/encode.h"
 #include "brotli/decode.h"
 
-int64_t lzbench_brotli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char*)
+static void* lzbench_brotli_alloc(void* pool, size_t size) { return pool ? lzbench_pool_alloc((lzbench_pool_t*)pool, size) : lzbench_mem_alloc(size); }
+static void lzbench_brotli_free(void* pool, void* address) { if (pool) lzbench_pool_free((lzbench_pool_t*)pool, address); else lzbench_mem_free(address); }
+
+// brotli states cannot be reset, with a pool they are created in the blocks of the previous call
+typedef struct
+{
+    lzbench_pool_t* pool;
+    BrotliEncoderPreparedDictionary* dict;
+    const char* dict_data; // the raw dictionary of the decoder
+    size_t dict_size;
+} brotli_params_s;
+
+char* lzbench_brotli_init(size_t, size_t level, size_t)
+{
+    if (!lzbench_context_reuse && !lzbench_dict) return NULL;
+    brotli_params_s* params = (brotli_params_s*) calloc(1, sizeof(brotli_params_s));
+    if (!params) return NULL;
+    if (lzbench_context_reuse) params->pool = lzbench_pool_create();
+    if (lzbench_dict) params->dict = BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW, lzbench_dict_size, (const uint8_t*)lzbench_dict, (int)level, lzbench_brotli_alloc, lzbench_brotli_free, NULL);
+    params->dict_data = lzbench_dict;
+    params->dict_size = lzbench_dict_size;
+    return (char*) params;
+}
+
+/*
+ * brotli_dict: always with the dictionary of --brotli-dict or of --dict, like shared-dictionary content encoding,
+ * levels 2-11 as levels 0 and 1 ignore a prepared dictionary.
+ * The preparation of the dictionary is timed here, outside of compression, and so is the cost that attaching it
+ * adds to every call: the compression of a single byte with and without the dictionary.
+ */
+const char* lzbench_brotli_dict = NULL;
+size_t lzbench_brotli_dict_size = 0;
+uint64_t lzbench_brotli_dict_prepare_ns = 0, lzbench_brotli_dict_call_ns = 0;
+
+static uint64_t brotli_tiny_call_ns(BrotliEncoderPreparedDictionary* dict, size_t level)
+{
+    uint64_t best = UINT64_MAX;
+    for (int k = 0; k < 5; k++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        BrotliEncoderState* s = BrotliEncoderCreateInstance(lzbench_brotli_alloc, lzbench_brotli_free, NULL);
+        if (!s) return 0;
+        if (dict) BrotliEncoderAttachPreparedDictionary(s, dict);
+        BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)level);
+        size_t avail_in = 1, avail_out = 16;
+        const uint8_t in[1] = { 0 }, *next_in = in;
+        uint8_t out[16], *next_out = out;
+        BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH, &avail_in, &next_in, &avail_out, &next_out, NULL);
+        BrotliEncoderDestroyInstance(s);
+        best = MIN(best, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+char* lzbench_brotli_dict_init(size_t, size_t level, size_t)
+{
+    if (!lzbench_brotli_dict) return NULL;
+    brotli_params_s* params = (brotli_params_s*) calloc(1, sizeof(brotli_params_s));
+    if (!params) return NULL;
+    if (lzbench_context_reuse) params->pool = lzbench_pool_create();
+    auto start = std::chrono::steady_clock::now();
+    params->dict = BrotliEncoderPrepareDictionary(BROTLI_SHARED_DICTIONARY_RAW, lzbench_brotli_dict_size, (const uint8_t*)lzbench_brotli_dict, (int)level, lzbench_brotli_alloc, lzbench_brotli_free, NULL);
+    lzbench_brotli_dict_prepare_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    if (!params->dict) { free(params); return NULL; }
+    params->dict_data = lzbench_brotli_dict;
+    params->dict_size = lzbench_brotli_dict_size;
+    uint64_t with = brotli_tiny_call_ns(params->dict, level), without = brotli_tiny_call_ns(NULL, level);
+    lzbench_brotli_dict_call_ns = with > without ? with - without : 0;
+    return (char*) params;
+}
+
+int64_t lzbench_brotli_dict_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+    if (!workmem) return 0; // no dictionary
+    return lzbench_brotli_compress(inbuf, insize, outbuf, outsize, level, windowLog, workmem);
+}
+
+void lzbench_brotli_deinit(char* workmem)
+{
+    brotli_params_s* params = (brotli_params_s*) workmem;
+    if (!params) return;
+    if (params->dict) BrotliEncoderDestroyPreparedDictionary(params->dict);
+    lzbench_pool_destroy(params->pool);
+    free(workmem);
+}
+
+size_t lzbench_brotli_bound(size_t insize)
+{
+    return BrotliEncoderMaxCompressedSize(insize);
+}
+
+// the same as BrotliEncoderCompress() and BrotliDecoderDecompress() but with the counting allocator
+int64_t lzbench_brotli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
 {
     if (!windowLog) windowLog = BROTLI_DEFAULT_WINDOW; // sliding window size. Range is 10 to 24.
+    if (lzbench_options.lgwin >= 0) windowLog = lzbench_options.lgwin; // up to 30 with a large window
+
+    brotli_params_s* params = (brotli_params_s*) workmem;
+    BrotliEncoderState* s = BrotliEncoderCreateInstance(lzbench_brotli_alloc, lzbench_brotli_free, params ? params->pool : NULL);
+    if (!s) return 0;
+    if (params && params->dict) BrotliEncoderAttachPreparedDictionary(s, params->dict);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)level);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)windowLog);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_MODE, BROTLI_DEFAULT_MODE);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_SIZE_HINT, (uint32_t)insize);
+    if (lzbench_options.lgblock >= 0) BrotliEncoderSetParameter(s, BROTLI_PARAM_LGBLOCK, (uint32_t)lzbench_options.lgblock);
+    if (windowLog > BROTLI_MAX_WINDOW_BITS) BrotliEncoderSetParameter(s, BROTLI_PARAM_LARGE_WINDOW, BROTLI_TRUE);
+
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = (const uint8_t*)inbuf;
+    uint8_t* next_out = (uint8_t*)outbuf;
+    BROTLI_BOOL ok = BrotliEncoderCompressStream(s, BROTLI_OPERATION_FINISH, &avail_in, &next_in, &avail_out, &next_out, NULL);
+    if (!BrotliEncoderIsFinished(s)) ok = BROTLI_FALSE;
+    BrotliEncoderDestroyInstance(s);
+    return ok ? outsize - avail_out : 0;
+}
+int64_t lzbench_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    brotli_params_s* params = (brotli_params_s*) workmem;
+    BrotliDecoderState* s = BrotliDecoderCreateInstance(lzbench_brotli_alloc, lzbench_brotli_free, params ? params->pool : NULL);
+    if (!s) return 0;
+    if (params && params->dict) BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW, params->dict_size, (const uint8_t*)params->dict_data);
+    if (lzbench_options.lgwin > BROTLI_MAX_WINDOW_BITS) BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, BROTLI_TRUE);
+
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = (const uint8_t*)inbuf;
+    uint8_t* next_out = (uint8_t*)outbuf;
+    BrotliDecoderResult res = BrotliDecoderDecompressStream(s, &avail_in, &next_in, &avail_out, &next_out, NULL);
+    BrotliDecoderDestroyInstance(s);
+    return res != BROTLI_DECODER_RESULT_SUCCESS ? 0 : outsize - avail_out;
+}
+
+// --ttfb: the stream is decoded until outsize bytes of output exist
+int64_t lzbench_brotli_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    brotli_params_s* params = (brotli_params_s*) workmem;
+    BrotliDecoderState* s = BrotliDecoderCreateInstance(lzbench_brotli_alloc, lzbench_brotli_free, params ? params->pool : NULL);
+    if (!s) return 0;
+    if (params && params->dict) BrotliDecoderAttachDictionary(s, BROTLI_SHARED_DICTIONARY_RAW, params->dict_size, (const uint8_t*)params->dict_data);
+    if (lzbench_options.lgwin > BROTLI_MAX_WINDOW_BITS) BrotliDecoderSetParameter(s, BROTLI_DECODER_PARAM_LARGE_WINDOW, BROTLI_TRUE);
+
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = (const uint8_t*)inbuf;
+    uint8_t* next_out = (uint8_t*)outbuf;
+    BrotliDecoderResult res = BrotliDecoderDecompressStream(s, &avail_in, &next_in, &avail_out, &next_out, NULL);
+    BrotliDecoderDestroyInstance(s);
+    return res == BROTLI_DECODER_RESULT_ERROR ? 0 : outsize - avail_out;
+}
+
+// streaming of --feed, a flush ends the current metablock
+char* lzbench_brotli_stream_begin(size_t level, size_t windowLog)
+{
+    if (!windowLog) windowLog = BROTLI_DEFAULT_WINDOW;
+
+    BrotliEncoderState* s = BrotliEncoderCreateInstance(lzbench_brotli_alloc, lzbench_brotli_free, NULL);
+    if (!s) return NULL;
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_QUALITY, (uint32_t)level);
+    BrotliEncoderSetParameter(s, BROTLI_PARAM_LGWIN, (uint32_t)windowLog);
+    if (windowLog > BROTLI_MAX_WINDOW_BITS) BrotliEncoderSetParameter(s, BROTLI_PARAM_LARGE_WINDOW, BROTLI_TRUE);
+    return (char*)s;
+}
+
+static int64_t brotli_stream(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize, BrotliEncoderOperation op)
+{
+    BrotliEncoderState* s = (BrotliEncoderState*)state;
+    size_t avail_in = insize, avail_out = outsize;
+    const uint8_t* next_in = (const uint8_t*)inbuf;
+    uint8_t* next_out = (uint8_t*)outbuf;
+
+    while (1)
+    {
+        if (!BrotliEncoderCompressStream(s, op, &avail_in, &next_in, &avail_out, &next_out, NULL)) return -1;
+        if (!avail_in && !BrotliEncoderHasMoreOutput(s) && (op != BROTLI_OPERATION_FINISH || BrotliEncoderIsFinished(s))) break;
+        if (!avail_out) return -1;
+    }
+    return outsize - avail_out;
+}
+
+int64_t lzbench_brotli_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+    return brotli_stream(state, inbuf, insize, outbuf, outsize, BROTLI_OPERATION_PROCESS);
+}
 
-    size_t actual_osize = outsize;
-    return BrotliEncoderCompress(level, windowLog, BROTLI_DEFAULT_MODE, insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) == 0 ? 0 : actual_osize;
+int64_t lzbench_brotli_stream_flush(char* state, char *outbuf, size_t outsize)
+{
+    return brotli_stream(state, NULL, 0, outbuf, outsize, BROTLI_OPERATION_FLUSH);
 }
-int64_t lzbench_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+
+int64_t lzbench_brotli_stream_end(char* state, char *outbuf, size_t outsize)
 {
-    size_t actual_osize = outsize;
-    return BrotliDecoderDecompress(insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) == BROTLI_DECODER_RESULT_ERROR ? 0 : actual_osize;
+    int64_t res = outbuf ? brotli_stream(state, NULL, 0, outbuf, outsize, BROTLI_OPERATION_FINISH) : 0;
+    BrotliEncoderDestroyInstance((BrotliEncoderState*)state);
+    return res;
 }
 
 #endif // BENCH_REMOVE_BROTLI
@@ -95,16 +744,267 @@ int64_t lzbench_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size
 #ifndef BENCH_REMOVE_BZIP2
 #include "bzip2/bzlib.h"
 
-int64_t lzbench_bzip2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char*)
+static void* lzbench_bzip2_alloc(void* pool, int n, int m) { return pool ? lzbench_pool_alloc((lzbench_pool_t*)pool, (size_t)n * m) : lzbench_mem_alloc((size_t)n * m); }
+static void lzbench_bzip2_free(void* pool, void* address) { if (pool) lzbench_pool_free((lzbench_pool_t*)pool, address); else lzbench_mem_free(address); }
+
+// bzip2 streams cannot be reset, with workmem their arrays are the blocks of the previous call
+char* lzbench_bzip2_init(size_t, size_t, size_t)
+{
+    return lzbench_context_reuse ? (char*)lzbench_pool_create() : NULL;
+}
+
+void lzbench_bzip2_deinit(char* workmem)
+{
+    lzbench_pool_destroy((lzbench_pool_t*)workmem);
+}
+
+// the same as BZ2_bzBuffToBuffCompress() and BZ2_bzBuffToBuffDecompress() but with the counting allocator
+int64_t lzbench_bzip2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+   bz_stream strm;
+   memset(&strm, 0, sizeof(strm));
+   strm.bzalloc = lzbench_bzip2_alloc;
+   strm.bzfree = lzbench_bzip2_free;
+   strm.opaque = workmem;
+   if (BZ2_bzCompressInit(&strm, level, 0, 0) != BZ_OK) return -1;
+   strm.next_in = inbuf;
+   strm.avail_in = (unsigned int)insize;
+   strm.next_out = outbuf;
+   strm.avail_out = (unsigned int)outsize;
+   int ret = BZ2_bzCompress(&strm, BZ_FINISH);
+   int64_t outlen = outsize - strm.avail_out;
+   BZ2_bzCompressEnd(&strm);
+   return ret==BZ_STREAM_END?outlen:-1;
+}
+
+int64_t lzbench_bzip2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+   bz_stream strm;
+   memset(&strm, 0, sizeof(strm));
+   strm.bzalloc = lzbench_bzip2_alloc;
+   strm.bzfree = lzbench_bzip2_free;
+   strm.opaque = workmem;
+   strm.next_in = inbuf;
+   strm.avail_in = (unsigned int)insize;
+   strm.next_out = outbuf;
+   strm.avail_out = (unsigned int)outsize;
+   int ret;
+   do // the concatenated streams of parallel bzip2 encoders
+   {
+      if (BZ2_bzDecompressInit(&strm, 0, 0) != BZ_OK) return -1;
+      ret = BZ2_bzDecompress(&strm);
+      BZ2_bzDecompressEnd(&strm);
+   }
+   while (ret == BZ_STREAM_END && strm.avail_in > 0);
+   return ret==BZ_STREAM_END?outsize - strm.avail_out:-1;
+}
+
+
+/*
+ * pbzip2 compresses slices of the input of the size of a bzip2 block on its threads into single-block streams, like
+ * lbzip2 their blocks are copied bit by bit into one multi-block stream with the combined CRC. The slices are cut
+ * where RLE1 fills a block, one that still makes more blocks is compressed again in halves. The decompression finds the blocks by their 48-bit magic at any
+ * bit offset like bzip2recover, decodes every block as a stream of its own on the threads and joins the outputs.
+ */
+int lzbench_pbzip2_threads = 1;
+
+#define BZIP2_BLOCK_MAGIC 0x314159265359ULL
+#define BZIP2_EOS_MAGIC 0x177245385090ULL
+
+// n <= 32 bits at bit pos of a big-endian bit stream of size bytes
+static uint32_t bzip2_get_bits(const uint8_t* p, size_t size, uint64_t pos, int n)
+{
+    uint64_t v = 0;
+    size_t byte = pos >> 3;
+    for (int i = 0; i < 5; i++) v = (v << 8) | (byte + i < size ? p[byte + i] : 0);
+    return (uint32_t)((v >> (40 - n - (pos & 7))) & ((1ULL << n) - 1));
+}
+
+typedef struct
+{
+    uint8_t* out;
+    size_t pos, size;
+    uint64_t acc;
+    int bits;
+} bzip2_bit_writer_t;
+
+static void bzip2_put_bits(bzip2_bit_writer_t& w, uint32_t v, int n)
+{
+    w.acc = (w.acc << n) | v;
+    w.bits += n;
+    while (w.bits >= 8)
+    {
+        w.bits -= 8;
+        if (w.pos < w.size) w.out[w.pos] = (uint8_t)(w.acc >> w.bits);
+        w.pos++;
+    }
+}
+
+static void bzip2_copy_bits(bzip2_bit_writer_t& w, const uint8_t* p, size_t size, uint64_t from, uint64_t to)
+{
+    for (; from + 32 <= to; from += 32) bzip2_put_bits(w, bzip2_get_bits(p, size, from, 32), 32);
+    if (from < to) bzip2_put_bits(w, bzip2_get_bits(p, size, from, (int)(to - from)), (int)(to - from));
+}
+
+static void bzip2_put_end(bzip2_bit_writer_t& w, uint32_t crc)
+{
+    bzip2_put_bits(w, (uint32_t)(BZIP2_EOS_MAGIC >> 24), 24);
+    bzip2_put_bits(w, (uint32_t)(BZIP2_EOS_MAGIC & 0xFFFFFF), 24);
+    bzip2_put_bits(w, crc, 32);
+    if (w.bits) bzip2_put_bits(w, 0, 8 - w.bits);
+}
+
+// the end of the single block of a stream of bzip2 in bits, 0 = not a stream of a single block
+static uint64_t bzip2_single_block(const uint8_t* p, size_t size)
+{
+    if (size < 4 + 10 + 10 || bzip2_get_bits(p, size, 32, 24) != (BZIP2_BLOCK_MAGIC >> 24)) return 0;
+    uint32_t crc = bzip2_get_bits(p, size, 80, 32);
+    for (int pad = 0; pad < 8; pad++)
+    {
+        uint64_t end = (uint64_t)size * 8 - 80 - pad;
+        if (bzip2_get_bits(p, size, end, 24) == (BZIP2_EOS_MAGIC >> 24) && bzip2_get_bits(p, size, end + 24, 24) == (BZIP2_EOS_MAGIC & 0xFFFFFF))
+            return bzip2_get_bits(p, size, end + 48, 32) == crc ? end : 0; // the combined CRC of one block is its CRC
+    }
+    return 0;
+}
+
+// bytes of the input that fit into a block of max bytes after RLE1, runs of 4 to 255 bytes are 4 bytes and a count
+static size_t bzip2_rle1_cut(const uint8_t* p, size_t size, size_t max)
+{
+    size_t pos = 0, n = 0;
+    while (pos < size)
+    {
+        size_t run = 1;
+        while (pos + run < size && run < 255 && p[pos + run] == p[pos]) run++;
+        if (n + MIN(run, (size_t)4) + (run >= 4) > max) break;
+        n += MIN(run, (size_t)4) + (run >= 4);
+        pos += run;
+    }
+    return pos;
+}
+
+char* lzbench_pbzip2_init(size_t, size_t, size_t)
+{
+    if (!lzbench_context_reuse) return NULL;
+    std::vector<lzbench_pool_t*>* pools = new std::vector<lzbench_pool_t*>;
+    for (int t = 0; t < lzbench_pbzip2_threads; t++) pools->push_back(lzbench_pool_create());
+    return (char*) pools;
+}
+
+void lzbench_pbzip2_deinit(char* workmem)
+{
+    std::vector<lzbench_pool_t*>* pools = (std::vector<lzbench_pool_t*>*) workmem;
+    if (!pools) return;
+    for (size_t t = 0; t < pools->size(); t++) lzbench_pool_destroy((*pools)[t]);
+    delete pools;
+}
+
+int64_t lzbench_pbzip2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-   unsigned int a_outsize = outsize;
-   return BZ2_bzBuffToBuffCompress((char *)outbuf, &a_outsize, (char *)inbuf, (unsigned int)insize, level, 0, 0)==BZ_OK?a_outsize:-1;
+    std::vector<lzbench_pool_t*>* pools = (std::vector<lzbench_pool_t*>*) workmem;
+    size_t block = 100000 * level - 20; // nblockMAX of bzip2, the last byte may wait for a run
+    std::vector<size_t> offsets, sizes;
+    std::vector<std::vector<char> > streams;
+    std::vector<uint64_t> ends;
+
+    for (size_t pos = 0, slice; pos < insize; pos += slice)
+    {
+        slice = MAX(bzip2_rle1_cut((uint8_t*)inbuf + pos, insize - pos, block), (size_t)1);
+        offsets.push_back(pos), sizes.push_back(slice);
+    }
+    for (size_t done = 0; done < offsets.size(); )
+    {
+        streams.resize(offsets.size());
+        ends.resize(offsets.size());
+        lzbench_run_blocks(lzbench_pbzip2_threads, (uint32_t)(offsets.size() - done), [&](uint32_t k, int t) {
+            size_t i = done + k;
+            streams[i].resize(sizes[i] + sizes[i] / 100 + 600);
+            int64_t len = lzbench_bzip2_compress(inbuf + offsets[i], sizes[i], streams[i].data(), streams[i].size(), level, 0, pools ? (char*)(*pools)[t] : NULL);
+            ends[i] = len > 0 ? bzip2_single_block((uint8_t*)streams[i].data(), len) : 0;
+        });
+        // slices of more than one block are compressed again in halves
+        size_t count = offsets.size();
+        for (size_t i = done; i < count; i++)
+        {
+            if (ends[i]) continue;
+            if (sizes[i] < 2) return 0;
+            offsets.push_back(offsets[i]), sizes.push_back(sizes[i] / 2);
+            offsets.push_back(offsets[i] + sizes[i] / 2), sizes.push_back(sizes[i] - sizes[i] / 2);
+        }
+        done = count;
+    }
+
+    // the slices in the order of the input, split ones are replaced by their halves
+    std::vector<size_t> order;
+    for (size_t i = 0; i < offsets.size(); i++)
+        if (ends[i]) order.push_back(i);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return offsets[a] < offsets[b]; });
+
+    bzip2_bit_writer_t w = { (uint8_t*)outbuf, 0, outsize, 0, 0 };
+    uint32_t crc = 0;
+    bzip2_put_bits(w, ('B' << 16) | ('Z' << 8) | 'h', 24);
+    bzip2_put_bits(w, '0' + (uint32_t)level, 8);
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        size_t i = order[k];
+        const uint8_t* p = (const uint8_t*)streams[i].data();
+        bzip2_copy_bits(w, p, streams[i].size(), 32, ends[i]);
+        crc = ((crc << 1) | (crc >> 31)) ^ bzip2_get_bits(p, streams[i].size(), 80, 32);
+    }
+    bzip2_put_end(w, crc);
+    return w.pos <= outsize ? (int64_t)w.pos : 0;
 }
 
-int64_t lzbench_bzip2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+int64_t lzbench_pbzip2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
-   unsigned int a_outsize = outsize;
-   return BZ2_bzBuffToBuffDecompress((char *)outbuf, &a_outsize, (char *)inbuf, (unsigned int)insize, 0, 0)==BZ_OK?a_outsize:-1;
+    std::vector<lzbench_pool_t*>* pools = (std::vector<lzbench_pool_t*>*) workmem;
+    const uint8_t* p = (const uint8_t*)inbuf;
+    std::vector<uint64_t> starts, ends;
+    uint64_t window = 0;
+
+    // a block ends at the magic of the next block or of the end of its stream
+    for (size_t i = 0; i < insize; i++)
+    {
+        window = (window << 8) | p[i];
+        for (int shift = 7; shift >= 0 && i >= 6; shift--)
+        {
+            uint64_t magic = (window >> shift) & 0xFFFFFFFFFFFFULL;
+            if (magic != BZIP2_BLOCK_MAGIC && magic != BZIP2_EOS_MAGIC) continue;
+            uint64_t pos = (uint64_t)(i + 1) * 8 - shift - 48;
+            if (starts.size() > ends.size()) ends.push_back(pos);
+            if (magic == BZIP2_BLOCK_MAGIC) starts.push_back(pos);
+        }
+    }
+    if (starts.empty() || starts.size() != ends.size())
+        return lzbench_bzip2_decompress(inbuf, insize, outbuf, outsize, 0, 0, NULL);
+
+    std::vector<std::vector<char> > outputs(starts.size());
+    std::vector<int64_t> sizes(starts.size(), -1);
+    lzbench_run_blocks(lzbench_pbzip2_threads, (uint32_t)starts.size(), [&](uint32_t i, int t) {
+        // a block as a stream of its own, its CRC is the combined one
+        std::vector<char> stream((ends[i] - starts[i]) / 8 + 32);
+        bzip2_bit_writer_t w = { (uint8_t*)stream.data(), 0, stream.size(), 0, 0 };
+        bzip2_put_bits(w, ('B' << 16) | ('Z' << 8) | 'h', 24);
+        bzip2_put_bits(w, '9', 8);
+        bzip2_copy_bits(w, p, insize, starts[i], ends[i]);
+        bzip2_put_end(w, bzip2_get_bits(p, insize, starts[i] + 48, 32));
+        for (size_t capacity = MIN(outsize, (size_t)900000); ; capacity = MIN(outsize, capacity * 2)) // RLE1 runs may decode to more than a block
+        {
+            outputs[i].resize(capacity);
+            sizes[i] = lzbench_bzip2_decompress(stream.data(), w.pos, outputs[i].data(), capacity, 0, 0, pools ? (char*)(*pools)[t] : NULL);
+            if (sizes[i] >= 0 || capacity == outsize) break;
+        }
+    });
+
+    size_t pos = 0;
+    for (size_t i = 0; i < starts.size(); i++)
+    {
+        if (sizes[i] < 0 || pos + sizes[i] > outsize)
+            return lzbench_bzip2_decompress(inbuf, insize, outbuf, outsize, 0, 0, NULL); // a false magic in the data
+        memcpy(outbuf + pos, outputs[i].data(), sizes[i]);
+        pos += sizes[i];
+    }
+    return pos;
 }
 
 #endif // BENCH_REMOVE_BZIP2
@@ -190,6 +1090,12 @@ int64_t lzbench_fastlz_decompress(char *inbuf, size_t insize, char *outbuf, size
 #ifndef BENCH_REMOVE_FASTLZMA2
 #include "fast-lzma2/fast-lzma2.h"
 
+// FL2_checkNbThreads() of the threaded library asks for it when 0 threads are given, util.c of fast-lzma2 is not included
+extern "C" int UTIL_countPhysicalCores(void)
+{
+    return std::thread::hardware_concurrency();
+}
+
 int64_t lzbench_fastlzma2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
 {
     size_t ret = FL2_compress(outbuf, outsize, inbuf, insize, level);
@@ -203,38 +1109,134 @@ int64_t lzbench_fastlzma2_decompress(char *inbuf, size_t insize, char *outbuf, s
     if (FL2_isError(ret)) return 0;
     return ret;
 }
+
+#ifdef BENCH_HAS_FASTLZMA2_ASM
+// fastlzma2_asm: FL2_decompress() of fast-lzma2/fl2_decompress_asm.o, symbols are decoded by lzma_dec_x86_64.S
+extern "C" size_t FL2_asm_decompress(void* dst, size_t dstCapacity, const void* src, size_t compressedSize);
+
+int64_t lzbench_fastlzma2_asm_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    size_t ret = FL2_asm_decompress(outbuf, outsize, inbuf, insize);
+    if (FL2_isError(ret)) return 0;
+    return ret;
+}
+#endif
+
+// fastlzma2mt: contexts with a pool of threads for the radix match finder and for decoding of blocks in parallel
+int lzbench_fastlzma2mt_threads = 1;
+
+typedef struct
+{
+    FL2_CCtx* cctx;
+    FL2_DCtx* dctx;
+} fastlzma2_params_s;
+
+char* lzbench_fastlzma2mt_init(size_t, size_t, size_t)
+{
+    fastlzma2_params_s* params = (fastlzma2_params_s*) malloc(sizeof(fastlzma2_params_s));
+    if (!params) return NULL;
+    params->cctx = FL2_createCCtxMt(lzbench_fastlzma2mt_threads);
+    params->dctx = FL2_createDCtxMt(lzbench_fastlzma2mt_threads);
+    return (char*) params;
+}
+
+void lzbench_fastlzma2mt_deinit(char* workmem)
+{
+    fastlzma2_params_s* params = (fastlzma2_params_s*) workmem;
+    if (!params) return;
+    FL2_freeCCtx(params->cctx);
+    FL2_freeDCtx(params->dctx);
+    free(workmem);
+}
+
+int64_t lzbench_fastlzma2mt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    fastlzma2_params_s* params = (fastlzma2_params_s*) workmem;
+    if (!params || !params->cctx) return 0;
+    size_t ret = FL2_compressCCtx(params->cctx, outbuf, outsize, inbuf, insize, level);
+    if (FL2_isError(ret)) return 0;
+    return ret;
+}
+
+int64_t lzbench_fastlzma2mt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    fastlzma2_params_s* params = (fastlzma2_params_s*) workmem;
+    if (!params || !params->dctx) return 0;
+    size_t ret = FL2_decompressDCtx(params->dctx, outbuf, outsize, inbuf, insize);
+    if (FL2_isError(ret)) return 0;
+    return ret;
+}
 #endif // BENCH_REMOVE_FASTLZMA2
 
 
 #ifndef BENCH_REMOVE_GIPFELI
 #include "gipfeli/gipfeli.h"
 
-int64_t lzbench_gipfeli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+// a compressor keeps its compression and decompression state between calls
+char* lzbench_gipfeli_init(size_t, size_t, size_t)
 {
-    int64_t res;
-    util::compression::Compressor *gipfeli = util::compression::NewGipfeliCompressor();
+    return lzbench_context_reuse ? (char*)util::compression::NewGipfeliCompressor() : NULL;
+}
+
+void lzbench_gipfeli_deinit(char* workmem)
+{
+    delete (util::compression::Compressor*)workmem;
+}
+
+// UncheckedByteArraySink has no GetAppendBuffer() of the Sink interface, gipfeli wrote every block to a scratch
+// buffer and copied it, this sink gives it the output buffer of lzbench and Append() of it copies nothing
+class lzbench_gipfeli_sink : public util::compression::Sink
+{
+public:
+    lzbench_gipfeli_sink(char* dest, size_t size) : start(dest), pos(dest), end(dest + size), overflow(false) {}
+
+    virtual void Append(const char* data, size_t n)
+    {
+        if (n > (size_t)(end - pos)) { overflow = true; n = end - pos; }
+        if (data != pos) memcpy(pos, data, n);
+        pos += n;
+    }
+
+    virtual char* GetAppendBuffer(size_t min_size, size_t, char* scratch, size_t scratch_size, size_t* allocated_size)
+    {
+        if (min_size > (size_t)(end - pos)) { *allocated_size = scratch_size; return scratch; }
+        *allocated_size = end - pos;
+        return pos;
+    }
+
+    int64_t written() const { return overflow ? 0 : pos - start; }
+
+private:
+    char *start, *pos, *end;
+    bool overflow;
+};
+
+int64_t lzbench_gipfeli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    int64_t res = 0;
+    util::compression::Compressor *gipfeli = workmem ? (util::compression::Compressor*)workmem : util::compression::NewGipfeliCompressor();
     if (gipfeli)
     {
-        util::compression::UncheckedByteArraySink sink((char*)outbuf);
+        lzbench_gipfeli_sink sink(outbuf, outsize);
         util::compression::ByteArraySource src((const char*)inbuf, insize);
-        res = gipfeli->CompressStream(&src, &sink); 
-        delete gipfeli; 
+        if (gipfeli->CompressStream(&src, &sink))
+            res = sink.written();
+        if (!workmem) delete gipfeli;
     }
-    else res=0;
     return res;
 }
 
-int64_t lzbench_gipfeli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_gipfeli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
     int64_t res = 0;
-    util::compression::Compressor *gipfeli = util::compression::NewGipfeliCompressor();
+    util::compression::Compressor *gipfeli = workmem ? (util::compression::Compressor*)workmem : util::compression::NewGipfeliCompressor();
     if (gipfeli)
     {
-        util::compression::UncheckedByteArraySink sink((char*)outbuf);
+        lzbench_gipfeli_sink sink(outbuf, outsize);
         util::compression::ByteArraySource src((const char*)inbuf, insize);
         if (gipfeli->UncompressStream(&src, &sink))
-            res = outsize;
-        delete gipfeli;
+            res = sink.written();
+        if (!workmem) delete gipfeli;
     }
     return res;
 }
@@ -265,236 +1267,990 @@ int64_t lzbench_glza_decompress(char *inbuf, size_t insize, char *outbuf, size_t
 
 #ifndef BENCH_REMOVE_LIBDEFLATE
 #include "libdeflate/libdeflate.h"
-int64_t lzbench_libdeflate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+typedef struct
+{
+    struct libdeflate_compressor *compressor;
+    struct libdeflate_decompressor *decompressor;
+} libdeflate_params_s;
+
+char* lzbench_libdeflate_init(size_t, size_t level, size_t)
+{
+    if (!lzbench_context_reuse) return NULL;
+    libdeflate_params_s* params = (libdeflate_params_s*) malloc(sizeof(libdeflate_params_s));
+    if (!params) return NULL;
+    params->compressor = libdeflate_alloc_compressor(level);
+    params->decompressor = libdeflate_alloc_decompressor();
+    return (char*) params;
+}
+
+void lzbench_libdeflate_deinit(char* workmem)
+{
+    libdeflate_params_s* params = (libdeflate_params_s*) workmem;
+    if (!params) return;
+    libdeflate_free_compressor(params->compressor);
+    libdeflate_free_decompressor(params->decompressor);
+    free(workmem);
+}
+
+// bounds of any compressor of the build, the compressor of a call may be allocated in it
+size_t lzbench_libdeflate_bound(size_t insize)
+{
+    return libdeflate_deflate_compress_bound(NULL, insize);
+}
+
+size_t lzbench_libdeflate_gzip_bound(size_t insize)
+{
+    return libdeflate_gzip_compress_bound(NULL, insize);
+}
+
+size_t lzbench_libdeflate_zlib_bound(size_t insize)
+{
+    return libdeflate_zlib_compress_bound(NULL, insize);
+}
+
+int64_t lzbench_libdeflate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-    struct libdeflate_compressor *compressor = libdeflate_alloc_compressor(level);
+    struct libdeflate_compressor *compressor = workmem ? ((libdeflate_params_s*)workmem)->compressor : libdeflate_alloc_compressor(level);
     if (!compressor)
         return 0;
     int64_t res = libdeflate_deflate_compress(compressor, inbuf, insize, outbuf, outsize);
-    libdeflate_free_compressor(compressor);
+    if (!workmem) libdeflate_free_compressor(compressor);
     return res;
 }
-int64_t lzbench_libdeflate_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_libdeflate_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
-    struct libdeflate_decompressor *decompressor = libdeflate_alloc_decompressor();
+    struct libdeflate_decompressor *decompressor = workmem ? ((libdeflate_params_s*)workmem)->decompressor : libdeflate_alloc_decompressor();
     if (!decompressor)
         return 0;
     size_t res = 0;
-    if (libdeflate_deflate_decompress(decompressor, inbuf, insize, outbuf, outsize, &res) != LIBDEFLATE_SUCCESS) {
+    enum libdeflate_result ret = libdeflate_deflate_decompress(decompressor, inbuf, insize, outbuf, outsize, &res);
+    if (!workmem) libdeflate_free_decompressor(decompressor);
+    if (ret != LIBDEFLATE_SUCCESS) {
         return 0;
     }
     return res;
 }
+
+// libdeflate_gzip and libdeflate_zlib: the same deflate stream in the containers with a CRC-32 or Adler-32
+int64_t lzbench_libdeflate_gzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    struct libdeflate_compressor *compressor = workmem ? ((libdeflate_params_s*)workmem)->compressor : libdeflate_alloc_compressor(level);
+    if (!compressor)
+        return 0;
+    int64_t res = libdeflate_gzip_compress(compressor, inbuf, insize, outbuf, outsize);
+    if (!workmem) libdeflate_free_compressor(compressor);
+    return res;
+}
+
+int64_t lzbench_libdeflate_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    struct libdeflate_compressor *compressor = workmem ? ((libdeflate_params_s*)workmem)->compressor : libdeflate_alloc_compressor(level);
+    if (!compressor)
+        return 0;
+    int64_t res = libdeflate_zlib_compress(compressor, inbuf, insize, outbuf, outsize);
+    if (!workmem) libdeflate_free_compressor(compressor);
+    return res;
+}
+
+// also gzip files of other encoders (--decompress-only), every member of a multi-member file is decompressed
+int64_t lzbench_libdeflate_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    struct libdeflate_decompressor *decompressor = workmem ? ((libdeflate_params_s*)workmem)->decompressor : libdeflate_alloc_decompressor();
+    if (!decompressor)
+        return 0;
+    size_t inpos = 0, outpos = 0, in_nbytes, out_nbytes;
+    enum libdeflate_result ret = LIBDEFLATE_SUCCESS;
+    while (inpos < insize && ret == LIBDEFLATE_SUCCESS)
+    {
+        ret = libdeflate_gzip_decompress_ex(decompressor, inbuf + inpos, insize - inpos, outbuf + outpos, outsize - outpos, &in_nbytes, &out_nbytes);
+        inpos += in_nbytes;
+        outpos += out_nbytes;
+    }
+    if (!workmem) libdeflate_free_decompressor(decompressor);
+    return ret == LIBDEFLATE_SUCCESS ? outpos : 0;
+}
+
+int64_t lzbench_libdeflate_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    struct libdeflate_decompressor *decompressor = workmem ? ((libdeflate_params_s*)workmem)->decompressor : libdeflate_alloc_decompressor();
+    if (!decompressor)
+        return 0;
+    size_t res = 0;
+    enum libdeflate_result ret = libdeflate_zlib_decompress(decompressor, inbuf, insize, outbuf, outsize, &res);
+    if (!workmem) libdeflate_free_decompressor(decompressor);
+    return ret == LIBDEFLATE_SUCCESS ? res : 0;
+}
+
+// checksum rows: the digest of the chunk is the "compressed" output, see is_checksum() of lzbench.cpp
+int64_t lzbench_crc32_libdeflate_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint32_t crc = libdeflate_crc32(0, inbuf, insize);
+    if (outsize < sizeof(crc)) return 0;
+    memcpy(outbuf, &crc, sizeof(crc));
+    return sizeof(crc);
+}
+
+int64_t lzbench_adler32_libdeflate_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint32_t adler = libdeflate_adler32(1, inbuf, insize);
+    if (outsize < sizeof(adler)) return 0;
+    memcpy(outbuf, &adler, sizeof(adler));
+    return sizeof(adler);
+}
 #endif // BENCH_REMOVE_LIBDEFLATE
 
 
 
 #ifndef BENCH_REMOVE_LZ4
+#define LZ4_STATIC_LINKING_ONLY // LZ4_compress_fast_extState_fastReset()
+#define LZ4_DISABLE_DEPRECATE_WARNINGS // LZ4_decompress_fast() of lz4_unsafe
 #include "lz4/lz4.h"
+#define LZ4_HC_STATIC_LINKING_ONLY // LZ4_favorDecompressionSpeed()
 #include "lz4/lz4hc.h"
 
-int64_t lzbench_lz4_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+// workmem is a stream for the dictionary of --dict, it is loaded before every call
+char* lzbench_lz4_init(size_t, size_t, size_t)
 {
-	return LZ4_compress_default(inbuf, outbuf, insize, outsize);
+	return lzbench_dict ? (char*)LZ4_createStream() : NULL;
 }
 
-int64_t lzbench_lz4fast_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+void lzbench_lz4_deinit(char* workmem)
 {
-	return LZ4_compress_fast(inbuf, outbuf, insize, outsize, level);
+	if (workmem) LZ4_freeStream((LZ4_stream_t*)workmem);
 }
 
-int64_t lzbench_lz4hc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+// 0 above LZ4_MAX_INPUT_SIZE, the chunk is stored
+size_t lzbench_lz4_bound(size_t insize)
 {
-	return LZ4_compress_HC(inbuf, outbuf, insize, outsize, level);
+	return LZ4_compressBound((int)MIN(insize, (size_t)LZ4_MAX_INPUT_SIZE + 1));
 }
 
-int64_t lzbench_lz4_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_lz4_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-	return LZ4_decompress_safe(inbuf, outbuf, insize, outsize);
+	if (workmem)
+	{
+		LZ4_loadDict((LZ4_stream_t*)workmem, lzbench_dict, lzbench_dict_size);
+		return LZ4_compress_fast_continue((LZ4_stream_t*)workmem, inbuf, outbuf, insize, outsize, 1);
+	}
+	return LZ4_compress_default(inbuf, outbuf, insize, outsize);
 }
 
-#endif // BENCH_REMOVE_LIBDEFLATE
+int64_t lzbench_lz4fast_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	return LZ4_compress_fast(inbuf, outbuf, insize, outsize, level);
+}
 
+// lz4_m##: lz4.c of lz4/lz4_m##.o with LZ4_MEMORY_USAGE=## and its functions renamed by lz4/lz4_mem.h
+#define LZ4_MEM_CODEC(m) \
+	extern "C" int LZ4_m##m##_sizeofState(void); \
+	extern "C" int LZ4_m##m##_compress_fast_extState(void* state, const char* src, char* dst, int srcSize, int dstCapacity, int acceleration); \
+	int64_t lzbench_lz4_m##m##_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem) \
+	{ \
+		return LZ4_m##m##_compress_fast_extState(workmem, inbuf, outbuf, insize, outsize, 1); \
+	}
 
+LZ4_MEM_CODEC(12)
+LZ4_MEM_CODEC(14)
+LZ4_MEM_CODEC(16)
+LZ4_MEM_CODEC(18)
+LZ4_MEM_CODEC(20)
 
-#ifndef BENCH_REMOVE_LZF
-extern "C"
+// the state of the largest table fits all of them
+char* lzbench_lz4_mem_init(size_t, size_t, size_t)
 {
-	#include "lzf/lzf.h"
+	return (char*)malloc(LZ4_m20_sizeofState());
 }
 
-int64_t lzbench_lzf_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+void lzbench_lz4_mem_deinit(char* workmem)
 {
-	if (level == 0)
-		return lzf_compress(inbuf, insize, outbuf, outsize);
-	return lzf_compress_very(inbuf, insize, outbuf, outsize);
+	free(workmem);
 }
 
-int64_t lzbench_lzf_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_lz4hc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
 {
-	return lzf_decompress(inbuf, insize, outbuf, outsize);
+	if (lzbench_options.favordec > 0)
+	{
+		LZ4_streamHC_t* stream = LZ4_createStreamHC();
+		if (!stream) return 0;
+		LZ4_resetStreamHC_fast(stream, level);
+		LZ4_favorDecompressionSpeed(stream, 1);
+		int res = LZ4_compress_HC_continue(stream, inbuf, outbuf, insize, outsize);
+		LZ4_freeStreamHC(stream);
+		return res;
+	}
+	return LZ4_compress_HC(inbuf, outbuf, insize, outsize, level);
 }
 
-#endif // BENCH_REMOVE_LZF
+// lz4_extstate and lz4hc_extstate: the state is made once by init and only reset for every chunk like on the hot path of
+// a server, LZ4_compress_default() and LZ4_compress_HC() set up a new one on the stack and clear its tables every time
+char* lzbench_lz4_extstate_init(size_t, size_t, size_t)
+{
+	return (char*)LZ4_createStream();
+}
 
+void lzbench_lz4_extstate_deinit(char* workmem)
+{
+	LZ4_freeStream((LZ4_stream_t*)workmem);
+}
 
+int64_t lzbench_lz4_extstate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	if (!workmem) return 0;
+	return LZ4_compress_fast_extState_fastReset(workmem, inbuf, outbuf, insize, outsize, 1);
+}
 
-#ifndef BENCH_REMOVE_LZFSE
-extern "C"
+char* lzbench_lz4hc_extstate_init(size_t, size_t, size_t)
 {
-	#include "lzfse/lzfse.h"
+	return (char*)LZ4_createStreamHC();
 }
 
-char* lzbench_lzfse_init(size_t insize, size_t level, size_t)
+void lzbench_lz4hc_extstate_deinit(char* workmem)
 {
-    return (char*) malloc(MAX(lzfse_encode_scratch_size(), lzfse_decode_scratch_size()));
+	LZ4_freeStreamHC((LZ4_streamHC_t*)workmem);
 }
 
-void lzbench_lzfse_deinit(char* workmem)
+int64_t lzbench_lz4hc_extstate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-    free(workmem);
+	if (!workmem) return 0;
+	LZ4_favorDecompressionSpeed((LZ4_streamHC_t*)workmem, lzbench_options.favordec > 0);
+	return LZ4_compress_HC_extStateHC_fastReset(workmem, inbuf, outbuf, insize, outsize, level);
 }
 
-int64_t lzbench_lzfse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+int64_t lzbench_lz4_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
-	return lzfse_encode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+	if (workmem)
+		return LZ4_decompress_safe_usingDict(inbuf, outbuf, insize, outsize, lzbench_dict, lzbench_dict_size);
+	return LZ4_decompress_safe(inbuf, outbuf, insize, outsize);
 }
 
-int64_t lzbench_lzfse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+// --ttfb: the block is decoded only up to outsize bytes
+int64_t lzbench_lz4_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
-	return lzfse_decode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+	if (workmem)
+		return LZ4_decompress_safe_partial_usingDict(inbuf, outbuf, insize, outsize, outsize, lzbench_dict, lzbench_dict_size);
+	return LZ4_decompress_safe_partial(inbuf, outbuf, insize, outsize, outsize);
 }
 
-#endif // BENCH_REMOVE_LZFSE
+// lz4_unsafe: the same blocks decoded without bounds checks of the input, the cost of the checks of lz4
+int64_t lzbench_lz4_decompress_fast(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	int res;
+	if (workmem)
+		res = LZ4_decompress_fast_usingDict(inbuf, outbuf, outsize, lzbench_dict, lzbench_dict_size);
+	else
+		res = LZ4_decompress_fast(inbuf, outbuf, outsize);
+	return (res < 0 || (size_t)res != insize) ? 0 : outsize;
+}
 
+// a batch shares one state, it is initialized once and only reset for the next chunk
+int64_t lzbench_lz4_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t, char* workmem)
+{
+	LZ4_stream_t state;
 
+	if (workmem)
+	{
+		for (size_t i = 0; i < n; i++)
+			sizes[i] = lzbench_lz4_compress(in[i], insize[i], out[i], outsize[i], level, 0, workmem);
+		return 0;
+	}
+	if (!LZ4_initStream(&state, sizeof(state))) return -1;
+	for (size_t i = 0; i < n; i++)
+		sizes[i] = LZ4_compress_fast_extState_fastReset(&state, in[i], out[i], insize[i], outsize[i], 1);
+	return 0;
+}
 
-#ifndef BENCH_REMOVE_LZVN
-extern "C"
+int64_t lzbench_lz4_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem)
 {
-	#include "lzfse/lzvn.h"
+	for (size_t i = 0; i < n; i++)
+		sizes[i] = workmem ? LZ4_decompress_safe_usingDict(in[i], out[i], insize[i], outsize[i], lzbench_dict, lzbench_dict_size)
+		                   : LZ4_decompress_safe(in[i], out[i], insize[i], outsize[i]);
+	return 0;
 }
 
-char* lzbench_lzvn_init(size_t insize, size_t level, size_t)
+// --inplace: bytes behind the output that a chunk needs at the tail of its output buffer, from the compressed size as lz4.h allows
+int64_t lzbench_lz4_inplace_margin(char*, size_t insize, size_t)
 {
-    return (char*) malloc(MAX(lzvn_encode_scratch_size(), lzvn_decode_scratch_size()));
+	return LZ4_DECOMPRESS_INPLACE_MARGIN(insize);
 }
 
-void lzbench_lzvn_deinit(char* workmem)
+// streaming of --feed: every write is a block of LZ4_compress_fast_continue() after its 32-bit size, a flush is not needed
+char* lzbench_lz4_stream_begin(size_t, size_t)
 {
-    free(workmem);
+	return (char*)LZ4_createStream();
 }
 
-int64_t lzbench_lzvn_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+int64_t lzbench_lz4_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize)
 {
-	return lzvn_encode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+	if (outsize < 4) return -1;
+	int res = LZ4_compress_fast_continue((LZ4_stream_t*)state, inbuf, outbuf + 4, insize, outsize - 4, 1);
+	if (res <= 0) return -1;
+	uint32_t block = res;
+	memcpy(outbuf, &block, 4);
+	return res + 4;
 }
 
-int64_t lzbench_lzvn_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+int64_t lzbench_lz4_stream_end(char* state, char *, size_t)
 {
-	return lzvn_decode_buffer_scratch((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+	LZ4_freeStream((LZ4_stream_t*)state);
+	return 0;
 }
 
-#endif // BENCH_REMOVE_LZVN
+int64_t lzbench_lz4_stream_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	LZ4_streamDecode_t stream;
+	size_t inpos = 0, outpos = 0;
 
+	LZ4_setStreamDecode(&stream, NULL, 0);
+	while (inpos + 4 <= insize)
+	{
+		uint32_t block;
+		memcpy(&block, inbuf + inpos, 4);
+		inpos += 4;
+		if (block > insize - inpos) return 0;
+		int res = LZ4_decompress_safe_continue(&stream, inbuf + inpos, outbuf + outpos, block, outsize - outpos);
+		if (res < 0) return 0;
+		inpos += block;
+		outpos += res;
+	}
+	return outpos;
+}
 
+/*
+ * lz4stream and lz4frame: the input is split into linked blocks of --lz4-block bytes, every block can reference
+ * the previous 64 KB. Levels 0-2 use LZ4_compress_fast_continue(), 3-12 LZ4_compress_HC_continue().
+ * lz4stream writes a 32-bit size before every block, lz4frame is the LZ4 Frame format (lz4framecrc with a content checksum).
+ */
+size_t lzbench_lz4_block_size = 64 << 10;
 
-#ifndef BENCH_REMOVE_LZG
-#include "liblzg/lzg.h"
+typedef struct
+{
+	LZ4_stream_t* fast;
+	LZ4_streamHC_t* hc;
+} lz4_linked_s;
 
-int64_t lzbench_lzg_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+char* lzbench_lz4linked_init(size_t, size_t level, size_t)
 {
-    lzg_encoder_config_t cfg;
-    cfg.level = level;
-    cfg.fast = LZG_TRUE;
-    cfg.progressfun = NULL;
-    cfg.userdata = NULL;
-    return LZG_Encode((const unsigned char*)inbuf, insize, (unsigned char*)outbuf, outsize, &cfg);
+	lz4_linked_s* params = (lz4_linked_s*) malloc(sizeof(lz4_linked_s));
+	if (!params) return NULL;
+	params->fast = level < 3 ? LZ4_createStream() : NULL;
+	params->hc = level < 3 ? NULL : LZ4_createStreamHC();
+	return (char*) params;
 }
 
-int64_t lzbench_lzg_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+void lzbench_lz4linked_deinit(char* workmem)
 {
-    return LZG_Decode((const unsigned char*)inbuf, insize, (unsigned char*)outbuf, outsize);
+	lz4_linked_s* params = (lz4_linked_s*) workmem;
+	if (!params) return;
+	if (params->fast) LZ4_freeStream(params->fast);
+	if (params->hc) LZ4_freeStreamHC(params->hc);
+	free(workmem);
 }
 
-#endif // BENCH_REMOVE_LZG
-
-
+static uint32_t lz4_xxh32(const uint8_t* p, size_t len)
+{
+	const uint32_t P1 = 0x9E3779B1U, P2 = 0x85EBCA77U, P3 = 0xC2B2AE3DU, P4 = 0x27D4EB2FU, P5 = 0x165667B1U;
+	const uint8_t* end = p + len;
+	uint32_t h, v[4] = { P1 + P2, P2, 0, 0 - P1 }, word;
 
-#ifndef BENCH_REMOVE_LZHAM
-#include "lzham/lzham.h"
-#include <memory.h>
+	if (len >= 16)
+	{
+		for ( ; p + 16 <= end; p += 16)
+			for (int i = 0; i < 4; i++)
+			{
+				memcpy(&word, p + 4 * i, 4);
+				v[i] += word * P2;
+				v[i] = ((v[i] << 13) | (v[i] >> 19)) * P1;
+			}
+		h = ((v[0] << 1) | (v[0] >> 31)) + ((v[1] << 7) | (v[1] >> 25)) + ((v[2] << 12) | (v[2] >> 20)) + ((v[3] << 18) | (v[3] >> 14));
+	}
+	else
+		h = P5;
+	h += (uint32_t)len;
+	for ( ; p + 4 <= end; p += 4)
+	{
+		memcpy(&word, p, 4);
+		h += word * P3;
+		h = ((h << 17) | (h >> 15)) * P4;
+	}
+	for ( ; p < end; p++)
+	{
+		h += *p * P5;
+		h = ((h << 11) | (h >> 21)) * P1;
+	}
+	h ^= h >> 15; h *= P2;
+	h ^= h >> 13; h *= P3;
+	h ^= h >> 16;
+	return h;
+}
 
-int64_t lzbench_lzham_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t dict_size_log, char*)
+// frame = 0: 32-bit sizes only, 1: LZ4 Frame, 2: LZ4 Frame with a content checksum
+static int64_t lz4_linked_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, char* workmem, int frame)
 {
-	lzham_compress_params comp_params;
-	memset(&comp_params, 0, sizeof(comp_params));
-	comp_params.m_struct_size = sizeof(lzham_compress_params);
-	comp_params.m_dict_size_log2 = dict_size_log?dict_size_log:26;
-	comp_params.m_max_helper_threads = 0;
-	comp_params.m_level = (lzham_compress_level)level;
+	lz4_linked_s* params = (lz4_linked_s*) workmem;
+	size_t block_size = lzbench_lz4_block_size, inpos = 0, outpos = 0;
 
-	lzham_compress_status_t comp_status;
-	lzham_uint32 comp_adler32 = 0;
+	if (!params || !(level < 3 ? (void*)params->fast : (void*)params->hc)) return 0;
+	if (level < 3) LZ4_resetStream_fast(params->fast);
+	else LZ4_resetStreamHC_fast(params->hc, level);
 
-	if ((comp_status = lzham_compress_memory(&comp_params, (uint8_t*)outbuf, &outsize, (const lzham_uint8 *)inbuf, insize, &comp_adler32)) != LZHAM_COMP_STATUS_SUCCESS)
+	if (frame)
 	{
-		printf("Compression test failed with status %i!\n", comp_status);
-		return 0;
+		uint32_t magic = 0x184D2204;
+		uint8_t bd = block_size <= (64 << 10) ? 4 : block_size <= (256 << 10) ? 5 : block_size <= (1 << 20) ? 6 : 7;
+		if (outsize < 7 + 4 + 4) return 0;
+		memcpy(outbuf, &magic, 4);
+		outbuf[4] = (char)(0x40 | (frame == 2 ? 0x04 : 0)); // version 01, linked blocks
+		outbuf[5] = (char)(bd << 4);
+		outbuf[6] = (char)((lz4_xxh32((uint8_t*)outbuf + 4, 2) >> 8) & 0xFF);
+		outpos = 7;
+		if (block_size > ((size_t)64 << 10) << (2 * (bd - 4))) block_size = ((size_t)64 << 10) << (2 * (bd - 4));
 	}
 
-	return outsize;
+	while (inpos < insize)
+	{
+		size_t part = insize - inpos < block_size ? insize - inpos : block_size;
+		if (outsize - outpos < 4 + 1) return 0;
+		int res = level < 3 ? LZ4_compress_fast_continue(params->fast, inbuf + inpos, outbuf + outpos + 4, part, outsize - outpos - 4, 1)
+		                    : LZ4_compress_HC_continue(params->hc, inbuf + inpos, outbuf + outpos + 4, part, outsize - outpos - 4);
+		uint32_t block = res;
+		if (res <= 0 || (frame && (size_t)res >= part))
+		{
+			if (!frame || outsize - outpos - 4 < part) return 0;
+			memcpy(outbuf + outpos + 4, inbuf + inpos, part); // stored block, it is still the prefix of the next block
+			block = (uint32_t)part | 0x80000000U;
+			res = part;
+		}
+		memcpy(outbuf + outpos, &block, 4);
+		outpos += 4 + res;
+		inpos += part;
+	}
+
+	if (frame)
+	{
+		uint32_t end_mark = 0, checksum = lz4_xxh32((uint8_t*)inbuf, insize);
+		if (outsize - outpos < (frame == 2 ? 8 : 4)) return 0;
+		memcpy(outbuf + outpos, &end_mark, 4);
+		outpos += 4;
+		if (frame == 2) { memcpy(outbuf + outpos, &checksum, 4); outpos += 4; }
+	}
+	return outpos;
 }
 
-int64_t lzbench_lzham_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t dict_size_log, char*)
+int64_t lzbench_lz4stream_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-	lzham_uint32 comp_adler32 = 0;
-	lzham_decompress_params decomp_params;
-
-	memset(&decomp_params, 0, sizeof(decomp_params));
-	decomp_params.m_struct_size = sizeof(decomp_params);
-	decomp_params.m_dict_size_log2 = dict_size_log?dict_size_log:26;
-    
-	lzham_decompress_memory(&decomp_params, (uint8_t*)outbuf, &outsize, (const lzham_uint8 *)inbuf, insize, &comp_adler32);
-	return outsize;
+	return lz4_linked_compress(inbuf, insize, outbuf, outsize, level, workmem, 0);
 }
 
-#endif // BENCH_REMOVE_LZHAM
+int64_t lzbench_lz4frame_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+	return lz4_linked_compress(inbuf, insize, outbuf, outsize, level, workmem, 1);
+}
 
+int64_t lzbench_lz4framecrc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+	return lz4_linked_compress(inbuf, insize, outbuf, outsize, level, workmem, 2);
+}
 
+// LZ4 Frames of lz4 -c and of lz4frame: linked or independent blocks, block and content checksums are verified,
+// skippable frames and multiple frames (lz4 of concatenated files) are accepted, only dictionary IDs are not.
+// With first_bytes (--ttfb) decoding stops when outsize bytes of output exist.
+static int64_t lz4frame_decode(char *inbuf, size_t insize, char *outbuf, size_t outsize, bool first_bytes)
+{
+	LZ4_streamDecode_t stream;
+	size_t inpos = 0, outpos = 0;
+	uint32_t magic, block, checksum;
 
-#ifndef BENCH_REMOVE_LZJB
-#include "lzjb/lzjb2010.h"
+	while (inpos < insize)
+	{
+		if (insize - inpos < 8) return 0;
+		memcpy(&magic, inbuf + inpos, 4);
+		if ((magic & 0xFFFFFFF0U) == 0x184D2A50)
+		{
+			memcpy(&block, inbuf + inpos + 4, 4);
+			if (block > insize - inpos - 8) return 0;
+			inpos += 8 + block;
+			continue;
+		}
+
+		uint8_t flg = (uint8_t)inbuf[inpos + 4];
+		size_t header = 4 + 2 + ((flg & 0x08) ? 8 : 0), frame_start = outpos;
+		if (magic != 0x184D2204 || (flg & 0xC3) != 0x40 || insize - inpos < header + 1 + 4) return 0;
+		if ((uint8_t)inbuf[inpos + header] != ((lz4_xxh32((uint8_t*)inbuf + inpos + 4, header - 4) >> 8) & 0xFF)) return 0;
+		inpos += header + 1;
+
+		LZ4_setStreamDecode(&stream, NULL, 0);
+		for ( ; ; )
+		{
+			if (insize - inpos < 4) return 0;
+			memcpy(&block, inbuf + inpos, 4);
+			inpos += 4;
+			if (block == 0) break;
+
+			size_t size = block & 0x7FFFFFFFU, dsize = size;
+			if (size > insize - inpos || ((flg & 0x10) && insize - inpos - size < 4)) return 0;
+			if (block & 0x80000000U)
+			{
+				if (size > outsize - outpos && first_bytes)
+				{
+					memcpy(outbuf + outpos, inbuf + inpos, outsize - outpos);
+					return outsize;
+				}
+				if (size > outsize - outpos) return 0;
+				memcpy(outbuf + outpos, inbuf + inpos, size);
+				if (!(flg & 0x20)) LZ4_setStreamDecode(&stream, outbuf + frame_start, outpos - frame_start + size); // the stored block is the prefix of the next one
+			}
+			else if (first_bytes) // the previous blocks of the frame are right before the output
+			{
+				size_t prefix = (flg & 0x20) ? 0 : outpos - frame_start;
+				int res = LZ4_decompress_safe_partial_usingDict(inbuf + inpos, outbuf + outpos, size, outsize - outpos, outsize - outpos, outbuf + outpos - prefix, prefix);
+				if (res < 0) return 0;
+				dsize = res;
+			}
+			else
+			{
+				int res = (flg & 0x20) ? LZ4_decompress_safe(inbuf + inpos, outbuf + outpos, size, outsize - outpos)
+				                       : LZ4_decompress_safe_continue(&stream, inbuf + inpos, outbuf + outpos, size, outsize - outpos);
+				if (res < 0) return 0;
+				dsize = res;
+			}
+			if (flg & 0x10)
+			{
+				memcpy(&checksum, inbuf + inpos + size, 4);
+				if (checksum != lz4_xxh32((uint8_t*)inbuf + inpos, size)) return 0;
+				inpos += 4;
+			}
+			inpos += size;
+			outpos += dsize;
+			if (first_bytes && outpos == outsize) return outpos;
+		}
+
+		if (flg & 0x04)
+		{
+			if (insize - inpos < 4) return 0;
+			memcpy(&checksum, inbuf + inpos, 4);
+			if (checksum != lz4_xxh32((uint8_t*)outbuf + frame_start, outpos - frame_start)) return 0;
+			inpos += 4;
+		}
+	}
+	return outpos;
+}
 
-int64_t lzbench_lzjb_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+int64_t lzbench_lz4frame_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
 {
-	return lzjb_compress2010((uint8_t*)inbuf, (uint8_t*)outbuf, insize, outsize, 0); 
+	return lz4frame_decode(inbuf, insize, outbuf, outsize, false);
 }
 
-int64_t lzbench_lzjb_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_lz4frame_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
 {
-	return lzjb_decompress2010((uint8_t*)inbuf, (uint8_t*)outbuf, insize, outsize, 0);
+	return lz4frame_decode(inbuf, insize, outbuf, outsize, true);
 }
 
-#endif // BENCH_REMOVE_LZJB
-
+#endif // BENCH_REMOVE_LIBDEFLATE
 
 
-#ifndef BENCH_REMOVE_LZLIB
-#include "lzlib/lzlib.h"
 
-int64_t lzbench_lzlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+#ifndef BENCH_REMOVE_LZF
+extern "C"
 {
-  struct Lzma_options
-  {
-      int dictionary_size;		/* 4 KiB .. 512 MiB */
-      int match_len_limit;		/* 5 .. 273 */
-  };
+	#include "lzf/lzf.h"
+}
 
-  const struct Lzma_options option_mapping[10] = {
-    {   65535,  16 },		/* -0 */
-    { 1 << 20,   5 },		/* -1 */
-    { 3 << 19,   6 },		/* -2 */
+int64_t lzbench_lzf_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	if (level == 0)
+		return lzf_compress(inbuf, insize, outbuf, outsize);
+	return lzf_compress_very(inbuf, insize, outbuf, outsize);
+}
+
+int64_t lzbench_lzf_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	return lzf_decompress(inbuf, insize, outbuf, outsize);
+}
+
+#endif // BENCH_REMOVE_LZF
+
+
+
+#ifndef BENCH_REMOVE_LZFSE
+extern "C"
+{
+	#include "lzfse/lzfse.h"
+}
+
+char* lzbench_lzfse_init(size_t insize, size_t level, size_t)
+{
+    return (char*) malloc(MAX(lzfse_encode_scratch_size(), lzfse_decode_scratch_size()));
+}
+
+void lzbench_lzfse_deinit(char* workmem)
+{
+    free(workmem);
+}
+
+int64_t lzbench_lzfse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+	return lzfse_encode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+}
+
+int64_t lzbench_lzfse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	return lzfse_decode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+}
+
+
+/*
+ * lzfse_fse: the literal coder of lzfse alone, 4 interleaved FSE states of 1024 over bytes. A block is the normalized
+ * frequencies (2 bytes for each of 256 symbols), the final states, the bits of the last byte and the bitstream, which
+ * is written from the last byte of the block, padded to 4 bytes like literals of lzfse, so decoding starts with the first.
+ */
+extern "C"
+{
+    #include "lzfse/lzfse_fse.h"
+}
+
+#define LZFSE_FSE_STATES 1024
+#define LZFSE_FSE_HEADER (256 * 2 + 4 * 2 + 1)
+
+typedef struct
+{
+    fse_encoder_entry encoder[256];
+    int32_t decoder[LZFSE_FSE_STATES];
+    uint8_t symbols[ENTROPY_BLOCK + 4];
+} lzfse_fse_s;
+
+char* lzbench_lzfse_fse_init(size_t, size_t, size_t)
+{
+    return (char*) malloc(sizeof(lzfse_fse_s));
+}
+
+void lzbench_lzfse_fse_deinit(char* workmem)
+{
+    free(workmem);
+}
+
+static size_t lzfse_fse_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t, char* workmem)
+{
+    lzfse_fse_s* f = (lzfse_fse_s*) workmem;
+    uint32_t occ[256] = { 0 };
+    uint16_t freq[256];
+    size_t n = (insize + 3) & ~(size_t)3;
+
+    for (size_t i = 0; i < insize; i++) occ[in[i]]++;
+    if (occ[in[0]] == insize) { out[0] = in[0]; return 1; }
+    occ[0] += n - insize; // padding
+    fse_normalize_freq(LZFSE_FSE_STATES, 256, occ, freq);
+    fse_init_encoder_table(LZFSE_FSE_STATES, 256, freq, f->encoder);
+    memcpy(f->symbols, in, insize);
+    memset(f->symbols + insize, 0, n - insize);
+
+    if (outsize < LZFSE_FSE_HEADER + 16) return 0;
+    uint8_t *buf = out + LZFSE_FSE_HEADER, *end = out + outsize;
+    fse_out_stream stream;
+    fse_state state[4] = { 0, 0, 0, 0 };
+    fse_out_init(&stream);
+    for (size_t i = n; i > 0; )
+    {
+        if (buf + 16 > end) return 0;
+        i -= 4;
+        fse_encode(&state[3], f->encoder, &stream, f->symbols[i + 3]);
+        fse_encode(&state[2], f->encoder, &stream, f->symbols[i + 2]);
+#if !FSE_IOSTREAM_64
+        fse_out_flush(&stream, &buf);
+#endif
+        fse_encode(&state[1], f->encoder, &stream, f->symbols[i + 1]);
+        fse_encode(&state[0], f->encoder, &stream, f->symbols[i + 0]);
+        fse_out_flush(&stream, &buf);
+    }
+    fse_out_finish(&stream, &buf);
+
+    for (int k = 0; k < 256; k++) out[2 * k] = (uint8_t)freq[k], out[2 * k + 1] = (uint8_t)(freq[k] >> 8);
+    for (int k = 0; k < 4; k++) out[512 + 2 * k] = (uint8_t)state[k], out[512 + 2 * k + 1] = (uint8_t)(state[k] >> 8);
+    out[520] = (uint8_t)(-stream.accum_nbits); // [0, 7]
+    return buf - out;
+}
+
+static bool lzfse_fse_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t, char* workmem)
+{
+    lzfse_fse_s* f = (lzfse_fse_s*) workmem;
+    uint16_t freq[256];
+    fse_state state[4];
+    fse_in_stream stream;
+
+    if (insize < LZFSE_FSE_HEADER) return false;
+    for (int k = 0; k < 256; k++) freq[k] = in[2 * k] | (in[2 * k + 1] << 8);
+    for (int k = 0; k < 4; k++) state[k] = in[512 + 2 * k] | (in[512 + 2 * k + 1] << 8);
+    if (fse_check_freq(freq, 256, LZFSE_FSE_STATES) || fse_init_decoder_table(LZFSE_FSE_STATES, 256, freq, f->decoder)) return false;
+    for (int k = 0; k < 4; k++) if (state[k] >= LZFSE_FSE_STATES) return false;
+
+    const uint8_t *buf = in + insize, *start = in; // the last refills read up to 7 bytes of the header, as lzfse does
+    if (fse_in_init(&stream, -(fse_bit_count)in[520], &buf, start)) return false;
+    for (size_t i = 0; i < outsize; i += 4)
+    {
+        if (fse_in_flush(&stream, &buf, start)) return false;
+        f->symbols[i + 0] = fse_decode(&state[0], f->decoder, &stream);
+        f->symbols[i + 1] = fse_decode(&state[1], f->decoder, &stream);
+#if !FSE_IOSTREAM_64
+        if (fse_in_flush(&stream, &buf, start)) return false;
+#endif
+        f->symbols[i + 2] = fse_decode(&state[2], f->decoder, &stream);
+        f->symbols[i + 3] = fse_decode(&state[3], f->decoder, &stream);
+    }
+    memcpy(out, f->symbols, outsize);
+    return true;
+}
+
+int64_t lzbench_lzfse_fse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    return entropy_blocks_compress(lzfse_fse_encode, inbuf, insize, outbuf, outsize, 0, workmem);
+}
+
+int64_t lzbench_lzfse_fse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    return entropy_blocks_decompress(lzfse_fse_decode, inbuf, insize, outbuf, outsize, 0, workmem);
+}
+
+#endif // BENCH_REMOVE_LZFSE
+
+
+
+#ifndef BENCH_REMOVE_LZVN
+extern "C"
+{
+	#include "lzfse/lzvn.h"
+}
+
+char* lzbench_lzvn_init(size_t insize, size_t level, size_t)
+{
+    return (char*) malloc(MAX(lzvn_encode_scratch_size(), lzvn_decode_scratch_size()));
+}
+
+void lzbench_lzvn_deinit(char* workmem)
+{
+    free(workmem);
+}
+
+int64_t lzbench_lzvn_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+	return lzvn_encode_buffer((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+}
+
+int64_t lzbench_lzvn_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	return lzvn_decode_buffer_scratch((uint8_t*)outbuf, outsize, (uint8_t*)inbuf, insize, workmem);
+}
+
+#endif // BENCH_REMOVE_LZVN
+
+
+
+#ifndef BENCH_REMOVE_LZG
+#include "liblzg/lzg.h"
+
+int64_t lzbench_lzg_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+    lzg_encoder_config_t cfg;
+    cfg.level = level;
+    cfg.fast = LZG_TRUE;
+    cfg.progressfun = NULL;
+    cfg.userdata = NULL;
+    return LZG_Encode((const unsigned char*)inbuf, insize, (unsigned char*)outbuf, outsize, &cfg);
+}
+
+int64_t lzbench_lzg_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    return LZG_Decode((const unsigned char*)inbuf, insize, (unsigned char*)outbuf, outsize);
+}
+
+#endif // BENCH_REMOVE_LZG
+
+
+
+#ifndef BENCH_REMOVE_LZHAM
+#include "lzham/lzham.h"
+#include <memory.h>
+
+// lzham allocates with the counting allocator, a block is reallocated by a copy
+static void* lzham_mem_realloc(void* p, size_t size, size_t* pActual_size, lzham_bool movable, void*)
+{
+	void* p_new = NULL;
+	if (size && (!p || movable))
+	{
+		p_new = lzbench_mem_alloc(size);
+		if (p_new && p) memcpy(p_new, p, MIN(size, lzbench_mem_size(p)));
+	}
+	if (!size || p_new) lzbench_mem_free(p);
+	if (pActual_size) *pActual_size = p_new ? size : (size ? lzbench_mem_size(p) : 0);
+	return p_new;
+}
+
+static size_t lzham_mem_msize(void* p, void*)
+{
+	return lzbench_mem_size(p);
+}
+
+static struct lzbench_lzham_hooks_t
+{
+	lzbench_lzham_hooks_t() { lzham_set_memory_callbacks(lzham_mem_realloc, lzham_mem_msize, NULL); }
+} lzbench_lzham_hooks;
+
+// helper threads of lzhammt, they run the match finder and parse jobs of the compressor
+int lzbench_lzhammt_threads = 1;
+
+static void lzham_params(lzham_compress_params &comp_params, lzham_decompress_params &decomp_params, size_t level, size_t dict_size_log, int helper_threads)
+{
+	memset(&comp_params, 0, sizeof(comp_params));
+	comp_params.m_struct_size = sizeof(lzham_compress_params);
+	comp_params.m_dict_size_log2 = dict_size_log?dict_size_log:26;
+	comp_params.m_max_helper_threads = helper_threads < LZHAM_MAX_HELPER_THREADS ? helper_threads : LZHAM_MAX_HELPER_THREADS;
+	comp_params.m_level = (lzham_compress_level)level;
+
+	memset(&decomp_params, 0, sizeof(decomp_params));
+	decomp_params.m_struct_size = sizeof(decomp_params);
+	decomp_params.m_dict_size_log2 = dict_size_log?dict_size_log:26;
+	decomp_params.m_decompress_flags = LZHAM_DECOMP_FLAG_OUTPUT_UNBUFFERED; // as in lzham_decompress_memory()
+}
+
+// states are initialized once and reinitialized in every call
+typedef struct
+{
+	lzham_compress_state_ptr comp_state;
+	lzham_decompress_state_ptr decomp_state;
+	lzham_decompress_params decomp_params;
+} lzham_params_s;
+
+static char* lzham_init(size_t level, size_t dict_size_log, int helper_threads)
+{
+	lzham_compress_params comp_params;
+	if (!lzbench_context_reuse) return NULL;
+	lzham_params_s* params = (lzham_params_s*) malloc(sizeof(lzham_params_s));
+	if (!params) return NULL;
+	lzham_params(comp_params, params->decomp_params, level, dict_size_log, helper_threads);
+	params->comp_state = lzham_compress_init(&comp_params);
+	params->decomp_state = lzham_decompress_init(&params->decomp_params);
+	return (char*) params;
+}
+
+char* lzbench_lzham_init(size_t, size_t level, size_t dict_size_log)
+{
+	return lzham_init(level, dict_size_log, 0);
+}
+
+char* lzbench_lzhammt_init(size_t, size_t level, size_t dict_size_log)
+{
+	return lzham_init(level, dict_size_log, lzbench_lzhammt_threads);
+}
+
+void lzbench_lzham_deinit(char* workmem)
+{
+	lzham_params_s* params = (lzham_params_s*) workmem;
+	if (!params) return;
+	if (params->comp_state) lzham_compress_deinit(params->comp_state);
+	if (params->decomp_state) lzham_decompress_deinit(params->decomp_state);
+	free(workmem);
+}
+
+static int64_t lzham_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t dict_size_log, char* workmem, int helper_threads)
+{
+	lzham_params_s* params = (lzham_params_s*) workmem;
+	lzham_compress_params comp_params;
+	lzham_decompress_params decomp_params;
+	lzham_params(comp_params, decomp_params, level, dict_size_log, helper_threads);
+
+	lzham_compress_status_t comp_status;
+	lzham_uint32 comp_adler32 = 0;
+
+	if (params && params->comp_state && lzham_compress_reinit(params->comp_state))
+	{
+		size_t inpos = 0, outpos = 0;
+		do
+		{
+			size_t in_len = insize - inpos, out_len = outsize - outpos;
+			comp_status = lzham_compress(params->comp_state, (const lzham_uint8 *)inbuf + inpos, &in_len, (lzham_uint8 *)outbuf + outpos, &out_len, true);
+			inpos += in_len;
+			outpos += out_len;
+			if (comp_status < LZHAM_COMP_STATUS_FIRST_SUCCESS_OR_FAILURE_CODE && outpos == outsize) comp_status = LZHAM_COMP_STATUS_OUTPUT_BUF_TOO_SMALL;
+		}
+		while (comp_status < LZHAM_COMP_STATUS_FIRST_SUCCESS_OR_FAILURE_CODE);
+		outsize = outpos;
+	}
+	else
+		comp_status = lzham_compress_memory(&comp_params, (uint8_t*)outbuf, &outsize, (const lzham_uint8 *)inbuf, insize, &comp_adler32);
+
+	if (comp_status != LZHAM_COMP_STATUS_SUCCESS)
+	{
+		printf("Compression test failed with status %i!\n", comp_status);
+		return 0;
+	}
+
+	return outsize;
+}
+
+int64_t lzbench_lzham_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t dict_size_log, char* workmem)
+{
+	return lzham_compress(inbuf, insize, outbuf, outsize, level, dict_size_log, workmem, 0);
+}
+
+int64_t lzbench_lzhammt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t dict_size_log, char* workmem)
+{
+	return lzham_compress(inbuf, insize, outbuf, outsize, level, dict_size_log, workmem, lzbench_lzhammt_threads);
+}
+
+int64_t lzbench_lzham_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t dict_size_log, char* workmem)
+{
+	lzham_params_s* params = (lzham_params_s*) workmem;
+	lzham_uint32 comp_adler32 = 0;
+	lzham_compress_params comp_params;
+	lzham_decompress_params decomp_params;
+	lzham_decompress_status_t decomp_status;
+
+	if (params && params->decomp_state && lzham_decompress_reinit(params->decomp_state, &params->decomp_params))
+		decomp_status = lzham_decompress(params->decomp_state, (const lzham_uint8 *)inbuf, &insize, (lzham_uint8 *)outbuf, &outsize, true);
+	else
+	{
+		lzham_params(comp_params, decomp_params, 0, dict_size_log, 0);
+		decomp_status = lzham_decompress_memory(&decomp_params, (uint8_t*)outbuf, &outsize, (const lzham_uint8 *)inbuf, insize, &comp_adler32);
+	}
+
+	if (decomp_status != LZHAM_DECOMP_STATUS_SUCCESS) return 0;
+	return outsize;
+}
+
+#endif // BENCH_REMOVE_LZHAM
+
+
+
+#ifndef BENCH_REMOVE_LZJB
+#include "lzjb/lzjb2010.h"
+
+int64_t lzbench_lzjb_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	return lzjb_compress2010((uint8_t*)inbuf, (uint8_t*)outbuf, insize, outsize, 0); 
+}
+
+int64_t lzbench_lzjb_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	return lzjb_decompress2010((uint8_t*)inbuf, (uint8_t*)outbuf, insize, outsize, 0);
+}
+
+#endif // BENCH_REMOVE_LZJB
+
+
+
+#ifndef BENCH_REMOVE_LZLIB
+#include "lzlib/lzlib.h"
+
+int64_t lzbench_lzlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+  struct Lzma_options
+  {
+      int dictionary_size;		/* 4 KiB .. 512 MiB */
+      int match_len_limit;		/* 5 .. 273 */
+  };
+
+  const struct Lzma_options option_mapping[10] = {
+    {   65535,  16 },		/* -0 */
+    { 1 << 20,   5 },		/* -1 */
+    { 3 << 19,   6 },		/* -2 */
     { 1 << 21,   8 },		/* -3 */
     { 3 << 20,  12 },		/* -4 */
     { 1 << 22,  20 },		/* -5 */
@@ -605,15 +2361,31 @@ void SzFree(ISzAllocPtr p, void *address) { (void)p; MyFree_Tornado(address); }
 const ISzAlloc g_Alloc = { SzAlloc, SzFree };
 #endif // BENCH_REMOVE_TORNADO
 
-int64_t lzbench_lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+static void *LzmaAlloc(ISzAllocPtr p, size_t size) { (void)p; return lzbench_mem_alloc(size); }
+static void LzmaFree(ISzAllocPtr p, void *address) { (void)p; lzbench_mem_free(address); }
+static const ISzAlloc g_LzmaAlloc = { LzmaAlloc, LzmaFree };
+
+// threads = 2 enables the bt4 match finder of LzFindMt that runs in its own threads
+static int64_t lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, int threads)
 {
 	CLzmaEncProps props;
 	int res;
     size_t headerSize = LZMA_PROPS_SIZE;
 	SizeT out_len = outsize - LZMA_PROPS_SIZE;
 	
+	if (outsize <= LZMA_PROPS_SIZE) return 0;
 	LzmaEncProps_Init(&props);
 	props.level = level;
+	props.numThreads = threads;
+	if (threads > 1) {
+		props.btMode = 1;
+		props.numHashBytes = 4;
+	}
+	if (lzbench_options.dict >= 0) props.dictSize = lzbench_options.dict;
+	if (lzbench_options.lc >= 0) props.lc = lzbench_options.lc;
+	if (lzbench_options.lp >= 0) props.lp = lzbench_options.lp;
+	if (lzbench_options.pb >= 0) props.pb = lzbench_options.pb;
+	if (lzbench_options.fb >= 0) props.fb = lzbench_options.fb;
 	LzmaEncProps_Normalize(&props);
   /*
   p->level = 5;
@@ -623,14 +2395,70 @@ int64_t lzbench_lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t o
   p->writeEndMark = 0;
   */
   
-  	res = LzmaEncode((uint8_t*)outbuf+LZMA_PROPS_SIZE, &out_len, (uint8_t*)inbuf, insize, &props, (uint8_t*)outbuf, &headerSize, 0/*int writeEndMark*/, NULL, &g_Alloc, &g_Alloc);
+  	res = LzmaEncode((uint8_t*)outbuf+LZMA_PROPS_SIZE, &out_len, (uint8_t*)inbuf, insize, &props, (uint8_t*)outbuf, &headerSize, 0/*int writeEndMark*/, NULL, &g_LzmaAlloc, &g_LzmaAlloc);
 	if (res != SZ_OK) return 0;
 	
 //	printf("out_len=%u LZMA_PROPS_SIZE=%d headerSize=%d\n", (int)(out_len + LZMA_PROPS_SIZE), LZMA_PROPS_SIZE, (int)headerSize);
 	return LZMA_PROPS_SIZE + out_len;
 }
 
-int64_t lzbench_lzma_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	return lzma_compress(inbuf, insize, outbuf, outsize, level, 1);
+}
+
+// lzmamt: block threads and size in bytes of independent blocks, 0 = input split evenly between the threads
+int lzbench_lzmamt_threads = 1;
+size_t lzbench_lzmamt_block_size = 0;
+
+/*
+ * With more than one block thread the input is split into independent blocks like in Lzma2Enc, the output
+ * is the number of blocks, the block size and the compressed size of every block (32-bit) followed by the blocks.
+ */
+int64_t lzbench_lzmamt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	if (lzbench_lzmamt_threads <= 1)
+		return lzma_compress(inbuf, insize, outbuf, outsize, level, 2);
+
+	size_t block_size = lzbench_lzmamt_block_size ? lzbench_lzmamt_block_size : (insize + lzbench_lzmamt_threads - 1) / lzbench_lzmamt_threads;
+	if (block_size == 0) block_size = 1;
+	uint32_t blocks = (uint32_t)((insize + block_size - 1) / block_size), header = 4 * (2 + blocks);
+	size_t bound = block_size + block_size / 2 + 1024;
+	std::vector<char*> bufs(blocks);
+	std::vector<int64_t> sizes(blocks, 0);
+	std::atomic<uint32_t> next(0);
+	std::vector<std::thread> threads;
+
+	if (outsize < header) return 0;
+	for (uint32_t i = 0; i < blocks; i++)
+		if (!(bufs[i] = (char*)malloc(bound))) break;
+	for (int t = 0; t < lzbench_lzmamt_threads && t < (int)blocks; t++)
+		threads.push_back(std::thread([&]() {
+			for (uint32_t i; (i = next++) < blocks; )
+				if (bufs[i]) sizes[i] = lzma_compress(inbuf + i * block_size, insize - i * block_size < block_size ? insize - i * block_size : block_size, bufs[i], bound, level, 2);
+		}));
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	uint32_t value = (uint32_t)block_size;
+	size_t pos = header;
+	memcpy(outbuf, &blocks, 4);
+	memcpy(outbuf + 4, &value, 4);
+	for (uint32_t i = 0; i < blocks; i++)
+	{
+		if (pos != 0 && (sizes[i] <= 0 || pos + sizes[i] > outsize)) pos = 0;
+		if (pos != 0) {
+			value = (uint32_t)sizes[i];
+			memcpy(outbuf + 8 + 4 * i, &value, 4);
+			memcpy(outbuf + pos, bufs[i], sizes[i]);
+			pos += sizes[i];
+		}
+		free(bufs[i]);
+	}
+	return pos;
+}
+
+int64_t lzbench_lzma_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
 {
 	int res;
 	SizeT out_len = outsize;
@@ -638,13 +2466,52 @@ int64_t lzbench_lzma_decompress(char *inbuf, size_t insize, char *outbuf, size_t
 	ELzmaStatus status;
 	
 //	SRes LzmaDecode(Byte *dest, SizeT *destLen, const Byte *src, SizeT *srcLen, const Byte *propData, unsigned propSize, ELzmaFinishMode finishMode, ELzmaStatus *status, ISzAlloc *alloc)
-	res = LzmaDecode((uint8_t*)outbuf, &out_len, (uint8_t*)inbuf+LZMA_PROPS_SIZE, &src_len, (uint8_t*)inbuf, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+	res = LzmaDecode((uint8_t*)outbuf, &out_len, (uint8_t*)inbuf+LZMA_PROPS_SIZE, &src_len, (uint8_t*)inbuf, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_LzmaAlloc);
 	if (res != SZ_OK) return 0;
 	
 //	printf("out_len=%u\n", (int)(out_len + LZMA_PROPS_SIZE));	
     return out_len;
 }
 
+// blocks of lzbench_lzmamt_compress() are decoded in parallel by the same number of threads
+int64_t lzbench_lzmamt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	if (lzbench_lzmamt_threads <= 1)
+		return lzbench_lzma_decompress(inbuf, insize, outbuf, outsize, 0, 0, NULL);
+
+	uint32_t blocks, block_size;
+	if (insize < 8) return 0;
+	memcpy(&blocks, inbuf, 4);
+	memcpy(&block_size, inbuf + 4, 4);
+	if (blocks == 0 || block_size == 0 || insize < 4 * (2 + (size_t)blocks) || (size_t)blocks * block_size < outsize) return 0;
+
+	std::vector<size_t> offsets(blocks + 1);
+	std::atomic<uint32_t> next(0);
+	std::atomic<bool> error(false);
+	std::vector<std::thread> threads;
+
+	offsets[0] = 4 * (2 + (size_t)blocks);
+	for (uint32_t i = 0; i < blocks; i++)
+	{
+		uint32_t csize;
+		memcpy(&csize, inbuf + 8 + 4 * i, 4);
+		offsets[i + 1] = offsets[i] + csize;
+		if (offsets[i + 1] > insize || (size_t)i * block_size >= outsize) return 0;
+	}
+	for (int t = 0; t < lzbench_lzmamt_threads && t < (int)blocks; t++)
+		threads.push_back(std::thread([&]() {
+			for (uint32_t i; (i = next++) < blocks; )
+			{
+				size_t dsize = outsize - (size_t)i * block_size < block_size ? outsize - (size_t)i * block_size : block_size;
+				if (lzbench_lzma_decompress(inbuf + offsets[i], offsets[i + 1] - offsets[i], outbuf + (size_t)i * block_size, dsize, 0, 0, NULL) != (int64_t)dsize)
+					error = true;
+			}
+		}));
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	return error ? 0 : outsize;
+}
+
 #endif // BENCH_REMOVE_LZMA
 
 
@@ -961,6 +2828,23 @@ int64_t lzbench_lzo2a_decompress(char *inbuf, size_t insize, char *outbuf, size_
 	return decomplen; 
 }
 
+// lzo*_safe: the same streams decoded by lzo*_decompress_safe() that checks input and output bounds
+#define LZO_SAFE_DECOMPRESS(v) \
+	int64_t lzbench_##v##_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*) \
+	{ \
+		lzo_uint decomplen = outsize; \
+		if (v##_decompress_safe((uint8_t*)inbuf, insize, (uint8_t*)outbuf, &decomplen, NULL) != LZO_E_OK) return 0; \
+		return decomplen; \
+	}
+
+LZO_SAFE_DECOMPRESS(lzo1b)
+LZO_SAFE_DECOMPRESS(lzo1c)
+LZO_SAFE_DECOMPRESS(lzo1f)
+LZO_SAFE_DECOMPRESS(lzo1x)
+LZO_SAFE_DECOMPRESS(lzo1y)
+LZO_SAFE_DECOMPRESS(lzo1z)
+LZO_SAFE_DECOMPRESS(lzo2a)
+
 #endif
 
 
@@ -1232,6 +3116,11 @@ int64_t lzbench_shrinker_decompress(char *inbuf, size_t insize, char *outbuf, si
 #ifndef BENCH_REMOVE_SNAPPY
 #include "snappy/snappy.h"
 
+size_t lzbench_snappy_bound(size_t insize)
+{
+	return snappy::MaxCompressedLength(insize);
+}
+
 int64_t lzbench_snappy_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
 {
 	snappy::RawCompress(inbuf, insize, outbuf, &outsize);
@@ -1417,9 +3306,16 @@ int64_t lzbench_xpack_decompress(char *inbuf, size_t insize, char *outbuf, size_
 #ifndef BENCH_REMOVE_XZ
 #include "xz/alone.h" 
 
+// xz, xz_check and the decoder of xzmt allocate with the counting allocator, the threaded encoder of xzmt doesn't
+static struct lzbench_xz_hooks_t
+{
+    lzbench_xz_hooks_t() { xz_set_allocator(lzbench_mem_alloc, lzbench_mem_free); }
+} lzbench_xz_hooks;
+
 int64_t lzbench_xz_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
 {
-    return xz_alone_compress(inbuf, insize, outbuf, outsize, level, 0, 0);
+    const codec_options_t& o = lzbench_options;
+    return xz_alone_compress_options(inbuf, insize, outbuf, outsize, level, o.dict >= 0 ? o.dict : 0, o.lc, o.lp, o.pb, o.fb);
 }
 
 int64_t lzbench_xz_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
@@ -1427,6 +3323,109 @@ int64_t lzbench_xz_decompress(char *inbuf, size_t insize, char *outbuf, size_t o
     return xz_alone_decompress(inbuf, insize, outbuf, outsize, 0, 0, 0);
 }
 
+// --ttfb: xz writes .lzma streams, xzmt .xz streams
+int64_t lzbench_xz_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    return xz_first_bytes(inbuf, insize, outbuf, outsize, 1);
+}
+
+int64_t lzbench_xzmt_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    return xz_first_bytes(inbuf, insize, outbuf, outsize, 0);
+}
+
+// threads (set to the number of CPUs by main) and block size in bytes of xzmt, 0 = default of xz
+int lzbench_xzmt_threads = 1;
+size_t lzbench_xzmt_block_size = 0;
+
+char* lzbench_xzmt_init(size_t, size_t, size_t)
+{
+    return (char*)xz_mt_init();
+}
+
+void lzbench_xzmt_deinit(char* workmem)
+{
+    xz_mt_end(workmem);
+}
+
+int64_t lzbench_xzmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    if (!workmem) return 0;
+    return xz_mt_compress(workmem, inbuf, insize, outbuf, outsize, level, lzbench_xzmt_threads, lzbench_xzmt_block_size);
+}
+
+// the blocks of the index of a stream are decoded on lzbench_xzmt_threads threads, liblzma 5.2 has no threaded decoder
+int64_t lzbench_xzmt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    return lzbench_xzmt_decompress_threads(inbuf, insize, outbuf, outsize, lzbench_xzmt_threads);
+}
+
+int64_t lzbench_xzmt_decompress_threads(char *inbuf, size_t insize, char *outbuf, size_t outsize, int threads)
+{
+    int check;
+    size_t count = threads > 1 ? xz_stream_blocks(inbuf, insize, NULL, 0, &check) : 0;
+    if (count < 2) return xz_mt_decompress(inbuf, insize, outbuf, outsize);
+
+    std::vector<xz_block_t> blocks(count);
+    xz_stream_blocks(inbuf, insize, blocks.data(), count, &check);
+    const xz_block_t& last = blocks.back();
+    if (last.out_offset + last.out_size > outsize) return 0;
+
+    std::atomic<bool> failed(false);
+    lzbench_run_blocks(threads, (uint32_t)count, [&](uint32_t i, int) {
+        const xz_block_t& b = blocks[i];
+        if (b.in_offset + b.in_size > insize || xz_block_decompress(inbuf + b.in_offset, b.in_size, check, outbuf + b.out_offset, b.out_size) != (int64_t)b.out_size)
+            failed = true;
+    });
+    return failed ? 0 : (int64_t)(last.out_offset + last.out_size);
+}
+
+size_t lzbench_xz_blocks(char *inbuf, size_t insize)
+{
+    int check;
+    return xz_stream_blocks(inbuf, insize, NULL, 0, &check);
+}
+
+// xzcrc64 and xzsha256: single-threaded .xz streams, the lzma_check of the integrity check is additional_param
+int64_t lzbench_xzcheck_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t check, char*)
+{
+    return xz_check_compress(inbuf, insize, outbuf, outsize, level, (int)check);
+}
+
+char* lzbench_xz_stream_begin(size_t level, size_t)
+{
+    return (char*)xz_alone_stream_begin(level);
+}
+
+int64_t lzbench_xz_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+    return xz_alone_stream_code(state, inbuf, insize, outbuf, outsize, 0);
+}
+
+int64_t lzbench_xz_stream_end(char* state, char *outbuf, size_t outsize)
+{
+    int64_t res = outbuf ? xz_alone_stream_code(state, NULL, 0, outbuf, outsize, 1) : 0;
+    xz_alone_stream_end(state);
+    return res;
+}
+
+
+int64_t lzbench_crc32_xz_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint32_t crc = xz_crc32(inbuf, insize);
+    if (outsize < sizeof(crc)) return 0;
+    memcpy(outbuf, &crc, sizeof(crc));
+    return sizeof(crc);
+}
+
+int64_t lzbench_crc64_xz_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint64_t crc = xz_crc64(inbuf, insize);
+    if (outsize < sizeof(crc)) return 0;
+    memcpy(outbuf, &crc, sizeof(crc));
+    return sizeof(crc);
+}
+
 #endif // BENCH_REMOVE_XZ
 
 
@@ -1437,21 +3436,26 @@ int64_t lzbench_xz_decompress(char *inbuf, size_t insize, char *outbuf, size_t o
 int64_t lzbench_yalz77_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
 {
   lz77::compress_t compress(level, lz77::DEFAULT_BLOCKSIZE);
-  std::string compressed = compress.feed((unsigned char*)inbuf, (unsigned char*)inbuf+insize);
+  std::string compressed = compress.feed((unsigned char*)inbuf, (unsigned char*)inbuf+insize); // the API returns a string, it is copied
   if (compressed.size() > outsize) return 0;
   memcpy(outbuf, compressed.c_str(), compressed.size());
   return compressed.size();
 }
 
+// feed() would resize a std::string to the size in the header and decode into it, the header is read here
+// and the state of decompress_t points to outbuf, so nothing is cleared or copied
 int64_t lzbench_yalz77_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
 {
   lz77::decompress_t decompress;
   std::string temp;
-  decompress.feed((unsigned char*)inbuf, (unsigned char*)inbuf+insize, temp);
-  const std::string& decompressed = decompress.result();
-  if (decompressed.size() > outsize) return 0;
-  memcpy(outbuf, decompressed.c_str(), decompressed.size());
-  return decompressed.size();
+  const unsigned char *in = (unsigned char*)inbuf, *end = in + insize;
+  size_t size;
+  if (!decompress.pop_vlq_uint(in, end, size) || size > outsize) return 0;
+  decompress.out = decompress.outb = (unsigned char*)outbuf;
+  decompress.oute = decompress.outb + size;
+  decompress.state.state = lz77::decompress_t::state_t::START;
+  if (!decompress.feed(in + 1, end, temp)) return 0;
+  return size;
 }
 
 #endif // BENCH_REMOVE_YALZ77
@@ -1484,22 +3488,404 @@ int64_t lzbench_yappy_decompress(char *inbuf, size_t insize, char *outbuf, size_
 #ifndef BENCH_REMOVE_ZLIB
 #include "zlib/zlib.h"
 
-int64_t lzbench_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+static voidpf lzbench_zlib_alloc(voidpf, uInt items, uInt size) { return lzbench_mem_alloc((size_t)items * size); }
+static void lzbench_zlib_free(voidpf, voidpf address) { lzbench_mem_free(address); }
+
+// streams initialized once, deflateReset() and inflateReset() before every call
+typedef struct
+{
+	z_stream cstream, dstream;
+	bool cinit, dinit;
+} zlib_params_s;
+
+char* lzbench_zlib_init(size_t, size_t level, size_t)
+{
+	if (!lzbench_context_reuse) return NULL;
+	zlib_params_s* params = (zlib_params_s*) calloc(1, sizeof(zlib_params_s));
+	if (!params) return NULL;
+	params->cstream.zalloc = params->dstream.zalloc = lzbench_zlib_alloc;
+	params->cstream.zfree = params->dstream.zfree = lzbench_zlib_free;
+	params->cinit = deflateInit(&params->cstream, level) == Z_OK;
+	params->dinit = inflateInit(&params->dstream) == Z_OK;
+	return (char*) params;
+}
+
+void lzbench_zlib_deinit(char* workmem)
+{
+	zlib_params_s* params = (zlib_params_s*) workmem;
+	if (!params) return;
+	if (params->cinit) deflateEnd(&params->cstream);
+	if (params->dinit) inflateEnd(&params->dstream);
+	free(workmem);
+}
+
+size_t lzbench_zlib_bound(size_t insize)
+{
+	return compressBound((uLong)insize);
+}
+
+// the same as compress2() and uncompress() but with the counting allocator
+int64_t lzbench_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
 {
-	uLongf zcomplen = insize;
-	int err = compress2((uint8_t*)outbuf, &zcomplen, (uint8_t*)inbuf, insize, level);
-	if (err != Z_OK)
+	zlib_params_s* params = (zlib_params_s*) workmem;
+	z_stream local, *stream = &local;
+	if (params && params->cinit)
+	{
+		stream = &params->cstream;
+		if (deflateReset(stream) != Z_OK)
+			return 0;
+	}
+	else
+	{
+		memset(&local, 0, sizeof(local));
+		local.zalloc = lzbench_zlib_alloc;
+		local.zfree = lzbench_zlib_free;
+		if (deflateInit(&local, level) != Z_OK)
+			return 0;
+	}
+	stream->next_in = (Bytef*)inbuf;
+	stream->avail_in = (uInt)insize;
+	stream->next_out = (Bytef*)outbuf;
+	stream->avail_out = (uInt)insize;
+	int err = deflate(stream, Z_FINISH);
+	int64_t zcomplen = stream->total_out;
+	if (stream == &local) deflateEnd(&local);
+	if (err != Z_STREAM_END)
 		return 0;
 	return zcomplen;
 }
 
-int64_t lzbench_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+int64_t lzbench_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
 {
-	uLongf zdecomplen = outsize;
-	int err = uncompress((uint8_t*)outbuf, &zdecomplen, (uint8_t*)inbuf, insize); 
-	if (err != Z_OK)
+	zlib_params_s* params = (zlib_params_s*) workmem;
+	z_stream local, *stream = &local;
+	if (params && params->dinit)
+	{
+		stream = &params->dstream;
+		if (inflateReset(stream) != Z_OK)
+			return 0;
+	}
+	else
+	{
+		memset(&local, 0, sizeof(local));
+		local.zalloc = lzbench_zlib_alloc;
+		local.zfree = lzbench_zlib_free;
+		if (inflateInit(&local) != Z_OK)
+			return 0;
+	}
+	stream->next_in = (Bytef*)inbuf;
+	stream->avail_in = (uInt)insize;
+	stream->next_out = (Bytef*)outbuf;
+	stream->avail_out = (uInt)outsize;
+	int err = inflate(stream, Z_FINISH);
+	if (stream == &local) inflateEnd(&local);
+	if (err != Z_STREAM_END)
 		return 0;
-	return outsize;
+	return outsize - stream->avail_out;
+}
+
+// --ttfb: inflate() stops when outsize bytes of output exist
+int64_t lzbench_zlib_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	zlib_params_s* params = (zlib_params_s*) workmem;
+	z_stream local, *stream = &local;
+	if (params && params->dinit)
+	{
+		stream = &params->dstream;
+		if (inflateReset(stream) != Z_OK)
+			return 0;
+	}
+	else
+	{
+		memset(&local, 0, sizeof(local));
+		local.zalloc = lzbench_zlib_alloc;
+		local.zfree = lzbench_zlib_free;
+		if (inflateInit(&local) != Z_OK)
+			return 0;
+	}
+	stream->next_in = (Bytef*)inbuf;
+	stream->avail_in = (uInt)insize;
+	stream->next_out = (Bytef*)outbuf;
+	stream->avail_out = (uInt)outsize;
+	int err = inflate(stream, Z_NO_FLUSH);
+	if (stream == &local) inflateEnd(&local);
+	if (err != Z_OK && err != Z_STREAM_END)
+		return 0;
+	return outsize - stream->avail_out;
+}
+
+// gzip files of other encoders (--decompress-only), every member of a multi-member file is decompressed
+int64_t lzbench_zlib_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	z_stream stream;
+	int err;
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = lzbench_zlib_alloc;
+	stream.zfree = lzbench_zlib_free;
+	if (inflateInit2(&stream, 15 + 16) != Z_OK)
+		return 0;
+	stream.next_in = (Bytef*)inbuf;
+	stream.avail_in = (uInt)insize;
+	stream.next_out = (Bytef*)outbuf;
+	stream.avail_out = (uInt)outsize;
+	while ((err = inflate(&stream, Z_FINISH)) == Z_STREAM_END && stream.avail_in > 0)
+		if (inflateReset(&stream) != Z_OK) break;
+	inflateEnd(&stream);
+	if (err != Z_STREAM_END)
+		return 0;
+	return outsize - stream.avail_out;
+}
+
+// deflate_indexed: a gzip stream, random reads of --range-reads go through the index of lzbench_zran_build()
+int64_t lzbench_gzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = lzbench_zlib_alloc;
+	stream.zfree = lzbench_zlib_free;
+	if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return 0;
+	stream.next_in = (Bytef*)inbuf;
+	stream.avail_in = (uInt)insize;
+	stream.next_out = (Bytef*)outbuf;
+	stream.avail_out = (uInt)outsize;
+	int err = deflate(&stream, Z_FINISH);
+	int64_t complen = stream.total_out;
+	deflateEnd(&stream);
+	if (err != Z_STREAM_END)
+		return 0;
+	return complen;
+}
+
+size_t lzbench_gzip_bound(size_t insize)
+{
+	return compressBound((uLong)insize) + 12; // gzip header and trailer instead of zlib ones
+}
+
+/*
+ * --zran: access points of a gzip stream like zlib's examples/zran.c, at the first deflate block boundary after every
+ * lzbench_zran_span bytes of output. A point keeps the offsets, the bits of the input byte before the block and the
+ * 32 KB of output before it, the dictionary of a raw inflate started there.
+ */
+size_t lzbench_zran_span = 1 << 20;
+
+#define ZRAN_WINDOW 32768
+
+typedef struct
+{
+	size_t out, in; // offset of the output and first byte of the input of the block, the byte before holds bits of it
+	int bits;
+	uint8_t window[ZRAN_WINDOW];
+} zran_point_s;
+
+typedef struct
+{
+	std::vector<zran_point_s> points;
+} zran_index_s;
+
+// inflates the whole stream into out, NULL if it isn't a valid gzip stream of outsize bytes
+char* lzbench_zran_build(const char *gz, size_t gzsize, char *out, size_t outsize, size_t* index_bytes)
+{
+	zran_index_s* index = new zran_index_s;
+	z_stream stream;
+	int err = Z_OK;
+	size_t last = 0;
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = lzbench_zlib_alloc;
+	stream.zfree = lzbench_zlib_free;
+	if (inflateInit2(&stream, 15 + 16) != Z_OK) { delete index; return NULL; }
+	stream.next_in = (Bytef*)gz;
+	stream.avail_in = (uInt)gzsize;
+	stream.next_out = (Bytef*)out;
+	stream.avail_out = (uInt)outsize;
+	while (err == Z_OK || (err == Z_STREAM_END && stream.avail_in > 0))
+	{
+		if (err == Z_STREAM_END && inflateReset(&stream) != Z_OK) break; // the next member of a multi-member file
+		err = inflate(&stream, Z_BLOCK);
+		size_t totout = (char*)stream.next_out - out;
+		// at the end of the header of a block that isn't the last one
+		if (err == Z_OK && (stream.data_type & 128) && !(stream.data_type & 64) && (index->points.empty() || totout - last >= lzbench_zran_span))
+		{
+			zran_point_s point;
+			point.out = totout;
+			point.in = (const char*)stream.next_in - gz;
+			point.bits = stream.data_type & 7;
+			size_t have = MIN(totout, (size_t)ZRAN_WINDOW);
+			memcpy(point.window + ZRAN_WINDOW - have, out + totout - have, have);
+			index->points.push_back(point);
+			last = totout;
+		}
+	}
+	inflateEnd(&stream);
+	if (err != Z_STREAM_END || (char*)stream.next_out - out != (ptrdiff_t)outsize) { delete index; return NULL; }
+	*index_bytes = index->points.size() * sizeof(zran_point_s);
+	return (char*)index;
+}
+
+// len bytes of output at offset from the last access point before it, fetched and decoded = compressed and output bytes of inflate
+int64_t lzbench_zran_read(char *zran, const char *gz, size_t gzsize, size_t offset, char *out, size_t len, char* scratch, size_t* fetched, size_t* decoded)
+{
+	zran_index_s* index = (zran_index_s*)zran;
+	if (!index || index->points.empty()) return 0;
+	size_t p = std::upper_bound(index->points.begin(), index->points.end(), offset,
+		[](size_t off, const zran_point_s& point) { return off < point.out; }) - index->points.begin();
+	const zran_point_s& point = index->points[p ? p - 1 : 0];
+
+	z_stream stream;
+	int err;
+	memset(&stream, 0, sizeof(stream));
+	stream.zalloc = lzbench_zlib_alloc;
+	stream.zfree = lzbench_zlib_free;
+	if (inflateInit2(&stream, -15) != Z_OK) return 0;
+	if (point.bits) inflatePrime(&stream, point.bits, (uint8_t)gz[point.in - 1] >> (8 - point.bits));
+	size_t have = MIN(point.out, (size_t)ZRAN_WINDOW);
+	inflateSetDictionary(&stream, point.window + ZRAN_WINDOW - have, (uInt)have);
+	stream.next_in = (Bytef*)gz + point.in;
+	stream.avail_in = (uInt)(gzsize - point.in);
+
+	size_t skip = offset - point.out, got = 0;
+	do {
+		if (skip)
+		{
+			stream.next_out = (Bytef*)scratch;
+			stream.avail_out = (uInt)MIN(skip, (size_t)ZRAN_WINDOW);
+		}
+		else
+		{
+			stream.next_out = (Bytef*)out + got;
+			stream.avail_out = (uInt)(len - got);
+		}
+		uInt avail = stream.avail_out;
+		err = inflate(&stream, Z_NO_FLUSH);
+		size_t n = avail - stream.avail_out;
+		if (skip) skip -= n; else got += n;
+		if (err == Z_STREAM_END && stream.avail_in > 8 && got < len)
+		{
+			// the trailer of this member and the header of the next one
+			stream.next_in += 8;
+			stream.avail_in -= 8;
+			err = inflateReset2(&stream, 15 + 16);
+		}
+	} while (err == Z_OK && got < len);
+	*fetched = (const char*)stream.next_in - (gz + point.in);
+	*decoded = offset - point.out + got;
+	inflateEnd(&stream);
+	return got;
+}
+
+void lzbench_zran_free(char* zran)
+{
+	delete (zran_index_s*)zran;
+}
+
+// --archive: inflates a whole gzip (all members) or zlib stream, raw deflate with window_bits = -15, to a malloc() buffer
+char* lzbench_zlib_unwrap(const char *inbuf, size_t insize, int window_bits, size_t* outsize)
+{
+	z_stream stream;
+	size_t capacity = insize * 4 + 4096, inpos = 0, outpos = 0;
+	char* out = (char*) malloc(capacity);
+	int ret = Z_OK;
+
+	memset(&stream, 0, sizeof(stream));
+	if (!out || inflateInit2(&stream, window_bits ? window_bits : 15 + 32) != Z_OK) { free(out); return NULL; }
+	while (ret != Z_STREAM_END || inpos < insize)
+	{
+		if (ret == Z_STREAM_END) // the next member of gzip
+		{
+			if (window_bits < 0 || (uint8_t)inbuf[inpos] != 0x1f) break; // trailing garbage or padding
+			inflateReset(&stream);
+		}
+		if (outpos == capacity)
+		{
+			char* grown = (char*) realloc(out, capacity * 2);
+			if (!grown) { ret = Z_MEM_ERROR; break; }
+			out = grown;
+			capacity *= 2;
+		}
+		stream.next_in = (Bytef*)inbuf + inpos;
+		stream.avail_in = (uInt)std::min(insize - inpos, (size_t)1 << 30);
+		stream.next_out = (Bytef*)out + outpos;
+		stream.avail_out = (uInt)std::min(capacity - outpos, (size_t)1 << 30);
+		ret = inflate(&stream, Z_NO_FLUSH);
+		inpos = (const char*)stream.next_in - inbuf;
+		outpos = (char*)stream.next_out - out;
+		if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) break;
+		if (ret == Z_BUF_ERROR && inpos == insize) break; // truncated
+	}
+	inflateEnd(&stream);
+	if (ret != Z_STREAM_END) { free(out); return NULL; }
+	*outsize = outpos;
+	return out;
+}
+
+// streaming of --feed, a flush is Z_SYNC_FLUSH
+char* lzbench_zlib_stream_begin(size_t level, size_t)
+{
+	z_stream* stream = (z_stream*) calloc(1, sizeof(z_stream));
+	if (!stream) return NULL;
+	stream->zalloc = lzbench_zlib_alloc;
+	stream->zfree = lzbench_zlib_free;
+	if (deflateInit(stream, level) != Z_OK) { free(stream); return NULL; }
+	return (char*) stream;
+}
+
+static int64_t zlib_stream(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize, int flush)
+{
+	z_stream* stream = (z_stream*) state;
+	stream->next_in = (Bytef*)inbuf;
+	stream->avail_in = (uInt)insize;
+	stream->next_out = (Bytef*)outbuf;
+	stream->avail_out = (uInt)outsize;
+	while (1)
+	{
+		int err = deflate(stream, flush);
+		if (err == Z_STREAM_ERROR) return -1;
+		if (flush == Z_FINISH ? err == Z_STREAM_END : flush == Z_NO_FLUSH ? !stream->avail_in : stream->avail_out != 0) break;
+		if (!stream->avail_out) return -1;
+	}
+	return outsize - stream->avail_out;
+}
+
+int64_t lzbench_zlib_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+	return zlib_stream(state, inbuf, insize, outbuf, outsize, Z_NO_FLUSH);
+}
+
+int64_t lzbench_zlib_stream_flush(char* state, char *outbuf, size_t outsize)
+{
+	return zlib_stream(state, NULL, 0, outbuf, outsize, Z_SYNC_FLUSH);
+}
+
+int64_t lzbench_zlib_stream_end(char* state, char *outbuf, size_t outsize)
+{
+	int64_t res = outbuf ? zlib_stream(state, NULL, 0, outbuf, outsize, Z_FINISH) : 0;
+	deflateEnd((z_stream*) state);
+	free(state);
+	return res;
+}
+
+
+// zlib takes uInt lengths, larger chunks are hashed in parts
+int64_t lzbench_crc32_zlib_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	uLong crc = crc32(0, Z_NULL, 0);
+	for (size_t pos = 0; pos < insize; pos += 1 << 30)
+		crc = crc32(crc, (const Bytef*)inbuf + pos, (uInt)MIN(insize - pos, (size_t)1 << 30));
+	uint32_t digest = (uint32_t)crc;
+	if (outsize < sizeof(digest)) return 0;
+	memcpy(outbuf, &digest, sizeof(digest));
+	return sizeof(digest);
+}
+
+int64_t lzbench_adler32_zlib_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	uLong adler = adler32(0, Z_NULL, 0);
+	for (size_t pos = 0; pos < insize; pos += 1 << 30)
+		adler = adler32(adler, (const Bytef*)inbuf + pos, (uInt)MIN(insize - pos, (size_t)1 << 30));
+	uint32_t digest = (uint32_t)adler;
+	if (outsize < sizeof(digest)) return 0;
+	memcpy(outbuf, &digest, sizeof(digest));
+	return sizeof(digest);
 }
 
 #endif // BENCH_REMOVE_ZLIB
@@ -1574,6 +3960,179 @@ int64_t lzbench_slz_decompress(char *inbuf, size_t insize, char *outbuf, size_t
 #endif // !defined(BENCH_REMOVE_SLZ) && !defined(BENCH_REMOVE_ZLIB)
 
 
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+// pdeflate: threads (default = number of CPUs) and bytes of input of a block
+int lzbench_pdeflate_threads = 1;
+size_t lzbench_pdeflate_block_size = 128 << 10;
+
+#define PDEFLATE_HEADER 20 // gzip header with an extra field "LZ" of the size of the member
+#define PDEFLATE_TRAILER 8
+
+// a compressor, a decompressor and a raw deflate stream of zlib for every thread
+typedef struct
+{
+    std::vector<struct libdeflate_compressor*> compressors;
+    std::vector<struct libdeflate_decompressor*> decompressors;
+    std::vector<z_stream> streams;
+    int streams_init;
+} pdeflate_params_s;
+
+static void put_le32(char* p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) p[i] = (char)(v >> (8 * i));
+}
+
+static uint32_t get_le32(const char* p)
+{
+    return (uint8_t)p[0] | ((uint8_t)p[1] << 8) | ((uint8_t)p[2] << 16) | ((uint32_t)(uint8_t)p[3] << 24);
+}
+
+char* lzbench_pdeflate_init(size_t, size_t level, size_t mode)
+{
+    pdeflate_params_s* params = new pdeflate_params_s;
+    params->streams_init = 0;
+    for (int t = 0; t < lzbench_pdeflate_threads; t++)
+    {
+        params->compressors.push_back(mode ? NULL : libdeflate_alloc_compressor(level));
+        params->decompressors.push_back(libdeflate_alloc_decompressor());
+    }
+    if (mode)
+    {
+        params->streams.resize(lzbench_pdeflate_threads);
+        for (int t = 0; t < lzbench_pdeflate_threads; t++, params->streams_init++)
+        {
+            z_stream* stream = &params->streams[t];
+            memset(stream, 0, sizeof(*stream));
+            stream->zalloc = lzbench_zlib_alloc;
+            stream->zfree = lzbench_zlib_free;
+            if (deflateInit2(stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) break;
+        }
+    }
+    return (char*) params;
+}
+
+void lzbench_pdeflate_deinit(char* workmem)
+{
+    pdeflate_params_s* params = (pdeflate_params_s*) workmem;
+    if (!params) return;
+    for (size_t t = 0; t < params->compressors.size(); t++)
+    {
+        if (params->compressors[t]) libdeflate_free_compressor(params->compressors[t]);
+        if (params->decompressors[t]) libdeflate_free_decompressor(params->decompressors[t]);
+    }
+    for (int t = 0; t < params->streams_init; t++)
+        deflateEnd(&params->streams[t]);
+    delete params;
+}
+
+/*
+ * pdeflate compresses blocks of lzbench_pdeflate_block_size bytes on the threads of pdeflate with libdeflate into
+ * gzip members, concatenated they are a gzip file of RFC 1952. The size of a member in an extra field of its header
+ * (like BGZF) lets the decompression find the members and run them on the threads too.
+ * pdeflate_pigz (mode 1) compresses the blocks like pigz with zlib into a single gzip member, a block is a raw
+ * deflate stream primed with the last 32 KB of the previous block and ended by a sync flush, and the CRC-32 of the
+ * blocks are combined. The decompression of a single deflate stream runs on one thread.
+ */
+int64_t lzbench_pdeflate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t mode, char* workmem)
+{
+    pdeflate_params_s* params = (pdeflate_params_s*) workmem;
+    size_t block_size = lzbench_pdeflate_block_size;
+    uint32_t blocks = (uint32_t)((insize + block_size - 1) / block_size);
+    size_t bound = block_size + block_size / 8 + 1024; // deflate with stored blocks and flushes stays below it
+    char* tmp = (char*)malloc((size_t)(blocks ? blocks : 1) * bound);
+    std::vector<int64_t> sizes(blocks, 0);
+    std::vector<uint32_t> crcs(blocks, 0);
+
+    if (!params || !tmp || (mode && params->streams_init < lzbench_pdeflate_threads) || (!mode && !params->compressors[0])) { free(tmp); return 0; }
+    lzbench_run_blocks(lzbench_pdeflate_threads, blocks, [&](uint32_t i, int t) {
+        size_t size = MIN(block_size, insize - (size_t)i * block_size);
+        char *src = inbuf + (size_t)i * block_size, *out = tmp + (size_t)i * bound;
+        crcs[i] = libdeflate_crc32(0, src, size);
+        if (!mode)
+        {
+            size_t clen = libdeflate_deflate_compress(params->compressors[t], src, size, out + PDEFLATE_HEADER, bound - PDEFLATE_HEADER - PDEFLATE_TRAILER);
+            if (!clen) return;
+            static const char header[12] = { 0x1f, (char)0x8b, 8, 4, 0, 0, 0, 0, 0, (char)255, 8, 0 };
+            memcpy(out, header, sizeof(header));
+            out[12] = 'L', out[13] = 'Z', out[14] = 4, out[15] = 0;
+            sizes[i] = PDEFLATE_HEADER + clen + PDEFLATE_TRAILER;
+            put_le32(out + 16, (uint32_t)sizes[i]);
+            put_le32(out + PDEFLATE_HEADER + clen, crcs[i]);
+            put_le32(out + PDEFLATE_HEADER + clen + 4, (uint32_t)size);
+            return;
+        }
+        z_stream* stream = &params->streams[t];
+        if (deflateReset(stream) != Z_OK) return;
+        if (i > 0)
+        {
+            size_t dict = MIN(block_size, (size_t)32768);
+            deflateSetDictionary(stream, (const Bytef*)src - dict, (uInt)dict);
+        }
+        stream->next_in = (Bytef*)src;
+        stream->avail_in = (uInt)size;
+        stream->next_out = (Bytef*)out;
+        stream->avail_out = (uInt)bound;
+        int err = deflate(stream, (i + 1 == blocks) ? Z_FINISH : Z_SYNC_FLUSH);
+        if ((i + 1 == blocks) ? err != Z_STREAM_END : (err != Z_OK || stream->avail_in)) return;
+        sizes[i] = bound - stream->avail_out;
+    });
+
+    size_t pos = 0;
+    if (mode)
+    {
+        static const char header[10] = { 0x1f, (char)0x8b, 8, 0, 0, 0, 0, 0, 0, (char)255 };
+        if (outsize < sizeof(header) + PDEFLATE_TRAILER) { free(tmp); return 0; }
+        memcpy(outbuf, header, sizeof(header));
+        pos = sizeof(header);
+    }
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        if (sizes[i] <= 0 || pos + sizes[i] + (mode ? PDEFLATE_TRAILER : 0) > outsize) { free(tmp); return 0; }
+        memcpy(outbuf + pos, tmp + (size_t)i * bound, sizes[i]);
+        pos += sizes[i];
+        crc = i ? crc32_combine(crc, crcs[i], (z_off_t)MIN(block_size, insize - (size_t)i * block_size)) : crcs[i];
+    }
+    free(tmp);
+    if (mode)
+    {
+        put_le32(outbuf + pos, crc);
+        put_le32(outbuf + pos + 4, (uint32_t)insize);
+        pos += PDEFLATE_TRAILER;
+    }
+    return pos;
+}
+
+int64_t lzbench_pdeflate_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t mode, char* workmem)
+{
+    pdeflate_params_s* params = (pdeflate_params_s*) workmem;
+    size_t res = 0;
+    if (!params || !params->decompressors[0]) return 0;
+    if (mode)
+        return libdeflate_gzip_decompress(params->decompressors[0], inbuf, insize, outbuf, outsize, &res) == LIBDEFLATE_SUCCESS ? res : 0;
+
+    std::vector<size_t> in_offsets(1, 0), out_offsets(1, 0);
+    while (in_offsets.back() < insize)
+    {
+        const char* member = inbuf + in_offsets.back();
+        size_t left = insize - in_offsets.back(), size;
+        if (left < PDEFLATE_HEADER + PDEFLATE_TRAILER || member[12] != 'L' || member[13] != 'Z' || (size = get_le32(member + 16)) > left || size < PDEFLATE_HEADER + PDEFLATE_TRAILER) return 0;
+        in_offsets.push_back(in_offsets.back() + size);
+        out_offsets.push_back(out_offsets.back() + get_le32(member + size - 4));
+    }
+    if (out_offsets.back() != outsize) return 0;
+
+    std::atomic<bool> error(false);
+    lzbench_run_blocks(lzbench_pdeflate_threads, (uint32_t)(in_offsets.size() - 1), [&](uint32_t i, int t) {
+        size_t dlen = 0, dsize = out_offsets[i + 1] - out_offsets[i];
+        if (libdeflate_gzip_decompress(params->decompressors[t], inbuf + in_offsets[i], in_offsets[i + 1] - in_offsets[i], outbuf + out_offsets[i], dsize, &dlen) != LIBDEFLATE_SUCCESS || dlen != dsize)
+            error = true;
+    });
+    return error ? 0 : outsize;
+}
+#endif // !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+
+
 
 #ifndef BENCH_REMOVE_ZLING
 #include "libzling/libzling.h"
@@ -1581,6 +4140,8 @@ int64_t lzbench_slz_decompress(char *inbuf, size_t insize, char *outbuf, size_t
 namespace baidu {
 namespace zling {
 
+// zling encodes blocks of 16 MB of its own buffer and decodes into its ROLZ window, these copies are those of
+// any Inputter and Outputter of it
 struct MemInputter: public baidu::zling::Inputter {
 	MemInputter(uint8_t* buffer, size_t buflen) :
 		m_buffer(buffer),
@@ -1608,23 +4169,26 @@ struct MemOutputter : public baidu::zling::Outputter {
 	MemOutputter(uint8_t* buffer, size_t buflen) :
 		m_buffer(buffer),
 		m_buflen(buflen),
-        m_total_write(0) {}
+        m_total_write(0),
+        m_overflow(false) {}
 
     size_t PutData(unsigned char* buf, size_t len) {
-		if (len > m_buflen - m_total_write)
+		if (len > m_buflen - m_total_write) {
 			len = m_buflen - m_total_write;
+			m_overflow = true; // the encoder and decoder retry until IsErr()
+		}
 
 		memcpy(m_buffer + m_total_write, buf, len);
 		m_total_write += len;
 		return len;
 	}
-    bool   IsErr() { return m_total_write > m_buflen; }
+    bool   IsErr() { return m_overflow; }
     size_t GetOutputSize() { return m_total_write; }
 
 private:
-    FILE*  m_fp;
 	uint8_t* m_buffer;
 	size_t m_buflen, m_total_write;
+	bool m_overflow;
 };
 
 }  // namespace zling
@@ -1634,7 +4198,7 @@ int64_t lzbench_zling_compress(char *inbuf, size_t insize, char *outbuf, size_t
 {
 	baidu::zling::MemInputter  inputter((uint8_t*)inbuf, insize);
 	baidu::zling::MemOutputter outputter((uint8_t*)outbuf, outsize);
-	baidu::zling::Encode(&inputter, &outputter, NULL, level);
+	if (baidu::zling::Encode(&inputter, &outputter, NULL, level) != 0) return 0;
 
 	return outputter.GetOutputSize();
 }
@@ -1643,7 +4207,7 @@ int64_t lzbench_zling_decompress(char *inbuf, size_t insize, char *outbuf, size_
 {
 	baidu::zling::MemInputter  inputter((uint8_t*)inbuf, insize);
 	baidu::zling::MemOutputter outputter((uint8_t*)outbuf, outsize);
-	baidu::zling::Decode(&inputter, &outputter);
+	if (baidu::zling::Decode(&inputter, &outputter) != 0) return 0;
 
 	return outputter.GetOutputSize();
 } 
@@ -1654,33 +4218,47 @@ int64_t lzbench_zling_decompress(char *inbuf, size_t insize, char *outbuf, size_
 
 #ifndef BENCH_REMOVE_ZSTD
 #define ZSTD_STATIC_LINKING_ONLY
+#define ZSTD_DISABLE_DEPRECATE_WARNINGS // ZSTD_generateSequences() of --lz-stats
 #include "zstd/lib/zstd.h"
+#include "zstd/lib/zdict.h"
+#include "zstd/lib/common/xxhash.h"
+#include "zstd/lib/common/zstd_trace.h"
+
+static void* lzbench_zstd_alloc(void*, size_t size) { return lzbench_mem_alloc(size); }
+static void lzbench_zstd_free(void*, void* address) { lzbench_mem_free(address); }
 
 typedef struct {
     ZSTD_CCtx* cctx;
     ZSTD_DCtx* dctx;
     ZSTD_CDict* cdict;
+    ZSTD_DDict* ddict;
     ZSTD_parameters zparams;
     ZSTD_customMem cmem;
+    int checksum; // zstdcrc: frames with the XXH64 content checksum
 } zstd_params_s;
 
 char* lzbench_zstd_init(size_t insize, size_t level, size_t windowLog)
 {
     zstd_params_s* zstd_params = (zstd_params_s*) malloc(sizeof(zstd_params_s));
     if (!zstd_params) return NULL;
-    zstd_params->cctx = ZSTD_createCCtx();
-    zstd_params->dctx = ZSTD_createDCtx();
-#if 1
+    zstd_params->cmem = { lzbench_zstd_alloc, lzbench_zstd_free, NULL };
+    zstd_params->cctx = ZSTD_createCCtx_advanced(zstd_params->cmem);
+    zstd_params->dctx = ZSTD_createDCtx_advanced(zstd_params->cmem);
     zstd_params->cdict = NULL;
-#else
-    zstd_params->zparams = ZSTD_getParams(level, insize, 0);
-    zstd_params->cmem = { NULL, NULL, NULL };
-    if (windowLog && zstd_params->zparams.cParams.windowLog > windowLog) {
-        zstd_params->zparams.cParams.windowLog = windowLog;
-        zstd_params->zparams.cParams.chainLog = windowLog + ((zstd_params->zparams.cParams.strategy == ZSTD_btlazy2) | (zstd_params->zparams.cParams.strategy == ZSTD_btopt) | (zstd_params->zparams.cParams.strategy == ZSTD_btopt2));
+    zstd_params->ddict = NULL;
+    zstd_params->checksum = 0;
+    if (zstd_params->dctx && lzbench_options.wlog > ZSTD_WINDOWLOG_LIMIT_DEFAULT)
+        ZSTD_DCtx_setParameter(zstd_params->dctx, ZSTD_d_windowLogMax, lzbench_options.wlog);
+    if (lzbench_dict)
+    {
+        zstd_params->zparams = ZSTD_getParams(level, insize, lzbench_dict_size);
+        if (windowLog && zstd_params->zparams.cParams.windowLog > windowLog) {
+            zstd_params->zparams.cParams.windowLog = windowLog;
+            zstd_params->zparams.cParams.chainLog = windowLog + ((zstd_params->zparams.cParams.strategy == ZSTD_btlazy2) || (zstd_params->zparams.cParams.strategy == ZSTD_btopt) || (zstd_params->zparams.cParams.strategy == ZSTD_btultra));
+        }
+        zstd_params->cdict = ZSTD_createCDict_advanced(lzbench_dict, lzbench_dict_size, ZSTD_dlm_byRef, ZSTD_dct_auto, zstd_params->zparams.cParams, zstd_params->cmem);
+        zstd_params->ddict = ZSTD_createDDict_advanced(lzbench_dict, lzbench_dict_size, ZSTD_dlm_byRef, ZSTD_dct_auto, zstd_params->cmem);
     }
-    zstd_params->cdict = ZSTD_createCDict_advanced(NULL, 0, zstd_params->zparams, zstd_params->cmem);
-#endif
 
     return (char*) zstd_params;
 }
@@ -1692,60 +4270,559 @@ void lzbench_zstd_deinit(char* workmem)
     if (zstd_params->cctx) ZSTD_freeCCtx(zstd_params->cctx);
     if (zstd_params->dctx) ZSTD_freeDCtx(zstd_params->dctx);
     if (zstd_params->cdict) ZSTD_freeCDict(zstd_params->cdict);
+    if (zstd_params->ddict) ZSTD_freeDDict(zstd_params->ddict);
     free(workmem);
 }
 
-int64_t lzbench_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+size_t lzbench_zstd_bound(size_t insize)
 {
-    size_t res;
-
-    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
-    if (!zstd_params || !zstd_params->cctx) return 0;
+    return ZSTD_compressBound(insize);
+}
 
-#if 1
+// zparams of a chunk of insize bytes with the -O options of lzbench_options
+static void lzbench_zstd_set_params(zstd_params_s* zstd_params, size_t level, size_t insize, size_t windowLog)
+{
     zstd_params->zparams = ZSTD_getParams(level, insize, 0);
     ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_compressionLevel, level);
     zstd_params->zparams.fParams.contentSizeFlag = 1;
+    zstd_params->zparams.fParams.checksumFlag = zstd_params->checksum;
 
     if (windowLog && zstd_params->zparams.cParams.windowLog > windowLog) {
         zstd_params->zparams.cParams.windowLog = windowLog;
         zstd_params->zparams.cParams.chainLog = windowLog + ((zstd_params->zparams.cParams.strategy == ZSTD_btlazy2) || (zstd_params->zparams.cParams.strategy == ZSTD_btopt) || (zstd_params->zparams.cParams.strategy == ZSTD_btultra));
     }
-    res = ZSTD_compress_advanced(zstd_params->cctx, outbuf, outsize, inbuf, insize, NULL, 0, zstd_params->zparams);
-//    res = ZSTD_compressCCtx(zstd_params->cctx, outbuf, outsize, inbuf, insize, level);
-#else
-    if (!zstd_params->cdict) return 0;
-    res = ZSTD_compress_usingCDict(zstd_params->cctx, outbuf, outsize, inbuf, insize, zstd_params->cdict);
-#endif
+    ZSTD_compressionParameters& cp = zstd_params->zparams.cParams;
+    if (lzbench_options.wlog >= 0) cp.windowLog = lzbench_options.wlog;
+    if (lzbench_options.clog >= 0) cp.chainLog = lzbench_options.clog;
+    if (lzbench_options.hlog >= 0) cp.hashLog = lzbench_options.hlog;
+    if (lzbench_options.slog >= 0) cp.searchLog = lzbench_options.slog;
+    if (lzbench_options.mml >= 0) cp.minMatch = lzbench_options.mml;
+    if (lzbench_options.tlen >= 0) cp.targetLength = lzbench_options.tlen;
+    if (lzbench_options.strategy >= 0) cp.strategy = (ZSTD_strategy)lzbench_options.strategy;
+}
+
+int64_t lzbench_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+    size_t res;
+
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->cctx) return 0;
+
+    if (zstd_params->cdict)
+        res = ZSTD_compress_usingCDict(zstd_params->cctx, outbuf, outsize, inbuf, insize, zstd_params->cdict);
+    else
+    {
+        lzbench_zstd_set_params(zstd_params, level, insize, windowLog);
+        res = ZSTD_compress_advanced(zstd_params->cctx, outbuf, outsize, inbuf, insize, NULL, 0, zstd_params->zparams);
+//        res = ZSTD_compressCCtx(zstd_params->cctx, outbuf, outsize, inbuf, insize, level);
+    }
     if (ZSTD_isError(res)) return res;
 
     return res;
 }
 
-int64_t lzbench_zstd_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+size_t lzbench_zstd_sequence_bound(size_t insize)
 {
-    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
-    if (!zstd_params || !zstd_params->dctx) return 0;
-
-    return ZSTD_decompressDCtx(zstd_params->dctx, outbuf, outsize, inbuf, insize);
+    return ZSTD_sequenceBound(insize);
 }
 
-char* lzbench_zstd_LDM_init(size_t insize, size_t level, size_t windowLog)
+/*
+ * --zstd-trace: the weak hooks of zstd_trace.h. A frame is timed from ZSTD_trace_compress_begin() to
+ * ZSTD_trace_compress_end() and the stages of its blocks from ZSTD_trace_compress_stage(), the remainder of a
+ * frame is its setup, headers and raw or RLE blocks. Without the option begin() returns 0 and zstd skips the rest.
+ */
+int lzbench_zstd_trace = 0;
+static std::atomic<uint64_t> zstd_trace_counters[ZSTD_TRACE_COUNTERS];
+static thread_local uint64_t zstd_trace_last, zstd_trace_stages[ZSTD_trace_stage_sequences + 1];
+static thread_local bool zstd_trace_active = false;
+
+static uint64_t zstd_trace_now()
 {
-    zstd_params_s* zstd_params = (zstd_params_s*) lzbench_zstd_init(insize, level, windowLog);
-    if (!zstd_params) return NULL;
-    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_enableLongDistanceMatching, 1);
-    return (char*) zstd_params;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-int64_t lzbench_zstd_LDM_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+extern "C" ZSTD_TraceCtx ZSTD_trace_compress_begin(struct ZSTD_CCtx_s const*)
 {
-    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
-    if (!zstd_params || !zstd_params->cctx) return 0;
-    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_enableLongDistanceMatching, 1);
-    return lzbench_zstd_compress(inbuf, insize, outbuf, outsize, level, windowLog, (char*) zstd_params);
+    if (!lzbench_zstd_trace) return 0;
+    memset(zstd_trace_stages, 0, sizeof(zstd_trace_stages));
+    zstd_trace_active = true;
+    zstd_trace_last = zstd_trace_now();
+    return zstd_trace_last | 1;
 }
-#endif // BENCH_REMOVE_ZSTD
+
+extern "C" void ZSTD_trace_compress_stage(ZSTD_TraceStage stage)
+{
+    if (!zstd_trace_active) return;
+    uint64_t now = zstd_trace_now();
+    zstd_trace_stages[stage] += now - zstd_trace_last;
+    zstd_trace_last = now;
+}
+
+extern "C" void ZSTD_trace_compress_end(ZSTD_TraceCtx ctx, ZSTD_Trace const*)
+{
+    zstd_trace_active = false;
+    zstd_trace_counters[0] += 1;
+    zstd_trace_counters[1] += zstd_trace_now() - ctx;
+    for (int k = ZSTD_trace_stage_match; k <= ZSTD_trace_stage_sequences; k++)
+        zstd_trace_counters[k + 1] += zstd_trace_stages[k];
+}
+
+void lzbench_zstd_trace_timing(uint64_t* counters)
+{
+    for (int k = 0; k < ZSTD_TRACE_COUNTERS; k++)
+        counters[k] += zstd_trace_counters[k].exchange(0);
+}
+
+// --tune: windowLog, chainLog, hashLog, searchLog, minMatch, targetLength and strategy of a level for insize bytes
+void lzbench_zstd_cparams(size_t level, size_t insize, int* cparams)
+{
+    ZSTD_compressionParameters cp = ZSTD_getCParams(level, insize, 0);
+    cparams[0] = cp.windowLog;
+    cparams[1] = cp.chainLog;
+    cparams[2] = cp.hashLog;
+    cparams[3] = cp.searchLog;
+    cparams[4] = cp.minMatch;
+    cparams[5] = cp.targetLength;
+    cparams[6] = cp.strategy;
+}
+
+// --lz-stats: the parse of lzbench_zstd_compress() as (literals, match length, offset), the last literals of a block have no match
+int64_t lzbench_zstd_sequences(char *inbuf, size_t insize, size_t level, size_t windowLog, uint32_t *seqs, size_t capacity)
+{
+    zstd_params_s zstd_params;
+    size_t bound = ZSTD_sequenceBound(insize);
+    ZSTD_Sequence* zseqs = (ZSTD_Sequence*) malloc(bound * sizeof(ZSTD_Sequence));
+    int64_t n = -1;
+
+    zstd_params.cctx = ZSTD_createCCtx();
+    zstd_params.checksum = 0;
+    if (zseqs && zstd_params.cctx)
+    {
+        lzbench_zstd_set_params(&zstd_params, level, insize, windowLog);
+        ZSTD_compressionParameters& cp = zstd_params.zparams.cParams;
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_windowLog, cp.windowLog);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_chainLog, cp.chainLog);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_hashLog, cp.hashLog);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_searchLog, cp.searchLog);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_minMatch, cp.minMatch);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_targetLength, cp.targetLength);
+        ZSTD_CCtx_setParameter(zstd_params.cctx, ZSTD_c_strategy, cp.strategy);
+        size_t res = ZSTD_generateSequences(zstd_params.cctx, zseqs, bound, inbuf, insize);
+        if (!ZSTD_isError(res) && res <= capacity)
+        {
+            for (size_t i = 0; i < res; i++)
+            {
+                seqs[3*i] = zseqs[i].litLength;
+                seqs[3*i+1] = zseqs[i].matchLength;
+                seqs[3*i+2] = zseqs[i].matchLength ? zseqs[i].offset : 0;
+            }
+            n = res;
+        }
+    }
+    if (zstd_params.cctx) ZSTD_freeCCtx(zstd_params.cctx);
+    free(zseqs);
+    return n;
+}
+
+int64_t lzbench_zstd_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->dctx) return 0;
+
+    if (zstd_params->ddict)
+        return ZSTD_decompress_usingDDict(zstd_params->dctx, outbuf, outsize, inbuf, insize, zstd_params->ddict);
+    return ZSTD_decompressDCtx(zstd_params->dctx, outbuf, outsize, inbuf, insize);
+}
+
+// --ttfb: ZSTD_decompressStream() until outsize bytes of output exist, frames after the first are decoded too
+int64_t lzbench_zstd_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->dctx) return 0;
+
+    ZSTD_inBuffer input = { inbuf, insize, 0 };
+    ZSTD_outBuffer output = { outbuf, outsize, 0 };
+    ZSTD_DCtx_reset(zstd_params->dctx, ZSTD_reset_session_only);
+    if (zstd_params->ddict) ZSTD_DCtx_refDDict(zstd_params->dctx, zstd_params->ddict);
+    while (output.pos < output.size && input.pos < input.size)
+        if (ZSTD_isError(ZSTD_decompressStream(zstd_params->dctx, &output, &input))) return 0;
+    return output.pos;
+}
+
+// one CCtx for the whole batch, the parameters are set once for the first (the largest) chunk
+int64_t lzbench_zstd_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t windowLog, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->cctx) return -1;
+
+    if (!zstd_params->cdict && n) lzbench_zstd_set_params(zstd_params, level, insize[0], windowLog);
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t res = zstd_params->cdict ? ZSTD_compress_usingCDict(zstd_params->cctx, out[i], outsize[i], in[i], insize[i], zstd_params->cdict)
+                                        : ZSTD_compress_advanced(zstd_params->cctx, out[i], outsize[i], in[i], insize[i], NULL, 0, zstd_params->zparams);
+        sizes[i] = ZSTD_isError(res) ? -1 : (int64_t)res;
+    }
+    return 0;
+}
+
+int64_t lzbench_zstd_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->dctx) return -1;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        size_t res = zstd_params->ddict ? ZSTD_decompress_usingDDict(zstd_params->dctx, out[i], outsize[i], in[i], insize[i], zstd_params->ddict)
+                                        : ZSTD_decompressDCtx(zstd_params->dctx, out[i], outsize[i], in[i], insize[i]);
+        sizes[i] = ZSTD_isError(res) ? -1 : (int64_t)res;
+    }
+    return 0;
+}
+
+// --inplace: ZSTD_decompressionMargin() reads the block sizes of the frames, it's exact for every chunk
+int64_t lzbench_zstd_inplace_margin(char *inbuf, size_t insize, size_t)
+{
+    size_t margin = ZSTD_decompressionMargin(inbuf, insize);
+    return ZSTD_isError(margin) ? -1 : (int64_t)margin;
+}
+
+/*
+ * zstd_delta: a chunk is compressed against the reference of --delta (lzbench_dict) given to ZSTD_CCtx_refPrefix(),
+ * like zstd --patch-from, the window covers the reference and the chunk and long distance matching is on
+ */
+char* lzbench_zstd_delta_init(size_t, size_t, size_t)
+{
+    if (!lzbench_dict) return NULL;
+    zstd_params_s* zstd_params = (zstd_params_s*) calloc(1, sizeof(zstd_params_s));
+    if (!zstd_params) return NULL;
+    zstd_params->cmem = { lzbench_zstd_alloc, lzbench_zstd_free, NULL };
+    zstd_params->cctx = ZSTD_createCCtx_advanced(zstd_params->cmem);
+    zstd_params->dctx = ZSTD_createDCtx_advanced(zstd_params->cmem);
+    if (zstd_params->dctx) ZSTD_DCtx_setParameter(zstd_params->dctx, ZSTD_d_windowLogMax, ZSTD_WINDOWLOG_MAX);
+    return (char*) zstd_params;
+}
+
+int64_t lzbench_zstd_delta_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->cctx) return 0;
+
+    int windowLog = ZSTD_WINDOWLOG_MIN;
+    while (windowLog < ZSTD_WINDOWLOG_MAX && ((size_t)1 << windowLog) < lzbench_dict_size + insize) windowLog++;
+    ZSTD_CCtx_reset(zstd_params->cctx, ZSTD_reset_session_and_parameters);
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_windowLog, windowLog);
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_enableLongDistanceMatching, 1);
+    ZSTD_CCtx_refPrefix(zstd_params->cctx, lzbench_dict, lzbench_dict_size);
+    size_t res = ZSTD_compress2(zstd_params->cctx, outbuf, outsize, inbuf, insize);
+    if (ZSTD_isError(res)) return 0;
+    return res;
+}
+
+int64_t lzbench_zstd_delta_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->dctx) return 0;
+
+    ZSTD_DCtx_reset(zstd_params->dctx, ZSTD_reset_session_only);
+    ZSTD_DCtx_refPrefix(zstd_params->dctx, lzbench_dict, lzbench_dict_size);
+    size_t res = ZSTD_decompressDCtx(zstd_params->dctx, outbuf, outsize, inbuf, insize);
+    if (ZSTD_isError(res)) return 0;
+    return res;
+}
+
+// --dict: ZDICT_trainFromBuffer() of contiguous samples, returns the size of the dictionary or 0
+size_t lzbench_zstd_train_dict(char* dict, size_t capacity, const char* samples, const size_t* sizes, unsigned count)
+{
+    size_t res = ZDICT_trainFromBuffer(dict, capacity, samples, sizes, count);
+    if (ZDICT_isError(res)) { printf("Dictionary training failed: %s\n", ZDICT_getErrorName(res)); return 0; }
+    return res;
+}
+
+// --archive: decompresses all frames of a .zst file to a malloc() buffer
+char* lzbench_zstd_unwrap(const char *inbuf, size_t insize, size_t* outsize)
+{
+    unsigned long long content = ZSTD_getFrameContentSize(inbuf, insize);
+    size_t capacity = (content != ZSTD_CONTENTSIZE_UNKNOWN && content != ZSTD_CONTENTSIZE_ERROR) ? (size_t)content + 4096 : insize * 4 + 4096;
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    char* out = (char*) malloc(capacity);
+    ZSTD_inBuffer input = { inbuf, insize, 0 };
+    ZSTD_outBuffer output = { out, capacity, 0 };
+    size_t ret = 1;
+
+    if (!dctx || !out) { ZSTD_freeDCtx(dctx); free(out); return NULL; }
+    ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax, ZSTD_WINDOWLOG_MAX); // --long frames of zstd -T0
+    while (input.pos < input.size || output.pos == output.size)
+    {
+        if (output.pos == output.size)
+        {
+            char* grown = (char*) realloc(out, capacity * 2);
+            if (!grown) { ret = 1; break; }
+            out = grown;
+            capacity *= 2;
+            output.dst = out;
+            output.size = capacity;
+        }
+        size_t before = input.pos + output.pos;
+        ret = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(ret) || (ret && input.pos + output.pos == before)) break;
+    }
+    ZSTD_freeDCtx(dctx);
+    if (ZSTD_isError(ret) || ret != 0) { free(out); return NULL; }
+    *outsize = output.pos;
+    return out;
+}
+
+// streaming of --feed, a flush ends the current block
+char* lzbench_zstd_stream_begin(size_t level, size_t windowLog)
+{
+    ZSTD_customMem cmem = { lzbench_zstd_alloc, lzbench_zstd_free, NULL };
+    ZSTD_CCtx* cctx = ZSTD_createCCtx_advanced(cmem);
+    if (!cctx) return NULL;
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, (int)level);
+    if (windowLog) ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, (int)windowLog);
+    return (char*)cctx;
+}
+
+static int64_t zstd_stream(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize, ZSTD_EndDirective op)
+{
+    ZSTD_inBuffer input = { inbuf, insize, 0 };
+    ZSTD_outBuffer output = { outbuf, outsize, 0 };
+
+    while (1)
+    {
+        size_t ret = ZSTD_compressStream2((ZSTD_CCtx*)state, &output, &input, op);
+        if (ZSTD_isError(ret)) return -1;
+        if (op == ZSTD_e_continue ? input.pos == input.size : ret == 0) break;
+        if (output.pos == output.size) return -1;
+    }
+    return output.pos;
+}
+
+int64_t lzbench_zstd_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+    return zstd_stream(state, inbuf, insize, outbuf, outsize, ZSTD_e_continue);
+}
+
+int64_t lzbench_zstd_stream_flush(char* state, char *outbuf, size_t outsize)
+{
+    return zstd_stream(state, NULL, 0, outbuf, outsize, ZSTD_e_flush);
+}
+
+int64_t lzbench_zstd_stream_end(char* state, char *outbuf, size_t outsize)
+{
+    int64_t res = outbuf ? zstd_stream(state, NULL, 0, outbuf, outsize, ZSTD_e_end) : 0;
+    ZSTD_freeCCtx((ZSTD_CCtx*)state);
+    return res;
+}
+
+// workers, job size in bytes and overlap log of zstdmt, 0 = default of zstd
+int lzbench_zstdmt_workers = 4;
+size_t lzbench_zstdmt_job_size = 0;
+int lzbench_zstdmt_overlap = 0;
+
+char* lzbench_zstdmt_init(size_t insize, size_t level, size_t windowLog)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) lzbench_zstd_init(insize, level, windowLog);
+    if (!zstd_params || !zstd_params->cctx) return (char*) zstd_params;
+    if (ZSTD_isError(ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_nbWorkers, lzbench_zstdmt_workers)))
+        printf("zstdmt: ZSTD_c_nbWorkers=%d is not supported, zstd was built without ZSTD_MULTITHREAD\n", lzbench_zstdmt_workers);
+    if (lzbench_zstdmt_job_size) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_jobSize, (int)lzbench_zstdmt_job_size);
+    if (lzbench_zstdmt_overlap) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_overlapLog, lzbench_zstdmt_overlap);
+    return (char*) zstd_params;
+}
+
+// ZSTD_compress2() uses the workers set by ZSTD_c_nbWorkers, ZSTD_compress_advanced() is single-threaded
+int64_t lzbench_zstdmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->cctx) return 0;
+
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_compressionLevel, (int)level);
+    if (windowLog) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_windowLog, (int)windowLog);
+    if (lzbench_options.wlog >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_windowLog, lzbench_options.wlog);
+    if (lzbench_options.clog >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_chainLog, lzbench_options.clog);
+    if (lzbench_options.hlog >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_hashLog, lzbench_options.hlog);
+    if (lzbench_options.slog >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_searchLog, lzbench_options.slog);
+    if (lzbench_options.mml >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_minMatch, lzbench_options.mml);
+    if (lzbench_options.tlen >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_targetLength, lzbench_options.tlen);
+    if (lzbench_options.strategy >= 0) ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_strategy, lzbench_options.strategy);
+    size_t res = ZSTD_compress2(zstd_params->cctx, outbuf, outsize, inbuf, insize);
+    if (ZSTD_isError(res)) return 0;
+    return res;
+}
+
+char* lzbench_zstd_LDM_init(size_t insize, size_t level, size_t windowLog)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) lzbench_zstd_init(insize, level, windowLog);
+    if (!zstd_params) return NULL;
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_enableLongDistanceMatching, 1);
+    return (char*) zstd_params;
+}
+
+char* lzbench_zstdcrc_init(size_t insize, size_t level, size_t windowLog)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) lzbench_zstd_init(insize, level, windowLog);
+    if (zstd_params) zstd_params->checksum = 1; // written by the compressor and verified by ZSTD_decompressDCtx()
+    return (char*) zstd_params;
+}
+
+int64_t lzbench_zstd_LDM_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+    zstd_params_s* zstd_params = (zstd_params_s*) workmem;
+    if (!zstd_params || !zstd_params->cctx) return 0;
+    ZSTD_CCtx_setParameter(zstd_params->cctx, ZSTD_c_enableLongDistanceMatching, 1);
+    return lzbench_zstd_compress(inbuf, insize, outbuf, outsize, level, windowLog, (char*) zstd_params);
+}
+
+/*
+ * zstd seekable format: independent frames of lzbench_options.frame bytes of input and a seek table with the
+ * compressed and decompressed size of every frame in a skippable frame at the end, so a range of the input is read
+ * by decompressing only the frames that cover it. ZSTD_decompressDCtx() decodes all frames and skips the table.
+ */
+static void write_le32(char* p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++) p[i] = (char)(v >> (8 * i));
+}
+
+int64_t lzbench_zstd_seekable_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t windowLog, char* workmem)
+{
+    size_t frame = lzbench_options.frame > 0 ? lzbench_options.frame : ZSTD_SEEKABLE_FRAME;
+    size_t frames = (insize + frame - 1) / frame, table = 8 + frames * 8 + ZSTD_SEEKABLE_FOOTER, outpos = 0;
+    std::vector<uint32_t> sizes;
+
+    if (outsize < table) return 0;
+    for (size_t pos = 0; pos < insize; pos += frame)
+    {
+        int64_t res = lzbench_zstd_compress(inbuf + pos, MIN(frame, insize - pos), outbuf + outpos, outsize - table - outpos, level, windowLog, workmem);
+        if (res <= 0) return 0;
+        sizes.push_back((uint32_t)res);
+        outpos += res;
+    }
+
+    char* p = outbuf + outpos;
+    write_le32(p, ZSTD_MAGIC_SKIPPABLE_START | 0xE);
+    write_le32(p + 4, (uint32_t)(table - 8));
+    for (size_t i = 0; i < frames; i++)
+    {
+        write_le32(p + 8 + i * 8, sizes[i]);
+        write_le32(p + 12 + i * 8, (uint32_t)MIN(frame, insize - i * frame));
+    }
+    p += 8 + frames * 8;
+    write_le32(p, (uint32_t)frames);
+    p[4] = 0; // no checksums of frames
+    write_le32(p + 5, ZSTD_SEEKABLE_MAGIC);
+    return outpos + table;
+}
+
+// xxHash of zstd (its content checksum), the bundled copy is built with XXH_NO_XXH3
+int64_t lzbench_xxh32_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint32_t h = XXH32(inbuf, insize, 0);
+    if (outsize < sizeof(h)) return 0;
+    memcpy(outbuf, &h, sizeof(h));
+    return sizeof(h);
+}
+
+int64_t lzbench_xxh64_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    uint64_t h = XXH64(inbuf, insize, 0);
+    if (outsize < sizeof(h)) return 0;
+    memcpy(outbuf, &h, sizeof(h));
+    return sizeof(h);
+}
+
+/* huff0_1x, huff0_4x and fse: the entropy stages of zstd alone, on blocks of ENTROPY_BLOCK bytes */
+extern "C"
+{
+    #define FSE_STATIC_LINKING_ONLY
+    #include "zstd/lib/common/huf.h"
+    #include "zstd/lib/compress/hist.h"
+}
+
+typedef struct
+{
+    HUF_CElt ctable[HUF_CTABLE_SIZE_ST(HUF_SYMBOLVALUE_MAX)];
+    U64 cwksp[HUF_WORKSPACE_SIZE_U64];
+    HUF_DTable dtable[HUF_DTABLE_SIZE(HUF_TABLELOG_MAX)];
+    U32 dwksp[HUF_DECOMPRESS_WORKSPACE_SIZE_U32];
+    FSE_CTable fse_ctable[FSE_CTABLE_SIZE_U32(FSE_MAX_TABLELOG, FSE_MAX_SYMBOL_VALUE)];
+    U32 fse_wksp[MAX(FSE_BUILD_CTABLE_WORKSPACE_SIZE(FSE_MAX_SYMBOL_VALUE, FSE_MAX_TABLELOG), FSE_DECOMPRESS_WKSP_SIZE(FSE_MAX_TABLELOG, FSE_MAX_SYMBOL_VALUE)) / sizeof(U32)];
+} zstd_entropy_s;
+
+char* lzbench_zstd_entropy_init(size_t, size_t, size_t)
+{
+    return (char*) malloc(sizeof(zstd_entropy_s));
+}
+
+void lzbench_zstd_entropy_deinit(char* workmem)
+{
+    free(workmem);
+}
+
+// streams = 1 or 4 of HUF_compress1X and HUF_compress4X
+static size_t huff0_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t streams, char* workmem)
+{
+    zstd_entropy_s* e = (zstd_entropy_s*) workmem;
+    HUF_repeat repeat = HUF_repeat_none;
+    size_t len = (streams == 1 ? HUF_compress1X_repeat : HUF_compress4X_repeat)(out, outsize, in, insize, HUF_SYMBOLVALUE_MAX, HUF_TABLELOG_DEFAULT,
+        e->cwksp, sizeof(e->cwksp), e->ctable, &repeat, 0);
+    return HUF_isError(len) ? 0 : len;
+}
+
+static bool huff0_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t streams, char* workmem)
+{
+    zstd_entropy_s* e = (zstd_entropy_s*) workmem;
+    e->dtable[0] = (U32)HUF_TABLELOG_MAX * 0x01000001;
+    size_t len = (streams == 1 ? HUF_decompress1X_DCtx_wksp : HUF_decompress4X_hufOnly_wksp)(e->dtable, out, outsize, in, insize, e->dwksp, sizeof(e->dwksp), 0);
+    return len == outsize;
+}
+
+int64_t lzbench_huff0_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t streams, char* workmem)
+{
+    return entropy_blocks_compress(huff0_encode, inbuf, insize, outbuf, outsize, streams, workmem);
+}
+
+int64_t lzbench_huff0_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t streams, char* workmem)
+{
+    return entropy_blocks_decompress(huff0_decode, inbuf, insize, outbuf, outsize, streams, workmem);
+}
+
+// what FSE_compress() of older zstd did: normalized counts of FSE_writeNCount() and the bitstream of FSE_compress_usingCTable()
+static size_t fse_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t, char* workmem)
+{
+    zstd_entropy_s* e = (zstd_entropy_s*) workmem;
+    unsigned count[FSE_MAX_SYMBOL_VALUE + 1], max_symbol = FSE_MAX_SYMBOL_VALUE;
+    short norm[FSE_MAX_SYMBOL_VALUE + 1];
+
+    unsigned largest = HIST_count_simple(count, &max_symbol, in, insize);
+    if (largest == insize) { out[0] = in[0]; return 1; }
+    if (largest <= (insize >> 7) + 4) return 0; // not compressible
+    unsigned log = FSE_optimalTableLog(FSE_DEFAULT_TABLELOG, insize, max_symbol);
+    if (FSE_isError(FSE_normalizeCount(norm, log, count, insize, max_symbol, insize >= 2048))) return 0;
+    size_t header = FSE_writeNCount(out, outsize, norm, max_symbol, log);
+    if (FSE_isError(header) || FSE_isError(FSE_buildCTable_wksp(e->fse_ctable, norm, max_symbol, log, e->fse_wksp, sizeof(e->fse_wksp)))) return 0;
+    size_t len = FSE_compress_usingCTable(out + header, outsize - header, in, insize, e->fse_ctable);
+    return (FSE_isError(len) || len == 0) ? 0 : header + len;
+}
+
+static bool fse_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t, char* workmem)
+{
+    zstd_entropy_s* e = (zstd_entropy_s*) workmem;
+    return FSE_decompress_wksp_bmi2(out, outsize, in, insize, FSE_MAX_TABLELOG, e->fse_wksp, sizeof(e->fse_wksp), 0) == outsize;
+}
+
+int64_t lzbench_fse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    return entropy_blocks_compress(fse_encode, inbuf, insize, outbuf, outsize, 0, workmem);
+}
+
+int64_t lzbench_fse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    return entropy_blocks_decompress(fse_decode, inbuf, insize, outbuf, outsize, 0, workmem);
+}
+
+#endif // BENCH_REMOVE_ZSTD
 
 
 #ifdef BENCH_HAS_NAKAMICHI
@@ -1763,6 +4840,358 @@ int64_t lzbench_nakamichi_decompress(char *inbuf, size_t insize, char *outbuf, s
 
 #endif // BENCH_REMOVE_NAKAMICHI
 
+#ifdef BENCH_HAS_ZLIBNG
+#include <zlib-ng.h>
+
+// zlib-ng: the native API (zng_ prefix) of a system library, format 0 = zlib, 1 = gzip
+int64_t lzbench_zlibng_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t format, char*)
+{
+	zng_stream stream;
+	int64_t res = 0;
+	memset(&stream, 0, sizeof(stream));
+	if (zng_deflateInit2(&stream, (int)level, Z_DEFLATED, format ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return 0;
+	stream.next_in = (const uint8_t*)inbuf;
+	stream.avail_in = (uint32_t)insize;
+	stream.next_out = (uint8_t*)outbuf;
+	stream.avail_out = (uint32_t)outsize;
+	if (zng_deflate(&stream, Z_FINISH) == Z_STREAM_END) res = stream.total_out;
+	zng_deflateEnd(&stream);
+	return res;
+}
+
+int64_t lzbench_zlibng_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t format, char*)
+{
+	zng_stream stream;
+	int64_t res = 0;
+	memset(&stream, 0, sizeof(stream));
+	if (zng_inflateInit2(&stream, format ? 15 + 16 : 15) != Z_OK)
+		return 0;
+	stream.next_in = (const uint8_t*)inbuf;
+	stream.avail_in = (uint32_t)insize;
+	stream.next_out = (uint8_t*)outbuf;
+	stream.avail_out = (uint32_t)outsize;
+	if (zng_inflate(&stream, Z_FINISH) == Z_STREAM_END) res = stream.total_out;
+	zng_inflateEnd(&stream);
+	return res;
+}
+
+// --decompress-only of gzip files, members one after another like lzbench_zlib_gzip_decompress()
+int64_t lzbench_zlibng_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	zng_stream stream;
+	int err;
+	memset(&stream, 0, sizeof(stream));
+	if (zng_inflateInit2(&stream, 15 + 16) != Z_OK)
+		return 0;
+	stream.next_in = (const uint8_t*)inbuf;
+	stream.avail_in = (uint32_t)insize;
+	stream.next_out = (uint8_t*)outbuf;
+	stream.avail_out = (uint32_t)outsize;
+	while ((err = zng_inflate(&stream, Z_FINISH)) == Z_STREAM_END && stream.avail_in > 0)
+		if (zng_inflateReset(&stream) != Z_OK) break;
+	zng_inflateEnd(&stream);
+	if (err != Z_STREAM_END)
+		return 0;
+	return outsize - stream.avail_out;
+}
+#endif // BENCH_HAS_ZLIBNG
+
+
+#ifdef BENCH_HAS_ISAL
+#include <isa-l/igzip_lib.h>
+
+// igzip: ISA-L levels 0-3, stateless calls over a whole chunk, format 0 = raw deflate, 1 = gzip
+static const uint32_t igzip_level_buf_size[] = { 0, ISAL_DEF_LVL1_DEFAULT, ISAL_DEF_LVL2_DEFAULT, ISAL_DEF_LVL3_DEFAULT };
+
+char* lzbench_igzip_init(size_t, size_t level, size_t)
+{
+	return (char*) malloc(MAX(igzip_level_buf_size[MIN(level, (size_t)3)], 1));
+}
+
+void lzbench_igzip_deinit(char* workmem)
+{
+	free(workmem);
+}
+
+int64_t lzbench_igzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t format, char* workmem)
+{
+	struct isal_zstream stream;
+	if (!workmem) return 0;
+	isal_deflate_stateless_init(&stream);
+	stream.level = (uint32_t)MIN(level, (size_t)3);
+	stream.level_buf = (uint8_t*)workmem;
+	stream.level_buf_size = igzip_level_buf_size[stream.level];
+	stream.gzip_flag = format ? IGZIP_GZIP : IGZIP_DEFLATE;
+	stream.end_of_stream = 1;
+	stream.flush = NO_FLUSH;
+	stream.next_in = (uint8_t*)inbuf;
+	stream.avail_in = (uint32_t)insize;
+	stream.next_out = (uint8_t*)outbuf;
+	stream.avail_out = (uint32_t)outsize;
+	if (isal_deflate_stateless(&stream) != COMP_OK) return 0;
+	return stream.total_out;
+}
+
+int64_t lzbench_igzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t format, char*)
+{
+	struct inflate_state state;
+	isal_inflate_init(&state);
+	state.crc_flag = format ? ISAL_GZIP : ISAL_DEFLATE;
+	state.next_in = (uint8_t*)inbuf;
+	state.avail_in = (uint32_t)insize;
+	state.next_out = (uint8_t*)outbuf;
+	state.avail_out = (uint32_t)outsize;
+	if (isal_inflate_stateless(&state) != ISAL_DECOMP_OK) return 0;
+	return state.total_out;
+}
+
+// --decompress-only of gzip files, a single member
+int64_t lzbench_igzip_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+	return lzbench_igzip_decompress(inbuf, insize, outbuf, outsize, 0, 1, NULL);
+}
+#endif // BENCH_HAS_ISAL
+
+
+// --offload-depth: jobs of a batch of qpl_deflate submitted before the first one is waited for, --offload-decoder:
+// the decoder of the raw deflate streams of qpl_deflate and qatzip, the accelerator or the bundled libdeflate or zlib
+int lzbench_offload_depth = 16;
+int lzbench_offload_decoder = OFFLOAD_DECODER_NATIVE;
+
+#if defined(BENCH_HAS_QPL) || defined(BENCH_HAS_QATZIP)
+static void* offload_decoder_alloc()
+{
+#ifndef BENCH_REMOVE_LIBDEFLATE
+	if (lzbench_offload_decoder == OFFLOAD_DECODER_LIBDEFLATE) return libdeflate_alloc_decompressor();
+#endif
+	return NULL;
+}
+
+static void offload_decoder_free(void* decoder)
+{
+#ifndef BENCH_REMOVE_LIBDEFLATE
+	if (decoder) libdeflate_free_decompressor((struct libdeflate_decompressor*)decoder);
+#endif
+}
+
+// a raw deflate stream of the accelerator decoded by a bundled decoder, decoder is from offload_decoder_alloc()
+static int64_t offload_decode(void* decoder, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+#ifndef BENCH_REMOVE_LIBDEFLATE
+	if (lzbench_offload_decoder == OFFLOAD_DECODER_LIBDEFLATE)
+	{
+		size_t res = 0;
+		if (!decoder || libdeflate_deflate_decompress((struct libdeflate_decompressor*)decoder, inbuf, insize, outbuf, outsize, &res) != LIBDEFLATE_SUCCESS) return 0;
+		return res;
+	}
+#endif
+#ifndef BENCH_REMOVE_ZLIB
+	if (lzbench_offload_decoder == OFFLOAD_DECODER_ZLIB)
+	{
+		z_stream stream;
+		int64_t res = 0;
+		memset(&stream, 0, sizeof(stream));
+		if (inflateInit2(&stream, -15) != Z_OK) return 0;
+		stream.next_in = (Bytef*)inbuf;
+		stream.avail_in = (uInt)insize;
+		stream.next_out = (Bytef*)outbuf;
+		stream.avail_out = (uInt)outsize;
+		if (inflate(&stream, Z_FINISH) == Z_STREAM_END) res = stream.total_out;
+		inflateEnd(&stream);
+		return res;
+	}
+#endif
+	return 0;
+}
+#endif
+
+
+#ifdef BENCH_HAS_QPL
+#include <qpl/qpl.h>
+
+// qpl_deflate: jobs of Intel QPL on the path of the row, 0 = hardware (IAA), 1 = software; raw deflate streams
+typedef struct
+{
+	std::vector<qpl_job*> jobs; // --offload-depth of them, single calls use the first one
+	void* decoder;
+} qpl_state_s;
+
+char* lzbench_qpl_init(size_t, size_t, size_t path)
+{
+	qpl_path_t qpath = path ? qpl_path_software : qpl_path_hardware;
+	uint32_t size = 0;
+	if (qpl_get_job_size(qpath, &size) != QPL_STS_OK) return NULL;
+
+	qpl_state_s* state = new qpl_state_s();
+	for (int i = 0; i < MAX(lzbench_offload_depth, 1); i++)
+	{
+		qpl_job* job = (qpl_job*) malloc(size);
+		if (!job || qpl_init_job(qpath, job) != QPL_STS_OK)
+		{
+			static bool warned = false;
+			if (!warned) fprintf(stderr, "warning: qpl_init_job failed on the %s path\n", path ? "software" : "hardware (IAA)");
+			warned = true;
+			free(job);
+			break;
+		}
+		state->jobs.push_back(job);
+	}
+	if (state->jobs.empty()) { delete state; return NULL; }
+	state->decoder = offload_decoder_alloc();
+	return (char*) state;
+}
+
+void lzbench_qpl_deinit(char* workmem)
+{
+	qpl_state_s* state = (qpl_state_s*) workmem;
+	if (!state) return;
+	for (size_t i = 0; i < state->jobs.size(); i++)
+	{
+		qpl_fini_job(state->jobs[i]);
+		free(state->jobs[i]);
+	}
+	offload_decoder_free(state->decoder);
+	delete state;
+}
+
+static void qpl_setup(qpl_job* job, bool decompress, char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level)
+{
+	job->op = decompress ? qpl_op_decompress : qpl_op_compress;
+	job->next_in_ptr = (uint8_t*) inbuf;
+	job->available_in = (uint32_t) insize;
+	job->next_out_ptr = (uint8_t*) outbuf;
+	job->available_out = (uint32_t) MIN(outsize, (size_t)UINT32_MAX);
+	job->level = level >= 2 ? qpl_high_level : qpl_default_level;
+	job->flags = QPL_FLAG_FIRST | QPL_FLAG_LAST;
+	if (!decompress) job->flags |= QPL_FLAG_DYNAMIC_HUFFMAN | QPL_FLAG_OMIT_VERIFY;
+}
+
+int64_t lzbench_qpl_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+	qpl_state_s* state = (qpl_state_s*) workmem;
+	if (!state) return 0;
+	qpl_job* job = state->jobs[0];
+	qpl_setup(job, false, inbuf, insize, outbuf, outsize, level);
+	return qpl_execute_job(job) == QPL_STS_OK ? job->total_out : 0;
+}
+
+int64_t lzbench_qpl_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	qpl_state_s* state = (qpl_state_s*) workmem;
+	if (!state) return 0;
+	if (lzbench_offload_decoder != OFFLOAD_DECODER_NATIVE) return offload_decode(state->decoder, inbuf, insize, outbuf, outsize);
+	qpl_job* job = state->jobs[0];
+	qpl_setup(job, true, inbuf, insize, outbuf, outsize, 0);
+	return qpl_execute_job(job) == QPL_STS_OK ? job->total_out : 0;
+}
+
+// asynchronous submission: chunk i goes to job i % depth once the job of chunk i - depth is done
+static int64_t qpl_batch(qpl_state_s* state, bool decompress, size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level)
+{
+	size_t depth = state->jobs.size();
+	std::vector<char> submitted(depth, 0);
+	for (size_t i = 0; i < n + depth; i++)
+	{
+		size_t slot = i % depth;
+		qpl_job* job = state->jobs[slot];
+		if (i >= depth && i - depth < n)
+			sizes[i - depth] = (submitted[slot] && qpl_wait_job(job) == QPL_STS_OK) ? (int64_t)job->total_out : 0;
+		submitted[slot] = 0;
+		if (i >= n) continue;
+		qpl_setup(job, decompress, in[i], insize[i], out[i], outsize[i], level);
+		qpl_status status;
+		while ((status = qpl_submit_job(job)) == QPL_STS_QUEUES_ARE_BUSY_ERR) {} // the work queues of the device are full
+		submitted[slot] = status == QPL_STS_OK;
+	}
+	return 0;
+}
+
+int64_t lzbench_qpl_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t, char* workmem)
+{
+	qpl_state_s* state = (qpl_state_s*) workmem;
+	if (!state) return -1;
+	return qpl_batch(state, false, n, in, insize, out, outsize, sizes, level);
+}
+
+int64_t lzbench_qpl_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem)
+{
+	qpl_state_s* state = (qpl_state_s*) workmem;
+	if (!state) return -1;
+	if (lzbench_offload_decoder == OFFLOAD_DECODER_NATIVE) return qpl_batch(state, true, n, in, insize, out, outsize, sizes, 0);
+	for (size_t i = 0; i < n; i++)
+		sizes[i] = offload_decode(state->decoder, in[i], insize[i], out[i], outsize[i]);
+	return 0;
+}
+#endif // BENCH_HAS_QPL
+
+
+#ifdef BENCH_HAS_QATZIP
+#include <qatzip.h>
+
+// qatzip: a session of QATzip per thread without the software fallback, raw deflate streams, requests of -T# threads are in flight at once
+typedef struct
+{
+	QzSession_T session;
+	void* decoder;
+} qatzip_state_s;
+
+char* lzbench_qatzip_init(size_t, size_t level, size_t)
+{
+	qatzip_state_s* state = (qatzip_state_s*) calloc(1, sizeof(qatzip_state_s));
+	QzSessionParams_T params;
+	if (!state) return NULL;
+	int rc = qzInit(&state->session, 0);
+	if ((rc == QZ_OK || rc == QZ_DUPLICATE) && qzGetDefaults(&params) == QZ_OK)
+	{
+		params.data_fmt = QZ_DEFLATE_RAW;
+		params.comp_lvl = (unsigned int)level;
+		params.sw_backup = 0;
+		if (qzSetupSession(&state->session, &params) == QZ_OK)
+		{
+			state->decoder = offload_decoder_alloc();
+			return (char*) state;
+		}
+	}
+	static bool warned = false;
+	if (!warned) fprintf(stderr, "warning: no QAT session of QATzip (error %d of qzInit)\n", rc);
+	warned = true;
+	qzClose(&state->session);
+	free(state);
+	return NULL;
+}
+
+void lzbench_qatzip_deinit(char* workmem)
+{
+	qatzip_state_s* state = (qatzip_state_s*) workmem;
+	if (!state) return;
+	qzTeardownSession(&state->session);
+	qzClose(&state->session);
+	offload_decoder_free(state->decoder);
+	free(state);
+}
+
+int64_t lzbench_qatzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	qatzip_state_s* state = (qatzip_state_s*) workmem;
+	if (!state) return 0;
+	unsigned int src_len = (unsigned int)insize, dst_len = (unsigned int)MIN(outsize, (size_t)UINT_MAX);
+	if (qzCompress(&state->session, (const unsigned char*)inbuf, &src_len, (unsigned char*)outbuf, &dst_len, 1) != QZ_OK || src_len != insize) return 0;
+	return dst_len;
+}
+
+int64_t lzbench_qatzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+	qatzip_state_s* state = (qatzip_state_s*) workmem;
+	if (!state) return 0;
+	if (lzbench_offload_decoder != OFFLOAD_DECODER_NATIVE) return offload_decode(state->decoder, inbuf, insize, outbuf, outsize);
+	unsigned int src_len = (unsigned int)insize, dst_len = (unsigned int)MIN(outsize, (size_t)UINT_MAX);
+	if (qzDecompress(&state->session, (const unsigned char*)inbuf, &src_len, (unsigned char*)outbuf, &dst_len) != QZ_OK) return 0;
+	return dst_len;
+}
+#endif // BENCH_HAS_QATZIP
+
+
 #ifdef BENCH_HAS_CUDA
 #include <cuda_runtime.h>
 
@@ -1790,9 +5219,192 @@ int64_t lzbench_cuda_return_0(char *inbuf, size_t insize, char *outbuf, size_t o
     return 0;
 }
 
+// page-locked host memory of --pinned, transfers from and to it do not go through a staging buffer of the driver
+void* lzbench_cuda_host_alloc(size_t size)
+{
+    void* buf = NULL;
+    if (cudaMallocHost(&buf, size) != cudaSuccess) return NULL;
+    return buf;
+}
+
+void lzbench_cuda_host_free(void* buf)
+{
+    cudaFreeHost(buf);
+}
+
+bool lzbench_cuda_host_register(void* buf, size_t size)
+{
+    return cudaHostRegister(buf, size, cudaHostRegisterDefault) == cudaSuccess;
+}
+
+void lzbench_cuda_host_unregister(void* buf)
+{
+    cudaHostUnregister(buf);
+}
+
 #ifdef BENCH_HAS_NVCOMP
 #include "nvcomp/lz4.h"
 
+// --cuda-streams: number of streams of the pipelined mode of nvcomp_lz4 (0 = not pipelined) and size of its slices
+int lzbench_cuda_streams = 0;
+size_t lzbench_cuda_slice_size = 4 << 20;
+
+// time of kernels and of transfers measured with events in the pipelined mode, taken by lzbench_cuda_timing()
+static std::atomic<uint64_t> cuda_kernel_ns(0), cuda_transfer_ns(0);
+
+void lzbench_cuda_timing(uint64_t& kernel_ns, uint64_t& transfer_ns)
+{
+  kernel_ns += cuda_kernel_ns.exchange(0);
+  transfer_ns += cuda_transfer_ns.exchange(0);
+}
+
+// --gpus: devices over which nvcomp_lz4_batch splits the chunks of a batch, 1 = only the current device
+int lzbench_cuda_devices = 1;
+
+// time from the upload to the end of the download of the batches of every device and their uncompressed bytes
+static std::atomic<uint64_t> cuda_device_ns[CUDA_DEVICES_MAX], cuda_device_bytes[CUDA_DEVICES_MAX];
+
+void lzbench_cuda_device_timing(uint64_t* ns, uint64_t* bytes)
+{
+  for (int d = 0; d < CUDA_DEVICES_MAX; d++) {
+    ns[d] += cuda_device_ns[d].exchange(0);
+    bytes[d] += cuda_device_bytes[d].exchange(0);
+  }
+}
+
+/*
+ * Number of visible devices, with print also list the devices and how they reach each other: devices behind the same PCIe
+ * switch or linked by NVLink have peer access and a better performance rank, and they usually also share the
+ * bandwidth of their link to the host, which caps the scaling of host-device transfers.
+ */
+int lzbench_cuda_topology(bool print)
+{
+  int count = 0;
+  if (cudaGetDeviceCount(&count) != cudaSuccess) return 0;
+  if (!print) return count;
+
+  for (int i = 0; i < count; i++) {
+    cudaDeviceProp prop;
+    char bus_id[32] = "?";
+    if (cudaGetDeviceProperties(&prop, i) != cudaSuccess) continue;
+    cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), i);
+    fprintf(stderr, "GPU %d: %s, PCI %s, peers:", i, prop.name, bus_id);
+    for (int j = 0; j < count; j++) {
+      int access = 0, rank = 0;
+      if (j == i) { fprintf(stderr, " -"); continue; }
+      cudaDeviceGetP2PAttribute(&access, cudaDevP2PAttrAccessSupported, i, j);
+      cudaDeviceGetP2PAttribute(&rank, cudaDevP2PAttrPerformanceRank, i, j);
+      if (access) fprintf(stderr, " %d", rank); else fprintf(stderr, " x");
+    }
+    fprintf(stderr, "\n");
+  }
+  fprintf(stderr, "peers: performance rank of peer access to GPU 0, 1, ... (lower is faster), x = no peer access\n");
+  return count;
+}
+
+/*
+ * Device memory pool of the nvcomp codecs: cudaMalloc and cudaMallocHost blocks and streams released by deinit are kept
+ * resident and taken again by the next init of a level or an iteration that fits in a block up to twice its size,
+ * so a test doesn't pay for GPU setup that earlier tests did. The time of cudaMalloc, cudaMallocHost and
+ * cudaStreamCreate that the pool could not avoid and of reading metadata is taken by lzbench_cuda_setup_timing().
+ */
+static std::mutex nvcomp_pool_mutex;
+static std::multimap<std::pair<int, size_t>, void*> nvcomp_pool_blocks[2]; // free blocks by device and size, 0 = device, 1 = pinned host
+static std::map<void*, std::pair<int, size_t> > nvcomp_pool_sizes[2]; // device and size of the blocks in use
+static std::multimap<int, cudaStream_t> nvcomp_pool_streams; // free streams by device
+static std::atomic<uint64_t> cuda_alloc_ns(0), cuda_metadata_ns(0), cuda_pool_hits(0);
+
+void lzbench_cuda_setup_timing(uint64_t& alloc_ns, uint64_t& metadata_ns, uint64_t& pool_hits)
+{
+  alloc_ns += cuda_alloc_ns.exchange(0);
+  metadata_ns += cuda_metadata_ns.exchange(0);
+  pool_hits += cuda_pool_hits.exchange(0);
+}
+
+static uint64_t nvcomp_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// cudaMalloc (host = 0) or cudaMallocHost (host = 1) of the current device through the pool
+static int nvcomp_pool_malloc(void** ptr, size_t size, int host)
+{
+  int device = 0;
+  if (!host) cudaGetDevice(&device);
+  std::lock_guard<std::mutex> lock(nvcomp_pool_mutex);
+  std::multimap<std::pair<int, size_t>, void*>::iterator it = nvcomp_pool_blocks[host].lower_bound(std::make_pair(device, size));
+  if (it != nvcomp_pool_blocks[host].end() && it->first.first == device && it->first.second <= 2 * std::max(size, (size_t)4096)) {
+    *ptr = it->second;
+    nvcomp_pool_sizes[host][*ptr] = it->first;
+    nvcomp_pool_blocks[host].erase(it);
+    cuda_pool_hits++;
+    return cudaSuccess;
+  }
+  uint64_t start = nvcomp_now_ns();
+  int status = host ? cudaMallocHost(ptr, size) : cudaMalloc(ptr, size);
+  cuda_alloc_ns += nvcomp_now_ns() - start;
+  if (status == cudaSuccess) nvcomp_pool_sizes[host][*ptr] = std::make_pair(device, size);
+  return status;
+}
+
+static void nvcomp_pool_free(void* ptr, int host)
+{
+  if (!ptr) return;
+  std::lock_guard<std::mutex> lock(nvcomp_pool_mutex);
+  std::map<void*, std::pair<int, size_t> >::iterator it = nvcomp_pool_sizes[host].find(ptr);
+  if (it == nvcomp_pool_sizes[host].end()) return;
+  nvcomp_pool_blocks[host].insert(std::make_pair(it->second, ptr));
+  nvcomp_pool_sizes[host].erase(it);
+}
+
+// cudaStreamCreate of the current device through the pool
+static int nvcomp_pool_stream(cudaStream_t* stream)
+{
+  int device = 0;
+  cudaGetDevice(&device);
+  std::lock_guard<std::mutex> lock(nvcomp_pool_mutex);
+  std::multimap<int, cudaStream_t>::iterator it = nvcomp_pool_streams.find(device);
+  if (it != nvcomp_pool_streams.end()) {
+    *stream = it->second;
+    nvcomp_pool_streams.erase(it);
+    cuda_pool_hits++;
+    return cudaSuccess;
+  }
+  uint64_t start = nvcomp_now_ns();
+  int status = cudaStreamCreate(stream);
+  cuda_alloc_ns += nvcomp_now_ns() - start;
+  return status;
+}
+
+// the stream must belong to the current device
+static void nvcomp_pool_stream_free(cudaStream_t stream)
+{
+  int device = 0;
+  cudaGetDevice(&device);
+  std::lock_guard<std::mutex> lock(nvcomp_pool_mutex);
+  nvcomp_pool_streams.insert(std::make_pair(device, stream));
+}
+
+// a stream of the pipelined mode with its own device and pinned host buffers for a slice
+typedef struct {
+  cudaStream_t stream;
+  cudaEvent_t events[4];     // before the upload, before the kernel, after the kernel, after the download
+  char* uncompressed_d;
+  char* compressed_d;
+  char* buffer_d;
+  char* in_h;
+  char* out_h;
+  size_t* compressed_size;
+  void* metadata_ptr;
+  int64_t slice;             // the slice in flight, -1 = idle
+} nvcomp_lane_s;
+
+typedef struct {
+  void* ptr;
+  size_t buffer_size;
+  size_t uncompressed_size;
+} nvcomp_metadata_s;
+
 typedef struct {
   size_t buffer_size;
   size_t compressed_max_size;
@@ -1802,27 +5414,253 @@ typedef struct {
   char* buffer_d;
   char* compressed_d;
   nvcompLZ4FormatOpts opts;
+  int lanes;                 // streams of the pipelined mode, 0 = not pipelined
+  size_t slice_size;
+  nvcomp_lane_s* lane;
+  std::map<std::pair<const char*, size_t>, nvcomp_metadata_s> metadata; // of compressed inputs since the last compress
 } nvcomp_params_s;
 
+/*
+ * Metadata of a compressed input that is already on the device, read once and kept by its host address and size
+ * until the next compress with this workmem, which is the only writer of the compressed data that it decompresses.
+ */
+static nvcomp_metadata_s* nvcomp_metadata(nvcomp_params_s* p, const char* inbuf, const char* compressed_d, size_t insize, cudaStream_t stream)
+{
+  std::pair<const char*, size_t> key(inbuf, insize);
+  std::map<std::pair<const char*, size_t>, nvcomp_metadata_s>::iterator it = p->metadata.find(key);
+  if (it != p->metadata.end()) return &it->second;
+
+  uint64_t start = nvcomp_now_ns();
+  nvcomp_metadata_s meta;
+  int status = nvcompDecompressGetMetadata(compressed_d, insize, &meta.ptr, stream);
+  assert(status == cudaSuccess);
+  status = nvcompDecompressGetTempSize(meta.ptr, &meta.buffer_size);
+  assert(status == cudaSuccess);
+  status = nvcompDecompressGetOutputSize(meta.ptr, &meta.uncompressed_size);
+  assert(status == cudaSuccess);
+  cuda_metadata_ns += nvcomp_now_ns() - start;
+  return &(p->metadata[key] = meta);
+}
+
+static void nvcomp_metadata_clear(nvcomp_params_s* p)
+{
+  for (std::map<std::pair<const char*, size_t>, nvcomp_metadata_s>::iterator it = p->metadata.begin(); it != p->metadata.end(); ++it)
+    nvcompDecompressDestroyMetadata(it->second.ptr);
+  p->metadata.clear();
+}
+
+/*
+ * The pipelined mode splits a call into slices that are compressed independently by a ring of streams, so
+ * the upload of slice i+1, the kernel of slice i and the download of slice i-1 overlap. The buffers of a
+ * stream are reused by slice i+streams only after the stream is synchronized. The output is the number of
+ * slices, the slice size and the compressed size of every slice (32-bit) followed by the slices.
+ */
+static void nvcomp_pipeline_init(nvcomp_params_s* p, size_t insize)
+{
+  int status = 0;
+
+  p->slice_size = std::min(std::max(lzbench_cuda_slice_size, (size_t)p->opts.chunk_size), std::max(insize, (size_t)1));
+  p->lanes = lzbench_cuda_streams;
+  p->lane = (nvcomp_lane_s*) calloc(p->lanes, sizeof(nvcomp_lane_s));
+  assert(p->lane);
+
+  for (int l = 0; l < p->lanes; l++) {
+    nvcomp_lane_s* lane = &p->lane[l];
+    lane->slice = -1;
+
+    status = nvcomp_pool_stream(&lane->stream);
+    assert(status == cudaSuccess);
+    for (int e = 0; e < 4; e++) {
+      status = cudaEventCreate(&lane->events[e]);
+      assert(status == cudaSuccess);
+    }
+
+    status = nvcomp_pool_malloc((void**)&lane->uncompressed_d, p->slice_size, 0);
+    assert(status == cudaSuccess);
+
+    // the sizes are the same for all the streams
+    if (l == 0) {
+      status = nvcompLZ4CompressGetTempSize(lane->uncompressed_d, p->slice_size, NVCOMP_TYPE_CHAR, &p->opts, &p->buffer_size);
+      assert(status == nvcompSuccess);
+    }
+    status = nvcomp_pool_malloc((void**)&lane->buffer_d, p->buffer_size, 0);
+    assert(status == cudaSuccess);
+    if (l == 0) {
+      status = nvcompLZ4CompressGetOutputSize(lane->uncompressed_d, p->slice_size, NVCOMP_TYPE_CHAR, &p->opts, lane->buffer_d, p->buffer_size, &p->compressed_max_size, 0);
+      assert(status == nvcompSuccess);
+    }
+    status = nvcomp_pool_malloc((void**)&lane->compressed_d, p->compressed_max_size, 0);
+    assert(status == cudaSuccess);
+
+    // pinned host buffers make the transfers asynchronous
+    size_t host_size = std::max(p->slice_size, p->compressed_max_size);
+    status = nvcomp_pool_malloc((void**)&lane->in_h, host_size, 1);
+    assert(status == cudaSuccess);
+    status = nvcomp_pool_malloc((void**)&lane->out_h, host_size, 1);
+    assert(status == cudaSuccess);
+    status = nvcomp_pool_malloc((void**)&lane->compressed_size, sizeof(size_t), 1);
+    assert(status == cudaSuccess);
+  }
+}
+
+static void nvcomp_pipeline_deinit(nvcomp_params_s* p)
+{
+  for (int l = 0; l < p->lanes; l++) {
+    nvcomp_lane_s* lane = &p->lane[l];
+    nvcomp_pool_free(lane->compressed_size, 1);
+    nvcomp_pool_free(lane->out_h, 1);
+    nvcomp_pool_free(lane->in_h, 1);
+    nvcomp_pool_free(lane->compressed_d, 0);
+    nvcomp_pool_free(lane->buffer_d, 0);
+    nvcomp_pool_free(lane->uncompressed_d, 0);
+    for (int e = 0; e < 4; e++)
+      cudaEventDestroy(lane->events[e]);
+    nvcomp_pool_stream_free(lane->stream);
+  }
+  free(p->lane);
+}
+
+// wait for the slice in flight of a stream and add the time of its kernel and transfers
+static void nvcomp_lane_sync(nvcomp_lane_s* lane)
+{
+  int status = cudaStreamSynchronize(lane->stream);
+  assert(status == cudaSuccess);
+
+  float upload_ms, kernel_ms, download_ms;
+  cudaEventElapsedTime(&upload_ms, lane->events[0], lane->events[1]);
+  cudaEventElapsedTime(&kernel_ms, lane->events[1], lane->events[2]);
+  cudaEventElapsedTime(&download_ms, lane->events[2], lane->events[3]);
+  cuda_kernel_ns += (uint64_t)(kernel_ms * 1e6);
+  cuda_transfer_ns += (uint64_t)((upload_ms + download_ms) * 1e6);
+}
+
+static int64_t nvcomp_pipeline_compress(nvcomp_params_s* p, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+  int status = 0;
+  uint32_t slices = (uint32_t)((insize + p->slice_size - 1) / p->slice_size), value;
+  size_t pos = 4 * (2 + (size_t)slices);
+  bool error = pos > outsize;
+
+  for (int64_t k = 0; k < (int64_t)slices + p->lanes; k++) {
+    nvcomp_lane_s* lane = &p->lane[k % p->lanes];
+
+    // pack the slice that used the buffers of this stream before
+    if (lane->slice >= 0) {
+      nvcomp_lane_sync(lane);
+      size_t csize = *lane->compressed_size;
+      if (pos + csize > outsize) error = true;
+      if (!error) {
+        value = (uint32_t)csize;
+        memcpy(outbuf + 8 + 4 * lane->slice, &value, 4);
+        memcpy(outbuf + pos, lane->out_h, csize);
+        pos += csize;
+      }
+      lane->slice = -1;
+    }
+    if (k >= slices) continue;
+
+    size_t offset = (size_t)k * p->slice_size, size = std::min(p->slice_size, insize - offset);
+    memcpy(lane->in_h, inbuf + offset, size);
+    cudaEventRecord(lane->events[0], lane->stream);
+    status = cudaMemcpyAsync(lane->uncompressed_d, lane->in_h, size, cudaMemcpyHostToDevice, lane->stream);
+    assert(status == cudaSuccess);
+    cudaEventRecord(lane->events[1], lane->stream);
+    *lane->compressed_size = p->compressed_max_size;
+    status = nvcompLZ4CompressAsync(lane->uncompressed_d, size, NVCOMP_TYPE_CHAR, &p->opts, lane->buffer_d, p->buffer_size,
+                                    lane->compressed_d, lane->compressed_size, lane->stream);
+    assert(status == nvcompSuccess);
+    cudaEventRecord(lane->events[2], lane->stream);
+    // the compressed size is known only after the kernel, so the bound of the slice is downloaded
+    status = cudaMemcpyAsync(lane->out_h, lane->compressed_d, p->compressed_max_size, cudaMemcpyDeviceToHost, lane->stream);
+    assert(status == cudaSuccess);
+    cudaEventRecord(lane->events[3], lane->stream);
+    lane->slice = k;
+  }
+  if (error) return 0;
+
+  value = (uint32_t)p->slice_size;
+  memcpy(outbuf, &slices, 4);
+  memcpy(outbuf + 4, &value, 4);
+  return pos;
+}
+
+static int64_t nvcomp_pipeline_decompress(nvcomp_params_s* p, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+  int status = 0;
+  uint32_t slices, slice_size;
+  if (insize < 8) return 0;
+  memcpy(&slices, inbuf, 4);
+  memcpy(&slice_size, inbuf + 4, 4);
+  if (slice_size != p->slice_size || insize < 4 * (2 + (size_t)slices) || (size_t)slices * slice_size < outsize) return 0;
+
+  std::vector<size_t> offsets(slices + 1);
+  offsets[0] = 4 * (2 + (size_t)slices);
+  for (uint32_t i = 0; i < slices; i++) {
+    uint32_t csize;
+    memcpy(&csize, inbuf + 8 + 4 * i, 4);
+    offsets[i + 1] = offsets[i] + csize;
+    if (offsets[i + 1] > insize || csize > p->compressed_max_size) return 0;
+  }
+
+  for (int64_t k = 0; k < (int64_t)slices + p->lanes; k++) {
+    nvcomp_lane_s* lane = &p->lane[k % p->lanes];
+
+    if (lane->slice >= 0) {
+      nvcomp_lane_sync(lane);
+      size_t offset = (size_t)lane->slice * p->slice_size;
+      memcpy(outbuf + offset, lane->out_h, std::min(p->slice_size, outsize - offset));
+      lane->slice = -1;
+    }
+    if (k >= slices) continue;
+
+    size_t csize = offsets[k + 1] - offsets[k], size = std::min(p->slice_size, outsize - (size_t)k * p->slice_size);
+    memcpy(lane->in_h, inbuf + offsets[k], csize);
+    cudaEventRecord(lane->events[0], lane->stream);
+    status = cudaMemcpyAsync(lane->compressed_d, lane->in_h, csize, cudaMemcpyHostToDevice, lane->stream);
+    assert(status == cudaSuccess);
+
+    // reading the metadata synchronizes only this stream, the others keep running, later passes take it from the cache
+    nvcomp_metadata_s* meta = nvcomp_metadata(p, inbuf + offsets[k], lane->compressed_d, csize, lane->stream);
+    lane->metadata_ptr = meta->ptr;
+    assert(meta->buffer_size <= p->buffer_size);
+    assert(meta->uncompressed_size == size);
+
+    cudaEventRecord(lane->events[1], lane->stream);
+    status = nvcompDecompressAsync(lane->compressed_d, csize, lane->buffer_d, p->buffer_size, lane->metadata_ptr,
+                                   lane->uncompressed_d, size, lane->stream);
+    assert(status == cudaSuccess);
+    cudaEventRecord(lane->events[2], lane->stream);
+    status = cudaMemcpyAsync(lane->out_h, lane->uncompressed_d, size, cudaMemcpyDeviceToHost, lane->stream);
+    assert(status == cudaSuccess);
+    cudaEventRecord(lane->events[3], lane->stream);
+    lane->slice = k;
+  }
+  return outsize;
+}
+
 // allocate the host and device memory buffers for the nvcom LZ4 compression and decompression
 // the chunk size is configured by the compression level, 0 to 5 inclusive, corresponding to a chunk size from 32 kB to 1 MB
 char* lzbench_nvcomp_init(size_t insize, size_t level, size_t)
 {
   // allocate the host memory for the algorithm options
-  nvcomp_params_s* nvcomp_params = (nvcomp_params_s*) malloc(sizeof(nvcomp_params_s));
-  if (!nvcomp_params) return NULL;
+  nvcomp_params_s* nvcomp_params = new nvcomp_params_s();
 
   // set the chunk size based on the compression level
   nvcomp_params->opts.chunk_size = 1 << (15 + level);
 
+  if (lzbench_cuda_streams > 1) {
+    nvcomp_pipeline_init(nvcomp_params, insize);
+    return (char*) nvcomp_params;
+  }
+
   int status = 0;
 
-  // create a CUDA stream to run the compression/decompression
-  status = cudaStreamCreate(&nvcomp_params->stream);
+  // take a CUDA stream to run the compression/decompression from the pool
+  status = nvcomp_pool_stream(&nvcomp_params->stream);
   assert(status == cudaSuccess);
 
-  // allocate device memory for the data to be compressed
-  status = cudaMalloc(&nvcomp_params->uncompressed_d, insize);
+  // allocate device memory for the data to be compressed, from the pool
+  status = nvcomp_pool_malloc((void**)&nvcomp_params->uncompressed_d, insize, 0);
   assert(status == cudaSuccess);
 
   // determine the size of the temporary buffer
@@ -1831,7 +5669,7 @@ char* lzbench_nvcomp_init(size_t insize, size_t level, size_t)
   assert(status == nvcompSuccess);
 
   // allocate device memory for the temporary buffer
-  status = cudaMalloc(&nvcomp_params->buffer_d, nvcomp_params->buffer_size);
+  status = nvcomp_pool_malloc((void**)&nvcomp_params->buffer_d, nvcomp_params->buffer_size, 0);
   assert(status == cudaSuccess);
 
   // determine the size of the output buffer
@@ -1840,11 +5678,11 @@ char* lzbench_nvcomp_init(size_t insize, size_t level, size_t)
   assert(status == nvcompSuccess);
 
   // allocate device memory for the compressed data
-  status = cudaMalloc(&nvcomp_params->compressed_d, nvcomp_params->compressed_max_size);
+  status = nvcomp_pool_malloc((void**)&nvcomp_params->compressed_d, nvcomp_params->compressed_max_size, 0);
   assert(status == cudaSuccess);
 
   // allocate pinned host memory for storing the compressed size from the device
-  status = cudaMallocHost(&nvcomp_params->compressed_size, sizeof(size_t));
+  status = nvcomp_pool_malloc((void**)&nvcomp_params->compressed_size, sizeof(size_t), 1);
   assert(status == cudaSuccess);
 
   return (char*) nvcomp_params;
@@ -1853,17 +5691,24 @@ char* lzbench_nvcomp_init(size_t insize, size_t level, size_t)
 void lzbench_nvcomp_deinit(char* params)
 {
   nvcomp_params_s* nvcomp_params = (nvcomp_params_s*) params;
-
-  // free all the device memory
-  cudaFree(nvcomp_params->compressed_d);
-  cudaFree(nvcomp_params->buffer_d);
-  cudaFree(nvcomp_params->uncompressed_d);
-
-  // release the CUDA stream
-  cudaStreamDestroy(nvcomp_params->stream);
+  if (!nvcomp_params) return;
+
+  nvcomp_metadata_clear(nvcomp_params);
+  if (nvcomp_params->lanes) {
+    nvcomp_pipeline_deinit(nvcomp_params);
+    delete nvcomp_params;
+    return;
+  }
+
+  // return the device memory, the pinned host memory and the CUDA stream to the pool
+  nvcomp_pool_free(nvcomp_params->compressed_size, 1);
+  nvcomp_pool_free(nvcomp_params->compressed_d, 0);
+  nvcomp_pool_free(nvcomp_params->buffer_d, 0);
+  nvcomp_pool_free(nvcomp_params->uncompressed_d, 0);
+  nvcomp_pool_stream_free(nvcomp_params->stream);
 
   // free the host memory for the algorithm options
-  free(nvcomp_params);
+  delete nvcomp_params;
 }
 
 int64_t lzbench_nvcomp_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* params)
@@ -1871,6 +5716,10 @@ int64_t lzbench_nvcomp_compress(char *inbuf, size_t insize, char *outbuf, size_t
   nvcomp_params_s* nvcomp_params = (nvcomp_params_s*) params;
   int status = 0;
 
+  nvcomp_metadata_clear(nvcomp_params); // the compressed data changes
+  if (nvcomp_params->lanes)
+    return nvcomp_pipeline_compress(nvcomp_params, inbuf, insize, outbuf, outsize);
+
   // copy the uncompressed data to the device
   status = cudaMemcpyAsync(nvcomp_params->uncompressed_d, inbuf, insize, cudaMemcpyHostToDevice, nvcomp_params->stream);
   assert(status == cudaSuccess);
@@ -1908,6 +5757,9 @@ int64_t lzbench_nvcomp_decompress(char *inbuf, size_t insize, char *outbuf, size
   nvcomp_params_s* nvcomp_params = (nvcomp_params_s*) params;
   int status = 0;
 
+  if (nvcomp_params->lanes)
+    return nvcomp_pipeline_decompress(nvcomp_params, inbuf, insize, outbuf, outsize);
+
   // check that the device buffer is large enough for the compressed data
   assert(insize <= nvcomp_params->compressed_max_size);
 
@@ -1915,23 +5767,13 @@ int64_t lzbench_nvcomp_decompress(char *inbuf, size_t insize, char *outbuf, size
   status = cudaMemcpyAsync(nvcomp_params->compressed_d, inbuf, insize, cudaMemcpyHostToDevice, nvcomp_params->stream);
   assert(status == cudaSuccess);
 
-  // extract the metadata
-  void* metadata_ptr;
-  status = nvcompDecompressGetMetadata(nvcomp_params->compressed_d, insize, &metadata_ptr, nvcomp_params->stream);
-  assert(status == cudaSuccess);
-
-  // get the temporary buffer size
-  size_t buffer_size;
-  status = nvcompDecompressGetTempSize(metadata_ptr, &buffer_size);
-  assert(status == cudaSuccess);
+  // extract the metadata with the temporary buffer size and the uncompressed size, or take it from the cache
+  nvcomp_metadata_s* meta = nvcomp_metadata(nvcomp_params, inbuf, nvcomp_params->compressed_d, insize, nvcomp_params->stream);
+  void* metadata_ptr = meta->ptr;
+  size_t uncompressed_size = meta->uncompressed_size;
 
   // check that the temporary buffer is large enough for the decompression
-  assert(buffer_size <= nvcomp_params->buffer_size);
-
-  // get the uncompressed size
-  size_t uncompressed_size;
-  status = nvcompDecompressGetOutputSize(metadata_ptr, &uncompressed_size);
-  assert(status == cudaSuccess);
+  assert(meta->buffer_size <= nvcomp_params->buffer_size);
 
   // check that the uncompressed buffer is large enough for the uncompressed data
   assert(uncompressed_size == outsize);
@@ -1952,16 +5794,813 @@ int64_t lzbench_nvcomp_decompress(char *inbuf, size_t insize, char *outbuf, size
   status = cudaMemcpyAsync(outbuf, nvcomp_params->uncompressed_d, uncompressed_size, cudaMemcpyDeviceToHost, nvcomp_params->stream);
   assert(status == cudaSuccess);
 
-  // ensure that all operations and copies are complete
+  // ensure that all operations and copies are complete, the metadata is kept until the next compress
   status = cudaStreamSynchronize(nvcomp_params->stream);
   assert(status == cudaSuccess);
 
-  // destroy the metadata
-  nvcompDecompressDestroyMetadata(metadata_ptr);
-
   return uncompressed_size;
 }
 
+#ifndef BENCH_REMOVE_LZ4
+// nvcomp_lz4_hybrid: slices of a call (--cuda-streams slice size, default 4 MB) are taken from a shared queue by
+// a thread running nvcomp_lz4 on the GPU and by --hybrid=# threads running lz4 on the CPU, whichever is free.
+// nvcomp_lz4 output is not a raw LZ4 block, so every slice is tagged and decompressed by the side that made it.
+int lzbench_hybrid_threads = 1;
+
+// bytes of input processed by the GPU, taken by lzbench_hybrid_share()
+static std::atomic<uint64_t> hybrid_gpu_bytes(0);
+
+void lzbench_hybrid_share(uint64_t& gpu_bytes)
+{
+  gpu_bytes += hybrid_gpu_bytes.exchange(0);
+}
+
+#define HYBRID_GPU_SLICE 0x80000000u
+
+typedef struct {
+  char* gpu;                 // nvcomp_lz4 state of a slice
+  size_t slice_size;
+  size_t bound;              // room for a compressed slice in tmp
+  size_t max_slices;
+  char* tmp;
+} nvcomp_hybrid_params_s;
+
+char* lzbench_nvcomp_hybrid_init(size_t insize, size_t level, size_t)
+{
+  nvcomp_hybrid_params_s* p = (nvcomp_hybrid_params_s*) calloc(1, sizeof(nvcomp_hybrid_params_s));
+  if (!p) return NULL;
+
+  p->slice_size = std::max(std::min(lzbench_cuda_slice_size, insize), (size_t)1);
+  p->gpu = lzbench_nvcomp_init(p->slice_size, level, 0);
+  if (!p->gpu) { free(p); return NULL; }
+  p->bound = std::max((size_t)LZ4_compressBound((int)p->slice_size), ((nvcomp_params_s*)p->gpu)->compressed_max_size);
+  p->max_slices = std::max((insize + p->slice_size - 1) / p->slice_size, (size_t)1);
+  p->tmp = (char*) malloc(p->max_slices * p->bound);
+  if (!p->tmp) { lzbench_nvcomp_hybrid_deinit((char*)p); return NULL; }
+  return (char*) p;
+}
+
+void lzbench_nvcomp_hybrid_deinit(char* params)
+{
+  nvcomp_hybrid_params_s* p = (nvcomp_hybrid_params_s*) params;
+  if (!p) return;
+
+  lzbench_nvcomp_deinit(p->gpu);
+  free(p->tmp);
+  free(p);
+}
+
+// runs the GPU loop on the calling thread and cpu(i) on lzbench_hybrid_threads threads
+static void nvcomp_hybrid_run(const std::function<void()>& gpu, const std::function<void()>& cpu)
+{
+  std::vector<std::thread> threads;
+  for (int t = 0; t < lzbench_hybrid_threads; t++)
+    threads.push_back(std::thread(cpu));
+  gpu();
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+}
+
+/*
+ * The output is the number of slices and the slice size (32-bit) and the compressed size of every slice
+ * (32-bit, the top bit set for a slice of the GPU) followed by the slices.
+ */
+int64_t lzbench_nvcomp_hybrid_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* params)
+{
+  nvcomp_hybrid_params_s* p = (nvcomp_hybrid_params_s*) params;
+  uint32_t slices = (uint32_t)((insize + p->slice_size - 1) / p->slice_size), header = 4 * (2 + slices);
+  std::vector<uint32_t> sizes(slices, 0);
+  std::atomic<uint32_t> next(0);
+  std::atomic<bool> error(false);
+
+  if (slices > p->max_slices || outsize < header) return 0;
+  nvcomp_hybrid_run([&]() {
+    for (uint32_t i; (i = next++) < slices; ) {
+      size_t size = std::min(p->slice_size, insize - (size_t)i * p->slice_size);
+      int64_t csize = lzbench_nvcomp_compress(inbuf + (size_t)i * p->slice_size, size, p->tmp + i * p->bound, p->bound, level, 0, p->gpu);
+      if (csize <= 0 || (size_t)csize >= HYBRID_GPU_SLICE) { error = true; continue; }
+      sizes[i] = (uint32_t)csize | HYBRID_GPU_SLICE;
+      hybrid_gpu_bytes += size;
+    }
+  }, [&]() {
+    for (uint32_t i; (i = next++) < slices; ) {
+      size_t size = std::min(p->slice_size, insize - (size_t)i * p->slice_size);
+      int csize = LZ4_compress_default(inbuf + (size_t)i * p->slice_size, p->tmp + i * p->bound, (int)size, (int)p->bound);
+      if (csize <= 0) { error = true; continue; }
+      sizes[i] = (uint32_t)csize;
+    }
+  });
+  if (error) return 0;
+
+  uint32_t value = (uint32_t)p->slice_size;
+  size_t pos = header;
+  memcpy(outbuf, &slices, 4);
+  memcpy(outbuf + 4, &value, 4);
+  for (uint32_t i = 0; i < slices; i++) {
+    size_t csize = sizes[i] & ~HYBRID_GPU_SLICE;
+    if (pos + csize > outsize) return 0;
+    memcpy(outbuf + 8 + 4 * i, &sizes[i], 4);
+    memcpy(outbuf + pos, p->tmp + i * p->bound, csize);
+    pos += csize;
+  }
+  return pos;
+}
+
+int64_t lzbench_nvcomp_hybrid_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* params)
+{
+  nvcomp_hybrid_params_s* p = (nvcomp_hybrid_params_s*) params;
+  uint32_t slices, slice_size;
+  if (insize < 8) return 0;
+  memcpy(&slices, inbuf, 4);
+  memcpy(&slice_size, inbuf + 4, 4);
+  if (slice_size != p->slice_size || insize < 4 * (2 + (size_t)slices) || (size_t)slices * slice_size < outsize) return 0;
+
+  // each side takes the next of its own slices
+  std::vector<size_t> offsets(slices + 1);
+  std::vector<uint32_t> gpu_slices, cpu_slices;
+  offsets[0] = 4 * (2 + (size_t)slices);
+  for (uint32_t i = 0; i < slices; i++) {
+    uint32_t value;
+    memcpy(&value, inbuf + 8 + 4 * i, 4);
+    offsets[i + 1] = offsets[i] + (value & ~HYBRID_GPU_SLICE);
+    if (offsets[i + 1] > insize) return 0;
+    if (value & HYBRID_GPU_SLICE) gpu_slices.push_back(i); else cpu_slices.push_back(i);
+  }
+
+  std::atomic<size_t> next_gpu(0), next_cpu(0);
+  std::atomic<bool> error(false);
+  nvcomp_hybrid_run([&]() {
+    for (size_t k; (k = next_gpu++) < gpu_slices.size(); ) {
+      uint32_t i = gpu_slices[k];
+      size_t size = std::min(p->slice_size, outsize - (size_t)i * p->slice_size);
+      if (lzbench_nvcomp_decompress(inbuf + offsets[i], offsets[i + 1] - offsets[i], outbuf + (size_t)i * p->slice_size, size, 0, 0, p->gpu) != (int64_t)size) error = true;
+      hybrid_gpu_bytes += size;
+    }
+  }, [&]() {
+    for (size_t k; (k = next_cpu++) < cpu_slices.size(); ) {
+      uint32_t i = cpu_slices[k];
+      size_t size = std::min(p->slice_size, outsize - (size_t)i * p->slice_size);
+      if (LZ4_decompress_safe(inbuf + offsets[i], outbuf + (size_t)i * p->slice_size, (int)(offsets[i + 1] - offsets[i]), (int)size) != (int)size) error = true;
+    }
+  });
+  return error ? 0 : outsize;
+}
+#endif  // BENCH_REMOVE_LZ4
+
+// nvcomp_lz4_batch: the input of a call is split into pages that are compressed by a single batched launch,
+// the page size is configured by the compression level, 0 to 5 inclusive, from 32 kB to 1 MB like nvcomp_lz4.
+// With --gpus the workmem is an array of these, one per device, and a batch of chunks is split between them.
+typedef struct {
+  int device;
+  int index;                 // position in the array of --gpus
+  int devices;               // size of the array, set in the first entry
+  size_t max_pages;
+  size_t page_size;
+  size_t max_out;            // maximum compressed size of a page
+  size_t temp_size;
+  cudaStream_t stream;
+  cudaEvent_t events[2];     // before the upload and after the download of a batch
+  char* uncompressed_d;
+  char* compressed_d;        // pages at multiples of max_out for compression, packed for decompression
+  char* temp_d;
+  char* staging_h;           // pinned host copy of compressed_d
+  size_t* out_bytes_h;       // pinned, written by the device
+  const void** in_ptrs;
+  size_t* in_bytes;
+  void** out_ptrs;
+  nvcompLZ4FormatOpts opts;
+  size_t pages;              // pages of the batch in flight, 0 = idle
+  size_t bytes;              // uncompressed bytes of the batch in flight
+  void* metadata_ptr;        // of the batch in flight of decompression
+} nvcomp_batch_params_s;
+
+// set the pointers and sizes of the uncompressed pages of insize bytes
+static size_t nvcomp_batch_pages(nvcomp_batch_params_s* p, size_t insize)
+{
+  size_t pages = (insize + p->page_size - 1) / p->page_size;
+  for (size_t i = 0; i < pages; i++) {
+    p->in_ptrs[i] = p->uncompressed_d + i * p->page_size;
+    p->in_bytes[i] = std::min(p->page_size, insize - i * p->page_size);
+  }
+  return pages;
+}
+
+// buffers for batches of up to pages pages, init sizes them for a chunk and compress_batch grows them for its chunks
+static void nvcomp_batch_reserve(nvcomp_batch_params_s* p, size_t pages)
+{
+  if (p->uncompressed_d && pages <= p->max_pages) return;
+
+  int status = cudaSetDevice(p->device);
+  assert(status == cudaSuccess);
+
+  nvcomp_pool_free(p->staging_h, 1);
+  nvcomp_pool_free(p->out_bytes_h, 1);
+  nvcomp_pool_free(p->compressed_d, 0);
+  nvcomp_pool_free(p->temp_d, 0);
+  nvcomp_pool_free(p->uncompressed_d, 0);
+  free(p->out_ptrs);
+  free(p->in_bytes);
+  free(p->in_ptrs);
+
+  p->max_pages = pages;
+  p->max_out = 0;
+  p->in_ptrs = (const void**) malloc(p->max_pages * sizeof(void*));
+  p->in_bytes = (size_t*) malloc(p->max_pages * sizeof(size_t));
+  p->out_ptrs = (void**) malloc(p->max_pages * sizeof(void*));
+  assert(p->in_ptrs && p->in_bytes && p->out_ptrs);
+
+  status = nvcomp_pool_malloc((void**)&p->uncompressed_d, p->max_pages * p->page_size, 0);
+  assert(status == cudaSuccess);
+
+  // the temporary buffer and output sizes of a batch of full pages are the largest ones
+  size_t full = nvcomp_batch_pages(p, p->max_pages * p->page_size);
+  status = nvcompBatchedLZ4CompressGetTempSize(p->in_ptrs, p->in_bytes, full, &p->opts, &p->temp_size);
+  assert(status == nvcompSuccess);
+
+  status = nvcomp_pool_malloc((void**)&p->temp_d, p->temp_size, 0);
+  assert(status == cudaSuccess);
+
+  status = nvcomp_pool_malloc((void**)&p->out_bytes_h, p->max_pages * sizeof(size_t), 1);
+  assert(status == cudaSuccess);
+
+  status = nvcompBatchedLZ4CompressGetOutputSize(p->in_ptrs, p->in_bytes, full, &p->opts, p->temp_d, p->temp_size, p->out_bytes_h);
+  assert(status == nvcompSuccess);
+  for (size_t i = 0; i < full; i++)
+    p->max_out = std::max(p->max_out, p->out_bytes_h[i]);
+
+  status = nvcomp_pool_malloc((void**)&p->compressed_d, p->max_pages * p->max_out, 0);
+  assert(status == cudaSuccess);
+
+  status = nvcomp_pool_malloc((void**)&p->staging_h, p->max_pages * p->max_out, 1);
+  assert(status == cudaSuccess);
+}
+
+char* lzbench_nvcomp_batch_init(size_t insize, size_t level, size_t)
+{
+  int devices = std::min(std::max(lzbench_cuda_devices, 1), CUDA_DEVICES_MAX);
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) calloc(devices, sizeof(nvcomp_batch_params_s));
+  if (!p) return NULL;
+  p->devices = devices;
+
+  int status = 0, current = 0;
+  status = cudaGetDevice(&current);
+  assert(status == cudaSuccess);
+
+  // every device gets buffers for a whole chunk, the device of compress() and decompress() is the current one
+  for (int d = 0; d < devices; d++) {
+    nvcomp_batch_params_s* q = &p[d];
+    q->device = (devices > 1) ? d : current;
+    q->index = d;
+    q->page_size = q->opts.chunk_size = 1 << (15 + level);
+
+    status = cudaSetDevice(q->device);
+    assert(status == cudaSuccess);
+    status = nvcomp_pool_stream(&q->stream);
+    assert(status == cudaSuccess);
+    for (int e = 0; e < 2; e++) {
+      status = cudaEventCreate(&q->events[e]);
+      assert(status == cudaSuccess);
+    }
+
+    nvcomp_batch_reserve(q, std::max((insize + q->page_size - 1) / q->page_size, (size_t)1));
+  }
+
+  cudaSetDevice(current);
+  return (char*) p;
+}
+
+void lzbench_nvcomp_batch_deinit(char* params)
+{
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) params;
+  if (!p) return;
+
+  for (int d = 0; d < p->devices; d++) {
+    nvcomp_batch_params_s* q = &p[d];
+    cudaSetDevice(q->device);
+    nvcomp_pool_free(q->staging_h, 1);
+    nvcomp_pool_free(q->out_bytes_h, 1);
+    nvcomp_pool_free(q->compressed_d, 0);
+    nvcomp_pool_free(q->temp_d, 0);
+    nvcomp_pool_free(q->uncompressed_d, 0);
+    cudaEventDestroy(q->events[0]);
+    cudaEventDestroy(q->events[1]);
+    nvcomp_pool_stream_free(q->stream);
+    free(q->out_ptrs);
+    free(q->in_bytes);
+    free(q->in_ptrs);
+  }
+  cudaSetDevice(p->device);
+  free(p);
+}
+
+/*
+ * The output is the number of pages and the compressed size of every page (64-bit) followed by the pages.
+ * The compressed pages are copied back to the host in one transfer and packed there, as their sizes are known
+ * only after the launch.
+ */
+int64_t lzbench_nvcomp_batch_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* params)
+{
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) params;
+  int status = 0;
+
+  size_t pages = nvcomp_batch_pages(p, insize);
+  size_t pos = sizeof(uint64_t) * (1 + pages);
+  if (pages > p->max_pages || pos > outsize) return 0;
+  for (size_t i = 0; i < pages; i++) {
+    p->out_ptrs[i] = p->compressed_d + i * p->max_out;
+    p->out_bytes_h[i] = p->max_out;
+  }
+
+  status = cudaMemcpyAsync(p->uncompressed_d, inbuf, insize, cudaMemcpyHostToDevice, p->stream);
+  assert(status == cudaSuccess);
+
+  // compress all the pages with a single launch
+  status = nvcompBatchedLZ4CompressAsync(p->in_ptrs, p->in_bytes, pages, &p->opts, p->temp_d, p->temp_size, p->out_ptrs, p->out_bytes_h, p->stream);
+  assert(status == nvcompSuccess);
+
+  status = cudaMemcpyAsync(p->staging_h, p->compressed_d, pages * p->max_out, cudaMemcpyDeviceToHost, p->stream);
+  assert(status == cudaSuccess);
+
+  status = cudaStreamSynchronize(p->stream);
+  assert(status == cudaSuccess);
+
+  uint64_t value = pages;
+  memcpy(outbuf, &value, sizeof(value));
+  for (size_t i = 0; i < pages; i++) {
+    if (pos + p->out_bytes_h[i] > outsize) return 0;
+    value = p->out_bytes_h[i];
+    memcpy(outbuf + sizeof(uint64_t) * (1 + i), &value, sizeof(value));
+    memcpy(outbuf + pos, p->staging_h + i * p->max_out, p->out_bytes_h[i]);
+    pos += p->out_bytes_h[i];
+  }
+  return pos;
+}
+
+int64_t lzbench_nvcomp_batch_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* params)
+{
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) params;
+  int status = 0;
+
+  uint64_t pages, value;
+  if (insize < sizeof(pages)) return 0;
+  memcpy(&pages, inbuf, sizeof(pages));
+  size_t header = sizeof(uint64_t) * (1 + pages);
+  if (pages > p->max_pages || header > insize || pages != nvcomp_batch_pages(p, outsize)) return 0;
+
+  // the pages are uploaded packed in one transfer
+  size_t pos = 0;
+  for (size_t i = 0; i < pages; i++) {
+    memcpy(&value, inbuf + sizeof(uint64_t) * (1 + i), sizeof(value));
+    p->in_ptrs[i] = p->compressed_d + pos;
+    p->out_ptrs[i] = p->uncompressed_d + i * p->page_size;
+    p->out_bytes_h[i] = p->in_bytes[i];
+    p->in_bytes[i] = value;
+    pos += value;
+  }
+  if (header + pos > insize || pos > p->max_pages * p->max_out) return 0;
+
+  status = cudaMemcpyAsync(p->compressed_d, inbuf + header, pos, cudaMemcpyHostToDevice, p->stream);
+  assert(status == cudaSuccess);
+
+  // extract the metadata of all the pages
+  void* metadata_ptr;
+  status = nvcompBatchedLZ4DecompressGetMetadata(p->in_ptrs, p->in_bytes, pages, &metadata_ptr, p->stream);
+  assert(status == nvcompSuccess);
+
+  // the temporary buffer of decompression may be larger than the one of compression
+  size_t temp_size;
+  status = nvcompBatchedLZ4DecompressGetTempSize(metadata_ptr, &temp_size);
+  assert(status == nvcompSuccess);
+  if (temp_size > p->temp_size) {
+    nvcomp_pool_free(p->temp_d, 0);
+    status = nvcomp_pool_malloc((void**)&p->temp_d, temp_size, 0);
+    assert(status == cudaSuccess);
+    p->temp_size = temp_size;
+  }
+
+  // decompress all the pages with a single launch
+  status = nvcompBatchedLZ4DecompressAsync(p->in_ptrs, p->in_bytes, pages, p->temp_d, p->temp_size, metadata_ptr, p->out_ptrs, p->out_bytes_h, p->stream);
+  assert(status == nvcompSuccess);
+
+  status = cudaMemcpyAsync(outbuf, p->uncompressed_d, outsize, cudaMemcpyDeviceToHost, p->stream);
+  assert(status == cudaSuccess);
+
+  status = cudaStreamSynchronize(p->stream);
+  assert(status == cudaSuccess);
+
+  nvcompBatchedLZ4DecompressDestroyMetadata(metadata_ptr);
+
+  return outsize;
+}
+
+/*
+ * --gpus: the chunks of a batch are split into runs of consecutive chunks of about the same number of bytes,
+ * one per device, first[d] is the first chunk of device d and first[devices] = n
+ */
+static void nvcomp_batch_split(int devices, size_t n, const size_t *size, size_t *first)
+{
+  size_t total = 0, sum = 0, c = 0;
+  for (size_t i = 0; i < n; i++)
+    total += size[i];
+
+  first[0] = 0;
+  for (int d = 1; d <= devices; d++) {
+    // a chunk goes to the device of its middle byte
+    while (c < n && (d == devices || sum + size[c] / 2 < total * d / devices))
+      sum += size[c++];
+    first[d] = c;
+  }
+}
+
+// wait for the batch in flight of a device and take the time between its events
+static void nvcomp_batch_wait(nvcomp_batch_params_s* p)
+{
+  if (!p->pages) return;
+
+  int status = cudaSetDevice(p->device);
+  assert(status == cudaSuccess);
+  status = cudaStreamSynchronize(p->stream);
+  assert(status == cudaSuccess);
+
+  float ms = 0;
+  if (cudaEventElapsedTime(&ms, p->events[0], p->events[1]) == cudaSuccess) {
+    cuda_device_ns[p->index] += (uint64_t)(ms * 1e6);
+    cuda_device_bytes[p->index] += p->bytes;
+  }
+  if (p->metadata_ptr) nvcompBatchedLZ4DecompressDestroyMetadata(p->metadata_ptr);
+  p->metadata_ptr = NULL;
+  p->pages = 0;
+}
+
+// queue the upload, the launch and the download of the pages of n chunks on the stream of a device
+static void nvcomp_batch_compress_launch(nvcomp_batch_params_s* p, size_t n, char **in, const size_t *insize)
+{
+  int status = 0;
+
+  size_t pages = 0, bytes = 0;
+  for (size_t c = 0; c < n; c++) {
+    pages += (insize[c] + p->page_size - 1) / p->page_size;
+    bytes += insize[c];
+  }
+  if (!pages) return;
+  nvcomp_batch_reserve(p, pages);
+
+  status = cudaSetDevice(p->device);
+  assert(status == cudaSuccess);
+  status = cudaEventRecord(p->events[0], p->stream);
+  assert(status == cudaSuccess);
+
+  size_t page = 0;
+  for (size_t c = 0; c < n; c++) {
+    size_t chunk_pages = (insize[c] + p->page_size - 1) / p->page_size;
+    for (size_t i = 0; i < chunk_pages; i++, page++) {
+      p->in_ptrs[page] = p->uncompressed_d + page * p->page_size;
+      p->in_bytes[page] = std::min(p->page_size, insize[c] - i * p->page_size);
+      p->out_ptrs[page] = p->compressed_d + page * p->max_out;
+      p->out_bytes_h[page] = p->max_out;
+    }
+    if (!chunk_pages) continue;
+    status = cudaMemcpyAsync((void*)p->in_ptrs[page - chunk_pages], in[c], insize[c], cudaMemcpyHostToDevice, p->stream);
+    assert(status == cudaSuccess);
+  }
+
+  status = nvcompBatchedLZ4CompressAsync(p->in_ptrs, p->in_bytes, pages, &p->opts, p->temp_d, p->temp_size, p->out_ptrs, p->out_bytes_h, p->stream);
+  assert(status == nvcompSuccess);
+
+  status = cudaMemcpyAsync(p->staging_h, p->compressed_d, pages * p->max_out, cudaMemcpyDeviceToHost, p->stream);
+  assert(status == cudaSuccess);
+
+  status = cudaEventRecord(p->events[1], p->stream);
+  assert(status == cudaSuccess);
+  p->pages = pages;
+  p->bytes = bytes;
+}
+
+// pack the pages of a finished batch of a device into the outputs of its chunks
+static void nvcomp_batch_compress_pack(nvcomp_batch_params_s* p, size_t n, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes)
+{
+  size_t page = 0;
+  for (size_t c = 0; c < n; c++) {
+    uint64_t value = (insize[c] + p->page_size - 1) / p->page_size;
+    size_t pos = sizeof(uint64_t) * (1 + value);
+    sizes[c] = (pos <= outsize[c]) ? 1 : 0;
+    if (sizes[c]) memcpy(out[c], &value, sizeof(value));
+    for (size_t i = 0, chunk_pages = value; i < chunk_pages; i++, page++) {
+      if (!sizes[c] || pos + p->out_bytes_h[page] > outsize[c]) { sizes[c] = 0; continue; }
+      value = p->out_bytes_h[page];
+      memcpy(out[c] + sizeof(uint64_t) * (1 + i), &value, sizeof(value));
+      memcpy(out[c] + pos, p->staging_h + page * p->max_out, p->out_bytes_h[page]);
+      pos += p->out_bytes_h[page];
+    }
+    if (sizes[c]) sizes[c] = pos;
+  }
+}
+
+/*
+ * compress_batch and decompress_batch of nvcomp_lz4_batch: the pages of all chunks of the batch go to a single launch,
+ * every chunk starts at a page of its own and gets the format of lzbench_nvcomp_batch_compress(). With --gpus every
+ * device gets a run of chunks, all devices are launched before the first one is waited for.
+ */
+int64_t lzbench_nvcomp_batch_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* params)
+{
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) params;
+
+  size_t total = 0, first[CUDA_DEVICES_MAX + 1];
+  for (size_t c = 0; c < n; c++)
+    total += insize[c];
+  if (!total) return -1;
+  nvcomp_batch_split(p->devices, n, insize, first);
+
+  for (int d = 0; d < p->devices; d++)
+    nvcomp_batch_compress_launch(&p[d], first[d + 1] - first[d], in + first[d], insize + first[d]);
+
+  for (int d = 0; d < p->devices; d++) {
+    nvcomp_batch_wait(&p[d]);
+    nvcomp_batch_compress_pack(&p[d], first[d + 1] - first[d], insize + first[d], out + first[d], outsize + first[d], sizes + first[d]);
+  }
+
+  cudaSetDevice(p->device);
+  return 0;
+}
+
+// queue the uploads, the launch and the downloads of n chunks on the stream of a device, -1 = invalid input
+static int64_t nvcomp_batch_decompress_launch(nvcomp_batch_params_s* p, size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes)
+{
+  int status = 0;
+
+  // the pages of all chunks are uploaded packed, one transfer per chunk
+  size_t pages = 0, pos = 0, bytes = 0;
+  for (size_t c = 0; c < n; c++) {
+    uint64_t chunk_pages;
+    if (insize[c] < sizeof(chunk_pages)) return -1;
+    memcpy(&chunk_pages, in[c], sizeof(chunk_pages));
+    if (chunk_pages != (outsize[c] + p->page_size - 1) / p->page_size || sizeof(uint64_t) * (1 + chunk_pages) > insize[c]) return -1;
+    pages += chunk_pages;
+    pos += insize[c] - sizeof(uint64_t) * (1 + chunk_pages);
+    bytes += outsize[c];
+    sizes[c] = outsize[c];
+  }
+  if (!pages) return 0;
+  nvcomp_batch_reserve(p, pages);
+  if (pos > p->max_pages * p->max_out) return -1;
+
+  size_t page = 0;
+  pos = 0;
+  for (size_t c = 0; c < n; c++) {
+    uint64_t chunk_pages, value;
+    memcpy(&chunk_pages, in[c], sizeof(chunk_pages));
+    size_t header = sizeof(uint64_t) * (1 + chunk_pages), start = pos;
+    for (size_t i = 0; i < chunk_pages; i++, page++) {
+      memcpy(&value, in[c] + sizeof(uint64_t) * (1 + i), sizeof(value));
+      p->in_ptrs[page] = p->compressed_d + pos;
+      p->in_bytes[page] = value;
+      p->out_ptrs[page] = p->uncompressed_d + page * p->page_size;
+      p->out_bytes_h[page] = std::min(p->page_size, outsize[c] - i * p->page_size);
+      pos += value;
+    }
+    if (header + pos - start != insize[c]) return -1;
+  }
+
+  status = cudaSetDevice(p->device);
+  assert(status == cudaSuccess);
+  status = cudaEventRecord(p->events[0], p->stream);
+  assert(status == cudaSuccess);
+
+  pos = 0;
+  for (size_t c = 0; c < n; c++) {
+    uint64_t chunk_pages;
+    memcpy(&chunk_pages, in[c], sizeof(chunk_pages));
+    size_t header = sizeof(uint64_t) * (1 + chunk_pages);
+    status = cudaMemcpyAsync(p->compressed_d + pos, in[c] + header, insize[c] - header, cudaMemcpyHostToDevice, p->stream);
+    assert(status == cudaSuccess);
+    pos += insize[c] - header;
+  }
+
+  status = nvcompBatchedLZ4DecompressGetMetadata(p->in_ptrs, p->in_bytes, pages, &p->metadata_ptr, p->stream);
+  assert(status == nvcompSuccess);
+
+  size_t temp_size;
+  status = nvcompBatchedLZ4DecompressGetTempSize(p->metadata_ptr, &temp_size);
+  assert(status == nvcompSuccess);
+  if (temp_size > p->temp_size) {
+    nvcomp_pool_free(p->temp_d, 0);
+    status = nvcomp_pool_malloc((void**)&p->temp_d, temp_size, 0);
+    assert(status == cudaSuccess);
+    p->temp_size = temp_size;
+  }
+
+  status = nvcompBatchedLZ4DecompressAsync(p->in_ptrs, p->in_bytes, pages, p->temp_d, p->temp_size, p->metadata_ptr, p->out_ptrs, p->out_bytes_h, p->stream);
+  assert(status == nvcompSuccess);
+
+  page = 0;
+  for (size_t c = 0; c < n; c++) {
+    if (!outsize[c]) continue;
+    status = cudaMemcpyAsync(out[c], p->out_ptrs[page], outsize[c], cudaMemcpyDeviceToHost, p->stream);
+    assert(status == cudaSuccess);
+    page += (outsize[c] + p->page_size - 1) / p->page_size;
+  }
+
+  status = cudaEventRecord(p->events[1], p->stream);
+  assert(status == cudaSuccess);
+  p->pages = pages;
+  p->bytes = bytes;
+  return 0;
+}
+
+int64_t lzbench_nvcomp_batch_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* params)
+{
+  nvcomp_batch_params_s* p = (nvcomp_batch_params_s*) params;
+
+  size_t total = 0, first[CUDA_DEVICES_MAX + 1];
+  for (size_t c = 0; c < n; c++)
+    total += outsize[c];
+  if (!total) return -1;
+  nvcomp_batch_split(p->devices, n, outsize, first);
+
+  // the devices launched before invalid input are still waited for
+  int64_t result = 0;
+  for (int d = 0; d < p->devices && !result; d++)
+    result = nvcomp_batch_decompress_launch(&p[d], first[d + 1] - first[d], in + first[d], insize + first[d], out + first[d], outsize + first[d], sizes + first[d]);
+
+  for (int d = 0; d < p->devices; d++)
+    nvcomp_batch_wait(&p[d]);
+
+  cudaSetDevice(p->device);
+  return result;
+}
+
+// nvcomp_cascaded: run length encoding, delta encoding and bit packing of the input seen as integers of
+// 1, 2, 4 or 8 bytes (the additional parameter), level 0 = configuration chosen by the selector on a sample,
+// levels 1 to 9 = 0-2 RLE passes and 0-2 delta passes with bit packing, bytes after the last integer are stored
+#include "nvcomp/cascaded.h"
+
+typedef struct {
+  size_t buffer_size;
+  size_t compressed_max_size;
+  size_t* compressed_size;
+  cudaStream_t stream;
+  char* uncompressed_d;
+  char* buffer_d;
+  char* compressed_d;
+  nvcompType_t type;
+  size_t width;
+  nvcompCascadedFormatOpts opts;
+  nvcompCascadedSelectorOpts selector_opts;
+} nvcomp_cascaded_params_s;
+
+static nvcompType_t nvcomp_cascaded_type(size_t width)
+{
+  switch (width) {
+    case 1: return NVCOMP_TYPE_CHAR;
+    case 2: return NVCOMP_TYPE_SHORT;
+    case 8: return NVCOMP_TYPE_LONGLONG;
+    default: return NVCOMP_TYPE_INT;
+  }
+}
+
+static nvcompCascadedFormatOpts nvcomp_cascaded_opts(size_t level)
+{
+  nvcompCascadedFormatOpts opts;
+  opts.num_RLEs = (int)(level - 1) / 3;
+  opts.num_deltas = (int)(level - 1) % 3;
+  opts.use_bp = 1;
+  return opts;
+}
+
+char* lzbench_nvcomp_cascaded_init(size_t insize, size_t level, size_t width)
+{
+  nvcomp_cascaded_params_s* p = (nvcomp_cascaded_params_s*) calloc(1, sizeof(nvcomp_cascaded_params_s));
+  if (!p) return NULL;
+
+  int status = 0;
+  p->width = width ? width : 4;
+  p->type = nvcomp_cascaded_type(p->width);
+  size_t in_bytes = insize / p->width * p->width;
+
+  // the selector takes up to 100 samples of 1024 integers
+  size_t elements = std::max(in_bytes / p->width, (size_t)1);
+  p->selector_opts.sample_size = std::min(elements, (size_t)1024);
+  p->selector_opts.num_samples = std::max(std::min(elements / p->selector_opts.sample_size, (size_t)100), (size_t)1);
+  p->selector_opts.seed = 1;
+
+  status = nvcomp_pool_stream(&p->stream);
+  assert(status == cudaSuccess);
+  status = nvcomp_pool_malloc((void**)&p->uncompressed_d, std::max(in_bytes, p->width), 0);
+  assert(status == cudaSuccess);
+
+  // the temporary buffer and the output bound are the largest of the configurations the level can use
+  size_t first = level ? level : 1, last = level ? level : 9, temp_size;
+  if (level == 0) {
+    status = nvcompCascadedSelectorGetTempSize(in_bytes, p->type, p->selector_opts, &p->buffer_size);
+    assert(status == nvcompSuccess);
+  }
+  for (size_t l = first; l <= last; l++) {
+    nvcompCascadedFormatOpts opts = nvcomp_cascaded_opts(l);
+    status = nvcompCascadedCompressGetTempSize(p->uncompressed_d, in_bytes, p->type, &opts, &temp_size);
+    assert(status == nvcompSuccess);
+    p->buffer_size = std::max(p->buffer_size, temp_size);
+  }
+  status = nvcomp_pool_malloc((void**)&p->buffer_d, p->buffer_size, 0);
+  assert(status == cudaSuccess);
+  for (size_t l = first; l <= last; l++) {
+    nvcompCascadedFormatOpts opts = nvcomp_cascaded_opts(l);
+    size_t out_size;
+    status = nvcompCascadedCompressGetOutputSize(p->uncompressed_d, in_bytes, p->type, &opts, p->buffer_d, p->buffer_size, &out_size, 0);
+    assert(status == nvcompSuccess);
+    p->compressed_max_size = std::max(p->compressed_max_size, out_size);
+  }
+  status = nvcomp_pool_malloc((void**)&p->compressed_d, p->compressed_max_size, 0);
+  assert(status == cudaSuccess);
+  status = nvcomp_pool_malloc((void**)&p->compressed_size, sizeof(size_t), 1);
+  assert(status == cudaSuccess);
+
+  p->opts = nvcomp_cascaded_opts(first);
+  return (char*) p;
+}
+
+void lzbench_nvcomp_cascaded_deinit(char* params)
+{
+  nvcomp_cascaded_params_s* p = (nvcomp_cascaded_params_s*) params;
+  if (!p) return;
+
+  nvcomp_pool_free(p->compressed_size, 1);
+  nvcomp_pool_free(p->compressed_d, 0);
+  nvcomp_pool_free(p->buffer_d, 0);
+  nvcomp_pool_free(p->uncompressed_d, 0);
+  nvcomp_pool_stream_free(p->stream);
+  free(p);
+}
+
+int64_t lzbench_nvcomp_cascaded_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* params)
+{
+  nvcomp_cascaded_params_s* p = (nvcomp_cascaded_params_s*) params;
+  int status = 0;
+  size_t in_bytes = insize / p->width * p->width, tail = insize - in_bytes;
+  if (!in_bytes) return 0;
+
+  status = cudaMemcpyAsync(p->uncompressed_d, inbuf, in_bytes, cudaMemcpyHostToDevice, p->stream);
+  assert(status == cudaSuccess);
+
+  // the selector is a part of the compression time, it synchronizes the stream
+  if (level == 0) {
+    double ratio;
+    status = nvcompCascadedSelectorSelectConfig(p->uncompressed_d, in_bytes, p->type, p->selector_opts, p->buffer_d, p->buffer_size, &p->opts, &ratio, p->stream);
+    assert(status == nvcompSuccess);
+  }
+
+  *p->compressed_size = p->compressed_max_size;
+  status = nvcompCascadedCompressAsync(p->uncompressed_d, in_bytes, p->type, &p->opts, p->buffer_d, p->buffer_size,
+                                       p->compressed_d, p->compressed_size, p->stream);
+  assert(status == nvcompSuccess);
+
+  size_t size = std::min(p->compressed_max_size, outsize);
+  status = cudaMemcpyAsync(outbuf, p->compressed_d, size, cudaMemcpyDeviceToHost, p->stream);
+  assert(status == cudaSuccess);
+  status = cudaStreamSynchronize(p->stream);
+  assert(status == cudaSuccess);
+
+  size_t csize = *p->compressed_size;
+  if (csize + tail > outsize) return 0;
+  memcpy(outbuf + csize, inbuf + in_bytes, tail);
+  return csize + tail;
+}
+
+int64_t lzbench_nvcomp_cascaded_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* params)
+{
+  nvcomp_cascaded_params_s* p = (nvcomp_cascaded_params_s*) params;
+  int status = 0;
+  size_t out_bytes = outsize / p->width * p->width, tail = outsize - out_bytes;
+  if (insize <= tail || insize - tail > p->compressed_max_size) return 0;
+  insize -= tail;
+
+  status = cudaMemcpyAsync(p->compressed_d, inbuf, insize, cudaMemcpyHostToDevice, p->stream);
+  assert(status == cudaSuccess);
+
+  void* metadata_ptr;
+  status = nvcompCascadedDecompressGetMetadata(p->compressed_d, insize, &metadata_ptr, p->stream);
+  assert(status == nvcompSuccess);
+
+  size_t buffer_size, uncompressed_size;
+  status = nvcompCascadedDecompressGetTempSize(metadata_ptr, &buffer_size);
+  assert(status == nvcompSuccess);
+  assert(buffer_size <= p->buffer_size);
+  status = nvcompCascadedDecompressGetOutputSize(metadata_ptr, &uncompressed_size);
+  assert(status == nvcompSuccess);
+  assert(uncompressed_size == out_bytes);
+
+  status = nvcompCascadedDecompressAsync(p->compressed_d, insize, p->buffer_d, p->buffer_size, metadata_ptr,
+                                         p->uncompressed_d, out_bytes, p->stream);
+  assert(status == nvcompSuccess);
+  status = cudaMemcpyAsync(outbuf, p->uncompressed_d, out_bytes, cudaMemcpyDeviceToHost, p->stream);
+  assert(status == cudaSuccess);
+  status = cudaStreamSynchronize(p->stream);
+  assert(status == cudaSuccess);
+  nvcompCascadedDecompressDestroyMetadata(metadata_ptr);
+
+  memcpy(outbuf + out_bytes, inbuf + insize, tail);
+  return outsize;
+}
+
 #endif  // BENCH_HAS_NVCOMP
 
 #endif  // BENCH_HAS_CUDA
@@ -6,15 +6,82 @@
 
 int64_t lzbench_memcpy(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t , size_t, char* );
 int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t , size_t, char* );
+size_t lzbench_copy_bound(size_t insize);
+int64_t lzbench_memcpy_short(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+	int64_t lzbench_memcpy_movsb(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_memcpy_avx2(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_memcpy_avx2nt(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_memcpy_avx512(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_memcpy_avx512nt(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+#else
+	#define lzbench_memcpy_movsb NULL
+	#define lzbench_memcpy_avx2 NULL
+	#define lzbench_memcpy_avx2nt NULL
+	#define lzbench_memcpy_avx512 NULL
+	#define lzbench_memcpy_avx512nt NULL
+#endif
+
+int64_t lzbench_intpack_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char*); // intcodecs.cpp
+int64_t lzbench_intpack_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char*);
+int64_t lzbench_streamvbyte_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+int64_t lzbench_streamvbyte_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+int64_t lzbench_gorilla_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t width, char*); // fpcodecs.cpp
+int64_t lzbench_gorilla_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t width, char*);
+char*   lzbench_fpc_init(size_t insize, size_t level, size_t);
+void    lzbench_fpc_deinit(char* workmem);
+int64_t lzbench_fpc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char* workmem);
+int64_t lzbench_fpc_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char* workmem);
+char*   lzbench_kernel_init(size_t insize, size_t level, size_t algorithm); // kernelcodecs.cpp
+const char* lzbench_kernel_check(size_t level, size_t algorithm); // the step that fails to set up a zram device, NULL if none
+void    lzbench_kernel_deinit(char* workmem);
+int64_t lzbench_kernel_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+int64_t lzbench_kernel_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+
+void* lzbench_mem_alloc(size_t size);
+void lzbench_mem_free(void* ptr);
+size_t lzbench_mem_size(void* ptr);
+void lzbench_mem_stats(int64_t* current, int64_t* peak, uint64_t* allocs);
+void lzbench_mem_reset_peak();
+
+extern int lzbench_context_reuse;
+extern int lzbench_mem_arena;
+extern const char* lzbench_dict;
+extern size_t lzbench_dict_size;
+
+/* options of "-e name,level:key=value", -1 = the value of the level */
+typedef struct
+{
+    int wlog, clog, hlog, slog, mml, tlen, strategy; // zstd
+    int lgwin, lgblock; // brotli
+    int dict, lc, lp, pb, fb; // lzma, lzmamt and xz, dict in bytes
+    int favordec; // lz4hc
+    int frame; // zstd_seekable, bytes of input of a frame
+} codec_options_t;
+extern thread_local codec_options_t lzbench_options; // per thread for --parallel
+void lzbench_reset_options(codec_options_t* options);
+struct lzbench_pool_t;
+lzbench_pool_t* lzbench_pool_create();
+void* lzbench_pool_alloc(lzbench_pool_t* pool, size_t size);
+void lzbench_pool_free(lzbench_pool_t* pool, void* ptr);
+void lzbench_pool_destroy(lzbench_pool_t* pool);
 
 
 
 #ifndef BENCH_REMOVE_BLOSCLZ
 	int64_t lzbench_blosclz_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_blosclz_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_memcpy_fastcopy(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	extern int lzbench_blosclzmt_threads, lzbench_blosclzmt_typesize, lzbench_blosclzmt_shuffle;
+	extern size_t lzbench_blosclzmt_block_size;
+	int64_t lzbench_blosclzmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_blosclzmt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
 	#define lzbench_blosclz_compress NULL
 	#define lzbench_blosclz_decompress NULL
+	#define lzbench_memcpy_fastcopy NULL
+	#define lzbench_blosclzmt_compress NULL
+	#define lzbench_blosclzmt_decompress NULL
 #endif
 
 
@@ -32,20 +99,56 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 
 
 #ifndef BENCH_REMOVE_BROTLI
+	char* lzbench_brotli_init(size_t insize, size_t level, size_t);
+	void lzbench_brotli_deinit(char* workmem);
 	int64_t lzbench_brotli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	size_t lzbench_brotli_bound(size_t insize);
 	int64_t lzbench_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_brotli_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_brotli_stream_begin(size_t level, size_t);
+	int64_t lzbench_brotli_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize);
+	int64_t lzbench_brotli_stream_flush(char* state, char *outbuf, size_t outsize);
+	int64_t lzbench_brotli_stream_end(char* state, char *outbuf, size_t outsize);
+	extern const char* lzbench_brotli_dict;
+	extern size_t lzbench_brotli_dict_size;
+	extern uint64_t lzbench_brotli_dict_prepare_ns, lzbench_brotli_dict_call_ns; // of the last init
+	char* lzbench_brotli_dict_init(size_t insize, size_t level, size_t);
+	int64_t lzbench_brotli_dict_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 #else
+	#define lzbench_brotli_init NULL
+	#define lzbench_brotli_deinit NULL
 	#define lzbench_brotli_compress NULL
+	#define lzbench_brotli_bound NULL
 	#define lzbench_brotli_decompress NULL
+	#define lzbench_brotli_first_bytes NULL
+	#define lzbench_brotli_stream_begin NULL
+	#define lzbench_brotli_stream_feed NULL
+	#define lzbench_brotli_stream_flush NULL
+	#define lzbench_brotli_stream_end NULL
+	#define lzbench_brotli_dict_init NULL
+	#define lzbench_brotli_dict_compress NULL
 #endif
 
 
 #ifndef BENCH_REMOVE_BZIP2
+	char* lzbench_bzip2_init(size_t insize, size_t level, size_t);
+	void lzbench_bzip2_deinit(char* workmem);
 	int64_t lzbench_bzip2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_bzip2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern int lzbench_pbzip2_threads;
+	char* lzbench_pbzip2_init(size_t insize, size_t level, size_t);
+	void lzbench_pbzip2_deinit(char* workmem);
+	int64_t lzbench_pbzip2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_pbzip2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
+	#define lzbench_bzip2_init NULL
+	#define lzbench_bzip2_deinit NULL
 	#define lzbench_bzip2_compress NULL
 	#define lzbench_bzip2_decompress NULL
+	#define lzbench_pbzip2_init NULL
+	#define lzbench_pbzip2_deinit NULL
+	#define lzbench_pbzip2_compress NULL
+	#define lzbench_pbzip2_decompress NULL
 #endif // BENCH_REMOVE_BZIP2
 
 
@@ -93,16 +196,35 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 #ifndef BENCH_REMOVE_FASTLZMA2
 	int64_t lzbench_fastlzma2_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_fastlzma2_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern int lzbench_fastlzma2mt_threads;
+	char* lzbench_fastlzma2mt_init(size_t insize, size_t level, size_t);
+	void lzbench_fastlzma2mt_deinit(char* workmem);
+	int64_t lzbench_fastlzma2mt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_fastlzma2mt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	#ifdef BENCH_HAS_FASTLZMA2_ASM
+		int64_t lzbench_fastlzma2_asm_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	#else
+		#define lzbench_fastlzma2_asm_decompress NULL
+	#endif
 #else
 	#define lzbench_fastlzma2_compress NULL
 	#define lzbench_fastlzma2_decompress NULL
+	#define lzbench_fastlzma2_asm_decompress NULL
+	#define lzbench_fastlzma2mt_init NULL
+	#define lzbench_fastlzma2mt_deinit NULL
+	#define lzbench_fastlzma2mt_compress NULL
+	#define lzbench_fastlzma2mt_decompress NULL
 #endif
 
 
 #ifndef BENCH_REMOVE_GIPFELI
+	char* lzbench_gipfeli_init(size_t insize, size_t level, size_t);
+	void lzbench_gipfeli_deinit(char* workmem);
 	int64_t lzbench_gipfeli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_gipfeli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
+	#define lzbench_gipfeli_init NULL
+	#define lzbench_gipfeli_deinit NULL
 	#define lzbench_gipfeli_compress NULL
 	#define lzbench_gipfeli_decompress NULL
 #endif
@@ -118,24 +240,115 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 
 
 #ifndef BENCH_REMOVE_LIBDEFLATE
+	char* lzbench_libdeflate_init(size_t insize, size_t level, size_t);
+	void lzbench_libdeflate_deinit(char* workmem);
 	int64_t lzbench_libdeflate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	size_t lzbench_libdeflate_bound(size_t insize);
+	size_t lzbench_libdeflate_gzip_bound(size_t insize);
+	size_t lzbench_libdeflate_zlib_bound(size_t insize);
 	int64_t lzbench_libdeflate_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_libdeflate_gzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_libdeflate_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_libdeflate_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_libdeflate_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_crc32_libdeflate_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_adler32_libdeflate_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
+	#define lzbench_libdeflate_init NULL
+	#define lzbench_libdeflate_deinit NULL
 	#define lzbench_libdeflate_compress NULL
+	#define lzbench_libdeflate_bound NULL
+	#define lzbench_libdeflate_gzip_bound NULL
+	#define lzbench_libdeflate_zlib_bound NULL
 	#define lzbench_libdeflate_decompress NULL
+	#define lzbench_libdeflate_gzip_compress NULL
+	#define lzbench_libdeflate_zlib_compress NULL
+	#define lzbench_libdeflate_gzip_decompress NULL
+	#define lzbench_libdeflate_zlib_decompress NULL
+	#define lzbench_crc32_libdeflate_hash NULL
+	#define lzbench_adler32_libdeflate_hash NULL
 #endif
 
 
 #ifndef BENCH_REMOVE_LZ4
+	char* lzbench_lz4_init(size_t insize, size_t level, size_t);
+	void lzbench_lz4_deinit(char* workmem);
 	int64_t lzbench_lz4_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	size_t lzbench_lz4_bound(size_t insize);
 	int64_t lzbench_lz4fast_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize,  size_t level, size_t, char*);
 	int64_t lzbench_lz4hc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize,  size_t level, size_t, char*);
+	char* lzbench_lz4_extstate_init(size_t insize, size_t level, size_t);
+	void lzbench_lz4_extstate_deinit(char* workmem);
+	int64_t lzbench_lz4_extstate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+	char* lzbench_lz4hc_extstate_init(size_t insize, size_t level, size_t);
+	void lzbench_lz4hc_extstate_deinit(char* workmem);
+	int64_t lzbench_lz4hc_extstate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
 	int64_t lzbench_lz4_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_lz4_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_lz4_decompress_fast(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_lz4_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t, char* workmem);
+	int64_t lzbench_lz4_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem);
+	int64_t lzbench_lz4_inplace_margin(char *inbuf, size_t insize, size_t outsize);
+	int64_t lzbench_lz4_interleaved_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*); // interleaved.cpp
+	int64_t lzbench_lz4_interleaved_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t param2, char*);
+	char* lzbench_lz4_mem_init(size_t insize, size_t level, size_t);
+	void lzbench_lz4_mem_deinit(char* workmem);
+	int64_t lzbench_lz4_m12_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_lz4_m14_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_lz4_m16_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_lz4_m18_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_lz4_m20_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	char* lzbench_lz4_stream_begin(size_t level, size_t);
+	int64_t lzbench_lz4_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize);
+	int64_t lzbench_lz4_stream_end(char* state, char *outbuf, size_t outsize);
+	int64_t lzbench_lz4_stream_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern size_t lzbench_lz4_block_size;
+	char* lzbench_lz4linked_init(size_t insize, size_t level, size_t);
+	void lzbench_lz4linked_deinit(char* workmem);
+	int64_t lzbench_lz4stream_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_lz4frame_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_lz4framecrc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_lz4frame_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_lz4frame_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
+	#define lzbench_lz4_init NULL
+	#define lzbench_lz4_deinit NULL
 	#define lzbench_lz4_compress NULL
+	#define lzbench_lz4_bound NULL
 	#define lzbench_lz4fast_compress NULL
 	#define lzbench_lz4hc_compress NULL
+	#define lzbench_lz4_extstate_init NULL
+	#define lzbench_lz4_extstate_deinit NULL
+	#define lzbench_lz4_extstate_compress NULL
+	#define lzbench_lz4hc_extstate_init NULL
+	#define lzbench_lz4hc_extstate_deinit NULL
+	#define lzbench_lz4hc_extstate_compress NULL
 	#define lzbench_lz4_decompress NULL
+	#define lzbench_lz4_first_bytes NULL
+	#define lzbench_lz4_decompress_fast NULL
+	#define lzbench_lz4_compress_batch NULL
+	#define lzbench_lz4_decompress_batch NULL
+	#define lzbench_lz4_inplace_margin NULL
+	#define lzbench_lz4_interleaved_decompress NULL
+	#define lzbench_lz4_interleaved_decompress_batch NULL
+	#define lzbench_lz4_mem_init NULL
+	#define lzbench_lz4_mem_deinit NULL
+	#define lzbench_lz4_m12_compress NULL
+	#define lzbench_lz4_m14_compress NULL
+	#define lzbench_lz4_m16_compress NULL
+	#define lzbench_lz4_m18_compress NULL
+	#define lzbench_lz4_m20_compress NULL
+	#define lzbench_lz4_stream_begin NULL
+	#define lzbench_lz4_stream_feed NULL
+	#define lzbench_lz4_stream_end NULL
+	#define lzbench_lz4_stream_decompress NULL
+	#define lzbench_lz4linked_init NULL
+	#define lzbench_lz4linked_deinit NULL
+	#define lzbench_lz4stream_compress NULL
+	#define lzbench_lz4frame_compress NULL
+	#define lzbench_lz4framecrc_compress NULL
+	#define lzbench_lz4frame_decompress NULL
+	#define lzbench_lz4frame_first_bytes NULL
 #endif
 
 
@@ -153,11 +366,19 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
     void lzbench_lzfse_deinit(char* workmem);
 	int64_t lzbench_lzfse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_lzfse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_lzfse_fse_init(size_t insize, size_t level, size_t);
+	void lzbench_lzfse_fse_deinit(char* workmem);
+	int64_t lzbench_lzfse_fse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_lzfse_fse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
 	#define lzbench_lzfse_init NULL
 	#define lzbench_lzfse_deinit NULL
 	#define lzbench_lzfse_compress NULL
 	#define lzbench_lzfse_decompress NULL
+	#define lzbench_lzfse_fse_init NULL
+	#define lzbench_lzfse_fse_deinit NULL
+	#define lzbench_lzfse_fse_compress NULL
+	#define lzbench_lzfse_fse_decompress NULL
 #endif
 
 
@@ -184,11 +405,20 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 
 
 #ifndef BENCH_REMOVE_LZHAM
+	char* lzbench_lzham_init(size_t insize, size_t level, size_t);
+	void lzbench_lzham_deinit(char* workmem);
 	int64_t lzbench_lzham_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_lzham_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern int lzbench_lzhammt_threads;
+	char* lzbench_lzhammt_init(size_t insize, size_t level, size_t);
+	int64_t lzbench_lzhammt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 #else
+	#define lzbench_lzham_init NULL
+	#define lzbench_lzham_deinit NULL
 	#define lzbench_lzham_compress NULL
 	#define lzbench_lzham_decompress NULL
+	#define lzbench_lzhammt_init NULL
+	#define lzbench_lzhammt_compress NULL
 #endif
 
 
@@ -213,9 +443,15 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 #ifndef BENCH_REMOVE_LZMA
 	int64_t lzbench_lzma_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_lzma_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern int lzbench_lzmamt_threads;
+	extern size_t lzbench_lzmamt_block_size;
+	int64_t lzbench_lzmamt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_lzmamt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
 	#define lzbench_lzma_compress NULL
 	#define lzbench_lzma_decompress NULL
+	#define lzbench_lzmamt_compress NULL
+	#define lzbench_lzmamt_decompress NULL
 #endif
 
 
@@ -249,6 +485,13 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
     int64_t lzbench_lzo1z_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
     int64_t lzbench_lzo2a_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
     int64_t lzbench_lzo2a_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+    int64_t lzbench_lzo1b_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo1c_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo1f_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo1x_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo1y_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo1z_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+    int64_t lzbench_lzo2a_decompress_safe(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
 	#define lzbench_lzo_init NULL
 	#define lzbench_lzo_deinit NULL
@@ -270,6 +513,13 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 	#define lzbench_lzo1z_decompress NULL
 	#define lzbench_lzo2a_compress NULL
 	#define lzbench_lzo2a_decompress NULL
+	#define lzbench_lzo1b_decompress_safe NULL
+	#define lzbench_lzo1c_decompress_safe NULL
+	#define lzbench_lzo1f_decompress_safe NULL
+	#define lzbench_lzo1x_decompress_safe NULL
+	#define lzbench_lzo1y_decompress_safe NULL
+	#define lzbench_lzo1z_decompress_safe NULL
+	#define lzbench_lzo2a_decompress_safe NULL
 #endif
 
 
@@ -365,10 +615,16 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 
 #ifndef BENCH_REMOVE_SNAPPY
 	int64_t lzbench_snappy_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	size_t lzbench_snappy_bound(size_t insize);
 	int64_t lzbench_snappy_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_snappy_interleaved_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*); // interleaved.cpp
+	int64_t lzbench_snappy_interleaved_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t param2, char*);
 #else
 	#define lzbench_snappy_compress NULL
+	#define lzbench_snappy_bound NULL
 	#define lzbench_snappy_decompress NULL
+	#define lzbench_snappy_interleaved_decompress NULL
+	#define lzbench_snappy_interleaved_decompress_batch NULL
 #endif
 
 
@@ -427,9 +683,37 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 #ifndef BENCH_REMOVE_XZ
 	int64_t lzbench_xz_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
 	int64_t lzbench_xz_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_xz_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_xzmt_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	extern int lzbench_xzmt_threads;
+	extern size_t lzbench_xzmt_block_size;
+	char* lzbench_xzmt_init(size_t insize, size_t level, size_t);
+	void lzbench_xzmt_deinit(char* workmem);
+	int64_t lzbench_xzmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_xzmt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_xzmt_decompress_threads(char *inbuf, size_t insize, char *outbuf, size_t outsize, int threads);
+	size_t lzbench_xz_blocks(char *inbuf, size_t insize);
+	int64_t lzbench_xzcheck_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t check, char*);
+	int64_t lzbench_crc32_xz_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_crc64_xz_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_xz_stream_begin(size_t level, size_t);
+	int64_t lzbench_xz_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize);
+	int64_t lzbench_xz_stream_end(char* state, char *outbuf, size_t outsize);
 #else
 	#define lzbench_xz_compress NULL
 	#define lzbench_xz_decompress NULL
+	#define lzbench_xz_first_bytes NULL
+	#define lzbench_xzmt_first_bytes NULL
+	#define lzbench_xzmt_init NULL
+	#define lzbench_xzmt_deinit NULL
+	#define lzbench_xzmt_compress NULL
+	#define lzbench_xzmt_decompress NULL
+	#define lzbench_xzcheck_compress NULL
+	#define lzbench_crc32_xz_hash NULL
+	#define lzbench_crc64_xz_hash NULL
+	#define lzbench_xz_stream_begin NULL
+	#define lzbench_xz_stream_feed NULL
+	#define lzbench_xz_stream_end NULL
 #endif
 
 
@@ -454,11 +738,58 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 
 
 #ifndef BENCH_REMOVE_ZLIB
+	char* lzbench_zlib_init(size_t insize, size_t level, size_t);
+	void lzbench_zlib_deinit(char* workmem);
 	int64_t lzbench_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	size_t lzbench_zlib_bound(size_t insize);
 	int64_t lzbench_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_zlib_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_zlib_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_gzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	size_t lzbench_gzip_bound(size_t insize);
+	extern size_t lzbench_zran_span;
+	char* lzbench_zran_build(const char *gz, size_t gzsize, char *out, size_t outsize, size_t* index_bytes);
+	int64_t lzbench_zran_read(char *zran, const char *gz, size_t gzsize, size_t offset, char *out, size_t len, char* scratch, size_t* fetched, size_t* decoded);
+	void lzbench_zran_free(char* zran);
+	char* lzbench_zlib_unwrap(const char *inbuf, size_t insize, int window_bits, size_t* outsize);
+	int64_t lzbench_crc32_zlib_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_adler32_zlib_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_zlib_stream_begin(size_t level, size_t);
+	int64_t lzbench_zlib_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize);
+	int64_t lzbench_zlib_stream_flush(char* state, char *outbuf, size_t outsize);
+	int64_t lzbench_zlib_stream_end(char* state, char *outbuf, size_t outsize);
 #else
+	#define lzbench_zlib_init NULL
+	#define lzbench_zlib_deinit NULL
 	#define lzbench_zlib_compress NULL
+	#define lzbench_zlib_bound NULL
 	#define lzbench_zlib_decompress NULL
+	#define lzbench_zlib_first_bytes NULL
+	#define lzbench_zlib_gzip_decompress NULL
+	#define lzbench_gzip_compress NULL
+	#define lzbench_gzip_bound NULL
+	#define lzbench_zlib_unwrap NULL
+	#define lzbench_crc32_zlib_hash NULL
+	#define lzbench_adler32_zlib_hash NULL
+	#define lzbench_zlib_stream_begin NULL
+	#define lzbench_zlib_stream_feed NULL
+	#define lzbench_zlib_stream_flush NULL
+	#define lzbench_zlib_stream_end NULL
+#endif
+
+
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+	extern int lzbench_pdeflate_threads;
+	extern size_t lzbench_pdeflate_block_size;
+	char* lzbench_pdeflate_init(size_t insize, size_t level, size_t);
+	void lzbench_pdeflate_deinit(char* workmem);
+	int64_t lzbench_pdeflate_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_pdeflate_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+#else
+	#define lzbench_pdeflate_init NULL
+	#define lzbench_pdeflate_deinit NULL
+	#define lzbench_pdeflate_compress NULL
+	#define lzbench_pdeflate_decompress NULL
 #endif
 
 
@@ -475,16 +806,79 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 	char* lzbench_zstd_init(size_t insize, size_t level, size_t);
 	void lzbench_zstd_deinit(char* workmem);
 	int64_t lzbench_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	size_t lzbench_zstd_bound(size_t insize);
 	int64_t lzbench_zstd_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_zstd_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_zstd_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t windowLog, char* workmem);
+	int64_t lzbench_zstd_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem);
+	int64_t lzbench_zstd_inplace_margin(char *inbuf, size_t insize, size_t outsize);
+	size_t lzbench_zstd_sequence_bound(size_t insize);
+	int64_t lzbench_zstd_sequences(char *inbuf, size_t insize, size_t level, size_t windowLog, uint32_t *seqs, size_t capacity);
+	void lzbench_zstd_cparams(size_t level, size_t insize, int* cparams);
+	char* lzbench_zstd_stream_begin(size_t level, size_t);
+	int64_t lzbench_zstd_stream_feed(char* state, char *inbuf, size_t insize, char *outbuf, size_t outsize);
+	int64_t lzbench_zstd_stream_flush(char* state, char *outbuf, size_t outsize);
+	int64_t lzbench_zstd_stream_end(char* state, char *outbuf, size_t outsize);
 	char* lzbench_zstd_LDM_init(size_t insize, size_t level, size_t);
+	char* lzbench_zstdcrc_init(size_t insize, size_t level, size_t);
+	int64_t lzbench_xxh32_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_xxh64_hash(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 	int64_t lzbench_zstd_LDM_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	size_t lzbench_zstd_train_dict(char* dict, size_t capacity, const char* samples, const size_t* sizes, unsigned count);
+	char* lzbench_zstd_unwrap(const char *inbuf, size_t insize, size_t* outsize);
+	extern int lzbench_zstd_trace;
+	void lzbench_zstd_trace_timing(uint64_t* counters); // adds and resets, ZSTD_TRACE_COUNTERS entries
+	extern int lzbench_zstdmt_workers;
+	extern size_t lzbench_zstdmt_job_size;
+	extern int lzbench_zstdmt_overlap;
+	char* lzbench_zstdmt_init(size_t insize, size_t level, size_t);
+	int64_t lzbench_zstdmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	#define ZSTD_SEEKABLE_FRAME (64 << 10) // default of lzbench_options.frame
+	#define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+	#define ZSTD_SEEKABLE_FOOTER 9 // number of frames, descriptor and magic at the end of the seek table
+	int64_t lzbench_zstd_seekable_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_zstd_delta_init(size_t insize, size_t level, size_t);
+	int64_t lzbench_zstd_delta_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*);
+	int64_t lzbench_zstd_delta_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	char* lzbench_zstd_entropy_init(size_t insize, size_t level, size_t);
+	void lzbench_zstd_entropy_deinit(char* workmem);
+	int64_t lzbench_huff0_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t streams, char*);
+	int64_t lzbench_huff0_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t streams, char*);
+	int64_t lzbench_fse_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+	int64_t lzbench_fse_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
 #else
 	#define lzbench_zstd_init NULL
 	#define lzbench_zstd_deinit NULL
 	#define lzbench_zstd_compress NULL
+	#define lzbench_zstd_bound NULL
 	#define lzbench_zstd_decompress NULL
+	#define lzbench_zstd_first_bytes NULL
+	#define lzbench_zstd_compress_batch NULL
+	#define lzbench_zstd_decompress_batch NULL
+	#define lzbench_zstd_inplace_margin NULL
+	#define lzbench_zstd_stream_begin NULL
+	#define lzbench_zstd_stream_feed NULL
+	#define lzbench_zstd_stream_flush NULL
+	#define lzbench_zstd_stream_end NULL
 	#define lzbench_zstd_LDM_init NULL
+	#define lzbench_zstdcrc_init NULL
+	#define lzbench_xxh32_hash NULL
+	#define lzbench_xxh64_hash NULL
 	#define lzbench_zstd_LDM_compress NULL
+	#define lzbench_zstd_train_dict NULL
+	#define lzbench_zstd_unwrap NULL
+	#define lzbench_zstdmt_init NULL
+	#define lzbench_zstdmt_compress NULL
+	#define lzbench_zstd_seekable_compress NULL
+	#define lzbench_zstd_delta_init NULL
+	#define lzbench_zstd_delta_compress NULL
+	#define lzbench_zstd_delta_decompress NULL
+	#define lzbench_zstd_entropy_init NULL
+	#define lzbench_zstd_entropy_deinit NULL
+	#define lzbench_huff0_compress NULL
+	#define lzbench_huff0_decompress NULL
+	#define lzbench_fse_compress NULL
+	#define lzbench_fse_decompress NULL
 #endif
 
 
@@ -496,11 +890,74 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
 	#define lzbench_nakamichi_decompress NULL
 #endif
 
+// --offload-depth and --offload-decoder: jobs in flight of the batches of qpl_deflate and the decoder of offloaded streams
+#ifdef BENCH_HAS_ZLIBNG
+	int64_t lzbench_zlibng_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t format, char*);
+	int64_t lzbench_zlibng_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t format, char*);
+	int64_t lzbench_zlibng_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+#else
+	#define lzbench_zlibng_compress NULL
+	#define lzbench_zlibng_decompress NULL
+	#define lzbench_zlibng_gzip_decompress NULL
+#endif
+
+#ifdef BENCH_HAS_ISAL
+	char* lzbench_igzip_init(size_t insize, size_t level, size_t);
+	void lzbench_igzip_deinit(char* workmem);
+	int64_t lzbench_igzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t format, char* workmem);
+	int64_t lzbench_igzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t format, char*);
+	int64_t lzbench_igzip_gzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*);
+#else
+	#define lzbench_igzip_init NULL
+	#define lzbench_igzip_deinit NULL
+	#define lzbench_igzip_compress NULL
+	#define lzbench_igzip_decompress NULL
+	#define lzbench_igzip_gzip_decompress NULL
+#endif
+
+extern int lzbench_offload_depth;
+extern int lzbench_offload_decoder; // OFFLOAD_DECODER_*
+#define OFFLOAD_DECODER_NATIVE 0
+#define OFFLOAD_DECODER_LIBDEFLATE 1
+#define OFFLOAD_DECODER_ZLIB 2
+
+#ifdef BENCH_HAS_QPL
+	char* lzbench_qpl_init(size_t insize, size_t level, size_t path);
+	void lzbench_qpl_deinit(char* workmem);
+	int64_t lzbench_qpl_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_qpl_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+	int64_t lzbench_qpl_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t level, size_t, char* workmem);
+	int64_t lzbench_qpl_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem);
+#else
+	#define lzbench_qpl_init NULL
+	#define lzbench_qpl_deinit NULL
+	#define lzbench_qpl_compress NULL
+	#define lzbench_qpl_decompress NULL
+	#define lzbench_qpl_compress_batch NULL
+	#define lzbench_qpl_decompress_batch NULL
+#endif
+
+#ifdef BENCH_HAS_QATZIP
+	char* lzbench_qatzip_init(size_t insize, size_t level, size_t);
+	void lzbench_qatzip_deinit(char* workmem);
+	int64_t lzbench_qatzip_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+	int64_t lzbench_qatzip_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+#else
+	#define lzbench_qatzip_init NULL
+	#define lzbench_qatzip_deinit NULL
+	#define lzbench_qatzip_compress NULL
+	#define lzbench_qatzip_decompress NULL
+#endif
+
 #ifdef BENCH_HAS_CUDA
         char* lzbench_cuda_init(size_t insize, size_t, size_t);
         void lzbench_cuda_deinit(char* workmem);
         int64_t lzbench_cuda_memcpy(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
         int64_t lzbench_cuda_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t , size_t, char* );
+        void* lzbench_cuda_host_alloc(size_t size); // cudaMallocHost, NULL on failure
+        void lzbench_cuda_host_free(void* buf);
+        bool lzbench_cuda_host_register(void* buf, size_t size); // cudaHostRegister of a buffer from malloc or mmap
+        void lzbench_cuda_host_unregister(void* buf);
 #else
         #define lzbench_cuda_init NULL
         #define lzbench_cuda_deinit NULL
@@ -508,16 +965,63 @@ int64_t lzbench_return_0(char *inbuf, size_t insize, char *outbuf, size_t outsiz
         #define lzbench_cuda_return_0 NULL
 #endif
 
+#define CUDA_DEVICES_MAX 8 // --gpus
+#define ZSTD_TRACE_COUNTERS 5 // --zstd-trace: frames and time of frames, of match finding, of literals and of sequences
+
 #ifdef BENCH_HAS_NVCOMP
+        extern int lzbench_cuda_streams;
+        extern size_t lzbench_cuda_slice_size;
+        void lzbench_cuda_timing(uint64_t& kernel_ns, uint64_t& transfer_ns); // adds and resets
+        void lzbench_cuda_setup_timing(uint64_t& alloc_ns, uint64_t& metadata_ns, uint64_t& pool_hits); // adds and resets
+        extern int lzbench_cuda_devices;
+        void lzbench_cuda_device_timing(uint64_t* ns, uint64_t* bytes); // adds and resets, CUDA_DEVICES_MAX entries
+        int lzbench_cuda_topology(bool print); // number of devices, print lists them and their peer access to stderr
         char* lzbench_nvcomp_init(size_t insize, size_t level, size_t);
         void lzbench_nvcomp_deinit(char* workmem);
         int64_t lzbench_nvcomp_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
         int64_t lzbench_nvcomp_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+        char* lzbench_nvcomp_batch_init(size_t insize, size_t level, size_t);
+        void lzbench_nvcomp_batch_deinit(char* workmem);
+        int64_t lzbench_nvcomp_batch_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+        int64_t lzbench_nvcomp_batch_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+        int64_t lzbench_nvcomp_batch_compress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem);
+        int64_t lzbench_nvcomp_batch_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char* workmem);
+    #ifndef BENCH_REMOVE_LZ4
+        extern int lzbench_hybrid_threads;
+        void lzbench_hybrid_share(uint64_t& gpu_bytes); // adds and resets
+        char* lzbench_nvcomp_hybrid_init(size_t insize, size_t level, size_t);
+        void lzbench_nvcomp_hybrid_deinit(char* workmem);
+        int64_t lzbench_nvcomp_hybrid_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+        int64_t lzbench_nvcomp_hybrid_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
+    #else
+        #define lzbench_nvcomp_hybrid_init NULL
+        #define lzbench_nvcomp_hybrid_deinit NULL
+        #define lzbench_nvcomp_hybrid_compress NULL
+        #define lzbench_nvcomp_hybrid_decompress NULL
+    #endif
+        char* lzbench_nvcomp_cascaded_init(size_t insize, size_t level, size_t width);
+        void lzbench_nvcomp_cascaded_deinit(char* workmem);
+        int64_t lzbench_nvcomp_cascaded_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem);
+        int64_t lzbench_nvcomp_cascaded_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem);
 #else
         #define lzbench_nvcomp_init NULL
         #define lzbench_nvcomp_deinit NULL
         #define lzbench_nvcomp_compress NULL
         #define lzbench_nvcomp_decompress NULL
+        #define lzbench_nvcomp_batch_init NULL
+        #define lzbench_nvcomp_batch_deinit NULL
+        #define lzbench_nvcomp_batch_compress NULL
+        #define lzbench_nvcomp_batch_decompress NULL
+        #define lzbench_nvcomp_batch_compress_batch NULL
+        #define lzbench_nvcomp_batch_decompress_batch NULL
+        #define lzbench_nvcomp_hybrid_init NULL
+        #define lzbench_nvcomp_hybrid_deinit NULL
+        #define lzbench_nvcomp_hybrid_compress NULL
+        #define lzbench_nvcomp_hybrid_decompress NULL
+        #define lzbench_nvcomp_cascaded_init NULL
+        #define lzbench_nvcomp_cascaded_deinit NULL
+        #define lzbench_nvcomp_cascaded_compress NULL
+        #define lzbench_nvcomp_cascaded_decompress NULL
 #endif
 
 #endif // LZBENCH_COMPRESSORS_H
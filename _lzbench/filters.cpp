@@ -0,0 +1,659 @@
+// byte shuffle, bit shuffle and delta pre-filters with SSE2 and AVX2 kernels and BCJ filters of executables, see filters.h
+
+#include "filters.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define FILTER_X86
+#include <immintrin.h>
+#define FILTER_AVX2 __attribute__((target("avx2")))
+
+static bool filter_use_avx2()
+{
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return avx2;
+}
+#endif
+
+#define BITSHUFFLE_BLOCK 1024 // elements byte shuffled at once to a buffer on the stack
+
+const char* lzbench_filter_isa(const std::vector<lzbench_filter_t>& filters)
+{
+    bool bcj = true; // the BCJ filters are scalar
+    for (size_t i = 0; i < filters.size(); i++) bcj = bcj && filters[i].type >= FILTER_BCJ_X86;
+    if (bcj) return "scalar";
+#ifdef FILTER_X86
+    return filter_use_avx2() ? "avx2" : "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+
+bool lzbench_parse_filters(const std::string& chain, std::vector<lzbench_filter_t>& filters)
+{
+    static const struct { const char* name; filter_e type; } names[] = {
+        { "bitshuffle", FILTER_BITSHUFFLE }, { "shuffle", FILTER_SHUFFLE }, { "delta", FILTER_DELTA },
+        { "bcj_x86", FILTER_BCJ_X86 }, { "bcj_armthumb", FILTER_BCJ_ARMTHUMB }, { "bcj_arm64", FILTER_BCJ_ARM64 },
+        { "bcj_arm", FILTER_BCJ_ARM }, { "bcj_powerpc", FILTER_BCJ_POWERPC }, { "bcj_sparc", FILTER_BCJ_SPARC },
+        { "bcj_riscv", FILTER_BCJ_RISCV } };
+    size_t start = 0, end;
+
+    filters.clear();
+    if (chain.empty()) return true;
+    do {
+        end = chain.find('+', start);
+        std::string token = chain.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        lzbench_filter_t filter;
+        size_t i = 0, len = 0;
+        for (; i < sizeof(names)/sizeof(names[0]); i++)
+            if (!token.compare(0, len = strlen(names[i].name), names[i].name)) break;
+        if (i == sizeof(names)/sizeof(names[0]))
+        {
+            printf("Unknown filter \"%s\", use shuffle#, bitshuffle[#], delta# or bcj_x86, bcj_arm, bcj_armthumb, bcj_arm64, bcj_powerpc, bcj_sparc, bcj_riscv\n", token.c_str());
+            return false;
+        }
+        filter.type = names[i].type;
+        if (filter.type >= FILTER_BCJ_X86)
+        {
+            if (len < token.size()) { printf("Unknown filter \"%s\", BCJ filters have no width\n", token.c_str()); return false; }
+            filter.width = 1;
+            filters.push_back(filter);
+            start = end + 1;
+            continue;
+        }
+        // bitshuffle without a width continues with elements of the previous filter
+        filter.width = (len < token.size()) ? atoi(token.c_str() + len) : (filter.type == FILTER_BITSHUFFLE && !filters.empty()) ? filters.back().width : 1;
+        if (filter.type == FILTER_SHUFFLE && len == token.size()) filter.width = 4;
+        if (filter.width < 1 || filter.width > FILTER_MAX_WIDTH || (filter.type == FILTER_DELTA && filter.width != 1 && filter.width != 2 && filter.width != 4 && filter.width != 8))
+        {
+            printf("Wrong width of filter \"%s\", delta supports 1, 2, 4 and 8 bytes, others 1 to %d\n", token.c_str(), FILTER_MAX_WIDTH);
+            return false;
+        }
+        filters.push_back(filter);
+        start = end + 1;
+    } while (end != std::string::npos);
+    return true;
+}
+
+
+/*
+ * Byte shuffle of n elements of width w: byte b of element e goes to dst[b*n + e].
+ * The SIMD kernels take blocks of 16 elements (32 with AVX2) in W vectors, for W a power of 2 the index
+ * of a byte in a block is (e,b) with log2(16*W) bits and the shuffle is a rotation of it by 4 bits.
+ * A round of unpacks of vectors j and j+W/2 rotates the index by one bit, the inverse takes log2(W) rounds.
+ */
+#ifdef FILTER_X86
+template<int W> static inline void transpose_round_sse2(__m128i* v)
+{
+    __m128i t[W];
+    for (int j = 0; j < W/2; j++)
+    {
+        t[2*j] = _mm_unpacklo_epi8(v[j], v[j + W/2]);
+        t[2*j+1] = _mm_unpackhi_epi8(v[j], v[j + W/2]);
+    }
+    for (int j = 0; j < W; j++) v[j] = t[j];
+}
+
+template<int W> static size_t shuffle_sse2(const uint8_t* src, uint8_t* dst, size_t n, size_t i)
+{
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v[W];
+        for (int j = 0; j < W; j++) v[j] = _mm_loadu_si128((const __m128i*)(src + i*W + 16*j));
+        for (int r = 0; r < 4; r++) transpose_round_sse2<W>(v);
+        for (int b = 0; b < W; b++) _mm_storeu_si128((__m128i*)(dst + b*n + i), v[b]);
+    }
+    return i;
+}
+
+template<int W> static size_t unshuffle_sse2(const uint8_t* src, uint8_t* dst, size_t n, size_t i)
+{
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v[W];
+        for (int b = 0; b < W; b++) v[b] = _mm_loadu_si128((const __m128i*)(src + b*n + i));
+        for (int r = 1; r < W; r *= 2) transpose_round_sse2<W>(v);
+        for (int j = 0; j < W; j++) _mm_storeu_si128((__m128i*)(dst + i*W + 16*j), v[j]);
+    }
+    return i;
+}
+
+// the lanes of a vector hold two blocks of 16 elements, so a plane of 32 bytes is a single store
+template<int W> static inline FILTER_AVX2 void transpose_round_avx2(__m256i* v)
+{
+    __m256i t[W];
+    for (int j = 0; j < W/2; j++)
+    {
+        t[2*j] = _mm256_unpacklo_epi8(v[j], v[j + W/2]);
+        t[2*j+1] = _mm256_unpackhi_epi8(v[j], v[j + W/2]);
+    }
+    for (int j = 0; j < W; j++) v[j] = t[j];
+}
+
+template<int W> static FILTER_AVX2 size_t shuffle_avx2(const uint8_t* src, uint8_t* dst, size_t n, size_t i)
+{
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v[W];
+        for (int j = 0; j < W; j++)
+            v[j] = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i*W + 16*j))),
+                                           _mm_loadu_si128((const __m128i*)(src + (i+16)*W + 16*j)), 1);
+        for (int r = 0; r < 4; r++) transpose_round_avx2<W>(v);
+        for (int b = 0; b < W; b++) _mm256_storeu_si256((__m256i*)(dst + b*n + i), v[b]);
+    }
+    return i;
+}
+
+template<int W> static FILTER_AVX2 size_t unshuffle_avx2(const uint8_t* src, uint8_t* dst, size_t n, size_t i)
+{
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v[W];
+        for (int b = 0; b < W; b++) v[b] = _mm256_loadu_si256((const __m256i*)(src + b*n + i));
+        for (int r = 1; r < W; r *= 2) transpose_round_avx2<W>(v);
+        for (int j = 0; j < W; j++)
+        {
+            _mm_storeu_si128((__m128i*)(dst + i*W + 16*j), _mm256_castsi256_si128(v[j]));
+            _mm_storeu_si128((__m128i*)(dst + (i+16)*W + 16*j), _mm256_extracti128_si256(v[j], 1));
+        }
+    }
+    return i;
+}
+
+#define FILTER_DISPATCH(i, kernel, w, ...) \
+    switch (w) { \
+        case 2: i = kernel<2>(__VA_ARGS__); break; \
+        case 4: i = kernel<4>(__VA_ARGS__); break; \
+        case 8: i = kernel<8>(__VA_ARGS__); break; \
+        case 16: i = kernel<16>(__VA_ARGS__); break; \
+    }
+
+static size_t shuffle_simd(const uint8_t* src, uint8_t* dst, size_t n, int w)
+{
+    size_t i = 0;
+    if (filter_use_avx2()) FILTER_DISPATCH(i, shuffle_avx2, w, src, dst, n, i);
+    FILTER_DISPATCH(i, shuffle_sse2, w, src, dst, n, i);
+    return i;
+}
+
+static size_t unshuffle_simd(const uint8_t* src, uint8_t* dst, size_t n, int w)
+{
+    size_t i = 0;
+    if (filter_use_avx2()) FILTER_DISPATCH(i, unshuffle_avx2, w, src, dst, n, i);
+    FILTER_DISPATCH(i, unshuffle_sse2, w, src, dst, n, i);
+    return i;
+}
+#endif
+
+static void shuffle_forward(const uint8_t* src, uint8_t* dst, size_t size, int w)
+{
+    size_t n = size / w, i = 0;
+#ifdef FILTER_X86
+    i = shuffle_simd(src, dst, n, w);
+#endif
+    for (int b = 0; b < w; b++)
+        for (size_t e = i; e < n; e++)
+            dst[b*n + e] = src[e*w + b];
+    memcpy(dst + n*w, src + n*w, size - n*w);
+}
+
+static void shuffle_inverse(const uint8_t* src, uint8_t* dst, size_t size, int w)
+{
+    size_t n = size / w, i = 0;
+#ifdef FILTER_X86
+    i = unshuffle_simd(src, dst, n, w);
+#endif
+    for (int b = 0; b < w; b++)
+        for (size_t e = i; e < n; e++)
+            dst[e*w + b] = src[b*n + e];
+    memcpy(dst + n*w, src + n*w, size - n*w);
+}
+
+
+/*
+ * Bit shuffle: the bytes are shuffled first, then bit i of byte k of a plane goes to bit k%8 of byte
+ * k/8 of bit plane i. SIMD takes bit 7 of 16 or 32 bytes with movemask and shifts the next bit up.
+ */
+#ifdef FILTER_X86
+static size_t bit_transpose_sse2(const uint8_t* in, uint8_t* out, size_t count, size_t stride, size_t k)
+{
+    for (; k + 16 <= count; k += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + k));
+        for (int i = 7; i >= 0; i--)
+        {
+            uint16_t m = (uint16_t)_mm_movemask_epi8(x);
+            memcpy(out + i*stride + k/8, &m, sizeof(m));
+            x = _mm_slli_epi16(x, 1);
+        }
+    }
+    return k;
+}
+
+static FILTER_AVX2 size_t bit_transpose_avx2(const uint8_t* in, uint8_t* out, size_t count, size_t stride)
+{
+    size_t k = 0;
+    for (; k + 32 <= count; k += 32)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(in + k));
+        for (int i = 7; i >= 0; i--)
+        {
+            uint32_t m = (uint32_t)_mm256_movemask_epi8(x);
+            memcpy(out + i*stride + k/8, &m, sizeof(m));
+            x = _mm256_slli_epi16(x, 1);
+        }
+    }
+    return k;
+}
+
+// bits of a plane are spread to the bytes, compared with the bit of every byte and merged
+static size_t bit_untranspose_sse2(const uint8_t* in, uint8_t* out, size_t count, size_t stride, size_t k)
+{
+    const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+    for (; k + 16 <= count; k += 16)
+    {
+        __m128i acc = _mm_setzero_si128();
+        for (int i = 0; i < 8; i++)
+        {
+            uint16_t m;
+            memcpy(&m, in + i*stride + k/8, sizeof(m));
+            __m128i v = _mm_cvtsi32_si128(m);
+            v = _mm_unpacklo_epi8(v, v);
+            v = _mm_unpacklo_epi16(v, v);
+            v = _mm_unpacklo_epi32(v, v);
+            v = _mm_cmpeq_epi8(_mm_and_si128(v, bits), bits);
+            acc = _mm_or_si128(acc, _mm_and_si128(v, _mm_set1_epi8((char)(1 << i))));
+        }
+        _mm_storeu_si128((__m128i*)(out + k), acc);
+    }
+    return k;
+}
+
+static FILTER_AVX2 size_t bit_untranspose_avx2(const uint8_t* in, uint8_t* out, size_t count, size_t stride)
+{
+    const __m256i bits = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    size_t k = 0;
+    for (; k + 32 <= count; k += 32)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for (int i = 0; i < 8; i++)
+        {
+            uint32_t m;
+            memcpy(&m, in + i*stride + k/8, sizeof(m));
+            __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32((int)m), spread);
+            v = _mm256_cmpeq_epi8(_mm256_and_si256(v, bits), bits);
+            acc = _mm256_or_si256(acc, _mm256_and_si256(v, _mm256_set1_epi8((char)(1 << i))));
+        }
+        _mm256_storeu_si256((__m256i*)(out + k), acc);
+    }
+    return k;
+}
+#endif
+
+static void bit_transpose(const uint8_t* in, uint8_t* out, size_t count, size_t stride)
+{
+    size_t k = 0;
+#ifdef FILTER_X86
+    if (filter_use_avx2()) k = bit_transpose_avx2(in, out, count, stride);
+    k = bit_transpose_sse2(in, out, count, stride, k);
+#endif
+    for (; k < count; k += 8)
+        for (int i = 0; i < 8; i++)
+        {
+            uint8_t m = 0;
+            for (int j = 0; j < 8; j++) m |= ((in[k+j] >> i) & 1) << j;
+            out[i*stride + k/8] = m;
+        }
+}
+
+static void bit_untranspose(const uint8_t* in, uint8_t* out, size_t count, size_t stride)
+{
+    size_t k = 0;
+#ifdef FILTER_X86
+    if (filter_use_avx2()) k = bit_untranspose_avx2(in, out, count, stride);
+    k = bit_untranspose_sse2(in, out, count, stride, k);
+#endif
+    for (; k < count; k += 8)
+        for (int j = 0; j < 8; j++)
+        {
+            uint8_t m = 0;
+            for (int i = 0; i < 8; i++) m |= ((in[i*stride + k/8] >> j) & 1) << i;
+            out[k+j] = m;
+        }
+}
+
+static void bitshuffle_forward(const uint8_t* src, uint8_t* dst, size_t size, int w)
+{
+    size_t n = size / w / 8 * 8, rows = n / 8; // elements in groups of 8, bytes of a bit plane
+    uint8_t tmp[FILTER_MAX_WIDTH * BITSHUFFLE_BLOCK];
+
+    for (size_t e0 = 0; e0 < n; e0 += BITSHUFFLE_BLOCK)
+    {
+        size_t e = (n - e0 < BITSHUFFLE_BLOCK) ? n - e0 : BITSHUFFLE_BLOCK;
+        shuffle_forward(src + e0*w, tmp, e*w, w);
+        for (int b = 0; b < w; b++)
+            bit_transpose(tmp + b*e, dst + 8*b*rows + e0/8, e, rows);
+    }
+    memcpy(dst + n*w, src + n*w, size - n*w);
+}
+
+static void bitshuffle_inverse(const uint8_t* src, uint8_t* dst, size_t size, int w)
+{
+    size_t n = size / w / 8 * 8, rows = n / 8;
+    uint8_t tmp[FILTER_MAX_WIDTH * BITSHUFFLE_BLOCK];
+
+    for (size_t e0 = 0; e0 < n; e0 += BITSHUFFLE_BLOCK)
+    {
+        size_t e = (n - e0 < BITSHUFFLE_BLOCK) ? n - e0 : BITSHUFFLE_BLOCK;
+        for (int b = 0; b < w; b++)
+            bit_untranspose(src + 8*b*rows + e0/8, tmp + b*e, e, rows);
+        shuffle_inverse(tmp, dst + e0*w, e*w, w);
+    }
+    memcpy(dst + n*w, src + n*w, size - n*w);
+}
+
+
+/* delta of little-endian elements, the forward loop is vectorized by the compiler, the inverse is a prefix sum */
+template<typename T> static void delta_forward(const uint8_t* src, uint8_t* dst, size_t size)
+{
+    size_t n = size / sizeof(T);
+
+    if (n) memcpy(dst, src, sizeof(T));
+    for (size_t i = 1; i < n; i++)
+    {
+        T cur, prev;
+        memcpy(&cur, src + i*sizeof(T), sizeof(T));
+        memcpy(&prev, src + (i-1)*sizeof(T), sizeof(T));
+        cur = (T)(cur - prev);
+        memcpy(dst + i*sizeof(T), &cur, sizeof(T));
+    }
+    memcpy(dst + n*sizeof(T), src + n*sizeof(T), size - n*sizeof(T));
+}
+
+template<typename T> static void delta_inverse(const uint8_t* src, uint8_t* dst, size_t size)
+{
+    size_t n = size / sizeof(T);
+    T sum = 0, d;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        memcpy(&d, src + i*sizeof(T), sizeof(T));
+        sum = (T)(sum + d);
+        memcpy(dst + i*sizeof(T), &sum, sizeof(T));
+    }
+    memcpy(dst + n*sizeof(T), src + n*sizeof(T), size - n*sizeof(T));
+}
+
+
+/*
+ * BCJ filters of xz (x86, ARM, ARM-Thumb, ARM64, PowerPC and SPARC) and the RISC-V filter after xz 5.6, in place
+ * on a copy of the chunk. The branch targets of calls are absolute addresses from the start of the chunk, so the
+ * same function called at many places gives the same bytes. Every filter decides where an instruction is from bytes
+ * that it doesn't change, so encode and decode see the same instructions.
+ */
+static inline uint32_t read32le(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static inline uint32_t read32be(const uint8_t* p) { return (uint32_t)p[3] | (uint32_t)p[2] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[0] << 24; }
+static inline void write32le(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24); }
+static inline void write32be(uint8_t* p, uint32_t v) { p[3] = (uint8_t)v; p[2] = (uint8_t)(v >> 8); p[1] = (uint8_t)(v >> 16); p[0] = (uint8_t)(v >> 24); }
+
+// E8 call and E9 jmp rel32, prev_mask remembers E8/E9 bytes of the last 3 positions that were not taken
+static void bcj_x86(uint8_t* buf, size_t size, bool encode)
+{
+    static const uint32_t mask_to_bit[8] = { 0, 1, 2, 2, 3, 3, 3, 3 };
+    uint32_t prev_mask = 0, prev_pos = (uint32_t)-5;
+
+    if (size < 5) return;
+    for (size_t i = 0; i <= size - 5; )
+    {
+        uint8_t b = buf[i];
+        if (b != 0xE8 && b != 0xE9) { i++; continue; }
+
+        uint32_t offset = (uint32_t)i - prev_pos;
+        prev_pos = (uint32_t)i;
+        if (offset > 5) prev_mask = 0;
+        else for (uint32_t k = 0; k < offset; k++) prev_mask = (prev_mask & 0x77) << 1;
+
+        b = buf[i + 4];
+        if (((b + 1) & 0xFE) == 0 && (prev_mask >> 1) <= 4 && (prev_mask >> 1) != 3)
+        {
+            uint32_t src = read32le(buf + i + 1), dest;
+            for (;;)
+            {
+                dest = encode ? src + ((uint32_t)i + 5) : src - ((uint32_t)i + 5);
+                if (prev_mask == 0) break;
+                uint32_t k = mask_to_bit[prev_mask >> 1];
+                b = (uint8_t)(dest >> (24 - k * 8));
+                if (((b + 1) & 0xFE) != 0) break;
+                src = dest ^ ((1U << (32 - k * 8)) - 1);
+            }
+            dest = (dest & 0x00FFFFFF) | ((uint32_t)(uint8_t)~(((dest >> 24) & 1) - 1) << 24);
+            write32le(buf + i + 1, dest);
+            i += 5;
+            prev_mask = 0;
+        }
+        else
+        {
+            i++;
+            prev_mask |= 1;
+            if (((b + 1) & 0xFE) == 0) prev_mask |= 0x10;
+        }
+    }
+}
+
+// BL with a 24-bit offset in words
+static void bcj_arm(uint8_t* buf, size_t size, bool encode)
+{
+    for (size_t i = 0; i + 4 <= size; i += 4)
+    {
+        if (buf[i + 3] != 0xEB) continue;
+        uint32_t src = ((uint32_t)buf[i + 2] << 16 | (uint32_t)buf[i + 1] << 8 | buf[i]) << 2;
+        uint32_t dest = (encode ? src + ((uint32_t)i + 8) : src - ((uint32_t)i + 8)) >> 2;
+        buf[i + 2] = (uint8_t)(dest >> 16);
+        buf[i + 1] = (uint8_t)(dest >> 8);
+        buf[i] = (uint8_t)dest;
+    }
+}
+
+// BL of Thumb-2, two halfwords with 11 bits of the offset each
+static void bcj_armthumb(uint8_t* buf, size_t size, bool encode)
+{
+    for (size_t i = 0; i + 4 <= size; i += 2)
+    {
+        if ((buf[i + 1] & 0xF8) != 0xF0 || (buf[i + 3] & 0xF8) != 0xF8) continue;
+        uint32_t src = (((uint32_t)buf[i + 1] & 7) << 19 | (uint32_t)buf[i] << 11 | ((uint32_t)buf[i + 3] & 7) << 8 | buf[i + 2]) << 1;
+        uint32_t dest = (encode ? src + ((uint32_t)i + 4) : src - ((uint32_t)i + 4)) >> 1;
+        buf[i + 1] = (uint8_t)(0xF0 | ((dest >> 19) & 7));
+        buf[i] = (uint8_t)(dest >> 11);
+        buf[i + 3] = (uint8_t)(0xF8 | ((dest >> 8) & 7));
+        buf[i + 2] = (uint8_t)dest;
+        i += 2;
+    }
+}
+
+// BL and ADRP within +-512 MB, the sign of the page of ADRP is extended from bit 17
+static void bcj_arm64(uint8_t* buf, size_t size, bool encode)
+{
+    for (size_t i = 0; i + 4 <= size; i += 4)
+    {
+        uint32_t pc = (uint32_t)i, instr = read32le(buf + i);
+        if ((instr >> 26) == 0x25)
+        {
+            pc >>= 2;
+            if (!encode) pc = 0U - pc;
+            write32le(buf + i, 0x94000000 | ((instr + pc) & 0x03FFFFFF));
+        }
+        else if ((instr & 0x9F000000) == 0x90000000)
+        {
+            uint32_t src = ((instr >> 29) & 3) | ((instr >> 3) & 0x001FFFFC);
+            if ((src + 0x00020000) & 0x001C0000) continue;
+            pc >>= 12;
+            if (!encode) pc = 0U - pc;
+            uint32_t dest = src + pc;
+            instr &= 0x9000001F;
+            instr |= (dest & 3) << 29;
+            instr |= (dest & 0x0003FFFC) << 3;
+            instr |= (0U - (dest & 0x00020000)) & 0x00E00000;
+            write32le(buf + i, instr);
+        }
+    }
+}
+
+// bl of big-endian PowerPC, 24-bit offset with AA = 0 and LK = 1
+static void bcj_powerpc(uint8_t* buf, size_t size, bool encode)
+{
+    for (size_t i = 0; i + 4 <= size; i += 4)
+    {
+        if ((buf[i] >> 2) != 0x12 || (buf[i + 3] & 3) != 1) continue;
+        uint32_t src = read32be(buf + i) & 0x03FFFFFC;
+        uint32_t dest = encode ? src + (uint32_t)i : src - (uint32_t)i;
+        write32be(buf + i, 0x48000000 | (dest & 0x03FFFFFC) | 1);
+    }
+}
+
+// call of SPARC with a 30-bit offset in words, only targets within +-8 MB
+static void bcj_sparc(uint8_t* buf, size_t size, bool encode)
+{
+    for (size_t i = 0; i + 4 <= size; i += 4)
+    {
+        if (!((buf[i] == 0x40 && (buf[i + 1] & 0xC0) == 0x00) || (buf[i] == 0x7F && (buf[i + 1] & 0xC0) == 0xC0))) continue;
+        uint32_t src = read32be(buf + i) << 2;
+        uint32_t dest = (encode ? src + (uint32_t)i : src - (uint32_t)i) >> 2;
+        dest = (((0 - ((dest >> 22) & 1)) << 22) & 0x3FFFFFFF) | (dest & 0x3FFFFF) | 0x40000000;
+        write32be(buf + i, dest);
+    }
+}
+
+/*
+ * RISC-V: JAL with rd = x1 or x5 and pairs of AUIPC rd with an instruction of rs1 = rd (jalr, ld, addi...).
+ * The address of a pair is stored big-endian after an AUIPC x2 that keeps the low 20 bits of the second
+ * instruction. An AUIPC x2 of the input that looks like such a pair is swapped into a pair that can't be taken for one.
+ */
+static void bcj_riscv(uint8_t* buf, size_t size, bool encode)
+{
+    if (size < 8) return;
+    for (size_t i = 0; i <= size - 8; i += 2)
+    {
+        uint32_t inst = buf[i], pc = (uint32_t)i;
+        if (inst == 0xEF)
+        {
+            uint32_t b1 = buf[i + 1], b2 = buf[i + 2], b3 = buf[i + 3], addr;
+            if (b1 & 0x0D) continue;
+            if (encode)
+            {
+                addr = ((b1 & 0xF0) << 8) | ((b2 & 0x0F) << 16) | ((b2 & 0x10) << 7) | ((b2 & 0xE0) >> 4) | ((b3 & 0x7F) << 4) | ((b3 & 0x80) << 13);
+                addr += pc;
+                buf[i + 1] = (uint8_t)((b1 & 0x0F) | ((addr >> 13) & 0xF0));
+                buf[i + 2] = (uint8_t)(addr >> 9);
+                buf[i + 3] = (uint8_t)(addr >> 1);
+            }
+            else
+            {
+                addr = ((b1 & 0xF0) << 13) | (b2 << 9) | (b3 << 1);
+                addr -= pc;
+                buf[i + 1] = (uint8_t)((b1 & 0x0F) | ((addr >> 8) & 0xF0));
+                buf[i + 2] = (uint8_t)(((addr >> 16) & 0x0F) | ((addr >> 7) & 0x10) | ((addr << 4) & 0xE0));
+                buf[i + 3] = (uint8_t)(((addr >> 4) & 0x7F) | ((addr >> 13) & 0x80));
+            }
+            i += 4 - 2;
+        }
+        else if ((inst & 0x7F) == 0x17)
+        {
+            inst = read32le(buf + i);
+            uint32_t inst2 = read32le(buf + i + 4);
+            if (inst & 0xE80)
+            {
+                // rd is not x0 or x2: a pair of the input or, when decoding, a swapped AUIPC x2
+                if (((inst << 8) ^ (inst2 - 3)) & 0xF8003) { i += 6 - 2; continue; }
+                if (encode)
+                {
+                    uint32_t addr = (inst & 0xFFFFF000) + (inst2 >> 20) - ((inst2 >> 19) & 0x1000) + pc;
+                    write32le(buf + i, 0x17 | (2 << 7) | (inst2 << 12));
+                    write32be(buf + i + 4, addr);
+                }
+                else
+                {
+                    write32le(buf + i, 0x17 | (2 << 7) | (inst2 << 12));
+                    write32le(buf + i + 4, (inst & 0xFFFFF000) | (inst2 >> 20));
+                }
+            }
+            else
+            {
+                // rd is x0 or x2: taken only when it looks like a stored pair, the rs1 it would have is not x0 or x2
+                uint32_t fake_rs1 = inst >> 27;
+                if ((uint32_t)((inst - 0x3117) << 18) >= (fake_rs1 & 0x1D)) { i += 4 - 2; continue; }
+                if (encode)
+                {
+                    write32le(buf + i, 0x17 | (fake_rs1 << 7) | (inst2 & 0xFFFFF000));
+                    write32le(buf + i + 4, (inst >> 12) | (inst2 << 20));
+                }
+                else
+                {
+                    uint32_t addr = read32be(buf + i + 4) - pc, low = inst >> 12;
+                    write32le(buf + i, 0x17 | (((low >> 15) & 0x1F) << 7) | ((addr + 0x800) & 0xFFFFF000));
+                    write32le(buf + i + 4, low | (addr << 20));
+                }
+            }
+            i += 8 - 2;
+        }
+    }
+}
+
+static void bcj(filter_e type, const uint8_t* src, uint8_t* dst, size_t size, bool encode)
+{
+    memcpy(dst, src, size);
+    switch (type)
+    {
+        case FILTER_BCJ_X86: bcj_x86(dst, size, encode); break;
+        case FILTER_BCJ_ARM: bcj_arm(dst, size, encode); break;
+        case FILTER_BCJ_ARMTHUMB: bcj_armthumb(dst, size, encode); break;
+        case FILTER_BCJ_ARM64: bcj_arm64(dst, size, encode); break;
+        case FILTER_BCJ_POWERPC: bcj_powerpc(dst, size, encode); break;
+        case FILTER_BCJ_SPARC: bcj_sparc(dst, size, encode); break;
+        case FILTER_BCJ_RISCV: bcj_riscv(dst, size, encode); break;
+        default: break;
+    }
+}
+
+
+void lzbench_filter_forward(const lzbench_filter_t& filter, const uint8_t* src, uint8_t* dst, size_t size)
+{
+    switch (filter.type)
+    {
+        case FILTER_SHUFFLE: shuffle_forward(src, dst, size, filter.width); break;
+        case FILTER_BITSHUFFLE: bitshuffle_forward(src, dst, size, filter.width); break;
+        case FILTER_DELTA:
+            switch (filter.width)
+            {
+                case 1: delta_forward<uint8_t>(src, dst, size); break;
+                case 2: delta_forward<uint16_t>(src, dst, size); break;
+                case 4: delta_forward<uint32_t>(src, dst, size); break;
+                case 8: delta_forward<uint64_t>(src, dst, size); break;
+            }
+            break;
+        default: bcj(filter.type, src, dst, size, true); break;
+    }
+}
+
+void lzbench_filter_inverse(const lzbench_filter_t& filter, const uint8_t* src, uint8_t* dst, size_t size)
+{
+    switch (filter.type)
+    {
+        case FILTER_SHUFFLE: shuffle_inverse(src, dst, size, filter.width); break;
+        case FILTER_BITSHUFFLE: bitshuffle_inverse(src, dst, size, filter.width); break;
+        case FILTER_DELTA:
+            switch (filter.width)
+            {
+                case 1: delta_inverse<uint8_t>(src, dst, size); break;
+                case 2: delta_inverse<uint16_t>(src, dst, size); break;
+                case 4: delta_inverse<uint32_t>(src, dst, size); break;
+                case 8: delta_inverse<uint64_t>(src, dst, size); break;
+            }
+            break;
+        default: bcj(filter.type, src, dst, size, false); break;
+    }
+}
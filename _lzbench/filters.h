@@ -0,0 +1,31 @@
+#ifndef LZBENCH_FILTERS_H
+#define LZBENCH_FILTERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/*
+ * Pre-filters of -e "shuffle4+lz4" or "delta8+bitshuffle+zstd,3". The input is seen as elements of width bytes,
+ * bytes after the last whole element (and for bitshuffle after the last group of 8 elements) are copied.
+ * The BCJ filters of executables ("bcj_x86+zstd,19") turn relative branch targets into absolute addresses
+ * from the start of a chunk, like the filters of xz, and have no width.
+ */
+typedef enum { FILTER_SHUFFLE, FILTER_BITSHUFFLE, FILTER_DELTA, FILTER_BCJ_X86, FILTER_BCJ_ARM, FILTER_BCJ_ARMTHUMB,
+               FILTER_BCJ_ARM64, FILTER_BCJ_POWERPC, FILTER_BCJ_SPARC, FILTER_BCJ_RISCV } filter_e;
+
+typedef struct
+{
+    filter_e type;
+    int width; // bytes of an element
+} lzbench_filter_t;
+
+#define FILTER_MAX_WIDTH 16
+
+bool lzbench_parse_filters(const std::string& chain, std::vector<lzbench_filter_t>& filters);
+void lzbench_filter_forward(const lzbench_filter_t& filter, const uint8_t* src, uint8_t* dst, size_t size);
+void lzbench_filter_inverse(const lzbench_filter_t& filter, const uint8_t* src, uint8_t* dst, size_t size);
+const char* lzbench_filter_isa(const std::vector<lzbench_filter_t>& filters); // kernels used on this CPU: "avx2", "sse2" or "scalar"
+
+#endif
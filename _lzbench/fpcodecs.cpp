@@ -0,0 +1,335 @@
+// lossless codecs of floating-point time series: XOR of consecutive values (Gorilla) and FCM/DFCM prediction (FPC), rows gorilla# and fpc#
+
+#include "compressors.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * The output starts with a byte of FP_CODED or FP_STORED, the input is stored as it is when the coded elements don't
+ * fit into the input size. The bytes after the last whole element of 4 (float32) or 8 bytes (float64) follow as they are.
+ */
+enum { FP_CODED = 0, FP_STORED = 1 };
+
+static int64_t fp_store(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    if (outsize < insize + 1) return 0;
+    out[0] = FP_STORED;
+    memcpy(out + 1, in, insize);
+    return insize + 1;
+}
+
+static int64_t fp_unstore(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    if (insize != outsize + 1) return 0;
+    memcpy(out, in + 1, outsize);
+    return outsize;
+}
+
+template<typename T> static inline int fp_clz(T v) { return sizeof(T) == 8 ? __builtin_clzll((uint64_t)v) : __builtin_clz((uint32_t)v); }
+template<typename T> static inline int fp_ctz(T v) { return sizeof(T) == 8 ? __builtin_ctzll((uint64_t)v) : __builtin_ctz((uint32_t)v); }
+
+
+/* bits are written from the top of a 64-bit word and the word is stored big-endian, up to 57 bits at a time */
+typedef struct
+{
+    uint8_t *op, *oend;
+    uint64_t acc;
+    int bits;
+} fp_writer_t;
+
+static inline bool fp_put(fp_writer_t& w, uint64_t v, int n)
+{
+    if (n == 0) return true;
+    w.acc |= (v & (~0ULL >> (64 - n))) << (64 - w.bits - n);
+    w.bits += n;
+    while (w.bits >= 8)
+    {
+        if (w.op >= w.oend) return false;
+        *w.op++ = (uint8_t)(w.acc >> 56);
+        w.acc <<= 8;
+        w.bits -= 8;
+    }
+    return true;
+}
+
+static inline bool fp_flush(fp_writer_t& w)
+{
+    return !w.bits || fp_put(w, 0, 8 - w.bits);
+}
+
+typedef struct
+{
+    const uint8_t *ip, *iend;
+    uint64_t acc;
+    int bits;
+} fp_reader_t;
+
+static inline bool fp_get(fp_reader_t& r, int n, uint64_t& v)
+{
+    if (n == 0) { v = 0; return true; }
+    while (r.bits < n)
+    {
+        if (r.ip >= r.iend) return false;
+        r.acc |= (uint64_t)*r.ip++ << (56 - r.bits);
+        r.bits += 8;
+    }
+    v = r.acc >> (64 - n);
+    r.acc <<= n;
+    r.bits -= n;
+    return true;
+}
+
+static inline bool fp_get_wide(fp_reader_t& r, int n, uint64_t& v)
+{
+    uint64_t hi, lo;
+    if (n <= 56) return fp_get(r, n, v);
+    if (!fp_get(r, n - 32, hi) || !fp_get(r, 32, lo)) return false;
+    v = hi << 32 | lo;
+    return true;
+}
+
+static inline bool fp_put_wide(fp_writer_t& w, uint64_t v, int n)
+{
+    if (n <= 56) return fp_put(w, v, n);
+    return fp_put(w, v >> 32, n - 32) && fp_put(w, v, 32);
+}
+
+
+/*
+ * gorilla32/64: Gorilla of Facebook (VLDB 2015), the first value as it is, then the XOR with the previous value:
+ * '0' when it's 0, '10' and its meaningful bits when they fit into the window of leading and trailing zeros of
+ * the previous XOR, else '11', the leading zeros (5 bits for float64, 4 bits for float32, capped), the number of
+ * meaningful bits - 1 (6 or 5 bits) and the bits.
+ */
+template<typename T>
+static int64_t gorilla_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    const int W = sizeof(T) * 8, LB = (W == 64) ? 5 : 4, NB = (W == 64) ? 6 : 5, max_lead = (1 << LB) - 1;
+    const size_t n = insize / sizeof(T), tail = insize - n * sizeof(T);
+    size_t limit = (insize < outsize ? insize : outsize);
+    fp_writer_t w = { out + 1, out + (limit > tail ? limit - tail : 0), 0, 0 };
+    T prev = 0;
+    int lead = -1, trail = 0;
+
+    if (limit < 1 + tail) return fp_store(in, insize, out, outsize);
+    out[0] = FP_CODED;
+    for (size_t i = 0; i < n; i++)
+    {
+        T v;
+        memcpy(&v, in + i * sizeof(T), sizeof(T));
+        bool ok;
+        if (i == 0) ok = fp_put_wide(w, v, W);
+        else
+        {
+            T x = v ^ prev;
+            if (!x) ok = fp_put(w, 0, 1);
+            else
+            {
+                int l = fp_clz(x), t = fp_ctz(x);
+                if (l > max_lead) l = max_lead;
+                if (lead >= 0 && l >= lead && t >= trail)
+                    ok = fp_put(w, 2, 2) && fp_put_wide(w, x >> trail, W - lead - trail);
+                else
+                {
+                    lead = l, trail = t;
+                    ok = fp_put(w, 3, 2) && fp_put(w, l, LB) && fp_put(w, W - l - t - 1, NB) && fp_put_wide(w, x >> t, W - l - t);
+                }
+            }
+        }
+        if (!ok) return fp_store(in, insize, out, outsize);
+        prev = v;
+    }
+    if (!fp_flush(w)) return fp_store(in, insize, out, outsize);
+    memcpy(w.op, in + n * sizeof(T), tail);
+    return w.op + tail - out;
+}
+
+template<typename T>
+static int64_t gorilla_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize)
+{
+    const int W = sizeof(T) * 8, LB = (W == 64) ? 5 : 4, NB = (W == 64) ? 6 : 5;
+    const size_t n = outsize / sizeof(T), tail = outsize - n * sizeof(T);
+    if (insize < 1 + tail) return 0;
+    if (in[0] == FP_STORED) return fp_unstore(in, insize, out, outsize);
+    fp_reader_t r = { in + 1, in + insize - tail, 0, 0 };
+    T prev = 0;
+    int lead = 0, trail = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t v, b;
+        if (i == 0) { if (!fp_get_wide(r, W, v)) return 0; prev = (T)v; }
+        else
+        {
+            if (!fp_get(r, 1, b)) return 0;
+            if (b)
+            {
+                if (!fp_get(r, 1, b)) return 0;
+                if (b)
+                {
+                    uint64_t l, m;
+                    if (!fp_get(r, LB, l) || !fp_get(r, NB, m)) return 0;
+                    lead = (int)l, trail = W - lead - (int)m - 1;
+                    if (trail < 0) return 0;
+                }
+                if (!fp_get_wide(r, W - lead - trail, v)) return 0;
+                prev ^= (T)(v << trail);
+            }
+        }
+        memcpy(out + i * sizeof(T), &prev, sizeof(T));
+    }
+    if ((size_t)(r.iend - r.ip) != 0) return 0;
+    memcpy(out + n * sizeof(T), in + insize - tail, tail);
+    return outsize;
+}
+
+
+/*
+ * fpc32/64: FPC of Burtscher and Ratanaworabhan, the value is predicted by a finite context method (FCM, the value
+ * that followed the last hash of previous values) and a differential one (DFCM, the last value plus the stride that
+ * followed the hash of previous strides), the XOR with the closer prediction is stored without its leading zero
+ * bytes. A header byte of 2 values holds for each a nibble of the predictor and the count of leading zero bytes
+ * (for float64 4 is coded as 3, the count of 8 is coded as 4). Level # = tables of 2^(4+4#) entries, at most 2x
+ * the elements of a chunk, they are cleared for every chunk.
+ */
+static int fpc_table_bits(size_t level, size_t n)
+{
+    int bits = 4 + 4 * (int)(level < 1 ? 1 : level > 4 ? 4 : level);
+    while (bits > 4 && ((size_t)1 << (bits - 1)) > n) bits--;
+    return bits;
+}
+
+char* lzbench_fpc_init(size_t, size_t level, size_t)
+{
+    int bits = fpc_table_bits(level, SIZE_MAX);
+    return (char*)malloc(2 * sizeof(uint64_t) << bits);
+}
+
+void lzbench_fpc_deinit(char* workmem)
+{
+    free(workmem);
+}
+
+template<typename T>
+struct fpc_predictor
+{
+    T *fcm, *dfcm, last;
+    size_t h1, h2, mask;
+
+    fpc_predictor(char* workmem, int bits) : fcm((T*)workmem), dfcm((T*)workmem + ((size_t)1 << bits)), last(0), h1(0), h2(0), mask(((size_t)1 << bits) - 1)
+    {
+        memset(workmem, 0, 2 * sizeof(T) << bits);
+    }
+    inline void predict(T& p1, T& p2) const { p1 = fcm[h1]; p2 = dfcm[h2] + last; }
+    inline void update(T v)
+    {
+        const int W = sizeof(T) * 8;
+        fcm[h1] = v;
+        h1 = ((h1 << 6) ^ (size_t)(v >> (W - 16))) & mask;
+        dfcm[h2] = v - last;
+        h2 = ((h2 << 2) ^ (size_t)((T)(v - last) >> (W - 24))) & mask;
+        last = v;
+    }
+};
+
+// leading zero bytes to the code of 3 bits and back, float64 codes 0-3 and 5-8 bytes
+template<typename T> static inline int fpc_code(T x, int& zeros)
+{
+    zeros = x ? fp_clz(x) / 8 : (int)sizeof(T);
+    if (sizeof(T) == 8 && zeros == 4) zeros = 3;
+    return (sizeof(T) == 8 && zeros > 4) ? zeros - 1 : zeros;
+}
+template<typename T> static inline int fpc_zeros(int code) { return (sizeof(T) == 8 && code >= 4) ? code + 1 : code; }
+
+template<typename T>
+static int64_t fpc_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t level, char* workmem)
+{
+    const size_t n = insize / sizeof(T), tail = insize - n * sizeof(T);
+    size_t limit = (insize < outsize ? insize : outsize);
+    uint8_t* op = out + 1;
+    uint8_t* oend = out + (limit > tail ? limit - tail : 0);
+
+    if (!workmem || limit < 1 + tail) return fp_store(in, insize, out, outsize);
+    fpc_predictor<T> pred(workmem, fpc_table_bits(level, n));
+    out[0] = FP_CODED;
+    for (size_t i = 0; i < n; i += 2)
+    {
+        if ((size_t)(oend - op) < 1 + 2 * sizeof(T)) return fp_store(in, insize, out, outsize);
+        uint8_t* header = op++;
+        *header = 0;
+        for (size_t k = 0; k < 2 && i + k < n; k++)
+        {
+            T v, p1, p2;
+            memcpy(&v, in + (i + k) * sizeof(T), sizeof(T));
+            pred.predict(p1, p2);
+            pred.update(v);
+            T x1 = v ^ p1, x2 = v ^ p2;
+            int choice = (x2 < x1), zeros;
+            T x = choice ? x2 : x1;
+            int code = fpc_code(x, zeros);
+            *header |= (uint8_t)((choice << 3 | code) << (4 * k));
+            for (size_t b = 0; b < sizeof(T) - zeros; b++) *op++ = (uint8_t)(x >> (8 * b));
+        }
+    }
+    memcpy(op, in + n * sizeof(T), tail);
+    return op + tail - out;
+}
+
+template<typename T>
+static int64_t fpc_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, size_t level, char* workmem)
+{
+    const size_t n = outsize / sizeof(T), tail = outsize - n * sizeof(T);
+    if (insize < 1 + tail || !workmem) return 0;
+    if (in[0] == FP_STORED) return fp_unstore(in, insize, out, outsize);
+    const uint8_t* ip = in + 1;
+    const uint8_t* iend = in + insize - tail;
+    fpc_predictor<T> pred(workmem, fpc_table_bits(level, n));
+
+    for (size_t i = 0; i < n; i += 2)
+    {
+        if (ip >= iend) return 0;
+        unsigned header = *ip++;
+        for (size_t k = 0; k < 2 && i + k < n; k++)
+        {
+            unsigned nibble = header >> (4 * k);
+            size_t bytes = sizeof(T) - fpc_zeros<T>(nibble & 7);
+            if (bytes > sizeof(T) || (size_t)(iend - ip) < bytes) return 0;
+            T x = 0, p1, p2;
+            for (size_t b = 0; b < bytes; b++) x |= (T)ip[b] << (8 * b);
+            ip += bytes;
+            pred.predict(p1, p2);
+            T v = x ^ ((nibble & 8) ? p2 : p1);
+            pred.update(v);
+            memcpy(out + (i + k) * sizeof(T), &v, sizeof(T));
+        }
+    }
+    if (ip != iend) return 0;
+    memcpy(out + n * sizeof(T), iend, tail);
+    return outsize;
+}
+
+
+int64_t lzbench_gorilla_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t width, char*)
+{
+    if (width == 4) return gorilla_encode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize);
+    return gorilla_encode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize);
+}
+
+int64_t lzbench_gorilla_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t width, char*)
+{
+    if (width == 4) return gorilla_decode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize);
+    return gorilla_decode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize);
+}
+
+int64_t lzbench_fpc_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char* workmem)
+{
+    if (width == 4) return fpc_encode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level, workmem);
+    return fpc_encode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level, workmem);
+}
+
+int64_t lzbench_fpc_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char* workmem)
+{
+    if (width == 4) return fpc_decode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level, workmem);
+    return fpc_decode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level, workmem);
+}
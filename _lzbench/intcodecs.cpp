@@ -0,0 +1,437 @@
+// integer codecs of posting lists and IDs: frame of reference and delta with bit-packing and StreamVByte, rows intpack# and streamvbyte
+
+#include "compressors.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define INTCODEC_X86
+#include <immintrin.h>
+#define INTCODEC_SSSE3 __attribute__((target("ssse3")))
+
+static bool intcodec_use_ssse3()
+{
+    static const bool ssse3 = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3") != 0);
+    return ssse3;
+}
+#endif
+
+
+/*
+ * intpack8/16/32/64: elements of 1 to 8 bytes (additional_param) in blocks of 128, level 0 = frame of reference
+ * (the minimum of the block is subtracted), level 1 = delta from the previous element before it. A block is a byte
+ * of the bit width b of its values, the minimum in the width of an element and 128 values of b bits packed in the
+ * 4 lanes of 32 bits of SIMDComp (value i in lane i % 4), or 0xFF and the elements as they are when b > 32.
+ * The elements after the last whole block and the bytes after the last whole element follow as they are.
+ */
+#define INTPACK_BLOCK 128
+#define INTPACK_RAW 0xFF
+
+#ifdef INTCODEC_X86
+template<int B>
+static void intpack_pack(const uint32_t* in, uint8_t* out)
+{
+    __m128i acc = _mm_setzero_si128();
+    int shift = 0;
+    for (int r = 0; r < 32; r++)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)in + r);
+        acc = _mm_or_si128(acc, _mm_slli_epi32(v, shift));
+        shift += B;
+        if (shift >= 32)
+        {
+            _mm_storeu_si128((__m128i*)out, acc);
+            out += 16;
+            shift -= 32;
+            acc = shift ? _mm_srli_epi32(v, B - shift) : _mm_setzero_si128();
+        }
+    }
+}
+
+template<int B>
+static void intpack_unpack(const uint8_t* in, uint32_t* out)
+{
+    const __m128i mask = _mm_set1_epi32(B == 32 ? -1 : (int)((1U << B) - 1));
+    __m128i cur = _mm_loadu_si128((const __m128i*)in);
+    int shift = 0;
+    for (int r = 0; r < 32; r++)
+    {
+        __m128i v = _mm_srli_epi32(cur, shift);
+        shift += B;
+        if (shift >= 32)
+        {
+            shift -= 32;
+            if (r < 31)
+            {
+                in += 16;
+                cur = _mm_loadu_si128((const __m128i*)in);
+                if (shift) v = _mm_or_si128(v, _mm_slli_epi32(cur, B - shift));
+            }
+        }
+        _mm_storeu_si128((__m128i*)out + r, _mm_and_si128(v, mask));
+    }
+}
+
+template<> void intpack_pack<0>(const uint32_t*, uint8_t*) {}
+template<> void intpack_unpack<0>(const uint8_t*, uint32_t* out) { memset(out, 0, INTPACK_BLOCK * 4); }
+#else
+template<int B>
+static void intpack_pack(const uint32_t* in, uint8_t* out)
+{
+    for (int l = 0; l < 4; l++)
+    {
+        uint64_t acc = 0;
+        int bits = 0, word = 0;
+        for (int r = 0; r < 32; r++)
+        {
+            acc |= (uint64_t)in[4 * r + l] << bits;
+            bits += B;
+            if (bits >= 32)
+            {
+                uint32_t w = (uint32_t)acc;
+                memcpy(out + 16 * word++ + 4 * l, &w, 4);
+                acc >>= 32;
+                bits -= 32;
+            }
+        }
+    }
+}
+
+template<int B>
+static void intpack_unpack(const uint8_t* in, uint32_t* out)
+{
+    const uint64_t mask = (B == 32) ? 0xFFFFFFFFULL : ((1ULL << B) - 1);
+    for (int l = 0; l < 4; l++)
+    {
+        uint64_t acc = 0;
+        int bits = 0, word = 0;
+        for (int r = 0; r < 32; r++)
+        {
+            if (bits < B)
+            {
+                uint32_t w;
+                memcpy(&w, in + 16 * word++ + 4 * l, 4);
+                acc |= (uint64_t)w << bits;
+                bits += 32;
+            }
+            out[4 * r + l] = (uint32_t)(acc & mask);
+            acc >>= B;
+            bits -= B;
+        }
+    }
+}
+
+template<> void intpack_pack<0>(const uint32_t*, uint8_t*) {}
+template<> void intpack_unpack<0>(const uint8_t*, uint32_t* out) { memset(out, 0, INTPACK_BLOCK * 4); }
+#endif
+
+typedef void (*intpack_pack_f)(const uint32_t*, uint8_t*);
+typedef void (*intpack_unpack_f)(const uint8_t*, uint32_t*);
+
+#define INTPACK_WIDTHS(f) { f<0>, f<1>, f<2>, f<3>, f<4>, f<5>, f<6>, f<7>, f<8>, f<9>, f<10>, f<11>, f<12>, f<13>, f<14>, f<15>, f<16>, \
+    f<17>, f<18>, f<19>, f<20>, f<21>, f<22>, f<23>, f<24>, f<25>, f<26>, f<27>, f<28>, f<29>, f<30>, f<31>, f<32> }
+static const intpack_pack_f intpack_packers[33] = INTPACK_WIDTHS(intpack_pack);
+static const intpack_unpack_f intpack_unpackers[33] = INTPACK_WIDTHS(intpack_unpack);
+
+static inline int intpack_bits(uint64_t v)
+{
+    return v ? 64 - __builtin_clzll(v) : 0;
+}
+
+template<typename T>
+static int64_t intpack_encode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, bool delta)
+{
+    const size_t blocks = insize / sizeof(T) / INTPACK_BLOCK;
+    uint8_t* op = out;
+    uint8_t* oend = out + outsize;
+    uint32_t values[INTPACK_BLOCK];
+    T elems[INTPACK_BLOCK], prev = 0;
+
+    for (size_t k = 0; k < blocks; k++)
+    {
+        const uint8_t* ip = in + k * INTPACK_BLOCK * sizeof(T);
+        memcpy(elems, ip, sizeof(elems));
+        T min = (T)~(T)0, max = 0;
+        for (int i = 0; i < INTPACK_BLOCK; i++)
+        {
+            T e = elems[i];
+            if (delta) elems[i] = (T)(e - prev), prev = e;
+            min = elems[i] < min ? elems[i] : min;
+            max = elems[i] > max ? elems[i] : max;
+        }
+        int b = intpack_bits((uint64_t)(T)(max - min));
+        if ((size_t)(oend - op) < 1 + sizeof(elems)) return 0;
+        if (b > 32)
+        {
+            *op++ = INTPACK_RAW;
+            memcpy(op, ip, sizeof(elems));
+            op += sizeof(elems);
+            continue;
+        }
+        *op++ = (uint8_t)b;
+        memcpy(op, &min, sizeof(T));
+        op += sizeof(T);
+        for (int i = 0; i < INTPACK_BLOCK; i++) values[i] = (uint32_t)(T)(elems[i] - min);
+        intpack_packers[b](values, op);
+        op += 16 * b;
+    }
+
+    size_t tail = insize - blocks * INTPACK_BLOCK * sizeof(T);
+    if ((size_t)(oend - op) < tail) return 0;
+    memcpy(op, in + insize - tail, tail);
+    return op + tail - out;
+}
+
+template<typename T>
+static int64_t intpack_decode(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, bool delta)
+{
+    const size_t blocks = outsize / sizeof(T) / INTPACK_BLOCK;
+    const uint8_t* ip = in;
+    const uint8_t* iend = in + insize;
+    uint32_t values[INTPACK_BLOCK];
+    T elems[INTPACK_BLOCK], prev = 0;
+
+    for (size_t k = 0; k < blocks; k++)
+    {
+        uint8_t* op = out + k * INTPACK_BLOCK * sizeof(T);
+        if (ip >= iend) return 0;
+        int b = *ip++;
+        if (b == INTPACK_RAW)
+        {
+            if ((size_t)(iend - ip) < sizeof(elems)) return 0;
+            memcpy(op, ip, sizeof(elems));
+            ip += sizeof(elems);
+            memcpy(&prev, op + sizeof(elems) - sizeof(T), sizeof(T));
+            continue;
+        }
+        if (b > 32 || (size_t)(iend - ip) < sizeof(T) + 16 * b) return 0;
+        T min;
+        memcpy(&min, ip, sizeof(T));
+        ip += sizeof(T);
+        intpack_unpackers[b](ip, values);
+        ip += 16 * b;
+        if (delta)
+            for (int i = 0; i < INTPACK_BLOCK; i++) elems[i] = prev = (T)(prev + (T)values[i] + min);
+        else
+            for (int i = 0; i < INTPACK_BLOCK; i++) elems[i] = (T)((T)values[i] + min);
+        memcpy(op, elems, sizeof(elems));
+    }
+
+    size_t tail = outsize - blocks * INTPACK_BLOCK * sizeof(T);
+    if ((size_t)(iend - ip) != tail) return 0;
+    memcpy(out + outsize - tail, ip, tail);
+    return outsize;
+}
+
+#ifdef INTCODEC_X86
+// 32-bit elements: the values of a block are added to the minimum and summed 4 at a time with SSE2
+template<>
+int64_t intpack_decode<uint32_t>(const uint8_t* in, size_t insize, uint8_t* out, size_t outsize, bool delta)
+{
+    const size_t blocks = outsize / 4 / INTPACK_BLOCK;
+    const uint8_t* ip = in;
+    const uint8_t* iend = in + insize;
+    uint32_t values[INTPACK_BLOCK];
+    __m128i prev = _mm_setzero_si128();
+
+    for (size_t k = 0; k < blocks; k++)
+    {
+        uint8_t* op = out + k * INTPACK_BLOCK * 4;
+        if (ip >= iend) return 0;
+        int b = *ip++;
+        if (b == INTPACK_RAW)
+        {
+            if ((size_t)(iend - ip) < INTPACK_BLOCK * 4) return 0;
+            memcpy(op, ip, INTPACK_BLOCK * 4);
+            ip += INTPACK_BLOCK * 4;
+            uint32_t last;
+            memcpy(&last, op + INTPACK_BLOCK * 4 - 4, 4);
+            prev = _mm_set1_epi32((int)last);
+            continue;
+        }
+        if (b > 32 || (size_t)(iend - ip) < 4 + 16 * (size_t)b) return 0;
+        uint32_t min;
+        memcpy(&min, ip, 4);
+        ip += 4;
+        intpack_unpackers[b](ip, values);
+        ip += 16 * b;
+        const __m128i vmin = _mm_set1_epi32((int)min);
+        for (int r = 0; r < 32; r++)
+        {
+            __m128i v = _mm_add_epi32(_mm_loadu_si128((const __m128i*)values + r), vmin);
+            if (delta)
+            {
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+                v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+                v = _mm_add_epi32(v, prev);
+                prev = _mm_shuffle_epi32(v, 0xFF);
+            }
+            _mm_storeu_si128((__m128i*)op + r, v);
+        }
+    }
+
+    size_t tail = outsize - blocks * INTPACK_BLOCK * 4;
+    if ((size_t)(iend - ip) != tail) return 0;
+    memcpy(out + outsize - tail, ip, tail);
+    return outsize;
+}
+#endif
+
+int64_t lzbench_intpack_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char*)
+{
+    switch (width)
+    {
+        case 1: return intpack_encode<uint8_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 2: return intpack_encode<uint16_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 4: return intpack_encode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 8: return intpack_encode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+    }
+    return 0;
+}
+
+int64_t lzbench_intpack_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t width, char*)
+{
+    switch (width)
+    {
+        case 1: return intpack_decode<uint8_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 2: return intpack_decode<uint16_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 4: return intpack_decode<uint32_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+        case 8: return intpack_decode<uint64_t>((const uint8_t*)inbuf, insize, (uint8_t*)outbuf, outsize, level > 0);
+    }
+    return 0;
+}
+
+
+/*
+ * streamvbyte: 32-bit elements in 1 to 4 bytes, level 1 = delta from the previous element before it. The control
+ * bytes of the lengths of 4 elements (2 bits each, length - 1) come first, then the bytes of the elements and the
+ * bytes after the last whole element. The decoder of SSSE3 expands 4 elements with a shuffle of a table indexed by
+ * the control byte while 16 bytes of input remain, the rest is decoded one element at a time.
+ */
+static inline size_t svb_length(uint32_t v)
+{
+    return v < (1U << 8) ? 1 : v < (1U << 16) ? 2 : v < (1U << 24) ? 3 : 4;
+}
+
+int64_t lzbench_streamvbyte_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+    const size_t count = insize / 4, tail = insize % 4, controls = (count + 3) / 4;
+    uint8_t* ctrl = (uint8_t*)outbuf;
+    uint8_t* op = ctrl + controls;
+    uint8_t* oend = (uint8_t*)outbuf + outsize;
+    uint32_t prev = 0;
+
+    if (outsize < controls) return 0;
+    memset(ctrl, 0, controls);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t v;
+        memcpy(&v, inbuf + 4 * i, 4);
+        uint32_t d = level ? v - prev : v;
+        prev = v;
+        size_t len = svb_length(d);
+        if ((size_t)(oend - op) < 4) return 0;
+        memcpy(op, &d, 4); // little endian, the bytes past len are overwritten by the next element
+        op += len;
+        ctrl[i / 4] |= (uint8_t)((len - 1) << (2 * (i % 4)));
+    }
+    if ((size_t)(oend - op) < tail) return 0;
+    memcpy(op, inbuf + 4 * count, tail);
+    return op + tail - (uint8_t*)outbuf;
+}
+
+static inline const uint8_t* svb_decode_scalar(const uint8_t* ctrl, const uint8_t* ip, const uint8_t* iend, uint8_t* op, size_t first, size_t count, uint32_t& prev, bool delta)
+{
+    for (size_t i = first; i < count; i++)
+    {
+        size_t len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        if ((size_t)(iend - ip) < len) return NULL;
+        uint32_t v = 0;
+        for (size_t b = 0; b < len; b++) v |= (uint32_t)ip[b] << (8 * b);
+        ip += len;
+        if (delta) v += prev;
+        prev = v;
+        memcpy(op + 4 * i, &v, 4);
+    }
+    return ip;
+}
+
+#ifdef INTCODEC_X86
+typedef struct
+{
+    uint8_t shuffle[256][16];
+    uint8_t length[256];
+} svb_tables_t;
+
+static svb_tables_t svb_build_tables()
+{
+    svb_tables_t t;
+    for (int c = 0; c < 256; c++)
+    {
+        int pos = 0;
+        for (int e = 0; e < 4; e++)
+        {
+            int len = ((c >> (2 * e)) & 3) + 1;
+            for (int b = 0; b < 4; b++) t.shuffle[c][4 * e + b] = b < len ? (uint8_t)(pos + b) : 0x80;
+            pos += len;
+        }
+        t.length[c] = (uint8_t)pos;
+    }
+    return t;
+}
+
+static const svb_tables_t& svb_tables()
+{
+    static const svb_tables_t t = svb_build_tables();
+    return t;
+}
+
+// returns the input after the groups of 4 elements decoded, g = their number
+INTCODEC_SSSE3
+static const uint8_t* svb_decode_ssse3(const uint8_t* ctrl, const uint8_t* ip, const uint8_t* iend, uint8_t* op, size_t groups, size_t& g, uint32_t& prev, bool delta)
+{
+    const svb_tables_t& t = svb_tables();
+    __m128i vprev = _mm_set1_epi32((int)prev);
+    for (g = 0; g < groups && iend - ip >= 16; g++)
+    {
+        uint8_t c = ctrl[g];
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)ip), _mm_loadu_si128((const __m128i*)t.shuffle[c]));
+        ip += t.length[c];
+        if (delta)
+        {
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi32(v, vprev);
+            vprev = _mm_shuffle_epi32(v, 0xFF);
+        }
+        _mm_storeu_si128((__m128i*)op + g, v);
+    }
+    prev = (uint32_t)_mm_cvtsi128_si32(vprev);
+    return ip;
+}
+#endif
+
+int64_t lzbench_streamvbyte_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+    const size_t count = outsize / 4, tail = outsize % 4, controls = (count + 3) / 4;
+    const uint8_t* ctrl = (const uint8_t*)inbuf;
+    const uint8_t* ip = ctrl + controls;
+    const uint8_t* iend = (const uint8_t*)inbuf + insize - tail;
+    uint8_t* op = (uint8_t*)outbuf;
+    uint32_t prev = 0;
+    size_t first = 0;
+
+    if (insize < controls + tail) return 0;
+#ifdef INTCODEC_X86
+    if (intcodec_use_ssse3())
+    {
+        size_t groups;
+        ip = svb_decode_ssse3(ctrl, ip, iend, op, count / 4, groups, prev, level > 0);
+        first = 4 * groups;
+    }
+#endif
+    ip = svb_decode_scalar(ctrl, ip, iend, op, first, count, prev, level > 0);
+    if (!ip || ip != iend) return 0;
+    memcpy(op + 4 * count, ip, tail);
+    return outsize;
+}
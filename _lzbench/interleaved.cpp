@@ -0,0 +1,267 @@
+// interleaved decoding of lz4 blocks and snappy streams on one core, the rows lz4_ilv# and snappy_ilv#
+
+#include "compressors.h"
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * The decoders of a batch take up to N chunks at once and decode a sequence (lz4) or a tag (snappy) of every
+ * chunk in turn. The copies of a chunk wait on the loads of its last token, the out-of-order core fills the
+ * wait with the independent tokens of the other chunks, like the 4 streams of Huff0. A chunk that is done
+ * hands its lane to the next chunk of the batch. The decoders are safe, a chunk that reads or writes outside
+ * of its buffers or doesn't fill its output gets size 0. Copies of 16 bytes don't pass the end of a buffer,
+ * since the next chunk of the output may be decoded in another lane at the same time.
+ */
+typedef struct
+{
+    const uint8_t *ip, *iend;
+    uint8_t *op, *oend, *ostart;
+    size_t chunk; // index in the batch, n = the lane is free
+} lane_t;
+
+enum { LANE_MORE = 0, LANE_DONE = 1, LANE_ERROR = -1 };
+
+static inline void copy_literals(uint8_t* op, const uint8_t* ip, size_t len, size_t in_left, size_t out_left)
+{
+    if (in_left >= len + 16 && out_left >= len + 16)
+        for (size_t i = 0; i < len; i += 16) memcpy(op + i, ip + i, 16);
+    else
+        memcpy(op, ip, len);
+}
+
+// an offset under 8 repeats a pattern, after 8 bytes the copy continues from a multiple of the offset of 8 or more
+static inline void copy_match(uint8_t* op, size_t offset, size_t len, size_t out_left)
+{
+    const uint8_t* match = op - offset;
+    if (offset >= 16 && out_left >= len + 16)
+        for (size_t i = 0; i < len; i += 16) memcpy(op + i, match + i, 16);
+    else if (offset >= 8 && out_left >= len + 8)
+        for (size_t i = 0; i < len; i += 8) memcpy(op + i, match + i, 8);
+    else if (out_left >= len + 8)
+    {
+        size_t period = offset * ((8 + offset - 1) / offset);
+        for (size_t i = 0; i < 8; i++) op[i] = match[i];
+        for (size_t i = 8; i < len; i += 8) memcpy(op + i, op + i - period, 8);
+    }
+    else
+        for (size_t i = 0; i < len; i++) op[i] = match[i];
+}
+
+
+/* lz4 block: a token of literal and match lengths, literals, a 16-bit offset, the last sequence has no match */
+static inline bool lz4_start(lane_t&)
+{
+    return true;
+}
+
+static inline bool lz4_length(const uint8_t*& ip, const uint8_t* iend, size_t& len)
+{
+    unsigned b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+static inline int lz4_step(lane_t& l)
+{
+    const uint8_t* ip = l.ip;
+    uint8_t* op = l.op;
+
+    if (ip >= l.iend) return LANE_ERROR;
+    unsigned token = *ip++;
+    size_t len = token >> 4, offset;
+
+    // short literals and a short match of an offset of 8 or more far from the ends are copied in blocks
+    if (len < 15 && l.iend - ip >= 16 + 2 && l.oend - op >= 16 + 24)
+    {
+        memcpy(op, ip, 16);
+        ip += len;
+        op += len;
+        offset = ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - l.ostart)) return LANE_ERROR;
+        len = token & 15;
+        if (len < 15 && offset >= 8)
+        {
+            memcpy(op, op - offset, 8);
+            memcpy(op + 8, op + 8 - offset, 8);
+            memcpy(op + 16, op + 16 - offset, 8);
+            l.ip = ip;
+            l.op = op + len + 4;
+            return LANE_MORE;
+        }
+        goto match;
+    }
+
+    if (len == 15 && !lz4_length(ip, l.iend, len)) return LANE_ERROR;
+    if ((size_t)(l.iend - ip) < len || (size_t)(l.oend - op) < len) return LANE_ERROR;
+    copy_literals(op, ip, len, l.iend - ip, l.oend - op);
+    ip += len;
+    op += len;
+    if (ip == l.iend)
+    {
+        l.op = op;
+        return op == l.oend ? LANE_DONE : LANE_ERROR;
+    }
+
+    if (l.iend - ip < 2) return LANE_ERROR;
+    offset = ip[0] | (size_t)ip[1] << 8;
+    ip += 2;
+    if (offset == 0 || offset > (size_t)(op - l.ostart)) return LANE_ERROR;
+    len = token & 15;
+match:
+    if (len == 15 && !lz4_length(ip, l.iend, len)) return LANE_ERROR;
+    len += 4;
+    if ((size_t)(l.oend - op) < len) return LANE_ERROR;
+    copy_match(op, offset, len, l.oend - op);
+    l.ip = ip;
+    l.op = op + len;
+    return LANE_MORE;
+}
+
+
+/* snappy: a varint of the uncompressed size, then tags of literals and of copies with 1, 2 or 4 byte offsets */
+static inline bool snappy_start(lane_t& l)
+{
+    uint64_t size = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (l.ip >= l.iend) return false;
+        uint8_t b = *l.ip++;
+        size |= (uint64_t)(b & 127) << shift;
+        if (b < 128) return size == (uint64_t)(l.oend - l.ostart);
+    }
+    return false;
+}
+
+static inline int snappy_step(lane_t& l)
+{
+    const uint8_t* ip = l.ip;
+    uint8_t* op = l.op;
+    size_t len, offset;
+
+    if (ip >= l.iend) return op == l.oend ? LANE_DONE : LANE_ERROR;
+    unsigned tag = *ip++;
+    switch (tag & 3)
+    {
+        case 0:
+            len = tag >> 2;
+            if (len >= 60)
+            {
+                size_t bytes = len - 59;
+                if ((size_t)(l.iend - ip) < bytes) return LANE_ERROR;
+                len = 0;
+                for (size_t i = 0; i < bytes; i++) len |= (size_t)ip[i] << (8 * i);
+                ip += bytes;
+            }
+            len++;
+            if ((size_t)(l.iend - ip) < len || (size_t)(l.oend - op) < len) return LANE_ERROR;
+            copy_literals(op, ip, len, l.iend - ip, l.oend - op);
+            l.ip = ip + len;
+            l.op = op + len;
+            return LANE_MORE;
+        case 1:
+            if (ip >= l.iend) return LANE_ERROR;
+            len = ((tag >> 2) & 7) + 4;
+            offset = (size_t)(tag >> 5) << 8 | *ip++;
+            break;
+        case 2:
+            if (l.iend - ip < 2) return LANE_ERROR;
+            len = (tag >> 2) + 1;
+            offset = ip[0] | (size_t)ip[1] << 8;
+            ip += 2;
+            break;
+        default:
+            if (l.iend - ip < 4) return LANE_ERROR;
+            len = (tag >> 2) + 1;
+            offset = ip[0] | (size_t)ip[1] << 8 | (size_t)ip[2] << 16 | (size_t)ip[3] << 24;
+            ip += 4;
+            break;
+    }
+    if (offset == 0 || offset > (size_t)(op - l.ostart) || (size_t)(l.oend - op) < len) return LANE_ERROR;
+    copy_match(op, offset, len, l.oend - op);
+    l.ip = ip;
+    l.op = op + len;
+    return LANE_MORE;
+}
+
+
+template<int N, bool (*start)(lane_t&), int (*step)(lane_t&)>
+static void decode_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes)
+{
+    lane_t lanes[N];
+    size_t next = 0;
+    int active = 0;
+
+    auto fill = [&](lane_t& l) {
+        for (l.chunk = n; next < n && l.chunk == n; next++)
+        {
+            l.ip = (const uint8_t*)in[next];
+            l.iend = l.ip + insize[next];
+            l.op = l.ostart = (uint8_t*)out[next];
+            l.oend = l.op + outsize[next];
+            if (start(l)) l.chunk = next, active++;
+            else sizes[next] = 0;
+        }
+    };
+    for (int k = 0; k < N; k++) fill(lanes[k]);
+
+    while (active)
+        for (int k = 0; k < N; k++)
+        {
+            lane_t& l = lanes[k];
+            if (l.chunk == n) continue;
+            int res = step(l);
+            if (res == LANE_MORE) continue;
+            sizes[l.chunk] = (res == LANE_DONE) ? l.op - l.ostart : 0;
+            active--;
+            fill(l);
+        }
+}
+
+// param2 = chunks decoded at once, 1 = one after another by the same decoder
+template<bool (*start)(lane_t&), int (*step)(lane_t&)>
+static int64_t interleaved_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t streams)
+{
+    switch (streams)
+    {
+        case 1: decode_batch<1, start, step>(n, in, insize, out, outsize, sizes); break;
+        case 2: decode_batch<2, start, step>(n, in, insize, out, outsize, sizes); break;
+        case 3: decode_batch<3, start, step>(n, in, insize, out, outsize, sizes); break;
+        default: decode_batch<4, start, step>(n, in, insize, out, outsize, sizes); break;
+    }
+    return 0;
+}
+
+
+#ifndef BENCH_REMOVE_LZ4
+int64_t lzbench_lz4_interleaved_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    int64_t size;
+    interleaved_batch<lz4_start, lz4_step>(1, &inbuf, &insize, &outbuf, &outsize, &size, 1);
+    return size;
+}
+
+int64_t lzbench_lz4_interleaved_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t param2, char*)
+{
+    return interleaved_batch<lz4_start, lz4_step>(n, in, insize, out, outsize, sizes, param2);
+}
+#endif // BENCH_REMOVE_LZ4
+
+
+#ifndef BENCH_REMOVE_SNAPPY
+int64_t lzbench_snappy_interleaved_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    int64_t size;
+    interleaved_batch<snappy_start, snappy_step>(1, &inbuf, &insize, &outbuf, &outsize, &size, 1);
+    return size;
+}
+
+int64_t lzbench_snappy_interleaved_decompress_batch(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t param2, char*)
+{
+    return interleaved_batch<snappy_start, snappy_step>(n, in, insize, out, outsize, sizes, param2);
+}
+#endif // BENCH_REMOVE_SNAPPY
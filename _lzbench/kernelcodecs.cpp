@@ -0,0 +1,198 @@
+// compression by the kernel through a zram device of every thread, rows kernel_# next to the bundled lz4, lzo1x and zstd
+
+#include "compressors.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * The crypto API has no compression type of AF_ALG sockets, the kernel codecs are reached through zram: init adds a
+ * device with /sys/class/zram-control/hot_add, sets its algorithm (the additional param indexes kernel_algorithms),
+ * the level by algorithm_params and a disk size of KERNEL_DISKSIZE. A chunk is copied to a page-aligned buffer and
+ * written with O_DIRECT to the slot of its input (the kernel compresses every page in the write), its compressed
+ * size is the change of compr_data_size of mm_stat plus the size of the data it replaced. The output is a record of
+ * the slot and its size, decompression reads the slot with O_DIRECT (the kernel decompresses every page) and copies
+ * it out. Needs root and the zram module, lzbench skips the rows whose algorithm gets no device by
+ * lzbench_kernel_check(), e.g. the ones that the kernel was built without, and init warns once per algorithm.
+ */
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <unordered_map>
+
+#define KERNEL_PAGE 4096
+#define KERNEL_DISKSIZE (4ULL << 30)
+
+static const char* kernel_algorithms[] = { "lzo", "lzo-rle", "lz4", "lz4hc", "zstd", "deflate", "842" };
+#define KERNEL_ALGORITHMS (sizeof(kernel_algorithms) / sizeof(kernel_algorithms[0]))
+
+typedef struct
+{
+    uint64_t offset, size;
+} kernel_record_t;
+
+typedef struct
+{
+    uint64_t offset, capacity, size;
+} kernel_slot_t;
+
+typedef struct
+{
+    int id, dev, mm_stat;
+    uint8_t* buf;
+    size_t bufsize;
+    uint64_t next;
+    std::unordered_map<const char*, kernel_slot_t> slots;
+} kernel_state_t;
+
+static bool kernel_write(const char* path, const char* text)
+{
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    bool ok = fputs(text, f) >= 0;
+    return (fclose(f) == 0) && ok;
+}
+
+static uint64_t kernel_compr_data_size(kernel_state_t* state)
+{
+    char text[256];
+    unsigned long long orig = 0, compr = 0;
+    ssize_t len = pread(state->mm_stat, text, sizeof(text) - 1, 0);
+    if (len <= 0) return 0;
+    text[len] = 0;
+    if (sscanf(text, "%llu %llu", &orig, &compr) != 2) return 0;
+    return compr;
+}
+
+void lzbench_kernel_deinit(char* workmem)
+{
+    kernel_state_t* state = (kernel_state_t*)workmem;
+    char id[32];
+    if (!state) return;
+    if (state->dev >= 0) close(state->dev);
+    if (state->mm_stat >= 0) close(state->mm_stat);
+    if (state->id >= 0)
+    {
+        snprintf(id, sizeof(id), "%d", state->id);
+        kernel_write("/sys/class/zram-control/hot_remove", id);
+    }
+    free(state->buf);
+    delete state;
+}
+
+/* a device of the algorithm, otherwise NULL and the step that failed in error */
+static kernel_state_t* kernel_open(size_t insize, size_t level, size_t algorithm, const char*& error)
+{
+    kernel_state_t* state = new kernel_state_t();
+    const char* name = kernel_algorithms[algorithm < KERNEL_ALGORITHMS ? algorithm : 0];
+    char path[128], text[128];
+    FILE* f;
+
+    error = "hot_add";
+    state->id = state->dev = state->mm_stat = -1;
+    state->bufsize = (insize + KERNEL_PAGE - 1) / KERNEL_PAGE * KERNEL_PAGE;
+    if (posix_memalign((void**)&state->buf, KERNEL_PAGE, state->bufsize ? state->bufsize : KERNEL_PAGE) != 0) state->buf = NULL;
+    if (state->buf && (f = fopen("/sys/class/zram-control/hot_add", "r")))
+    {
+        if (fscanf(f, "%d", &state->id) != 1) state->id = -1;
+        fclose(f);
+    }
+    if (state->id >= 0)
+    {
+        snprintf(path, sizeof(path), "/sys/block/zram%d/comp_algorithm", state->id);
+        error = "comp_algorithm";
+        if (kernel_write(path, name))
+        {
+            snprintf(path, sizeof(path), "/sys/block/zram%d/algorithm_params", state->id);
+            snprintf(text, sizeof(text), "algo=%s level=%d", name, (int)level);
+            error = "algorithm_params";
+            if (!level || kernel_write(path, text))
+            {
+                snprintf(path, sizeof(path), "/sys/block/zram%d/disksize", state->id);
+                snprintf(text, sizeof(text), "%llu", (unsigned long long)KERNEL_DISKSIZE);
+                error = "disksize";
+                if (kernel_write(path, text))
+                {
+                    snprintf(path, sizeof(path), "/dev/zram%d", state->id);
+                    state->dev = open(path, O_RDWR | O_DIRECT);
+                    snprintf(path, sizeof(path), "/sys/block/zram%d/mm_stat", state->id);
+                    state->mm_stat = open(path, O_RDONLY);
+                    error = "open";
+                    if (state->dev >= 0 && state->mm_stat >= 0) return state;
+                }
+            }
+        }
+    }
+
+    lzbench_kernel_deinit((char*)state);
+    return NULL;
+}
+
+const char* lzbench_kernel_check(size_t level, size_t algorithm)
+{
+    const char* error = NULL;
+    kernel_state_t* state = kernel_open(KERNEL_PAGE, level, algorithm, error);
+    lzbench_kernel_deinit((char*)state);
+    return state ? NULL : error;
+}
+
+char* lzbench_kernel_init(size_t insize, size_t level, size_t algorithm)
+{
+    static bool warned[KERNEL_ALGORITHMS];
+    const char* error = NULL;
+    kernel_state_t* state = kernel_open(insize, level, algorithm, error);
+    algorithm = algorithm < KERNEL_ALGORITHMS ? algorithm : 0;
+
+    if (!state && !warned[algorithm])
+        fprintf(stderr, "warning: no zram device with %s (%s failed), kernel_# need root and the zram module\n", kernel_algorithms[algorithm], error);
+    if (!state) warned[algorithm] = true;
+    return (char*)state;
+}
+
+int64_t lzbench_kernel_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    kernel_state_t* state = (kernel_state_t*)workmem;
+    size_t padded = (insize + KERNEL_PAGE - 1) / KERNEL_PAGE * KERNEL_PAGE;
+    if (!state || padded > state->bufsize || outsize < sizeof(kernel_record_t)) return 0;
+
+    kernel_slot_t& slot = state->slots[inbuf];
+    if (slot.capacity < padded)
+    {
+        if (state->next + padded > KERNEL_DISKSIZE) return 0;
+        slot.offset = state->next, slot.capacity = padded, slot.size = 0;
+        state->next += padded;
+    }
+    memcpy(state->buf, inbuf, insize);
+    memset(state->buf + insize, 0, padded - insize);
+    uint64_t before = kernel_compr_data_size(state);
+    if (pwrite(state->dev, state->buf, padded, slot.offset) != (ssize_t)padded) return 0;
+    slot.size = kernel_compr_data_size(state) + slot.size - before;
+
+    kernel_record_t record = { slot.offset, slot.size };
+    memcpy(outbuf, &record, sizeof(record));
+    return slot.size > sizeof(record) ? slot.size : sizeof(record);
+}
+
+int64_t lzbench_kernel_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    kernel_state_t* state = (kernel_state_t*)workmem;
+    size_t padded = (outsize + KERNEL_PAGE - 1) / KERNEL_PAGE * KERNEL_PAGE;
+    kernel_record_t record;
+    if (!state || padded > state->bufsize || insize < sizeof(record)) return 0;
+
+    memcpy(&record, inbuf, sizeof(record));
+    if (record.offset + padded > KERNEL_DISKSIZE || pread(state->dev, state->buf, padded, record.offset) != (ssize_t)padded) return 0;
+    memcpy(outbuf, state->buf, outsize);
+    return outsize;
+}
+
+#else
+
+const char* lzbench_kernel_check(size_t, size_t) { return "zram"; }
+char* lzbench_kernel_init(size_t, size_t, size_t) { return NULL; }
+void lzbench_kernel_deinit(char*) {}
+int64_t lzbench_kernel_compress(char*, size_t, char*, size_t, size_t, size_t, char*) { return 0; }
+int64_t lzbench_kernel_decompress(char*, size_t, char*, size_t, size_t, size_t, char*) { return 0; }
+
+#endif // __linux__
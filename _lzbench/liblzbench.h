@@ -0,0 +1,62 @@
+#ifndef LIBLZBENCH_H
+#define LIBLZBENCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The C API of liblzbench.a (make liblzbench.a), the codecs and the benchmark of lzbench without main(). It runs the
+ * tests of -e on a buffer in memory and returns the rows instead of printing them. Link with the libraries of
+ * lzbench, e.g. -pthread -lrt -ldl on Linux. Calls run one after another, the library isn't reentrant.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    unsigned c_iters, d_iters; // -i#,#: minimum number of compression and decompression iterations
+    unsigned cmintime_ms, dmintime_ms; // -t#,#: minimum time of compression and decompression
+    size_t chunk_size; // -b# in bytes, 0 = the whole buffer like -b0
+    int threads; // -T#
+    int timetype; // -p#: 1 = fastest, 2 = average, 3 = median
+    int verbose; // -v#: 0 = nothing is printed
+} lzbench_bench_params_t;
+
+typedef struct
+{
+    char name[64]; // the row of lzbench, e.g. "zstd 1.5.6 -3"
+    char codec[32], version[32]; // of the codec table
+    int level;
+    uint64_t insize, outsize;
+    uint64_t ctime_ns, dtime_ns; // of timetype, 0 = not measured
+    double cspeed, dspeed; // MB/s
+    int error; // decompression failed or its output differs from the input
+} lzbench_result_t;
+
+typedef struct
+{
+    const char* name;
+    const char* version;
+    int first_level, last_level;
+} lzbench_codec_t;
+
+/* the defaults of lzbench: -i1,1 -t1,2 -b1747626 -T1 -p1 and -v0 */
+void lzbench_bench_defaults(lzbench_bench_params_t* bench);
+
+/*
+ * Benchmarks the codecs of codecs, the syntax of -e like "zstd,1,3/lz4" or NULL for "fast", on size bytes of data,
+ * with bench or the defaults when it's NULL. Up to max_results rows are written to results. It returns the number
+ * of rows, which may be larger than max_results, or -1 when memory can't be allocated.
+ */
+int lzbench_bench(const void* data, size_t size, const char* codecs, const lzbench_bench_params_t* bench, lzbench_result_t* results, size_t max_results);
+
+/* the codec table: up to max_codecs codecs are written to codecs, it returns the number of codecs */
+int lzbench_codecs(lzbench_codec_t* codecs, size_t max_codecs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,12 +19,172 @@
 #include "lzbench.h"
 #include "util.h"
 #include "cpuid1.h"
+#include "filters.h"
+#include "matchfinders.h"
+#include "liblzbench.h"
+#ifndef BENCH_REMOVE_ZSTD
+#include "xxhash.h" // XXH64 of zstd, its copy of xxHash is built without XXH3
+#endif
 #include <numeric>
 #include <algorithm> // sort
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
+#include <math.h> // sqrt
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <unordered_map> // --dedup
+#include <set>
+#include <limits.h> // INT_MAX
+#include <stddef.h> // offsetof
+#include <random>
+#include <atomic>
+#if !defined(_WIN32)
+    #include <dlfcn.h> // --plugin
+#else
+    #include <direct.h> // _mkdir
+#endif
+#if defined(__SSE2__)
+    #include <emmintrin.h> // _mm_clflush
+#endif
+#if defined(__linux__)
+    #include <sched.h>
+    #include <sys/syscall.h>
+    #include <sys/ioctl.h>
+    #include <linux/perf_event.h>
+    #include <malloc.h> // malloc_usable_size
+    #include <dirent.h> // --llc-ways
+    #include <spawn.h> // --cold-start
+    #include <sys/prctl.h> // --sandbox
+    #include <linux/seccomp.h>
+    #include <linux/filter.h>
+    #include <linux/audit.h>
+    extern char **environ;
+#endif
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <sys/socket.h> // --statsd
+    #include <netdb.h>
+    #include <unistd.h>
+    #include <sys/wait.h> // --isolate
+    #include <sys/resource.h>
+    #include <poll.h>
+    #include <signal.h>
+#else
+    #include <fcntl.h> // _O_BINARY
+    #include <io.h> // _setmode
+#endif
+
+/*
+ * make BENCH_HAS_USDT=1 with <sys/sdt.h> of SystemTap: USDT probes lzbench:compress_begin, compress_end,
+ * decompress_begin and decompress_end around every codec call of lzbench_compress() and lzbench_decompress()
+ * (and of their batches and work stealing) with the codec name, level, chunk index and size, so that perf record, bpftrace or
+ * flame graphs can be cut to the calls of one codec without the copies, memcmp() and memset() around them.
+ */
+#ifdef BENCH_HAS_USDT
+    #include <sys/sdt.h>
+    #define LZBENCH_PROBE(event, chunk, size) do { DTRACE_PROBE4(lzbench, event, probe_codec, probe_level, (int)(chunk), (int64_t)(size)); timeline_probe(#event, chunk, size); } while (0)
+#else
+    #define LZBENCH_PROBE(event, chunk, size) timeline_probe(#event, chunk, size)
+#endif
+
+static const char* probe_codec = ""; // codec and level of the test for LZBENCH_PROBE(), the same in all threads
+static int probe_level;
+
+
+/*
+ * --timeline=file: Chrome trace events (chrome://tracing, ui.perfetto.dev) of every codec call of a chunk, the passes
+ * of every thread, init and deinit of workmem, verification, the sleeps of lzbench_test() and reading of inputs. They
+ * are complete ("X") events kept per thread, moved to timeline_events in batches and written at exit.
+ */
+#define TIMELINE_MAX_EVENTS (4 << 20)
+
+struct timeline_event_t
+{
+    const char *name, *cat, *codec; // codec NULL = outside of a test
+    int level, tid;
+    int64_t chunk, size; // -1 = none
+    uint64_t ts, dur; // ns since the start of lzbench
+};
+
+static bool timeline_on = false;
+static std::chrono::steady_clock::time_point timeline_start = std::chrono::steady_clock::now();
+static std::mutex timeline_mutex;
+static std::vector<timeline_event_t> timeline_events;
+static std::atomic<int> timeline_tids(0);
+static std::atomic<bool> timeline_full(false);
+
+struct timeline_buffer_t
+{
+    int tid;
+    std::vector<timeline_event_t> events;
+
+    timeline_buffer_t() : tid(timeline_tids++) {}
+    ~timeline_buffer_t() { flush(); }
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(timeline_mutex);
+        size_t room = TIMELINE_MAX_EVENTS - MIN(timeline_events.size(), (size_t)TIMELINE_MAX_EVENTS);
+        if (events.size() > room) timeline_full = true;
+        timeline_events.insert(timeline_events.end(), events.begin(), events.begin() + MIN(events.size(), room));
+        events.clear();
+    }
+};
+
+static thread_local timeline_buffer_t timeline_buffer;
+
+inline uint64_t timeline_now()
+{
+    return timeline_on ? std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - timeline_start).count() : 0;
+}
+
+/* an event from begin (of timeline_now()) to now, codec and level of the test are taken from LZBENCH_PROBE() */
+void timeline_end(const char* name, const char* cat, uint64_t begin, int64_t chunk = -1, int64_t size = -1, bool test = true)
+{
+    if (!timeline_on || timeline_full) return;
+    timeline_event_t event = { name, cat, test ? probe_codec : NULL, probe_level, timeline_buffer.tid, chunk, size, begin, timeline_now() - begin };
+    timeline_buffer.events.push_back(event);
+    if (timeline_buffer.events.size() >= 4096) timeline_buffer.flush();
+}
+
+/* LZBENCH_PROBE(): a codec call of a chunk from its *_begin to its *_end, of the size at begin */
+static thread_local uint64_t timeline_call;
+static thread_local int64_t timeline_call_size;
+
+inline void timeline_probe(const char* event, int64_t chunk, int64_t size)
+{
+    if (!timeline_on) return;
+    if (!strstr(event, "_end")) { timeline_call = timeline_now(); timeline_call_size = size; return; }
+    timeline_end(event[0] == 'c' ? "compress" : "decompress", "chunk", timeline_call, chunk, timeline_call_size);
+}
+
+void fprint_json_string(FILE* f, const char* str);
+
+void timeline_write(FILE* f)
+{
+    timeline_buffer.flush();
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (int t = 0; t < timeline_tids; t++)
+        fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}},\n", t, t ? "thread" : "main", t);
+    for (size_t i = 0; i < timeline_events.size(); i++)
+    {
+        const timeline_event_t& e = timeline_events[i];
+        fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{", i ? ",\n" : "",
+            e.name, e.cat, e.tid, e.ts / 1000.0, e.dur / 1000.0);
+        const char* sep = "";
+        if (e.codec && *e.codec) fprintf(f, "\"codec\":"), fprint_json_string(f, e.codec), fprintf(f, ",\"level\":%d", e.level), sep = ",";
+        if (e.chunk >= 0) fprintf(f, "%s\"chunk\":%lld", sep, (long long)e.chunk), sep = ",";
+        if (e.size >= 0) fprintf(f, "%s\"size\":%lld", sep, (long long)e.size);
+        fprintf(f, "}}");
+    }
+    fprintf(f, "\n]}\n");
+    if (timeline_full) fprintf(stderr, "warning: --timeline keeps only the first %d events\n", TIMELINE_MAX_EVENTS);
+}
 
 
 int istrcmp(const char *str1, const char *str2)
@@ -70,553 +230,15223 @@ std::vector<std::string> split(const std::string &text, char sep)
 }
 
 
-void print_header(lzbench_params_t *params)
+static hugepage_e huge_pages = HUGE_NONE; // of alloc_and_touch(), HUGE_TLB falls back to HUGE_THP
+static std::map<void*, size_t> huge_maps; // MAP_HUGETLB buffers and their sizes
+static const char* huge_page_names[] = { "4K", "THP", "2M" };
+static hostmem_e host_memory = HOST_PAGEABLE; // of alloc_and_touch(), falls back to HOST_PAGEABLE
+static std::map<void*, int> host_bufs; // pinned and registered buffers and their hostmem_e
+static const char* host_memory_names[] = { "pageable", "pinned", "registered" };
+static precheck_e precheck_mode = PRECHECK_NONE; // of lzbench_compress(), set for the second run of --precheck
+static int fresh_output_mode = 0; // of decompression passes of lzbench_test(), set for the second run of --fresh-output=both
+static std::atomic<uint64_t> precheck_chunks(0), precheck_skipped(0);
+/* codecs whose init allocates a context that is reused by every call, see --contexts */
+static const char* context_reuse[] = { "brotli", "brotli22", "brotli24", "bzip2", "gipfeli", "libdeflate", "libdeflate_gzip", "libdeflate_zlib", "lzham", "lzham22", "lzham24", "lzhammt", "lzhammt22", "lzhammt24", "zlib", NULL };
+
+bool reuses_context(const compressor_desc_t* desc)
 {
-    switch (params->textformat)
-    {
-        case CSV:
-            if (params->show_speed)
-                printf("Compressor name,Compression speed,Decompression speed,Original size,Compressed size,Ratio,Filename\n");
-            else
-                printf("Compressor name,Compression time in us,Decompression time in us,Original size,Compressed size,Ratio,Filename\n"); break;
-            break;
-        case TURBOBENCH:
-            printf("  Compressed  Ratio   Cspeed   Dspeed         Compressor name Filename\n"); break;
-        case TEXT:
-            printf("Compressor name         Compress. Decompress. Compr. size  Ratio Filename\n"); break;
-        case TEXT_FULL:
-            printf("Compressor name         Compress. Decompress.  Orig. size  Compr. size  Ratio Filename\n"); break;
-        case MARKDOWN:
-            printf("| Compressor name         | Compression| Decompress.| Compr. size | Ratio | Filename |\n");
-            printf("| ---------------         | -----------| -----------| ----------- | ----- | -------- |\n");
-            break;
-        case MARKDOWN2:
-            printf("| Compressor name         | Ratio | Compression| Decompress.|\n");
-            printf("| ---------------         | ------| -----------| ---------- |\n");
-            break;
-    }
+    for (int i=0; context_reuse[i]; i++)
+        if (istrcmp(desc->name, context_reuse[i]) == 0) return desc->init != NULL;
+    return false;
 }
 
+/* prefixes of codecs that allocate with the counting allocator of compressors.cpp, see --alloc */
+static const char* allocator_aware[] = { "brotli", "bzip2", "pbzip2", "lzham", "lzma", "xz", "zlib", "zstd", NULL };
 
-void print_speed(lzbench_params_t *params, string_table_t& row)
+bool uses_allocator(const compressor_desc_t* desc)
 {
-    float cspeed, dspeed, ratio;
-    cspeed = row.col5_origsize * 1000.0 / row.col2_ctime;
-    dspeed = (!row.col3_dtime) ? 0 : (row.col5_origsize * 1000.0 / row.col3_dtime);
-    ratio = row.col4_comprsize * 100.0 / row.col5_origsize;
-
-    switch (params->textformat)
-    {
-        case CSV:
-            printf("%s,%.2f,%.2f,%llu,%llu,%.2f,%s\n", row.col1_algname.c_str(), cspeed, dspeed, (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str()); break;
-        case TURBOBENCH:
-            printf("%12llu %6.1f%9.2f%9.2f  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, cspeed, dspeed, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
-        case TEXT:
-        case TEXT_FULL:
-            printf("%-23s", row.col1_algname.c_str());
-            if (cspeed < 10) printf("%6.2f MB/s", cspeed);
-            else if (cspeed < 100) printf("%6.1f MB/s", cspeed);
-            else printf("%6d MB/s", (int)cspeed);
-            if (!dspeed)
-                printf("      ERROR");
-            else
-                if (dspeed < 10) printf("%6.2f MB/s", dspeed);
-                else if (dspeed < 100) printf("%6.1f MB/s", dspeed);
-                else printf("%6d MB/s", (int)dspeed);
-            if (params->textformat == TEXT_FULL)
-                printf("%12llu %12llu %6.2f %s\n", (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            else
-                printf("%12llu %6.2f %s\n", (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            break;
-        case MARKDOWN:
-            printf("| %-23s ", row.col1_algname.c_str());
-            if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
-            else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
-            else printf("|%6d MB/s ", (int)cspeed);
-            if (!dspeed)
-                printf("|      ERROR ");
-            else
-                if (dspeed < 10) printf("|%6.2f MB/s ", dspeed);
-                else if (dspeed < 100) printf("|%6.1f MB/s ", dspeed);
-                else printf("|%6d MB/s ", (int)dspeed);
-            printf("|%12llu |%6.2f | %-s|\n", (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            break;
-        case MARKDOWN2:
-            ratio = 1.0*row.col5_origsize / row.col4_comprsize;
-            printf("| %-23s |%6.3f ", row.col1_algname.c_str(), ratio);
-            if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
-            else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
-            else printf("|%6d MB/s ", (int)cspeed);
-            if (!dspeed)
-                printf("|      ERROR ");
-            else
-                if (dspeed < 10) printf("|%6.2f MB/s ", dspeed);
-                else if (dspeed < 100) printf("|%6.1f MB/s ", dspeed);
-                else printf("|%6d MB/s ", (int)dspeed);
-            printf("|\n");
-            break;
-    }
+    if (istrcmp(desc->name, "lzmat") == 0) return false;
+    for (int i=0; allocator_aware[i]; i++)
+        if (strncmp(desc->name, allocator_aware[i], strlen(allocator_aware[i])) == 0) return true;
+    return false;
 }
 
+/* worst case of compress of size bytes, at least the size of the stored chunk when compress fails */
+size_t codec_bound(const compressor_desc_t* desc, size_t size)
+{
+    if (!desc || !desc->bound) return GET_COMPRESS_BOUND(size);
+    return MAX(desc->bound(size), size);
+}
 
-void print_time(lzbench_params_t *params, string_table_t& row)
+/* checksum rows (crc32_zlib, xxh64...) only hash the input, their digest is not decompressed */
+/* the largest chunk that the API of a codec takes, see max_block_size of plugin.h */
+size_t codec_chunk_limit(const compressor_desc_t* desc)
 {
-    float ratio = row.col4_comprsize * 100.0 / row.col5_origsize;
-    uint64_t ctime = row.col2_ctime / 1000;
-    uint64_t dtime = row.col3_dtime / 1000;
+    return desc->max_block_size ? desc->max_block_size : LIMIT_2G;
+}
 
-    switch (params->textformat)
-    {
-        case CSV:
-            printf("%s,%llu,%llu,%llu,%llu,%.2f,%s\n", row.col1_algname.c_str(), (unsigned long long)ctime, (unsigned long long)dtime,  (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str()); break; 
-        case TURBOBENCH:
-            printf("%12llu %6.1f%9llu%9llu  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, (unsigned long long)ctime, (unsigned long long)dtime, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
-        case TEXT:
-        case TEXT_FULL:
-            printf("%-23s", row.col1_algname.c_str());
-            printf("%8llu us", (unsigned long long)ctime);
-            if (!dtime)
-                printf("      ERROR");
-            else
-                printf("%8llu us", (unsigned long long)dtime);
-            if (params->textformat == TEXT_FULL)
-                printf("%12llu %12llu %6.2f %s\n", (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            else
-                printf("%12llu %6.2f %s\n", (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            break;
-        case MARKDOWN:
-        case MARKDOWN2:
-            printf("| %-23s ", row.col1_algname.c_str());
-            printf("|%8llu us ", (unsigned long long)ctime);
-            if (!dtime)
-                printf("|      ERROR ");
-            else
-                printf("|%8llu us ", (unsigned long long)dtime);
-            printf("|%12llu |%6.2f | %-s|\n", (unsigned long long)row.col4_comprsize, ratio, row.col6_filename.c_str());
-            break;
-    }
+
+bool is_checksum(const compressor_desc_t* desc)
+{
+    return desc->decompress == lzbench_return_0;
 }
 
+/*
+ * The binary is built for the baseline of the target (SSE2 on x86-64), codecs built for a higher instruction set
+ * are skipped on CPUs without it and codecs that select a path at runtime get its name, see the ISA column of --isa.
+ */
+static const struct { const char* prefix; const char* isa; bool dispatch; } codec_isas[] = {
+    { "lzsse", "sse4.1", false }, { "nakamichi", "avx", false }, // compiled with -msse4.1 and -mavx
+    { "libdeflate", "bmi2", true }, { "zstd", "bmi2", true }, // DYNAMIC_BMI2 of zstd/huf, decompression of libdeflate
+    { "memcpy_avx2", "avx2", false }, { "memcpy_avx512", "avx512f", false }, // target attributes of the copy baselines
+    { "streamvbyte", "ssse3", true } }; // shuffle decoder of intcodecs.cpp
 
-void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int level, std::vector<uint64_t> &ctime, std::vector<uint64_t> &dtime, size_t insize, size_t outsize, bool decomp_error)
+bool cpu_supports(const char* isa)
 {
-    std::string col1_algname;
-    std::sort(ctime.begin(), ctime.end());
-    std::sort(dtime.begin(), dtime.end());
-    uint64_t best_ctime, best_dtime;
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (!strcmp(isa, "ssse3")) return __builtin_cpu_supports("ssse3");
+    if (!strcmp(isa, "sse4.1")) return __builtin_cpu_supports("sse4.1");
+    if (!strcmp(isa, "avx")) return __builtin_cpu_supports("avx");
+    if (!strcmp(isa, "bmi2")) return __builtin_cpu_supports("bmi2");
+    if (!strcmp(isa, "avx2")) return __builtin_cpu_supports("avx2");
+    if (!strcmp(isa, "avx512f")) return __builtin_cpu_supports("avx512f");
+#endif
+    (void)isa;
+    return false;
+}
 
-    switch (params->timetype)
+/* the instruction set of the path of a codec on this CPU, NULL if it was built for one that the CPU lacks */
+const char* codec_isa(const compressor_desc_t* desc, const char** needs = NULL)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    const char* base = "sse2";
+#elif defined(__aarch64__) || defined(__ARM_NEON)
+    const char* base = "neon";
+#else
+    const char* base = "scalar";
+#endif
+    const char* name = strrchr(desc->name, '+') ? strrchr(desc->name, '+') + 1 : desc->name; // after the filters of -e
+    if (strchr(name, ':')) name = strchr(name, ':') + 1; // after mt#: of -e
+
+    for (size_t i=0; i<sizeof(codec_isas)/sizeof(codec_isas[0]); i++)
     {
-        default:
-        case FASTEST: 
-            best_ctime = ctime.empty()?0:ctime[0];
-            best_dtime = dtime.empty()?0:dtime[0];
-            break;
-        case AVERAGE: 
-            best_ctime = ctime.empty()?0:std::accumulate(ctime.begin(),ctime.end(),(uint64_t)0) / ctime.size();
-            best_dtime = dtime.empty()?0:std::accumulate(dtime.begin(),dtime.end(),(uint64_t)0) / dtime.size();
-            break;
-        case MEDIAN: 
-            best_ctime = ctime.empty()?0:(ctime[(ctime.size()-1)/2] + ctime[ctime.size()/2]) / 2;
-            best_dtime = dtime.empty()?0:(dtime[(dtime.size()-1)/2] + dtime[dtime.size()/2]) / 2;
-            break;
+        if (strncmp(name, codec_isas[i].prefix, strlen(codec_isas[i].prefix))) continue;
+        if (needs) *needs = codec_isas[i].isa;
+        if (cpu_supports(codec_isas[i].isa)) return codec_isas[i].isa;
+        return codec_isas[i].dispatch ? base : NULL;
     }
+    return base;
+}
 
-    if (desc->first_level == 0 && desc->last_level==0)
-        format(col1_algname, "%s %s", desc->name, desc->version);
-    else
-        format(col1_algname, "%s %s -%d", desc->name, desc->version, level);
+/* --plugin: compressors of shared objects, they have the indexes after LZBENCH_COMPRESSOR_COUNT in jobs */
+static std::vector<compressor_desc_t> plugin_desc;
 
-    params->results.push_back(string_table_t(col1_algname, best_ctime, (decomp_error)?0:best_dtime, outsize, insize, params->in_filename));
-    if (params->show_speed)
-        print_speed(params, params->results[params->results.size()-1]);
-    else
-        print_time(params, params->results[params->results.size()-1]);
+int codec_count() { return LZBENCH_COMPRESSOR_COUNT + (int)plugin_desc.size(); }
 
-    ctime.clear();
-    dtime.clear();
+const compressor_desc_t* codec_desc(int i) { return i < LZBENCH_COMPRESSOR_COUNT ? &comp_desc[i] : &plugin_desc[i - LZBENCH_COMPRESSOR_COUNT]; }
+
+int codec_index(const compressor_desc_t* desc)
+{
+    if (desc >= comp_desc && desc < comp_desc + LZBENCH_COMPRESSOR_COUNT) return (int)(desc - comp_desc);
+    return LZBENCH_COMPRESSOR_COUNT + (int)(desc - plugin_desc.data());
 }
 
+/* bundled codecs with a plugin variant name[variant], e.g. zstd[system] of lzbench-system.so, are shown as name[bundled] */
+static std::vector<std::string> plugin_variants;
 
-size_t common(uint8_t *p1, uint8_t *p2)
+std::string codec_name(const compressor_desc_t* desc)
 {
-    size_t size = 0;
+    if (desc < comp_desc || desc >= comp_desc + LZBENCH_COMPRESSOR_COUNT) return desc->name;
+    for (size_t i=0; i<plugin_variants.size(); i++)
+        if (istrcmp(plugin_variants[i].c_str(), desc->name) == 0) return std::string(desc->name) + "[bundled]";
+    return desc->name;
+}
 
-    while (*(p1++) == *(p2++))
-        size++;
+/* the shared object is never unloaded, names and functions of its compressors are used until exit */
+bool lzbench_load_plugin(const char* path)
+{
+    lzbench_plugin_func entry;
+    const compressor_desc_t* descs;
+    int count = 0;
+#ifdef _WIN32
+    HMODULE lib = LoadLibraryA(path);
+    if (!lib) { fprintf(stderr, "--plugin: cannot load %s (error %lu)\n", path, (unsigned long)GetLastError()); return false; }
+    entry = (lzbench_plugin_func)GetProcAddress(lib, "lzbench_plugin");
+#else
+    void* lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!lib) { fprintf(stderr, "--plugin: %s\n", dlerror()); return false; }
+    entry = (lzbench_plugin_func)dlsym(lib, "lzbench_plugin");
+#endif
+    if (!entry) { fprintf(stderr, "--plugin: %s does not export lzbench_plugin()\n", path); return false; }
+    if (!(descs = entry(LZBENCH_PLUGIN_ABI, &count)) || count <= 0) { fprintf(stderr, "--plugin: %s has no compressors for ABI %d\n", path, LZBENCH_PLUGIN_ABI); return false; }
 
-    return size;
+    for (int k=0; k<count; k++)
+    {
+        if (!descs[k].name || !descs[k].compress || !descs[k].decompress) { fprintf(stderr, "--plugin: %s: compressor %d has no name or functions\n", path, k); return false; }
+        int i = 1;
+        while (i < codec_count() && istrcmp(codec_desc(i)->name, descs[k].name) != 0) i++;
+        if (i < codec_count()) { fprintf(stderr, "warning: --plugin: %s of %s is skipped, a compressor has the same name\n", descs[k].name, path); continue; }
+        plugin_desc.push_back(descs[k]);
+        if (!plugin_desc.back().version) plugin_desc.back().version = "plugin";
+        const char* variant = strchr(descs[k].name, '[');
+        if (variant) plugin_variants.push_back(std::string(descs[k].name, variant - descs[k].name));
+    }
+    return true;
 }
 
-/*
- * Allocate a buffer of size bytes using malloc (or equivalent call returning a buffer
- * that can be passed to free). Touches each page so that the each page is actually
- * physically allocated and mapped into the process.
- */
-void *alloc_and_touch(size_t size, bool must_zero) {
-	void *buf = must_zero ? calloc(1, size) : malloc(size);
-	volatile char zero = 0;
-	for (size_t i = 0; i < size; i += MIN_PAGE_SIZE) {
-		static_cast<char * volatile>(buf)[i] = zero;
-	}
-	return buf;
+/* --consume=path: the consumer of a shared object, also never unloaded */
+consume_func lzbench_load_consumer(const char* path)
+{
+    consume_func consumer;
+#ifdef _WIN32
+    HMODULE lib = LoadLibraryA(path);
+    if (!lib) { fprintf(stderr, "--consume: cannot load %s (error %lu)\n", path, (unsigned long)GetLastError()); return NULL; }
+    consumer = (consume_func)GetProcAddress(lib, "lzbench_consume");
+#else
+    void* lib = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!lib) { fprintf(stderr, "--consume: %s\n", dlerror()); return NULL; }
+    consumer = (consume_func)dlsym(lib, "lzbench_consume");
+#endif
+    if (!consumer) fprintf(stderr, "--consume: %s does not export lzbench_consume()\n", path);
+    return consumer;
 }
 
+/* codecs that are run also with the dictionary of --dict */
+static const char* dictionary_codecs[] = { "brotli", "brotli22", "brotli24", "lz4", "zstd", NULL };
 
-inline int64_t lzbench_compress(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, compress_func compress, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t outsize, size_t param1, size_t param2, char* workmem)
+bool uses_dictionary(const compressor_desc_t* desc)
 {
-    int64_t clen;
-    size_t outpart, part, sum = 0;
-    uint8_t *start = inbuf;
-    int cscount = chunk_sizes.size();
+    for (int i=0; dictionary_codecs[i]; i++)
+        if (istrcmp(desc->name, dictionary_codecs[i]) == 0) return desc->init != NULL;
+    return false;
+}
 
-    compr_sizes.resize(cscount);
 
-    for (int i=0; i<cscount; i++)
-    {
-        part = chunk_sizes[i];
-        outpart = GET_COMPRESS_BOUND(part);
-        if (outpart > outsize) outpart = outsize;
+/* codecs that compress against the reference of --delta, the codec without _delta is the one without the reference */
+static const char* delta_codecs[] = { "brotli_delta", "lz4_delta", "zstd_delta", NULL };
 
-        clen = compress((char*)inbuf, part, (char*)outbuf, outpart, param1, param2, workmem);
-        LZBENCH_PRINT(9, "ENC part=%d clen=%d in=%d\n", (int)part, (int)clen, (int)(inbuf-start));
+bool is_delta(const compressor_desc_t* desc)
+{
+    for (int i=0; delta_codecs[i]; i++)
+        if (istrcmp(desc->name, delta_codecs[i]) == 0) return true;
+    return false;
+}
 
-        if (clen <= 0 || clen == part)
-        {
-            if (part > outsize) return 0;
-            memcpy(outbuf, inbuf, part);
-            clen = part;
-        }
+/*
+ * --feed: a codec with stream_desc_t is run also through lzbench_feed_compress(), which feeds every chunk in writes
+ * of feed_write bytes to a new stream and flushes it every feed_flush bytes. The workmem of a test is lzbench_feed_t
+ * that keeps the workmem of the codec for its one-shot decompress.
+ */
+typedef struct
+{
+    const compressor_desc_t* desc;
+    size_t write_size, flush_size;
+    char* workmem;
+} lzbench_feed_t;
 
-        inbuf += part;
-        outbuf += clen;
-        outsize -= clen;
-        compr_sizes[i] = clen;
-        sum += clen;
-    }
-    return sum;
+static lzbench_feed_t feed_setup; // copied by lzbench_feed_init() for every thread
+
+char* lzbench_feed_init(size_t insize, size_t level, size_t param2)
+{
+    lzbench_feed_t* feed = (lzbench_feed_t*)malloc(sizeof(lzbench_feed_t));
+    if (!feed) return NULL;
+    *feed = feed_setup;
+    feed->workmem = feed->desc->init ? feed->desc->init(insize, level, param2) : NULL;
+    return (char*)feed;
 }
 
+void lzbench_feed_deinit(char* workmem)
+{
+    lzbench_feed_t* feed = (lzbench_feed_t*)workmem;
+    if (!feed) return;
+    if (feed->desc->deinit) feed->desc->deinit(feed->workmem);
+    free(feed);
+}
 
-inline int64_t lzbench_decompress(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, compress_func decompress, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t param1, size_t param2, char* workmem)
+int64_t lzbench_feed_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
 {
-    int64_t dlen;
-    size_t part, sum = 0;
-    uint8_t *outstart = outbuf;
-    int cscount = compr_sizes.size();
+    lzbench_feed_t* feed = (lzbench_feed_t*)workmem;
+    if (!feed) return 0;
+    const stream_desc_t* stream = feed->desc->stream;
+    size_t inpos = 0, outpos = 0, unflushed = 0;
+    int64_t res;
 
-    for (int i=0; i<cscount; i++)
+    char* state = stream->begin(level, param2);
+    if (!state) return 0;
+    while (inpos < insize)
     {
-        part = compr_sizes[i];
-        if (part == chunk_sizes[i]) // uncompressed
-        {
-            memcpy(outbuf, inbuf, part);
-            dlen = part;
-        }
-        else
+        size_t part = MIN(feed->write_size, insize - inpos);
+        if ((res = stream->feed(state, inbuf + inpos, part, outbuf + outpos, outsize - outpos)) < 0) goto error;
+        inpos += part;
+        outpos += res;
+        if (feed->flush_size && stream->flush && (unflushed += part) >= feed->flush_size)
         {
-            dlen = decompress((char*)inbuf, part, (char*)outbuf, chunk_sizes[i], param1, param2, workmem);
+            if ((res = stream->flush(state, outbuf + outpos, outsize - outpos)) < 0) goto error;
+            outpos += res;
+            unflushed = 0;
         }
-        LZBENCH_PRINT(9, "DEC part=%d dlen=%d out=%d\n", (int)part, (int)dlen, (int)(outbuf - outstart));
-        if (dlen <= 0) return dlen;
-
-        inbuf += part;
-        outbuf += dlen;
-        sum += dlen;
     }
+    if ((res = stream->end(state, outbuf + outpos, outsize - outpos)) < 0) return 0;
+    return outpos + res;
+error:
+    stream->end(state, NULL, 0);
+    return 0;
+}
 
-    return sum;
+int64_t lzbench_feed_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_feed_t* feed = (lzbench_feed_t*)workmem;
+    if (!feed) return 0;
+    compress_func decompress = feed->desc->stream->decompress ? feed->desc->stream->decompress : feed->desc->decompress;
+    return decompress(inbuf, insize, outbuf, outsize, level, param2, feed->workmem);
 }
 
+/*
+ * -e "shuffle4+lz4": every chunk is run through the chain of filters before compress of the codec and through
+ * the inverse filters after its decompress. The workmem of a test is lzbench_filtered_t with the workmem of the
+ * codec and two buffers for the filters. Without a codec (desc = NULL) lzbench_filter_compress() is the filters
+ * alone with a byte of header, so the chunk is not taken as stored and its decompress runs the inverse filters.
+ */
+typedef struct
+{
+    const compressor_desc_t* desc;
+    std::vector<lzbench_filter_t> filters;
+    std::vector<uint8_t> buf[2];
+    char* workmem;
+} lzbench_filtered_t;
+
+static lzbench_filtered_t filter_setup; // copied by lzbench_filter_init() for every thread
 
-void lzbench_test(lzbench_params_t *params, std::vector<size_t> &file_sizes, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1)
+char* lzbench_filter_init(size_t insize, size_t level, size_t param2)
 {
-    float speed;
-    int i, total_c_iters, total_d_iters;
-    bench_timer_t loop_ticks, start_ticks, end_ticks, timer_ticks;
-    int64_t complen=0, decomplen;
-    uint64_t nanosec, total_nanosec;
-    std::vector<uint64_t> ctime, dtime;
-    std::vector<size_t> compr_sizes, chunk_sizes;
-    bool decomp_error = false;
-    char* workmem = NULL;
-    size_t param2 = desc->additional_param;
-    size_t chunk_size = (params->chunk_size > insize) ? insize : params->chunk_size;
+    lzbench_filtered_t* filtered = new lzbench_filtered_t(filter_setup);
+    filtered->buf[0].resize(insize + PAD_SIZE);
+    filtered->buf[1].resize(insize + PAD_SIZE);
+    filtered->workmem = (filtered->desc && filtered->desc->init) ? filtered->desc->init(insize, level, param2) : NULL;
+    return (char*)filtered;
+}
 
-    LZBENCH_PRINT(5, "*** trying %s insize=%d comprsize=%d chunk_size=%d\n", desc->name, (int)insize, (int)comprsize, (int)chunk_size);
+void lzbench_filter_deinit(char* workmem)
+{
+    lzbench_filtered_t* filtered = (lzbench_filtered_t*)workmem;
+    if (!filtered) return;
+    if (filtered->desc && filtered->desc->deinit) filtered->desc->deinit(filtered->workmem);
+    delete filtered;
+}
 
-    if (desc->max_block_size != 0 && chunk_size > desc->max_block_size) chunk_size = desc->max_block_size;
-    if (!desc->compress || !desc->decompress) goto done;
-    if (desc->init) workmem = desc->init(chunk_size, param1, param2);
+int64_t lzbench_filter_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_filtered_t* filtered = (lzbench_filtered_t*)workmem;
+    size_t count = filtered->filters.size();
+    const uint8_t* src = (const uint8_t*)inbuf;
 
-    if (params->cspeed > 0)
+    if (insize + PAD_SIZE > filtered->buf[0].size()) return 0;
+    if (!filtered->desc)
     {
-        size_t part = MIN(100*1024, chunk_size);
-        GetTime(start_ticks);
-        int64_t clen = desc->compress((char*)inbuf, part, (char*)compbuf, GET_COMPRESS_BOUND(part), param1, param2, workmem);
+        if (outsize < insize + 1) return 0;
+        outbuf[0] = 0;
+        count--;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        lzbench_filter_forward(filtered->filters[i], src, filtered->buf[i & 1].data(), insize);
+        src = filtered->buf[i & 1].data();
+    }
+    if (!filtered->desc)
+    {
+        lzbench_filter_forward(filtered->filters[count], src, (uint8_t*)outbuf + 1, insize);
+        return insize + 1;
+    }
+    return filtered->desc->compress((char*)src, insize, outbuf, outsize, level, param2, filtered->workmem);
+}
+
+int64_t lzbench_filter_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_filtered_t* filtered = (lzbench_filtered_t*)workmem;
+    size_t count = filtered->filters.size();
+    const uint8_t* src = (const uint8_t*)inbuf + 1;
+
+    if (outsize + PAD_SIZE > filtered->buf[0].size()) return 0;
+    if (filtered->desc)
+    {
+        int64_t dlen = filtered->desc->decompress(inbuf, insize, (char*)filtered->buf[0].data(), outsize, level, param2, filtered->workmem);
+        if (dlen != (int64_t)outsize) return dlen;
+        src = filtered->buf[0].data();
+    }
+    for (size_t i = count; i-- > 0; )
+    {
+        uint8_t* dst = i ? filtered->buf[(count - i) & 1].data() : (uint8_t*)outbuf;
+        lzbench_filter_inverse(filtered->filters[i], src, dst, outsize);
+        src = dst;
+    }
+    return outsize;
+}
+
+static const char* page_cache_names[] = { "-", "cold", "warm", "mem" }; // pagecache_e
+static const char* readahead_names[] = { "-", "normal", "sequential", "random" };
+
+
+/*
+ * -e bestof: a meta-codec that compresses every chunk with one of the candidates of --bestof and writes
+ * its index in a byte before the compressed data. The candidate is chosen by sampled order-0 entropy or lz4 ratio
+ * against thresholds or by trying the candidates in turn within a time budget and keeping the smallest output.
+ * "store" is a candidate without a codec, its chunks are stored by lzbench_compress(). The workmem of a test is
+ * lzbench_bestof_t, the choices and the time of decisions of all threads are counted in bestof_setup.
+ */
+#define BESTOF_MAX 16
+enum bestof_e { BESTOF_TRY=0, BESTOF_ENTROPY, BESTOF_LZ4 };
+
+typedef struct
+{
+    std::vector<const compressor_desc_t*> descs; // NULL = store
+    std::vector<int> levels;
+    std::vector<std::string> names;
+    bestof_e select;
+    std::vector<float> thresholds; // descending bits per byte or lz4 ratio in %, chunks at or over thresholds[i] get candidate i
+    uint64_t budget_ns; // BESTOF_TRY: no more candidates are tried after this time, 0 = all
+    bench_rate_t rate;
+    std::atomic<uint64_t> chosen[BESTOF_MAX], decision_ns, total_ns;
+} lzbench_bestof_setup_t;
+
+static lzbench_bestof_setup_t bestof_setup;
+
+typedef struct
+{
+    std::vector<char*> workmem;
+    std::vector<char> buf; // output of a tried candidate
+} lzbench_bestof_t;
+
+char* lzbench_bestof_init(size_t insize, size_t level, size_t param2)
+{
+    lzbench_bestof_t* bestof = new lzbench_bestof_t;
+    for (size_t i = 0; i < bestof_setup.descs.size(); i++)
+    {
+        const compressor_desc_t* desc = bestof_setup.descs[i];
+        bestof->workmem.push_back((desc && desc->init) ? desc->init(insize, bestof_setup.levels[i], 0) : NULL);
+    }
+    if (bestof_setup.select == BESTOF_TRY) bestof->buf.resize(GET_COMPRESS_BOUND(insize) + PAD_SIZE);
+    return (char*)bestof;
+}
+
+void lzbench_bestof_deinit(char* workmem)
+{
+    lzbench_bestof_t* bestof = (lzbench_bestof_t*)workmem;
+    if (!bestof) return;
+    for (size_t i = 0; i < bestof->workmem.size(); i++)
+        if (bestof_setup.descs[i] && bestof_setup.descs[i]->deinit) bestof_setup.descs[i]->deinit(bestof->workmem[i]);
+    delete bestof;
+}
+
+/* order-0 entropy in bits per byte or lz4 ratio in % of 8 samples of 512 bytes spread over a chunk */
+float bestof_estimate(const uint8_t *buf, size_t size)
+{
+    const size_t sample = 512, samples = 8;
+    size_t step = size > sample * samples ? size / samples : sample, total = 0;
+
+    if (bestof_setup.select == BESTOF_ENTROPY)
+    {
+        uint32_t freq[256] = { 0 };
+        for (size_t pos = 0; pos < size; pos += step)
+        {
+            size_t len = MIN(sample, size - pos);
+            for (size_t i = 0; i < len; i++) freq[buf[pos + i]]++;
+            total += len;
+        }
+        double bits = 0;
+        for (int c = 0; c < 256; c++)
+            if (freq[c]) bits -= freq[c] * log2((double)freq[c] / total);
+        return total ? bits / total : 8;
+    }
+#ifndef BENCH_REMOVE_LZ4
+    char out[sample + sample / 255 + 16];
+    size_t compressed = 0;
+    for (size_t pos = 0; pos < size; pos += step)
+    {
+        size_t len = MIN(sample, size - pos);
+        int64_t clen = lzbench_lz4fast_compress((char*)buf + pos, len, out, sizeof(out), 1, 0, NULL);
+        compressed += (clen > 0 && (size_t)clen < len) ? clen : len;
+        total += len;
+    }
+    return total ? compressed * 100.0 / total : 100;
+#else
+    return 100;
+#endif
+}
+
+/* compress with candidate i after the byte of its index, 0 = the chunk is stored */
+int64_t bestof_compress_with(lzbench_bestof_t* bestof, size_t i, char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+    const compressor_desc_t* desc = bestof_setup.descs[i];
+    if (!desc || outsize < 2) return 0;
+    int64_t clen = desc->compress(inbuf, insize, outbuf + 1, outsize - 1, bestof_setup.levels[i], 0, bestof->workmem[i]);
+    if (clen <= 0 || (size_t)clen + 1 >= insize) return 0;
+    outbuf[0] = (char)i;
+    return clen + 1;
+}
+
+int64_t lzbench_bestof_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_bestof_t* bestof = (lzbench_bestof_t*)workmem;
+    bench_timer_t start_ticks, decided_ticks, end_ticks;
+    size_t count = bestof_setup.descs.size(), best = 0;
+    int64_t res = 0;
+
+    GetTime(start_ticks);
+    if (bestof_setup.select != BESTOF_TRY)
+    {
+        float estimate = bestof_estimate((const uint8_t*)inbuf, insize);
+        while (best < bestof_setup.thresholds.size() && estimate < bestof_setup.thresholds[best]) best++;
+        GetTime(decided_ticks);
+        res = bestof_compress_with(bestof, best, inbuf, insize, outbuf, outsize);
         GetTime(end_ticks);
-        nanosec = GetDiffTime(rate, start_ticks, end_ticks)/1000;
-        if (clen>0 && nanosec>=1000)
+        bestof_setup.decision_ns += GetDiffTime(bestof_setup.rate, start_ticks, decided_ticks);
+    }
+    else
+    {
+        // the output of the best candidate so far is kept in outbuf, the others are written to buf
+        uint64_t best_ns = 0;
+        int64_t best_len = insize; // store
+        for (size_t i = 0; i < count; i++)
         {
-            part = (part / nanosec); // speed in MB/s
-            if (part < params->cspeed) { LZBENCH_PRINT(7, "%s (100K) slower than %d MB/s nanosec=%d\n", desc->name, (uint32_t)part, (uint32_t)nanosec); goto done; }
+            bench_timer_t try_start, try_end;
+            GetTime(try_start);
+            int64_t len = bestof_compress_with(bestof, i, inbuf, insize, best_len < (int64_t)insize ? bestof->buf.data() : outbuf, best_len < (int64_t)insize ? bestof->buf.size() : outsize);
+            GetTime(try_end);
+            uint64_t ns = GetDiffTime(bestof_setup.rate, try_start, try_end);
+            if (len > 0 && len < best_len)
+            {
+                if (best_len < (int64_t)insize) memcpy(outbuf, bestof->buf.data(), len);
+                best_len = len, best = i, best_ns = ns;
+            }
+            else if (len <= 0 && !bestof_setup.descs[i] && best_len == (int64_t)insize)
+                best = i, best_ns = ns;
+            if (bestof_setup.budget_ns && GetDiffTime(bestof_setup.rate, start_ticks, try_end) >= bestof_setup.budget_ns) break;
         }
+        GetTime(end_ticks);
+        res = best_len < (int64_t)insize ? best_len : 0;
+        bestof_setup.decision_ns += GetDiffTime(bestof_setup.rate, start_ticks, end_ticks) - best_ns; // all but the chosen compression
     }
+    bestof_setup.chosen[best]++;
+    bestof_setup.total_ns += GetDiffTime(bestof_setup.rate, start_ticks, end_ticks);
+    return res;
+}
 
-    for (int i=0; i<file_sizes.size(); i++) {
-        size_t tmpsize = file_sizes[i];
-        while (tmpsize > 0)
+int64_t lzbench_bestof_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_bestof_t* bestof = (lzbench_bestof_t*)workmem;
+    size_t i = (uint8_t)inbuf[0];
+    if (insize < 1 || i >= bestof_setup.descs.size() || !bestof_setup.descs[i]) return 0;
+    return bestof_setup.descs[i]->decompress(inbuf + 1, insize - 1, outbuf, outsize, bestof_setup.levels[i], 0, bestof->workmem[i]);
+}
+
+
+/*
+ * Thread affinity and NUMA placement of buffer slices (Linux only).
+ * Nodes are read from /sys/devices/system/node and pages are moved with the
+ * mbind() syscall, so there is no dependency on libnuma.
+ */
+#if defined(__linux__)
+#define LZBENCH_MPOL_BIND 2
+#define LZBENCH_MPOL_INTERLEAVE 3
+#define LZBENCH_MPOL_MF_MOVE (1<<1)
+
+static std::vector<std::vector<int> > numa_nodes; // CPUs of every NUMA node
+
+/* CPUs of a list of sysfs like "0-3,8,10-11" */
+std::vector<int> cpu_list(const std::string &text)
+{
+    std::vector<int> cpus;
+    std::vector<std::string> ranges = split(text, ',');
+    for (size_t i=0; i<ranges.size(); i++)
+    {
+        int first, last;
+        int n = sscanf(ranges[i].c_str(), "%d-%d", &first, &last);
+        if (n == 1) last = first;
+        if (n >= 1) for (int c=first; c<=last; c++) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+
+void numa_init()
+{
+    if (!numa_nodes.empty()) return;
+
+    for (int node=0; node<1024; node++)
+    {
+        char path[128], line[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* f = fopen(path, "r");
+        if (!f) { if (node > 0 && numa_nodes.size() > 0) break; else continue; }
+        std::vector<int> cpus;
+        if (fgets(line, sizeof(line), f)) cpus = cpu_list(line);
+        fclose(f);
+        if (!cpus.empty()) numa_nodes.push_back(cpus);
+    }
+
+    if (numa_nodes.empty()) // no NUMA information, all CPUs are on a single node
+    {
+        cpu_set_t mask;
+        std::vector<int> cpus;
+        CPU_ZERO(&mask);
+        sched_getaffinity(0, sizeof(mask), &mask);
+        for (int c=0; c<CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &mask)) cpus.push_back(c);
+        numa_nodes.push_back(cpus);
+    }
+}
+
+
+int numa_node_of_thread(lzbench_params_t *params, int tid)
+{
+    int node = tid % numa_nodes.size();
+    if (params->numa_mode == NUMA_REMOTE) node = (node + 1) % numa_nodes.size();
+    return node;
+}
+
+
+void numa_pin_thread(lzbench_params_t *params, int tid)
+{
+    cpu_set_t mask;
+    int node = tid % numa_nodes.size();
+
+    CPU_ZERO(&mask);
+    if (params->pin_mode == PIN_NODE)
+    {
+        for (size_t c=0; c<numa_nodes[node].size(); c++)
+            CPU_SET(numa_nodes[node][c], &mask);
+    }
+    else
+    {
+        // spread threads over nodes: thread t gets CPU (t/nodes) of node (t%nodes)
+        std::vector<int> &cpus = numa_nodes[node];
+        CPU_SET(cpus[(tid / numa_nodes.size()) % cpus.size()], &mask);
+    }
+
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0)
+        LZBENCH_PRINT(5, "sched_setaffinity failed for thread %d\n", tid);
+}
+
+
+/* --parallel: CPUs for the workers, with nosmt only the first SMT sibling of a core, with spare not the first core of a package */
+std::vector<int> parallel_cores(lzbench_params_t *params)
+{
+    cpu_set_t mask;
+    std::vector<int> cores;
+    std::set<int> spared;
+
+    CPU_ZERO(&mask);
+    sched_getaffinity(0, sizeof(mask), &mask);
+    for (int c=0; c<CPU_SETSIZE; c++)
+    {
+        if (!CPU_ISSET(c, &mask)) continue;
+
+        char path[128];
+        int sibling = c, package = 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", c);
+        FILE* f = fopen(path, "r");
+        if (f) { if (fscanf(f, "%d", &sibling) != 1) sibling = c; fclose(f); }
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c);
+        f = fopen(path, "r");
+        if (f) { if (fscanf(f, "%d", &package) != 1) package = 0; fclose(f); }
+
+        if (params->parallel_nosmt && sibling != c) continue;
+        if (params->parallel_spare && spared.insert(package).second) continue;
+        cores.push_back(c);
+    }
+    return cores;
+}
+
+
+void numa_bind_memory(lzbench_params_t *params, void* addr, size_t size, int mode, unsigned long nodemask)
+{
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(MIN_PAGE_SIZE-1);
+    uintptr_t end = ((uintptr_t)addr + size) & ~(uintptr_t)(MIN_PAGE_SIZE-1);
+    if (end <= start) return;
+
+    if (syscall(SYS_mbind, start, end - start, mode, &nodemask, sizeof(nodemask)*8, LZBENCH_MPOL_MF_MOVE) != 0)
+        LZBENCH_PRINT(5, "mbind failed for %d bytes\n", (int)(end - start));
+}
+
+
+/* nodes with memory, also those without CPUs like CXL expanders, HBM and PMEM in KMEM DAX mode that numa_nodes skips */
+std::vector<int> numa_memory_nodes()
+{
+    char line[4096];
+    std::vector<int> nodes;
+    FILE* f = fopen("/sys/devices/system/node/has_memory", "r");
+    if (f) { if (fgets(line, sizeof(line), f)) nodes = cpu_list(line); fclose(f); }
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+
+/* the node of every page of a buffer, -1 = not resident */
+std::vector<int> numa_page_nodes(void* addr, size_t size, std::vector<void*> &pages)
+{
+    const uintptr_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t start = (uintptr_t)addr & ~(page-1), end = ((uintptr_t)addr + size) & ~(page-1);
+    pages.clear();
+    for (uintptr_t p = start; p < end; p += page) pages.push_back((void*)p);
+    std::vector<int> nodes(pages.size(), -1);
+    if (!pages.empty() && syscall(SYS_move_pages, 0, pages.size(), pages.data(), NULL, nodes.data(), 0) != 0)
+        nodes.assign(pages.size(), -1);
+    return nodes;
+}
+
+
+/* drop the policy of mbind() and move the pages back to the nodes of numa_page_nodes() */
+void numa_restore_pages(lzbench_params_t *params, std::vector<void*> &pages, std::vector<int> &nodes)
+{
+    const size_t page = sysconf(_SC_PAGESIZE);
+    std::vector<void*> moved;
+    std::vector<int> targets;
+    if (pages.empty()) return;
+    syscall(SYS_mbind, pages[0], pages.size() * page, 0 /* MPOL_DEFAULT */, NULL, 0, 0);
+    for (size_t i = 0; i < pages.size(); i++)
+        if (nodes[i] >= 0) moved.push_back(pages[i]), targets.push_back(nodes[i]);
+    std::vector<int> status(moved.size());
+    if (!moved.empty() && syscall(SYS_move_pages, 0, moved.size(), moved.data(), targets.data(), status.data(), LZBENCH_MPOL_MF_MOVE) < 0)
+        LZBENCH_PRINT(5, "move_pages failed for %d pages\n", (int)moved.size());
+}
+#endif
+
+
+/*
+ * --quiesce[=cpu]: the benchmark is pinned to one CPU with SCHED_FIFO and its memory is locked with mlockall().
+ * For 200 ms the SMT siblings of the CPU are watched in /proc/stat and interrupts served by it in /proc/interrupts,
+ * busy siblings, interrupts and a governor other than performance are reported because they add run-to-run noise.
+ */
+#if defined(__linux__)
+/* busy and total jiffies of a CPU from /proc/stat */
+static bool cpu_jiffies(int cpu, uint64_t &busy, uint64_t &total)
+{
+    char name[32], line[512];
+    FILE* f = fopen("/proc/stat", "r");
+    if (!f) return false;
+    snprintf(name, sizeof(name), "cpu%d ", cpu);
+    bool found = false;
+    while (!found && fgets(line, sizeof(line), f))
+    {
+        if (strncmp(line, name, strlen(name))) continue;
+        unsigned long long v[8] = { 0 };
+        sscanf(line + strlen(name), "%llu %llu %llu %llu %llu %llu %llu %llu", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7]);
+        total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        busy = total - v[3] - v[4]; // without idle and iowait
+        found = true;
+    }
+    fclose(f);
+    return found;
+}
+
+
+bool read_line(FILE* f, std::string &line);
+
+/* words of a line separated by spaces or tabs */
+static std::vector<std::string> split_words(const std::string &line)
+{
+    std::vector<std::string> words;
+    size_t pos = 0;
+    while ((pos = line.find_first_not_of(" \t", pos)) != std::string::npos)
+    {
+        size_t end = line.find_first_of(" \t", pos);
+        words.push_back(line.substr(pos, end - pos));
+        pos = end;
+    }
+    return words;
+}
+
+
+/* interrupts served by a CPU so far, the column "CPU#" of /proc/interrupts */
+static uint64_t cpu_interrupts(int cpu)
+{
+    std::string line, name = "CPU" + std::to_string(cpu);
+    uint64_t sum = 0;
+    FILE* f = fopen("/proc/interrupts", "r");
+    if (!f) return 0;
+    if (read_line(f, line))
+    {
+        std::vector<std::string> header = split_words(line);
+        size_t col = std::find(header.begin(), header.end(), name) - header.begin();
+        while (col < header.size() && read_line(f, line))
         {
-            chunk_sizes.push_back(MIN(tmpsize, chunk_size));
-            tmpsize -= MIN(tmpsize, chunk_size);
+            std::vector<std::string> words = split_words(line); // "IRQ:" and a count for every CPU
+            if (col + 1 < words.size() && isdigit((unsigned char)words[col + 1][0])) sum += strtoull(words[col + 1].c_str(), NULL, 10);
         }
     }
+    fclose(f);
+    return sum;
+}
 
-    LZBENCH_PRINT(5, "%s chunk_sizes=%d\n", desc->name, (int)chunk_sizes.size());
 
-    total_c_iters = 0;
-    GetTime(timer_ticks);
-    do
+void lzbench_quiesce(lzbench_params_t *params)
+{
+    cpu_set_t mask;
+    std::string state, sibling_list, governor = "unknown";
+    char path[128];
+    int cpu = params->quiesce_cpu;
+
+    CPU_ZERO(&mask);
+    sched_getaffinity(0, sizeof(mask), &mask);
+    if (cpu < 0)
+        for (int c=0; c<CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &mask)) cpu = c;
+    if (cpu < 0 || cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &mask))
     {
-        i = 0;
-        uni_sleep(1); // give processor to other processes
-        GetTime(loop_ticks);
-        do
+        fprintf(stderr, "warning: --quiesce: CPU %d is not allowed, nothing is changed\n", params->quiesce_cpu);
+        return;
+    }
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    bool pinned = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+
+    struct sched_param sp;
+    sp.sched_priority = MIN(50, sched_get_priority_max(SCHED_FIFO));
+    bool fifo = sched_setscheduler(0, SCHED_FIFO, &sp) == 0;
+    bool locked = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    if (!fifo || !locked) fprintf(stderr, "warning: --quiesce:%s%s failed (needs root or CAP_SYS_NICE/CAP_IPC_LOCK)\n", fifo ? "" : " SCHED_FIFO", locked ? "" : " mlockall()");
+    if (params->threads > 1 || params->thread_counts_nb > 1) fprintf(stderr, "warning: --quiesce: all threads share CPU %d\n", cpu);
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+    FILE* f = fopen(path, "r");
+    if (f) { read_line(f, sibling_list); fclose(f); }
+    std::vector<int> siblings;
+    for (const std::string &range : split(sibling_list, ','))
+    {
+        int a = 0, b = -1;
+        int n = sscanf(range.c_str(), "%d-%d", &a, &b);
+        if (n < 1) continue;
+        for (int c = a; c <= (n == 2 ? b : a); c++)
+            if (c != cpu) siblings.push_back(c);
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+    f = fopen(path, "r");
+    if (f) { read_line(f, governor); fclose(f); }
+
+    std::vector<uint64_t> busy0(siblings.size()), total0(siblings.size()), busy1(siblings.size()), total1(siblings.size());
+    for (size_t k=0; k<siblings.size(); k++) cpu_jiffies(siblings[k], busy0[k], total0[k]);
+    uint64_t irq0 = cpu_interrupts(cpu);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    uint64_t irq1 = cpu_interrupts(cpu);
+    float irq_rate = (irq1 - irq0) * 5.0, sibling_busy = 0;
+    for (size_t k=0; k<siblings.size(); k++)
+        if (cpu_jiffies(siblings[k], busy1[k], total1[k]) && total1[k] > total0[k])
+            sibling_busy = MAX(sibling_busy, 100.0f * (busy1[k] - busy0[k]) / (total1[k] - total0[k]));
+
+    if (sibling_busy > 5) fprintf(stderr, "warning: --quiesce: an SMT sibling of CPU %d is %.0f%% busy\n", cpu, sibling_busy);
+    if (irq_rate > 1000) fprintf(stderr, "warning: --quiesce: CPU %d serves %.0f interrupts/s, move IRQ affinity away from it\n", cpu, irq_rate);
+    if (governor != "performance" && governor != "unknown") fprintf(stderr, "warning: --quiesce: the governor of CPU %d is %s, not performance\n", cpu, governor.c_str());
+
+    format(state, "{\"cpu\":%d,\"pinned\":%s,\"fifo\":%s,\"mlock\":%s,\"smt_siblings\":%d,\"sibling_busy_pct\":%.1f,\"irq_per_s\":%.0f,\"governor\":\"%s\"}",
+        cpu, pinned ? "true" : "false", fifo ? "true" : "false", locked ? "true" : "false", (int)siblings.size(), sibling_busy, irq_rate, governor.c_str());
+    params->quiesce_state = state;
+    if (params->textformat != JSON)
+        LZBENCH_PRINT(2, "Quiesced on CPU %d: %s, %s, %d SMT siblings %.1f%% busy, %.0f interrupts/s, governor %s\n", cpu, fifo ? "SCHED_FIFO" : "no SCHED_FIFO",
+            locked ? "mlockall" : "no mlockall", (int)siblings.size(), sibling_busy, irq_rate, governor.c_str());
+}
+#else
+void lzbench_quiesce(lzbench_params_t *params)
+{
+    (void)params;
+    fprintf(stderr, "warning: --quiesce is supported only on Linux\n");
+}
+#endif
+
+
+/*
+ * --llc-ways: lzbench moves all of its threads into a resctrl group of its own (Intel CAT, AMD L3 QoS) and sets
+ * the L3 schemata of the group to the lowest # ways of every cache domain, so the tests see a slice of the LLC
+ * like a container does. It needs resctrl mounted on /sys/fs/resctrl and root, the group is removed at exit.
+ */
+static std::string resctrl_group; // empty = not created
+static int llc_total_ways, llc_min_ways, llc_current_ways;
+static uint64_t llc_bytes;
+static std::vector<std::string> llc_domains;
+
+#if defined(__linux__)
+static bool write_file(const std::string &path, const std::string &text)
+{
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+    return (fclose(f) == 0) && ok;
+}
+
+
+/* moves all threads of the process to the tasks file of a group */
+static bool resctrl_move_tasks(const std::string &group)
+{
+    DIR* dir = opendir("/proc/self/task");
+    struct dirent* entry;
+    bool ok = dir != NULL;
+    while (dir && (entry = readdir(dir)) != NULL)
+        if (entry->d_name[0] != '.') ok = write_file(group + "/tasks", std::string(entry->d_name) + "\n") && ok;
+    if (dir) closedir(dir);
+    return ok;
+}
+
+
+bool resctrl_init(lzbench_params_t *params)
+{
+    std::string line, schemata;
+    FILE* f = fopen("/sys/fs/resctrl/info/L3/cbm_mask", "r");
+    if (!f) { fprintf(stderr, "--llc-ways: L3 allocation of resctrl is not available (mount -t resctrl resctrl /sys/fs/resctrl)\n"); return false; }
+    read_line(f, line);
+    fclose(f);
+    for (uint64_t mask = strtoull(line.c_str(), NULL, 16); mask; mask >>= 1) llc_total_ways += mask & 1;
+    llc_min_ways = 1;
+    if ((f = fopen("/sys/fs/resctrl/info/L3/min_cbm_bits", "r")) != NULL) { read_line(f, line); fclose(f); llc_min_ways = MAX(atoi(line.c_str()), 1); }
+    if ((f = fopen("/sys/devices/system/cpu/cpu0/cache/index3/size", "r")) != NULL) { read_line(f, line); fclose(f); llc_bytes = strtoull(line.c_str(), NULL, 10) << (line.find('M') != std::string::npos ? 20 : 10); }
+
+    // cache domains of "L3:0=7ff;1=7ff" in the schemata of the root group
+    if ((f = fopen("/sys/fs/resctrl/schemata", "r")) != NULL)
+    {
+        while (read_line(f, line))
         {
-            GetTime(start_ticks);
-            complen = lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem);
-            GetTime(end_ticks);
-            nanosec = GetDiffTime(rate, start_ticks, end_ticks);
-            if (nanosec >= 10000) ctime.push_back(nanosec);
-            i++;
+            size_t start = line.find_first_not_of(' ');
+            if (start == std::string::npos || line.compare(start, 3, "L3:") != 0) continue;
+            for (const std::string &term : split(line.substr(start + 3), ';'))
+                llc_domains.push_back(term.substr(0, term.find('=')));
         }
-        while (GetDiffTime(rate, loop_ticks, end_ticks) < params->cloop_time);
+        fclose(f);
+    }
+    if (llc_domains.empty() || !llc_total_ways) { fprintf(stderr, "--llc-ways: no L3 domains in /sys/fs/resctrl/schemata (CDP is not supported)\n"); return false; }
 
-        nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
-        ctime.push_back(nanosec/i);
-        speed = (float)insize*i*1000/nanosec;
-        LZBENCH_PRINT(8, "%s nanosec=%d\n", desc->name, (int)nanosec);
+    format(resctrl_group, "/sys/fs/resctrl/lzbench-%d", (int)getpid());
+    if (mkdir(resctrl_group.c_str(), 0755) != 0 || !resctrl_move_tasks(resctrl_group))
+    {
+        fprintf(stderr, "--llc-ways: cannot create %s or move lzbench into it (needs root)\n", resctrl_group.c_str());
+        rmdir(resctrl_group.c_str());
+        resctrl_group.clear();
+        return false;
+    }
+    LZBENCH_PRINT(2, "L3 cache: %d ways of %.1f MB in %d domains\n", llc_total_ways, llc_bytes / 1048576.0, (int)llc_domains.size());
+    return true;
+}
 
-        if ((uint32_t)speed < params->cspeed) { LZBENCH_PRINT(7, "%s slower than %d MB/s\n", desc->name, (uint32_t)speed); return; }
 
-        total_nanosec = GetDiffTime(rate, timer_ticks, end_ticks);
-        total_c_iters += i;
-        if ((total_c_iters >= params->c_iters) && (total_nanosec > ((uint64_t)params->cmintime*1000000))) break;
-        LZBENCH_PRINT(2, "%s compr iter=%d time=%.2fs speed=%.2f MB/s     \r", desc->name, total_c_iters, total_nanosec/1000000000.0, speed);
+/* the lowest # ways of every domain, 0 = all */
+bool resctrl_set(int ways)
+{
+    std::string text = "L3:";
+    if (resctrl_group.empty()) return false;
+    for (size_t d = 0; d < llc_domains.size(); d++)
+    {
+        std::string term;
+        format(term, "%s%s=%llx", d ? ";" : "", llc_domains[d].c_str(), (unsigned long long)((1ULL << (ways ? ways : llc_total_ways)) - 1));
+        text += term;
     }
-    while (true);
+    if (!write_file(resctrl_group + "/schemata", text + "\n")) { fprintf(stderr, "--llc-ways: the schemata %s was rejected\n", text.c_str()); return false; }
+    llc_current_ways = ways;
+    return true;
+}
 
 
-    total_d_iters = 0;
-    GetTime(timer_ticks);
-    if (!params->compress_only)
-    do
+void resctrl_exit()
+{
+    if (resctrl_group.empty()) return;
+    resctrl_move_tasks("/sys/fs/resctrl");
+    rmdir(resctrl_group.c_str());
+    resctrl_group.clear();
+}
+#else
+bool resctrl_init(lzbench_params_t *params) { (void)params; fprintf(stderr, "--llc-ways is supported only on Linux\n"); return false; }
+bool resctrl_set(int ways) { (void)ways; return false; }
+void resctrl_exit() {}
+#endif
+
+
+/*
+ * --llc-mon: L3 occupancy and memory bandwidth of the threads of lzbench from the resctrl monitoring (Intel CMT/MBM,
+ * AMD L3 QoS), read around every timed pass like RAPL energy. The counters of the --llc-ways group are used, without
+ * it lzbench moves its threads into a monitoring group of its own under mon_groups, removed at exit. Threads created
+ * later are in the group of the thread that created them.
+ */
+static std::string llc_mon_group; // created by --llc-mon, empty = none
+static std::vector<std::string> llc_mon_dirs; // mon_data/mon_L3_* of the group, empty = not available
+static bool llc_mon_occupancy, llc_mon_mbm;
+
+#if defined(__linux__)
+bool llc_mon_init(lzbench_params_t *params)
+{
+    std::string line, group = resctrl_group;
+    FILE* f = fopen("/sys/fs/resctrl/info/L3_MON/mon_features", "r");
+    if (!f) { fprintf(stderr, "warning: --llc-mon: L3 monitoring of resctrl is not available (mount -t resctrl resctrl /sys/fs/resctrl)\n"); return false; }
+    while (read_line(f, line))
     {
-        i = 0;
-        uni_sleep(1); // give processor to other processes
-        GetTime(loop_ticks);
-        do
+        if (line == "llc_occupancy") llc_mon_occupancy = true;
+        if (line == "mbm_total_bytes") llc_mon_mbm = true;
+    }
+    fclose(f);
+    if (!llc_mon_occupancy && !llc_mon_mbm) { fprintf(stderr, "warning: --llc-mon: neither llc_occupancy nor mbm_total_bytes is monitored\n"); return false; }
+
+    if (group.empty())
+    {
+        format(llc_mon_group, "/sys/fs/resctrl/mon_groups/lzbench-%d", (int)getpid());
+        if (mkdir(llc_mon_group.c_str(), 0755) != 0 || !resctrl_move_tasks(llc_mon_group))
         {
-            GetTime(start_ticks);
-            decomplen = lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, param1, param2, workmem);
-            GetTime(end_ticks);
-            nanosec = GetDiffTime(rate, start_ticks, end_ticks);
-            if (nanosec >= 10000) dtime.push_back(nanosec);
-            i++;
+            fprintf(stderr, "warning: --llc-mon: cannot create %s or move lzbench into it (needs root and a free RMID)\n", llc_mon_group.c_str());
+            rmdir(llc_mon_group.c_str());
+            llc_mon_group.clear();
+            return false;
+        }
+        group = llc_mon_group;
+    }
+
+    DIR* dir = opendir((group + "/mon_data").c_str());
+    struct dirent* entry;
+    while (dir && (entry = readdir(dir)) != NULL)
+        if (!strncmp(entry->d_name, "mon_L3_", 7)) llc_mon_dirs.push_back(group + "/mon_data/" + entry->d_name);
+    if (dir) closedir(dir);
+    if (llc_mon_dirs.empty()) fprintf(stderr, "warning: --llc-mon: no L3 domains in %s/mon_data\n", group.c_str());
+    else LZBENCH_PRINT(2, "L3 monitoring: %s%s%s in %d domains\n", llc_mon_occupancy ? "occupancy" : "", llc_mon_occupancy && llc_mon_mbm ? " and " : "",
+        llc_mon_mbm ? "memory bandwidth" : "", (int)llc_mon_dirs.size());
+    return !llc_mon_dirs.empty();
+}
+
+
+/* a counter summed over all domains, false if a domain reads "Unavailable" or "Error" */
+static bool llc_mon_counter(const char* name, uint64_t &value)
+{
+    value = 0;
+    for (size_t d = 0; d < llc_mon_dirs.size(); d++)
+    {
+        unsigned long long v;
+        FILE* f = fopen((llc_mon_dirs[d] + "/" + name).c_str(), "r");
+        if (!f) return false;
+        bool ok = fscanf(f, "%llu", &v) == 1;
+        fclose(f);
+        if (!ok) return false;
+        value += v;
+    }
+    return true;
+}
+
+
+/* bytes of the LLC held by the group now and bytes read and written to memory so far, UINT64_MAX = not available */
+void llc_mon_read(uint64_t &occupancy, uint64_t &mbm)
+{
+    if (!llc_mon_occupancy || !llc_mon_counter("llc_occupancy", occupancy)) occupancy = UINT64_MAX;
+    if (!llc_mon_mbm || !llc_mon_counter("mbm_total_bytes", mbm)) mbm = UINT64_MAX;
+}
+
+
+void llc_mon_exit()
+{
+    llc_mon_dirs.clear();
+    if (llc_mon_group.empty()) return;
+    resctrl_move_tasks("/sys/fs/resctrl");
+    rmdir(llc_mon_group.c_str());
+    llc_mon_group.clear();
+}
+#else
+bool llc_mon_init(lzbench_params_t *params) { (void)params; fprintf(stderr, "warning: --llc-mon is supported only on Linux\n"); return false; }
+void llc_mon_read(uint64_t &occupancy, uint64_t &mbm) { occupancy = mbm = UINT64_MAX; }
+void llc_mon_exit() {}
+#endif
+
+
+/*
+ * --core-types: CPUs of a hybrid processor grouped by type, the fastest type first. Intel hybrid CPUs have
+ * perf PMUs cpu_core, cpu_atom and cpu_lowpower that list their CPUs, without them the core type of CPUID leaf
+ * 0x1A is read on every CPU, ARM big.LITTLE and DynamIQ CPUs are grouped by cpu_capacity of the scheduler.
+ * A processor of one type gives a single type "all". The tests of a type run on all of its CPUs.
+ */
+struct core_type_t
+{
+    std::string name;
+    std::vector<int> cpus;
+};
+static std::vector<core_type_t> core_types;
+static int core_type_current = -1;
+
+#if defined(__linux__)
+static cpu_set_t core_types_mask; // the allowed CPUs before --core-types
+
+void core_types_init(lzbench_params_t *params)
+{
+    static const char* pmus[][2] = { { "cpu_core", "P" }, { "cpu_atom", "E" }, { "cpu_lowpower", "LP-E" } };
+    std::vector<int> allowed;
+    std::string line;
+    char path[128];
+
+    CPU_ZERO(&core_types_mask);
+    sched_getaffinity(0, sizeof(core_types_mask), &core_types_mask);
+    for (int c=0; c<CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &core_types_mask)) allowed.push_back(c);
+
+    for (size_t k=0; k<sizeof(pmus)/sizeof(pmus[0]); k++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/%s/cpus", pmus[k][0]);
+        FILE* f = fopen(path, "r");
+        if (!f) continue;
+        core_type_t type;
+        type.name = pmus[k][1];
+        if (read_line(f, line))
+            for (int c : cpu_list(line))
+                if (CPU_ISSET(c, &core_types_mask)) type.cpus.push_back(c);
+        fclose(f);
+        if (!type.cpus.empty()) core_types.push_back(type);
+    }
+
+#if (defined(__i386__) || defined(__x86_64__))
+    uint32_t a, b, c, d;
+    __cpuid(0, a, b, c, d);
+    if (core_types.empty() && a >= 0x1A)
+    {
+        __cpuid_count(7, 0, a, b, c, d);
+        if (d & (1 << 15)) // hybrid
+        {
+            std::map<uint32_t, core_type_t> types; // Core (0x40) before Atom (0x20)
+            for (int cpu : allowed)
+            {
+                cpu_set_t mask;
+                CPU_ZERO(&mask);
+                CPU_SET(cpu, &mask);
+                if (sched_setaffinity(0, sizeof(mask), &mask) != 0) continue;
+                __cpuid_count(0x1A, 0, a, b, c, d);
+                core_type_t &type = types[0xFF - (a >> 24)];
+                if (type.name.empty()) type.name = (a >> 24) == 0x40 ? "P" : (a >> 24) == 0x20 ? "E" : "type " + std::to_string(a >> 24);
+                type.cpus.push_back(cpu);
+            }
+            sched_setaffinity(0, sizeof(core_types_mask), &core_types_mask);
+            for (auto &type : types) core_types.push_back(type.second);
+        }
+    }
+#endif
+
+    if (core_types.empty())
+    {
+        std::map<int, core_type_t, std::greater<int> > capacities;
+        for (int cpu : allowed)
+        {
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu);
+            FILE* f = fopen(path, "r");
+            if (!f) break;
+            if (read_line(f, line)) capacities[atoi(line.c_str())].cpus.push_back(cpu);
+            fclose(f);
+        }
+        if (capacities.size() > 1)
+            for (auto &type : capacities)
+                core_types.push_back(type.second), core_types.back().name = "cap " + std::to_string(type.first);
+    }
+
+    if (core_types.empty())
+    {
+        fprintf(stderr, "warning: --core-types: all CPUs are of the same type\n");
+        core_types.push_back(core_type_t());
+        core_types.back().name = "all";
+        core_types.back().cpus = allowed;
+    }
+    for (size_t k=0; k<core_types.size(); k++)
+        LZBENCH_PRINT(2, "Core type %s: %d CPUs\n", core_types[k].name.c_str(), (int)core_types[k].cpus.size());
+}
+
+
+/* the main thread and the threads it starts run on the CPUs of a type, -1 = on all allowed CPUs */
+void core_type_pin(lzbench_params_t *params, int k)
+{
+    cpu_set_t mask = core_types_mask;
+    if (k >= 0)
+    {
+        CPU_ZERO(&mask);
+        for (int c : core_types[k].cpus) CPU_SET(c, &mask);
+    }
+    if (sched_setaffinity(0, sizeof(mask), &mask) != 0) LZBENCH_PRINT(5, "sched_setaffinity failed for core type %d\n", k);
+    core_type_current = k;
+}
+#else
+void core_types_init(lzbench_params_t *params)
+{
+    (void)params;
+    fprintf(stderr, "warning: --core-types is supported only on Linux\n");
+    core_types.push_back(core_type_t());
+    core_types.back().name = "all";
+}
+void core_type_pin(lzbench_params_t *params, int k) { (void)params; core_type_current = k; }
+#endif
+
+
+/* "4 ways 5.5 MB" of --llc-ways */
+std::string llc_label(int ways)
+{
+    std::string label;
+    if (!ways) ways = llc_total_ways;
+    if (llc_bytes && llc_total_ways) format(label, "%d ways %.1f MB", ways, llc_bytes * ways / llc_total_ways / 1048576.0);
+    else format(label, "%d ways", ways);
+    return label;
+}
+
+
+/*
+ * Log-linear (HDR-style) histogram of latencies in nanoseconds. Every power of 2
+ * is split into HIST_SUB_COUNT buckets, what gives a relative error below 3%.
+ */
+#define HIST_SUB_BITS 5
+#define HIST_SUB_COUNT (1<<HIST_SUB_BITS)
+#define HIST_BUCKETS ((65-HIST_SUB_BITS)*HIST_SUB_COUNT)
+
+static const double latency_percentiles[LATENCY_PERCENTILES] = { 50.0, 99.0, 99.9 };
+
+// --lz-stats: upper limits of the buckets of match lengths and offsets
+static const uint32_t lz_len_limits[LZ_STAT_BUCKETS] = { 3, 4, 7, 15, 63, UINT32_MAX };
+static const uint32_t lz_off_limits[LZ_STAT_BUCKETS] = { 16, 1 << 10, 16 << 10, 64 << 10, 1 << 20, UINT32_MAX };
+static const char* lz_len_labels[LZ_STAT_BUCKETS] = { "3", "4", "5-7", "8-15", "16-63", "64+" };
+static const char* lz_off_labels[LZ_STAT_BUCKETS] = { "<=16", "<=1K", "<=16K", "<=64K", "<=1M", ">1M" };
+
+class lzbench_histogram
+{
+public:
+    bench_rate_t rate;
+
+    lzbench_histogram() : counts(HIST_BUCKETS, 0), total(0) {}
+
+    void clear() { std::fill(counts.begin(), counts.end(), 0); total = 0; }
+    void add(uint64_t nanosec) { counts[index(nanosec)]++; total++; }
+    uint64_t size() const { return total; }
+
+    void merge(const lzbench_histogram& h)
+    {
+        for (int i=0; i<HIST_BUCKETS; i++) counts[i] += h.counts[i];
+        total += h.total;
+    }
+
+    uint64_t percentile(double p) const
+    {
+        uint64_t target = (uint64_t)(p / 100.0 * total + 0.5), sum = 0;
+        if (target < 1) target = 1;
+        for (int i=0; i<HIST_BUCKETS; i++)
+        {
+            sum += counts[i];
+            if (sum >= target) return value(i);
+        }
+        return 0;
+    }
+
+private:
+    static int index(uint64_t v)
+    {
+        int shift = 0;
+        if (v < 2*HIST_SUB_COUNT) return (int)v;
+        while ((v >> shift) >= 2*HIST_SUB_COUNT) shift++;
+        return (shift+1)*HIST_SUB_COUNT + (int)((v >> shift) - HIST_SUB_COUNT);
+    }
+
+    static uint64_t value(int idx) // the middle of a bucket
+    {
+        if (idx < 2*HIST_SUB_COUNT) return idx;
+        int shift = idx/HIST_SUB_COUNT - 1;
+        uint64_t mant = idx%HIST_SUB_COUNT + HIST_SUB_COUNT;
+        return (mant << shift) + ((1ULL << shift) >> 1);
+    }
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+};
+
+
+/* per-thread state of lzbench_test: a slice of chunks with its own buffers and workmem */
+typedef struct
+{
+    std::vector<size_t> chunk_sizes, compr_sizes;
+    uint8_t *inbuf, *compbuf, *decomp;
+    size_t insize, comprsize;
+    char* workmem;
+    int64_t complen, decomplen;
+    uint64_t nanosec, best_cnanosec, best_dnanosec;
+    uint64_t busy_cnanosec, busy_dnanosec; // all passes, used with work stealing
+    uint64_t cbytes, dbytes;
+    int csteals, dsteals;
+    int perf_fd[PERF_COUNTERS];
+    uint64_t cperf[PERF_COUNTERS], dperf[PERF_COUNTERS];
+    int td_fd[TOPDOWN_EVENTS]; // --topdown: groups led by TD_CYCLES and TD_MEM_STALLS
+    uint64_t ctd[TOPDOWN_EVENTS], dtd[TOPDOWN_EVENTS];
+    lzbench_histogram chist, dhist; // per-chunk latencies
+    lzbench_freq_t cfreq, dfreq;
+} lzbench_thread_t;
+
+
+/*
+ * Frequency of the CPU of the calling thread from cpufreq (with intel_pstate and amd-pstate an
+ * APERF/MPERF average since the last read) and thermal throttle events of all CPUs.
+ */
+void freq_add(lzbench_freq_t &f, float mhz)
+{
+    if (mhz <= 0) return;
+    f.min = f.count ? MIN(f.min, mhz) : mhz;
+    f.max = f.count ? MAX(f.max, mhz) : mhz;
+    f.sum += mhz;
+    f.count++;
+}
+
+
+void freq_merge(lzbench_freq_t &f, const lzbench_freq_t &g)
+{
+    if (!g.count) return;
+    f.min = f.count ? MIN(f.min, g.min) : g.min;
+    f.max = f.count ? MAX(f.max, g.max) : g.max;
+    f.sum += g.sum;
+    f.count += g.count;
+}
+
+
+float freq_read()
+{
+    unsigned long long khz = 0;
+#if defined(__linux__)
+    char path[96];
+    int cpu = sched_getcpu();
+    if (cpu < 0) return 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpu);
+    FILE* f = fopen(path, "r");
+    if (!f) return 0;
+    if (fscanf(f, "%llu", &khz) != 1) khz = 0;
+    fclose(f);
+#endif
+    return khz / 1000.0f;
+}
+
+
+uint64_t throttle_count()
+{
+    uint64_t sum = 0;
+#if defined(__linux__)
+    static const char* names[] = { "core_throttle_count", "package_throttle_count" };
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu=0; cpu<cpus; cpu++)
+        for (int i=0; i<2; i++)
+        {
+            char path[96];
+            unsigned long long value;
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/thermal_throttle/%s", cpu, names[i]);
+            FILE* f = fopen(path, "r");
+            if (!f) continue;
+            if (fscanf(f, "%llu", &value) == 1) sum += value;
+            fclose(f);
+        }
+#endif
+    return sum;
+}
+
+
+/*
+ * CPU limits of the cgroup of a container (Kubernetes etc.): a cpuset is already the affinity mask, a CFS quota of
+ * cpu.max (v2) or cpu.cfs_quota_us (v1) of the cgroup or a parent allows quota/period CPUs of time. Default thread
+ * counts of lzbench_cpus() take the smaller of both, so threads don't oversubscribe the quota and get throttled.
+ * Throttled periods of cpu.stat are read before and after every test and rows that got throttled are flagged.
+ */
+static std::string cgroup_stat; // cpu.stat of the cgroup with the quota, empty = no quota
+static bool cgroup_v2;
+static float cgroup_cpus; // quota/period, 0 = no quota
+
+#if defined(__linux__)
+static bool cgroup_read(const std::string &path, std::string &line)
+{
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f) return false;
+    bool ok = read_line(f, line);
+    fclose(f);
+    return ok;
+}
+
+
+/* the smallest quota of the cgroup of lzbench and its parents */
+void cgroup_init()
+{
+    std::string line, dir, v1dir;
+    FILE* f = fopen("/proc/self/cgroup", "r");
+    if (!f) return;
+    while (read_line(f, line)) // "0::/path" of v2 or "4:cpu,cpuacct:/path" of v1
+    {
+        std::vector<std::string> fields = split(line, ':');
+        if (fields.size() < 3) continue;
+        if (fields[0] == "0" && fields[1].empty()) dir = "/sys/fs/cgroup" + fields[2];
+        for (const std::string &controller : split(fields[1], ','))
+            if (controller == "cpu") v1dir = fields[2];
+    }
+    fclose(f);
+
+    if (!v1dir.empty())
+    {
+        const char* mounts[] = { "/sys/fs/cgroup/cpu,cpuacct", "/sys/fs/cgroup/cpu" };
+        for (size_t k=0; k<2 && dir.empty(); k++)
+            if (access((std::string(mounts[k]) + "/cpu.cfs_period_us").c_str(), R_OK) == 0) dir = mounts[k] + v1dir;
+    }
+    else cgroup_v2 = true;
+
+    // in a cgroup namespace the path of another namespace may not exist, the root of the mount is the cgroup
+    while (!dir.empty() && access(dir.c_str(), R_OK) != 0) dir.erase(dir.rfind('/'));
+    for (; !dir.empty(); dir.erase(dir.rfind('/')))
+    {
+        float cpus = 0;
+        std::string quota, period;
+        if (cgroup_v2 && cgroup_read(dir + "/cpu.max", line)) // "max 100000" or "200000 100000"
+        {
+            std::vector<std::string> words = split(line, ' ');
+            if (words.size() == 2 && words[0] != "max" && atof(words[1].c_str()) > 0) cpus = atof(words[0].c_str()) / atof(words[1].c_str());
+        }
+        else if (!cgroup_v2 && cgroup_read(dir + "/cpu.cfs_quota_us", quota) && cgroup_read(dir + "/cpu.cfs_period_us", period))
+        {
+            if (atof(quota.c_str()) > 0 && atof(period.c_str()) > 0) cpus = atof(quota.c_str()) / atof(period.c_str());
+        }
+        if (cpus > 0 && (!cgroup_cpus || cpus < cgroup_cpus)) cgroup_cpus = cpus, cgroup_stat = dir + "/cpu.stat";
+        if (dir == "/sys/fs/cgroup" || dir.rfind('/') == 0) break;
+    }
+}
+
+
+/* throttled periods and ms so far of cpu.stat */
+bool cgroup_throttled(uint64_t &periods, double &ms)
+{
+    std::string line;
+    periods = 0, ms = 0;
+    if (cgroup_stat.empty()) return false;
+    FILE* f = fopen(cgroup_stat.c_str(), "r");
+    if (!f) return false;
+    while (read_line(f, line))
+    {
+        std::vector<std::string> words = split(line, ' ');
+        if (words.size() != 2) continue;
+        if (words[0] == "nr_throttled") periods = strtoull(words[1].c_str(), NULL, 10);
+        else if (words[0] == "throttled_usec") ms = strtoull(words[1].c_str(), NULL, 10) / 1000.0; // v2
+        else if (words[0] == "throttled_time") ms = strtoull(words[1].c_str(), NULL, 10) / 1000000.0; // v1 in ns
+    }
+    fclose(f);
+    return true;
+}
+
+
+/* CPUs for the default number of threads: the allowed CPUs (cpuset) within the CFS quota */
+int lzbench_cpus()
+{
+    cpu_set_t mask;
+    int cpus = 0;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) cpus = CPU_COUNT(&mask);
+    if (cpus <= 0) cpus = std::thread::hardware_concurrency();
+    if (cgroup_cpus > 0) cpus = MIN(cpus, (int)ceil(cgroup_cpus));
+    return MAX(cpus, 1);
+}
+#else
+void cgroup_init() {}
+bool cgroup_throttled(uint64_t &periods, double &ms) { periods = 0, ms = 0; return false; }
+int lzbench_cpus() { return MAX((int)std::thread::hardware_concurrency(), 1); }
+#endif
+
+
+/* cgroup CFS throttling during the test, shown when lzbench has a quota */
+void print_cgroup_header(lzbench_params_t *params)
+{
+    if (cgroup_stat.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Throttled periods,Throttled ms,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("  Throttled "); break;
+        case MARKDOWN: printf("  Throttled |"); break;
+        default: break;
+    }
+}
+
+
+void print_cgroup_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (cgroup_stat.empty()) return;
+
+    std::string text = "-";
+    if (row.counters.cg_throttled) format(text, "%llu %.0fms", (unsigned long long)row.counters.cg_throttled, row.counters.cg_throttled_ms);
+    switch (params->textformat)
+    {
+        case CSV: printf("%llu,%.1f,", (unsigned long long)row.counters.cg_throttled, row.counters.cg_throttled_ms); break;
+        case TEXT:
+        case TEXT_FULL: printf("%11s ", text.c_str()); break;
+        case MARKDOWN: printf(" %10s |", text.c_str()); break;
+        default: break;
+    }
+}
+
+
+static const char* numa_mode_names[] = { "default", "local", "interleave", "remote" };
+static const char* noise_names[] = { "none", "stream", "chase" };
+
+
+/* cycles per byte, IPC and misses per KB of input for compression and decompression */
+void print_perf_header(lzbench_params_t *params)
+{
+    if (!params->perf_counters) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("C cycles/B,C IPC,C LLC-misses/KB,C branch-misses/KB,C dTLB-misses/KB,D cycles/B,D IPC,D LLC-misses/KB,D branch-misses/KB,D dTLB-misses/KB,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C cyc/B C IPC  C LLC   C BrM  C TLB D cyc/B D IPC  D LLC   D BrM  D TLB "); break;
+        case MARKDOWN:
+            printf(" C cyc/B| C IPC | C LLC  | C BrM  | C TLB  | D cyc/B| D IPC | D LLC  | D BrM  | D TLB  |"); break;
+        default: break;
+    }
+}
+
+
+void print_perf_value(lzbench_params_t *params, uint64_t value, uint64_t div, double mul, const char* fmt, const char* na)
+{
+    if (value == UINT64_MAX || !div)
+        printf("%s", na);
+    else
+        printf(fmt, value * mul / div);
+}
+
+
+void print_perf_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->perf_counters) return;
+
+    const char *fmt_cpb, *fmt_ipc, *fmt_kb, *na_cpb, *na_ipc, *na_kb;
+    lzbench_counters_t &c = row.counters;
+
+    switch (params->textformat)
+    {
+        case CSV: fmt_cpb = fmt_ipc = fmt_kb = "%.3f,"; na_cpb = na_ipc = na_kb = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt_cpb = "%7.2f "; fmt_ipc = "%5.2f "; fmt_kb = "%6.2f "; na_cpb = "      - "; na_ipc = "    - "; na_kb = "     - "; break;
+        case MARKDOWN: fmt_cpb = " %6.2f |"; fmt_ipc = " %5.2f |"; fmt_kb = " %6.2f |"; na_cpb = "      - |"; na_ipc = "     - |"; na_kb = "      - |"; break;
+        default: return;
+    }
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t *values = d ? c.dvalues : c.cvalues;
+        uint64_t bytes = d ? c.dbytes : c.cbytes;
+        print_perf_value(params, values[PERF_CYCLES], bytes, 1.0, fmt_cpb, na_cpb);
+        print_perf_value(params, values[PERF_INSTRUCTIONS], (values[PERF_CYCLES] == UINT64_MAX) ? 0 : values[PERF_CYCLES], 1.0, fmt_ipc, na_ipc);
+        print_perf_value(params, values[PERF_LLC_MISSES], bytes, 1024.0, fmt_kb, na_kb);
+        print_perf_value(params, values[PERF_BRANCH_MISSES], bytes, 1024.0, fmt_kb, na_kb);
+        print_perf_value(params, values[PERF_DTLB_MISSES], bytes, 1024.0, fmt_kb, na_kb);
+    }
+}
+
+
+
+/* --topdown: % of the slots in frontend bound, bad speculation, backend memory and core bound, retiring */
+bool topdown_shares(const uint64_t *v, double *pct);
+
+void print_topdown_header(lzbench_params_t *params)
+{
+    if (!params->topdown) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("C frontend %%,C bad speculation %%,C memory bound %%,C core bound %%,C retiring %%,D frontend %%,D bad speculation %%,D memory bound %%,D core bound %%,D retiring %%,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C FE/BS/Mem/Core/Ret D FE/BS/Mem/Core/Ret "); break;
+        case MARKDOWN:
+            printf(" C FE/BS/Mem/Core/Ret | D FE/BS/Mem/Core/Ret |"); break;
+        default: break;
+    }
+}
+
+
+void print_topdown_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->topdown) return;
+
+    for (int d=0; d<2; d++)
+    {
+        double pct[5];
+        bool valid = topdown_shares(d ? row.counters.dtopdown : row.counters.ctopdown, pct);
+        std::string text = "-";
+        if (valid) format(text, "%.0f/%.0f/%.0f/%.0f/%.0f", pct[0], pct[1], pct[2], pct[3], pct[4]);
+        switch (params->textformat)
+        {
+            case CSV:
+                if (valid) printf("%.1f,%.1f,%.1f,%.1f,%.1f,", pct[0], pct[1], pct[2], pct[3], pct[4]);
+                else printf(",,,,,");
+                break;
+            case TEXT:
+            case TEXT_FULL: printf("%19s ", text.c_str()); break;
+            case MARKDOWN: printf(" %20s |", text.c_str()); break;
+            default: break;
+        }
+    }
+}
+
+/*
+ * --rusage: getrusage() of the process around every hot pass, so the CPU time of threads that MT codecs start
+ * themselves is included. Cores = CPU time over wall time, MB/s per core = MB/s of a core fully busy with the codec.
+ */
+void rusage_read(uint64_t values[6])
+{
+#if !defined(_WIN32)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    values[0] = usage.ru_utime.tv_sec * 1000000000ULL + usage.ru_utime.tv_usec * 1000ULL;
+    values[1] = usage.ru_stime.tv_sec * 1000000000ULL + usage.ru_stime.tv_usec * 1000ULL;
+    values[2] = usage.ru_minflt;
+    values[3] = usage.ru_majflt;
+    values[4] = usage.ru_nvcsw;
+    values[5] = usage.ru_nivcsw;
+#else
+    memset(values, 0, 6 * sizeof(values[0]));
+#endif
+}
+
+
+void rusage_add(lzbench_counters_t &counters, int d, const uint64_t start[6], uint64_t wall_ns)
+{
+    uint64_t end[6];
+    rusage_read(end);
+    counters.ru_user_ns[d] += end[0] - start[0];
+    counters.ru_sys_ns[d] += end[1] - start[1];
+    counters.ru_minflt[d] += end[2] - start[2];
+    counters.ru_majflt[d] += end[3] - start[3];
+    counters.ru_nvcsw[d] += end[4] - start[4];
+    counters.ru_nivcsw[d] += end[5] - start[5];
+    counters.ru_wall_ns[d] += wall_ns;
+    counters.ru_passes[d]++;
+}
+
+
+void print_rusage_header(lzbench_params_t *params)
+{
+    if (!params->rusage) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("C cores,C MB/s per core,C sys %%,C minor faults/MB,C major faults/pass,C voluntary switches/pass,C involuntary switches/pass,"
+                   "D cores,D MB/s per core,D sys %%,D minor faults/MB,D major faults/pass,D voluntary switches/pass,D involuntary switches/pass,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C cores C MB/s/c C sys%% C flt/MB C majflt C vcsw C ivcsw D cores D MB/s/c D sys%% D flt/MB D majflt D vcsw D ivcsw "); break;
+        case MARKDOWN:
+            printf(" C cores | C MB/s/c | C sys%% | C flt/MB | C majflt | C vcsw | C ivcsw | D cores | D MB/s/c | D sys%% | D flt/MB | D majflt | D vcsw | D ivcsw |"); break;
+        default: break;
+    }
+}
+
+
+void print_rusage_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->rusage) return;
+
+    lzbench_counters_t &c = row.counters;
+    for (int d=0; d<2; d++)
+    {
+        uint64_t bytes = d ? c.dbytes : c.cbytes, cpu_ns = c.ru_user_ns[d] + c.ru_sys_ns[d], passes = c.ru_passes[d];
+        if (!passes || !c.ru_wall_ns[d])
+        {
+            switch (params->textformat)
+            {
+                case CSV: printf(",,,,,,,"); break;
+                case TEXT:
+                case TEXT_FULL: printf("%7s %8s %6s %8s %8s %6s %7s ", "-", "-", "-", "-", "-", "-", "-"); break;
+                case MARKDOWN: printf(" %7s | %8s | %6s | %8s | %8s | %6s | %7s |", "-", "-", "-", "-", "-", "-", "-"); break;
+                default: break;
+            }
+            continue;
+        }
+        float cores = (float)cpu_ns / c.ru_wall_ns[d];
+        float per_core = cpu_ns ? bytes * 1000.0 / cpu_ns : 0;
+        float sys = cpu_ns ? 100.0 * c.ru_sys_ns[d] / cpu_ns : 0;
+        float faults = bytes ? c.ru_minflt[d] * 1048576.0 / bytes : 0;
+        float majflt = (float)c.ru_majflt[d] / passes, vcsw = (float)c.ru_nvcsw[d] / passes, ivcsw = (float)c.ru_nivcsw[d] / passes;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,%.2f,%.2f,%.3f,%.3f,%.3f,%.3f,", cores, per_core, sys, faults, majflt, vcsw, ivcsw); break;
+            case TEXT:
+            case TEXT_FULL: printf("%7.2f %8d %5.1f%% %8.2f %8.2f %6.1f %7.1f ", cores, (int)per_core, sys, faults, majflt, vcsw, ivcsw); break;
+            case MARKDOWN: printf(" %7.2f | %8d | %5.1f%% | %8.2f | %8.2f | %6.1f | %7.1f |", cores, (int)per_core, sys, faults, majflt, vcsw, ivcsw); break;
+            default: break;
+        }
+    }
+}
+
+
+/* percentiles of per-chunk latency in microseconds */
+void print_latency_header(lzbench_params_t *params)
+{
+    if (!params->latency) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("C p50 in us,C p99 in us,C p99.9 in us,D p50 in us,D p99 in us,D p99.9 in us,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  C p50   C p99 C p99.9   D p50   D p99 D p99.9 "); break;
+        case MARKDOWN:
+            printf("   C p50 |   C p99 | C p99.9 |   D p50 |   D p99 | D p99.9 |"); break;
+        default: break;
+    }
+}
+
+
+void print_latency_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->latency) return;
+
+    for (int d=0; d<2; d++)
+        for (int i=0; i<LATENCY_PERCENTILES; i++)
+        {
+            float us = d ? row.dlat[i] : row.clat[i];
+            switch (params->textformat)
+            {
+                case CSV: printf("%.3f,", us); break;
+                case TEXT:
+                case TEXT_FULL: printf(us < 1000 ? "%7.2f " : "%7.0f ", us); break;
+                case MARKDOWN: printf(us < 1000 ? " %7.2f |" : " %7.0f |", us); break;
+                default: break;
+            }
+        }
+}
+
+
+/* speed or time of passes with evicted caches */
+void print_cold_header(lzbench_params_t *params)
+{
+    if (params->cold_mode == COLD_NONE) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf(params->show_speed ? "Cold compression speed,Cold decompression speed," : "Cold compression time in us,Cold decompression time in us,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Cold compr. Cold decomp. "); break;
+        case MARKDOWN:
+            printf(" Cold compr.| Cold decomp.|"); break;
+        default: break;
+    }
+}
+
+
+void print_cold_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->cold_mode == COLD_NONE) return;
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t time = d ? row.cold_dtime : row.cold_ctime;
+        float speed = time ? (row.col5_origsize * 1000.0 / time) : 0;
+        switch (params->textformat)
+        {
+            case CSV:
+                if (params->show_speed) printf("%.2f,", speed); else printf("%llu,", (unsigned long long)time/1000);
+                break;
+            case TEXT:
+            case TEXT_FULL:
+            case MARKDOWN:
+                if (params->textformat == MARKDOWN) printf(" ");
+                if (!time) printf("     ERROR");
+                else if (!params->show_speed) printf("%8llu us", (unsigned long long)time/1000);
+                else if (speed < 10) printf("%6.2f MB/s", speed);
+                else if (speed < 100) printf("%6.1f MB/s", speed);
+                else printf("%6d MB/s", (int)speed);
+                printf(params->textformat == MARKDOWN ? (d ? "  |" : " |") : (d ? "  " : " "));
+                break;
+            default: break;
+        }
+    }
+}
+
+
+/* speed as % of the copy bandwidth of --bandwidth with the same number of threads */
+void print_bandwidth_header(lzbench_params_t *params)
+{
+    if (!params->bandwidth) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression speed in %% of copy bandwidth,Decompression speed in %% of copy bandwidth,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" C %%BW  D %%BW "); break;
+        case MARKDOWN:
+            printf("  C %%BW |  D %%BW |"); break;
+        default: break;
+    }
+}
+
+
+void print_bandwidth_columns(lzbench_params_t *params, string_table_t& row)
+{
+    float copy = 0;
+
+    if (!params->bandwidth) return;
+    for (int k=0; k<params->thread_counts_nb && k<(int)params->bandwidth_mbs.size(); k++)
+        if (MAX(params->thread_counts[k], 1) == row.threads) copy = params->bandwidth_mbs[k][BW_COPY];
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t time = d ? row.col3_dtime : row.col2_ctime;
+        float pct = (copy > 0 && time) ? row.col5_origsize * 1000.0 / time * 100 / copy : 0;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.2f,", pct); break;
+            case TEXT:
+            case TEXT_FULL: printf("%6.1f ", pct); break;
+            case MARKDOWN: printf(" %6.1f |", pct); break;
+            default: break;
+        }
+    }
+}
+
+
+/* --calibrate: speed in % of the calibrated memcpy or in MB per 10^9 ops of the calibrated ALU score */
+void print_calibrate_header(lzbench_params_t *params)
+{
+    if (!params->calibrate) return;
+    bool alu = params->calibrate == CALIBRATE_ALU;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            if (alu) printf("Compression speed in MB per Gop of the ALU score,Decompression speed in MB per Gop of the ALU score,");
+            else printf("Compression speed in %% of calibrated memcpy,Decompression speed in %% of calibrated memcpy,");
+            break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(alu ? "  C/Gop   D/Gop " : "  C %%MC   D %%MC "); break;
+        case MARKDOWN:
+            printf(alu ? "   C/Gop |   D/Gop |" : "   C %%MC |   D %%MC |"); break;
+        default: break;
+    }
+}
+
+
+void print_calibrate_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->calibrate) return;
+    float basis = (params->calibrate == CALIBRATE_ALU) ? params->cal_alu_mops / 1000 : params->cal_memcpy_mbs / 100;
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t time = d ? row.col3_dtime : row.col2_ctime;
+        float norm = (basis > 0 && time) ? row.col5_origsize * 1000.0 / time / basis : 0;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.2f,", norm); break;
+            case TEXT:
+            case TEXT_FULL: printf("%7.1f ", norm); break;
+            case MARKDOWN: printf(" %7.1f |", norm); break;
+            default: break;
+        }
+    }
+}
+
+
+/*
+ * --dedup and --long-range: ratio of the codec output and the recipe or the references to the input before the
+ * pre-stage, speed of the pre-stage and the codec in a row
+ */
+void print_dedup_header(lzbench_params_t *params)
+{
+    if (!params->dedup_size && !params->long_range_block) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Effective ratio with pre-stage,Effective compression speed with pre-stage,Effective decompression speed with pre-stage,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Eff.ratio  Eff.C MB/s  Eff.D MB/s "); break;
+        case MARKDOWN:
+            printf(" Eff.ratio | Eff.C MB/s | Eff.D MB/s |"); break;
+        default: break;
+    }
+}
+
+
+/* ratio in % and MB/s of the input before the pre-stage, 0 = unavailable */
+static void dedup_effective(lzbench_params_t *params, string_table_t& row, float& ratio, float& cspeed, float& dspeed)
+{
+    const lzbench_counters_t& c = row.counters;
+    ratio = (c.dedup_insize && row.col4_comprsize) ? (row.col4_comprsize + c.dedup_recipe) * 100.0 / c.dedup_insize : 0;
+    cspeed = (c.dedup_insize && row.col2_ctime) ? c.dedup_insize * 1000.0 / (c.dedup_ns + row.col2_ctime) : 0;
+    dspeed = (c.dedup_insize && row.col3_dtime) ? c.dedup_insize * 1000.0 / (c.dedup_restore_ns + row.col3_dtime) : 0;
+}
+
+
+void print_dedup_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->dedup_size && !params->long_range_block) return;
+
+    float ratio, cspeed, dspeed;
+    dedup_effective(params, row, ratio, cspeed, dspeed);
+    switch (params->textformat)
+    {
+        case CSV: printf("%.2f,%.2f,%.2f,", ratio, cspeed, dspeed); break;
+        case TEXT:
+        case TEXT_FULL:
+            if (ratio > 0) printf("%8.2f %6d MB/s %6d MB/s ", ratio, (int)cspeed, (int)dspeed); else printf("%8s %11s %11s ", "-", "-", "-");
+            break;
+        case MARKDOWN:
+            if (ratio > 0) printf(" %9.2f | %5d MB/s | %5d MB/s |", ratio, (int)cspeed, (int)dspeed); else printf(" %9s | %10s | %10s |", "-", "-", "-");
+            break;
+        default: break;
+    }
+}
+
+
+/* time converted to cycles at a fixed clock frequency, comparable between machines with different clocks */
+void print_cpb_header(lzbench_params_t *params)
+{
+    if (!params->cpb_ghz) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression cycles per byte,Decompression cycles per byte,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  C cpb   D cpb "); break;
+        case MARKDOWN:
+            printf("   C cpb |   D cpb |"); break;
+        default: break;
+    }
+}
+
+
+void print_cpb_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->cpb_ghz) return;
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t time = d ? row.col3_dtime : row.col2_ctime;
+        float cpb = row.col5_origsize ? time * params->cpb_ghz / row.col5_origsize : 0;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,", cpb); break;
+            case TEXT:
+            case TEXT_FULL: printf(cpb < 100 ? "%7.3f " : "%7.1f ", cpb); break;
+            case MARKDOWN: printf(cpb < 100 ? " %7.3f |" : " %7.1f |", cpb); break;
+            default: break;
+        }
+    }
+}
+
+
+/* --msg: every message is a separate call, a pass over all of them is timed at once */
+void print_msg_header(lzbench_params_t *params)
+{
+    if (params->msg_sizes.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression ops/s,Compression ns/op,Decompression ops/s,Decompression ns/op,Compressed bytes/op,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("   C op/s  C ns/op    D op/s  D ns/op  B/op "); break;
+        case MARKDOWN:
+            printf("    C op/s |  C ns/op |    D op/s |  D ns/op |   B/op |"); break;
+        default: break;
+    }
+}
+
+
+void print_msg_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->msg_sizes.empty()) return;
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t time = d ? row.col3_dtime : row.col2_ctime;
+        double ns = row.messages ? (double)time / row.messages : 0;
+        double ops = ns > 0 ? 1e9 / ns : 0;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.0f,%.1f,", ops, ns); break;
+            case TEXT:
+            case TEXT_FULL: printf("%9.0f %8.1f ", ops, ns); break;
+            case MARKDOWN: printf(" %9.0f | %8.1f |", ops, ns); break;
+            default: break;
+        }
+    }
+    double bytes = row.messages ? (double)row.col4_comprsize / row.messages : 0;
+    switch (params->textformat)
+    {
+        case CSV: printf("%.1f,", bytes); break;
+        case TEXT:
+        case TEXT_FULL: printf("%5.0f ", bytes); break;
+        case MARKDOWN: printf(" %6.1f |", bytes); break;
+        default: break;
+    }
+}
+
+
+/* spread of iterations */
+void print_stats_header(lzbench_params_t *params)
+{
+    if (!params->stats) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression stddev in %%,Compression CI95 in %%,Decompression stddev in %%,Decompression CI95 in %%,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" C sd%%  C ci%%  D sd%%  D ci%% "); break;
+        case MARKDOWN:
+            printf("  C sd%% |  C ci%% |  D sd%% |  D ci%% |"); break;
+        default: break;
+    }
+}
+
+
+void print_stats_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->stats) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%.2f,%.2f,%.2f,%.2f,", row.cstddev, row.cci, row.dstddev, row.dci); break;
+        case TEXT:
+        case TEXT_FULL: printf("%5.1f %5.1f %5.1f %5.1f ", row.cstddev, row.cci, row.dstddev, row.dci); break;
+        case MARKDOWN: printf(" %5.1f | %5.1f | %5.1f | %5.1f |", row.cstddev, row.cci, row.dstddev, row.dci); break;
+        default: break;
+    }
+}
+
+
+/* average core frequency of (de)compression, spread of all samples in % of the average and throttle events */
+void print_freq_header(lzbench_params_t *params)
+{
+    if (params->freq_threshold <= 0) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression MHz,Decompression MHz,Frequency spread in %%,Throttle events,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C MHz D MHz MHz%% Thrtl "); break;
+        case MARKDOWN:
+            printf(" C MHz | D MHz | MHz%% | Thrtl |"); break;
+        default: break;
+    }
+}
+
+
+float freq_spread(lzbench_counters_t &c)
+{
+    lzbench_freq_t f = c.cfreq;
+    freq_merge(f, c.dfreq);
+    return f.count ? 100 * (f.max - f.min) * f.count / f.sum : 0;
+}
+
+
+void print_freq_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->freq_threshold <= 0) return;
+
+    const char *fmt_mhz, *fmt_spread, *fmt_thr, *na_mhz, *na_spread;
+    lzbench_counters_t &c = row.counters;
+
+    switch (params->textformat)
+    {
+        case CSV: fmt_mhz = "%.0f,"; fmt_spread = "%.1f,"; fmt_thr = "%llu,"; na_mhz = na_spread = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt_mhz = "%5.0f "; fmt_spread = "%4.1f "; fmt_thr = "%5llu "; na_mhz = "    - "; na_spread = "   - "; break;
+        case MARKDOWN: fmt_mhz = " %5.0f |"; fmt_spread = " %4.1f |"; fmt_thr = " %5llu |"; na_mhz = "     - |"; na_spread = "    - |"; break;
+        default: return;
+    }
+
+    if (c.cfreq.count) printf(fmt_mhz, c.cfreq.sum / c.cfreq.count); else printf("%s", na_mhz);
+    if (c.dfreq.count) printf(fmt_mhz, c.dfreq.sum / c.dfreq.count); else printf("%s", na_mhz);
+    if (c.cfreq.count || c.dfreq.count) printf(fmt_spread, freq_spread(c)); else printf("%s", na_spread);
+    printf(fmt_thr, (unsigned long long)c.throttle);
+}
+
+
+/* page size of the benchmark buffers */
+void print_pages_header(lzbench_params_t *params)
+{
+    if (!params->hugepages) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Pages,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("Pages "); break;
+        case MARKDOWN: printf(" Pages |"); break;
+        default: break;
+    }
+}
+
+
+void print_pages_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->hugepages) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%s,", huge_page_names[row.pages]); break;
+        case TEXT:
+        case TEXT_FULL: printf("%-5s ", huge_page_names[row.pages]); break;
+        case MARKDOWN: printf(" %-5s |", huge_page_names[row.pages]); break;
+        default: break;
+    }
+}
+
+
+/* chunks stored without compression by --precheck and the speedup of compression against the run without it */
+void print_precheck_header(lzbench_params_t *params)
+{
+    if (!params->precheck) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Precheck skipped chunks,Precheck speedup,"); break;
+        case TEXT:
+        case TEXT_FULL: printf(" Skip Speedup "); break;
+        case MARKDOWN: printf("  Skip | Speedup |"); break;
+        default: break;
+    }
+}
+
+
+void print_precheck_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->precheck) return;
+
+    const lzbench_counters_t& c = row.counters;
+    bool skip = row.precheck && c.cchunks, speedup = row.precheck && row.precheck_speedup > 0;
+    switch (params->textformat)
+    {
+        case CSV:
+            if (skip) printf("%.1f,", c.cskipped * 100.0 / c.cchunks); else printf(",");
+            if (speedup) printf("%.3f,", row.precheck_speedup); else printf(",");
+            break;
+        case TEXT:
+        case TEXT_FULL:
+            if (skip) printf("%4.0f%% ", c.cskipped * 100.0 / c.cchunks); else printf("    - ");
+            if (speedup) printf("%6.2fx ", row.precheck_speedup); else printf("      - ");
+            break;
+        case MARKDOWN:
+            if (skip) printf(" %4.0f%% |", c.cskipped * 100.0 / c.cchunks); else printf("     - |");
+            if (speedup) printf(" %6.2fx |", row.precheck_speedup); else printf("       - |");
+            break;
+        default: break;
+    }
+}
+
+
+/* "4 KB" or "1 MB" for sizes of whole KB or MB, otherwise bytes */
+std::string size_label(size_t size)
+{
+    std::string label;
+    if (size == NO_LIMIT) label = "whole";
+    else if (size >= (1 << 20) && size % (1 << 20) == 0) format(label, "%llu MB", (unsigned long long)(size >> 20));
+    else if (size >= (1 << 10) && size % (1 << 10) == 0) format(label, "%llu KB", (unsigned long long)(size >> 10));
+    else format(label, "%llu B", (unsigned long long)size);
+    return label;
+}
+
+
+/* --consume: MB/s of decompression followed by the consumer over the whole output and the gain of fused decompression */
+void print_consume_header(lzbench_params_t *params)
+{
+    if (!params->consumer) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Unfused decompression speed,Fused gain in %%,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("   Unfused   Gain "); break;
+        case MARKDOWN: printf("   Unfused |   Gain |"); break;
+        default: break;
+    }
+}
+
+
+void print_consume_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->consumer) return;
+
+    uint64_t unfused = row.counters.dunfused_ns;
+    float speed = unfused ? row.col5_origsize * 1000.0 / unfused : 0;
+    float gain = (unfused && row.col3_dtime) ? 100.0 * unfused / row.col3_dtime - 100 : 0;
+    switch (params->textformat)
+    {
+        case CSV: printf("%.2f,%.2f,", speed, gain); break;
+        case TEXT:
+        case TEXT_FULL:
+            if (unfused) printf("%5d MB/s %+5.1f%% ", (int)speed, gain); else printf("%9s %6s ", "-", "-");
+            break;
+        case MARKDOWN:
+            if (unfused) printf(" %4d MB/s | %+5.1f%% |", (int)speed, gain); else printf(" %9s | %6s |", "-", "-");
+            break;
+        default: break;
+    }
+}
+
+
+/* --noise: slowdown of (de)compression with co-runners and their GB/s */
+void print_noise_header(lzbench_params_t *params)
+{
+    if (!params->noise_mode) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression slowdown with co-runners,Decompression slowdown with co-runners,Co-runners GB/s,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" C noise  D noise   N GB/s "); break;
+        case MARKDOWN:
+            printf(" C noise | D noise |  N GB/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_noise_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->noise_mode) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%.3f,%.3f,%.2f,", row.counters.nslow[0], row.counters.nslow[1], row.counters.ngbs); break;
+        case TEXT:
+        case TEXT_FULL:
+            for (int d=0; d<2; d++)
+                if (row.counters.nslow[d]) printf("%7.2fx ", row.counters.nslow[d]); else printf("%8s ", "-");
+            printf("%8.1f ", row.counters.ngbs);
+            break;
+        case MARKDOWN:
+            for (int d=0; d<2; d++)
+                if (row.counters.nslow[d]) printf(" %6.2fx |", row.counters.nslow[d]); else printf(" %7s |", "-");
+            printf(" %7.1f |", row.counters.ngbs);
+            break;
+        default: break;
+    }
+}
+
+
+/* --core-types: the type of the CPUs of the row */
+void print_core_header(lzbench_params_t *params)
+{
+    if (!params->per_core_type) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Core type,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("    Core "); break;
+        case MARKDOWN: printf("    Core |"); break;
+        default: break;
+    }
+}
+
+
+void print_core_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->per_core_type) return;
+
+    const char* name = row.core_type >= 0 && row.core_type < (int)core_types.size() ? core_types[row.core_type].name.c_str() : "-";
+    switch (params->textformat)
+    {
+        case CSV: printf("%s,", name); break;
+        case TEXT:
+        case TEXT_FULL: printf("%8s ", name); break;
+        case MARKDOWN: printf(" %7s |", name); break;
+        default: break;
+    }
+}
+
+
+/* --llc-ways: the slice of the L3 cache of the row */
+void print_llc_header(lzbench_params_t *params)
+{
+    if (params->llc_ways.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("L3 ways,L3 MB,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("       L3 slice "); break;
+        case MARKDOWN: printf("       L3 slice |"); break;
+        default: break;
+    }
+}
+
+
+void print_llc_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->llc_ways.empty()) return;
+
+    int ways = row.llc_ways ? row.llc_ways : llc_total_ways;
+    switch (params->textformat)
+    {
+        case CSV: printf("%d,%.2f,", ways, llc_total_ways ? llc_bytes * ways / llc_total_ways / 1048576.0 : 0); break;
+        case TEXT:
+        case TEXT_FULL: printf("%15s ", llc_label(row.llc_ways).c_str()); break;
+        case MARKDOWN: printf(" %14s |", llc_label(row.llc_ways).c_str()); break;
+        default: break;
+    }
+}
+
+
+/* --offsets: the misalignment of the buffers of the row */
+void print_offset_header(lzbench_params_t *params)
+{
+    if (params->buf_offsets.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Buffer offset,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("Offset "); break;
+        case MARKDOWN: printf(" Offset |"); break;
+        default: break;
+    }
+}
+
+
+void print_offset_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->buf_offsets.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%zu,", row.buf_offset); break;
+        case TEXT:
+        case TEXT_FULL: printf("%6zu ", row.buf_offset); break;
+        case MARKDOWN: printf(" %6zu |", row.buf_offset); break;
+        default: break;
+    }
+}
+
+
+/* --setup: median of init, deinit and the first calls of a new context */
+void print_setup_header(lzbench_params_t *params)
+{
+    if (!params->setup) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Init in us,Deinit in us,First compression in us,First decompression in us,Cold init in us,Cold first compression in us,Cold first decompression in us,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("    Init   Deinit    C 1st    D 1st "); break;
+        case MARKDOWN:
+            printf("     Init |   Deinit |    C 1st |    D 1st |"); break;
+        default: break;
+    }
+}
+
+
+void print_setup_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->setup) return;
+
+    float us[4] = { row.counters.sinit_us, row.counters.sdeinit_us, row.counters.sfirst_us[0], row.counters.sfirst_us[1] };
+    for (int k=0; k<4; k++)
+    {
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,", us[k]); break;
+            case TEXT:
+            case TEXT_FULL: printf(us[k] < 1000 ? "%8.2f " : "%8.0f ", us[k]); break;
+            case MARKDOWN: printf(us[k] < 1000 ? " %8.2f |" : " %8.0f |", us[k]); break;
+            default: break;
+        }
+    }
+    if (params->textformat == CSV) printf("%.3f,%.3f,%.3f,", row.counters.scold_us[0], row.counters.scold_us[1], row.counters.scold_us[2]);
+}
+
+
+/* --warmup: first-use latency, the time of the first pass before the recorded ones */
+void print_warmup_header(lzbench_params_t *params)
+{
+    if (!params->warmup_passes && !params->warmup_ms) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("First compression pass in us,First decompression pass in us,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" C first  D first "); break;
+        case MARKDOWN:
+            printf("  C first |  D first |"); break;
+        default: break;
+    }
+}
+
+
+void print_warmup_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->warmup_passes && !params->warmup_ms) return;
+
+    for (int d=0; d<2; d++)
+    {
+        float us = (d ? row.counters.dfirst_ns : row.counters.cfirst_ns) / 1000.0;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,", us); break;
+            case TEXT:
+            case TEXT_FULL: printf(us < 1000 ? "%8.2f " : "%8.0f ", us); break;
+            case MARKDOWN: printf(us < 1000 ? " %8.2f |" : " %8.0f |", us); break;
+            default: break;
+        }
+    }
+}
+
+
+/* -b#,#,...: chunk size of the row */
+void print_block_header(lzbench_params_t *params)
+{
+    if (params->block_sizes.size() <= 1) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Block size,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("   Block "); break;
+        case MARKDOWN: printf("   Block |"); break;
+        default: break;
+    }
+}
+
+
+void print_block_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->block_sizes.size() <= 1) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%llu,", (unsigned long long)row.block_size); break;
+        case TEXT:
+        case TEXT_FULL: printf("%8s ", size_label(row.block_size).c_str()); break;
+        case MARKDOWN: printf(" %7s |", size_label(row.block_size).c_str()); break;
+        default: break;
+    }
+}
+
+
+/* --isa: instruction set of the codec path */
+void print_isa_header(lzbench_params_t *params)
+{
+    if (!params->show_isa) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("ISA,"); break;
+        case TEXT:
+        case TEXT_FULL: printf(" ISA    "); break;
+        case MARKDOWN: printf(" ISA    |"); break;
+        default: break;
+    }
+}
+
+
+void print_isa_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->show_isa) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%s,", row.isa); break;
+        case TEXT:
+        case TEXT_FULL: printf(" %-6s ", row.isa); break;
+        case MARKDOWN: printf(" %-6s |", row.isa); break;
+        default: break;
+    }
+}
+
+
+/* --isolate: peak memory of the process of the test and how it failed */
+void print_isolate_header(lzbench_params_t *params)
+{
+    if (!params->isolate) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Max RSS in KB,Failure,"); break;
+        case TEXT:
+        case TEXT_FULL: printf(" RSS MB Failure            "); break;
+        case MARKDOWN: printf("  RSS MB | Failure            |"); break;
+        default: break;
+    }
+}
+
+
+void print_isolate_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->isolate) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%llu,%s,", (unsigned long long)row.max_rss_kb, row.failure.c_str()); break;
+        case TEXT:
+        case TEXT_FULL: printf("%7.1f %-18s ", row.max_rss_kb / 1024.0, row.failure.empty() ? "-" : row.failure.c_str()); break;
+        case MARKDOWN: printf(" %7.1f | %-18s |", row.max_rss_kb / 1024.0, row.failure.empty() ? "-" : row.failure.c_str()); break;
+        default: break;
+    }
+}
+
+
+/* --sample: 95% confidence interval of the ratio from the ratios of the sampled blocks */
+void print_sample_header(lzbench_params_t *params)
+{
+    if (!params->sample_blocks) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Ratio CI95 in %%,"); break;
+        case TEXT:
+        case TEXT_FULL: printf(" R ci%% "); break;
+        case MARKDOWN: printf(" R ci%% |"); break;
+        default: break;
+    }
+}
+
+
+void print_sample_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->sample_blocks) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%.3f,", row.counters.ratio_ci); break;
+        case TEXT:
+        case TEXT_FULL: printf("%6.2f ", row.counters.ratio_ci); break;
+        case MARKDOWN: printf(" %5.2f |", row.counters.ratio_ci); break;
+        default: break;
+    }
+}
+
+
+/* host memory of the benchmark buffers of --pinned */
+void print_host_header(lzbench_params_t *params)
+{
+    if (!params->pinned) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Host memory,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("Host       "); break;
+        case MARKDOWN: printf(" Host       |"); break;
+        default: break;
+    }
+}
+
+
+void print_host_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->pinned) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%s,", host_memory_names[row.host]); break;
+        case TEXT:
+        case TEXT_FULL: printf("%-10s ", host_memory_names[row.host]); break;
+        case MARKDOWN: printf(" %-10s |", host_memory_names[row.host]); break;
+        default: break;
+    }
+}
+
+
+/* state of the page cache when the file was read, mem = the input was in memory */
+void print_page_cache_header(lzbench_params_t *params)
+{
+    if (!params->page_cache && !params->readahead) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("Page cache,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("Cache "); break;
+        case MARKDOWN: printf(" Cache |"); break;
+        default: break;
+    }
+}
+
+
+void print_page_cache_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->page_cache && !params->readahead) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%s,", page_cache_names[row.page_cache]); break;
+        case TEXT:
+        case TEXT_FULL: printf("%-5s ", page_cache_names[row.page_cache]); break;
+        case MARKDOWN: printf(" %-5s |", page_cache_names[row.page_cache]); break;
+        default: break;
+    }
+}
+
+
+/* --iovec: MB/s of compression from contiguous input, gathered by a copy and streamed and of decompression to contiguous and scattered output, cost in % of the best scattered path */
+void print_iovec_header(lzbench_params_t *params)
+{
+    if (!params->iovec_min) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Contiguous compression speed,Gather copy compression speed,Stream compression speed,Gather cost in %%,"
+                   "Contiguous decompression speed,Scatter decompression speed,Scatter cost in %%,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C contig  C copy C stream C cost D contig D scatt D cost "); break;
+        case MARKDOWN:
+            printf(" C contig |  C copy | C stream | C cost | D contig | D scatt | D cost |"); break;
+        default: break;
+    }
+}
+
+
+void print_iovec_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->iovec_min) return;
+
+    const float *mbs = row.counters.iov_speed;
+    float ccost = mbs[0] ? 100 * (1 - (MAX(mbs[1], mbs[2])) / mbs[0]) : 0, dcost = mbs[3] ? 100 * (1 - mbs[4] / mbs[3]) : 0;
+    for (int k = 0; k < IOVEC_PATHS; k++)
+    {
+        switch (params->textformat)
+        {
+            case CSV: if (mbs[k]) printf("%.2f,", mbs[k]); else printf(","); break;
+            case TEXT:
+            case TEXT_FULL: if (mbs[k]) printf("%8.0f ", mbs[k]); else printf("%8s ", "-"); break;
+            case MARKDOWN: if (mbs[k]) printf(" %8.0f |", mbs[k]); else printf(" %8s |", "-"); break;
+            default: break;
+        }
+        if (k != 2 && k != 4) continue;
+        float cost = k == 2 ? ccost : dcost;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.2f,", cost); break;
+            case TEXT:
+            case TEXT_FULL: printf("%5.1f%% ", cost); break;
+            case MARKDOWN: printf(" %5.1f%% |", cost); break;
+            default: break;
+        }
+    }
+}
+
+
+/* --fuzz: slowest decode of a mutated chunk, its slowdown, crashes, hangs and anomalies */
+void print_fuzz_header(lzbench_params_t *params)
+{
+    if (!params->fuzz_cases) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Fuzz cases,Fuzz rejected,Fuzz worst decode in us,Fuzz worst slowdown,Fuzz crashes,Fuzz hangs,Fuzz anomalies,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  F worst  F slow Crash  Hang  Anom "); break;
+        case MARKDOWN:
+            printf("   F worst |  F slow | Crash |  Hang |  Anom |"); break;
+        default: break;
+    }
+}
+
+
+void print_fuzz_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->fuzz_cases) return;
+
+    lzbench_counters_t &c = row.counters;
+    switch (params->textformat)
+    {
+        case CSV: printf("%u,%u,%.3f,%.2f,%u,%u,%u,", c.fcases, c.frejected, c.fworst_us, c.fworst_x, c.fcrashes, c.fhangs, c.fanomalies); break;
+        case TEXT:
+        case TEXT_FULL: printf("%9.1f %6.1fx %5u %5u %5u ", c.fworst_us, c.fworst_x, c.fcrashes, c.fhangs, c.fanomalies); break;
+        case MARKDOWN: printf(" %9.1f | %6.1fx | %5u | %5u | %5u |", c.fworst_us, c.fworst_x, c.fcrashes, c.fhangs, c.fanomalies); break;
+        default: break;
+    }
+}
+
+
+/* --append: latency of appends to a long-lived stream, cost of flushes and ratio against one-shot compression */
+void print_append_header(lzbench_params_t *params)
+{
+    if (!params->append_size) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Append p50 in us,Append p99 in us,Append p99.9 in us,Flush mean in us,Flush time in %%,Append ratio,Append size in %% of one-shot,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  A p50   A p99 A p99.9 F mean F time A ratio A/1shot "); break;
+        case MARKDOWN:
+            printf("   A p50 |   A p99 | A p99.9 | F mean | F time | A ratio | A/1shot |"); break;
+        default: break;
+    }
+}
+
+
+void print_append_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->append_size) return;
+
+    for (int i=0; i<LATENCY_PERCENTILES; i++)
+    {
+        float us = row.counters.alat[i];
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,", us); break;
+            case TEXT:
+            case TEXT_FULL: printf(us < 1000 ? "%7.2f " : "%7.0f ", us); break;
+            case MARKDOWN: printf(us < 1000 ? " %7.2f |" : " %7.0f |", us); break;
+            default: break;
+        }
+    }
+    switch (params->textformat)
+    {
+        case CSV: printf("%.3f,%.2f,%.2f,%.2f,", row.counters.aflush, row.counters.aflush_pct, row.counters.aratio, row.counters.aoneshot); break;
+        case TEXT:
+        case TEXT_FULL: printf(row.counters.aflush < 1000 ? "%6.2f " : "%6.0f ", row.counters.aflush); printf("%5.1f%% %6.2f%% %6.1f%% ", row.counters.aflush_pct, row.counters.aratio, row.counters.aoneshot); break;
+        case MARKDOWN: printf(row.counters.aflush < 1000 ? " %6.2f |" : " %6.0f |", row.counters.aflush); printf(" %5.1f%% | %6.2f%% | %6.1f%% |", row.counters.aflush_pct, row.counters.aratio, row.counters.aoneshot); break;
+        default: break;
+    }
+}
+
+
+/* --trace: records per second, MB/s and latency of compression and decompression records */
+void print_trace_header(lzbench_params_t *params)
+{
+    if (params->trace.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Trace records per second,Trace compression speed,Trace decompression speed,Trace compression p50 in us,Trace compression p99 in us,Trace compression p99.9 in us,"
+                   "Trace decompression p50 in us,Trace decompression p99 in us,Trace decompression p99.9 in us,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Records/s TC MB/s TD MB/s  TC p50  TC p99 TC p99.9  TD p50  TD p99 TD p99.9 "); break;
+        case MARKDOWN:
+            printf(" Records/s | TC MB/s | TD MB/s |  TC p50 |  TC p99 | TC p99.9 |  TD p50 |  TD p99 | TD p99.9 |"); break;
+        default: break;
+    }
+}
+
+
+void print_trace_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->trace.empty()) return;
+
+    switch (params->textformat)
+    {
+        case CSV: printf("%.0f,%.2f,%.2f,", row.counters.trate, row.counters.tspeed[0], row.counters.tspeed[1]); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("%9.0f ", row.counters.trate);
+            for (int d=0; d<2; d++) printf(row.counters.tspeed[d] < 10000 ? "%7.1f " : "%7.0f ", row.counters.tspeed[d]);
+            break;
+        case MARKDOWN:
+            printf(" %9.0f |", row.counters.trate);
+            for (int d=0; d<2; d++) printf(row.counters.tspeed[d] < 10000 ? " %7.1f |" : " %7.0f |", row.counters.tspeed[d]);
+            break;
+        default: break;
+    }
+    for (int d=0; d<2; d++)
+    {
+        for (int i=0; i<LATENCY_PERCENTILES; i++)
+        {
+            float us = row.counters.tlat[d][i];
+            int width = (i == LATENCY_PERCENTILES-1) ? 8 : 7;
+            switch (params->textformat)
+            {
+                case CSV: printf("%.3f,", us); break;
+                case TEXT:
+                case TEXT_FULL: printf(us < 1000 ? "%*.2f " : "%*.0f ", width, us); break;
+                case MARKDOWN: printf(us < 1000 ? " %*.2f |" : " %*.0f |", width, us); break;
+                default: break;
+            }
+        }
+    }
+}
+
+
+/* --load: response time of requests including queueing and busy time of the workers */
+void print_load_header(lzbench_params_t *params)
+{
+    if (!(params->load_rate > 0)) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Load compression p50 in us,Load compression p99 in us,Load compression p99.9 in us,Load compression busy in %%,"
+                   "Load decompression p50 in us,Load decompression p99 in us,Load decompression p99.9 in us,Load decompression busy in %%,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" LC p50  LC p99 LC p99.9 LC busy  LD p50  LD p99 LD p99.9 LD busy "); break;
+        case MARKDOWN:
+            printf("  LC p50 |  LC p99 | LC p99.9 | LC busy |  LD p50 |  LD p99 | LD p99.9 | LD busy |"); break;
+        default: break;
+    }
+}
+
+
+void print_load_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!(params->load_rate > 0)) return;
+
+    for (int d=0; d<2; d++)
+    {
+        for (int i=0; i<LATENCY_PERCENTILES; i++)
+        {
+            float us = row.counters.llat[d][i];
+            int width = (i == LATENCY_PERCENTILES-1) ? 8 : 7;
+            switch (params->textformat)
+            {
+                case CSV: printf("%.3f,", us); break;
+                case TEXT:
+                case TEXT_FULL: printf(us < 1000 ? "%*.2f " : "%*.0f ", width, us); break;
+                case MARKDOWN: printf(us < 1000 ? " %*.2f |" : " %*.0f |", width, us); break;
+                default: break;
+            }
+        }
+        switch (params->textformat)
+        {
+            case CSV: printf("%.1f,", row.counters.lbusy[d]); break;
+            case TEXT:
+            case TEXT_FULL: printf("%6.1f%% ", row.counters.lbusy[d]); break;
+            case MARKDOWN: printf("  %5.1f%% |", row.counters.lbusy[d]); break;
+            default: break;
+        }
+    }
+}
+
+
+/* --inplace: margin of the largest chunk and MB/s of in-place decompression, "-" for decoders that can't do it */
+void print_inplace_header(lzbench_params_t *params)
+{
+    if (!params->inplace) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("In-place margin in bytes,In-place decompression speed,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" IP margin  IP MB/s "); break;
+        case MARKDOWN:
+            printf(" IP margin |  IP MB/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_inplace_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->inplace) return;
+
+    bool none = row.counters.imargin < 0;
+    unsigned long long margin = none ? 0 : row.counters.imargin;
+    switch (params->textformat)
+    {
+        case CSV:
+            if (none) printf(",,"); else printf("%llu,%.2f,", margin, row.counters.ispeed);
+            break;
+        case TEXT:
+        case TEXT_FULL:
+            if (none) printf("%10s %8s ", "-", "-"); else printf("%10llu %8.0f ", margin, row.counters.ispeed);
+            break;
+        case MARKDOWN:
+            if (none) printf(" %9s | %8s |", "-", "-"); else printf(" %9llu | %8.0f |", margin, row.counters.ispeed);
+            break;
+        default: break;
+    }
+}
+
+
+/* --dthreads: MB/s of decompression with every count of threads that share one compbuf */
+void print_shared_reads_header(lzbench_params_t *params)
+{
+    for (int k=0; k<params->dthread_counts_nb; k++)
+    {
+        std::string label;
+        format(label, "D%d MB/s", params->dthread_counts[k]);
+        switch (params->textformat)
+        {
+            case CSV: printf("Shared decompression with %d threads in MB/s,", params->dthread_counts[k]); break;
+            case TEXT:
+            case TEXT_FULL: printf("%9s ", label.c_str()); break;
+            case MARKDOWN: printf(" %9s |", label.c_str()); break;
+            default: break;
+        }
+    }
+}
+
+
+void print_shared_reads_columns(lzbench_params_t *params, string_table_t& row)
+{
+    for (int k=0; k<params->dthread_counts_nb; k++)
+    {
+        float speed = row.counters.shared_dspeed[k];
+        switch (params->textformat)
+        {
+            case CSV: printf("%.2f,", speed); break;
+            case TEXT:
+            case TEXT_FULL: printf(speed < 100 ? "%9.2f " : "%9.0f ", speed); break;
+            case MARKDOWN: printf(speed < 100 ? " %9.2f |" : " %9.0f |", speed); break;
+            default: break;
+        }
+    }
+}
+
+
+/* latency of decompression of a single random chunk and reads per second of one thread */
+void print_random_header(lzbench_params_t *params)
+{
+    if (!params->random_reads) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Random read p50 in us,Random read p99 in us,Random read p99.9 in us,Random read mean in us,Random reads per second,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  R p50   R p99 R p99.9  R mean  Reads/s "); break;
+        case MARKDOWN:
+            printf("   R p50 |   R p99 | R p99.9 |  R mean |  Reads/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_random_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->random_reads) return;
+
+    for (int i=0; i<=LATENCY_PERCENTILES; i++)
+    {
+        float us = (i < LATENCY_PERCENTILES) ? row.counters.rlat[i] : row.counters.rmean;
+        switch (params->textformat)
+        {
+            case CSV: printf("%.3f,", us); break;
+            case TEXT:
+            case TEXT_FULL: printf(us < 1000 ? "%7.2f " : "%7.0f ", us); break;
+            case MARKDOWN: printf(us < 1000 ? " %7.2f |" : " %7.0f |", us); break;
+            default: break;
+        }
+    }
+    switch (params->textformat)
+    {
+        case CSV: printf("%.0f,", row.counters.rrate); break;
+        case TEXT:
+        case TEXT_FULL: printf("%8.0f ", row.counters.rrate); break;
+        case MARKDOWN: printf(" %8.0f |", row.counters.rrate); break;
+        default: break;
+    }
+}
+
+
+/* --ttfb: time to the first bytes of output of streaming decompression, "-" for codecs without a streaming decoder */
+void print_ttfb_header(lzbench_params_t *params)
+{
+    for (size_t s=0; s<params->ttfb_sizes.size(); s++)
+    {
+        std::string size = size_label(params->ttfb_sizes[s]);
+        size.erase(size.find(' '), 1);
+        switch (params->textformat)
+        {
+            case CSV: printf("TTFB %s in us,", size.c_str()); break;
+            case TEXT:
+            case TEXT_FULL: printf("%5s TTFB ", size.c_str()); break;
+            case MARKDOWN: printf(" %5s TTFB |", size.c_str()); break;
+            default: break;
+        }
+    }
+}
+
+
+void print_ttfb_columns(lzbench_params_t *params, string_table_t& row)
+{
+    for (size_t s=0; s<params->ttfb_sizes.size(); s++)
+    {
+        float us = row.counters.ttfb_us[s];
+        switch (params->textformat)
+        {
+            case CSV: if (us) printf("%.3f", us); printf(","); break;
+            case TEXT:
+            case TEXT_FULL: if (!us) printf("%10s ", "-"); else printf(us < 1000 ? "%10.2f " : "%10.0f ", us); break;
+            case MARKDOWN: if (!us) printf(" %10s |", "-"); else printf(us < 1000 ? " %10.2f |" : " %10.0f |", us); break;
+            default: break;
+        }
+    }
+}
+
+
+/* --range-reads: p50 and p99 latency and compressed bytes fetched per byte of a range of each size, "-" for codecs without a seek table */
+void print_range_header(lzbench_params_t *params)
+{
+    if (!params->range_reads) return;
+
+    for (size_t s=0; s<params->range_sizes.size(); s++)
+    {
+        std::string size = size_label(params->range_sizes[s]);
+        size.erase(size.find(' '), 1);
+        switch (params->textformat)
+        {
+            case CSV: printf("Range %s p50 in us,Range %s p99 in us,Range %s read amplification,", size.c_str(), size.c_str(), size.c_str()); break;
+            case TEXT:
+            case TEXT_FULL: printf("%7s p50 %7s p99 %6s amp ", size.c_str(), size.c_str(), size.c_str()); break;
+            case MARKDOWN: printf(" %7s p50 | %7s p99 | %6s amp |", size.c_str(), size.c_str(), size.c_str()); break;
+            default: break;
+        }
+    }
+    switch (params->textformat)
+    {
+        case CSV: printf("Index size,Index build time in ms,"); break;
+        case TEXT:
+        case TEXT_FULL: printf("    Index  Index ms "); break;
+        case MARKDOWN: printf("    Index | Index ms |"); break;
+        default: break;
+    }
+}
+
+
+void print_range_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->range_reads) return;
+
+    for (size_t s=0; s<params->range_sizes.size(); s++)
+    {
+        bool none = row.counters.samp[s] == 0;
+        for (int i=0; i<2; i++)
+        {
+            float us = row.counters.slat[s][i];
+            switch (params->textformat)
+            {
+                case CSV: if (!none) printf("%.3f", us); printf(","); break;
+                case TEXT:
+                case TEXT_FULL: if (none) printf("%11s ", "-"); else printf(us < 1000 ? "%11.2f " : "%11.0f ", us); break;
+                case MARKDOWN: if (none) printf(" %11s |", "-"); else printf(us < 1000 ? " %11.2f |" : " %11.0f |", us); break;
+                default: break;
+            }
+        }
+        switch (params->textformat)
+        {
+            case CSV: if (!none) printf("%.2f", row.counters.samp[s]); printf(","); break;
+            case TEXT:
+            case TEXT_FULL: if (none) printf("%10s ", "-"); else printf("%9.2fx ", row.counters.samp[s]); break;
+            case MARKDOWN: if (none) printf(" %10s |", "-"); else printf(" %9.2fx |", row.counters.samp[s]); break;
+            default: break;
+        }
+    }
+    bool none = row.counters.sindex_bytes == 0;
+    std::string index = none ? "-" : size_label(row.counters.sindex_bytes);
+    float ms = row.counters.sindex_ns / 1e6;
+    switch (params->textformat)
+    {
+        case CSV: if (!none) printf("%llu,%.3f", (unsigned long long)row.counters.sindex_bytes, ms); else printf(","); printf(","); break;
+        case TEXT:
+        case TEXT_FULL: if (none) printf("%9s %9s ", "-", "-"); else printf("%9s %9.2f ", index.c_str(), ms); break;
+        case MARKDOWN: if (none) printf(" %8s | %8s |", "-", "-"); else printf(" %8s | %8.2f |", index.c_str(), ms); break;
+        default: break;
+    }
+}
+
+
+/* speed of the file to file pipeline next to the codec only speed */
+void print_pipeline_header(lzbench_params_t *params)
+{
+    if (!params->pipeline_dir) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Pipeline compression speed,Pipeline decompression speed,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Pipe C MB/s Pipe D MB/s "); break;
+        case MARKDOWN:
+            printf(" Pipe C MB/s | Pipe D MB/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_pipeline_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->pipeline_dir) return;
+
+    const char *fmt, *na;
+    switch (params->textformat)
+    {
+        case CSV: fmt = "%.2f,"; na = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt = "%11.1f "; na = "          - "; break;
+        case MARKDOWN: fmt = " %11.1f |"; na = "           - |"; break;
+        default: return;
+    }
+    if (row.counters.cpipe > 0) printf(fmt, row.counters.cpipe); else printf("%s", na);
+    if (row.counters.dpipe > 0) printf(fmt, row.counters.dpipe); else printf("%s", na);
+}
+
+
+/* speed of kernels alone and of host-device transfers alone of the pipelined CUDA codecs */
+void print_cuda_header(lzbench_params_t *params)
+{
+    if (params->cuda_streams <= 1) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Kernel compression speed,Transfer compression speed,Kernel decompression speed,Transfer decompression speed,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Kern C MB/s Xfer C MB/s Kern D MB/s Xfer D MB/s "); break;
+        case MARKDOWN:
+            printf(" Kern C MB/s | Xfer C MB/s | Kern D MB/s | Xfer D MB/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_cuda_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->cuda_streams <= 1) return;
+
+    const char *fmt, *na;
+    switch (params->textformat)
+    {
+        case CSV: fmt = "%.2f,"; na = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt = "%11.1f "; na = "          - "; break;
+        case MARKDOWN: fmt = " %11.1f |"; na = "           - |"; break;
+        default: return;
+    }
+    const lzbench_counters_t& c = row.counters;
+    uint64_t ns[4] = { c.ckernel_ns, c.ctransfer_ns, c.dkernel_ns, c.dtransfer_ns };
+    for (int k=0; k<4; k++)
+    {
+        uint64_t bytes = k < 2 ? c.cbytes : c.dbytes;
+        if (ns[k]) printf(fmt, bytes * 1000.0 / ns[k]); else printf("%s", na);
+    }
+}
+
+
+/* share of the input of nvcomp_lz4_hybrid (de)compressed by the GPU, the rest is done by lz4 on the CPU */
+void print_hybrid_header(lzbench_params_t *params)
+{
+    if (!params->hybrid) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("GPU share of compression,GPU share of decompression,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("GPU C GPU D "); break;
+        case MARKDOWN:
+            printf(" GPU C | GPU D |"); break;
+        default: break;
+    }
+}
+
+
+void print_hybrid_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->hybrid) return;
+
+    const char *fmt, *na;
+    switch (params->textformat)
+    {
+        case CSV: fmt = "%.1f,"; na = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt = "%4.0f%% "; na = "    - "; break;
+        case MARKDOWN: fmt = " %4.0f%% |"; na = "     - |"; break;
+        default: return;
+    }
+    const lzbench_counters_t& c = row.counters;
+    if (c.cgpu_bytes && c.cbytes) printf(fmt, c.cgpu_bytes * 100.0 / c.cbytes); else printf("%s", na);
+    if (c.dgpu_bytes && c.dbytes) printf(fmt, c.dgpu_bytes * 100.0 / c.dbytes); else printf("%s", na);
+}
+
+
+/* --gpus: MB/s of the slowest and of the fastest device of nvcomp_lz4_batch, the speed of the row is the aggregate */
+void print_gpus_header(lzbench_params_t *params)
+{
+    if (params->gpus <= 1) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Slowest GPU compression speed,Fastest GPU compression speed,Slowest GPU decompression speed,Fastest GPU decompression speed,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("Min GPU C Max GPU C Min GPU D Max GPU D "); break;
+        case MARKDOWN:
+            printf(" Min GPU C | Max GPU C | Min GPU D | Max GPU D |"); break;
+        default: break;
+    }
+}
+
+
+/* MB/s of a device while it had a batch in flight, 0 = no batches */
+static double gpu_speed(const lzbench_counters_t& c, int phase, int d)
+{
+    return c.gpu_ns[phase][d] ? c.gpu_bytes[phase][d] * 1000.0 / c.gpu_ns[phase][d] : 0;
+}
+
+
+void print_gpus_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (params->gpus <= 1) return;
+
+    const char *fmt, *na;
+    switch (params->textformat)
+    {
+        case CSV: fmt = "%.2f,"; na = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt = "%9.1f "; na = "        - "; break;
+        case MARKDOWN: fmt = " %9.1f |"; na = "         - |"; break;
+        default: return;
+    }
+    for (int phase=0; phase<2; phase++)
+    {
+        double slowest = 0, fastest = 0;
+        for (int d=0; d<params->gpus; d++)
+        {
+            double speed = gpu_speed(row.counters, phase, d);
+            if (speed > 0 && (slowest == 0 || speed < slowest)) slowest = speed;
+            if (speed > fastest) fastest = speed;
+        }
+        if (slowest > 0) printf(fmt, slowest); else printf("%s", na);
+        if (fastest > 0) printf(fmt, fastest); else printf("%s", na);
+    }
+}
+
+
+/* --zstd-trace: shares of the time of zstd frames of compression in match finding, literals, sequences and the rest */
+void print_zstd_trace_header(lzbench_params_t *params)
+{
+    if (!lzbench_zstd_trace) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Match finding in %%,Literals in %%,Sequences in %%,Other in %%,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" Match   Lit   Seq Other "); break;
+        case MARKDOWN:
+            printf("  Match |    Lit |    Seq |  Other |"); break;
+        default: break;
+    }
+}
+
+
+void print_zstd_trace_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!lzbench_zstd_trace) return;
+
+    const char *fmt, *na;
+    switch (params->textformat)
+    {
+        case CSV: fmt = "%.1f,"; na = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt = "%5.1f "; na = "    - "; break;
+        case MARKDOWN: fmt = " %5.1f%% |"; na = "      - |"; break;
+        default: return;
+    }
+    const uint64_t* t = row.counters.zstd_trace;
+    uint64_t stages = t[2] + t[3] + t[4];
+    for (int k=2; k<ZSTD_TRACE_COUNTERS; k++)
+        if (t[1]) printf(fmt, t[k] * 100.0 / t[1]); else printf("%s", na);
+    if (t[1]) printf(fmt, t[1] > stages ? (t[1] - stages) * 100.0 / t[1] : 0.0); else printf("%s", na);
+}
+
+
+/* package energy per GB of input and average package power of (de)compression */
+void print_energy_header(lzbench_params_t *params)
+{
+    if (!params->energy) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression energy in J/GB,Compression power in W,Decompression energy in J/GB,Decompression power in W,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf(" C J/GB    C W  D J/GB    D W "); break;
+        case MARKDOWN:
+            printf("  C J/GB |    C W |  D J/GB |    D W |"); break;
+        default: break;
+    }
+}
+
+
+void print_energy_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->energy) return;
+
+    const char *fmt_j, *fmt_w, *na_j, *na_w;
+    lzbench_counters_t &c = row.counters;
+
+    switch (params->textformat)
+    {
+        case CSV: fmt_j = fmt_w = "%.2f,"; na_j = na_w = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt_j = "%7.2f "; fmt_w = "%6.1f "; na_j = "      - "; na_w = "     - "; break;
+        case MARKDOWN: fmt_j = " %7.2f |"; fmt_w = " %6.1f |"; na_j = "       - |"; na_w = "      - |"; break;
+        default: return;
+    }
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t energy = d ? c.denergy : c.cenergy, bytes = d ? c.dbytes : c.cbytes, ns = d ? c.denergy_ns : c.cenergy_ns;
+        if (ns && bytes) printf(fmt_j, energy * 1000.0 / bytes); else printf("%s", na_j);
+        if (ns) printf(fmt_w, energy * 1000.0 / ns); else printf("%s", na_w);
+    }
+}
+
+
+/* --llc-mon: L3 occupancy at the end of passes and memory bandwidth of (de)compression */
+void print_llc_mon_header(lzbench_params_t *params)
+{
+    if (!params->llc_mon) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Compression LLC occupancy in MB,Compression DRAM bandwidth in GB/s,Decompression LLC occupancy in MB,Decompression DRAM bandwidth in GB/s,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("C LLC MB C DRAM GB/s D LLC MB D DRAM GB/s "); break;
+        case MARKDOWN:
+            printf(" C LLC MB | C DRAM GB/s | D LLC MB | D DRAM GB/s |"); break;
+        default: break;
+    }
+}
+
+
+void print_llc_mon_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->llc_mon) return;
+
+    const char *fmt_mb, *fmt_gb, *na_mb, *na_gb;
+    lzbench_counters_t &c = row.counters;
+
+    switch (params->textformat)
+    {
+        case CSV: fmt_mb = fmt_gb = "%.2f,"; na_mb = na_gb = ","; break;
+        case TEXT:
+        case TEXT_FULL: fmt_mb = "%8.2f "; fmt_gb = "%11.2f "; na_mb = "       - "; na_gb = "          - "; break;
+        case MARKDOWN: fmt_mb = " %8.2f |"; fmt_gb = " %11.2f |"; na_mb = "        - |"; na_gb = "           - |"; break;
+        default: return;
+    }
+
+    for (int d=0; d<2; d++)
+    {
+        uint64_t occupancy = d ? c.dllc_bytes : c.cllc_bytes, mbm = d ? c.dmbm_bytes : c.cmbm_bytes, ns = d ? c.dmbm_ns : c.cmbm_ns;
+        if (occupancy) printf(fmt_mb, occupancy / 1048576.0); else printf("%s", na_mb);
+        if (ns) printf(fmt_gb, (double)mbm / ns); else printf("%s", na_gb);
+    }
+}
+
+
+/* memory held by init and peak memory and allocations of (de)compression */
+void print_memory_header(lzbench_params_t *params)
+{
+    if (!params->memory) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            printf("Init memory in KB,Compression memory in KB,Compression allocations per call,Decompression memory in KB,Decompression allocations per call,"); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("  Init KB  C peak KB C allocs  D peak KB D allocs "); break;
+        case MARKDOWN:
+            printf("   Init KB |  C peak KB | C allocs |  D peak KB | D allocs |"); break;
+        default: break;
+    }
+}
+
+
+void print_memory_columns(lzbench_params_t *params, string_table_t& row)
+{
+    if (!params->memory) return;
+
+    unsigned long long init_kb = (row.memory.init_bytes + 1023) / 1024;
+    unsigned long long ckb = (row.memory.cpeak + 1023) / 1024;
+    unsigned long long dkb = (row.memory.dpeak + 1023) / 1024;
+    switch (params->textformat)
+    {
+        case CSV: printf("%llu,%llu,%.2f,%llu,%.2f,", init_kb, ckb, row.memory.callocs, dkb, row.memory.dallocs); break;
+        case TEXT:
+        case TEXT_FULL: printf("%9llu %10llu %8.1f %10llu %8.1f ", init_kb, ckb, row.memory.callocs, dkb, row.memory.dallocs); break;
+        case MARKDOWN: printf(" %9llu | %10llu | %8.1f | %10llu | %8.1f |", init_kb, ckb, row.memory.callocs, dkb, row.memory.dallocs); break;
+        default: break;
+    }
+}
+
+
+/* optional columns, printed before the filename: number of threads and per-thread speed */
+void print_extra_header(lzbench_params_t *params)
+{
+    print_block_header(params);
+    print_core_header(params);
+    print_llc_header(params);
+    print_offset_header(params);
+    print_warmup_header(params);
+    print_setup_header(params);
+    print_consume_header(params);
+    print_noise_header(params);
+    print_cpb_header(params);
+    print_msg_header(params);
+    print_bandwidth_header(params);
+    print_calibrate_header(params);
+    print_dedup_header(params);
+    print_stats_header(params);
+    print_cold_header(params);
+    print_perf_header(params);
+    print_topdown_header(params);
+    print_rusage_header(params);
+    print_latency_header(params);
+    print_memory_header(params);
+    print_energy_header(params);
+    print_llc_mon_header(params);
+    print_freq_header(params);
+    print_cgroup_header(params);
+    print_random_header(params);
+    print_shared_reads_header(params);
+    print_inplace_header(params);
+    print_range_header(params);
+    print_ttfb_header(params);
+    print_load_header(params);
+    print_trace_header(params);
+    print_append_header(params);
+    print_fuzz_header(params);
+    print_iovec_header(params);
+    print_pipeline_header(params);
+    print_cuda_header(params);
+    print_hybrid_header(params);
+    print_gpus_header(params);
+#ifndef BENCH_REMOVE_ZSTD
+    print_zstd_trace_header(params);
+#endif
+    print_pages_header(params);
+    print_host_header(params);
+    print_precheck_header(params);
+    print_page_cache_header(params);
+    print_sample_header(params);
+    print_isa_header(params);
+    print_isolate_header(params);
+    if (params->max_threads <= 1 && params->numa_mode == NUMA_DEFAULT) return;
+
+    switch (params->textformat) // the placement is shown with any -T#, also -T1
+    {
+        case CSV:
+            if (params->max_threads > 1) printf("Threads,Compression speed per thread,Decompression speed per thread,");
+            if (params->numa_mode != NUMA_DEFAULT) printf("Placement,");
+            break;
+        case TEXT:
+        case TEXT_FULL:
+            if (params->max_threads > 1) printf("Thr  C/thread  D/thread ");
+            if (params->numa_mode != NUMA_DEFAULT) printf("Placement  ");
+            break;
+        case MARKDOWN:
+            if (params->max_threads > 1) printf(" Thr |  C/thread |  D/thread |");
+            if (params->numa_mode != NUMA_DEFAULT) printf(" Placement  |");
+            break;
+        default: break;
+    }
+}
+
+
+void print_extra_header_line(lzbench_params_t *params)
+{
+    if (params->textformat != MARKDOWN) return;
+    if (params->block_sizes.size() > 1) printf(" ------- |");
+    if (params->per_core_type) printf(" ------- |");
+    if (!params->llc_ways.empty()) printf(" -------------- |");
+    if (!params->buf_offsets.empty()) printf(" ------ |");
+    if (params->warmup_passes || params->warmup_ms) printf(" -------- | -------- |");
+    if (params->setup) printf(" -------- | -------- | -------- | -------- |");
+    if (params->consumer) printf(" --------- | ------ |");
+    if (params->noise_mode) printf(" ------- | ------- | ------- |");
+    if (params->cpb_ghz) printf(" ------- | ------- |");
+    if (!params->msg_sizes.empty()) printf(" --------- | -------- | --------- | -------- | ------ |");
+    if (params->bandwidth) printf(" ------ | ------ |");
+    if (params->calibrate) printf(" ------- | ------- |");
+    if (params->dedup_size || params->long_range_block) printf(" --------- | ---------- | ---------- |");
+    if (params->stats) printf(" ------ | ------ | ------ | ------ |");
+    if (params->cold_mode != COLD_NONE) printf(" -----------| ------------|");
+    if (params->perf_counters) printf(" ------ | ----- | ------ | ------ | ------ | ------ | ----- | ------ | ------ | ------ |");
+    if (params->topdown) printf(" -------------------- | -------------------- |");
+    if (params->rusage) printf(" ------- | -------- | ------ | -------- | -------- | ------ | ------- | ------- | -------- | ------ | -------- | -------- | ------ | ------- |");
+    if (params->latency) printf(" ------- | ------- | ------- | ------- | ------- | ------- |");
+    if (params->memory) printf(" --------- | ---------- | -------- | ---------- | -------- |");
+    if (params->energy) printf(" ------- | ------ | ------- | ------ |");
+    if (params->llc_mon) printf(" -------- | ----------- | -------- | ----------- |");
+    if (params->freq_threshold > 0) printf(" ----- | ----- | ---- | ----- |");
+    if (!cgroup_stat.empty()) printf(" ---------- |");
+    if (params->random_reads) printf(" ------- | ------- | ------- | ------- | -------- |");
+    for (int k=0; k<params->dthread_counts_nb; k++) printf(" --------- |");
+    if (params->inplace) printf(" --------- | -------- |");
+    for (size_t s=0; params->range_reads && s<params->range_sizes.size(); s++) printf(" ----------- | ----------- | ---------- |");
+    if (params->range_reads) printf(" -------- | -------- |");
+    for (size_t s=0; s<params->ttfb_sizes.size(); s++) printf(" ---------- |");
+    if (params->load_rate > 0) printf(" ------- | ------- | -------- | ------- | ------- | ------- | -------- | ------- |");
+    if (!params->trace.empty()) printf(" --------- | ------- | ------- | ------- | ------- | -------- | ------- | ------- | -------- |");
+    if (params->append_size) printf(" ------- | ------- | ------- | ------ | ------ | ------- | ------- |");
+    if (params->fuzz_cases) printf(" --------- | ------- | ----- | ----- | ----- |");
+    if (params->iovec_min) printf(" -------- | ------- | -------- | ------ | -------- | ------- | ------ |");
+    if (params->pipeline_dir) printf(" ----------- | ----------- |");
+    if (params->cuda_streams > 1) printf(" ----------- | ----------- | ----------- | ----------- |");
+    if (params->gpus > 1) printf(" --------- | --------- | --------- | --------- |");
+#ifndef BENCH_REMOVE_ZSTD
+    if (lzbench_zstd_trace) printf(" ------ | ------ | ------ | ------ |");
+#endif
+    if (params->hybrid) printf(" ----- | ----- |");
+    if (params->hugepages) printf(" ----- |");
+    if (params->pinned) printf(" ---------- |");
+    if (params->precheck) printf(" ----- | ------- |");
+    if (params->page_cache || params->readahead) printf(" ----- |");
+    if (params->sample_blocks) printf(" ----- |");
+    if (params->show_isa) printf(" ------ |");
+    if (params->isolate) printf(" ------- | ------------------ |");
+    if (params->max_threads > 1) printf(" --- | --------- | --------- |");
+    if (params->numa_mode != NUMA_DEFAULT) printf(" ---------- |");
+}
+
+
+void print_extra_columns(lzbench_params_t *params, string_table_t& row)
+{
+    print_block_columns(params, row);
+    print_core_columns(params, row);
+    print_llc_columns(params, row);
+    print_offset_columns(params, row);
+    print_warmup_columns(params, row);
+    print_setup_columns(params, row);
+    print_consume_columns(params, row);
+    print_noise_columns(params, row);
+    print_cpb_columns(params, row);
+    print_msg_columns(params, row);
+    print_bandwidth_columns(params, row);
+    print_calibrate_columns(params, row);
+    print_dedup_columns(params, row);
+    print_stats_columns(params, row);
+    print_cold_columns(params, row);
+    print_perf_columns(params, row);
+    print_topdown_columns(params, row);
+    print_rusage_columns(params, row);
+    print_latency_columns(params, row);
+    print_memory_columns(params, row);
+    print_energy_columns(params, row);
+    print_llc_mon_columns(params, row);
+    print_freq_columns(params, row);
+    print_cgroup_columns(params, row);
+    print_random_columns(params, row);
+    print_shared_reads_columns(params, row);
+    print_inplace_columns(params, row);
+    print_range_columns(params, row);
+    print_ttfb_columns(params, row);
+    print_load_columns(params, row);
+    print_trace_columns(params, row);
+    print_append_columns(params, row);
+    print_fuzz_columns(params, row);
+    print_iovec_columns(params, row);
+    print_pipeline_columns(params, row);
+    print_cuda_columns(params, row);
+    print_hybrid_columns(params, row);
+    print_gpus_columns(params, row);
+#ifndef BENCH_REMOVE_ZSTD
+    print_zstd_trace_columns(params, row);
+#endif
+    print_pages_columns(params, row);
+    print_host_columns(params, row);
+    print_precheck_columns(params, row);
+    print_page_cache_columns(params, row);
+    print_sample_columns(params, row);
+    print_isa_columns(params, row);
+    print_isolate_columns(params, row);
+    if (params->max_threads <= 1 && params->numa_mode == NUMA_DEFAULT) return;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            if (params->max_threads > 1) printf("%d,%.2f,%.2f,", row.threads, row.thr_cspeed, row.thr_dspeed);
+            if (params->numa_mode != NUMA_DEFAULT) printf("%s,", numa_mode_names[row.numa_mode]);
+            break;
+        case TEXT:
+        case TEXT_FULL:
+            if (params->max_threads > 1) printf("%3d %9.1f %9.1f ", row.threads, row.thr_cspeed, row.thr_dspeed);
+            if (params->numa_mode != NUMA_DEFAULT) printf("%-10s ", numa_mode_names[row.numa_mode]);
+            break;
+        case MARKDOWN:
+            if (params->max_threads > 1) printf(" %3d | %9.1f | %9.1f |", row.threads, row.thr_cspeed, row.thr_dspeed);
+            if (params->numa_mode != NUMA_DEFAULT) printf(" %-10s |", numa_mode_names[row.numa_mode]);
+            break;
+        default: break;
+    }
+}
+
+
+#if defined(__clang__)
+    #define LZBENCH_COMPILER __VERSION__
+#elif defined(__GNUC__)
+    #define LZBENCH_COMPILER "gcc " __VERSION__
+#else
+    #define LZBENCH_COMPILER "unknown"
+#endif
+#ifndef LZBENCH_BUILD_FLAGS
+    #define LZBENCH_BUILD_FLAGS ""
+#endif
+
+void fprint_json_string(FILE* f, const char* str)
+{
+    fputc('"', f);
+    for (const unsigned char* p = (const unsigned char*)str; *p; p++)
+    {
+        if (*p == '"' || *p == '\\') fprintf(f, "\\%c", *p);
+        else if (*p < 0x20) fprintf(f, "\\u%04x", *p);
+        else fputc(*p, f);
+    }
+    fputc('"', f);
+}
+
+
+void print_json_string(const char* str)
+{
+    fprint_json_string(stdout, str);
+}
+
+
+/* NDJSON output, a record with the machine and the settings followed by one record per compressor and level */
+void print_json_header(lzbench_params_t *params)
+{
+    printf("{\"type\":\"run\",\"program\":\"" PROGNAME "\",\"version\":\"" PROGVERSION "\",\"os\":\"" PROGOS "\",\"bits\":%d,\"cpu\":", (int)(8 * sizeof(uint8_t*)));
+    print_json_string(params->cpu_brand ? params->cpu_brand : "");
+    printf(",\"compiler\":");
+    print_json_string(LZBENCH_COMPILER);
+    printf(",\"flags\":");
+    print_json_string(LZBENCH_BUILD_FLAGS);
+    printf(",\"timer\":\"%s\",\"timetype\":%d,\"chunk_size\":%llu,\"c_iters\":%u,\"d_iters\":%u,\"cmintime_ms\":%u,\"dmintime_ms\":%u,\"threads\":[",
+        params->timer_tsc ? "tsc" : "clock", params->timetype, (unsigned long long)(params->chunk_size == NO_LIMIT ? 0 : params->chunk_size), params->c_iters, params->d_iters, params->cmintime, params->dmintime);
+    for (int k=0; k<params->thread_counts_nb; k++)
+        printf("%s%d", k ? "," : "", params->thread_counts[k]);
+    printf("]");
+    if (params->load_ms > 0)
+        printf(",\"load_ms\":%.3f,\"load_threads\":%d", params->load_ms, params->load_threads);
+    if (!params->quiesce_state.empty())
+        printf(",\"quiesce\":%s", params->quiesce_state.c_str());
+    if (!params->dict.empty())
+        printf(",\"dict_size\":%llu,\"dict_samples\":%d,\"dict_train_ms\":%.3f", (unsigned long long)params->dict.size(), params->dict_samples, params->dict_ms);
+    if (params->calibrate)
+        printf(",\"calibration\":{\"basis\":\"%s\",\"memcpy_mbs\":%.2f,\"chase_ns\":%.2f,\"alu_mops\":%.2f}",
+            params->calibrate == CALIBRATE_ALU ? "alu" : "memcpy", params->cal_memcpy_mbs, params->cal_chase_ns, params->cal_alu_mops);
+    printf("}\n");
+}
+
+
+void print_json_array(const char* name, const uint64_t* values, size_t count)
+{
+    printf(",\"%s\":[", name);
+    for (size_t i=0; i<count; i++)
+        printf("%s%llu", i ? "," : "", (unsigned long long)values[i]);
+    printf("]");
+}
+
+
+void print_json_record(lzbench_params_t *params, string_table_t& row)
+{
+    std::vector<uint64_t> sizes(row.file_sizes.begin(), row.file_sizes.end());
+
+    printf("{\"type\":\"result\",\"name\":");
+    print_json_string(row.col1_algname.c_str());
+    printf(",\"compressor\":");
+    print_json_string(row.name.c_str());
+    printf(",\"library_version\":");
+    print_json_string(row.version.c_str());
+    printf(",\"level\":%d,\"file\":", row.level);
+    print_json_string(row.col6_filename.c_str());
+    print_json_array("file_sizes", sizes.data(), sizes.size());
+    printf(",\"chunk_size\":%llu,\"threads\":%d,\"orig_size\":%llu,\"compr_size\":%llu,\"ctime_ns\":%llu,\"dtime_ns\":%llu,\"decomp_error\":%s",
+        (unsigned long long)row.chunk_size, row.threads, (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize,
+        (unsigned long long)row.col2_ctime, (unsigned long long)row.col3_dtime, row.col3_dtime || row.checksum || row.unmeasured ? "false" : "true");
+    if (params->ratio_only)
+        printf(",\"ratio_only\":true,\"verified\":%s", params->ratio_only > 1 && row.unmeasured ? "true" : "false");
+    print_json_array("ctime_samples_ns", row.csamples.data(), row.csamples.size());
+    print_json_array("dtime_samples_ns", row.dsamples.data(), row.dsamples.size());
+    if (params->max_threads > 1)
+        printf(",\"thr_cspeed\":%.2f,\"thr_dspeed\":%.2f", row.thr_cspeed, row.thr_dspeed);
+    if (params->max_threads > 1 || params->numa_mode != NUMA_DEFAULT)
+        printf(",\"placement\":\"%s\"", numa_mode_names[row.numa_mode]);
+    if (params->stats)
+        printf(",\"cstddev_pct\":%.3f,\"cci95_pct\":%.3f,\"dstddev_pct\":%.3f,\"dci95_pct\":%.3f", row.cstddev, row.cci, row.dstddev, row.dci);
+    if (params->cold_mode != COLD_NONE)
+        printf(",\"cold_ctime_ns\":%llu,\"cold_dtime_ns\":%llu", (unsigned long long)row.cold_ctime, (unsigned long long)row.cold_dtime);
+    if (params->latency)
+        printf(",\"clat_us\":[%.3f,%.3f,%.3f],\"dlat_us\":[%.3f,%.3f,%.3f]", row.clat[0], row.clat[1], row.clat[2], row.dlat[0], row.dlat[1], row.dlat[2]);
+    if (params->memory)
+        printf(",\"init_bytes\":%llu,\"cpeak_bytes\":%llu,\"dpeak_bytes\":%llu,\"callocs\":%.2f,\"dallocs\":%.2f", (unsigned long long)row.memory.init_bytes,
+            (unsigned long long)row.memory.cpeak, (unsigned long long)row.memory.dpeak, row.memory.callocs, row.memory.dallocs);
+    if (params->perf_counters)
+    {
+        printf(",\"perf_cbytes\":%llu,\"perf_dbytes\":%llu", (unsigned long long)row.counters.cbytes, (unsigned long long)row.counters.dbytes);
+        print_json_array("perf_cvalues", row.counters.cvalues, PERF_COUNTERS); // UINT64_MAX = unavailable
+        print_json_array("perf_dvalues", row.counters.dvalues, PERF_COUNTERS);
+    }
+    if (params->topdown)
+        for (int d=0; d<2; d++)
+        {
+            double pct[5];
+            if (topdown_shares(d ? row.counters.dtopdown : row.counters.ctopdown, pct))
+                printf(",\"%stopdown\":{\"frontend\":%.2f,\"bad_speculation\":%.2f,\"memory_bound\":%.2f,\"core_bound\":%.2f,\"retiring\":%.2f}",
+                    d ? "d" : "c", pct[0], pct[1], pct[2], pct[3], pct[4]);
+        }
+    if (params->rusage)
+        for (int d=0; d<2; d++)
+            printf(",\"%srusage\":{\"user_ns\":%llu,\"sys_ns\":%llu,\"wall_ns\":%llu,\"passes\":%llu,\"minflt\":%llu,\"majflt\":%llu,\"nvcsw\":%llu,\"nivcsw\":%llu}", d ? "d" : "c",
+                (unsigned long long)row.counters.ru_user_ns[d], (unsigned long long)row.counters.ru_sys_ns[d], (unsigned long long)row.counters.ru_wall_ns[d],
+                (unsigned long long)row.counters.ru_passes[d], (unsigned long long)row.counters.ru_minflt[d], (unsigned long long)row.counters.ru_majflt[d],
+                (unsigned long long)row.counters.ru_nvcsw[d], (unsigned long long)row.counters.ru_nivcsw[d]);
+    if (params->energy && row.counters.cenergy_ns)
+        printf(",\"cenergy_uj\":%llu,\"cenergy_ns\":%llu,\"cenergy_bytes\":%llu,\"denergy_uj\":%llu,\"denergy_ns\":%llu,\"denergy_bytes\":%llu",
+            (unsigned long long)row.counters.cenergy, (unsigned long long)row.counters.cenergy_ns, (unsigned long long)row.counters.cbytes,
+            (unsigned long long)row.counters.denergy, (unsigned long long)row.counters.denergy_ns, (unsigned long long)row.counters.dbytes);
+    if (params->llc_mon)
+        for (int d=0; d<2; d++)
+        {
+            uint64_t occupancy = d ? row.counters.dllc_bytes : row.counters.cllc_bytes, ns = d ? row.counters.dmbm_ns : row.counters.cmbm_ns;
+            if (occupancy) printf(",\"%sllc_bytes\":%llu", d ? "d" : "c", (unsigned long long)occupancy);
+            if (ns) printf(",\"%smbm_bytes\":%llu,\"%smbm_ns\":%llu", d ? "d" : "c", (unsigned long long)(d ? row.counters.dmbm_bytes : row.counters.cmbm_bytes),
+                d ? "d" : "c", (unsigned long long)ns);
+        }
+    if (params->freq_threshold > 0)
+        printf(",\"cfreq_mhz\":[%.0f,%.0f,%.0f],\"dfreq_mhz\":[%.0f,%.0f,%.0f],\"throttle\":%llu", // min, avg, max
+            row.counters.cfreq.min, row.counters.cfreq.count ? row.counters.cfreq.sum / row.counters.cfreq.count : 0, row.counters.cfreq.max,
+            row.counters.dfreq.min, row.counters.dfreq.count ? row.counters.dfreq.sum / row.counters.dfreq.count : 0, row.counters.dfreq.max,
+            (unsigned long long)row.counters.throttle);
+    if (params->range_reads && row.counters.samp[0] + row.counters.samp[params->range_sizes.size() - 1] > 0)
+        for (size_t s=0; s<params->range_sizes.size(); s++)
+            printf("%s{\"size\":%llu,\"p50_us\":%.3f,\"p99_us\":%.3f,\"compressed_per_byte\":%.3f,\"decompressed_per_byte\":%.3f}%s", s ? "," : ",\"range_reads\":[",
+                (unsigned long long)params->range_sizes[s], row.counters.slat[s][0], row.counters.slat[s][1], row.counters.samp[s], row.counters.sdecoded[s], s + 1 < params->range_sizes.size() ? "" : "]");
+    if (params->range_reads && row.counters.sindex_bytes)
+        printf(",\"range_index_bytes\":%llu,\"range_index_build_ns\":%llu", (unsigned long long)row.counters.sindex_bytes, (unsigned long long)row.counters.sindex_ns);
+    if (row.counters.xcount)
+        printf(",\"xz_blocks\":%u", row.counters.xblocks);
+    for (uint32_t i=0; i<row.counters.xcount; i++)
+        printf("%s{\"threads\":%u,\"dspeed\":%.2f}%s", i ? "," : ",\"xz_dscaling\":[", row.counters.xthreads[i], row.counters.xdspeed[i], i + 1 < row.counters.xcount ? "" : "]");
+    if (row.counters.delta_plain)
+        printf(",\"delta_ref_size\":%llu,\"delta_plain_size\":%llu,\"delta_plain_cspeed\":%.2f,\"delta_plain_dspeed\":%.2f", (unsigned long long)params->delta_ref.size(),
+            (unsigned long long)row.counters.delta_plain, row.counters.delta_cspeed, row.counters.delta_dspeed);
+    if (row.counters.ilv_dspeed > 0)
+        printf(",\"interleaved_dspeed\":%.2f,\"sequential_dspeed\":%.2f", row.counters.ilv_dspeed, row.counters.ilv_seq_dspeed);
+    if (row.counters.tc_fused_ns)
+    {
+        printf(",\"transcode\":{\"source\":"), fprint_json_string(stdout, params->transcode.c_str());
+        printf(",\"decompress_ns\":%llu,\"compress_ns\":%llu,\"fused_ns\":%llu,\"threads\":%d,\"threads_ns\":%llu,\"threads_cpu_ns\":%llu}",
+            (unsigned long long)row.counters.tc_dns, (unsigned long long)row.counters.tc_cns, (unsigned long long)row.counters.tc_fused_ns, row.counters.tc_threads,
+            (unsigned long long)row.counters.tc_mt_ns, (unsigned long long)row.counters.tc_mt_cpu_ns);
+    }
+    if (row.counters.zpages)
+    {
+        printf(",\"zram\":{\"page_size\":%llu,\"pages\":%llu,\"zero_pages\":%llu,\"same_pages\":%llu,\"huge_pages\":%llu,\"stored_bytes\":%llu,"
+            "\"store_ns\":%llu,\"load_ns\":%llu", (unsigned long long)params->zram_page, (unsigned long long)row.counters.zpages, (unsigned long long)row.counters.zzero,
+            (unsigned long long)row.counters.zsame, (unsigned long long)row.counters.zhuge, (unsigned long long)row.counters.zbytes,
+            (unsigned long long)row.counters.zstore_ns, (unsigned long long)row.counters.zload_ns);
+        print_json_array("size_classes", row.counters.zsizes, ZRAM_CLASSES);
+        printf("}");
+    }
+    if (row.counters.rot_inputs)
+        printf(",\"rotate\":{\"inputs\":%u,\"bytes\":%llu,\"one_cns\":%llu,\"one_dns\":%llu,\"cns\":%llu,\"dns\":%llu}", row.counters.rot_inputs,
+            (unsigned long long)row.counters.rot_bytes, (unsigned long long)row.counters.rot_cns[0], (unsigned long long)row.counters.rot_dns[0],
+            (unsigned long long)row.counters.rot_cns[1], (unsigned long long)row.counters.rot_dns[1]);
+    if (row.counters.sb_calls)
+        printf(",\"sandbox\":{\"mode\":\"%s\",\"calls\":%u,\"process_ns\":%llu,\"per_call_ns\":%llu,\"one_call_ns\":%llu,\"process_us\":[%.3f,%.3f,%.3f],"
+            "\"sandbox_us\":[%.3f,%.3f,%.3f]}", params->sandbox == SANDBOX_STRICT ? "strict" : "filter", row.counters.sb_calls,
+            (unsigned long long)row.counters.sb_ns[0], (unsigned long long)row.counters.sb_ns[1], (unsigned long long)row.counters.sb_ns[2],
+            row.counters.sb_lat[0][0], row.counters.sb_lat[0][1], row.counters.sb_lat[0][2], row.counters.sb_lat[1][0], row.counters.sb_lat[1][1], row.counters.sb_lat[1][2]);
+    if (row.counters.ss_blocks)
+        printf(",\"sstable\":{\"block_size\":%zu,\"restart_interval\":%u,\"blocks\":%u,\"records\":%llu,\"file_bytes\":%llu,\"index_bytes\":%llu,"
+            "\"restart_bytes\":%llu,\"build_ns\":%llu,\"lookup_us\":[%.3f,%.3f,%.3f],\"lookups_per_s\":%.0f,\"scan_records\":%u,\"scan_mbs\":%.2f,"
+            "\"scan_blocks\":%.3f}", params->sstable_block, params->sstable_restart, row.counters.ss_blocks, (unsigned long long)row.counters.ss_records,
+            (unsigned long long)row.counters.ss_file_bytes, (unsigned long long)row.counters.ss_index_bytes, (unsigned long long)row.counters.ss_restart_bytes,
+            (unsigned long long)row.counters.ss_build_ns, row.counters.ss_lat[0], row.counters.ss_lat[1], row.counters.ss_lat[2], row.counters.ss_rate,
+            params->sstable_scan, row.counters.ss_scan_mbs, row.counters.ss_scan_blocks);
+    if (row.counters.sp_blocks)
+        printf(",\"spsc\":{\"depth\":%d,\"blocks\":%u,\"slot\":%u,\"bytes\":%llu,\"decoder_cpu\":%d,\"consumer_cpu\":%d,\"pipelined_ns\":%llu,\"decode_ns\":%llu,"
+            "\"serial_ns\":%llu,\"consume_local_ns\":%llu,\"consume_remote_ns\":%llu,\"full\":%llu,\"empty\":%llu}", params->spsc_depth, row.counters.sp_blocks, row.counters.sp_slot,
+            (unsigned long long)row.counters.sp_bytes, row.counters.sp_cpus[0], row.counters.sp_cpus[1], (unsigned long long)row.counters.sp_ns,
+            (unsigned long long)row.counters.sp_decode_ns, (unsigned long long)row.counters.sp_serial_ns, (unsigned long long)row.counters.sp_local_ns,
+            (unsigned long long)row.counters.sp_remote_ns, (unsigned long long)row.counters.sp_full, (unsigned long long)row.counters.sp_empty);
+    if (row.counters.kio_cns)
+        printf(",\"kernel_io_cns\":%llu,\"kernel_io_dns\":%llu", (unsigned long long)row.counters.kio_cns, (unsigned long long)row.counters.kio_dns);
+    for (uint32_t c = 0; c < row.counters.pl_count; c++)
+        printf("%s{\"in_node\":%d,\"comp_node\":%d,\"decomp_node\":%d,\"cspeed\":%.2f,\"dspeed\":%.2f,\"dchunk_us\":%.3f}%s", c ? "," : ",\"placements\":[",
+            params->placements[c*3], params->placements[c*3 + 1], params->placements[c*3 + 2], row.counters.pl_cspeed[c], row.counters.pl_dspeed[c],
+            row.counters.pl_dchunk_us[c], c + 1 < row.counters.pl_count ? "" : "]");
+    if (row.counters.mt_plain)
+        printf(",\"single_thread_size\":%llu,\"single_thread_compress_ms\":%.3f,\"single_thread_decompress_ms\":%.3f", (unsigned long long)row.counters.mt_plain,
+            row.counters.mt_plain_cms, row.counters.mt_plain_dms);
+    if (row.counters.filter_plain)
+        printf(",\"unfiltered_size\":%llu,\"filter_speed\":%.2f,\"filter_inverse_speed\":%.2f", (unsigned long long)row.counters.filter_plain,
+            row.counters.filter_fspeed, row.counters.filter_ispeed);
+    if (row.counters.dprepare_ms > 0)
+        printf(",\"dict_prepare_ms\":%.3f,\"dict_call_us\":%.3f", row.counters.dprepare_ms, row.counters.dcall_us);
+    if (params->inplace && row.counters.imargin >= 0)
+        printf(",\"inplace_margin\":%llu,\"inplace_dspeed\":%.2f", (unsigned long long)row.counters.imargin, row.counters.ispeed);
+    else if (params->inplace)
+        printf(",\"inplace_margin\":null,\"inplace_dspeed\":null");
+    for (int k=0; k<params->dthread_counts_nb; k++)
+        printf("%s{\"threads\":%d,\"dspeed\":%.2f}%s", k ? "," : ",\"shared_decompression\":[", params->dthread_counts[k], row.counters.shared_dspeed[k], k + 1 < params->dthread_counts_nb ? "" : "]");
+    if (row.counters.lz_parsed)
+    {
+        printf(",\"lz_literals_pct\":%.2f,\"lz_matches\":%llu,\"lz_mean_match_len\":%.2f,\"lz_repeats_pct\":%.2f", row.counters.lz_literals,
+            (unsigned long long)row.counters.lz_matches, row.counters.lz_mean_len, row.counters.lz_repeats);
+        for (int b=0; b<LZ_STAT_BUCKETS; b++)
+            printf("%s{\"len\":\"%s\",\"pct\":%.2f}%s", b ? "," : ",\"lz_match_lengths\":[", lz_len_labels[b], row.counters.lz_len[b], b + 1 < LZ_STAT_BUCKETS ? "" : "]");
+        for (int b=0; b<LZ_STAT_BUCKETS; b++)
+            printf("%s{\"offset\":\"%s\",\"pct\":%.2f}%s", b ? "," : ",\"lz_offsets\":[", lz_off_labels[b], row.counters.lz_off[b], b + 1 < LZ_STAT_BUCKETS ? "" : "]");
+    }
+    if (params->random_reads)
+        printf(",\"random_read_us\":[%.3f,%.3f,%.3f],\"random_read_mean_us\":%.3f,\"random_reads_per_s\":%.0f", row.counters.rlat[0], row.counters.rlat[1], row.counters.rlat[2],
+            row.counters.rmean, row.counters.rrate);
+    if (params->load_rate > 0)
+        printf(",\"load_c_us\":[%.3f,%.3f,%.3f],\"load_d_us\":[%.3f,%.3f,%.3f],\"load_cbusy_pct\":%.1f,\"load_dbusy_pct\":%.1f",
+            row.counters.llat[0][0], row.counters.llat[0][1], row.counters.llat[0][2], row.counters.llat[1][0], row.counters.llat[1][1], row.counters.llat[1][2],
+            row.counters.lbusy[0], row.counters.lbusy[1]);
+    if (!params->trace.empty())
+        printf(",\"trace_records_per_s\":%.0f,\"trace_cspeed\":%.2f,\"trace_dspeed\":%.2f,\"trace_c_us\":[%.3f,%.3f,%.3f],\"trace_d_us\":[%.3f,%.3f,%.3f]",
+            row.counters.trate, row.counters.tspeed[0], row.counters.tspeed[1], row.counters.tlat[0][0], row.counters.tlat[0][1], row.counters.tlat[0][2],
+            row.counters.tlat[1][0], row.counters.tlat[1][1], row.counters.tlat[1][2]);
+    if (params->iovec_min)
+    {
+        static const char* keys[IOVEC_PATHS] = { "iovec_contig_cspeed", "iovec_copy_cspeed", "iovec_stream_cspeed", "iovec_contig_dspeed", "iovec_scatter_dspeed" };
+        for (int k = 0; k < IOVEC_PATHS; k++)
+            if (row.counters.iov_speed[k]) printf(",\"%s\":%.2f", keys[k], row.counters.iov_speed[k]); else printf(",\"%s\":null", keys[k]);
+    }
+    if (params->append_size)
+        printf(",\"append_us\":[%.3f,%.3f,%.3f],\"flush_mean_us\":%.3f,\"flush_time_pct\":%.2f,\"append_ratio\":%.2f,\"append_oneshot_pct\":%.2f",
+            row.counters.alat[0], row.counters.alat[1], row.counters.alat[2], row.counters.aflush, row.counters.aflush_pct, row.counters.aratio, row.counters.aoneshot);
+    if (params->fuzz_cases)
+        printf(",\"fuzz_cases\":%u,\"fuzz_rejected\":%u,\"fuzz_worst_us\":%.3f,\"fuzz_worst_x\":%.2f,\"fuzz_crashes\":%u,\"fuzz_hangs\":%u,\"fuzz_anomalies\":%u",
+            row.counters.fcases, row.counters.frejected, row.counters.fworst_us, row.counters.fworst_x, row.counters.fcrashes, row.counters.fhangs, row.counters.fanomalies);
+    if (params->pipeline_dir)
+        printf(",\"pipeline_cspeed\":%.2f,\"pipeline_dspeed\":%.2f", row.counters.cpipe, row.counters.dpipe);
+    if (params->cuda_streams > 1)
+        printf(",\"ckernel_ns\":%llu,\"ctransfer_ns\":%llu,\"dkernel_ns\":%llu,\"dtransfer_ns\":%llu",
+            (unsigned long long)row.counters.ckernel_ns, (unsigned long long)row.counters.ctransfer_ns,
+            (unsigned long long)row.counters.dkernel_ns, (unsigned long long)row.counters.dtransfer_ns);
+    if (row.counters.cuda_alloc_ns || row.counters.cuda_metadata_ns || row.counters.cuda_pool_hits)
+        printf(",\"cuda_alloc_ms\":%.3f,\"cuda_pool_hits\":%llu,\"cuda_metadata_ms\":%.3f", row.counters.cuda_alloc_ns / 1e6,
+            (unsigned long long)row.counters.cuda_pool_hits, row.counters.cuda_metadata_ns / 1e6);
+    if (params->gpus > 1)
+        for (int phase=0; phase<2; phase++)
+        {
+            printf(",\"%s\":[", phase ? "gpu_dspeed" : "gpu_cspeed");
+            for (int d=0; d<params->gpus; d++)
+                printf("%s%.2f", d ? "," : "", gpu_speed(row.counters, phase, d));
+            printf("]");
+        }
+#ifndef BENCH_REMOVE_ZSTD
+    if (lzbench_zstd_trace && row.counters.zstd_trace[0])
+        printf(",\"zstd_frames\":%llu,\"zstd_frame_ns\":%llu,\"zstd_match_ns\":%llu,\"zstd_literals_ns\":%llu,\"zstd_sequences_ns\":%llu",
+            (unsigned long long)row.counters.zstd_trace[0], (unsigned long long)row.counters.zstd_trace[1], (unsigned long long)row.counters.zstd_trace[2],
+            (unsigned long long)row.counters.zstd_trace[3], (unsigned long long)row.counters.zstd_trace[4]);
+#endif
+    if (params->dedup_size || params->long_range_block)
+    {
+        float ratio, cspeed, dspeed;
+        dedup_effective(params, row, ratio, cspeed, dspeed);
+        printf(",\"effective_ratio\":%.2f,\"effective_cspeed\":%.2f,\"effective_dspeed\":%.2f", ratio, cspeed, dspeed);
+    }
+    if (params->hybrid)
+        printf(",\"cgpu_bytes\":%llu,\"dgpu_bytes\":%llu", (unsigned long long)row.counters.cgpu_bytes, (unsigned long long)row.counters.dgpu_bytes);
+    if (params->hugepages)
+        printf(",\"pages\":\"%s\"", huge_page_names[row.pages]);
+    if (params->pinned)
+        printf(",\"host_memory\":\"%s\"", host_memory_names[row.host]);
+    if (params->precheck && row.precheck)
+        printf(",\"precheck_chunks\":%llu,\"precheck_skipped\":%llu,\"precheck_speedup\":%.3f",
+            (unsigned long long)row.counters.cchunks, (unsigned long long)row.counters.cskipped, row.precheck_speedup);
+    if (params->page_cache || params->readahead)
+        printf(",\"page_cache\":\"%s\",\"readahead\":\"%s\"", page_cache_names[row.page_cache], readahead_names[params->readahead]);
+    printf(",\"isa\":\"%s\"", row.isa);
+    if (params->sample_blocks)
+        printf(",\"block_ratio_mean\":%.3f,\"block_ratio_ci95\":%.3f", row.counters.ratio_mean, row.counters.ratio_ci);
+    if (params->per_core_type && row.core_type >= 0)
+        printf(",\"core_type\":\"%s\",\"core_type_cpus\":%d", core_types[row.core_type].name.c_str(), (int)core_types[row.core_type].cpus.size());
+    if (!cgroup_stat.empty())
+        printf(",\"cgroup_cpus\":%.2f,\"throttled_periods\":%llu,\"throttled_ms\":%.1f", cgroup_cpus, (unsigned long long)row.counters.cg_throttled, row.counters.cg_throttled_ms);
+    if (!params->buf_offsets.empty())
+        printf(",\"buf_offset\":%zu", row.buf_offset);
+    if (!params->llc_ways.empty())
+        printf(",\"llc_ways\":%d,\"llc_total_ways\":%d,\"llc_bytes\":%llu", row.llc_ways ? row.llc_ways : llc_total_ways, llc_total_ways,
+            (unsigned long long)(llc_total_ways ? llc_bytes * (row.llc_ways ? row.llc_ways : llc_total_ways) / llc_total_ways : 0));
+    if (!params->ttfb_sizes.empty())
+    {
+        printf(",\"ttfb_us\":{");
+        for (size_t k=0; k<params->ttfb_sizes.size(); k++)
+            if (row.counters.ttfb_us[k]) printf("%s\"%llu\":%.3f", k ? "," : "", (unsigned long long)params->ttfb_sizes[k], row.counters.ttfb_us[k]);
+            else printf("%s\"%llu\":null", k ? "," : "", (unsigned long long)params->ttfb_sizes[k]);
+        printf("}");
+    }
+    if (params->consumer)
+        printf(",\"consume\":\"%s\",\"unfused_dtime_ns\":%llu", params->consume_name, (unsigned long long)row.counters.dunfused_ns);
+    if (params->noise_mode)
+        printf(",\"noise\":\"%s\",\"noise_threads\":%d,\"noise_cslowdown\":%.3f,\"noise_dslowdown\":%.3f,\"noise_gbs\":%.2f",
+            noise_names[params->noise_mode], params->noise_threads, row.counters.nslow[0], row.counters.nslow[1], row.counters.ngbs);
+    if (params->setup)
+        printf(",\"init_us\":%.3f,\"deinit_us\":%.3f,\"first_c_us\":%.3f,\"first_d_us\":%.3f,\"cold_init_us\":%.3f,\"cold_first_c_us\":%.3f,\"cold_first_d_us\":%.3f",
+            row.counters.sinit_us, row.counters.sdeinit_us, row.counters.sfirst_us[0], row.counters.sfirst_us[1], row.counters.scold_us[0], row.counters.scold_us[1], row.counters.scold_us[2]);
+    if (params->warmup_passes || params->warmup_ms)
+        printf(",\"first_ctime_ns\":%llu,\"first_dtime_ns\":%llu", (unsigned long long)row.counters.cfirst_ns, (unsigned long long)row.counters.dfirst_ns);
+    if (params->isolate)
+    {
+        printf(",\"max_rss_kb\":%llu,\"failure\":", (unsigned long long)row.max_rss_kb);
+        print_json_string(row.failure.c_str());
+    }
+    if (params->cpb_ghz)
+        printf(",\"cpb_ghz\":%.4f", params->cpb_ghz);
+    if (row.messages)
+        printf(",\"messages\":%llu", (unsigned long long)row.messages);
+    printf("}\n");
+}
+
+
+void print_header(lzbench_params_t *params)
+{
+    switch (params->textformat)
+    {
+        case CSV:
+            if (params->show_speed)
+                printf("Compressor name,Compression speed,Decompression speed,Original size,Compressed size,Ratio,");
+            else
+                printf("Compressor name,Compression time in us,Decompression time in us,Original size,Compressed size,Ratio,");
+            print_extra_header(params);
+            printf("Filename\n");
+            break;
+        case TURBOBENCH:
+            printf("  Compressed  Ratio   Cspeed   Dspeed         Compressor name Filename\n"); break;
+        case TEXT:
+            printf("Compressor name         Compress. Decompress. Compr. size  Ratio ");
+            print_extra_header(params);
+            printf("Filename\n"); break;
+        case TEXT_FULL:
+            printf("Compressor name         Compress. Decompress.  Orig. size  Compr. size  Ratio ");
+            print_extra_header(params);
+            printf("Filename\n"); break;
+        case MARKDOWN:
+            printf("| Compressor name         | Compression| Decompress.| Compr. size | Ratio |");
+            print_extra_header(params);
+            printf(" Filename |\n");
+            printf("| ---------------         | -----------| -----------| ----------- | ----- |");
+            print_extra_header_line(params);
+            printf(" -------- |\n");
+            break;
+        case MARKDOWN2:
+            printf("| Compressor name         | Ratio | Compression| Decompress.|\n");
+            printf("| ---------------         | ------| -----------| ---------- |\n");
+            break;
+        case JSON:
+            print_json_header(params); break;
+    }
+}
+
+
+void print_speed(lzbench_params_t *params, string_table_t& row)
+{
+    float cspeed, dspeed, ratio;
+    cspeed = (!row.col2_ctime) ? 0 : (row.col5_origsize * 1000.0 / row.col2_ctime); // 0 = not compressed, --decompress-only of a file
+    dspeed = (!row.col3_dtime) ? 0 : (row.col5_origsize * 1000.0 / row.col3_dtime);
+    ratio = row.col4_comprsize * 100.0 / row.col5_origsize;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            if (row.unmeasured)
+                printf("%s,,,%llu,%llu,%.2f,", row.col1_algname.c_str(), (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            else
+                printf("%s,%.2f,%.2f,%llu,%llu,%.2f,", row.col1_algname.c_str(), cspeed, dspeed, (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf("%s\n", row.col6_filename.c_str()); break;
+        case TURBOBENCH:
+            printf("%12llu %6.1f%9.2f%9.2f  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, cspeed, dspeed, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("%-23s", row.col1_algname.c_str());
+            if (!cspeed) printf("     - MB/s");
+            else if (cspeed < 10) printf("%6.2f MB/s", cspeed);
+            else if (cspeed < 100) printf("%6.1f MB/s", cspeed);
+            else printf("%6d MB/s", (int)cspeed);
+            if (row.checksum || row.unmeasured)
+                printf("     - MB/s");
+            else if (!dspeed)
+                printf("      ERROR");
+            else
+                if (dspeed < 10) printf("%6.2f MB/s", dspeed);
+                else if (dspeed < 100) printf("%6.1f MB/s", dspeed);
+                else printf("%6d MB/s", (int)dspeed);
+            if (params->textformat == TEXT_FULL)
+                printf("%12llu %12llu %6.2f ", (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            else
+                printf("%12llu %6.2f ", (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf("%s\n", row.col6_filename.c_str());
+            break;
+        case MARKDOWN:
+            printf("| %-23s ", row.col1_algname.c_str());
+            if (!cspeed) printf("|     - MB/s ");
+            else if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
+            else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
+            else printf("|%6d MB/s ", (int)cspeed);
+            if (row.checksum || row.unmeasured)
+                printf("|     - MB/s ");
+            else if (!dspeed)
+                printf("|      ERROR ");
+            else
+                if (dspeed < 10) printf("|%6.2f MB/s ", dspeed);
+                else if (dspeed < 100) printf("|%6.1f MB/s ", dspeed);
+                else printf("|%6d MB/s ", (int)dspeed);
+            printf("|%12llu |%6.2f |", (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf(" %-s|\n", row.col6_filename.c_str());
+            break;
+        case MARKDOWN2:
+            ratio = 1.0*row.col5_origsize / row.col4_comprsize;
+            printf("| %-23s |%6.3f ", row.col1_algname.c_str(), ratio);
+            if (!cspeed) printf("|     - MB/s ");
+            else if (cspeed < 10) printf("|%6.2f MB/s ", cspeed);
+            else if (cspeed < 100) printf("|%6.1f MB/s ", cspeed);
+            else printf("|%6d MB/s ", (int)cspeed);
+            if (row.checksum || row.unmeasured)
+                printf("|     - MB/s ");
+            else if (!dspeed)
+                printf("|      ERROR ");
+            else
+                if (dspeed < 10) printf("|%6.2f MB/s ", dspeed);
+                else if (dspeed < 100) printf("|%6.1f MB/s ", dspeed);
+                else printf("|%6d MB/s ", (int)dspeed);
+            printf("|\n");
+            break;
+        case JSON:
+            print_json_record(params, row); break;
+    }
+}
+
+
+void print_time(lzbench_params_t *params, string_table_t& row)
+{
+    float ratio = row.col4_comprsize * 100.0 / row.col5_origsize;
+    uint64_t ctime = row.col2_ctime / 1000;
+    uint64_t dtime = row.col3_dtime / 1000;
+
+    switch (params->textformat)
+    {
+        case CSV:
+            if (row.unmeasured)
+                printf("%s,,,%llu,%llu,%.2f,", row.col1_algname.c_str(), (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            else
+                printf("%s,%llu,%llu,%llu,%llu,%.2f,", row.col1_algname.c_str(), (unsigned long long)ctime, (unsigned long long)dtime,  (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf("%s\n", row.col6_filename.c_str()); break;
+        case TURBOBENCH:
+            printf("%12llu %6.1f%9llu%9llu  %22s %s\n", (unsigned long long)row.col4_comprsize, ratio, (unsigned long long)ctime, (unsigned long long)dtime, row.col1_algname.c_str(), row.col6_filename.c_str()); break;
+        case TEXT:
+        case TEXT_FULL:
+            printf("%-23s", row.col1_algname.c_str());
+            if (row.unmeasured)
+                printf("       - us");
+            else
+                printf("%8llu us", (unsigned long long)ctime);
+            if (row.checksum || row.unmeasured)
+                printf("       - us");
+            else if (!dtime)
+                printf("      ERROR");
+            else
+                printf("%8llu us", (unsigned long long)dtime);
+            if (params->textformat == TEXT_FULL)
+                printf("%12llu %12llu %6.2f ", (unsigned long long) row.col5_origsize, (unsigned long long)row.col4_comprsize, ratio);
+            else
+                printf("%12llu %6.2f ", (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf("%s\n", row.col6_filename.c_str());
+            break;
+        case MARKDOWN:
+        case MARKDOWN2:
+            printf("| %-23s ", row.col1_algname.c_str());
+            if (row.unmeasured)
+                printf("|       - us ");
+            else
+                printf("|%8llu us ", (unsigned long long)ctime);
+            if (row.unmeasured)
+                printf("|       - us ");
+            else if (!dtime)
+                printf("|      ERROR ");
+            else
+                printf("|%8llu us ", (unsigned long long)dtime);
+            printf("|%12llu |%6.2f |", (unsigned long long)row.col4_comprsize, ratio);
+            print_extra_columns(params, row);
+            printf(" %-s|\n", row.col6_filename.c_str());
+            break;
+        case JSON:
+            print_json_record(params, row); break;
+    }
+}
+
+
+/* remove slow outliers (more than 3 scaled MADs above the median) from sorted times, interference never makes a pass faster */
+void reject_outliers(std::vector<uint64_t> &times)
+{
+    if (times.size() < 3) return;
+    uint64_t median = times[times.size()/2];
+    std::vector<uint64_t> dev(times.size());
+    for (size_t i=0; i<times.size(); i++)
+        dev[i] = (times[i] > median) ? times[i] - median : median - times[i];
+    std::nth_element(dev.begin(), dev.begin() + dev.size()/2, dev.end());
+    double limit = median + 3 * 1.4826 * dev[dev.size()/2];
+    while (times.size() > 1 && times.back() > limit) times.pop_back();
+}
+
+
+/* mean, standard deviation and half-width of 95% confidence interval of the mean after rejection of outliers */
+void get_sample_stats(std::vector<uint64_t> times, size_t &n, double &mean, double &stddev, double &ci)
+{
+    static const double t95[30] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+                                    2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    std::sort(times.begin(), times.end());
+    reject_outliers(times);
+    n = times.size();
+    mean = stddev = ci = 0;
+    if (n == 0) return;
+    for (size_t i=0; i<n; i++) mean += times[i];
+    mean /= n;
+    if (n < 2) return;
+    for (size_t i=0; i<n; i++) stddev += (times[i] - mean) * (times[i] - mean);
+    stddev = sqrt(stddev / (n - 1));
+    ci = (n <= 30 ? t95[n-2] : 1.96) * stddev / sqrt((double)n); // Student's t for small samples
+}
+
+
+/* adaptive stopping: true if enough samples are collected and the confidence interval is narrow enough */
+bool ci_reached(lzbench_params_t *params, std::vector<uint64_t> &times)
+{
+    size_t n;
+    double mean, stddev, ci;
+    get_sample_stats(times, n, mean, stddev, ci);
+    return n >= 5 && mean > 0 && 100 * ci / mean <= params->ci_target;
+}
+
+
+uint64_t get_time(lzbench_params_t *params, std::vector<uint64_t> &all_times)
+{
+    if (all_times.empty()) return 0;
+    std::sort(all_times.begin(), all_times.end());
+    std::vector<uint64_t> kept;
+    if (params->stats) kept = all_times, reject_outliers(kept);
+    std::vector<uint64_t> &times = params->stats ? kept : all_times;
+
+    switch (params->timetype)
+    {
+        default:
+        case FASTEST: return times[0];
+        case AVERAGE: return std::accumulate(times.begin(),times.end(),(uint64_t)0) / times.size();
+        case MEDIAN: return (times[(times.size()-1)/2] + times[times.size()/2]) / 2;
+    }
+}
+
+
+/*
+ * --statsd: progress and results are pushed as StatsD gauges over UDP with tags in the DogStatsD format,
+ * so long runs can be watched while they go. Sends are fire and forget, a missing agent costs nothing.
+ */
+static int statsd_fd = -1;
+static std::string statsd_prefix;
+
+bool statsd_open(const char* target)
+{
+#if !defined(_WIN32)
+    std::vector<std::string> terms = split(target, ',');
+    std::string host = terms[0], port = "8125";
+    size_t colon = host.rfind(':');
+    struct addrinfo hints, *addr;
+
+    if (colon != std::string::npos) port = host.substr(colon + 1), host.erase(colon);
+    statsd_prefix = terms.size() > 1 ? terms[1] : "lzbench";
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addr) != 0) return false;
+    statsd_fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    if (statsd_fd >= 0 && connect(statsd_fd, addr->ai_addr, addr->ai_addrlen) != 0) close(statsd_fd), statsd_fd = -1;
+    freeaddrinfo(addr);
+    return statsd_fd >= 0;
+#else
+    (void)target;
+    return false;
+#endif
+}
+
+/* tags of a codec and level, characters that separate StatsD fields are replaced */
+std::string statsd_tags(const char* name, int level, const char* phase)
+{
+    std::string tags;
+    format(tags, "codec:%s,level:%d%s%s", name, level, phase ? ",phase:" : "", phase ? phase : "");
+    for (size_t i = 0; i < tags.size(); i++)
+        if (tags[i] == '|' || tags[i] == '#' || tags[i] == '@' || tags[i] == ' ') tags[i] = '_';
+    return tags;
+}
+
+void statsd_send(const char* metric, double value, const char* type, const std::string &tags)
+{
+#if !defined(_WIN32)
+    if (statsd_fd < 0) return;
+    std::string line;
+    format(line, "%s.%s:%.6g|%s|#%s", statsd_prefix.c_str(), metric, value, type, tags.c_str());
+    if (send(statsd_fd, line.data(), line.size(), 0) < 0) {} // nobody listens
+#else
+    (void)metric; (void)value; (void)type; (void)tags;
+#endif
+}
+
+/* the progress line of a test: iterations so far and MB/s of the last loop */
+void statsd_progress(const compressor_desc_t* desc, int level, bool decompress, int iters, float speed)
+{
+    if (statsd_fd < 0) return;
+    std::string tags = statsd_tags(desc->name, level, decompress ? "decompress" : "compress");
+    statsd_send("iterations", iters, "g", tags);
+    statsd_send("speed_mbs", speed, "g", tags);
+}
+
+void statsd_result(const compressor_desc_t* desc, int level, string_table_t &row)
+{
+    if (statsd_fd < 0) return;
+    std::string tags = statsd_tags(desc->name, level, NULL);
+    statsd_send("results", 1, "c", tags);
+    statsd_send("result.cspeed_mbs", row.col2_ctime ? row.col5_origsize * 1000.0 / row.col2_ctime : 0, "g", tags);
+    statsd_send("result.dspeed_mbs", row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0, "g", tags);
+    statsd_send("result.ratio_pct", row.col5_origsize ? row.col4_comprsize * 100.0 / row.col5_origsize : 0, "g", tags);
+}
+
+
+/* "name version -level" of a result row, without the space of an empty version or the level of a codec without levels */
+std::string row_name(const std::string& name, const compressor_desc_t* desc, int level)
+{
+    std::string s;
+    if (desc->first_level == 0 && desc->last_level == 0)
+        format(s, *desc->version ? "%s %s" : "%s%s", name.c_str(), desc->version);
+    else
+        format(s, *desc->version ? "%s %s -%d" : "%s%s -%d", name.c_str(), desc->version, level);
+    return s;
+}
+
+
+void print_stats(lzbench_params_t *params, const compressor_desc_t* desc, int level, std::vector<uint64_t> &ctime, std::vector<uint64_t> &dtime, size_t insize, size_t outsize, bool decomp_error, std::vector<lzbench_thread_t> &thr, lzbench_counters_t &counters, std::vector<uint64_t> &cold_ctime, std::vector<uint64_t> &cold_dtime, lzbench_memory_t &memory, std::vector<size_t> &file_sizes, size_t chunk_size, pagecache_e page_cache)
+{
+    std::string col1_algname;
+    std::vector<uint64_t> csamples, dsamples;
+    if (params->textformat == JSON || params->interleave) csamples = ctime, dsamples = dtime; // before sorting
+    uint64_t best_ctime = params->ratio_only ? 0 : get_time(params, ctime);
+    uint64_t best_dtime = params->ratio_only ? 0 : get_time(params, dtime);
+    if (params->ratio_only) csamples.clear(), dsamples.clear(); // a single pass isn't a sample
+
+    std::string name = codec_name(desc);
+    col1_algname = row_name(name, desc, level);
+    if (!lzbench_context_reuse && reuses_context(desc))
+        col1_algname += " percall";
+    if (lzbench_mem_arena && uses_allocator(desc))
+        col1_algname += " arena";
+    if (fresh_output_mode)
+        col1_algname += " fresh";
+    if (desc->compress == lzbench_feed_compress)
+        col1_algname += " feed";
+    if (precheck_mode)
+        col1_algname += " precheck";
+    if (lzbench_dict && uses_dictionary(desc))
+        col1_algname += " dict";
+    if (!params->codec_options.empty())
+        col1_algname += " " + params->codec_options;
+    int workers = 0;
+#ifndef BENCH_REMOVE_BLOSCLZ
+    if (desc->compress == lzbench_blosclzmt_compress) workers = lzbench_blosclzmt_threads;
+#endif
+#ifndef BENCH_REMOVE_BZIP2
+    if (desc->compress == lzbench_pbzip2_compress) workers = lzbench_pbzip2_threads;
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+    if (desc->compress == lzbench_zstdmt_compress) workers = lzbench_zstdmt_workers;
+#endif
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+    if (desc->compress == lzbench_pdeflate_compress) workers = lzbench_pdeflate_threads;
+#endif
+#ifndef BENCH_REMOVE_XZ
+    if (desc->compress == lzbench_xzmt_compress) workers = lzbench_xzmt_threads;
+#endif
+#ifndef BENCH_REMOVE_FASTLZMA2
+    if (desc->compress == lzbench_fastlzma2mt_compress) workers = lzbench_fastlzma2mt_threads;
+#endif
+#ifndef BENCH_REMOVE_LZHAM
+    if (desc->compress == lzbench_lzhammt_compress) workers = lzbench_lzhammt_threads;
+#endif
+#ifndef BENCH_REMOVE_LZMA
+    if (desc->compress == lzbench_lzmamt_compress) workers = lzbench_lzmamt_threads;
+#endif
+    if (workers)
+    {
+        std::string suffix;
+        format(suffix, " w%d", workers);
+        col1_algname += suffix;
+    }
+
+    string_table_t row(col1_algname, best_ctime, (decomp_error)?0:best_dtime, outsize, insize, params->in_filename);
+    row.threads = thr.size();
+    row.numa_mode = params->numa_mode;
+    row.pages = huge_pages;
+    row.host = host_memory;
+    row.precheck = precheck_mode;
+    if (precheck_mode && params->precheck_base && best_ctime) row.precheck_speedup = (float)params->precheck_base / best_ctime;
+    row.page_cache = page_cache;
+    row.checksum = is_checksum(desc);
+    row.unmeasured = params->ratio_only && !decomp_error;
+    row.block_size = params->chunk_size;
+    row.core_type = core_type_current;
+    row.llc_ways = llc_current_ways;
+    row.buf_offset = params->buf_offset;
+    if (!params->msg_sizes.empty())
+        for (size_t t=0; t<thr.size(); t++) row.messages += thr[t].chunk_sizes.size();
+    row.isa = (desc->compress == lzbench_filter_compress && !filter_setup.desc) ? lzbench_filter_isa(filter_setup.filters) : codec_isa(desc); // the filters alone
+    row.counters = counters;
+    row.memory = memory;
+    if (params->textformat == JSON || params->library)
+    {
+        row.name = name;
+        row.version = desc->version;
+        row.level = level;
+        row.chunk_size = chunk_size;
+        row.file_sizes = file_sizes;
+    }
+    if (params->textformat == JSON || params->interleave)
+    {
+        row.csamples.swap(csamples);
+        if (!decomp_error) row.dsamples.swap(dsamples);
+    }
+    if (params->stats)
+    {
+        size_t n;
+        double mean, stddev, ci;
+        get_sample_stats(ctime, n, mean, stddev, ci);
+        if (mean > 0) row.cstddev = 100 * stddev / mean, row.cci = 100 * ci / mean;
+        get_sample_stats(dtime, n, mean, stddev, ci);
+        if (mean > 0 && !decomp_error) row.dstddev = 100 * stddev / mean, row.dci = 100 * ci / mean;
+    }
+    row.cold_ctime = get_time(params, cold_ctime);
+    row.cold_dtime = decomp_error ? 0 : get_time(params, cold_dtime);
+    if (params->latency)
+    {
+        lzbench_histogram chist, dhist;
+        for (size_t t=0; t<thr.size(); t++)
+            chist.merge(thr[t].chist), dhist.merge(thr[t].dhist);
+        for (int i=0; i<LATENCY_PERCENTILES; i++)
+        {
+            row.clat[i] = chist.size() ? chist.percentile(latency_percentiles[i]) / 1000.0 : 0;
+            row.dlat[i] = (dhist.size() && !decomp_error) ? dhist.percentile(latency_percentiles[i]) / 1000.0 : 0;
+        }
+    }
+    bool steal = (params->work_stealing && thr.size() > 1); // as in lzbench_test()
+    for (size_t t=0; t<thr.size(); t++)
+    {
+        if (steal) // threads process different amounts of data in every pass, one that got no chunks counts as 0 MB/s
+        {
+            if (thr[t].busy_cnanosec) row.thr_cspeed += thr[t].cbytes * 1000.0 / thr[t].busy_cnanosec / thr.size();
+            if (!decomp_error && thr[t].busy_dnanosec) row.thr_dspeed += thr[t].dbytes * 1000.0 / thr[t].busy_dnanosec / thr.size();
+            continue;
+        }
+        if (thr[t].best_cnanosec != UINT64_MAX && thr[t].best_cnanosec > 0)
+            row.thr_cspeed += thr[t].insize * 1000.0 / thr[t].best_cnanosec / thr.size();
+        if (!decomp_error && thr[t].best_dnanosec != UINT64_MAX && thr[t].best_dnanosec > 0)
+            row.thr_dspeed += thr[t].insize * 1000.0 / thr[t].best_dnanosec / thr.size();
+    }
+    if (params->freq_threshold > 0 && (freq_spread(counters) > params->freq_threshold || counters.throttle))
+        fprintf(stderr, "warning: %s frequency moved %.1f%% (%.0f-%.0f MHz), %llu throttle events\n", col1_algname.c_str(), freq_spread(counters),
+            MIN(counters.cfreq.min, counters.dfreq.count ? counters.dfreq.min : counters.cfreq.min), MAX(counters.cfreq.max, counters.dfreq.max), (unsigned long long)counters.throttle);
+    if (counters.cg_throttled)
+        fprintf(stderr, "warning: %s was throttled by the CPU quota of the cgroup (%.2f CPUs) in %llu periods for %.0f ms\n", col1_algname.c_str(),
+            cgroup_cpus, (unsigned long long)counters.cg_throttled, counters.cg_throttled_ms);
+    params->results.push_back(row);
+    statsd_result(desc, level, params->results.back());
+    if (!params->merge_parts && !params->library) // otherwise printed by lzbench_merge_parts()
+    {
+        if (params->show_speed)
+            print_speed(params, params->results[params->results.size()-1]);
+        else
+            print_time(params, params->results[params->results.size()-1]);
+    }
+
+    ctime.clear();
+    dtime.clear();
+    cold_ctime.clear();
+    cold_dtime.clear();
+}
+
+
+/* time of a row used by the Pareto frontier: 0 = compression, 1 = decompression, 2 = weighted sum of both */
+double pareto_time(lzbench_params_t *params, string_table_t &row, int mode)
+{
+    if (mode == 0) return row.col2_ctime;
+    if (mode == 1) return row.col3_dtime;
+    return params->pareto_weight * row.col2_ctime + (1 - params->pareto_weight) * row.col3_dtime;
+}
+
+
+/* print rows that no other row beats in both ratio and speed, separately for every file and number of threads */
+void print_pareto_frontier(lzbench_params_t *params, int mode)
+{
+    static const char* mode_names[] = { "compression", "decompression", "weighted" };
+    std::vector<string_table_t> &res = params->results;
+    std::vector<bool> done(res.size(), false);
+
+    if (params->textformat != JSON)
+    {
+        if (mode == 2)
+            printf("\nPareto frontier of ratio and %.0f%%/%.0f%% weighted compression/decompression time:\n", params->pareto_weight*100, (1-params->pareto_weight)*100);
+        else
+            printf("\nPareto frontier of ratio and %s speed:\n", mode_names[mode]);
+        print_header(params);
+    }
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (done[i]) continue;
+
+        std::vector<size_t> group;
+        for (size_t j=i; j<res.size(); j++)
+        {
+            if (res[j].col6_filename != res[i].col6_filename || res[j].threads != res[i].threads) continue;
+            done[j] = true;
+            if (res[j].col1_algname.compare(0, 6, "memcpy") == 0 || !res[j].col2_ctime || !res[j].col3_dtime) continue; // reference or decompression error
+            group.push_back(j);
+        }
+
+        // the fastest first, then a row is on the frontier if its ratio is better than of all faster rows
+        std::sort(group.begin(), group.end(), [&](size_t a, size_t b) {
+            double ta = pareto_time(params, res[a], mode), tb = pareto_time(params, res[b], mode);
+            return (ta != tb) ? ta < tb : res[a].col4_comprsize * res[b].col5_origsize < res[b].col4_comprsize * res[a].col5_origsize;
+        });
+        double best_ratio = 1e30;
+        for (size_t k=0; k<group.size(); k++)
+        {
+            string_table_t &row = res[group[k]];
+            double ratio = (double)row.col4_comprsize / row.col5_origsize;
+            if (ratio >= best_ratio) continue;
+            best_ratio = ratio;
+
+            if (params->textformat == JSON)
+            {
+                printf("{\"type\":\"pareto\",\"frontier\":\"%s\",\"name\":", mode_names[mode]);
+                print_json_string(row.col1_algname.c_str());
+                printf(",\"file\":");
+                print_json_string(row.col6_filename.c_str());
+                printf(",\"threads\":%d}\n", row.threads);
+            }
+            else if (params->show_speed)
+                print_speed(params, row);
+            else
+                print_time(params, row);
+        }
+    }
+}
+
+
+/*
+ * --summary: every compressor (with the same threads and chunk size) over all files benchmarked one by one, the total
+ * ratio, MB/s of the total size in the total time (size-weighted), the geometric mean of MB/s of the files (every file
+ * counts the same) and the slowest file. Decompression of rows with an error is left out.
+ */
+void print_summary(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<bool> done(res.size(), false);
+
+    if (params->textformat == CSV)
+        printf("\nCompressor name,Files,Original size,Compressed size,Ratio,Compression speed,Compression speed geometric mean,Compression speed worst,"
+               "Decompression speed,Decompression speed geometric mean,Decompression speed worst\n");
+    else if (params->textformat != JSON)
+        printf("\nSummary over all files (speed in MB/s of the total size, geometric mean of files and the slowest file):\n"
+               "%-23s Files   Ratio   C total     C geo     C min   D total     D geo     D min\n", "Compressor name");
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (done[i]) continue;
+
+        uint64_t orig = 0, compr = 0, ctime = 0, dtime = 0, dorig = 0;
+        double clog = 0, dlog = 0, cmin = 1e30, dmin = 1e30;
+        int files = 0, dfiles = 0;
+        for (size_t j=i; j<res.size(); j++)
+        {
+            if (res[j].col1_algname != res[i].col1_algname || res[j].threads != res[i].threads || res[j].block_size != res[i].block_size) continue;
+            done[j] = true;
+            if (!res[j].col5_origsize || !res[j].col2_ctime) continue;
+            double cspeed = res[j].col5_origsize * 1000.0 / res[j].col2_ctime;
+            files++;
+            orig += res[j].col5_origsize;
+            compr += res[j].col4_comprsize;
+            ctime += res[j].col2_ctime;
+            clog += log(cspeed);
+            cmin = MIN(cmin, cspeed);
+            if (!res[j].col3_dtime) continue; // decompression error
+            double dspeed = res[j].col5_origsize * 1000.0 / res[j].col3_dtime;
+            dfiles++;
+            dorig += res[j].col5_origsize;
+            dtime += res[j].col3_dtime;
+            dlog += log(dspeed);
+            dmin = MIN(dmin, dspeed);
+        }
+        if (!files) continue;
+
+        double ratio = compr * 100.0 / orig, cspeed = orig * 1000.0 / ctime, cgeo = exp(clog / files);
+        double dspeed = dfiles ? dorig * 1000.0 / dtime : 0, dgeo = dfiles ? exp(dlog / dfiles) : 0;
+        if (!dfiles) dmin = 0;
+        if (params->textformat == JSON)
+        {
+            printf("{\"type\":\"summary\",\"name\":");
+            print_json_string(res[i].col1_algname.c_str());
+            printf(",\"threads\":%d,\"files\":%d,\"orig_size\":%llu,\"compr_size\":%llu,\"ratio\":%.2f,\"cspeed\":%.2f,\"cspeed_geomean\":%.2f,\"cspeed_min\":%.2f,"
+                   "\"dspeed\":%.2f,\"dspeed_geomean\":%.2f,\"dspeed_min\":%.2f}\n", res[i].threads, files, (unsigned long long)orig, (unsigned long long)compr,
+                   ratio, cspeed, cgeo, cmin, dspeed, dgeo, dmin);
+        }
+        else if (params->textformat == CSV)
+            printf("%s,%d,%llu,%llu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n", res[i].col1_algname.c_str(), files, (unsigned long long)orig, (unsigned long long)compr,
+                   ratio, cspeed, cgeo, cmin, dspeed, dgeo, dmin);
+        else
+            printf("%-23s %5d %6.2f%% %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", res[i].col1_algname.c_str(), files, ratio, cspeed, cgeo, cmin, dspeed, dgeo, dmin);
+    }
+}
+
+
+/* --pathological: generated inputs, see pathological_input() */
+#define PATHOLOGICAL_INPUTS 4
+
+static const char* pathological_names[PATHOLOGICAL_INPUTS] = { "gen:zeros", "gen:period-7", "gen:near-dup", "gen:de-bruijn" };
+
+
+/* --pathological: speed on every generated input against the speed on the files, the worst one shows how far compression collapses */
+void print_pathological(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<bool> done(res.size(), false);
+
+    if (params->textformat == CSV)
+    {
+        printf("\nCompressor name,Compression speed,Decompression speed,");
+        for (int k=0; k<PATHOLOGICAL_INPUTS; k++)
+            printf("Compression speed of %s,Decompression speed of %s,", pathological_names[k], pathological_names[k]);
+        printf("Worst compression speed against files,Worst input\n");
+    }
+    else if (params->textformat != JSON)
+    {
+        printf("\nPathological inputs (compression/decompression speed in MB/s, the files first, and the slowest compression against the files):\n%-23s", "Compressor name");
+        printf(" %15s", "files");
+        for (int k=0; k<PATHOLOGICAL_INPUTS; k++) printf(" %15s", pathological_names[k] + 4);
+        printf("  Worst C\n");
+    }
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (done[i]) continue;
+
+        // speed of the files over their total size and of each generated input
+        uint64_t orig = 0, ctime = 0, dtime = 0;
+        double cspeed[PATHOLOGICAL_INPUTS] = { 0 }, dspeed[PATHOLOGICAL_INPUTS] = { 0 };
+        bool generated = false;
+        for (size_t j=i; j<res.size(); j++)
+        {
+            if (res[j].col1_algname != res[i].col1_algname || res[j].threads != res[i].threads || res[j].block_size != res[i].block_size) continue;
+            done[j] = true;
+            int kind = PATHOLOGICAL_INPUTS;
+            for (int k=0; k<PATHOLOGICAL_INPUTS; k++)
+                if (res[j].col6_filename == pathological_names[k]) kind = k;
+            if (kind < PATHOLOGICAL_INPUTS)
+            {
+                generated = true;
+                cspeed[kind] = res[j].col2_ctime ? res[j].col5_origsize * 1000.0 / res[j].col2_ctime : 0;
+                dspeed[kind] = res[j].col3_dtime ? res[j].col5_origsize * 1000.0 / res[j].col3_dtime : 0;
+            }
+            else if (res[j].col2_ctime && res[j].col3_dtime)
+                orig += res[j].col5_origsize, ctime += res[j].col2_ctime, dtime += res[j].col3_dtime;
+        }
+        if (!generated) continue;
+
+        double fcspeed = ctime ? orig * 1000.0 / ctime : 0, fdspeed = dtime ? orig * 1000.0 / dtime : 0, worst = 0;
+        int worst_kind = -1;
+        for (int k=0; k<PATHOLOGICAL_INPUTS; k++)
+            if (fcspeed && cspeed[k] && (worst_kind < 0 || cspeed[k] / fcspeed < worst))
+                worst = cspeed[k] / fcspeed, worst_kind = k;
+        const char* worst_name = worst_kind >= 0 ? pathological_names[worst_kind] : "";
+
+        if (params->textformat == JSON)
+        {
+            printf("{\"type\":\"pathological\",\"name\":");
+            print_json_string(res[i].col1_algname.c_str());
+            printf(",\"threads\":%d,\"cspeed\":%.2f,\"dspeed\":%.2f", res[i].threads, fcspeed, fdspeed);
+            for (int k=0; k<PATHOLOGICAL_INPUTS; k++)
+                printf(",\"%s\":{\"cspeed\":%.2f,\"dspeed\":%.2f}", pathological_names[k] + 4, cspeed[k], dspeed[k]);
+            if (worst_kind >= 0) printf(",\"worst_cspeed_x\":%.4f,\"worst_input\":\"%s\"}\n", worst, worst_name + 4); else printf("}\n");
+        }
+        else if (params->textformat == CSV)
+        {
+            printf("%s,%.2f,%.2f,", res[i].col1_algname.c_str(), fcspeed, fdspeed);
+            for (int k=0; k<PATHOLOGICAL_INPUTS; k++) printf("%.2f,%.2f,", cspeed[k], dspeed[k]);
+            printf("%.4f,%s\n", worst, worst_name + (worst_kind >= 0 ? 4 : 0));
+        }
+        else
+        {
+            std::string cell = "-";
+            printf("%-23s", res[i].col1_algname.c_str());
+            if (fcspeed) format(cell, "%.0f/%.0f", fcspeed, fdspeed);
+            printf(" %15s", cell.c_str());
+            for (int k=0; k<PATHOLOGICAL_INPUTS; k++) { format(cell, "%.0f/%.0f", cspeed[k], dspeed[k]); printf(" %15s", cell.c_str()); }
+            if (worst_kind >= 0) printf(" %6.2fx %s\n", worst, worst_name + 4); else printf("\n");
+        }
+    }
+}
+
+
+/*
+ * --transfer=#,...: end-to-end time of shipping the input over links of # Gbit/s, compression + the compressed size at
+ * the speed of the link + decompression, next to sending it uncompressed. With --cost also $ per TB of input for the
+ * data stored or shipped and for the CPU time of all threads. The fastest row of every link and file is marked by *.
+ */
+void print_transfer(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<double> &links = params->link_gbits;
+    std::vector<bool> done(res.size(), false);
+    bool cost = params->cost_gb > 0 || params->cost_core_hour > 0;
+    std::string label;
+
+    if (params->textformat == CSV)
+    {
+        printf("\nCompressor name,");
+        for (size_t k=0; k<links.size(); k++) printf("Transfer time at %g Gbit/s in ms,", links[k]);
+        if (cost) printf("CPU $ per TB,Data $ per TB,Total $ per TB,");
+        printf("Filename\n");
+    }
+    else if (params->textformat != JSON)
+    {
+        printf("\nTransfer time in ms of compression, the compressed data over the link and decompression");
+        if (cost) printf(", $ per TB of input at $%g/GB and $%g/core-hour", params->cost_gb, params->cost_core_hour);
+        printf(":\n%-23s", "Compressor name");
+        for (size_t k=0; k<links.size(); k++) { format(label, "%g Gbit", links[k]); printf(" %12s ", label.c_str()); }
+        if (cost) printf("  CPU $/TB Data $/TB Total $/TB");
+        printf(" Filename\n");
+    }
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (done[i]) continue;
+
+        // the uncompressed input first, then the rows of the file
+        std::vector<int> group(1, -1);
+        for (size_t j=i; j<res.size(); j++)
+        {
+            if (res[j].col6_filename != res[i].col6_filename) continue;
+            done[j] = true;
+            if (res[j].col1_algname.compare(0, 6, "memcpy") == 0 || !res[j].col2_ctime || !res[j].col3_dtime) continue; // reference or decompression error
+            group.push_back(j);
+        }
+
+        uint64_t origsize = res[i].col5_origsize;
+        std::vector<std::vector<double> > ms(group.size(), std::vector<double>(links.size()));
+        std::vector<size_t> best(links.size(), 0);
+        for (size_t g=0; g<group.size(); g++)
+            for (size_t k=0; k<links.size(); k++)
+            {
+                uint64_t nanosec = group[g] < 0 ? 0 : res[group[g]].col2_ctime + res[group[g]].col3_dtime;
+                uint64_t bytes = group[g] < 0 ? origsize : res[group[g]].col4_comprsize;
+                ms[g][k] = nanosec / 1000000.0 + bytes * 8 / (links[k] * 1000000.0);
+                if (ms[g][k] < ms[best[k]][k]) best[k] = g;
+            }
+
+        for (size_t g=0; g<group.size(); g++)
+        {
+            const char* name = group[g] < 0 ? "uncompressed" : res[group[g]].col1_algname.c_str();
+            double ratio = group[g] < 0 ? 1 : (double)res[group[g]].col4_comprsize / (MAX(origsize, (uint64_t)1));
+            double core_ns = group[g] < 0 ? 0 : (double)(res[group[g]].col2_ctime + res[group[g]].col3_dtime) * res[group[g]].threads;
+            double cpu_usd = core_ns / (MAX(origsize, (uint64_t)1)) * 1e12 / 1e9 / 3600 * params->cost_core_hour, data_usd = ratio * 1000 * params->cost_gb;
+
+            if (params->textformat == JSON)
+            {
+                printf("{\"type\":\"transfer\",\"name\":");
+                print_json_string(name);
+                printf(",\"file\":");
+                print_json_string(res[i].col6_filename.c_str());
+                for (size_t k=0; k<links.size(); k++)
+                    printf("%s{\"gbit\":%g,\"ms\":%.3f,\"best\":%s}%s", k ? "," : ",\"links\":[", links[k], ms[g][k], best[k] == g ? "true" : "false", k + 1 < links.size() ? "" : "]");
+                if (cost) printf(",\"cpu_usd_per_tb\":%.4f,\"data_usd_per_tb\":%.4f", cpu_usd, data_usd);
+                printf("}\n");
+                continue;
+            }
+            printf(params->textformat == CSV ? "%s," : "%-23s", name);
+            for (size_t k=0; k<links.size(); k++)
+                printf(params->textformat == CSV ? "%.3f," : " %12.2f%c", ms[g][k], best[k] == g ? '*' : ' ');
+            if (cost) printf(params->textformat == CSV ? "%.4f,%.4f,%.4f," : " %10.2f %9.2f %10.2f", cpu_usd, data_usd, cpu_usd + data_usd);
+            printf(params->textformat == CSV ? "%s\n" : " %s\n", res[i].col6_filename.c_str());
+        }
+    }
+}
+
+
+/* read a line of any length without the end of line, false at the end of file */
+bool read_line(FILE* f, std::string &line)
+{
+    char buf[4096];
+    line.clear();
+    while (fgets(buf, sizeof(buf), f))
+    {
+        line += buf;
+        if (line[line.size()-1] == '\n') break;
+    }
+    while (!line.empty() && (line[line.size()-1] == '\n' || line[line.size()-1] == '\r')) line.erase(line.size()-1);
+    return !line.empty() || !feof(f);
+}
+
+
+/* value of a field of a single-line JSON object written by print_json_record() */
+bool json_field(const std::string &line, const char* key, std::string &value)
+{
+    std::string k = std::string("\"") + key + "\":";
+    size_t pos = line.find(k);
+    if (pos == std::string::npos) return false;
+
+    pos += k.size();
+    value.clear();
+    if (pos < line.size() && line[pos] == '"')
+    {
+        for (pos++; pos < line.size() && line[pos] != '"'; pos++)
+        {
+            if (line[pos] == '\\' && pos+1 < line.size()) pos++;
+            value += line[pos];
+        }
+    }
+    else
+        value = line.substr(pos, line.find_first_of(",}]", pos) - pos);
+    return true;
+}
+
+
+std::string trim(const std::string &str)
+{
+    size_t first = str.find_first_not_of(' ');
+    if (first == std::string::npos) return "";
+    return str.substr(first, str.find_last_not_of(' ') - first + 1);
+}
+
+
+/* load results of a previous run written with -o4 (CSV) or -o7 (JSON) */
+int lzbench_load_baseline(const char* filename, std::vector<string_table_t> &baseline)
+{
+    FILE* f = fopen(filename, "rb");
+    std::string line, value;
+    std::vector<std::string> header;
+
+    if (!f) { perror(filename); return 1; }
+
+    while (read_line(f, line))
+    {
+        if (line.empty()) continue;
+        if (line[0] == '{')
+        {
+            std::string name, file, orig, compr, ctime, dtime;
+            if (!json_field(line, "type", value) || value != "result") continue;
+            if (!json_field(line, "name", name) || !json_field(line, "file", file) || !json_field(line, "orig_size", orig) || !json_field(line, "compr_size", compr)
+                || !json_field(line, "ctime_ns", ctime) || !json_field(line, "dtime_ns", dtime)) continue;
+            string_table_t row(trim(name), strtoull(ctime.c_str(), NULL, 10), strtoull(dtime.c_str(), NULL, 10), strtoull(compr.c_str(), NULL, 10), strtoull(orig.c_str(), NULL, 10), file);
+            if (json_field(line, "threads", value)) row.threads = atoi(value.c_str());
+            baseline.push_back(row);
+            continue;
+        }
+
+        std::vector<std::string> cols;
+        size_t pos = 0, next;
+        while ((next = line.find(',', pos)) != std::string::npos) { cols.push_back(line.substr(pos, next - pos)); pos = next + 1; }
+        cols.push_back(line.substr(pos));
+        if (cols[0] == "Compressor name") { header = cols; continue; }
+        if (header.empty() || cols.size() != header.size()) continue;
+
+        string_table_t row(trim(cols[0]), 0, 0, 0, 0, cols.back());
+        for (size_t i=1; i<header.size(); i++)
+        {
+            if (header[i] == "Original size") row.col5_origsize = strtoull(cols[i].c_str(), NULL, 10);
+            else if (header[i] == "Compressed size") row.col4_comprsize = strtoull(cols[i].c_str(), NULL, 10);
+            else if (header[i] == "Compression time in us") row.col2_ctime = strtoull(cols[i].c_str(), NULL, 10) * 1000;
+            else if (header[i] == "Decompression time in us") row.col3_dtime = strtoull(cols[i].c_str(), NULL, 10) * 1000;
+            else if (header[i] == "Threads") row.threads = atoi(cols[i].c_str());
+        }
+        for (size_t i=1; i<header.size(); i++) // speeds need the original size
+        {
+            double speed = atof(cols[i].c_str());
+            if (header[i] == "Compression speed" && speed > 0) row.col2_ctime = row.col5_origsize * 1000.0 / speed;
+            else if (header[i] == "Decompression speed" && speed > 0) row.col3_dtime = row.col5_origsize * 1000.0 / speed;
+        }
+        baseline.push_back(row);
+    }
+
+    fclose(f);
+    if (baseline.empty()) { printf("No results found in baseline file %s\n", filename); return 1; }
+    return 0;
+}
+
+
+/* compare results with a baseline, returns the number of rows with a regression above the thresholds */
+int lzbench_compare_baseline(lzbench_params_t *params, std::vector<string_table_t> &baseline)
+{
+    int regressions = 0;
+
+    if (params->textformat == CSV)
+        printf("Compressor name,Threads,Compression speed change,Decompression speed change,Ratio change,Regression,Filename\n");
+    else if (params->textformat != JSON)
+    {
+        printf("\nComparison with %s (regression thresholds: speed %.1f%%, ratio %.2f%%):\n", params->baseline_file, params->speed_threshold, params->ratio_threshold);
+        printf("Compressor name         Thr Compress. Decompress.   Ratio Filename\n");
+    }
+
+    for (size_t i=0; i<params->results.size(); i++)
+    {
+        string_table_t &row = params->results[i];
+        std::string name = trim(row.col1_algname);
+        if (name == "memcpy") continue; // only a reference, too noisy to be compared
+
+        size_t k;
+        for (k=0; k<baseline.size(); k++)
+            if (baseline[k].col1_algname == name && baseline[k].col6_filename == row.col6_filename && baseline[k].threads == row.threads) break;
+        if (k == baseline.size()) { LZBENCH_PRINT(2, "%s %s: not found in the baseline\n", name.c_str(), row.col6_filename.c_str()); continue; }
+
+        string_table_t &base = baseline[k];
+        // changes in %, positive is better: faster (de)compression or a lower ratio
+        float cdelta = (row.col2_ctime && base.col2_ctime) ? 100.0 * base.col2_ctime / row.col2_ctime - 100 : 0;
+        float ddelta = (row.col3_dtime && base.col3_dtime) ? 100.0 * base.col3_dtime / row.col3_dtime - 100 : 0;
+        float ratio = row.col5_origsize ? (float)row.col4_comprsize / row.col5_origsize : 0;
+        float base_ratio = base.col5_origsize ? (float)base.col4_comprsize / base.col5_origsize : 0;
+        float rdelta = (ratio && base_ratio) ? 100.0 * base_ratio / ratio - 100 : 0;
+        bool decomp_error = !row.col3_dtime && base.col3_dtime;
+        bool regression = decomp_error || cdelta < -params->speed_threshold || ddelta < -params->speed_threshold || rdelta < -params->ratio_threshold;
+        if (regression) regressions++;
+
+        switch (params->textformat)
+        {
+            case CSV:
+                printf("%s,%d,%.2f,%.2f,%.3f,%d,%s\n", name.c_str(), row.threads, cdelta, ddelta, rdelta, regression, row.col6_filename.c_str()); break;
+            case JSON:
+                printf("{\"type\":\"baseline\",\"name\":");
+                print_json_string(name.c_str());
+                printf(",\"file\":");
+                print_json_string(row.col6_filename.c_str());
+                printf(",\"threads\":%d,\"cspeed_change_pct\":%.3f,\"dspeed_change_pct\":%.3f,\"ratio_change_pct\":%.3f,\"decomp_error\":%s,\"regression\":%s}\n",
+                    row.threads, cdelta, ddelta, rdelta, decomp_error ? "true" : "false", regression ? "true" : "false");
+                break;
+            default:
+                printf("%-23s %3d %+8.1f%%", name.c_str(), row.threads, cdelta);
+                if (decomp_error) printf("      ERROR"); else printf(" %+9.1f%%", ddelta);
+                printf(" %+6.2f%% %s%s\n", rdelta, row.col6_filename.c_str(), regression ? "  <-- REGRESSION" : "");
+                break;
+        }
+    }
+
+    if (params->textformat != CSV && params->textformat != JSON)
+        printf(regressions ? "%d regressions found\n" : "no regressions found\n", regressions);
+    return regressions;
+}
+
+
+/*
+ * --predict: features of samples of a file that cost a few ms, order-0 and order-1 entropy in bits per byte / 8,
+ * the share of bytes covered by 4-byte matches found by a single hash probe (greedy like lz4 at its fastest),
+ * and the shares of text (printable ASCII, tab and line ends), zero and high (>= 128) bytes. Ratio and speed of
+ * a codec are the weighted means of the results of the PREDICT_NEIGHBORS files of the model nearest in features,
+ * the weight is 1 / distance. The model is a run written with --predict -o7, only single-thread results are used.
+ */
+typedef struct
+{
+    std::map<std::string, std::vector<float> > files; // features of the files of the model
+    std::vector<string_table_t> rows;
+} predict_model_t;
+
+static predict_model_t predict_model;
+static std::map<std::string, std::vector<float> > predict_features; // --predict: features of the files of the run
+
+
+/* PREDICT_SAMPLES samples of 64 KB spread over size bytes, the whole input if it's smaller */
+template<typename Read>
+std::vector<uint8_t> predict_sample(size_t size, Read read)
+{
+    const size_t sample = 64 << 10;
+    std::vector<uint8_t> buf;
+    if (size <= PREDICT_SAMPLES * sample)
+    {
+        buf.resize(size);
+        buf.resize(read(0, buf.data(), size));
+        return buf;
+    }
+    buf.resize(PREDICT_SAMPLES * sample);
+    size_t len = 0;
+    for (int k = 0; k < PREDICT_SAMPLES; k++)
+        len += read((size - sample) / (PREDICT_SAMPLES - 1) * k, buf.data() + len, sample);
+    buf.resize(len);
+    return buf;
+}
+
+
+std::vector<float> predict_features_of(const uint8_t* buf, size_t size)
+{
+    std::vector<float> f(PREDICT_FEATURES_NB, 0);
+    std::vector<uint32_t> freq(256), pairs(256 * 256), table(1 << 12);
+    size_t text = 0, covered = 0;
+    if (!size) return f;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        uint8_t c = buf[i];
+        freq[c]++;
+        if (i) pairs[buf[i-1] * 256 + c]++;
+        text += (c >= 0x20 && c < 0x7f) || c == '\t' || c == '\n' || c == '\r';
+    }
+    for (size_t i = 0; i + 4 <= size; )
+    {
+        uint32_t v;
+        memcpy(&v, buf + i, 4);
+        uint32_t h = (v * 2654435761u) >> 20, cand = table[h];
+        table[h] = i + 1;
+        size_t len = 0;
+        if (cand && i - (cand - 1) < (64 << 10))
+            while (i + len < size && len < 255 && buf[cand - 1 + len] == buf[i + len]) len++;
+        if (len >= 4) covered += len, i += len;
+        else i++;
+    }
+
+    double h0 = 0, h1 = 0;
+    for (int c = 0; c < 256; c++)
+        if (freq[c]) h0 -= freq[c] * log2((double)freq[c] / size);
+    for (int p = 0; p < 256; p++)
+    {
+        uint32_t total = 0;
+        for (int c = 0; c < 256; c++) total += pairs[p * 256 + c];
+        for (int c = 0; c < 256 && total; c++)
+            if (pairs[p * 256 + c]) h1 -= pairs[p * 256 + c] * log2((double)pairs[p * 256 + c] / total);
+    }
+    f[0] = h0 / size / 8;
+    f[1] = size > 1 ? h1 / (size - 1) / 8 : f[0];
+    f[2] = (float)covered / size;
+    f[3] = (float)text / size;
+    f[4] = (float)freq[0] / size;
+    f[5] = (float)std::accumulate(freq.begin() + 128, freq.end(), (uint64_t)0) / size;
+    return f;
+}
+
+
+void print_predict_features(lzbench_params_t *params, const char* filename, const std::vector<float> &f)
+{
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"features\",\"file\":");
+        print_json_string(filename);
+        printf(",\"h0\":%.5f,\"h1\":%.5f,\"matches\":%.5f,\"text\":%.5f,\"zero\":%.5f,\"high\":%.5f}\n", f[0], f[1], f[2], f[3], f[4], f[5]);
+    }
+    else if (params->textformat != CSV)
+        printf("%s: order-0 entropy %.2f bits, order-1 %.2f bits, %.1f%% in matches, %.1f%% text, %.1f%% zero and %.1f%% high bytes\n",
+            filename, f[0] * 8, f[1] * 8, f[2] * 100, f[3] * 100, f[4] * 100, f[5] * 100);
+}
+
+
+/* features of the input of the run, for the comparison of --predict=file,run and the model of a later run */
+void lzbench_predict_input(lzbench_params_t *params, const uint8_t* inbuf, size_t insize)
+{
+    std::vector<uint8_t> sample = predict_sample(insize, [&](size_t pos, uint8_t* out, size_t len) { memcpy(out, inbuf + pos, len); return len; });
+    std::vector<float> f = predict_features_of(sample.data(), sample.size());
+    predict_features[params->in_filename] = f;
+    print_predict_features(params, params->in_filename, f);
+}
+
+
+/* load the results (threads = 1) and the features of a run written with --predict -o7 */
+int lzbench_load_model(const char* filename)
+{
+    FILE* f = fopen(filename, "rb");
+    std::string line, file, value;
+    static const char* keys[PREDICT_FEATURES_NB] = { "h0", "h1", "matches", "text", "zero", "high" };
+    std::vector<string_table_t> rows;
+
+    if (!f) { perror(filename); return 1; }
+    while (read_line(f, line))
+    {
+        if (!json_field(line, "type", value) || value != "features" || !json_field(line, "file", file)) continue;
+        std::vector<float> features(PREDICT_FEATURES_NB);
+        for (int k = 0; k < PREDICT_FEATURES_NB; k++)
+            features[k] = json_field(line, keys[k], value) ? atof(value.c_str()) : 0;
+        predict_model.files[file] = features;
+    }
+    fclose(f);
+    if (predict_model.files.empty()) { printf("No features found in %s, write it with --predict -o7\n", filename); return 1; }
+    if (lzbench_load_baseline(filename, rows) != 0) return 1;
+    for (size_t i = 0; i < rows.size(); i++)
+        if (rows[i].threads == 1 && rows[i].col1_algname != "memcpy" && rows[i].col2_ctime && rows[i].col5_origsize && predict_model.files.count(rows[i].col6_filename))
+            predict_model.rows.push_back(rows[i]);
+    return 0;
+}
+
+
+/* ratio in %, compression and decompression speed in MB/s of a codec of the model, returns the distance to the nearest file or -1 */
+float predict_codec(const std::string &name, const std::vector<float> &f, float &ratio, float &cspeed, float &dspeed)
+{
+    std::vector<std::pair<float, const string_table_t*> > near;
+    for (size_t i = 0; i < predict_model.rows.size(); i++)
+    {
+        const string_table_t &row = predict_model.rows[i];
+        if (row.col1_algname != name) continue;
+        const std::vector<float> &m = predict_model.files[row.col6_filename];
+        float d = 0;
+        for (int k = 0; k < PREDICT_FEATURES_NB; k++) d += (f[k] - m[k]) * (f[k] - m[k]);
+        near.push_back(std::make_pair(sqrtf(d), &row));
+    }
+    if (near.empty()) return -1;
+    std::sort(near.begin(), near.end(), [](const std::pair<float, const string_table_t*> &a, const std::pair<float, const string_table_t*> &b) { return a.first < b.first; });
+    if (near.size() > PREDICT_NEIGHBORS) near.resize(PREDICT_NEIGHBORS);
+
+    double weights = 0, r = 0, c = 0, d = 0;
+    for (size_t i = 0; i < near.size(); i++)
+    {
+        const string_table_t &row = *near[i].second;
+        double w = 1.0 / (near[i].first + 1e-3);
+        weights += w;
+        r += w * row.col4_comprsize * 100.0 / row.col5_origsize;
+        c += w * row.col5_origsize * 1000.0 / row.col2_ctime;
+        d += w * (row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0);
+    }
+    ratio = r / weights, cspeed = c / weights, dspeed = d / weights;
+    return near[0].first;
+}
+
+
+/* codecs of the model in the order of their first result */
+std::vector<std::string> predict_codecs()
+{
+    std::vector<std::string> names;
+    for (size_t i = 0; i < predict_model.rows.size(); i++)
+        if (std::find(names.begin(), names.end(), predict_model.rows[i].col1_algname) == names.end()) names.push_back(predict_model.rows[i].col1_algname);
+    return names;
+}
+
+
+/* --predict=file: features of samples of every file and the predictions of all codecs of the model, no codec is run */
+int lzbench_predict_files(lzbench_params_t *params, const char** inFileNames, unsigned ifnIdx)
+{
+    std::vector<std::string> names = predict_codecs();
+
+    if (params->textformat == CSV)
+        printf("Compressor name,Predicted ratio,Predicted compression speed,Predicted decompression speed,Distance,Filename\n");
+    else if (params->textformat != JSON)
+        printf("Predicted from %s (%d files, %d codecs, %d nearest files):\n", params->predict_model, (int)predict_model.files.size(), (int)names.size(), PREDICT_NEIGHBORS);
+
+    for (unsigned i = 0; i < ifnIdx; i++)
+    {
+        FILE* in = fopen(inFileNames[i], "rb");
+        if (!in) { perror(inFileNames[i]); continue; }
+        fseeko(in, 0L, SEEK_END);
+        size_t size = ftello(in);
+        std::vector<uint8_t> sample = predict_sample(size, [&](size_t pos, uint8_t* out, size_t len) { fseeko(in, pos, SEEK_SET); return fread(out, 1, len, in); });
+        fclose(in);
+
+        const char* pch = strrchr(inFileNames[i], '\\');
+        const char* filename = pch ? pch+1 : inFileNames[i];
+        std::vector<float> f = predict_features_of(sample.data(), sample.size());
+        print_predict_features(params, filename, f);
+        if (params->textformat != JSON && params->textformat != CSV)
+            printf("Compressor name              Ratio   C MB/s   D MB/s Distance\n");
+        for (size_t n = 0; n < names.size(); n++)
+        {
+            float ratio, cspeed, dspeed, distance = predict_codec(names[n], f, ratio, cspeed, dspeed);
+            switch (params->textformat)
+            {
+                case CSV:
+                    printf("%s,%.2f,%.2f,%.2f,%.4f,%s\n", names[n].c_str(), ratio, cspeed, dspeed, distance, filename); break;
+                case JSON:
+                    printf("{\"type\":\"prediction\",\"name\":");
+                    print_json_string(names[n].c_str());
+                    printf(",\"file\":");
+                    print_json_string(filename);
+                    printf(",\"ratio\":%.3f,\"cspeed\":%.2f,\"dspeed\":%.2f,\"distance\":%.4f}\n", ratio, cspeed, dspeed, distance);
+                    break;
+                default:
+                    printf("%-26s %6.2f %8.1f %8.1f %8.4f\n", names[n].c_str(), ratio, cspeed, dspeed, distance); break;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/* --predict=file,run: the prediction next to the single-thread results of the run */
+void lzbench_compare_prediction(lzbench_params_t *params)
+{
+    double error[3] = { 0, 0, 0 };
+    int compared = 0;
+
+    if (params->textformat == CSV)
+        printf("Compressor name,Predicted ratio,Ratio,Predicted compression speed,Compression speed,Predicted decompression speed,Decompression speed,Filename\n");
+    else if (params->textformat != JSON)
+    {
+        printf("\nPredicted from %s and measured:\n", params->predict_model);
+        printf("Compressor name            Ratio pred/meas   C MB/s pred/meas     D MB/s pred/meas Filename\n");
+    }
+
+    for (size_t i = 0; i < params->results.size(); i++)
+    {
+        string_table_t &row = params->results[i];
+        std::string name = trim(row.col1_algname);
+        float ratio, cspeed, dspeed;
+        if (row.threads != 1 || name == "memcpy" || !predict_features.count(row.col6_filename) || !row.col2_ctime || !row.col5_origsize
+            || predict_codec(name, predict_features[row.col6_filename], ratio, cspeed, dspeed) < 0) continue;
+
+        float mratio = row.col4_comprsize * 100.0 / row.col5_origsize, mcspeed = row.col5_origsize * 1000.0 / row.col2_ctime;
+        float mdspeed = row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0;
+        error[0] += fabs(ratio - mratio);
+        error[1] += fabs(cspeed / mcspeed - 1);
+        error[2] += mdspeed ? fabs(dspeed / mdspeed - 1) : 0;
+        compared++;
+        switch (params->textformat)
+        {
+            case CSV:
+                printf("%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%s\n", name.c_str(), ratio, mratio, cspeed, mcspeed, dspeed, mdspeed, row.col6_filename.c_str()); break;
+            case JSON:
+                printf("{\"type\":\"prediction\",\"name\":");
+                print_json_string(name.c_str());
+                printf(",\"file\":");
+                print_json_string(row.col6_filename.c_str());
+                printf(",\"ratio\":%.3f,\"cspeed\":%.2f,\"dspeed\":%.2f,\"measured_ratio\":%.3f,\"measured_cspeed\":%.2f,\"measured_dspeed\":%.2f}\n",
+                    ratio, cspeed, dspeed, mratio, mcspeed, mdspeed);
+                break;
+            default:
+                printf("%-26s %6.2f/%6.2f %8.1f/%8.1f %9.1f/%9.1f %s\n", name.c_str(), ratio, mratio, cspeed, mcspeed, dspeed, mdspeed, row.col6_filename.c_str()); break;
+        }
+    }
+
+    if (params->textformat != CSV && params->textformat != JSON)
+    {
+        if (compared)
+            printf("mean absolute error of %d results: ratio %.2f points, compression speed %.1f%%, decompression speed %.1f%%\n",
+                compared, error[0] / compared, error[1] * 100 / compared, error[2] * 100 / compared);
+        else
+            printf("no results of codecs of the model\n");
+    }
+}
+
+
+/* replace rows of all parts of a file with one row per compressor and number of threads, times and sizes are summed */
+/* add counters of row to m, latency and peak memory can't be combined and the worst one is kept */
+void lzbench_merge_counters(string_table_t &m, string_table_t &row, float weight)
+{
+    m.thr_cspeed += (row.thr_cspeed - m.thr_cspeed) * weight;
+    m.thr_dspeed += (row.thr_dspeed - m.thr_dspeed) * weight;
+    for (int j=0; j<PERF_COUNTERS; j++)
+    {
+        if (m.counters.cvalues[j] != UINT64_MAX) m.counters.cvalues[j] = (row.counters.cvalues[j] == UINT64_MAX) ? UINT64_MAX : m.counters.cvalues[j] + row.counters.cvalues[j];
+        if (m.counters.dvalues[j] != UINT64_MAX) m.counters.dvalues[j] = (row.counters.dvalues[j] == UINT64_MAX) ? UINT64_MAX : m.counters.dvalues[j] + row.counters.dvalues[j];
+    }
+    for (int j=0; j<TOPDOWN_EVENTS; j++)
+    {
+        if (m.counters.ctopdown[j] != UINT64_MAX) m.counters.ctopdown[j] = (row.counters.ctopdown[j] == UINT64_MAX) ? UINT64_MAX : m.counters.ctopdown[j] + row.counters.ctopdown[j];
+        if (m.counters.dtopdown[j] != UINT64_MAX) m.counters.dtopdown[j] = (row.counters.dtopdown[j] == UINT64_MAX) ? UINT64_MAX : m.counters.dtopdown[j] + row.counters.dtopdown[j];
+    }
+    m.counters.cbytes += row.counters.cbytes;
+    m.counters.dbytes += row.counters.dbytes;
+    m.counters.cenergy += row.counters.cenergy;
+    m.counters.denergy += row.counters.denergy;
+    m.counters.cenergy_ns = (m.counters.cenergy_ns && row.counters.cenergy_ns) ? m.counters.cenergy_ns + row.counters.cenergy_ns : 0;
+    m.counters.denergy_ns = (m.counters.denergy_ns && row.counters.denergy_ns) ? m.counters.denergy_ns + row.counters.denergy_ns : 0;
+    m.counters.cllc_bytes = MAX(m.counters.cllc_bytes, row.counters.cllc_bytes);
+    m.counters.dllc_bytes = MAX(m.counters.dllc_bytes, row.counters.dllc_bytes);
+    m.counters.cmbm_bytes += row.counters.cmbm_bytes;
+    m.counters.dmbm_bytes += row.counters.dmbm_bytes;
+    m.counters.cmbm_ns = (m.counters.cmbm_ns && row.counters.cmbm_ns) ? m.counters.cmbm_ns + row.counters.cmbm_ns : 0;
+    m.counters.dmbm_ns = (m.counters.dmbm_ns && row.counters.dmbm_ns) ? m.counters.dmbm_ns + row.counters.dmbm_ns : 0;
+    freq_merge(m.counters.cfreq, row.counters.cfreq);
+    freq_merge(m.counters.dfreq, row.counters.dfreq);
+    for (int d=0; d<2; d++)
+    {
+        m.counters.ru_user_ns[d] += row.counters.ru_user_ns[d];
+        m.counters.ru_sys_ns[d] += row.counters.ru_sys_ns[d];
+        m.counters.ru_wall_ns[d] += row.counters.ru_wall_ns[d];
+        m.counters.ru_passes[d] += row.counters.ru_passes[d];
+        m.counters.ru_minflt[d] += row.counters.ru_minflt[d];
+        m.counters.ru_majflt[d] += row.counters.ru_majflt[d];
+        m.counters.ru_nvcsw[d] += row.counters.ru_nvcsw[d];
+        m.counters.ru_nivcsw[d] += row.counters.ru_nivcsw[d];
+    }
+    m.counters.throttle += row.counters.throttle;
+    m.counters.dunfused_ns += row.counters.dunfused_ns;
+    m.counters.cg_throttled += row.counters.cg_throttled;
+    m.counters.cg_throttled_ms += row.counters.cg_throttled_ms;
+    m.counters.cpipe += (row.counters.cpipe - m.counters.cpipe) * weight;
+    m.counters.dpipe += (row.counters.dpipe - m.counters.dpipe) * weight;
+    m.counters.ckernel_ns += row.counters.ckernel_ns;
+    m.counters.ctransfer_ns += row.counters.ctransfer_ns;
+    m.counters.dkernel_ns += row.counters.dkernel_ns;
+    m.counters.dtransfer_ns += row.counters.dtransfer_ns;
+    m.counters.cgpu_bytes += row.counters.cgpu_bytes;
+    m.counters.dgpu_bytes += row.counters.dgpu_bytes;
+    for (int k=0; k<ZSTD_TRACE_COUNTERS; k++) m.counters.zstd_trace[k] += row.counters.zstd_trace[k];
+    m.counters.dedup_insize += row.counters.dedup_insize;
+    m.counters.dedup_recipe += row.counters.dedup_recipe;
+    m.counters.dedup_ns += row.counters.dedup_ns;
+    m.counters.dedup_restore_ns += row.counters.dedup_restore_ns;
+    for (int d=0; d<CUDA_DEVICES_MAX; d++)
+        for (int phase=0; phase<2; phase++)
+        {
+            m.counters.gpu_ns[phase][d] += row.counters.gpu_ns[phase][d];
+            m.counters.gpu_bytes[phase][d] += row.counters.gpu_bytes[phase][d];
+        }
+    m.counters.cchunks += row.counters.cchunks;
+    m.counters.cskipped += row.counters.cskipped;
+    m.counters.rmean += (row.counters.rmean - m.counters.rmean) * weight;
+    m.counters.rrate += (row.counters.rrate - m.counters.rrate) * weight;
+    for (int j=0; j<TTFB_SIZES_MAX; j++)
+        m.counters.ttfb_us[j] += (row.counters.ttfb_us[j] - m.counters.ttfb_us[j]) * weight;
+    for (int j=0; j<LATENCY_PERCENTILES; j++)
+        m.counters.rlat[j] = MAX(m.counters.rlat[j], row.counters.rlat[j]);
+    for (int j=0; j<LATENCY_PERCENTILES; j++)
+    {
+        m.clat[j] = MAX(m.clat[j], row.clat[j]);
+        m.dlat[j] = MAX(m.dlat[j], row.dlat[j]);
+    }
+    m.memory.init_bytes = MAX(m.memory.init_bytes, row.memory.init_bytes);
+    m.memory.cpeak = MAX(m.memory.cpeak, row.memory.cpeak);
+    m.memory.dpeak = MAX(m.memory.dpeak, row.memory.dpeak);
+    m.memory.callocs += (row.memory.callocs - m.memory.callocs) * weight;
+    m.memory.dallocs += (row.memory.dallocs - m.memory.dallocs) * weight;
+}
+
+
+/* merge rows of all rounds of --interleave, times are computed again from the samples of all rounds */
+void lzbench_merge_rounds(lzbench_params_t *params, size_t first, bool print)
+{
+    std::vector<string_table_t> merged;
+    std::vector<int> rounds;
+
+    for (size_t i=first; i<params->results.size(); i++)
+    {
+        string_table_t &row = params->results[i];
+        size_t k;
+        for (k=0; k<merged.size(); k++)
+            if (merged[k].col1_algname == row.col1_algname && merged[k].threads == row.threads) break;
+        if (k == merged.size())
+        {
+            merged.push_back(row);
+            rounds.push_back(1);
+            continue;
+        }
+
+        string_table_t &m = merged[k];
+        rounds[k]++;
+        m.csamples.insert(m.csamples.end(), row.csamples.begin(), row.csamples.end());
+        m.dsamples.insert(m.dsamples.end(), row.dsamples.begin(), row.dsamples.end());
+        if (!row.col3_dtime) m.col3_dtime = 0; // decompression error in any round
+        m.cold_ctime = (m.cold_ctime && row.cold_ctime) ? m.cold_ctime + row.cold_ctime : 0;
+        m.cold_dtime = (m.cold_dtime && row.cold_dtime) ? m.cold_dtime + row.cold_dtime : 0;
+        lzbench_merge_counters(m, row, 1.0f / rounds[k]);
+    }
+
+    params->results.erase(params->results.begin() + first, params->results.end());
+    for (size_t k=0; k<merged.size(); k++)
+    {
+        string_table_t &m = merged[k];
+        std::vector<uint64_t> ctime = m.csamples, dtime = m.dsamples;
+        m.cold_ctime /= rounds[k];
+        m.cold_dtime /= rounds[k];
+        m.col2_ctime = get_time(params, ctime);
+        if (m.col3_dtime) m.col3_dtime = get_time(params, dtime);
+        if (params->stats)
+        {
+            size_t n;
+            double mean, stddev, ci;
+            get_sample_stats(m.csamples, n, mean, stddev, ci);
+            if (mean > 0) m.cstddev = 100 * stddev / mean, m.cci = 100 * ci / mean;
+            get_sample_stats(m.dsamples, n, mean, stddev, ci);
+            if (mean > 0 && m.col3_dtime) m.dstddev = 100 * stddev / mean, m.dci = 100 * ci / mean;
+        }
+        if (params->textformat != JSON) m.csamples.clear(), m.dsamples.clear();
+        params->results.push_back(m);
+        if (!print) continue;
+        if (params->show_speed)
+            print_speed(params, params->results.back());
+        else
+            print_time(params, params->results.back());
+    }
+}
+
+
+void lzbench_merge_parts(lzbench_params_t *params, size_t first, const char* filename)
+{
+    std::vector<string_table_t> merged;
+
+    for (size_t i=first; i<params->results.size(); i++)
+    {
+        string_table_t &row = params->results[i];
+        size_t k;
+        for (k=0; k<merged.size(); k++)
+            if (merged[k].col1_algname == row.col1_algname && merged[k].threads == row.threads) break;
+        if (k == merged.size())
+        {
+            merged.push_back(row);
+            merged[k].col6_filename = filename;
+            merged[k].csamples.clear(); // samples of parts of different sizes can't be compared
+            merged[k].dsamples.clear();
+            continue;
+        }
+
+        string_table_t &m = merged[k];
+        float weight = (float)row.col5_origsize / (m.col5_origsize + row.col5_origsize);
+        m.col2_ctime += row.col2_ctime;
+        m.col3_dtime = (m.col3_dtime && row.col3_dtime) ? m.col3_dtime + row.col3_dtime : 0; // decompression error in any part
+        m.col4_comprsize += row.col4_comprsize;
+        m.col5_origsize += row.col5_origsize;
+        m.cold_ctime = (m.cold_ctime && row.cold_ctime) ? m.cold_ctime + row.cold_ctime : 0;
+        m.cold_dtime = (m.cold_dtime && row.cold_dtime) ? m.cold_dtime + row.cold_dtime : 0;
+        lzbench_merge_counters(m, row, weight);
+        m.file_sizes.insert(m.file_sizes.end(), row.file_sizes.begin(), row.file_sizes.end());
+    }
+
+    params->results.erase(params->results.begin() + first, params->results.end());
+    for (size_t k=0; k<merged.size(); k++)
+    {
+        params->results.push_back(merged[k]);
+        if (params->show_speed)
+            print_speed(params, params->results.back());
+        else
+            print_time(params, params->results.back());
+    }
+}
+
+
+/* print throughput, speedup and parallel efficiency of every compressor against its run with the lowest number of threads */
+void print_scaling(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<bool> printed(res.size(), false);
+
+    printf("\nThread scaling (speedup and efficiency against the run with the lowest number of threads):\n");
+    if (params->textformat == CSV)
+        printf("Compressor name,Threads,Compression speed,Compression speedup,Compression efficiency,Decompression speed,Decompression speedup,Decompression efficiency,Filename\n");
+    else
+        printf("Compressor name         Thr  Compress. Speedup  Eff. Decompress. Speedup  Eff. Filename\n");
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (printed[i]) continue;
+
+        size_t base = i;
+        for (size_t j=i+1; j<res.size(); j++)
+            if (res[j].col1_algname == res[i].col1_algname && res[j].col6_filename == res[i].col6_filename && res[j].threads < res[base].threads)
+                base = j;
+
+        float base_cspeed = res[base].col5_origsize * 1000.0 / res[base].col2_ctime;
+        float base_dspeed = (!res[base].col3_dtime) ? 0 : (res[base].col5_origsize * 1000.0 / res[base].col3_dtime);
+
+        for (size_t j=i; j<res.size(); j++)
+        {
+            if (printed[j] || res[j].col1_algname != res[i].col1_algname || res[j].col6_filename != res[i].col6_filename) continue;
+            printed[j] = true;
+
+            float cspeed = res[j].col5_origsize * 1000.0 / res[j].col2_ctime;
+            float dspeed = (!res[j].col3_dtime) ? 0 : (res[j].col5_origsize * 1000.0 / res[j].col3_dtime);
+            float cspeedup = cspeed / base_cspeed;
+            float dspeedup = (!base_dspeed) ? 0 : dspeed / base_dspeed;
+            float ratio = (float)res[base].threads / res[j].threads;
+
+            if (params->textformat == CSV)
+                printf("%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%s\n", res[j].col1_algname.c_str(), res[j].threads, cspeed, cspeedup, cspeedup*ratio*100, dspeed, dspeedup, dspeedup*ratio*100, res[j].col6_filename.c_str());
+            else
+                printf("%-23s %3d %6d MB/s %6.2fx %4.0f%% %6d MB/s %6.2fx %4.0f%% %s\n", res[j].col1_algname.c_str(), res[j].threads, (int)cspeed, cspeedup, cspeedup*ratio*100, (int)dspeed, dspeedup, dspeedup*ratio*100, res[j].col6_filename.c_str());
+        }
+    }
+}
+
+
+/*
+ * -b#,#,... and --llc-ways: ratio and speed of every codec at every value of a sweep, one line per codec and file,
+ * column() is the index of the value of a row
+ */
+void print_sweep_matrix(lzbench_params_t *params, const char* title, const std::vector<std::string> &labels, const std::vector<std::string> &csv_labels,
+                        std::function<int(const string_table_t&)> column)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<bool> printed(res.size(), false);
+
+    printf("\n%s (ratio, compression and decompression speed in MB/s):\n", title);
+    if (params->textformat == CSV)
+    {
+        printf("Compressor name,");
+        for (size_t b=0; b<csv_labels.size(); b++)
+            printf("Ratio at %s,Compression speed at %s,Decompression speed at %s,", csv_labels[b].c_str(), csv_labels[b].c_str(), csv_labels[b].c_str());
+        printf("Filename\n");
+    }
+    else
+    {
+        printf("%-23s", "Compressor name");
+        for (size_t b=0; b<labels.size(); b++)
+            printf(" %20s", labels[b].c_str());
+        printf(" Filename\n");
+    }
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (printed[i]) continue;
+
+        printf(params->textformat == CSV ? "%s," : "%-23s", res[i].col1_algname.c_str());
+        for (size_t b=0; b<labels.size(); b++)
+        {
+            size_t j = i;
+            while (j < res.size() && (printed[j] || column(res[j]) != (int)b || res[j].col1_algname != res[i].col1_algname || res[j].col6_filename != res[i].col6_filename)) j++;
+            if (j == res.size())
+            {
+                printf(params->textformat == CSV ? ",,," : " %20s", "-");
+                continue;
+            }
+            printed[j] = true;
+
+            float ratio = res[j].col5_origsize ? res[j].col4_comprsize * 100.0 / res[j].col5_origsize : 0;
+            float cspeed = res[j].col2_ctime ? res[j].col5_origsize * 1000.0 / res[j].col2_ctime : 0;
+            float dspeed = res[j].col3_dtime ? res[j].col5_origsize * 1000.0 / res[j].col3_dtime : 0;
+            if (params->textformat == CSV)
+                printf("%.2f,%.2f,%.2f,", ratio, cspeed, dspeed);
+            else
+                printf(" %6.2f %6d %6d", ratio, (int)cspeed, (int)dspeed);
+        }
+        printf(params->textformat == CSV ? "%s\n" : " %s\n", res[i].col6_filename.c_str());
+    }
+}
+
+
+void print_block_matrix(lzbench_params_t *params)
+{
+    std::vector<std::string> labels, csv_labels;
+    for (size_t b=0; b<params->block_sizes.size(); b++)
+        labels.push_back(size_label(params->block_sizes[b])), csv_labels.push_back(std::to_string(params->block_sizes[b]));
+    print_sweep_matrix(params, "Block size sweep", labels, csv_labels, [params](const string_table_t& row) {
+        return (int)(std::find(params->block_sizes.begin(), params->block_sizes.end(), row.block_size) - params->block_sizes.begin()); });
+}
+
+
+void print_llc_matrix(lzbench_params_t *params)
+{
+    std::vector<std::string> labels, csv_labels;
+    for (size_t k=0; k<params->llc_ways.size(); k++)
+        labels.push_back(llc_label(params->llc_ways[k])), csv_labels.push_back(std::to_string(params->llc_ways[k] ? params->llc_ways[k] : llc_total_ways) + " ways");
+    print_sweep_matrix(params, "L3 cache sweep", labels, csv_labels, [params](const string_table_t& row) {
+        return (int)(std::find(params->llc_ways.begin(), params->llc_ways.end(), row.llc_ways) - params->llc_ways.begin()); });
+}
+
+
+void print_offset_matrix(lzbench_params_t *params)
+{
+    std::vector<std::string> labels, csv_labels;
+    for (size_t k=0; k<params->buf_offsets.size(); k++)
+        labels.push_back("+" + std::to_string(params->buf_offsets[k])), csv_labels.push_back("offset " + std::to_string(params->buf_offsets[k]));
+    print_sweep_matrix(params, "Buffer offset sweep", labels, csv_labels, [params](const string_table_t& row) {
+        return (int)(std::find(params->buf_offsets.begin(), params->buf_offsets.end(), row.buf_offset) - params->buf_offsets.begin()); });
+}
+
+
+/* --core-types: speed of every type and of the fastest type over the slowest one */
+void print_core_matrix(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    std::vector<std::string> labels, csv_labels;
+    for (size_t k=0; k<core_types.size(); k++)
+    {
+        labels.push_back(core_types[k].name + " " + std::to_string(core_types[k].cpus.size()) + " CPUs");
+        csv_labels.push_back(core_types[k].name);
+    }
+    print_sweep_matrix(params, "Core type sweep", labels, csv_labels, [](const string_table_t& row) { return row.core_type; });
+    if (core_types.size() < 2) return;
+
+    const char* fast = core_types.front().name.c_str(), *slow = core_types.back().name.c_str();
+    printf("\nSpeed on %s cores over speed on %s cores:\n", fast, slow);
+    if (params->textformat == CSV)
+        printf("Compressor name,Compression %s/%s,Decompression %s/%s,Filename\n", fast, slow, fast, slow);
+    else
+        printf("%-23s %8s %8s Filename\n", "Compressor name", "C ratio", "D ratio");
+    for (size_t i=0; i<res.size(); i++)
+    {
+        if (res[i].core_type != 0) continue;
+        for (size_t j=0; j<res.size(); j++)
+        {
+            if (res[j].core_type != (int)core_types.size() - 1 || res[j].col1_algname != res[i].col1_algname || res[j].col6_filename != res[i].col6_filename) continue;
+            float cratio = res[i].col2_ctime ? (float)res[j].col2_ctime / res[i].col2_ctime : 0;
+            float dratio = res[i].col3_dtime ? (float)res[j].col3_dtime / res[i].col3_dtime : 0;
+            if (params->textformat == CSV)
+                printf("%s,%.3f,%.3f,%s\n", res[i].col1_algname.c_str(), cratio, dratio, res[i].col6_filename.c_str());
+            else
+                printf("%-23s %7.2fx %7.2fx %s\n", res[i].col1_algname.c_str(), cratio, dratio, res[i].col6_filename.c_str());
+            break;
+        }
+    }
+}
+
+
+/* --lz-stats: the parse of every row that has one, after the results */
+void print_lz_stats(lzbench_params_t *params)
+{
+    std::vector<string_table_t> &res = params->results;
+    bool csv = params->textformat == CSV;
+
+    printf("\nLZ parse (literals in %% of the input, mean match length, repeat offsets and buckets in %% of matches):\n");
+    if (csv)
+    {
+        printf("Compressor name,Literals,Matches,Mean match length,Repeats,");
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf("Match length %s,", lz_len_labels[b]);
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf("Offset %s,", lz_off_labels[b]);
+        printf("Filename\n");
+    }
+    else
+    {
+        printf("%-23s Literal   Matches Mean ML Repeat |", "Compressor name");
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf(" %5s", lz_len_labels[b]);
+        printf(" |");
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf(" %5s", lz_off_labels[b]);
+        printf(" | Filename\n");
+    }
+
+    for (size_t i=0; i<res.size(); i++)
+    {
+        lzbench_counters_t &c = res[i].counters;
+        if (!c.lz_parsed) continue;
+        if (csv)
+        {
+            printf("%s,%.2f,%llu,%.2f,%.2f,", res[i].col1_algname.c_str(), c.lz_literals, (unsigned long long)c.lz_matches, c.lz_mean_len, c.lz_repeats);
+            for (int b=0; b<LZ_STAT_BUCKETS; b++) printf("%.2f,", c.lz_len[b]);
+            for (int b=0; b<LZ_STAT_BUCKETS; b++) printf("%.2f,", c.lz_off[b]);
+            printf("%s\n", res[i].col6_filename.c_str());
+            continue;
+        }
+        printf("%-23s %6.2f%% %9llu %7.2f %5.1f%% |", res[i].col1_algname.c_str(), c.lz_literals, (unsigned long long)c.lz_matches, c.lz_mean_len, c.lz_repeats);
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf(" %5.1f", c.lz_len[b]);
+        printf(" |");
+        for (int b=0; b<LZ_STAT_BUCKETS; b++) printf(" %5.1f", c.lz_off[b]);
+        printf(" | %s\n", res[i].col6_filename.c_str());
+    }
+}
+
+
+/* page-locks a buffer of alloc_and_touch() with --pinned=register */
+static void host_register(void *buf, size_t size) {
+#ifdef BENCH_HAS_CUDA
+	if (host_memory != HOST_REGISTERED) return;
+	if (lzbench_cuda_host_register(buf, size)) { host_bufs[buf] = HOST_REGISTERED; return; }
+	fprintf(stderr, "warning: cudaHostRegister of %llu bytes failed, pageable memory is used\n", (unsigned long long)size);
+	host_memory = HOST_PAGEABLE;
+#else
+	(void)buf; (void)size;
+#endif
+}
+
+
+/* writes a byte of every page, so page faults of first use aren't measured */
+void touch_pages(void *buf, size_t size) {
+	volatile char zero = 0;
+	for (size_t i = 0; i < size; i += MIN_PAGE_SIZE) {
+		static_cast<char * volatile>(buf)[i] = zero;
+	}
+}
+
+
+/*
+ * --fresh-output: pages of a buffer are given back to the kernel, so the next write of each faults in a zeroed page
+ * as in a newly allocated buffer; pages that are shared with data before or after the buffer are kept
+ */
+bool drop_pages(void *buf, size_t size) {
+#if defined(__linux__)
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t start = ((uintptr_t)buf + page - 1) & ~(page - 1), end = ((uintptr_t)buf + size) & ~(page - 1);
+	return end <= start || madvise((void*)start, end - start, MADV_DONTNEED) == 0;
+#else
+	(void)buf; (void)size;
+	return false;
+#endif
+}
+
+
+/*
+ * Allocate a buffer of size bytes using malloc (or equivalent call returning a buffer
+ * that can be passed to free_touched). Touches each page so that the each page is actually
+ * physically allocated and mapped into the process. With --hugepages it is backed
+ * by transparent huge pages (madvise) or by reserved pages of hugetlbfs (MAP_HUGETLB).
+ * With --pinned it is page-locked by cudaMallocHost or by cudaHostRegister after that.
+ */
+static void *alloc_pages(size_t size, bool must_zero, bool touch) {
+	void *buf = NULL;
+#ifdef BENCH_HAS_CUDA
+	if (host_memory == HOST_PINNED) {
+		buf = lzbench_cuda_host_alloc(size);
+		if (buf) {
+			host_bufs[buf] = HOST_PINNED;
+			memset(buf, 0, size); // touches all pages
+			return buf;
+		}
+		fprintf(stderr, "warning: cudaMallocHost of %llu bytes failed, pageable memory is used\n", (unsigned long long)size);
+		host_memory = HOST_PAGEABLE;
+	}
+#endif
+#if defined(__linux__)
+	if (huge_pages == HUGE_TLB) {
+		size_t mapsize = (size + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+		buf = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (buf != MAP_FAILED) {
+			huge_maps[buf] = mapsize;
+			host_register(buf, mapsize);
+			return buf; // zeroed and touched by the kernel for the reservation
+		}
+		fprintf(stderr, "warning: MAP_HUGETLB failed (%s), transparent huge pages are used, see /proc/sys/vm/nr_hugepages\n", strerror(errno));
+		huge_pages = HUGE_THP;
+		buf = NULL;
+	}
+	if (huge_pages == HUGE_THP) {
+		if (posix_memalign(&buf, HUGE_PAGE_SIZE, size) != 0) return NULL;
+		madvise(buf, size, MADV_HUGEPAGE);
+		if (must_zero) memset(buf, 0, size);
+	}
+#endif
+	if (!buf) buf = must_zero ? calloc(1, size) : malloc(size);
+	if (buf && touch) touch_pages(buf, size);
+	if (buf) host_register(buf, size);
+	return buf;
+}
+
+
+void *alloc_and_touch(size_t size, bool must_zero) {
+	return alloc_pages(size, must_zero, true);
+}
+
+
+/*
+ * compbuf is sized for the blanket GET_COMPRESS_BOUND, lzbench_test() touches only the part for the bound of the
+ * codec, so untouched pages of codecs with an exact bound never take memory
+ */
+void *alloc_untouched(size_t size) {
+	return alloc_pages(size, false, false);
+}
+
+
+void free_touched(void *buf) {
+#ifdef BENCH_HAS_CUDA
+	std::map<void*, int>::iterator host = host_bufs.find(buf);
+	if (host != host_bufs.end()) {
+		int type = host->second;
+		host_bufs.erase(host);
+		if (type == HOST_PINNED) { lzbench_cuda_host_free(buf); return; }
+		lzbench_cuda_host_unregister(buf);
+	}
+#endif
+#if defined(__linux__)
+	std::map<void*, size_t>::iterator it = huge_maps.find(buf);
+	if (it != huge_maps.end()) {
+		munmap(buf, it->second);
+		huge_maps.erase(it);
+		return;
+	}
+#endif
+	free(buf);
+}
+
+
+/*
+ * --precheck: order-0 entropy or the lz4 ratio of up to 8 samples of 512 bytes spread over a chunk,
+ * a chunk at or over the threshold is stored without running the codec
+ */
+static bool precheck_incompressible(lzbench_params_t *params, const uint8_t *buf, size_t size)
+{
+    const size_t sample = 512, samples = 8;
+    size_t step = size > sample * samples ? size / samples : sample, total = 0;
+
+    precheck_chunks++;
+    if (precheck_mode == PRECHECK_ENTROPY)
+    {
+        uint32_t freq[256] = { 0 };
+        for (size_t pos = 0; pos < size; pos += step)
+        {
+            size_t len = MIN(sample, size - pos);
+            for (size_t i = 0; i < len; i++) freq[buf[pos + i]]++;
+            total += len;
+        }
+        double bits = 0;
+        for (int c = 0; c < 256; c++)
+            if (freq[c]) bits -= freq[c] * log2((double)freq[c] / total);
+        if (!total || bits / total < params->precheck_threshold) return false;
+    }
+#ifndef BENCH_REMOVE_LZ4
+    else
+    {
+        char out[sample + sample / 255 + 16];
+        size_t compressed = 0;
+        for (size_t pos = 0; pos < size; pos += step)
+        {
+            size_t len = MIN(sample, size - pos);
+            int64_t clen = lzbench_lz4fast_compress((char*)buf + pos, len, out, sizeof(out), 1, 0, NULL);
+            compressed += (clen > 0 && (size_t)clen < len) ? clen : len;
+            total += len;
+        }
+        if (!total || compressed * 100.0 / total < params->precheck_threshold) return false;
+    }
+#endif
+    precheck_skipped++;
+    return true;
+}
+
+
+inline int64_t lzbench_compress(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, compress_func compress, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t outsize, size_t param1, size_t param2, char* workmem, lzbench_histogram* hist)
+{
+    bench_timer_t call_start, call_end;
+    int64_t clen;
+    size_t outpart, part, sum = 0;
+    uint8_t *start = inbuf;
+    int cscount = chunk_sizes.size();
+
+    compr_sizes.resize(cscount);
+
+    for (int i=0; i<cscount; i++)
+    {
+        part = chunk_sizes[i];
+        outpart = GET_COMPRESS_BOUND(part);
+        if (outpart > outsize) outpart = outsize;
+
+        if (hist) { GetTime(call_start); }
+        if (precheck_mode && precheck_incompressible(params, inbuf, part))
+            clen = 0;
+        else
+        {
+            LZBENCH_PROBE(compress_begin, i, part);
+            clen = compress((char*)inbuf, part, (char*)outbuf, outpart, param1, param2, workmem);
+            LZBENCH_PROBE(compress_end, i, clen);
+        }
+        if (hist) { GetTime(call_end); hist->add(GetDiffTime(hist->rate, call_start, call_end)); }
+        LZBENCH_PRINT(9, "ENC part=%zu clen=%lld in=%zu\n", (size_t)part, (long long)clen, (size_t)(inbuf-start));
+
+        if (clen <= 0 || clen == part)
+        {
+            if (part > outsize) return 0;
+            memcpy(outbuf, inbuf, part);
+            clen = part;
+        }
+
+        inbuf += part;
+        outbuf += clen;
+        outsize -= clen;
+        compr_sizes[i] = clen;
+        sum += clen;
+    }
+    return sum;
+}
+
+
+/*
+ * --consume: the work of a reader of decompressed chunks, run on every chunk while it is still in cache. Results go
+ * to consume_sink, so that the compiler can't drop the work.
+ */
+static thread_local volatile uint64_t consume_sink;
+
+uint64_t consume_xxh64(const char *data, size_t size)
+{
+    return XXH64(data, size, 0);
+}
+
+/* the scan of a line parser: number of line ends */
+uint64_t consume_scan(const char *data, size_t size)
+{
+    uint64_t lines = 0;
+    for (const char* end = data + size; (data = (const char*)memchr(data, '\n', end - data)) != NULL; data++)
+        lines++;
+    return lines;
+}
+
+/* the consumer run afterwards over all chunks of a thread, for the unfused time */
+void consume_chunks(consume_func consumer, uint8_t *outbuf, std::vector<size_t>& chunk_sizes)
+{
+    uint64_t sum = 0;
+    for (size_t i=0; i<chunk_sizes.size(); i++)
+    {
+        sum += consumer((char*)outbuf, chunk_sizes[i]);
+        outbuf += chunk_sizes[i];
+    }
+    consume_sink = consume_sink + sum;
+}
+
+
+inline int64_t lzbench_decompress(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, compress_func decompress, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t param1, size_t param2, char* workmem, lzbench_histogram* hist)
+{
+    bench_timer_t call_start, call_end;
+    int64_t dlen;
+    size_t part, sum = 0;
+    uint8_t *outstart = outbuf;
+    uint64_t consumed = 0;
+    int cscount = compr_sizes.size();
+
+    for (int i=0; i<cscount; i++)
+    {
+        part = compr_sizes[i];
+        if (part == chunk_sizes[i]) // uncompressed
+        {
+            memcpy(outbuf, inbuf, part);
+            dlen = part;
+        }
+        else
+        {
+            if (hist) { GetTime(call_start); }
+            LZBENCH_PROBE(decompress_begin, i, part);
+            dlen = decompress((char*)inbuf, part, (char*)outbuf, chunk_sizes[i], param1, param2, workmem);
+            LZBENCH_PROBE(decompress_end, i, dlen);
+            if (hist) { GetTime(call_end); hist->add(GetDiffTime(hist->rate, call_start, call_end)); }
+        }
+        LZBENCH_PRINT(9, "DEC part=%zu dlen=%lld out=%zu\n", (size_t)part, (long long)dlen, (size_t)(outbuf - outstart));
+        if (dlen <= 0) return dlen;
+        if (params->consumer) consumed += params->consumer((char*)outbuf, dlen);
+
+        inbuf += part;
+        outbuf += dlen;
+        sum += dlen;
+    }
+
+    if (params->consumer) consume_sink = consume_sink + consumed;
+    return sum;
+}
+
+
+/* arrays of a call of compress_batch or decompress_batch, one per thread */
+struct lzbench_batch_t
+{
+    std::vector<char*> in, out;
+    std::vector<size_t> insize, outsize;
+    std::vector<int64_t> sizes;
+
+    void resize(size_t n) { in.resize(n); out.resize(n); insize.resize(n); outsize.resize(n); sizes.resize(n); }
+};
+
+static thread_local lzbench_batch_t batch_arrays;
+
+
+/*
+ * compress_batch of the codec gets all chunks of the thread in one call. Every chunk is written to a slot of its
+ * bound, the slots are packed afterwards into the layout of lzbench_compress() and chunks that failed are stored.
+ */
+int64_t lzbench_compress_batch(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, const compressor_desc_t* desc, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t outsize, size_t param1, size_t param2, char* workmem)
+{
+    lzbench_batch_t &b = batch_arrays;
+    size_t n = chunk_sizes.size(), slots = 0, pos = 0, sum = 0;
+
+    b.resize(n);
+    compr_sizes.resize(n);
+    for (size_t i=0; i<n; i++)
+    {
+        b.in[i] = (char*)inbuf + pos;
+        b.insize[i] = chunk_sizes[i];
+        b.out[i] = (char*)outbuf + slots;
+        b.outsize[i] = codec_bound(desc, chunk_sizes[i]);
+        pos += chunk_sizes[i];
+        slots += b.outsize[i];
+    }
+    if (slots > outsize) // slots of an input of many tiny chunks may not fit, the chunks are compressed one by one
+        return lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, outbuf, outsize, param1, param2, workmem, NULL);
+
+    LZBENCH_PROBE(compress_begin, -1, pos); // chunk -1: the whole batch
+    if (n && desc->compress_batch(n, b.in.data(), b.insize.data(), b.out.data(), b.outsize.data(), b.sizes.data(), param1, param2, workmem) < 0)
+        std::fill(b.sizes.begin(), b.sizes.end(), 0);
+    LZBENCH_PROBE(compress_end, -1, pos);
+    for (size_t i=0; i<n; i++)
+    {
+        // the packed output is never ahead of the slot of the chunk
+        int64_t clen = b.sizes[i];
+        if (clen <= 0 || clen == (int64_t)chunk_sizes[i])
+        {
+            memcpy(outbuf + sum, b.in[i], chunk_sizes[i]);
+            clen = chunk_sizes[i];
+        }
+        else
+            memmove(outbuf + sum, b.out[i], clen);
+        compr_sizes[i] = clen;
+        sum += clen;
+    }
+    return sum;
+}
+
+
+/* decompress_batch of the codec gets all compressed chunks of the thread in one call, stored chunks are copied */
+int64_t lzbench_decompress_batch(lzbench_params_t *params, std::vector<size_t>& chunk_sizes, const compressor_desc_t* desc, std::vector<size_t> &compr_sizes, uint8_t *inbuf, uint8_t *outbuf, size_t param1, size_t param2, char* workmem)
+{
+    lzbench_batch_t &b = batch_arrays;
+    size_t n = compr_sizes.size(), m = 0, sum = 0;
+
+    b.resize(n);
+    for (size_t i=0; i<n; i++)
+    {
+        if (compr_sizes[i] == chunk_sizes[i]) // uncompressed
+        {
+            memcpy(outbuf, inbuf, compr_sizes[i]);
+            sum += compr_sizes[i];
+        }
+        else
+        {
+            b.in[m] = (char*)inbuf;
+            b.insize[m] = compr_sizes[i];
+            b.out[m] = (char*)outbuf;
+            b.outsize[m] = chunk_sizes[i];
+            m++;
+        }
+        inbuf += compr_sizes[i];
+        outbuf += chunk_sizes[i];
+    }
+
+    LZBENCH_PROBE(decompress_begin, -1, m);
+    int64_t res = m ? desc->decompress_batch(m, b.in.data(), b.insize.data(), b.out.data(), b.outsize.data(), b.sizes.data(), param1, param2, workmem) : 0;
+    LZBENCH_PROBE(decompress_end, -1, m);
+    if (res < 0) return 0;
+    for (size_t k=0; k<m; k++)
+    {
+        LZBENCH_PRINT(9, "DEC batch part=%zu dlen=%lld\n", (size_t)b.insize[k], (long long)b.sizes[k]);
+        if (b.sizes[k] <= 0) return b.sizes[k];
+        sum += b.sizes[k];
+    }
+    return sum;
+}
+
+
+/*
+ * A minimal pool of persistent worker threads. run() executes job(tid) for
+ * tid=0..nthreads-1 and returns when all of them have finished. The calling
+ * thread runs tid=0 itself, so with a single thread no worker is created.
+ */
+class lzbench_thread_pool
+{
+public:
+    lzbench_thread_pool(int nthreads) : nthreads(nthreads), generation(0), pending(0), quit(false)
+    {
+        for (int t=1; t<nthreads; t++)
+            workers.push_back(std::thread(&lzbench_thread_pool::worker, this, t));
+    }
+
+    ~lzbench_thread_pool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            quit = true;
+        }
+        start_cv.notify_all();
+        for (size_t t=0; t<workers.size(); t++)
+            workers[t].join();
+    }
+
+    void run(const std::function<void(int)>& fn)
+    {
+        if (nthreads > 1)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job = fn;
+            pending = nthreads - 1;
+            generation++;
+            start_cv.notify_all();
+        }
+        fn(0);
+        if (nthreads > 1)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (pending > 0) done_cv.wait(lock);
+        }
+    }
+
+private:
+    void worker(int tid)
+    {
+        uint64_t seen = 0;
+        while (true)
+        {
+            std::function<void(int)> fn;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while (!quit && generation == seen) start_cv.wait(lock);
+                if (quit) return;
+                seen = generation;
+                fn = job;
+            }
+            fn(tid);
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (--pending == 0) done_cv.notify_one();
+            }
+        }
+    }
+
+    int nthreads;
+    uint64_t generation;
+    int pending;
+    bool quit;
+    std::function<void(int)> job;
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable start_cv, done_cv;
+};
+
+
+/*
+ * -e "mt#:codec": a chunk is cut into blocks of its size / # (at least 64 KB) that are compressed and decompressed
+ * by the codec on a pool of # threads, for the latency of one large request served by # cores. The container is
+ * the block size and the block count in 32 bits, the index of compressed sizes of the blocks in 32 bits with
+ * BLOCKMT_STORED for a block kept as it is, then the blocks. The workmem of a test is lzbench_blockmt_t with its
+ * own pool and a workmem of the codec for every thread of the pool.
+ */
+#define BLOCKMT_MIN_BLOCK (64*1024)
+#define BLOCKMT_STORED 0x80000000U
+
+typedef struct
+{
+    const compressor_desc_t* desc;
+    int threads;
+} lzbench_blockmt_setup_t;
+
+static lzbench_blockmt_setup_t blockmt_setup; // copied by lzbench_blockmt_init() for every thread
+
+typedef struct
+{
+    const compressor_desc_t* desc;
+    lzbench_thread_pool* pool;
+    std::vector<char*> workmem;
+    std::vector<char> buf; // slots of compressed blocks before they are joined
+} lzbench_blockmt_t;
+
+static inline void blockmt_write32(char* p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (char)(v >> (8 * i)); }
+static inline uint32_t blockmt_read32(const char* p) { uint32_t v = 0; for (int i = 0; i < 4; i++) v |= (uint32_t)(uint8_t)p[i] << (8 * i); return v; }
+
+size_t blockmt_block_size(const compressor_desc_t* desc, size_t insize, int threads)
+{
+    size_t block = MAX((insize + threads - 1) / threads, (size_t)BLOCKMT_MIN_BLOCK);
+    return MIN(block, MIN(codec_chunk_limit(desc), (size_t)BLOCKMT_STORED - 1));
+}
+
+char* lzbench_blockmt_init(size_t insize, size_t level, size_t param2)
+{
+    lzbench_blockmt_t* blockmt = new lzbench_blockmt_t;
+    blockmt->desc = blockmt_setup.desc;
+    blockmt->pool = new lzbench_thread_pool(blockmt_setup.threads);
+    size_t block = blockmt_block_size(blockmt->desc, insize, blockmt_setup.threads);
+    for (int t = 0; t < blockmt_setup.threads; t++)
+        blockmt->workmem.push_back(blockmt->desc->init ? blockmt->desc->init(block, level, param2) : NULL);
+    return (char*)blockmt;
+}
+
+void lzbench_blockmt_deinit(char* workmem)
+{
+    lzbench_blockmt_t* blockmt = (lzbench_blockmt_t*)workmem;
+    if (!blockmt) return;
+    delete blockmt->pool;
+    for (size_t t = 0; t < blockmt->workmem.size(); t++)
+        if (blockmt->desc->deinit) blockmt->desc->deinit(blockmt->workmem[t]);
+    delete blockmt;
+}
+
+int64_t lzbench_blockmt_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_blockmt_t* blockmt = (lzbench_blockmt_t*)workmem;
+    size_t block = blockmt_block_size(blockmt->desc, insize, (int)blockmt->workmem.size());
+    size_t count = (insize + block - 1) / block, slot = codec_bound(blockmt->desc, block) + PAD_SIZE;
+    size_t header = 8 + 4 * count;
+    std::vector<size_t> offsets(count + 1);
+    std::atomic<size_t> next(0);
+
+    if (insize == 0 || outsize < header) return 0;
+    if (blockmt->buf.size() < count * slot) blockmt->buf.resize(count * slot);
+    blockmt->pool->run([&](int tid) {
+        for (size_t i; (i = next++) < count; )
+        {
+            size_t len = MIN(block, insize - i * block);
+            int64_t clen = blockmt->desc->compress(inbuf + i * block, len, blockmt->buf.data() + i * slot, slot, level, param2, blockmt->workmem[tid]);
+            blockmt_write32(outbuf + 8 + 4 * i, (clen <= 0 || (size_t)clen >= len) ? (uint32_t)len | BLOCKMT_STORED : (uint32_t)clen);
+        }
+    });
+
+    offsets[0] = header;
+    for (size_t i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + (blockmt_read32(outbuf + 8 + 4 * i) & ~BLOCKMT_STORED);
+    if (offsets[count] > outsize) return 0;
+    blockmt_write32(outbuf, (uint32_t)block);
+    blockmt_write32(outbuf + 4, (uint32_t)count);
+
+    // the blocks are joined by the threads too
+    next = 0;
+    blockmt->pool->run([&](int) {
+        for (size_t i; (i = next++) < count; )
+        {
+            bool stored = blockmt_read32(outbuf + 8 + 4 * i) & BLOCKMT_STORED;
+            memcpy(outbuf + offsets[i], stored ? inbuf + i * block : blockmt->buf.data() + i * slot, offsets[i + 1] - offsets[i]);
+        }
+    });
+    return offsets[count];
+}
+
+int64_t lzbench_blockmt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t param2, char* workmem)
+{
+    lzbench_blockmt_t* blockmt = (lzbench_blockmt_t*)workmem;
+    if (insize < 8) return 0;
+    size_t block = blockmt_read32(inbuf), count = blockmt_read32(inbuf + 4);
+    if (!block || count != (outsize + block - 1) / block || insize < 8 + 4 * count) return 0;
+
+    std::vector<size_t> offsets(count + 1);
+    offsets[0] = 8 + 4 * count;
+    for (size_t i = 0; i < count; i++)
+        offsets[i + 1] = offsets[i] + (blockmt_read32(inbuf + 8 + 4 * i) & ~BLOCKMT_STORED);
+    if (offsets[count] > insize) return 0;
+
+    std::atomic<size_t> next(0);
+    std::atomic<bool> error(false);
+    blockmt->pool->run([&](int tid) {
+        for (size_t i; (i = next++) < count && !error; )
+        {
+            size_t len = MIN(block, outsize - i * block), clen = offsets[i + 1] - offsets[i];
+            if (blockmt_read32(inbuf + 8 + 4 * i) & BLOCKMT_STORED)
+            {
+                if (clen != len) error = true;
+                else memcpy(outbuf + i * block, inbuf + offsets[i], len);
+            }
+            else if (blockmt->desc->decompress(inbuf + offsets[i], clen, outbuf + i * block, len, level, param2, blockmt->workmem[tid]) != (int64_t)len)
+                error = true;
+        }
+    });
+    return error ? 0 : outsize;
+}
+
+
+/* split chunk_sizes into contiguous slices of similar size in bytes, one per thread */
+void lzbench_split_chunks(std::vector<size_t> &chunk_sizes, std::vector<lzbench_thread_t> &thr, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, const compressor_desc_t* desc)
+{
+    size_t inpos = 0, outpos = 0, k = 0, bound;
+    int nthreads = thr.size();
+
+    for (int t=0; t<nthreads; t++)
+    {
+        size_t goal = (t == nthreads-1) ? insize : (insize / nthreads) * (t+1);
+        thr[t].chunk_sizes.clear();
+        thr[t].inbuf = inbuf + inpos;
+        thr[t].decomp = decomp + inpos;
+        thr[t].compbuf = compbuf + outpos;
+        thr[t].insize = 0;
+        bound = 0;
+        while (k < chunk_sizes.size() && (inpos < goal || thr[t].chunk_sizes.empty()))
+        {
+            thr[t].chunk_sizes.push_back(chunk_sizes[k]);
+            thr[t].insize += chunk_sizes[k];
+            bound += codec_bound(desc, chunk_sizes[k]);
+            inpos += chunk_sizes[k++];
+        }
+        if (!desc || !desc->bound) bound = GET_COMPRESS_BOUND(thr[t].insize);
+        thr[t].comprsize = (t == nthreads-1) ? comprsize - outpos : MIN(bound, comprsize - outpos);
+        outpos += thr[t].comprsize;
+    }
+}
+
+
+/* a queue of chunks [head, tail) owned by a worker, other workers steal from its tail */
+typedef struct lzbench_steal
+{
+    std::mutex mutex;
+    size_t head, tail;
+} lzbench_steal_t;
+
+
+/* chunks with fixed positions of input and output, so that any worker can (de)compress any chunk */
+typedef struct
+{
+    std::vector<size_t> chunk_sizes, in_offsets, out_offsets, out_bounds, compr_sizes;
+} lzbench_chunks_t;
+
+
+void lzbench_reset_queues(std::vector<lzbench_steal_t> &queues, std::vector<lzbench_thread_t> &thr)
+{
+    size_t k = 0;
+    for (size_t t=0; t<queues.size(); t++)
+    {
+        queues[t].head = k;
+        k += thr[t].chunk_sizes.size();
+        queues[t].tail = k;
+    }
+}
+
+
+/* take the next chunk from the own queue or steal the last chunk of the longest queue of other workers */
+bool lzbench_next_chunk(std::vector<lzbench_steal_t> &queues, int tid, size_t &k, int &steals)
+{
+    {
+        std::unique_lock<std::mutex> lock(queues[tid].mutex);
+        if (queues[tid].head < queues[tid].tail) { k = queues[tid].head++; return true; }
+    }
+
+    while (true)
+    {
+        int victim = -1;
+        size_t longest = 0;
+        for (size_t t=0; t<queues.size(); t++)
+        {
+            std::unique_lock<std::mutex> lock(queues[t].mutex);
+            if (queues[t].tail - queues[t].head > longest) { longest = queues[t].tail - queues[t].head; victim = t; }
+        }
+        if (victim < 0) return false;
+
+        std::unique_lock<std::mutex> lock(queues[victim].mutex);
+        if (queues[victim].head < queues[victim].tail) { k = --queues[victim].tail; steals++; return true; }
+    }
+}
+
+
+int64_t lzbench_compress_steal(lzbench_params_t *params, std::vector<lzbench_steal_t> &queues, int tid, lzbench_chunks_t &chunks, compress_func compress, uint8_t *inbuf, uint8_t *outbuf, size_t param1, size_t param2, char* workmem, int &steals, uint64_t &bytes, lzbench_histogram* hist)
+{
+    bench_timer_t call_start, call_end;
+    size_t k;
+    int64_t clen, sum = 0;
+
+    while (lzbench_next_chunk(queues, tid, k, steals))
+    {
+        size_t part = chunks.chunk_sizes[k];
+        uint8_t *in = inbuf + chunks.in_offsets[k];
+        uint8_t *out = outbuf + chunks.out_offsets[k];
+
+        if (hist) { GetTime(call_start); }
+        if (precheck_mode && precheck_incompressible(params, in, part))
+            clen = 0;
+        else
+        {
+            LZBENCH_PROBE(compress_begin, k, part);
+            clen = compress((char*)in, part, (char*)out, chunks.out_bounds[k], param1, param2, workmem);
+            LZBENCH_PROBE(compress_end, k, clen);
+        }
+        if (hist) { GetTime(call_end); hist->add(GetDiffTime(hist->rate, call_start, call_end)); }
+        LZBENCH_PRINT(9, "ENC thread=%d chunk=%zu part=%zu clen=%lld\n", tid, (size_t)k, (size_t)part, (long long)clen);
+
+        if (clen <= 0 || clen == part)
+        {
+            if (part > chunks.out_bounds[k]) return 0;
+            memcpy(out, in, part);
+            clen = part;
+        }
+
+        chunks.compr_sizes[k] = clen;
+        sum += clen;
+        bytes += part;
+    }
+    return sum;
+}
+
+
+int64_t lzbench_decompress_steal(lzbench_params_t *params, std::vector<lzbench_steal_t> &queues, int tid, lzbench_chunks_t &chunks, compress_func decompress, uint8_t *inbuf, uint8_t *outbuf, size_t param1, size_t param2, char* workmem, int &steals, uint64_t &bytes, lzbench_histogram* hist)
+{
+    bench_timer_t call_start, call_end;
+    size_t k;
+    int64_t dlen, sum = 0;
+
+    while (lzbench_next_chunk(queues, tid, k, steals))
+    {
+        size_t part = chunks.compr_sizes[k];
+        uint8_t *in = inbuf + chunks.out_offsets[k];
+        uint8_t *out = outbuf + chunks.in_offsets[k];
+
+        if (part == chunks.chunk_sizes[k]) // uncompressed
+        {
+            memcpy(out, in, part);
+            dlen = part;
+        }
+        else
+        {
+            if (hist) { GetTime(call_start); }
+            LZBENCH_PROBE(decompress_begin, k, part);
+            dlen = decompress((char*)in, part, (char*)out, chunks.chunk_sizes[k], param1, param2, workmem);
+            LZBENCH_PROBE(decompress_end, k, dlen);
+            if (hist) { GetTime(call_end); hist->add(GetDiffTime(hist->rate, call_start, call_end)); }
+        }
+        LZBENCH_PRINT(9, "DEC thread=%d chunk=%zu part=%zu dlen=%lld\n", tid, (size_t)k, (size_t)part, (long long)dlen);
+        if (dlen <= 0) return (dlen < 0) ? dlen : -1; // 0 is returned by a worker without chunks
+        if (params->consumer) consume_sink = consume_sink + params->consumer((char*)out, dlen);
+
+        sum += dlen;
+        bytes += dlen;
+    }
+    return sum;
+}
+
+
+void print_steal_stats(lzbench_params_t *params, std::vector<lzbench_thread_t> &thr, uint64_t total_cnanosec, uint64_t total_dnanosec)
+{
+    int csteals = 0, dsteals = 0;
+
+    if (params->textformat == CSV || params->textformat == JSON) return;
+
+    for (size_t t=0; t<thr.size(); t++)
+        csteals += thr[t].csteals, dsteals += thr[t].dsteals;
+
+    printf("  work stealing: compr. steals=%d busy=", csteals);
+    for (size_t t=0; t<thr.size(); t++)
+        printf("%s%.0f%%", t ? "/" : "", total_cnanosec ? thr[t].busy_cnanosec*100.0/total_cnanosec : 0.0);
+    printf(", decompr. steals=%d busy=", dsteals);
+    for (size_t t=0; t<thr.size(); t++)
+        printf("%s%.0f%%", t ? "/" : "", total_dnanosec ? thr[t].busy_dnanosec*100.0/total_dnanosec : 0.0);
+    printf("\n");
+}
+
+
+/*
+ * --topdown: level 1 of the top-down method (frontend bound, bad speculation, backend bound, retiring) with the
+ * backend split into memory and core bound, from raw events of the cores known below. The slots are the issue
+ * width times the cycles. Intel: frontend = IDQ_UOPS_NOT_DELIVERED.CORE, bad speculation = UOPS_ISSUED.ANY -
+ * UOPS_RETIRED.SLOTS + width * INT_MISC.RECOVERY_CYCLES, retiring = UOPS_RETIRED.SLOTS and backend = the rest.
+ * AMD Zen 4/5: frontend and backend = DE_NO_DISPATCH_PER_SLOT, bad speculation = DE_SRC_OP_DISP - EX_RET_OPS.
+ * The memory share of backend stalls is CYCLE_ACTIVITY.STALLS_MEM_ANY (L1D miss on Golden Cove) of
+ * STALLS_TOTAL on Intel and EX_NO_RETIRE.LOAD_NOT_COMPLETE of NOT_COMPLETE on AMD, without SMT correction.
+ * The events are read in 2 groups that the kernel may multiplex with --perf, their counts are scaled.
+ */
+#define TD_EVENT(event, umask, cmask) ((uint64_t)((event) & 0xFF) | (uint64_t)(umask) << 8 | (uint64_t)(cmask) << 24 | (uint64_t)((event) >> 8) << 32)
+
+typedef struct
+{
+    const char* name;
+    bool amd;
+    int width;
+    uint64_t events[TOPDOWN_EVENTS]; // TD_CYCLES unused, Intel: issued, retired, recovery, AMD: backend, dispatched, retired
+} topdown_arch_t;
+
+static const topdown_arch_t topdown_archs[] = {
+    { "Skylake", false, 4, { 0, TD_EVENT(0x9C, 0x01, 0), TD_EVENT(0x0E, 0x01, 0), TD_EVENT(0xC2, 0x02, 0), TD_EVENT(0x0D, 0x01, 0), TD_EVENT(0xA3, 0x14, 20), TD_EVENT(0xA3, 0x04, 4) } },
+    { "Sunny Cove", false, 5, { 0, TD_EVENT(0x9C, 0x01, 0), TD_EVENT(0x0E, 0x01, 0), TD_EVENT(0xC2, 0x02, 0), TD_EVENT(0x0D, 0x03, 1), TD_EVENT(0xA3, 0x14, 20), TD_EVENT(0xA3, 0x04, 4) } },
+    { "Golden Cove", false, 6, { 0, TD_EVENT(0x9C, 0x01, 0), TD_EVENT(0xAE, 0x01, 0), TD_EVENT(0xC2, 0x02, 0), TD_EVENT(0xAD, 0x01, 1), TD_EVENT(0xA3, 0x0C, 12), TD_EVENT(0xA3, 0x04, 4) } },
+    { "Zen 4", true, 6, { 0, TD_EVENT(0x1A0, 0x01, 0), TD_EVENT(0x1A0, 0x1E, 0), TD_EVENT(0xAA, 0x07, 0), TD_EVENT(0xC1, 0x00, 0), TD_EVENT(0xD6, 0x02, 0), TD_EVENT(0xD6, 0x01, 0) } },
+    { "Zen 5", true, 8, { 0, TD_EVENT(0x1A0, 0x01, 0), TD_EVENT(0x1A0, 0x1E, 0), TD_EVENT(0xAA, 0x07, 0), TD_EVENT(0xC1, 0x00, 0), TD_EVENT(0xD6, 0x02, 0), TD_EVENT(0xD6, 0x01, 0) } } };
+
+/* the core of this CPU by vendor, family and model, hybrid Intel CPUs are left out (their P-cores have a PMU type of their own) */
+static const topdown_arch_t* topdown_detect()
+{
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__)
+    uint32_t a, b, c, d;
+    __cpuid(0, a, b, c, d);
+    bool intel = (b == 0x756E6547), amd = (b == 0x68747541); // "Genu", "Auth"
+    __cpuid(1, a, b, c, d);
+    uint32_t family = (a >> 8) & 0xF, model = (a >> 4) & 0xF;
+    if (family == 0xF) family += (a >> 20) & 0xFF;
+    if (family >= 6) model |= ((a >> 16) & 0xF) << 4;
+
+    if (intel && family == 6)
+        switch (model)
+        {
+            case 0x4E: case 0x5E: case 0x55: case 0x8E: case 0x9E: case 0xA5: case 0xA6: return &topdown_archs[0];
+            case 0x6A: case 0x6C: case 0x7D: case 0x7E: case 0x8C: case 0x8D: case 0xA7: return &topdown_archs[1];
+            case 0x8F: case 0xCF: return &topdown_archs[2]; // Sapphire and Emerald Rapids
+        }
+    if (amd && family == 0x19 && ((model >= 0x10 && model <= 0x1F) || (model >= 0x60 && model <= 0xAF))) return &topdown_archs[3];
+    if (amd && family == 0x1A) return &topdown_archs[4];
+#endif
+    return NULL;
+}
+
+static const topdown_arch_t* topdown_arch()
+{
+    static const topdown_arch_t* arch = topdown_detect();
+    return arch;
+}
+
+/* shares in % of the slots: frontend, bad speculation, backend memory, backend core, retiring; false if unavailable */
+bool topdown_shares(const uint64_t *v, double *pct)
+{
+    const topdown_arch_t* arch = topdown_arch();
+    if (!arch || v[TD_CYCLES] == UINT64_MAX || !v[TD_CYCLES]) return false;
+    double slots = (double)arch->width * v[TD_CYCLES], frontend = v[TD_FRONTEND] / slots, bad, backend, retiring;
+    if (arch->amd)
+    {
+        backend = v[TD_SLOT_A] / slots;
+        bad = ((double)v[TD_SLOT_B] - (double)v[TD_SLOT_C]) / slots;
+        retiring = v[TD_SLOT_C] / slots;
+    }
+    else
+    {
+        bad = ((double)v[TD_SLOT_A] - (double)v[TD_SLOT_B] + arch->width * (double)v[TD_SLOT_C]) / slots;
+        retiring = v[TD_SLOT_B] / slots;
+        backend = 1.0 - frontend - bad - retiring;
+    }
+    bad = MAX(bad, 0.0);
+    backend = MAX(backend, 0.0);
+    double memory = v[TD_ALL_STALLS] ? backend * MIN((double)v[TD_MEM_STALLS] / v[TD_ALL_STALLS], 1.0) : 0;
+    pct[0] = frontend * 100, pct[1] = bad * 100, pct[2] = memory * 100, pct[3] = (backend - memory) * 100, pct[4] = retiring * 100;
+    return true;
+}
+
+
+/*
+ * Hardware performance counters of the calling thread (Linux perf_event_open).
+ * Counters are opened for user space only and work with perf_event_paranoid <= 2.
+ */
+static const char* perf_counter_names[PERF_COUNTERS] = { "cycles", "instructions", "LLC-misses", "branch-misses", "dTLB-misses" };
+
+void topdown_open(lzbench_thread_t &thr)
+{
+    for (int i=0; i<TOPDOWN_EVENTS; i++)
+    {
+        thr.td_fd[i] = -1;
+        thr.ctd[i] = thr.dtd[i] = 0;
+    }
+#if defined(__linux__)
+    const topdown_arch_t* arch = topdown_arch();
+    static bool warned = false;
+    if (!arch)
+    {
+        if (!warned) fprintf(stderr, "warning: --topdown knows no events of this CPU (Intel Skylake, Sunny Cove, Sapphire Rapids, AMD Zen 4/5)\n");
+        warned = true;
+        return;
+    }
+
+    for (int i=0; i<TOPDOWN_EVENTS; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = (i == TD_CYCLES) ? PERF_TYPE_HARDWARE : PERF_TYPE_RAW;
+        attr.config = (i == TD_CYCLES) ? PERF_COUNT_HW_CPU_CYCLES : arch->events[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        int leader = (i == TD_CYCLES || i == TD_MEM_STALLS) ? -1 : thr.td_fd[i < TD_MEM_STALLS ? TD_CYCLES : TD_MEM_STALLS];
+        thr.td_fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (thr.td_fd[i] < 0)
+        {
+            if (!warned) fprintf(stderr, "warning: perf_event_open failed for the %s events of --topdown (%s)\n", arch->name, strerror(errno));
+            warned = true;
+            for (int k=0; k<i; k++) { close(thr.td_fd[k]); thr.td_fd[k] = -1; }
+            return;
+        }
+    }
+#endif
+}
+
+
+/* values of both groups scaled by the time they were scheduled, 0 if unavailable */
+void topdown_read(lzbench_thread_t &thr, uint64_t *values)
+{
+    for (int i=0; i<TOPDOWN_EVENTS; i++) values[i] = 0;
+#if defined(__linux__)
+    static const int leaders[2] = { TD_CYCLES, TD_MEM_STALLS }, ends[2] = { TD_MEM_STALLS, TOPDOWN_EVENTS };
+    for (int g=0; g<2; g++)
+    {
+        uint64_t buf[3 + TOPDOWN_EVENTS]; // nr, time enabled, time running, values
+        int n = ends[g] - leaders[g];
+        if (thr.td_fd[leaders[g]] < 0 || read(thr.td_fd[leaders[g]], buf, (3 + n) * sizeof(uint64_t)) != (ssize_t)((3 + n) * sizeof(uint64_t)) || !buf[2]) continue;
+        for (int k=0; k<n; k++) values[leaders[g] + k] = (uint64_t)(buf[3 + k] * ((double)buf[1] / buf[2]));
+    }
+#endif
+}
+
+
+void perf_open(lzbench_params_t *params, lzbench_thread_t &thr)
+{
+    for (int i=0; i<PERF_COUNTERS; i++)
+    {
+        thr.perf_fd[i] = -1;
+        thr.cperf[i] = thr.dperf[i] = 0;
+    }
+#if defined(__linux__)
+    static const uint32_t types[PERF_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+    static const uint64_t configs[PERF_COUNTERS] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) };
+
+    // one group led by the first counter that opens, all counters are scheduled together when the kernel multiplexes
+    int leader = -1;
+    for (int i=0; i<PERF_COUNTERS; i++)
+    {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        thr.perf_fd[i] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (thr.perf_fd[i] >= 0 && leader < 0) leader = thr.perf_fd[i];
+        if (thr.perf_fd[i] < 0)
+        {
+            static bool warned = false;
+            if (!warned) fprintf(stderr, "warning: perf_event_open failed for %s (check /proc/sys/kernel/perf_event_paranoid)\n", perf_counter_names[i]);
+            warned = true;
+        }
+    }
+    if (params->topdown) topdown_open(thr);
+#else
+    fprintf(stderr, "warning: hardware counters are supported only on Linux\n");
+#endif
+}
+
+
+/* values of the group in the order of perf_counter_names scaled by the time it was scheduled, 0 if unavailable */
+void perf_read(lzbench_thread_t &thr, uint64_t *values)
+{
+    for (int i=0; i<PERF_COUNTERS; i++) values[i] = 0;
+#if defined(__linux__)
+    int leader = -1, n = 0;
+    for (int i=0; i<PERF_COUNTERS; i++)
+        if (thr.perf_fd[i] >= 0) { if (leader < 0) leader = thr.perf_fd[i]; n++; }
+    uint64_t buf[3 + PERF_COUNTERS]; // nr, time enabled, time running, values of the opened counters
+    if (leader < 0 || read(leader, buf, (3 + n) * sizeof(uint64_t)) != (ssize_t)((3 + n) * sizeof(uint64_t)) || !buf[2]) return;
+    for (int i=0, k=0; i<PERF_COUNTERS; i++)
+        if (thr.perf_fd[i] >= 0) values[i] = (uint64_t)(buf[3 + k++] * ((double)buf[1] / buf[2]));
+#endif
+}
+
+
+void perf_close(lzbench_thread_t &thr)
+{
+#if defined(__linux__)
+    for (int i=0; i<PERF_COUNTERS; i++)
+        if (thr.perf_fd[i] >= 0) { close(thr.perf_fd[i]); thr.perf_fd[i] = -1; }
+    for (int i=0; i<TOPDOWN_EVENTS; i++)
+        if (thr.td_fd[i] >= 0) { close(thr.td_fd[i]); thr.td_fd[i] = -1; }
+#endif
+}
+
+
+/* sum counters of all threads, a counter is unavailable if any thread could not open it */
+void perf_sum(std::vector<lzbench_thread_t> &thr, lzbench_counters_t &counters)
+{
+    for (int i=0; i<PERF_COUNTERS; i++)
+    {
+        counters.cvalues[i] = counters.dvalues[i] = 0;
+        for (size_t t=0; t<thr.size(); t++)
+        {
+            if (thr[t].perf_fd[i] < 0) { counters.cvalues[i] = counters.dvalues[i] = UINT64_MAX; break; }
+            counters.cvalues[i] += thr[t].cperf[i];
+            counters.dvalues[i] += thr[t].dperf[i];
+        }
+    }
+    for (int i=0; i<TOPDOWN_EVENTS; i++)
+    {
+        counters.ctopdown[i] = counters.dtopdown[i] = 0;
+        for (size_t t=0; t<thr.size(); t++)
+        {
+            if (thr[t].td_fd[i] < 0) { counters.ctopdown[i] = counters.dtopdown[i] = UINT64_MAX; break; }
+            counters.ctopdown[i] += thr[t].ctd[i];
+            counters.dtopdown[i] += thr[t].dtd[i];
+        }
+    }
+}
+
+
+/*
+ * Energy of all CPU packages from RAPL counters of the Linux powercap interface, available
+ * for Intel and AMD (kernel 5.8+). energy_uj is readable only by root on most distributions.
+ */
+static std::vector<std::string> rapl_files;
+static std::vector<uint64_t> rapl_ranges;
+
+void rapl_init()
+{
+#if defined(__linux__)
+    for (int i=0; i<64; i++)
+    {
+        char path[128];
+        unsigned long long value, range = 0;
+        snprintf(path, sizeof(path), "/sys/class/powercap/intel-rapl:%d/max_energy_range_uj", i);
+        FILE* f = fopen(path, "r");
+        if (!f) break;
+        if (fscanf(f, "%llu", &range) != 1) range = 0;
+        fclose(f);
+        snprintf(path, sizeof(path), "/sys/class/powercap/intel-rapl:%d/energy_uj", i);
+        if (!(f = fopen(path, "r"))) continue;
+        if (fscanf(f, "%llu", &value) == 1) { rapl_files.push_back(path); rapl_ranges.push_back(range); }
+        fclose(f);
+    }
+#endif
+    if (rapl_files.empty()) fprintf(stderr, "warning: RAPL energy counters are not readable (check /sys/class/powercap/intel-rapl:*/energy_uj)\n");
+}
+
+
+void rapl_read(std::vector<uint64_t> &values)
+{
+    values.resize(rapl_files.size());
+    for (size_t i=0; i<rapl_files.size(); i++)
+    {
+        unsigned long long value = 0;
+        FILE* f = fopen(rapl_files[i].c_str(), "r");
+        if (f) { if (fscanf(f, "%llu", &value) != 1) value = 0; fclose(f); }
+        values[i] = value;
+    }
+}
+
+
+/* microjoules between two readings, counters wrap around at max_energy_range_uj */
+uint64_t rapl_diff(std::vector<uint64_t> &start, std::vector<uint64_t> &end)
+{
+    uint64_t sum = 0;
+    for (size_t i=0; i<start.size(); i++)
+        sum += (end[i] >= start[i]) ? end[i] - start[i] : end[i] + rapl_ranges[i] - start[i];
+    return sum;
+}
+
+
+/* pin the calling thread and move its slices of buffers to the selected NUMA node */
+void lzbench_place_thread(lzbench_params_t *params, std::vector<lzbench_thread_t> &thr, int tid)
+{
+#if defined(__linux__)
+    if (params->pin_mode != PIN_NONE)
+        numa_pin_thread(params, tid);
+
+    if (params->numa_mode == NUMA_LOCAL || params->numa_mode == NUMA_REMOTE)
+    {
+        unsigned long nodemask = 1UL << (numa_node_of_thread(params, tid) % (sizeof(unsigned long)*8));
+        numa_bind_memory(params, thr[tid].inbuf, thr[tid].insize, LZBENCH_MPOL_BIND, nodemask);
+        numa_bind_memory(params, thr[tid].compbuf, thr[tid].comprsize, LZBENCH_MPOL_BIND, nodemask);
+        numa_bind_memory(params, thr[tid].decomp, thr[tid].insize, LZBENCH_MPOL_BIND, nodemask);
+    }
+    else if (params->numa_mode == NUMA_INTERLEAVE && tid == 0)
+    {
+        unsigned long nodemask = 0;
+        for (size_t n=0; n<numa_nodes.size() && n<sizeof(unsigned long)*8; n++)
+            nodemask |= 1UL << n;
+        size_t insize = 0, comprsize = 0;
+        for (size_t t=0; t<thr.size(); t++)
+            insize += thr[t].insize, comprsize += thr[t].comprsize;
+        numa_bind_memory(params, thr[0].inbuf, insize, LZBENCH_MPOL_INTERLEAVE, nodemask);
+        numa_bind_memory(params, thr[0].compbuf, comprsize, LZBENCH_MPOL_INTERLEAVE, nodemask);
+        numa_bind_memory(params, thr[0].decomp, insize, LZBENCH_MPOL_INTERLEAVE, nodemask);
+    }
+#endif
+}
+
+
+/* evict caches before a cold pass: flush cache lines of all buffers or read an eviction buffer larger than LLC in every thread */
+void lzbench_evict_caches(lzbench_params_t *params, lzbench_thread_pool &pool, std::vector<lzbench_thread_t> &thr, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp)
+{
+#if defined(__SSE2__)
+    if (params->cold_mode == COLD_FLUSH)
+    {
+        for (size_t i=0; i<insize; i+=64) { _mm_clflush(inbuf+i); _mm_clflush(decomp+i); }
+        for (size_t i=0; i<comprsize; i+=64) _mm_clflush(compbuf+i);
+        _mm_mfence();
+        return;
+    }
+#endif
+    if (!params->cold_buf) return;
+
+    pool.run([&](int t) {
+        volatile uint8_t sum = 0; // evicts also private caches of a thread and its workmem
+        for (size_t i=0; i<params->cold_size; i+=64)
+            sum += params->cold_buf[i];
+    });
+}
+
+
+/*
+ * --bandwidth: STREAM-like baseline of memory bandwidth for every -T# on the buffers of the benchmark.
+ * Every thread reads, writes or copies its slice of the input, the NT kernels use non-temporal stores
+ * that bypass caches (SSE2, otherwise normal stores). Speed is in input bytes per second like of memcpy
+ * and codecs, i.e. a copy moves twice as many bytes, the fastest of passes during 0.1 s is taken.
+ */
+static const char* bandwidth_names[BW_KERNELS] = { "read", "write", "copy", "write_nt", "copy_nt" };
+
+void bandwidth_kernel(int kernel, const uint8_t *src, uint8_t *dst, size_t size)
+{
+    size_t i = 0;
+
+    switch (kernel)
+    {
+        case BW_READ:
+        {
+            uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0, w[4];
+            for (; i + 32 <= size; i += 32)
+            {
+                memcpy(w, src + i, 32);
+                s0 += w[0]; s1 += w[1]; s2 += w[2]; s3 += w[3];
+            }
+            for (; i < size; i++) s0 += src[i];
+            volatile uint64_t sum = s0 + s1 + s2 + s3; // keeps the loads
+            (void)sum;
+            break;
+        }
+#if defined(__SSE2__)
+        case BW_WRITE_NT:
+        case BW_COPY_NT:
+        {
+            size_t head = MIN(size, (16 - ((uintptr_t)dst & 15)) & 15);
+            if (kernel == BW_COPY_NT) memcpy(dst, src, head); else memset(dst, 1, head);
+            __m128i v0 = _mm_set1_epi8(1), v1 = v0, v2 = v0, v3 = v0;
+            for (i = head; i + 64 <= size; i += 64)
+            {
+                if (kernel == BW_COPY_NT)
+                {
+                    v0 = _mm_loadu_si128((const __m128i*)(src + i));
+                    v1 = _mm_loadu_si128((const __m128i*)(src + i + 16));
+                    v2 = _mm_loadu_si128((const __m128i*)(src + i + 32));
+                    v3 = _mm_loadu_si128((const __m128i*)(src + i + 48));
+                }
+                _mm_stream_si128((__m128i*)(dst + i), v0);
+                _mm_stream_si128((__m128i*)(dst + i + 16), v1);
+                _mm_stream_si128((__m128i*)(dst + i + 32), v2);
+                _mm_stream_si128((__m128i*)(dst + i + 48), v3);
+            }
+            if (kernel == BW_COPY_NT) memcpy(dst + i, src + i, size - i); else memset(dst + i, 1, size - i);
+            _mm_sfence();
+            break;
+        }
+#else
+        case BW_WRITE_NT:
+#endif
+        case BW_WRITE:
+            memset(dst, 1, size);
+            break;
+        default: // BW_COPY and BW_COPY_NT without SSE2
+            memcpy(dst, src, size);
+            break;
+    }
+}
+
+
+void lzbench_bandwidth(lzbench_params_t *params, uint8_t *inbuf, size_t insize, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks, loop_ticks;
+    std::vector<size_t> chunk_sizes;
+#if defined(__linux__)
+    cpu_set_t main_mask;
+#endif
+
+    for (size_t left = insize; left > 0; left -= MIN(left, (size_t)1 << 20))
+        chunk_sizes.push_back(MIN(left, (size_t)1 << 20)); // only for the split between threads
+    params->bandwidth_mbs.assign(params->thread_counts_nb, std::vector<float>(BW_KERNELS, 0));
+    if (chunk_sizes.empty()) return;
+
+    for (int k=0; k<params->thread_counts_nb; k++)
+    {
+        int nthreads = (params->thread_counts[k] > 1) ? params->thread_counts[k] : 1;
+        std::vector<lzbench_thread_t> thr(nthreads);
+        lzbench_thread_pool pool(nthreads);
+
+        lzbench_split_chunks(chunk_sizes, thr, inbuf, insize, decomp, insize, decomp, NULL);
+#if defined(__linux__)
+        if (params->pin_mode != PIN_NONE) sched_getaffinity(0, sizeof(main_mask), &main_mask);
+#endif
+        if (params->pin_mode != PIN_NONE || params->numa_mode != NUMA_DEFAULT)
+            pool.run([&](int t) { lzbench_place_thread(params, thr, t); });
+
+        for (int kernel=0; kernel<BW_KERNELS; kernel++)
+        {
+            uint64_t best = UINT64_MAX;
+            int passes = 0;
+            pool.run([&](int t) { bandwidth_kernel(kernel, thr[t].inbuf, thr[t].decomp, thr[t].insize); }); // warm-up
+            GetTime(loop_ticks);
+            do
+            {
+                GetTime(start_ticks);
+                pool.run([&](int t) { bandwidth_kernel(kernel, thr[t].inbuf, thr[t].decomp, thr[t].insize); });
+                GetTime(end_ticks);
+                best = MIN(best, GetDiffTime(rate, start_ticks, end_ticks));
+            }
+            while (++passes < 3 || GetDiffTime(rate, loop_ticks, end_ticks) < DEFAULT_LOOP_TIME);
+            params->bandwidth_mbs[k][kernel] = insize * 1000.0 / (MAX(best, (uint64_t)1));
+        }
+#if defined(__linux__)
+        if (params->pin_mode != PIN_NONE) sched_setaffinity(0, sizeof(main_mask), &main_mask);
+#endif
+    }
+    memset(decomp, 0, insize);
+}
+
+
+/* printed after the memcpy row, the bandwidth is measured before it */
+void print_bandwidth(lzbench_params_t *params)
+{
+    for (size_t k=0; k<params->bandwidth_mbs.size(); k++)
+    {
+        std::vector<float> &mbs = params->bandwidth_mbs[k];
+        int nthreads = (params->thread_counts[k] > 1) ? params->thread_counts[k] : 1;
+        if (params->textformat == JSON)
+        {
+            printf("{\"type\":\"bandwidth\",\"threads\":%d", nthreads);
+            for (int kernel=0; kernel<BW_KERNELS; kernel++)
+                printf(",\"%s_mbs\":%.2f", bandwidth_names[kernel], mbs[kernel]);
+            printf("}\n");
+        }
+        else if (params->textformat == TEXT || params->textformat == TEXT_FULL)
+        {
+            printf("  memory bandwidth -T%d:", nthreads);
+            for (int kernel=0; kernel<BW_KERNELS; kernel++)
+                printf("%s %s %d MB/s", kernel ? "," : "", bandwidth_names[kernel], (int)mbs[kernel]);
+            printf("\n");
+        }
+    }
+}
+
+
+/*
+ * --calibrate: a short suite at startup that lets results of different hosts be compared. memcpy is the decompressor
+ * of comp_desc[0] on a fixed buffer of CALIBRATE_SIZE (single core, mostly out of the caches), the pointer chase walks
+ * a single cycle through the lines of the same buffer made by Sattolo's shuffle (latency of a dependent load) and
+ * the ALU loop runs SipRounds (additions, rotations and xors of 4 words, 14 ops each). Every one takes the fastest
+ * of passes during 0.1 s, the results are printed with the run and are the basis of the normalised speed columns.
+ */
+#define CALIBRATE_SIZE (64 << 20)
+
+static uint64_t calibrate_alu(uint64_t v0, uint64_t rounds)
+{
+    uint64_t v1 = v0 ^ 0x736f6d6570736575ULL, v2 = v0 ^ 0x646f72616e646f6dULL, v3 = v0 ^ 0x7465646279746573ULL;
+    #define ROTL64(x, b) (((x) << (b)) | ((x) >> (64 - (b))))
+    for (uint64_t i = 0; i < rounds; i++)
+    {
+        v0 += v1; v1 = ROTL64(v1, 13); v1 ^= v0; v0 = ROTL64(v0, 32);
+        v2 += v3; v3 = ROTL64(v3, 16); v3 ^= v2;
+        v0 += v3; v3 = ROTL64(v3, 21); v3 ^= v0;
+        v2 += v1; v1 = ROTL64(v1, 17); v1 ^= v2; v2 = ROTL64(v2, 32);
+    }
+    #undef ROTL64
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+
+void lzbench_calibrate(lzbench_params_t *params, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks, loop_ticks;
+    const size_t rounds = 1 << 22, lines = CALIBRATE_SIZE / 64, step = 64 / sizeof(uint64_t);
+    uint8_t *buf = (uint8_t*)alloc_and_touch(2 * (size_t)CALIBRATE_SIZE, false);
+    uint64_t best[3] = { UINT64_MAX, UINT64_MAX, UINT64_MAX };
+
+    if (!buf) { fprintf(stderr, "warning: not enough memory for --calibrate\n"); params->calibrate = CALIBRATE_NONE; return; }
+    for (int k = 0; k < 3; k++)
+    {
+        int passes = 0;
+        if (k == 1)
+        {
+            uint64_t *chase = (uint64_t*)buf;
+            std::vector<uint32_t> order(lines);
+            std::mt19937 rng(1);
+            for (size_t i = 0; i < lines; i++) order[i] = i;
+            for (size_t i = lines - 1; i > 0; i--) std::swap(order[i], order[rng() % i]);
+            for (size_t i = 0; i < lines; i++) chase[order[i] * step] = order[(i + 1) % lines];
+        }
+        GetTime(loop_ticks);
+        do
+        {
+            uint64_t sum = 0;
+            GetTime(start_ticks);
+            if (k == 0) comp_desc[0].decompress((char*)buf, CALIBRATE_SIZE, (char*)buf + CALIBRATE_SIZE, CALIBRATE_SIZE, 0, 0, NULL);
+            else if (k == 1)
+            {
+                const uint64_t *chase = (const uint64_t*)buf;
+                for (size_t i = 0, pos = 0; i < lines; i++) pos = chase[pos * step], sum += pos;
+            }
+            else sum = calibrate_alu(passes, rounds);
+            GetTime(end_ticks);
+            consume_sink = consume_sink + sum;
+            best[k] = MIN(best[k], GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        while (++passes < 3 || GetDiffTime(rate, loop_ticks, end_ticks) < DEFAULT_LOOP_TIME);
+    }
+    free_touched(buf);
+
+    params->cal_memcpy_mbs = CALIBRATE_SIZE * 1000.0 / (MAX(best[0], (uint64_t)1));
+    params->cal_chase_ns = (float)best[1] / lines;
+    params->cal_alu_mops = rounds * 14 * 1000.0 / (MAX(best[2], (uint64_t)1));
+    if (params->textformat != JSON)
+        LZBENCH_PRINT(2, "Calibration: memcpy %d MB/s, pointer chase %.1f ns, ALU %d Mops/s\n\n", (int)params->cal_memcpy_mbs, params->cal_chase_ns, (int)params->cal_alu_mops);
+}
+
+
+/*
+ * --dedup: FastCDC chunking of the input with a gear hash, cut points are looked for from a quarter of the
+ * average size with a harder mask (2 more bits) up to the average and with an easier one after it, chunks
+ * end at 8 times the average. Chunks are fingerprinted with XXH64 and compared in full when fingerprints
+ * match, the first copy of every chunk goes to the output, which the codecs then get as their input.
+ */
+#define DEDUP_PASSES 3
+
+static uint64_t dedup_gear[256];
+
+static size_t dedup_cut(const uint8_t* in, size_t size, size_t avg, uint64_t mask_hard, uint64_t mask_easy)
+{
+    size_t min_size = avg / 4, max_size = avg * 8;
+    if (size <= min_size) return size;
+    if (size > max_size) size = max_size;
+
+    uint64_t hash = 0;
+    size_t i = min_size, normal = MIN(avg, size);
+    for (; i < normal; i++)
+    {
+        hash = (hash << 1) + dedup_gear[in[i]];
+        if (!(hash & mask_hard)) return i + 1;
+    }
+    for (; i < size; i++)
+    {
+        hash = (hash << 1) + dedup_gear[in[i]];
+        if (!(hash & mask_easy)) return i + 1;
+    }
+    return size;
+}
+
+
+/* the unique chunks of inbuf go to outbuf, returns their size */
+size_t lzbench_dedup(lzbench_params_t *params, uint8_t *inbuf, size_t insize, uint8_t *outbuf, bench_rate_t rate)
+{
+    lzbench_dedup_t &d = params->dedup;
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> cuts, unique_pos;
+    std::vector<uint32_t> recipe;
+    std::unordered_map<uint64_t, uint32_t> index;
+    size_t avg = params->dedup_size, outsize = 0;
+    int bits = 0;
+
+    std::mt19937_64 rng(0x6765617268617368ULL);
+    for (int i=0; i<256; i++) dedup_gear[i] = rng();
+    while (((size_t)2 << bits) <= avg) bits++;
+    // the top bits, where the last 64 bytes have an effect
+    int bits_hard = MIN(bits + 2, 63), bits_easy = MAX(bits - 2, 1);
+    uint64_t mask_hard = ~0ULL << (64 - bits_hard);
+    uint64_t mask_easy = ~0ULL << (64 - bits_easy);
+
+    memset(&d, 0, sizeof(d));
+    d.insize = insize;
+    d.chunk_ns = d.dedup_ns = d.restore_ns = UINT64_MAX;
+    cuts.reserve(insize / avg * 2 + 1);
+    index.reserve(insize / avg * 2 + 1);
+    for (int pass=0; pass<DEDUP_PASSES; pass++)
+    {
+        cuts.clear();
+        recipe.clear();
+        unique_pos.clear();
+        index.clear();
+        outsize = 0;
+
+        GetTime(start_ticks);
+        for (size_t pos = 0; pos < insize; )
+        {
+            pos += dedup_cut(inbuf + pos, insize - pos, avg, mask_hard, mask_easy);
+            cuts.push_back(pos);
+        }
+        GetTime(end_ticks);
+        uint64_t chunk_ns = GetDiffTime(rate, start_ticks, end_ticks);
+        d.chunk_ns = MIN(d.chunk_ns, chunk_ns);
+
+        GetTime(start_ticks);
+        for (size_t c = 0, pos = 0; c < cuts.size(); pos = cuts[c++])
+        {
+            size_t size = cuts[c] - pos;
+            uint64_t hash = XXH64(inbuf + pos, size, 0);
+            // a fingerprint collision keeps the chunk as unique, it is found again only by its first copy
+            auto it = index.find(hash);
+            if (it != index.end())
+            {
+                uint32_t u = it->second;
+                size_t usize = (u + 1 < unique_pos.size() ? unique_pos[u + 1] : outsize) - unique_pos[u];
+                if (usize == size && !memcmp(outbuf + unique_pos[u], inbuf + pos, size)) { recipe.push_back(u); continue; }
+            }
+            else
+                index[hash] = (uint32_t)unique_pos.size();
+            recipe.push_back((uint32_t)unique_pos.size());
+            unique_pos.push_back(outsize);
+            memcpy(outbuf + outsize, inbuf + pos, size);
+            outsize += size;
+        }
+        GetTime(end_ticks);
+        uint64_t nanosec = chunk_ns + GetDiffTime(rate, start_ticks, end_ticks);
+        d.dedup_ns = MIN(d.dedup_ns, nanosec);
+    }
+    unique_pos.push_back(outsize);
+
+    // the rebuild of the input from the recipe, checked against the input
+    std::vector<uint8_t> restored(insize);
+    for (int pass=0; pass<DEDUP_PASSES; pass++)
+    {
+        uint8_t *dst = restored.data();
+        GetTime(start_ticks);
+        for (size_t c = 0; c < recipe.size(); c++)
+        {
+            size_t size = unique_pos[recipe[c] + 1] - unique_pos[recipe[c]];
+            memcpy(dst, outbuf + unique_pos[recipe[c]], size);
+            dst += size;
+        }
+        GetTime(end_ticks);
+        d.restore_ns = MIN(d.restore_ns, GetDiffTime(rate, start_ticks, end_ticks));
+    }
+    if (insize && memcmp(restored.data(), inbuf, insize)) fprintf(stderr, "--dedup: the input rebuilt from unique chunks differs\n");
+
+    d.unique_size = outsize;
+    d.chunks = cuts.size();
+    d.unique = unique_pos.size() - 1;
+    d.recipe = (d.chunks + d.unique) * sizeof(uint32_t);
+    return outsize;
+}
+
+
+void print_dedup(lzbench_params_t *params)
+{
+    lzbench_dedup_t &d = params->dedup;
+    float chunk_speed = d.chunk_ns ? d.insize * 1000.0 / d.chunk_ns : 0;
+    float dedup_speed = d.dedup_ns ? d.insize * 1000.0 / d.dedup_ns : 0;
+    float restore_speed = d.restore_ns ? d.insize * 1000.0 / d.restore_ns : 0;
+    float ratio = d.unique_size ? (float)d.insize / d.unique_size : 0;
+
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"dedup\",\"file\":");
+        fprint_json_string(stdout, params->in_filename);
+        printf(",\"avg_chunk\":%llu,\"insize\":%llu,\"unique_size\":%llu,\"chunks\":%llu,\"unique_chunks\":%llu,\"recipe_bytes\":%llu,"
+            "\"chunking_mbs\":%.2f,\"dedup_mbs\":%.2f,\"restore_mbs\":%.2f,\"dedup_ratio\":%.3f}\n",
+            (unsigned long long)params->dedup_size, (unsigned long long)d.insize, (unsigned long long)d.unique_size, (unsigned long long)d.chunks,
+            (unsigned long long)d.unique, (unsigned long long)d.recipe, chunk_speed, dedup_speed, restore_speed, ratio);
+    }
+    else if (params->textformat == TEXT || params->textformat == TEXT_FULL)
+        printf("  dedup of %s in %s chunks: %llu of %llu chunks unique, %llu of %llu bytes, dedup ratio %.3fx, chunking %d MB/s, dedup %d MB/s, rebuild %d MB/s\n",
+            params->in_filename, size_label(params->dedup_size).c_str(), (unsigned long long)d.unique, (unsigned long long)d.chunks, (unsigned long long)d.unique_size,
+            (unsigned long long)d.insize, ratio, (int)chunk_speed, (int)dedup_speed, (int)restore_speed);
+}
+
+
+/*
+ * --long-range: rzip-style pre-pass over a window far beyond the ones of codecs. The hash of every block at
+ * a multiple of the block size goes to a table, a rolling hash of a block looks the table up at every position,
+ * so a repeat of at least twice the block size is always found. A hit that matches is extended backwards and
+ * forwards and replaced with a reference (varints of the literal length, the match length and the distance),
+ * the literals between references are the residual that the codecs get.
+ */
+#define LONG_RANGE_PASSES 3
+#define LONG_RANGE_PRIME 0x100000001B3ULL
+
+static void varint_put(std::vector<uint8_t>& out, uint64_t value)
+{
+    for (; value >= 0x80; value >>= 7) out.push_back((uint8_t)(value | 0x80));
+    out.push_back((uint8_t)value);
+}
+
+
+static uint64_t varint_get(const uint8_t*& in)
+{
+    uint64_t value = 0;
+    for (int shift = 0; ; shift += 7)
+    {
+        uint8_t byte = *in++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+}
+
+
+/* the residual of inbuf goes to outbuf and the references to refs, table holds positions + 1 (0 = empty), returns the residual size */
+static size_t long_range_parse(const uint8_t *inbuf, size_t insize, uint8_t *outbuf, std::vector<uint8_t>& refs, std::vector<uint64_t>& table, int bits,
+                               size_t block, size_t window, size_t& matches)
+{
+    size_t outsize = 0, literal = 0, pos;
+    uint64_t hash = 0, oldest = 1; // oldest = LONG_RANGE_PRIME^block, takes the first byte out of the hash
+
+    refs.clear();
+    matches = 0;
+    for (pos = 0; pos < block; pos++) oldest *= LONG_RANGE_PRIME;
+    for (pos = 0; pos < block && pos < insize; pos++) hash = hash * LONG_RANGE_PRIME + inbuf[pos];
+
+    // hash is of the block that ends at pos
+    while (pos >= block)
+    {
+        size_t start = pos - block;
+        uint64_t slot = (hash * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+        uint64_t cand = table[slot];
+        if (cand && start - (cand - 1) <= window && !memcmp(inbuf + cand - 1, inbuf + start, block))
+        {
+            size_t src = cand - 1, dst = start, len = block;
+            while (dst > literal && src > 0 && inbuf[src - 1] == inbuf[dst - 1]) { src--; dst--; len++; }
+            while (dst + len < insize && inbuf[src + len] == inbuf[dst + len]) len++;
+
+            varint_put(refs, dst - literal);
+            varint_put(refs, len);
+            varint_put(refs, dst - src);
+            memcpy(outbuf + outsize, inbuf + literal, dst - literal);
+            outsize += dst - literal;
+            literal = dst + len;
+            matches++;
+
+            // the hash starts again after the match, blocks inside it are not indexed
+            if (literal + block > insize) break;
+            hash = 0;
+            for (pos = literal; pos < literal + block; pos++) hash = hash * LONG_RANGE_PRIME + inbuf[pos];
+            continue;
+        }
+        if (start % block == 0) table[slot] = start + 1;
+        if (pos == insize) break;
+        hash = hash * LONG_RANGE_PRIME + inbuf[pos] - oldest * inbuf[start];
+        pos++;
+    }
+
+    memcpy(outbuf + outsize, inbuf + literal, insize - literal);
+    return outsize + insize - literal;
+}
+
+
+static void long_range_rebuild(const uint8_t *residual, size_t residual_size, const std::vector<uint8_t>& refs, uint8_t *out)
+{
+    const uint8_t *ref = refs.data(), *end = ref + refs.size(), *residual_end = residual + residual_size;
+
+    while (ref < end)
+    {
+        uint64_t literals = varint_get(ref), len = varint_get(ref), dist = varint_get(ref);
+        memcpy(out, residual, literals);
+        out += literals;
+        residual += literals;
+        if (dist >= len)
+            memcpy(out, out - dist, len);
+        else
+            for (uint64_t i = 0; i < len; i++) out[i] = out[i - dist]; // overlapping like LZ77
+        out += len;
+    }
+    memcpy(out, residual, residual_end - residual);
+}
+
+
+/* the residual of inbuf goes to outbuf, returns its size */
+size_t lzbench_long_range(lzbench_params_t *params, uint8_t *inbuf, size_t insize, uint8_t *outbuf, bench_rate_t rate)
+{
+    lzbench_dedup_t &d = params->dedup;
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<uint8_t> refs;
+    size_t block = params->long_range_block, window = MIN(params->long_range_window, insize), outsize = 0;
+    size_t blocks = window / block;
+    int bits = 1;
+
+    // a slot for every block of the window
+    while (((size_t)1 << bits) < blocks && bits < 40) bits++;
+    std::vector<uint64_t> table((size_t)1 << bits);
+
+    memset(&d, 0, sizeof(d));
+    d.insize = insize;
+    d.memory = table.size() * sizeof(uint64_t);
+    d.dedup_ns = d.restore_ns = UINT64_MAX;
+    for (int pass=0; pass<LONG_RANGE_PASSES; pass++)
+    {
+        GetTime(start_ticks);
+        std::fill(table.begin(), table.end(), 0);
+        outsize = long_range_parse(inbuf, insize, outbuf, refs, table, bits, block, window, d.matches);
+        GetTime(end_ticks);
+        d.dedup_ns = MIN(d.dedup_ns, GetDiffTime(rate, start_ticks, end_ticks));
+    }
+
+    std::vector<uint8_t> restored(insize + 1);
+    for (int pass=0; pass<LONG_RANGE_PASSES; pass++)
+    {
+        GetTime(start_ticks);
+        long_range_rebuild(outbuf, outsize, refs, restored.data());
+        GetTime(end_ticks);
+        d.restore_ns = MIN(d.restore_ns, GetDiffTime(rate, start_ticks, end_ticks));
+    }
+    if (memcmp(restored.data(), inbuf, insize)) fprintf(stderr, "--long-range: the input rebuilt from the residual differs\n");
+
+    d.unique_size = outsize;
+    d.recipe = refs.size();
+    return outsize;
+}
+
+
+void print_long_range(lzbench_params_t *params)
+{
+    lzbench_dedup_t &d = params->dedup;
+    float speed = d.dedup_ns ? d.insize * 1000.0 / d.dedup_ns : 0;
+    float restore_speed = d.restore_ns ? d.insize * 1000.0 / d.restore_ns : 0;
+    float ratio = d.unique_size ? (float)d.insize / (d.unique_size + d.recipe) : 0;
+
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"long_range\",\"file\":");
+        fprint_json_string(stdout, params->in_filename);
+        printf(",\"window\":%llu,\"block\":%llu,\"insize\":%llu,\"residual_size\":%llu,\"references\":%llu,\"reference_bytes\":%llu,"
+            "\"memory\":%llu,\"prepass_mbs\":%.2f,\"restore_mbs\":%.2f,\"ratio\":%.3f}\n",
+            (unsigned long long)params->long_range_window, (unsigned long long)params->long_range_block, (unsigned long long)d.insize,
+            (unsigned long long)d.unique_size, (unsigned long long)d.matches, (unsigned long long)d.recipe, (unsigned long long)d.memory,
+            speed, restore_speed, ratio);
+    }
+    else if (params->textformat == TEXT || params->textformat == TEXT_FULL)
+        printf("  long-range of %s: %llu references in %llu bytes, residual %llu of %llu bytes, ratio %.3fx, pre-pass %d MB/s with %s of memory, rebuild %d MB/s\n",
+            params->in_filename, (unsigned long long)d.matches, (unsigned long long)d.recipe, (unsigned long long)d.unique_size,
+            (unsigned long long)d.insize, ratio, (int)speed, size_label(d.memory).c_str(), (int)restore_speed);
+}
+
+
+/*
+ * --page-cache and --readahead of measurements that read the input file: --mmap-direct reads it in every
+ * compression pass and --pipeline reads it and the compressed file. Cold drops pages of the file from the
+ * page cache with posix_fadvise(DONTNEED) before every such read, also the pages of the mapping of
+ * --mmap-direct that would keep them there, warm reads all of them once before the test.
+ */
+void readahead_fd(lzbench_params_t *params, int fd)
+{
+#if defined(POSIX_FADV_SEQUENTIAL)
+    static const int advice[] = { POSIX_FADV_NORMAL, POSIX_FADV_NORMAL, POSIX_FADV_SEQUENTIAL, POSIX_FADV_RANDOM };
+    if (params->readahead) posix_fadvise(fd, 0, 0, advice[params->readahead]);
+#endif
+}
+
+
+void page_cache_fd(lzbench_params_t *params, int fd, uint8_t *map, size_t size)
+{
+#if defined(POSIX_FADV_DONTNEED)
+    if (params->page_cache == PAGECACHE_COLD)
+    {
+        if (map) madvise(map, size, MADV_DONTNEED); // a private read-only mapping faults the pages in again from the file
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    }
+    else if (params->page_cache == PAGECACHE_WARM)
+    {
+        char buf[1 << 16];
+        for (off_t pos = 0; ; )
+        {
+            ssize_t len = pread(fd, buf, sizeof(buf), pos);
+            if (len <= 0) break;
+            pos += len;
+        }
+        volatile uint8_t sum = 0;
+        for (size_t i = 0; map && i < size; i += 4096)
+            sum += map[i];
+    }
+#endif
+}
+
+
+void lzbench_page_cache(lzbench_params_t *params, uint8_t *map, size_t size)
+{
+#if !defined(_WIN32)
+    int fd = open(params->in_path, O_RDONLY);
+    if (fd < 0) { perror(params->in_path); return; }
+    page_cache_fd(params, fd, map, size);
+    close(fd);
+#endif
+}
+
+
+#define PIPELINE_ALIGN 4096
+#define PIPELINE_STAGE (1<<20)
+#define PIPELINE_ROUND(x) (((x) + PIPELINE_ALIGN - 1) & ~(size_t)(PIPELINE_ALIGN - 1))
+/*
+ * Minimal io_uring made directly with syscalls (no liburing) for --uring: reads and writes
+ * are prepared in the submission queue and handed to the kernel with one io_uring_enter().
+ */
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #define LZBENCH_URING
+#endif
+#endif
+
+#ifdef LZBENCH_URING
+typedef struct
+{
+    int fd;
+    unsigned pending;
+    unsigned *sq_tail, *sq_mask, *sq_array, *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr, *cq_ptr;
+    size_t sq_size, cq_size, sqes_size;
+} uring_t;
+
+
+void uring_exit(uring_t &r)
+{
+    if (r.sqes) munmap(r.sqes, r.sqes_size);
+    if (r.cq_ptr) munmap(r.cq_ptr, r.cq_size);
+    if (r.sq_ptr) munmap(r.sq_ptr, r.sq_size);
+    if (r.fd >= 0) close(r.fd);
+    memset(&r, 0, sizeof(r));
+    r.fd = -1;
+}
+
+
+bool uring_init(uring_t &r, unsigned entries)
+{
+    struct io_uring_params p;
+    memset(&r, 0, sizeof(r));
+    memset(&p, 0, sizeof(p));
+    r.fd = syscall(__NR_io_uring_setup, entries, &p);
+    if (r.fd < 0) return false;
+
+    r.sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r.cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    r.sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    r.sq_ptr = mmap(NULL, r.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQ_RING);
+    r.cq_ptr = mmap(NULL, r.cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_CQ_RING);
+    r.sqes = (struct io_uring_sqe*)mmap(NULL, r.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r.fd, IORING_OFF_SQES);
+    if (r.sq_ptr == MAP_FAILED) r.sq_ptr = NULL;
+    if (r.cq_ptr == MAP_FAILED) r.cq_ptr = NULL;
+    if (r.sqes == MAP_FAILED) r.sqes = NULL;
+    if (!r.sq_ptr || !r.cq_ptr || !r.sqes) { uring_exit(r); return false; }
+
+    r.sq_tail = (unsigned*)((char*)r.sq_ptr + p.sq_off.tail);
+    r.sq_mask = (unsigned*)((char*)r.sq_ptr + p.sq_off.ring_mask);
+    r.sq_array = (unsigned*)((char*)r.sq_ptr + p.sq_off.array);
+    r.cq_head = (unsigned*)((char*)r.cq_ptr + p.cq_off.head);
+    r.cq_tail = (unsigned*)((char*)r.cq_ptr + p.cq_off.tail);
+    r.cq_mask = (unsigned*)((char*)r.cq_ptr + p.cq_off.ring_mask);
+    r.cqes = (struct io_uring_cqe*)((char*)r.cq_ptr + p.cq_off.cqes);
+    return true;
+}
+
+
+void uring_prep(uring_t &r, int opcode, int fd, void* buf, size_t len, uint64_t offset, uint64_t user_data)
+{
+    unsigned tail = *r.sq_tail, idx = tail & *r.sq_mask;
+    struct io_uring_sqe *sqe = &r.sqes[idx];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    r.sq_array[idx] = idx;
+    __atomic_store_n(r.sq_tail, tail + 1, __ATOMIC_RELEASE);
+    r.pending++;
+}
+
+
+/* submit prepared entries and when wait is set block until a completion, returns false on errors */
+bool uring_enter(uring_t &r, bool wait)
+{
+    if (!r.pending && !wait) return true;
+    int ret = syscall(__NR_io_uring_enter, r.fd, r.pending, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (ret < 0) return errno == EINTR;
+    r.pending -= MIN((unsigned)ret, r.pending);
+    return true;
+}
+
+
+/* take the next completion if there is one */
+bool uring_reap(uring_t &r, uint64_t &user_data, int &res)
+{
+    unsigned head = *r.cq_head;
+    if (head == __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE)) return false;
+    struct io_uring_cqe *cqe = &r.cqes[head & *r.cq_mask];
+    user_data = cqe->user_data;
+    res = cqe->res;
+    __atomic_store_n(r.cq_head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+#endif
+
+
+/*
+ * I/O of --pipeline: a sequential reader of rsize blocks and a writer of up to wsize blocks, each
+ * with depth buffers. Without --uring a block is read and written synchronously with pread/pwrite,
+ * with io_uring depth reads are kept in flight and writes finish while the next block is processed.
+ */
+typedef struct
+{
+    int in, out, depth;
+    size_t rsize, wsize;
+    uint64_t rlimit, woffset;
+    uint64_t rsubmit, rconsume; // block numbers of the next read to submit and to return
+    int whead, inflight;
+    bool error;
+    std::vector<uint8_t*> rbufs, wbufs;
+    std::vector<ssize_t> rlens, wlens; // -1 = in flight
+#ifdef LZBENCH_URING
+    uring_t ring;
+    bool uring;
+#endif
+} pipe_io_t;
+
+
+#ifdef LZBENCH_URING
+#define PIPE_WRITE_TAG (1ULL<<32)
+/* wait for one completion and mark its buffer */
+bool pipe_complete(pipe_io_t &io)
+{
+    uint64_t data;
+    int res;
+    while (!uring_reap(io.ring, data, res))
+        if (!uring_enter(io.ring, true)) { io.error = true; return false; }
+    io.inflight--;
+    int slot = data & 0xFFFFFFFF;
+    if (data & PIPE_WRITE_TAG)
+    {
+        if (res != io.wlens[slot]) io.error = true; // a short write on a regular file is an error
+        io.wlens[slot] = 0;
+    }
+    else
+    {
+        if (res < 0) io.error = true;
+        io.rlens[slot] = MAX(res, 0);
+    }
+    return true;
+}
+
+
+void pipe_submit_read(pipe_io_t &io)
+{
+    while (io.rsubmit < io.rconsume + io.depth && io.rsubmit * io.rsize < io.rlimit)
+    {
+        int slot = io.rsubmit % io.depth;
+        io.rlens[slot] = -1;
+        uring_prep(io.ring, IORING_OP_READ, io.in, io.rbufs[slot], io.rsize, io.rsubmit * io.rsize, slot);
+        io.inflight++;
+        io.rsubmit++;
+    }
+    if (!uring_enter(io.ring, false)) io.error = true;
+}
+#endif
+
+
+void pipe_close(pipe_io_t &io)
+{
+#ifdef LZBENCH_URING
+    if (io.uring)
+    {
+        while (io.inflight > 0 && pipe_complete(io)); // the kernel can write to buffers until they complete
+        uring_exit(io.ring);
+        io.uring = false;
+    }
+#endif
+    for (size_t i = 0; i < io.rbufs.size(); i++) free(io.rbufs[i]);
+    for (size_t i = 0; i < io.wbufs.size(); i++) free(io.wbufs[i]);
+    io.rbufs.clear();
+    io.wbufs.clear();
+}
+
+
+bool pipe_open(pipe_io_t &io, lzbench_params_t *params, int in, uint64_t rlimit, size_t rsize, int out, size_t wsize)
+{
+    io.in = in; io.out = out;
+    io.rsize = rsize; io.wsize = wsize;
+    io.rlimit = rlimit;
+    io.woffset = io.rsubmit = io.rconsume = 0;
+    io.whead = io.inflight = 0;
+    io.error = false;
+    io.depth = MAX(params->uring_depth, 1);
+#ifdef LZBENCH_URING
+    io.uring = params->uring_depth > 0 && uring_init(io.ring, 2 * io.depth);
+    if (params->uring_depth > 0 && !io.uring)
+    {
+        fprintf(stderr, "warning: io_uring is not available (%s), --pipeline uses synchronous I/O\n", strerror(errno));
+        params->uring_depth = 0;
+        io.depth = 1;
+    }
+#endif
+    io.rbufs.assign(io.depth, NULL);
+    io.wbufs.assign(io.depth, NULL);
+    io.rlens.assign(io.depth, 0);
+    io.wlens.assign(io.depth, 0);
+    for (int i = 0; i < io.depth; i++)
+        if (posix_memalign((void**)&io.rbufs[i], PIPELINE_ALIGN, rsize) || posix_memalign((void**)&io.wbufs[i], PIPELINE_ALIGN, wsize + PAD_SIZE))
+            { printf("Not enough memory for --pipeline!\n"); pipe_close(io); return false; }
+#ifdef LZBENCH_URING
+    if (io.uring) pipe_submit_read(io);
+#endif
+    return true;
+}
+
+
+/* the next block of input or NULL at the end, it stays valid until the next call */
+uint8_t* pipe_read(pipe_io_t &io, size_t &len)
+{
+    uint64_t offset = io.rconsume * io.rsize;
+    int slot = io.rconsume % io.depth;
+    ssize_t ret;
+
+    len = 0;
+    if (io.error || offset >= io.rlimit) return NULL;
+#ifdef LZBENCH_URING
+    if (io.uring)
+    {
+        pipe_submit_read(io); // reuses the buffer of the previous block
+        while (io.rlens[slot] < 0 && pipe_complete(io));
+        ret = io.rlens[slot];
+    }
+    else
+#endif
+        ret = pread(io.in, io.rbufs[slot], io.rsize, offset);
+    if (io.error || ret <= 0) { io.error = true; return NULL; }
+    len = MIN((uint64_t)ret, io.rlimit - offset);
+    io.rconsume++;
+    return io.rbufs[slot];
+}
+
+
+/* the buffer that is filled for the next pipe_write() */
+uint8_t* pipe_buffer(pipe_io_t &io)
+{
+    return io.wbufs[io.whead];
+}
+
+
+/* write len bytes of the current buffer and return the next one, NULL on errors */
+uint8_t* pipe_write(pipe_io_t &io, size_t len)
+{
+    int slot = io.whead;
+    if (io.error) return NULL;
+#ifdef LZBENCH_URING
+    if (io.uring)
+    {
+        io.wlens[slot] = len;
+        uring_prep(io.ring, IORING_OP_WRITE, io.out, io.wbufs[slot], len, io.woffset, PIPE_WRITE_TAG | slot);
+        io.inflight++;
+        if (!uring_enter(io.ring, false)) io.error = true;
+        io.whead = (io.whead + 1) % io.depth;
+        while (io.wlens[io.whead] != 0 && pipe_complete(io)); // wait until the next buffer is written
+    }
+    else
+#endif
+    if (pwrite(io.out, io.wbufs[slot], len, io.woffset) != (ssize_t)len) io.error = true;
+    io.woffset += len;
+    return io.error ? NULL : io.wbufs[io.whead];
+}
+
+
+/* wait for all writes, returns false if any I/O failed */
+bool pipe_finish(pipe_io_t &io)
+{
+#ifdef LZBENCH_URING
+    if (io.uring)
+        for (int i = 0; i < io.depth; i++)
+            while (io.wlens[i] != 0 && pipe_complete(io));
+#endif
+    return !io.error;
+}
+
+
+/*
+ * File to file pipeline of --pipeline: read the input in chunks, compress them and write a stream of
+ * [size][compressed size][data] to pipeline_dir, then read it back, decompress and write the result
+ * there too. It is single threaded, with --uring the reads and writes overlap (de)compression.
+ * Files are synced before the time is taken.
+ */
+bool lzbench_pipeline(lzbench_params_t *params, const compressor_desc_t* desc, size_t chunk_size, size_t param1, size_t param2, char* workmem, bench_rate_t rate, float &cspeed, float &dspeed)
+{
+#if !defined(_WIN32)
+    bench_timer_t start_ticks, end_ticks;
+    std::string cname = std::string(params->pipeline_dir) + "/lzbench_pipeline.lzb", dname = std::string(params->pipeline_dir) + "/lzbench_pipeline.out";
+    const size_t header = 2*sizeof(uint32_t);
+    size_t block = PIPELINE_ROUND(chunk_size); // the unit of reads of the input and writes of the output
+    size_t bound = GET_COMPRESS_BOUND(chunk_size);
+    size_t stagesize = PIPELINE_ROUND(PIPELINE_STAGE + header + bound);
+    uint8_t *src, *wbuf, *stage = NULL, *obuf;
+    uint64_t total = 0, stream = 0, written = 0;
+    size_t len, fill = 0, pos = 0, ofill = 0;
+    int flags = 0, in = -1, out = -1;
+    struct stat st;
+    pipe_io_t io = pipe_io_t();
+    bool ok = false;
+#ifdef O_DIRECT
+    if (params->pipeline_direct) flags = O_DIRECT;
+#endif
+
+    // compression: input file -> codec -> stream written in PIPELINE_STAGE blocks
+    if ((in = open(params->in_path, O_RDONLY | flags)) < 0 || fstat(in, &st) != 0) { perror(params->in_path); goto done; }
+    readahead_fd(params, in);
+    if ((out = open(cname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | flags, 0644)) < 0) { perror(cname.c_str()); goto done; }
+    if (!pipe_open(io, params, in, st.st_size, block, out, stagesize)) goto done;
+    GetTime(start_ticks);
+    wbuf = pipe_buffer(io);
+    while ((src = pipe_read(io, len)) != NULL)
+    {
+        for (size_t k = 0; k < len; k += chunk_size)
+        {
+            uint32_t part = MIN(chunk_size, len - k);
+            int64_t clen = desc->compress((char*)src + k, part, (char*)wbuf + fill + header, bound, param1, param2, workmem);
+            uint32_t csize = (clen <= 0 || clen >= part) ? 0 : (uint32_t)clen; // 0 = stored
+            memcpy(wbuf + fill, &part, sizeof(part));
+            memcpy(wbuf + fill + sizeof(part), &csize, sizeof(csize));
+            if (!csize) memcpy(wbuf + fill + header, src + k, part);
+            fill += header + (csize ? csize : part);
+            total += part;
+            while (fill >= PIPELINE_STAGE)
+            {
+                uint8_t *next = pipe_write(io, PIPELINE_STAGE);
+                if (!next) { perror(cname.c_str()); goto done; }
+                memcpy(next, wbuf + PIPELINE_STAGE, fill - PIPELINE_STAGE);
+                wbuf = next;
+                fill -= PIPELINE_STAGE;
+                stream += PIPELINE_STAGE;
+            }
+        }
+    }
+    if (io.error) { perror(params->in_path); goto done; }
+    if (fill)
+    {
+        memset(wbuf + fill, 0, PIPELINE_ROUND(fill) - fill); // O_DIRECT writes whole blocks, the file is truncated later
+        if (!pipe_write(io, PIPELINE_ROUND(fill))) { perror(cname.c_str()); goto done; }
+        stream += fill;
+    }
+    if (!pipe_finish(io) || ftruncate(out, stream) != 0 || fdatasync(out) != 0) { perror(cname.c_str()); goto done; }
+    GetTime(end_ticks);
+    cspeed = total * 1000.0 / (MAX(GetDiffTime(rate, start_ticks, end_ticks), 1));
+    pipe_close(io);
+    close(in); close(out);
+    in = out = -1;
+
+    // decompression: stream -> codec -> output file written in blocks as they were read from the input
+    if (posix_memalign((void**)&stage, PIPELINE_ALIGN, stagesize + PAD_SIZE)) { stage = NULL; printf("Not enough memory for --pipeline!\n"); goto done; }
+    if ((in = open(cname.c_str(), O_RDONLY | flags)) < 0) { perror(cname.c_str()); goto done; }
+    readahead_fd(params, in);
+    page_cache_fd(params, in, NULL, 0);
+    if ((out = open(dname.c_str(), O_WRONLY | O_CREAT | O_TRUNC | flags, 0644)) < 0) { perror(dname.c_str()); goto done; }
+    if (!pipe_open(io, params, in, stream, PIPELINE_STAGE, out, block)) goto done;
+    GetTime(start_ticks);
+    fill = 0;
+    obuf = pipe_buffer(io);
+    while (true)
+    {
+        uint32_t part, csize;
+        if (fill - pos < header + bound && stream > 0)
+        {
+            memmove(stage, stage + pos, fill - pos);
+            fill -= pos;
+            pos = 0;
+            while (fill < header + bound && stream > 0)
+            {
+                if ((src = pipe_read(io, len)) == NULL) { perror(cname.c_str()); goto done; }
+                memcpy(stage + fill, src, len);
+                fill += len;
+                stream -= len;
+            }
+        }
+        if (fill - pos < header) break;
+        memcpy(&part, stage + pos, sizeof(part));
+        memcpy(&csize, stage + pos + sizeof(part), sizeof(csize));
+        pos += header;
+        if (!csize)
+            memcpy(obuf + ofill, stage + pos, part);
+        else if (desc->decompress((char*)stage + pos, csize, (char*)obuf + ofill, part, param1, param2, workmem) != part)
+            { printf("ERROR: --pipeline decompression of %s failed\n", desc->name); goto done; }
+        pos += csize ? csize : part;
+        ofill += part;
+        if (ofill == block || (fill - pos < header && stream == 0))
+        {
+            memset(obuf + ofill, 0, PIPELINE_ROUND(ofill) - ofill);
+            if ((obuf = pipe_write(io, PIPELINE_ROUND(ofill))) == NULL) { perror(dname.c_str()); goto done; }
+            written += ofill;
+            ofill = 0;
+        }
+    }
+    if (!pipe_finish(io) || ftruncate(out, written) != 0 || fdatasync(out) != 0) { perror(dname.c_str()); goto done; }
+    GetTime(end_ticks);
+    if (written != total) { printf("ERROR: --pipeline wrote %llu of %llu bytes\n", (unsigned long long)written, (unsigned long long)total); goto done; }
+    dspeed = total * 1000.0 / (MAX(GetDiffTime(rate, start_ticks, end_ticks), 1));
+    ok = true;
+
+done:
+    pipe_close(io);
+    if (in >= 0) close(in);
+    if (out >= 0) close(out);
+    unlink(cname.c_str());
+    unlink(dname.c_str());
+    free(stage);
+    return ok;
+#else
+    return false;
+#endif
+}
+
+
+/*
+ * --random-reads: the input is compressed once into independent chunks of -b# and then chunks
+ * of random indices are decompressed one at a time by a single thread, like reads of a key-value
+ * store. The same sequence of indices is used for every compressor.
+ */
+bool lzbench_random_reads(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                          uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> compr_sizes, coffsets, doffsets;
+    lzbench_histogram hist;
+    std::mt19937 rng(1);
+    uint64_t total = 0;
+    size_t cpos = 0, dpos = 0;
+
+    if (chunk_sizes.empty() || lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+    for (size_t i = 0; i < chunk_sizes.size(); i++)
+    {
+        coffsets.push_back(cpos);
+        doffsets.push_back(dpos);
+        cpos += compr_sizes[i];
+        dpos += chunk_sizes[i];
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, chunk_sizes.size() - 1);
+    for (uint32_t k = 0; k < params->random_reads; k++)
+    {
+        size_t i = pick(rng);
+        int64_t dlen;
+        uint8_t *src = compbuf + coffsets[i], *dst = decomp + doffsets[i];
+
+        GetTime(start_ticks);
+        if (compr_sizes[i] == chunk_sizes[i]) // stored
+            memcpy(dst, src, chunk_sizes[i]), dlen = chunk_sizes[i];
+        else
+            dlen = desc->decompress((char*)src, compr_sizes[i], (char*)dst, chunk_sizes[i], param1, param2, workmem);
+        GetTime(end_ticks);
+        if (dlen != (int64_t)chunk_sizes[i] || memcmp(dst, inbuf + doffsets[i], chunk_sizes[i]) != 0)
+        {
+            printf("ERROR: --random-reads decompression of chunk %d of %s failed\n", (int)i, desc->name);
+            return false;
+        }
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        hist.add(nanosec);
+        total += nanosec;
+    }
+
+    for (int i = 0; i < LATENCY_PERCENTILES; i++)
+        counters.rlat[i] = hist.percentile(latency_percentiles[i]) / 1000.0;
+    counters.rmean = total / 1000.0 / params->random_reads;
+    counters.rrate = params->random_reads * 1000000000.0 / (MAX(total, (uint64_t)1));
+    return true;
+}
+
+
+/*
+ * --sstable: a storage engine over a file of sorted records like an SSTable of RocksDB or pages of Parquet. Lines
+ * of the input (cut to SSTABLE_VALUE_MAX bytes, binary inputs into values of that size) are the values of keys of
+ * 16 digits of their number. Records are encoded into blocks of # KB with keys sharing a prefix with the previous
+ * one and restart points of whole keys every # records, every block is compressed alone (stored if it doesn't
+ * shrink) and the index holds the last key and the place of every block. A point lookup searches the index and
+ * the restart points of one decompressed block, a scan seeks to a key and reads # records from as many blocks as
+ * needed, there is no block cache. The same keys are used for every compressor.
+ */
+#define SSTABLE_KEY 16
+#define SSTABLE_VALUE_MAX 256
+#define SSTABLE_LOOKUPS 20000
+#define SSTABLE_SCANS 2000
+
+struct sstable_block_t
+{
+    size_t offset, size, raw; // size == 0: stored
+};
+
+static size_t sstable_put_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+    for (; v >= 0x80; v >>= 7) p[n++] = (uint8_t)(v | 0x80);
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static const uint8_t* sstable_get_varint(const uint8_t *p, uint64_t &v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    return p;
+}
+
+struct sstable_t
+{
+    const compressor_desc_t* desc;
+    size_t param1, param2;
+    char* workmem;
+    std::vector<uint8_t> file, block;
+    std::vector<sstable_block_t> blocks;
+    std::vector<char> index; // last key of every block
+    std::vector<std::pair<const uint8_t*, uint32_t> > records;
+    const uint8_t *data, *end; // the decoded block and its restart array
+    uint32_t restarts;
+    int decoded;
+
+    bool load(int b)
+    {
+        const sstable_block_t &blk = blocks[b];
+        if (!blk.size) data = &file[blk.offset];
+        else if (desc->decompress((char*)&file[blk.offset], blk.size, (char*)block.data(), blk.raw, param1, param2, workmem) == (int64_t)blk.raw) data = block.data();
+        else return false;
+        memcpy(&restarts, data + blk.raw - 4, 4);
+        end = data + blk.raw - 4 - 4 * (size_t)restarts;
+        decoded = b;
+        return true;
+    }
+
+    uint32_t restart(uint32_t r) { uint32_t offset; memcpy(&offset, end + 4 * (size_t)r, 4); return offset; }
+
+    // the entry at p: its key into key, its value, the next entry
+    const uint8_t* entry(const uint8_t *p, char *key, const uint8_t *&value, uint64_t &vlen)
+    {
+        uint64_t shared, unshared;
+        p = sstable_get_varint(p, shared);
+        p = sstable_get_varint(p, unshared);
+        p = sstable_get_varint(p, vlen);
+        memcpy(key + shared, p, unshared);
+        value = p + unshared;
+        return value + vlen;
+    }
+
+    // the first entry with a key >= key in the block of the index, NULL past the last block
+    const uint8_t* seek(const char *key, char *found, const uint8_t *&value, uint64_t &vlen)
+    {
+        size_t lo = 0, hi = blocks.size();
+        while (lo < hi) { size_t mid = (lo + hi) / 2; if (memcmp(&index[mid * SSTABLE_KEY], key, SSTABLE_KEY) < 0) lo = mid + 1; else hi = mid; }
+        if (lo == blocks.size() || !load(lo)) return NULL;
+        uint32_t left = 0, right = restarts - 1; // the last restart point with a key <= key
+        while (left < right)
+        {
+            uint32_t mid = (left + right + 1) / 2;
+            uint64_t shared, unshared, len;
+            const uint8_t *p = sstable_get_varint(sstable_get_varint(sstable_get_varint(data + restart(mid), shared), unshared), len);
+            if (memcmp(p, key, SSTABLE_KEY) <= 0) left = mid; else right = mid - 1;
+        }
+        for (const uint8_t *p = data + restart(left); p < end; )
+        {
+            const uint8_t *next = entry(p, found, value, vlen);
+            if (memcmp(found, key, SSTABLE_KEY) >= 0) return next;
+            p = next;
+        }
+        return NULL;
+    }
+};
+
+bool lzbench_sstable(lzbench_params_t *params, const compressor_desc_t* desc, uint8_t *inbuf, size_t insize, bench_rate_t rate,
+                     size_t param1, size_t param2, lzbench_counters_t &counters)
+{
+    const size_t block_size = params->sstable_block, restart_interval = params->sstable_restart;
+    sstable_t table;
+    std::vector<uint8_t> raw;
+    std::vector<uint32_t> restarts;
+    bench_timer_t start_ticks, end_ticks;
+    lzbench_histogram hist;
+    std::mt19937 rng(1);
+    char key[21], prev[SSTABLE_KEY], found[SSTABLE_KEY]; // key is sized for any uint64_t, the keys written are SSTABLE_KEY digits
+    uint64_t total = 0, scanned = 0, scan_blocks = 0, index_bytes = 0, restart_bytes = 0, sum = 0;
+    bool ok = true;
+
+    // values are lines without their line end, a part of a longer line or of a binary input
+    for (size_t pos = 0; pos < insize; )
+    {
+        const uint8_t *eol = (const uint8_t*)memchr(inbuf + pos, '\n', MIN(insize - pos, (size_t)SSTABLE_VALUE_MAX));
+        size_t len = eol ? eol - (inbuf + pos) : MIN(insize - pos, (size_t)SSTABLE_VALUE_MAX);
+        table.records.push_back(std::make_pair(inbuf + pos, (uint32_t)len));
+        pos += len + (eol ? 1 : 0);
+    }
+    if (table.records.empty()) return false;
+
+    table.desc = desc, table.param1 = param1, table.param2 = param2;
+    table.workmem = desc->init ? desc->init(block_size + 2 * SSTABLE_VALUE_MAX, param1, param2) : NULL;
+    table.block.resize(block_size + 2 * SSTABLE_VALUE_MAX + PAD_SIZE);
+    raw.reserve(block_size + 2 * SSTABLE_VALUE_MAX);
+
+    GetTime(start_ticks);
+    for (size_t i = 0, count = 0; ok && i < table.records.size(); i++)
+    {
+        uint8_t head[30];
+        size_t shared = 0;
+        snprintf(key, sizeof(key), "%016llu", (unsigned long long)i);
+        if (count++ % restart_interval == 0) restarts.push_back(raw.size());
+        else while (shared < SSTABLE_KEY && key[shared] == prev[shared]) shared++;
+        size_t n = sstable_put_varint(head, shared);
+        n += sstable_put_varint(head + n, SSTABLE_KEY - shared);
+        n += sstable_put_varint(head + n, table.records[i].second);
+        raw.insert(raw.end(), head, head + n);
+        raw.insert(raw.end(), key + shared, key + SSTABLE_KEY);
+        raw.insert(raw.end(), table.records[i].first, table.records[i].first + table.records[i].second);
+        memcpy(prev, key, SSTABLE_KEY);
+        if (raw.size() < block_size && i + 1 < table.records.size()) continue;
+
+        // the restart array closes the block
+        uint32_t nb = restarts.size();
+        raw.insert(raw.end(), (uint8_t*)restarts.data(), (uint8_t*)(restarts.data() + nb));
+        raw.insert(raw.end(), (uint8_t*)&nb, (uint8_t*)&nb + 4);
+        restart_bytes += 4 * (nb + 1);
+        sstable_block_t blk = { table.file.size(), 0, raw.size() };
+        table.file.resize(blk.offset + GET_COMPRESS_BOUND(raw.size()));
+        int64_t clen = desc->compress((char*)raw.data(), raw.size(), (char*)&table.file[blk.offset], GET_COMPRESS_BOUND(raw.size()), param1, param2, table.workmem);
+        if (clen > 0 && (size_t)clen < raw.size()) blk.size = clen;
+        else memcpy(&table.file[blk.offset], raw.data(), raw.size());
+        table.file.resize(blk.offset + (blk.size ? blk.size : raw.size()));
+        table.blocks.push_back(blk);
+        table.index.insert(table.index.end(), key, key + SSTABLE_KEY);
+        index_bytes += SSTABLE_KEY + sstable_put_varint(head, blk.offset) + sstable_put_varint(head, blk.size ? blk.size : raw.size());
+        raw.clear();
+        restarts.clear();
+        count = 0;
+    }
+    GetTime(end_ticks);
+    counters.ss_build_ns = GetDiffTime(rate, start_ticks, end_ticks);
+
+    std::uniform_int_distribution<size_t> pick(0, table.records.size() - 1);
+    for (uint32_t k = 0; ok && k < SSTABLE_LOOKUPS; k++)
+    {
+        size_t i = pick(rng);
+        const uint8_t *value;
+        uint64_t vlen;
+        snprintf(key, sizeof(key), "%016llu", (unsigned long long)i);
+        GetTime(start_ticks);
+        bool hit = table.seek(key, found, value, vlen) && !memcmp(found, key, SSTABLE_KEY);
+        GetTime(end_ticks);
+        if (!hit || vlen != table.records[i].second || memcmp(value, table.records[i].first, vlen) != 0) ok = false;
+        hist.add(GetDiffTime(rate, start_ticks, end_ticks));
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    if (ok)
+    {
+        for (int i = 0; i < LATENCY_PERCENTILES; i++)
+            counters.ss_lat[i] = hist.percentile(latency_percentiles[i]) / 1000.0;
+        counters.ss_rate = SSTABLE_LOOKUPS * 1000000000.0 / (MAX(total, (uint64_t)1));
+    }
+
+    total = 0;
+    for (uint32_t k = 0; ok && k < SSTABLE_SCANS; k++)
+    {
+        size_t i = pick(rng), n = 0;
+        uint8_t copy[SSTABLE_VALUE_MAX];
+        const uint8_t *value;
+        uint64_t vlen;
+        snprintf(key, sizeof(key), "%016llu", (unsigned long long)i);
+        GetTime(start_ticks);
+        const uint8_t *p = table.seek(key, found, value, vlen);
+        int first = table.decoded;
+        while (p && n < params->sstable_scan)
+        {
+            memcpy(copy, value, vlen); // the reader takes every value
+            sum += copy[0];
+            scanned += vlen;
+            if (++n == params->sstable_scan) break;
+            if (p >= table.end)
+            {
+                if ((size_t)table.decoded + 1 == table.blocks.size()) break;
+                if (!table.load(table.decoded + 1)) { p = NULL; break; }
+                p = table.data;
+            }
+            p = table.entry(p, found, value, vlen);
+        }
+        GetTime(end_ticks);
+        if (!p) ok = false;
+        scan_blocks += table.decoded - first + 1;
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    consume_sink = consume_sink + sum;
+    if (desc->deinit) desc->deinit(table.workmem);
+    if (!ok)
+    {
+        printf("ERROR: --sstable read of %s failed\n", desc->name);
+        return false;
+    }
+
+    counters.ss_blocks = table.blocks.size();
+    counters.ss_records = table.records.size();
+    counters.ss_file_bytes = table.file.size() + index_bytes;
+    counters.ss_index_bytes = index_bytes;
+    counters.ss_restart_bytes = restart_bytes;
+    counters.ss_scan_mbs = scanned * 1000.0 / (MAX(total, (uint64_t)1));
+    counters.ss_scan_blocks = (float)scan_blocks / SSTABLE_SCANS;
+    return true;
+}
+
+
+/*
+ * --sandbox: untrusted input decoded in a child process that can't do anything else. The compressed chunks and the
+ * output are in memory shared with the child, requests of chunks to decompress and replies go through pipes. The child
+ * decompresses all chunks once before it locks itself in with seccomp: strict mode allows only read, write and exit
+ * of the thread, so the allocator can't get more memory, filter allows also brk, mmap, munmap, mremap, madvise and
+ * futex. A round trip per chunk and one for all chunks are timed against the same calls in the process. The best of
+ * up to 3 passes of each within -u#, the output of the child is verified.
+ */
+#if defined(__linux__)
+struct sandbox_request_t
+{
+    uint32_t first, count; // count 0 = exit
+};
+
+static bool sandbox_lock(int mode)
+{
+    if (mode == SANDBOX_STRICT) return prctl(PR_SET_SECCOMP, SECCOMP_MODE_STRICT, 0, 0, 0) == 0;
+#if defined(__x86_64__) || defined(__aarch64__)
+#if defined(__x86_64__)
+    const uint32_t arch = AUDIT_ARCH_X86_64;
+#else
+    const uint32_t arch = AUDIT_ARCH_AARCH64;
+#endif
+    static const int allowed[] = { SYS_read, SYS_write, SYS_exit, SYS_exit_group, SYS_rt_sigreturn, SYS_mmap, SYS_munmap, SYS_mremap, SYS_madvise, SYS_futex,
+#ifdef SYS_brk
+        SYS_brk,
+#endif
+    };
+    const int n = sizeof(allowed) / sizeof(allowed[0]);
+    std::vector<struct sock_filter> filter;
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, arch)));
+    filter.push_back((struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, arch, 1, 0));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)));
+    for (int i = 0; i < n; i++) filter.push_back((struct sock_filter)BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)allowed[i], (uint8_t)(n - i), 0));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS));
+    filter.push_back((struct sock_filter)BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW));
+    struct sock_fprog prog = { (unsigned short)filter.size(), filter.data() };
+    return prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0 && prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &prog, 0, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+bool lzbench_sandbox(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, size_t insize,
+                     uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    std::vector<size_t> compr_sizes, coffsets, doffsets;
+    bench_timer_t start_ticks, end_ticks, call_start, call_end;
+    lzbench_histogram hist[2];
+    uint64_t best[3] = { UINT64_MAX, UINT64_MAX, UINT64_MAX }, total[3] = { 0, 0, 0 };
+    const size_t chunks = chunk_sizes.size();
+    int to_child[2], to_parent[2], status;
+    bool ok = true;
+
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+    for (size_t i = 0, cpos = 0, dpos = 0; i < chunks; cpos += compr_sizes[i], dpos += chunk_sizes[i], i++) coffsets.push_back(cpos), doffsets.push_back(dpos);
+    size_t csize = coffsets.back() + compr_sizes.back();
+
+    auto decode = [&](uint8_t *src, uint8_t *dst, uint32_t first, uint32_t count) -> bool {
+        for (uint32_t i = first; i < first + count; i++)
+            if (compr_sizes[i] == chunk_sizes[i]) memcpy(dst + doffsets[i], src + coffsets[i], chunk_sizes[i]); // stored
+            else if (desc->decompress((char*)src + coffsets[i], compr_sizes[i], (char*)dst + doffsets[i], chunk_sizes[i], param1, param2, workmem) != (int64_t)chunk_sizes[i]) return false;
+        return true;
+    };
+
+    // the calls in the process
+    for (int k = 0; k < 3 && (k == 0 || total[0] < (uint64_t)params->dmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        for (uint32_t i = 0; ok && i < chunks; i++)
+        {
+            GetTime(call_start);
+            ok = decode(compbuf, decomp, i, 1);
+            GetTime(call_end);
+            hist[0].add(GetDiffTime(rate, call_start, call_end));
+        }
+        GetTime(end_ticks);
+        best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    if (!ok) return false;
+
+    uint8_t *shared = (uint8_t*)mmap(NULL, csize + insize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) { perror("--sandbox"); return false; }
+    memcpy(shared, compbuf, csize);
+    memset(shared + csize, 0, insize);
+    if (pipe(to_child) != 0 || pipe(to_parent) != 0) { perror("--sandbox"); munmap(shared, csize + insize); return false; }
+
+    fflush(stdout);
+    fflush(stderr);
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        sandbox_request_t req;
+        int64_t reply = decode(shared, shared + csize, 0, chunks); // warm-up, the allocator gets what the codec needs
+        close(to_child[1]);
+        close(to_parent[0]);
+        if (!sandbox_lock(params->sandbox)) reply = -1;
+        if (write(to_parent[1], &reply, sizeof(reply)) != sizeof(reply)) reply = -1;
+        while (reply >= 0 && read(to_child[0], &req, sizeof(req)) == sizeof(req) && req.count)
+        {
+            reply = decode(shared, shared + csize, req.first, req.count) ? req.count : 0;
+            if (write(to_parent[1], &reply, sizeof(reply)) != sizeof(reply)) break;
+        }
+        syscall(SYS_exit, 0); // exit_group() isn't allowed in strict mode
+    }
+    close(to_child[0]);
+    close(to_parent[1]);
+
+    int64_t reply = 0;
+    auto call = [&](uint32_t first, uint32_t count) -> bool {
+        sandbox_request_t req = { first, count };
+        return write(to_child[1], &req, sizeof(req)) == sizeof(req) && read(to_parent[0], &reply, sizeof(reply)) == sizeof(reply) && reply == count;
+    };
+    ok = pid > 0 && read(to_parent[0], &reply, sizeof(reply)) == sizeof(reply) && reply == 1;
+    if (pid > 0 && !ok) fprintf(stderr, "warning: --sandbox: the child of %s %s\n", desc->name, reply < 0 ? "can't enter seccomp" : "failed before seccomp");
+    memset(shared + csize, 0, insize);
+
+    // a round trip per chunk and one for all chunks
+    for (int mode = 1; ok && mode < 3; mode++)
+        for (int k = 0; ok && k < 3 && (k == 0 || total[mode] < (uint64_t)params->dmintime * 1000000); k++)
+        {
+            GetTime(start_ticks);
+            if (mode == 2) ok = call(0, chunks);
+            else for (uint32_t i = 0; ok && i < chunks; i++)
+            {
+                GetTime(call_start);
+                ok = call(i, 1);
+                GetTime(call_end);
+                hist[1].add(GetDiffTime(rate, call_start, call_end));
+            }
+            GetTime(end_ticks);
+            best[mode] = MIN(best[mode], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[mode] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+    bool killed = !ok && pid > 0 && reply >= 0;
+    close(to_child[1]); // the child reads the end of requests
+    close(to_parent[0]);
+    if (pid > 0) waitpid(pid, &status, 0);
+    if (killed && WIFSIGNALED(status))
+        fprintf(stderr, "warning: --sandbox: the child of %s was killed by signal %d (a system call %s)\n", desc->name, WTERMSIG(status),
+            params->sandbox == SANDBOX_STRICT ? "outside of seccomp strict mode, try --sandbox=filter" : "outside of the seccomp filter");
+    if (ok && memcmp(shared + csize, inbuf, insize) != 0)
+    {
+        printf("ERROR: --sandbox decompression of %s failed\n", desc->name);
+        ok = false;
+    }
+    munmap(shared, csize + insize);
+    if (!ok) return false;
+
+    counters.sb_calls = chunks;
+    for (int m = 0; m < 3; m++) counters.sb_ns[m] = best[m];
+    for (int h = 0; h < 2; h++)
+        for (int i = 0; i < LATENCY_PERCENTILES; i++)
+            counters.sb_lat[h][i] = hist[h].percentile(latency_percentiles[i]) / 1000.0;
+    return true;
+}
+#endif
+
+
+/*
+ * --zram: the input is stored in pages like zram and zswap do. A page of the same machine word (zero-filled or
+ * not) is elided and only its value is kept, the others are compressed one by one into a buffer of a bound of a
+ * page and copied to the store, a page that doesn't fit into 4/5 of a page (about huge_class_size of zsmalloc)
+ * is stored as it is. Loads restore all pages in order. The best of up to 3 passes within -t# and -u#.
+ */
+bool lzbench_zram(lzbench_params_t *params, const compressor_desc_t* desc, uint8_t *inbuf, size_t insize, uint8_t *decomp,
+                  bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    const size_t page = params->zram_page, pages = (insize + page - 1) / page, huge = page / 5 * 4;
+    enum { ZRAM_COMPRESSED = 0, ZRAM_SAME, ZRAM_HUGE };
+    std::vector<uint8_t> store(pages * page), scratch(GET_COMPRESS_BOUND(page));
+    std::vector<size_t> offsets(pages), sizes(pages);
+    std::vector<uint8_t> kinds(pages);
+    std::vector<unsigned long> values(pages);
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total[2] = { 0, 0 };
+    size_t stored = 0;
+
+    for (int k = 0; k < 3 && (k == 0 || total[0] < (uint64_t)params->cmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        stored = 0;
+        for (size_t i = 0; i < pages; i++)
+        {
+            const uint8_t* src = inbuf + i * page;
+            size_t len = MIN(page, insize - i * page);
+            bool same = (len % sizeof(unsigned long) == 0);
+            unsigned long first = 0, v;
+            if (same) memcpy(&first, src, sizeof(first));
+            for (size_t w = sizeof(v); same && w < len; w += sizeof(v)) memcpy(&v, src + w, sizeof(v)), same = (v == first);
+            offsets[i] = stored;
+            if (same) { kinds[i] = ZRAM_SAME, values[i] = first, sizes[i] = 0; continue; }
+            int64_t clen = desc->compress((char*)src, len, (char*)scratch.data(), scratch.size(), param1, param2, workmem);
+            if (clen <= 0) return false;
+            if ((size_t)clen >= huge || (size_t)clen >= len) kinds[i] = ZRAM_HUGE, sizes[i] = len, memcpy(&store[stored], src, len);
+            else kinds[i] = ZRAM_COMPRESSED, sizes[i] = clen, memcpy(&store[stored], scratch.data(), clen);
+            stored += sizes[i];
+        }
+        GetTime(end_ticks);
+        best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+
+    for (int k = 0; k < 3 && (k == 0 || total[1] < (uint64_t)params->dmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        for (size_t i = 0; i < pages; i++)
+        {
+            uint8_t* dst = decomp + i * page;
+            size_t len = MIN(page, insize - i * page);
+            if (kinds[i] == ZRAM_SAME)
+            {
+                if (!values[i]) memset(dst, 0, len);
+                else for (size_t w = 0; w < len; w += sizeof(unsigned long)) memcpy(dst + w, &values[i], sizeof(unsigned long));
+            }
+            else if (kinds[i] == ZRAM_HUGE)
+                memcpy(dst, &store[offsets[i]], len);
+            else if (desc->decompress((char*)&store[offsets[i]], sizes[i], (char*)dst, len, param1, param2, workmem) != (int64_t)len)
+                break;
+        }
+        GetTime(end_ticks);
+        if (memcmp(decomp, inbuf, insize) != 0)
+        {
+            printf("ERROR: --zram load of the pages of %s failed\n", desc->name);
+            return false;
+        }
+        best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[1] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+
+    counters.zpages = pages;
+    counters.zzero = counters.zsame = counters.zhuge = 0;
+    for (int c = 0; c < ZRAM_CLASSES; c++) counters.zsizes[c] = 0;
+    for (size_t i = 0; i < pages; i++)
+        if (kinds[i] == ZRAM_SAME) (values[i] ? counters.zsame : counters.zzero)++;
+        else if (kinds[i] == ZRAM_HUGE) counters.zhuge++;
+        else counters.zsizes[MIN(sizes[i] * ZRAM_CLASSES / page, (size_t)ZRAM_CLASSES - 1)]++;
+    counters.zbytes = stored;
+    counters.zstore_ns = best[0];
+    counters.zload_ns = best[1];
+    return true;
+}
+
+
+/*
+ * kernel_#: the path through zram without compression, zero-filled chunks of the sizes of the chunks are written and
+ * read like the input (zram stores them as same-filled pages): copies to and from the aligned buffer, syscalls, the
+ * block layer and mm_stat. The best of up to 3 passes within -t# and -u#.
+ */
+void lzbench_kernel_io(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, bench_rate_t rate,
+                       size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    size_t chunk_size = *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    std::vector<char> zeros(chunk_size), record(GET_COMPRESS_BOUND(chunk_size)), out(chunk_size);
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total[2] = { 0, 0 };
+    int64_t len = 0;
+
+    for (int k = 0; k < 3 && (k == 0 || total[0] < (uint64_t)params->cmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        for (size_t i = 0; i < chunk_sizes.size(); i++)
+            if ((len = desc->compress(zeros.data(), chunk_sizes[i], record.data(), record.size(), param1, param2, workmem)) <= 0) return;
+        GetTime(end_ticks);
+        best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    for (int k = 0; k < 3 && (k == 0 || total[1] < (uint64_t)params->dmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        for (size_t i = 0; i < chunk_sizes.size(); i++)
+            if (desc->decompress(record.data(), len, out.data(), chunk_sizes[i], param1, param2, workmem) != (int64_t)chunk_sizes[i]) return;
+        GetTime(end_ticks);
+        best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[1] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    counters.kio_cns = best[0];
+    counters.kio_dns = best[1];
+}
+
+
+/*
+ * --rotate=#: a pass of # calls over one input lets the branch predictor and prefetchers learn its exact token stream,
+ * so every call of a pass takes the next of # distinct chunks of -b# from the input instead, with a stream of its own
+ * for decompression. Passes of the first chunk # times run the same way for comparison, both modes use the same
+ * output buffers. The best of up to 3 passes of each mode within -t# and -u#, the outputs are verified afterwards.
+ */
+bool lzbench_rotate(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf,
+                    bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    size_t len = chunk_sizes[0], inputs = 0;
+    while (inputs < chunk_sizes.size() && inputs < (size_t)params->rotate && chunk_sizes[inputs] == len) inputs++;
+    if (inputs < 2)
+    {
+        static bool warned = false;
+        if (!warned) fprintf(stderr, "warning: --rotate needs at least 2 chunks of -b# in the input\n");
+        warned = true;
+        return false;
+    }
+
+    size_t bound = GET_COMPRESS_BOUND(len);
+    std::vector<uint8_t> streams(inputs * bound), scratch(bound), out(len);
+    std::vector<size_t> csizes(inputs);
+    bench_timer_t start_ticks, end_ticks;
+    for (size_t i = 0; i < inputs; i++)
+    {
+        int64_t clen = desc->compress((char*)inbuf + i * len, len, (char*)&streams[i * bound], bound, param1, param2, workmem);
+        if (clen <= 0) return false;
+        csizes[i] = clen;
+    }
+
+    for (int mode = 0; mode < 2; mode++) // one input, rotated inputs
+    {
+        uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total[2] = { 0, 0 };
+        for (int k = 0; k < 3 && (k == 0 || total[0] < (uint64_t)params->cmintime * 1000000); k++)
+        {
+            GetTime(start_ticks);
+            for (size_t i = 0; i < inputs; i++)
+                if (desc->compress((char*)inbuf + (mode ? i : 0) * len, len, (char*)scratch.data(), bound, param1, param2, workmem) <= 0) return false;
+            GetTime(end_ticks);
+            best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+        for (int k = 0; k < 3 && (k == 0 || total[1] < (uint64_t)params->dmintime * 1000000); k++)
+        {
+            GetTime(start_ticks);
+            for (size_t i = 0; i < inputs; i++)
+            {
+                size_t j = mode ? i : 0;
+                if (desc->decompress((char*)&streams[j * bound], csizes[j], (char*)out.data(), len, param1, param2, workmem) != (int64_t)len) return false;
+            }
+            GetTime(end_ticks);
+            best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[1] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+        counters.rot_cns[mode] = best[0];
+        counters.rot_dns[mode] = best[1];
+    }
+
+    for (size_t i = 0; i < inputs; i++)
+        if (desc->decompress((char*)&streams[i * bound], csizes[i], (char*)out.data(), len, param1, param2, workmem) != (int64_t)len
+            || memcmp(out.data(), inbuf + i * len, len) != 0)
+        {
+            printf("ERROR: --rotate decompression of chunk %d of %s failed\n", (int)i, desc->name);
+            counters.rot_cns[0] = 0;
+            return false;
+        }
+    counters.rot_inputs = inputs;
+    counters.rot_bytes = inputs * len;
+    return true;
+}
+
+
+/*
+ * --spsc=#: a reader that hands decompressed blocks to a parser. A decoder thread decompresses the chunks of -b# into
+ * the slots of a ring of # blocks and a consumer thread runs --consume (default scan) on them, the ring is a lock-free
+ * single-producer/single-consumer queue with its head and tail on cache lines of their own. The consumer is pinned to
+ * another allowed CPU than the decoder (Linux), so every block crosses cores. Passes of decompression alone and of
+ * decompression with the consumer on one thread give the speeds without the handoff, the busy time of the consumer
+ * on the other core against its time on blocks in the cache of the decoder is the transfer cost. The best of up to
+ * 3 passes of each within -u#.
+ */
+struct spsc_ring_t
+{
+    alignas(64) std::atomic<uint64_t> head; // blocks written by the decoder
+    alignas(64) std::atomic<uint64_t> tail; // blocks released by the consumer
+    alignas(64) std::atomic<bool> ready, failed;
+};
+
+static inline void spsc_wait(int &spins)
+{
+    if (++spins > 64) std::this_thread::yield(); // a single CPU or a preempted peer
+}
+
+bool lzbench_spsc(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                  bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    const size_t depth = params->spsc_depth, blocks = chunk_sizes.size(), slot = *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    consume_func consumer = params->consumer ? params->consumer : consume_scan;
+    std::vector<size_t> compr_sizes, offsets;
+    std::vector<uint8_t> ring(depth * slot);
+    spsc_ring_t queue;
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[3] = { UINT64_MAX, UINT64_MAX, UINT64_MAX }, total[3] = { 0, 0, 0 }, bytes = 0;
+    int cpus[2] = { -1, -1 };
+
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+    for (size_t i = 0, pos = 0; i < blocks; pos += compr_sizes[i++]) offsets.push_back(pos), bytes += chunk_sizes[i];
+
+    auto decode = [&](size_t i, uint8_t *dst) -> bool {
+        if (compr_sizes[i] == chunk_sizes[i]) { memcpy(dst, compbuf + offsets[i], chunk_sizes[i]); return true; } // stored
+        return desc->decompress((char*)compbuf + offsets[i], compr_sizes[i], (char*)dst, chunk_sizes[i], param1, param2, workmem) == (int64_t)chunk_sizes[i];
+    };
+
+#if defined(__linux__)
+    cpu_set_t main_mask, mask;
+    sched_getaffinity(0, sizeof(main_mask), &main_mask);
+    cpus[0] = sched_getcpu();
+    for (int c = 0; c < CPU_SETSIZE && cpus[0] >= 0; c++)
+        if (c != cpus[0] && CPU_ISSET(c, &main_mask)) { cpus[1] = c; break; }
+    if (cpus[0] >= 0)
+    {
+        CPU_ZERO(&mask);
+        CPU_SET(cpus[0], &mask);
+        sched_setaffinity(0, sizeof(mask), &mask);
+    }
+#endif
+    if (cpus[1] < 0)
+    {
+        static bool warned = false;
+        if (!warned) fprintf(stderr, "warning: --spsc has a single CPU, the consumer shares it with the decoder\n");
+        warned = true;
+    }
+
+    // decompression alone and decompression followed by the consumer on one thread
+    for (int mode = 0; mode < 2; mode++)
+        for (int k = 0; k < 3 && (k == 0 || total[mode] < (uint64_t)params->dmintime * 1000000); k++)
+        {
+            uint64_t sum = 0, busy = 0;
+            bench_timer_t call_start, call_end;
+            GetTime(start_ticks);
+            for (size_t i = 0; i < blocks; i++)
+            {
+                uint8_t *dst = &ring[(i % depth) * slot];
+                if (!decode(i, dst)) goto failed;
+                if (!mode) continue;
+                GetTime(call_start);
+                sum += consumer((char*)dst, chunk_sizes[i]);
+                GetTime(call_end);
+                busy += GetDiffTime(rate, call_start, call_end);
+            }
+            GetTime(end_ticks);
+            consume_sink = consume_sink + sum;
+            if (GetDiffTime(rate, start_ticks, end_ticks) < best[mode] && mode) counters.sp_local_ns = busy;
+            best[mode] = MIN(best[mode], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[mode] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+
+    // the decoder fills the ring, the consumer on the other CPU empties it
+    for (int k = 0; k < 3 && (k == 0 || total[2] < (uint64_t)params->dmintime * 1000000); k++)
+    {
+        uint64_t busy = 0, full = 0, empty = 0;
+        queue.head = queue.tail = 0;
+        queue.ready = queue.failed = false;
+        std::thread thread([&]() {
+#if defined(__linux__)
+            cpu_set_t cmask;
+            int cpu = cpus[1] >= 0 ? cpus[1] : cpus[0];
+            CPU_ZERO(&cmask);
+            CPU_SET(cpu >= 0 ? cpu : 0, &cmask);
+            if (sched_setaffinity(0, sizeof(cmask), &cmask) != 0) LZBENCH_PRINT(5, "sched_setaffinity failed for the --spsc consumer on CPU %d\n", cpu);
+#endif
+            uint64_t sum = 0;
+            bench_timer_t call_start, call_end;
+            queue.ready.store(true, std::memory_order_release);
+            for (size_t i = 0; i < blocks; i++)
+            {
+                int spins = 0;
+                if (queue.head.load(std::memory_order_acquire) == i) empty++;
+                while (queue.head.load(std::memory_order_acquire) == i && !queue.failed.load(std::memory_order_relaxed)) spsc_wait(spins);
+                if (queue.failed.load(std::memory_order_relaxed)) break;
+                GetTime(call_start);
+                sum += consumer((char*)&ring[(i % depth) * slot], chunk_sizes[i]);
+                GetTime(call_end);
+                busy += GetDiffTime(rate, call_start, call_end);
+                queue.tail.store(i + 1, std::memory_order_release);
+            }
+            consume_sink = consume_sink + sum;
+        });
+        for (int spins = 0; !queue.ready.load(std::memory_order_acquire); ) spsc_wait(spins);
+
+        GetTime(start_ticks);
+        for (size_t i = 0; i < blocks; i++)
+        {
+            int spins = 0;
+            if (i - queue.tail.load(std::memory_order_acquire) == depth) full++;
+            while (i - queue.tail.load(std::memory_order_acquire) == depth) spsc_wait(spins);
+            if (!decode(i, &ring[(i % depth) * slot])) { queue.failed = true; break; }
+            queue.head.store(i + 1, std::memory_order_release);
+        }
+        for (int spins = 0; !queue.failed && queue.tail.load(std::memory_order_acquire) != blocks; ) spsc_wait(spins);
+        GetTime(end_ticks);
+        thread.join();
+        if (queue.failed) goto failed;
+
+        if (GetDiffTime(rate, start_ticks, end_ticks) < best[2])
+            counters.sp_remote_ns = busy, counters.sp_full = full, counters.sp_empty = empty;
+        best[2] = MIN(best[2], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[2] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+
+#if defined(__linux__)
+    sched_setaffinity(0, sizeof(main_mask), &main_mask);
+#endif
+    counters.sp_blocks = blocks;
+    counters.sp_slot = slot;
+    counters.sp_bytes = bytes;
+    counters.sp_decode_ns = best[0];
+    counters.sp_serial_ns = best[1];
+    counters.sp_ns = best[2];
+    counters.sp_cpus[0] = cpus[0];
+    counters.sp_cpus[1] = cpus[1];
+    return true;
+
+failed:
+#if defined(__linux__)
+    sched_setaffinity(0, sizeof(main_mask), &main_mask);
+#endif
+    printf("ERROR: --spsc decompression of %s failed\n", desc->name);
+    return false;
+}
+
+
+#if defined(__linux__)
+/*
+ * --placement: inbuf, compbuf and decomp are moved with mbind() to the memory nodes of every combination, nodes
+ * without CPUs of tiered memory (CXL, HBM, PMEM) included, and the chunks are compressed and decompressed again on
+ * one thread. Pages go back to the nodes the test left them on afterwards and for a buffer of "-". The best of up
+ * to 3 passes within -t# and -u#, the output of the last pass is verified.
+ */
+bool lzbench_placement(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, size_t insize,
+                       uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    uint8_t* bufs[3] = { inbuf, compbuf, decomp };
+    size_t sizes[3] = { insize, comprsize, insize };
+    std::vector<void*> pages[3];
+    std::vector<int> nodes[3];
+    std::vector<size_t> compr_sizes;
+    bench_timer_t start_ticks, end_ticks;
+    bool ok = true;
+
+    for (int b = 0; b < 3; b++) nodes[b] = numa_page_nodes(bufs[b], sizes[b], pages[b]);
+    counters.pl_count = 0;
+    for (size_t p = 0; ok && p + 3 <= params->placements.size(); p += 3)
+    {
+        uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total[2] = { 0, 0 };
+        for (int b = 0; b < 3; b++)
+        {
+            int node = params->placements[p + b];
+            if (node < 0) numa_restore_pages(params, pages[b], nodes[b]);
+            else numa_bind_memory(params, bufs[b], sizes[b], LZBENCH_MPOL_BIND, 1UL << node);
+        }
+
+        for (int k = 0; ok && k < 3 && (k == 0 || total[0] < (uint64_t)params->cmintime * 1000000); k++)
+        {
+            GetTime(start_ticks);
+            ok = lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) > 0;
+            GetTime(end_ticks);
+            best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+        for (int k = 0; ok && k < 3 && (k == 0 || total[1] < (uint64_t)params->dmintime * 1000000); k++)
+        {
+            GetTime(start_ticks);
+            ok = lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, param1, param2, workmem, NULL) == (int64_t)insize;
+            GetTime(end_ticks);
+            best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+            total[1] += GetDiffTime(rate, start_ticks, end_ticks);
+        }
+        ok = ok && memcmp(decomp, inbuf, insize) == 0;
+
+        uint32_t c = counters.pl_count++;
+        counters.pl_cspeed[c] = insize * 1000.0 / (MAX(best[0], (uint64_t)1));
+        counters.pl_dspeed[c] = insize * 1000.0 / (MAX(best[1], (uint64_t)1));
+        counters.pl_dchunk_us[c] = best[1] / 1000.0 / chunk_sizes.size();
+    }
+
+    for (int b = 0; b < 3; b++) numa_restore_pages(params, pages[b], nodes[b]);
+    if (!ok)
+    {
+        printf("ERROR: --placement run of %s failed\n", desc->name);
+        counters.pl_count = 0;
+        return false;
+    }
+    return true;
+}
+#endif
+
+
+#define TTFB_RUNS 5 // --ttfb: decodes of a chunk to each size, the best one is used
+#define TTFB_CHUNKS 100 // --ttfb: chunks sampled at most
+
+/*
+ * --ttfb: time to the first bytes of streaming decompression, what a client of a streamed response waits for.
+ * The input is compressed once into chunks of -b#, every chunk is decoded by the streaming decoder of the codec
+ * from its first byte until each size of output exists. The best of TTFB_RUNS of a chunk, the median of chunks.
+ */
+bool lzbench_ttfb(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                  uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> compr_sizes;
+    compress_func first_bytes = NULL;
+    size_t pos = 0, dpos = 0;
+
+    for (size_t i = 0; i < sizeof(ttfb_decoders) / sizeof(ttfb_decoders[0]); i++)
+        if (ttfb_decoders[i].decompress && ttfb_decoders[i].decompress == desc->decompress) first_bytes = ttfb_decoders[i].first_bytes;
+    if (!first_bytes || chunk_sizes.empty()) return false;
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+
+    std::vector<std::vector<uint64_t>> times(params->ttfb_sizes.size());
+    size_t step = MAX(chunk_sizes.size() / TTFB_CHUNKS, (size_t)1);
+    for (size_t i = 0; i < chunk_sizes.size(); pos += compr_sizes[i], dpos += chunk_sizes[i], i++)
+    {
+        if (i % step || compr_sizes[i] == chunk_sizes[i]) continue; // stored chunks have no decoder
+        for (size_t s = 0; s < params->ttfb_sizes.size(); s++)
+        {
+            size_t size = params->ttfb_sizes[s];
+            uint64_t best = UINT64_MAX;
+            if (size > chunk_sizes[i]) continue;
+            for (int k = 0; k < TTFB_RUNS; k++)
+            {
+                GetTime(start_ticks);
+                int64_t dlen = first_bytes((char*)compbuf + pos, compr_sizes[i], (char*)decomp, size, param1, param2, workmem);
+                GetTime(end_ticks);
+                if (dlen != (int64_t)size || memcmp(decomp, inbuf + dpos, size) != 0)
+                {
+                    printf("ERROR: --ttfb decompression of chunk %d of %s failed\n", (int)i, desc->name);
+                    return false;
+                }
+                uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+                best = MIN(best, nanosec);
+            }
+            times[s].push_back(best);
+        }
+    }
+
+    for (size_t s = 0; s < times.size(); s++)
+    {
+        if (times[s].empty()) continue;
+        std::sort(times[s].begin(), times[s].end());
+        uint64_t median = MAX(times[s][times[s].size() / 2], (uint64_t)1); // 0 = not measured
+        counters.ttfb_us[s] = median / 1000.0;
+    }
+    return true;
+}
+
+
+/*
+ * --lz-stats: the LZ77 parse of the codec over the chunks of the test. LZ4 blocks are parsed from the compressed
+ * data, zstd hands out its sequences with ZSTD_generateSequences(). A repeat is a match at one of the 3 previous
+ * offsets of the chunk, what a coder with repcodes like zstd codes without an offset.
+ */
+struct lzbench_lz_parse
+{
+    uint64_t literals, matched, matches, repeats, len[LZ_STAT_BUCKETS], off[LZ_STAT_BUCKETS];
+    uint32_t rep[3];
+
+    lzbench_lz_parse() { memset(this, 0, sizeof(*this)); }
+
+    void chunk() { rep[0] = rep[1] = rep[2] = 0; }
+
+    void add(uint32_t litlen, uint32_t mlen, uint32_t offset)
+    {
+        literals += litlen;
+        if (!mlen) return;
+        matched += mlen;
+        matches++;
+        int b = 0;
+        while (mlen > lz_len_limits[b]) b++;
+        len[b]++;
+        for (b = 0; offset > lz_off_limits[b]; ) b++;
+        off[b]++;
+
+        if (offset == rep[0]) { repeats++; return; }
+        if (offset == rep[1] || offset == rep[2]) repeats++;
+        if (offset != rep[1]) rep[2] = rep[1];
+        rep[1] = rep[0];
+        rep[0] = offset;
+    }
+};
+
+
+/* sequences of an LZ4 block: a token with 4 bits of literal length and of match length - 4, extended by bytes of 255 */
+static bool lz4_block_parse(const uint8_t* p, size_t size, lzbench_lz_parse &parse)
+{
+    const uint8_t* end = p + size;
+    while (p < end)
+    {
+        uint32_t token = *p++, lit = token >> 4, mlen = token & 15, b;
+        if (lit == 15)
+            do { if (p >= end) return false; b = *p++; lit += b; } while (b == 255);
+        if ((size_t)(end - p) < lit) return false;
+        p += lit;
+        if (p == end) { parse.add(lit, 0, 0); break; } // last literals
+        if (end - p < 2) return false;
+        uint32_t offset = p[0] | (p[1] << 8);
+        p += 2;
+        if (mlen == 15)
+            do { if (p >= end) return false; b = *p++; mlen += b; } while (b == 255);
+        parse.add(lit, mlen + 4, offset);
+    }
+    return true;
+}
+
+
+bool lzbench_lz_stats(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                      size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    lzbench_lz_parse parse;
+    size_t pos = 0, cpos = 0;
+
+    if (chunk_sizes.empty()) return false;
+    if (desc->decompress == lzbench_lz4_decompress)
+    {
+        std::vector<size_t> compr_sizes;
+        if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+        for (size_t i = 0; i < chunk_sizes.size(); i++)
+        {
+            parse.chunk();
+            if (compr_sizes[i] == chunk_sizes[i]) // stored
+                parse.add(chunk_sizes[i], 0, 0);
+            else if (!lz4_block_parse(compbuf + cpos, compr_sizes[i], parse))
+                return false;
+            cpos += compr_sizes[i];
+        }
+    }
+#ifndef BENCH_REMOVE_ZSTD
+    else if (desc->compress == lzbench_zstd_compress && !lzbench_dict)
+    {
+        std::vector<uint32_t> seqs;
+        for (size_t i = 0; i < chunk_sizes.size(); i++)
+        {
+            seqs.resize(3 * lzbench_zstd_sequence_bound(chunk_sizes[i]));
+            int64_t n = lzbench_zstd_sequences((char*)inbuf + pos, chunk_sizes[i], param1, param2, seqs.data(), seqs.size() / 3);
+            if (n < 0) return false;
+            parse.chunk();
+            for (int64_t k = 0; k < n; k++)
+                parse.add(seqs[3*k], seqs[3*k+1], seqs[3*k+2]);
+            pos += chunk_sizes[i];
+        }
+    }
+#endif
+    else
+        return false;
+
+    uint64_t total = parse.literals + parse.matched, matches = MAX(parse.matches, (uint64_t)1);
+    counters.lz_parsed = 1;
+    counters.lz_matches = parse.matches;
+    counters.lz_literals = total ? 100.0 * parse.literals / total : 0;
+    counters.lz_mean_len = (float)parse.matched / matches;
+    counters.lz_repeats = 100.0 * parse.repeats / matches;
+    for (int b = 0; b < LZ_STAT_BUCKETS; b++)
+    {
+        counters.lz_len[b] = 100.0 * parse.len[b] / matches;
+        counters.lz_off[b] = 100.0 * parse.off[b] / matches;
+    }
+    return true;
+}
+
+
+/*
+ * --chunk-map=file: offset, size, compressed size and the best of CHUNK_MAP_RUNS compression and decompression
+ * times of every chunk, a map of compressibility and speed along the input that shows where incompressible
+ * regions, headers or embedded media are. Lines are CSV or JSON Lines for a file name that ends with .jsonl.
+ */
+#define CHUNK_MAP_RUNS 3
+
+bool lzbench_chunk_map(lzbench_params_t *params, const compressor_desc_t* desc, const std::string &name, std::vector<size_t> &chunk_sizes, uint8_t *inbuf,
+                       uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem)
+{
+    bench_timer_t start_ticks, end_ticks;
+    size_t n = chunk_sizes.size();
+    std::vector<uint64_t> ctime(n, UINT64_MAX), dtime(n, UINT64_MAX);
+    std::vector<size_t> compr_sizes(n);
+
+    for (int run = 0; run < CHUNK_MAP_RUNS; run++)
+    {
+        size_t pos = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t part = chunk_sizes[i], outpart = GET_COMPRESS_BOUND(part);
+            if (outpart > comprsize) outpart = comprsize;
+
+            GetTime(start_ticks);
+            int64_t clen = desc->compress((char*)inbuf + pos, part, (char*)compbuf, outpart, param1, param2, workmem);
+            GetTime(end_ticks);
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            ctime[i] = MIN(ctime[i], nanosec);
+
+            if (clen <= 0 || (size_t)clen == part) // stored
+            {
+                compr_sizes[i] = part;
+                dtime[i] = 0;
+            }
+            else
+            {
+                compr_sizes[i] = clen;
+                GetTime(start_ticks);
+                int64_t dlen = desc->decompress((char*)compbuf, clen, (char*)decomp + pos, part, param1, param2, workmem);
+                GetTime(end_ticks);
+                if (dlen != (int64_t)part || memcmp(decomp + pos, inbuf + pos, part) != 0)
+                {
+                    printf("ERROR: --chunk-map decompression of chunk %d of %s failed\n", (int)i, desc->name);
+                    return false;
+                }
+                nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+                dtime[i] = MIN(dtime[i], nanosec);
+            }
+            pos += part;
+        }
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (params->chunk_map_json)
+        {
+            fprintf(params->chunk_map, "{\"name\":");
+            fprint_json_string(params->chunk_map, name.c_str());
+            fprintf(params->chunk_map, ",\"file\":");
+            fprint_json_string(params->chunk_map, params->in_filename);
+            fprintf(params->chunk_map, ",\"offset\":%llu,\"size\":%llu,\"compressed_size\":%llu,\"ctime_ns\":%llu,\"dtime_ns\":%llu}\n", (unsigned long long)pos,
+                (unsigned long long)chunk_sizes[i], (unsigned long long)compr_sizes[i], (unsigned long long)ctime[i], (unsigned long long)dtime[i]);
+        }
+        else
+            fprintf(params->chunk_map, "%s,%s,%llu,%llu,%llu,%llu,%llu\n", name.c_str(), params->in_filename, (unsigned long long)pos, (unsigned long long)chunk_sizes[i],
+                (unsigned long long)compr_sizes[i], (unsigned long long)ctime[i], (unsigned long long)dtime[i]);
+        pos += chunk_sizes[i];
+    }
+    fflush(params->chunk_map);
+    return true;
+}
+
+
+/*
+ * --fuzz: compressed chunks of the codec are mutated (bit flips, truncation, bytes set to 0xFF that turn
+ * lengths and varints into huge values, runs of random bytes) and decoded by a forked process, so a crash
+ * or a hang costs only the process. The slowest decode shows decoders with super-linear blowup, an output
+ * longer than the chunk or writes past its end are anomalies. Mutation k is the same for every codec.
+ */
+#define FUZZ_GUARD 64
+#define FUZZ_RUNS 3 // the best time of a case, noise is not a blowup
+
+static const char* fuzz_kinds[] = { "bit flips", "truncation", "huge length", "random bytes" };
+
+enum { FUZZ_ACCEPTED, FUZZ_REJECTED, FUZZ_ANOMALY };
+
+typedef struct
+{
+    uint32_t k, outcome;
+    uint64_t nanosec;
+} fuzz_record_t;
+
+/* mutation k of one of the compressed chunks in candidates, returns its kind */
+int fuzz_mutate(uint32_t k, const std::vector<size_t> &candidates, const std::vector<size_t> &coffsets, const std::vector<size_t> &compr_sizes,
+                const uint8_t *compbuf, std::vector<uint8_t> &buf, size_t &chunk, size_t &size)
+{
+    std::mt19937 rng(k + 1);
+    int kind = k % 4;
+    chunk = candidates[rng() % candidates.size()];
+    size = compr_sizes[chunk];
+    buf.assign(compbuf + coffsets[chunk], compbuf + coffsets[chunk] + size);
+
+    size_t pos = rng() % size, len;
+    switch (kind)
+    {
+        case 0:
+            for (int flips = 1 + rng() % 8; flips > 0; flips--)
+                buf[rng() % size] ^= 1 << (rng() % 8);
+            break;
+        case 1:
+            size = pos;
+            break;
+        case 2:
+            len = MIN(size - pos, (size_t)(1 + rng() % 8));
+            memset(&buf[pos], 0xFF, len);
+            break;
+        default:
+            len = MIN(size - pos, (size_t)(1 + rng() % 64));
+            for (size_t j = 0; j < len; j++) buf[pos + j] = rng();
+            break;
+    }
+    return kind;
+}
+
+#if !defined(_WIN32)
+bool write_all(int fd, const char* buf, size_t size);
+
+bool lzbench_fuzz(lzbench_params_t *params, const compressor_desc_t* desc, int level, std::vector<size_t> &chunk_sizes, uint8_t *compbuf, size_t comprsize,
+                  uint8_t *inbuf, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> compr_sizes, coffsets, candidates;
+    std::vector<uint64_t> clean_ns;
+    std::vector<uint8_t> buf, out;
+    size_t cpos = 0, max_chunk = 0;
+
+    if (chunk_sizes.empty() || lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+    for (size_t i = 0; i < chunk_sizes.size(); i++)
+    {
+        coffsets.push_back(cpos);
+        cpos += compr_sizes[i];
+        max_chunk = MAX(max_chunk, chunk_sizes[i]);
+        if (compr_sizes[i] != chunk_sizes[i] && compr_sizes[i] > 0) candidates.push_back(i); // stored chunks are not decoded
+    }
+    if (candidates.empty()) return false;
+
+    // best time of the intact chunks, the base of the slowdown
+    out.resize(max_chunk + FUZZ_GUARD);
+    clean_ns.resize(chunk_sizes.size(), UINT64_MAX);
+    for (int run = 0; run < FUZZ_RUNS; run++)
+    for (size_t c = 0; c < candidates.size(); c++)
+    {
+        size_t i = candidates[c];
+        GetTime(start_ticks);
+        desc->decompress((char*)compbuf + coffsets[i], compr_sizes[i], (char*)out.data(), chunk_sizes[i], param1, param2, workmem);
+        GetTime(end_ticks);
+        clean_ns[i] = MIN(clean_ns[i], MAX(GetDiffTime(rate, start_ticks, end_ticks), (uint64_t)1));
+    }
+
+    uint64_t worst = 0;
+    counters.fworst_x = 0;
+    uint32_t next = 0;
+    while (next < params->fuzz_cases)
+    {
+        int fds[2];
+        if (pipe(fds) != 0) { perror("pipe"); return false; }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork"); close(fds[0]); close(fds[1]); return false; }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            memset(out.data(), 0, out.size()); // copy-on-write faults of the forked process are not timed
+            for (uint32_t k = next; k < params->fuzz_cases; k++)
+            {
+                size_t chunk, size;
+                fuzz_mutate(k, candidates, coffsets, compr_sizes, compbuf, buf, chunk, size);
+                fuzz_record_t rec = { k, FUZZ_ACCEPTED, UINT64_MAX };
+                for (int run = 0; run < FUZZ_RUNS; run++)
+                {
+                    memset(&out[chunk_sizes[chunk]], 0xA5, FUZZ_GUARD);
+                    GetTime(start_ticks);
+                    int64_t dlen = desc->decompress((char*)buf.data(), size, (char*)out.data(), chunk_sizes[chunk], param1, param2, workmem);
+                    GetTime(end_ticks);
+                    rec.nanosec = MIN(rec.nanosec, GetDiffTime(rate, start_ticks, end_ticks));
+                    if (dlen <= 0 && rec.outcome == FUZZ_ACCEPTED) rec.outcome = FUZZ_REJECTED;
+                    if (dlen > (int64_t)chunk_sizes[chunk]) rec.outcome = FUZZ_ANOMALY;
+                    for (size_t j = 0; j < FUZZ_GUARD; j++)
+                        if (out[chunk_sizes[chunk] + j] != 0xA5) rec.outcome = FUZZ_ANOMALY;
+                }
+                if (!write_all(fds[1], (const char*)&rec, sizeof(rec))) break;
+            }
+            _exit(0);
+        }
+
+        close(fds[1]);
+        std::string data;
+        bool timeout = false;
+        while (true)
+        {
+            struct pollfd pfd = { fds[0], POLLIN, 0 };
+            int ready = poll(&pfd, 1, params->fuzz_timeout_ms);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready == 0) { timeout = true; break; }
+            char rbuf[4096];
+            ssize_t n = read(fds[0], rbuf, sizeof(rbuf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            data.append(rbuf, n);
+
+            fuzz_record_t rec;
+            while (data.size() >= sizeof(rec))
+            {
+                memcpy(&rec, data.data(), sizeof(rec));
+                data.erase(0, sizeof(rec));
+                size_t chunk, size;
+                fuzz_mutate(rec.k, candidates, coffsets, compr_sizes, compbuf, buf, chunk, size);
+                counters.fcases++;
+                if (rec.outcome == FUZZ_REJECTED) counters.frejected++;
+                if (rec.outcome == FUZZ_ANOMALY) counters.fanomalies++;
+                worst = MAX(worst, rec.nanosec);
+                counters.fworst_x = MAX(counters.fworst_x, (float)rec.nanosec / clean_ns[chunk]);
+                next = rec.k + 1;
+            }
+        }
+        if (timeout) kill(pid, SIGKILL);
+        close(fds[0]);
+
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+        if (next >= params->fuzz_cases) break;
+        if (!timeout && WIFEXITED(status) && WEXITSTATUS(status) == 0) break; // the process stopped writing, don't start it again
+
+        // the case after the last record crashed or hung, the next process starts behind it
+        std::string failure;
+        if (timeout)
+            format(failure, "hang over %u ms", params->fuzz_timeout_ms), counters.fhangs++;
+        else if (WIFSIGNALED(status))
+            failure = strsignal(WTERMSIG(status)), counters.fcrashes++;
+        else
+            format(failure, "exit %d", WEXITSTATUS(status)), counters.fcrashes++;
+        size_t chunk, size;
+        int kind = fuzz_mutate(next, candidates, coffsets, compr_sizes, compbuf, buf, chunk, size);
+        fprintf(stderr, "%s -%d: fuzz case %u (%s of chunk %u): %s\n", desc->name, level, next, fuzz_kinds[kind], (unsigned)chunk, failure.c_str());
+        counters.fcases++;
+        next++;
+    }
+    counters.fworst_us = worst / 1000.0;
+    return true;
+}
+#else
+bool lzbench_fuzz(lzbench_params_t *params, const compressor_desc_t* desc, int level, std::vector<size_t> &chunk_sizes, uint8_t *compbuf, size_t comprsize,
+                  uint8_t *inbuf, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    return false;
+}
+#endif
+
+
+/* --inplace: decoders that can read compressed data from the tail of their own output buffer and the margin they need behind the output */
+typedef int64_t (*margin_func)(char *inbuf, size_t insize, size_t outsize);
+
+static const struct { compress_func decompress; margin_func margin; } inplace_codecs[] = {
+    { lzbench_lz4_decompress,  lzbench_lz4_inplace_margin },
+    { lzbench_zstd_decompress, lzbench_zstd_inplace_margin },
+};
+
+margin_func inplace_margin(const compressor_desc_t* desc)
+{
+    for (size_t i=0; i<sizeof(inplace_codecs)/sizeof(inplace_codecs[0]); i++)
+        if (inplace_codecs[i].margin && inplace_codecs[i].decompress == desc->decompress) return inplace_codecs[i].margin;
+    return NULL;
+}
+
+
+/*
+ * --inplace: every chunk is decompressed into a buffer of its size plus the margin of the codec with the compressed
+ * data at the tail of the same buffer, as firmware and readers of mapped files do to need a single allocation. Copies
+ * of the compressed data to the tail aren't timed, the fastest pass over all chunks within -t of decompression is shown.
+ */
+bool lzbench_inplace(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                     bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks, loop_ticks;
+    std::vector<size_t> compr_sizes;
+    std::vector<int64_t> margins;
+    margin_func margin = inplace_margin(desc);
+    size_t max_chunk = 0, insize = 0;
+    uint64_t best = UINT64_MAX;
+
+    counters.imargin = -1;
+    if (!margin || chunk_sizes.empty()) return true;
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return false;
+    for (size_t i = 0, cpos = 0; i < chunk_sizes.size(); cpos += compr_sizes[i++])
+    {
+        int64_t m = compr_sizes[i] == chunk_sizes[i] ? 0 : margin((char*)compbuf + cpos, compr_sizes[i], chunk_sizes[i]); // stored chunks are already in place
+        if (m < 0) return true;
+        margins.push_back(m);
+        counters.imargin = MAX(counters.imargin, m);
+        max_chunk = MAX(max_chunk, chunk_sizes[i]);
+        insize += chunk_sizes[i];
+    }
+
+    uint8_t *buf = (uint8_t*)alloc_and_touch(max_chunk + counters.imargin + PAD_SIZE, false);
+    if (!buf) { counters.imargin = -1; return false; }
+    GetTime(loop_ticks);
+    for (uint32_t pass = 0; ; pass++)
+    {
+        uint64_t total = 0;
+        size_t cpos = 0, dpos = 0;
+        for (size_t i = 0; i < chunk_sizes.size(); i++)
+        {
+            uint8_t *src = buf + chunk_sizes[i] + margins[i] - compr_sizes[i];
+            int64_t dlen = chunk_sizes[i];
+            memcpy(src, compbuf + cpos, compr_sizes[i]);
+            GetTime(start_ticks);
+            if (compr_sizes[i] != chunk_sizes[i])
+                dlen = desc->decompress((char*)src, compr_sizes[i], (char*)buf, chunk_sizes[i], param1, param2, workmem);
+            GetTime(end_ticks);
+            total += GetDiffTime(rate, start_ticks, end_ticks);
+            if (pass == 0 && (dlen != (int64_t)chunk_sizes[i] || memcmp(buf, inbuf + dpos, chunk_sizes[i]) != 0))
+            {
+                printf("ERROR: --inplace decompression of chunk %d of %s failed\n", (int)i, desc->name);
+                free_touched(buf);
+                counters.imargin = -1;
+                return false;
+            }
+            cpos += compr_sizes[i];
+            dpos += chunk_sizes[i];
+        }
+        best = MIN(best, total);
+        GetTime(end_ticks);
+        if (pass + 1 >= params->d_iters && GetDiffTime(rate, loop_ticks, end_ticks) >= (uint64_t)params->dmintime * 1000000) break;
+    }
+    free_touched(buf);
+    counters.ispeed = insize * 1000.0 / (MAX(best, (uint64_t)1));
+    return true;
+}
+
+
+/* pdeflate writes gzip for other decoders, the output of the first chunk has to be read by zlib too */
+bool lzbench_pdeflate_check(const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                            uint8_t *decomp, size_t param1, size_t param2, char* workmem)
+{
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+    size_t size = MIN(chunk_size, insize);
+    int64_t clen = desc->compress((char*)inbuf, size, (char*)compbuf, comprsize, param1, param2, workmem);
+    if (clen <= 0) return true; // stored
+    if (lzbench_zlib_gzip_decompress((char*)compbuf, clen, (char*)decomp, size, 0, 0, NULL) == (int64_t)size && memcmp(decomp, inbuf, size) == 0) return true;
+    printf("ERROR: zlib cannot decompress the gzip output of %s\n", desc->name);
+    return false;
+#else
+    return true;
+#endif
+}
+
+
+/*
+ * xzmt: the first chunk is compressed once and decompressed block-parallel with 1, 2, 4... up to the threads
+ * of --xzmt, at least 3 passes and 100 ms each, the fastest pass is taken. Only blocks of the index are split
+ * across threads, so the scaling is bound by the number of blocks.
+ */
+void lzbench_xzmt_scaling(const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                          uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+#ifndef BENCH_REMOVE_XZ
+    size_t size = MIN(chunk_size, insize);
+    int64_t clen = desc->compress((char*)inbuf, size, (char*)compbuf, comprsize, param1, param2, workmem);
+    if (clen <= 0) return;
+    counters.xblocks = lzbench_xz_blocks((char*)compbuf, clen);
+    counters.xcount = 0;
+    for (int threads = 1; counters.xcount < XZ_SCALING_MAX; threads = MIN(threads * 2, lzbench_xzmt_threads))
+    {
+        bench_timer_t start_ticks, end_ticks, first_ticks;
+        uint64_t best = UINT64_MAX;
+
+        GetTime(first_ticks);
+        for (int k = 0; k < 3 || GetDiffTime(rate, first_ticks, end_ticks) < 100000000; k++)
+        {
+            GetTime(start_ticks);
+            int64_t len = lzbench_xzmt_decompress_threads((char*)compbuf, clen, (char*)decomp, size, threads);
+            GetTime(end_ticks);
+            if (len != (int64_t)size) return;
+            best = MIN(best, GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        counters.xthreads[counters.xcount] = threads;
+        counters.xdspeed[counters.xcount++] = size * 1000.0 / (MAX(best, (uint64_t)1));
+        if (threads >= lzbench_xzmt_threads) break;
+    }
+#endif
+}
+
+
+/*
+ * --delta: the input is compressed and decompressed by chunks of the test by the codec of a delta codec without the
+ * reference, the best of 3 passes, to show the size and speed of the delta next to the ones of standalone compression
+ */
+void lzbench_delta_plain(const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                         uint8_t *decomp, bench_rate_t rate, size_t param1, lzbench_counters_t &counters)
+{
+    std::string name(desc->name, strlen(desc->name) - strlen("_delta"));
+    const compressor_desc_t* plain = NULL;
+    for (int i=0; i<LZBENCH_COMPRESSOR_COUNT; i++)
+        if (name == comp_desc[i].name) plain = &comp_desc[i];
+    if (!plain) return;
+
+    const char* dict = lzbench_dict;
+    size_t dict_size = lzbench_dict_size, param2 = plain->additional_param;
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX };
+    std::vector<int64_t> clens;
+
+    lzbench_dict = NULL, lzbench_dict_size = 0;
+    char* workmem = plain->init ? plain->init(chunk_size, param1, param2) : NULL;
+    for (int k = 0; k < 3; k++)
+    {
+        size_t outpos = 0;
+        clens.clear();
+        GetTime(start_ticks);
+        for (size_t pos = 0; pos < insize; pos += chunk_size)
+        {
+            size_t size = MIN(chunk_size, insize - pos);
+            int64_t len = plain->compress((char*)inbuf + pos, size, (char*)compbuf + outpos, comprsize - outpos, param1, param2, workmem);
+            if (len <= 0 || len == (int64_t)size) memcpy(compbuf + outpos, inbuf + pos, size), len = size; // stored like lzbench_compress()
+            clens.push_back(len);
+            outpos += len;
+        }
+        GetTime(end_ticks);
+        best[0] = MIN(best[0], GetDiffTime(rate, start_ticks, end_ticks));
+        counters.delta_plain = outpos;
+
+        outpos = 0;
+        GetTime(start_ticks);
+        for (size_t pos = 0, i = 0; pos < insize; pos += chunk_size, i++)
+        {
+            size_t size = MIN(chunk_size, insize - pos);
+            if (clens[i] == (int64_t)size) memcpy(decomp + pos, compbuf + outpos, size);
+            else plain->decompress((char*)compbuf + outpos, clens[i], (char*)decomp + pos, size, param1, param2, workmem);
+            outpos += clens[i];
+        }
+        GetTime(end_ticks);
+        best[1] = MIN(best[1], GetDiffTime(rate, start_ticks, end_ticks));
+    }
+    if (plain->deinit) plain->deinit(workmem);
+    lzbench_dict = dict, lzbench_dict_size = dict_size;
+
+    if (memcmp(decomp, inbuf, insize) != 0) { counters.delta_plain = 0; return; }
+    counters.delta_cspeed = insize * 1000.0 / (MAX(best[0], (uint64_t)1));
+    counters.delta_dspeed = insize * 1000.0 / (MAX(best[1], (uint64_t)1));
+}
+
+
+/*
+ * -e "filters+codec": the input is compressed by the codec without the filters in the chunks of the test to show
+ * the gain of the filters, and the filters and their inverse are run alone over the chunks, the best of 3 passes
+ */
+void lzbench_filter_plain(lzbench_params_t *params, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                          uint8_t *decomp, bench_rate_t rate, size_t param1, lzbench_counters_t &counters)
+{
+    const compressor_desc_t* plain = filter_setup.desc;
+    const std::vector<lzbench_filter_t>& filters = filter_setup.filters;
+    size_t chunk_size = *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    std::vector<uint8_t> buf(chunk_size + PAD_SIZE);
+    std::vector<size_t> compr_sizes;
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX };
+
+    char* workmem = plain->init ? plain->init(chunk_size, param1, plain->additional_param) : NULL;
+    int64_t len = lzbench_compress(params, chunk_sizes, plain->compress, compr_sizes, inbuf, compbuf, comprsize, param1, plain->additional_param, workmem, NULL);
+    if (plain->deinit) plain->deinit(workmem);
+    if (len <= 0) return;
+
+    // a chain of n filters ends in decomp (forward) or compbuf (inverse) and starts there for an even n
+    for (int k = 0; k < 3; k++)
+        for (int dir = 0; dir < 2; dir++)
+        {
+            GetTime(start_ticks);
+            for (size_t i = 0, pos = 0; i < chunk_sizes.size(); pos += chunk_sizes[i++])
+            {
+                uint8_t* target = dir ? compbuf + pos : decomp + pos;
+                const uint8_t* src = dir ? decomp + pos : inbuf + pos;
+                for (size_t f = 0; f < filters.size(); f++)
+                {
+                    size_t n = dir ? filters.size() - 1 - f : f;
+                    uint8_t* dst = ((filters.size() - f) & 1) ? target : buf.data();
+                    if (dir) lzbench_filter_inverse(filters[n], src, dst, chunk_sizes[i]);
+                    else lzbench_filter_forward(filters[n], src, dst, chunk_sizes[i]);
+                    src = dst;
+                }
+            }
+            GetTime(end_ticks);
+            best[dir] = MIN(best[dir], GetDiffTime(rate, start_ticks, end_ticks));
+        }
+    if (memcmp(compbuf, inbuf, insize) != 0) return;
+    counters.filter_plain = len;
+    counters.filter_fspeed = insize * 1000.0 / (MAX(best[0], (uint64_t)1));
+    counters.filter_ispeed = insize * 1000.0 / (MAX(best[1], (uint64_t)1));
+}
+
+
+/*
+ * -e "mt#:codec": the codec alone compresses and decompresses the chunks of the test on one thread for the latency
+ * and the size of one request without the blocks, the best of up to 3 passes within -t# and -u#
+ */
+void lzbench_blockmt_plain(lzbench_params_t *params, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                           uint8_t *decomp, bench_rate_t rate, size_t param1, lzbench_counters_t &counters)
+{
+    const compressor_desc_t* plain = blockmt_setup.desc;
+    size_t chunk_size = *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    std::vector<size_t> compr_sizes;
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total[2] = { 0, 0 };
+    int64_t len = 0;
+
+    char* workmem = plain->init ? plain->init(chunk_size, param1, plain->additional_param) : NULL;
+    for (int k = 0; k < 3 && (k == 0 || total[0] < (uint64_t)params->cmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        len = lzbench_compress(params, chunk_sizes, plain->compress, compr_sizes, inbuf, compbuf, comprsize, param1, plain->additional_param, workmem, NULL);
+        GetTime(end_ticks);
+        if (len <= 0) break;
+        best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[0] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    for (int k = 0; len > 0 && k < 3 && (k == 0 || total[1] < (uint64_t)params->dmintime * 1000000); k++)
+    {
+        GetTime(start_ticks);
+        int64_t dlen = lzbench_decompress(params, chunk_sizes, plain->decompress, compr_sizes, compbuf, decomp, param1, plain->additional_param, workmem, NULL);
+        GetTime(end_ticks);
+        if (dlen != (int64_t)insize || memcmp(decomp, inbuf, insize) != 0) len = 0;
+        best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total[1] += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    if (plain->deinit) plain->deinit(workmem);
+    if (len <= 0) return;
+    counters.mt_plain = len;
+    counters.mt_plain_cms = best[0] / 1e6 / chunk_sizes.size();
+    counters.mt_plain_dms = best[1] / 1e6 / chunk_sizes.size();
+}
+
+
+/*
+ * --transcode=codec[,level]: the input is compressed once by the source codec, then its chunks are decompressed and
+ * compressed again by the codec of the row, as separate passes over all chunks (one thread) and fused chunk by
+ * chunk through a buffer of a chunk that stays in the cache, on one thread and on the threads of the test that take
+ * chunks from a shared counter. The best of up to 3 passes within -t#, the output of the fused pass is verified.
+ */
+bool lzbench_transcode(lzbench_params_t *params, const compressor_desc_t* desc, lzbench_thread_pool &pool, int nthreads, std::vector<size_t> &chunk_sizes,
+                       uint8_t *inbuf, size_t insize, uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, lzbench_counters_t &counters)
+{
+    std::vector<std::string> terms = split(params->transcode, ',');
+    const compressor_desc_t* source = NULL;
+    for (int i=1; i<codec_count() && !source; i++)
+        if (istrcmp(codec_desc(i)->name, terms[0].c_str()) == 0) source = codec_desc(i);
+    if (!source)
+    {
+        static bool warned = false;
+        if (!warned) fprintf(stderr, "warning: codec %s of --transcode not found\n", terms[0].c_str());
+        warned = true;
+        return false;
+    }
+    size_t level = (terms.size() > 1) ? atoi(terms[1].c_str()) : source->first_level, chunk_size = *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    size_t n = chunk_sizes.size(), bound = 0;
+    std::vector<size_t> src_sizes, dst_sizes(n), in_offsets(n), src_offsets(n), dst_offsets(n);
+    for (size_t i = 0, pos = 0; i < n; pos += chunk_sizes[i], i++) in_offsets[i] = pos, dst_offsets[i] = bound, bound += GET_COMPRESS_BOUND(chunk_sizes[i]);
+    std::vector<uint8_t> src(GET_COMPRESS_BOUND(insize) + PAD_SIZE), dst(bound), scratch((size_t)nthreads * chunk_size);
+    std::vector<char*> swork(nthreads), dwork(nthreads);
+    for (int t = 0; t < nthreads; t++)
+    {
+        swork[t] = source->init ? source->init(chunk_size, level, source->additional_param) : NULL;
+        dwork[t] = desc->init ? desc->init(chunk_size, param1, param2) : NULL;
+    }
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[4] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX }, total = 0, cpu = 0;
+    std::vector<uint64_t> busy(nthreads);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> failed(false);
+    bool ok = lzbench_compress(params, chunk_sizes, source->compress, src_sizes, inbuf, src.data(), src.size(), level, source->additional_param, swork[0], NULL) > 0;
+    for (size_t i = 0, pos = 0; ok && i < n; pos += src_sizes[i], i++) src_offsets[i] = pos;
+
+    // chunks of src stored by lzbench_compress (size = chunk size) are copied
+    auto fused = [&](int t) {
+        bench_timer_t thr_start, thr_end;
+        uint8_t* buf = scratch.data() + (size_t)t * chunk_size;
+        GetTime(thr_start);
+        for (size_t i; !failed && (i = next++) < n; )
+        {
+            const uint8_t* in = src.data() + src_offsets[i];
+            if (src_sizes[i] == chunk_sizes[i]) memcpy(buf, in, chunk_sizes[i]);
+            else if (source->decompress((char*)in, src_sizes[i], (char*)buf, chunk_sizes[i], level, source->additional_param, swork[t]) != (int64_t)chunk_sizes[i]) { failed = true; break; }
+            int64_t len = desc->compress((char*)buf, chunk_sizes[i], (char*)dst.data() + dst_offsets[i], GET_COMPRESS_BOUND(chunk_sizes[i]), param1, param2, dwork[t]);
+            if (len <= 0) { failed = true; break; }
+            dst_sizes[i] = len;
+        }
+        GetTime(thr_end);
+        busy[t] = GetDiffTime(rate, thr_start, thr_end);
+    };
+
+    for (int k = 0; ok && k < 3 && (k == 0 || total < (uint64_t)params->cmintime * 1000000); k++)
+    {
+        std::vector<size_t> sizes;
+        GetTime(start_ticks);
+        ok = lzbench_decompress(params, chunk_sizes, source->decompress, src_sizes, src.data(), decomp, level, source->additional_param, swork[0], NULL) == (int64_t)insize;
+        GetTime(end_ticks);
+        best[0] = MIN(best[0], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+        GetTime(start_ticks);
+        ok = ok && lzbench_compress(params, chunk_sizes, desc->compress, sizes, decomp, dst.data(), dst.size(), param1, param2, dwork[0], NULL) > 0;
+        GetTime(end_ticks);
+        best[1] = MIN(best[1], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+
+        next = 0;
+        GetTime(start_ticks);
+        fused(0);
+        GetTime(end_ticks);
+        best[2] = MIN(best[2], (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+
+        if (nthreads > 1)
+        {
+            next = 0;
+            GetTime(start_ticks);
+            pool.run(fused);
+            GetTime(end_ticks);
+            uint64_t wall = GetDiffTime(rate, start_ticks, end_ticks);
+            if (wall < best[3]) best[3] = wall, cpu = std::accumulate(busy.begin(), busy.end(), (uint64_t)0);
+            total += wall;
+        }
+        ok = ok && !failed;
+    }
+
+    for (size_t i = 0; ok && i < n; i++) // the output of the last fused pass
+        ok = desc->decompress((char*)dst.data() + dst_offsets[i], dst_sizes[i], (char*)decomp + in_offsets[i], chunk_sizes[i], param1, param2, dwork[0]) == (int64_t)chunk_sizes[i]
+            && memcmp(decomp + in_offsets[i], inbuf + in_offsets[i], chunk_sizes[i]) == 0;
+    for (int t = 0; t < nthreads; t++)
+    {
+        if (source->deinit) source->deinit(swork[t]);
+        if (desc->deinit) desc->deinit(dwork[t]);
+    }
+    if (!ok)
+    {
+        printf("ERROR: --transcode from %s to %s failed\n", source->name, desc->name);
+        return false;
+    }
+    counters.tc_dns = best[0];
+    counters.tc_cns = best[1];
+    counters.tc_fused_ns = best[2];
+    counters.tc_threads = nthreads;
+    counters.tc_mt_ns = (nthreads > 1) ? best[3] : best[2];
+    counters.tc_mt_cpu_ns = (nthreads > 1) ? cpu : best[2];
+    return true;
+}
+
+
+/* lz4_ilv#, snappy_ilv#: batches of all chunks decoded by the same decoder with param2 chunks at once and with one, in turn for -u# */
+bool is_interleaved(const compressor_desc_t* desc)
+{
+    return desc->decompress_batch && (desc->decompress_batch == lzbench_lz4_interleaved_decompress_batch || desc->decompress_batch == lzbench_snappy_interleaved_decompress_batch);
+}
+
+void lzbench_interleaved_gain(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                              uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, lzbench_counters_t &counters)
+{
+    std::vector<size_t> compr_sizes;
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t best[2] = { UINT64_MAX, UINT64_MAX }, total = 0;
+
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, NULL, NULL) <= 0) return;
+    for (int pass = 0; pass < 6 || total < (uint64_t)params->dmintime * 1000000; pass++)
+    {
+        GetTime(start_ticks);
+        int64_t dlen = lzbench_decompress_batch(params, chunk_sizes, desc, compr_sizes, compbuf, decomp, param1, (pass & 1) ? 1 : param2, NULL);
+        GetTime(end_ticks);
+        if (dlen != (int64_t)insize || memcmp(decomp, inbuf, insize) != 0) return;
+        best[pass & 1] = MIN(best[pass & 1], GetDiffTime(rate, start_ticks, end_ticks));
+        total += GetDiffTime(rate, start_ticks, end_ticks);
+    }
+    counters.ilv_dspeed = insize * 1000.0 / (MAX(best[0], (uint64_t)1));
+    counters.ilv_seq_dspeed = insize * 1000.0 / (MAX(best[1], (uint64_t)1));
+}
+
+
+/*
+ * --range-reads: the input up to a chunk of -b# is compressed by zstd_seekable or deflate_indexed as one object and
+ * ranges at random offsets are read by a single thread, like range GETs of a compressed object. With zstd_seekable
+ * the frames that are fully inside a range are decompressed into place through its seek table and the ones at its
+ * ends into a frame buffer. A gzip stream of deflate_indexed, or a gzip file of --decompress-only as it is, gets a
+ * zran index of access points every --zran=# MB and a read inflates from the last point before the range.
+ */
+static uint32_t read_le32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool lzbench_range_reads(lzbench_params_t *params, const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                         uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> coffsets(1, 0), doffsets(1, 0);
+    std::vector<uint8_t> frame_buf;
+    std::mt19937 rng(1);
+    size_t objsize = MIN(chunk_size, insize);
+    std::function<bool(size_t, size_t, uint64_t&, uint64_t&)> read_range; // offset, size, compressed and decompressed bytes
+
+#ifndef BENCH_REMOVE_ZLIB
+    const uint8_t* gz = compbuf;
+    int64_t gzsize = 0;
+    char* zran = NULL;
+    if (desc->decompress == lzbench_zlib_gzip_decompress)
+    {
+        gzsize = params->decode_data ? (int64_t)params->decode_size : desc->compress((char*)inbuf, objsize, (char*)compbuf, comprsize, param1, param2, workmem);
+        size_t index_bytes = 0;
+        if (params->decode_data) gz = params->decode_data, objsize = insize;
+        if (gzsize <= 0) return false;
+        GetTime(start_ticks);
+        zran = lzbench_zran_build((const char*)gz, gzsize, (char*)decomp, objsize, &index_bytes);
+        GetTime(end_ticks);
+        if (!zran) return false;
+        counters.sindex_bytes = index_bytes;
+        counters.sindex_ns = GetDiffTime(rate, start_ticks, end_ticks);
+        frame_buf.resize(1 << 15);
+        read_range = [&](size_t offset, size_t size, uint64_t& fetched, uint64_t& decoded) -> bool {
+            size_t in = 0, out = 0;
+            int64_t dlen = lzbench_zran_read(zran, (const char*)gz, gzsize, offset, (char*)decomp, size, (char*)frame_buf.data(), &in, &out);
+            fetched += in;
+            decoded += out;
+            return dlen == (int64_t)size;
+        };
+    }
+    else
+#endif
+    {
+        int64_t clen = desc->compress((char*)inbuf, objsize, (char*)compbuf, comprsize, param1, param2, workmem);
+        if (clen < ZSTD_SEEKABLE_FOOTER || read_le32(compbuf + clen - 4) != ZSTD_SEEKABLE_MAGIC) return false;
+        GetTime(start_ticks);
+        size_t frames = read_le32(compbuf + clen - ZSTD_SEEKABLE_FOOTER);
+        const uint8_t* table = compbuf + clen - ZSTD_SEEKABLE_FOOTER - frames * 8;
+        for (size_t i = 0; i < frames; i++)
+        {
+            coffsets.push_back(coffsets.back() + read_le32(table + i * 8));
+            doffsets.push_back(doffsets.back() + read_le32(table + i * 8 + 4));
+            frame_buf.resize(MAX(frame_buf.size(), (size_t)read_le32(table + i * 8 + 4)));
+        }
+        GetTime(end_ticks);
+        if (doffsets.back() != objsize) return false;
+        counters.sindex_bytes = frames * 8 + ZSTD_SEEKABLE_FOOTER;
+        counters.sindex_ns = GetDiffTime(rate, start_ticks, end_ticks);
+        read_range = [&](size_t offset, size_t size, uint64_t& fetched, uint64_t& decoded) -> bool {
+            size_t end = offset + size;
+            size_t first = std::upper_bound(doffsets.begin(), doffsets.end(), offset) - doffsets.begin() - 1;
+            size_t last = std::lower_bound(doffsets.begin(), doffsets.end(), end) - doffsets.begin(); // one past the last frame
+            bool ok = true;
+            for (size_t f = first; f < last && ok; f++)
+            {
+                size_t fsize = doffsets[f + 1] - doffsets[f];
+                bool whole = doffsets[f] >= offset && doffsets[f + 1] <= end;
+                uint8_t *dst = whole ? decomp + doffsets[f] - offset : frame_buf.data();
+                int64_t dlen = desc->decompress((char*)compbuf + coffsets[f], coffsets[f + 1] - coffsets[f], (char*)dst, fsize, param1, param2, workmem);
+                ok = (dlen == (int64_t)fsize);
+                if (ok && !whole)
+                {
+                    size_t from = MAX(offset, doffsets[f]), to = MIN(end, doffsets[f + 1]);
+                    memcpy(decomp + from - offset, frame_buf.data() + from - doffsets[f], to - from);
+                }
+            }
+            fetched += coffsets[last] - coffsets[first];
+            decoded += doffsets[last] - doffsets[first];
+            return ok;
+        };
+    }
+
+    bool ok = true;
+    for (size_t s = 0; s < params->range_sizes.size() && ok; s++)
+    {
+        size_t size = params->range_sizes[s];
+        lzbench_histogram hist;
+        uint64_t fetched = 0, decoded = 0;
+
+        if (size > objsize) continue;
+        std::uniform_int_distribution<size_t> pick(0, objsize - size);
+        for (uint32_t k = 0; k < params->range_reads; k++)
+        {
+            size_t offset = pick(rng);
+            GetTime(start_ticks);
+            ok = read_range(offset, size, fetched, decoded);
+            GetTime(end_ticks);
+            if (!ok || memcmp(decomp, inbuf + offset, size) != 0)
+            {
+                printf("ERROR: --range-reads of %d bytes at %llu of %s failed\n", (int)size, (unsigned long long)offset, desc->name);
+                ok = false;
+                break;
+            }
+            hist.add(GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        counters.slat[s][0] = hist.percentile(50) / 1000.0;
+        counters.slat[s][1] = hist.percentile(99) / 1000.0;
+        counters.samp[s] = (double)fetched / size / params->range_reads;
+        counters.sdecoded[s] = (double)decoded / size / params->range_reads;
+    }
+#ifndef BENCH_REMOVE_ZLIB
+    lzbench_zran_free(zran);
+#endif
+    return ok;
+}
+
+
+/*
+ * --dthreads: decompression-only scaling of a read path. Threads decode all chunks of the same read-only compbuf
+ * into a private buffer of a chunk with a workmem of their own, thread t starts at chunk t*n/threads so they don't
+ * run in lockstep. A pass takes as long as the slowest thread, the speed is the bytes of all threads over the
+ * fastest pass. The first pass of every count is checked against the input.
+ */
+void lzbench_shared_reads(lzbench_params_t *params, const compressor_desc_t* desc, std::vector<size_t> &chunk_sizes, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize,
+                          bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    std::vector<size_t> compr_sizes, coffsets, doffsets;
+    size_t max_size = 0, insize = 0, n = chunk_sizes.size();
+
+    if (!n || lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) <= 0) return;
+    for (size_t i = 0, cpos = 0; i < n; cpos += compr_sizes[i], insize += chunk_sizes[i], i++)
+    {
+        coffsets.push_back(cpos);
+        doffsets.push_back(insize);
+        max_size = MAX(max_size, chunk_sizes[i]);
+    }
+
+    for (int k = 0; k < params->dthread_counts_nb; k++)
+    {
+        int nthreads = params->dthread_counts[k];
+        lzbench_thread_pool pool(nthreads);
+        std::vector<char*> workmems(nthreads, (char*)NULL);
+        std::vector<uint8_t*> outs(nthreads, (uint8_t*)NULL);
+        std::atomic<bool> failed(false);
+        bench_timer_t start_ticks, end_ticks;
+        uint64_t best = UINT64_MAX, total = 0;
+
+        // every thread allocates its own buffer and workmem, so they are local to it
+        pool.run([&](int t) {
+            outs[t] = (uint8_t*)alloc_and_touch(max_size + PAD_SIZE, false);
+            workmems[t] = desc->init ? desc->init(max_size, param1, param2) : NULL;
+        });
+
+        for (uint32_t pass = 0; !failed; pass++)
+        {
+            GetTime(start_ticks);
+            pool.run([&](int t) {
+                if (!outs[t]) { failed = true; return; }
+                for (size_t j = 0, i = (size_t)t * n / nthreads; j < n; j++, i = (i + 1 < n) ? i + 1 : 0)
+                {
+                    int64_t dlen = chunk_sizes[i];
+                    if (compr_sizes[i] == chunk_sizes[i]) // stored
+                        memcpy(outs[t], compbuf + coffsets[i], chunk_sizes[i]);
+                    else
+                        dlen = desc->decompress((char*)compbuf + coffsets[i], compr_sizes[i], (char*)outs[t], chunk_sizes[i], param1, param2, workmems[t]);
+                    if (pass == 0 && (dlen != (int64_t)chunk_sizes[i] || memcmp(outs[t], inbuf + doffsets[i], chunk_sizes[i]) != 0)) { failed = true; return; }
+                }
+            });
+            GetTime(end_ticks);
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            if (pass > 0 || params->dmintime == 0) best = MIN(best, nanosec); // the first pass is checked and not timed
+            total += nanosec;
+            if (pass >= 1 && pass + 1 >= params->d_iters && total >= (uint64_t)params->dmintime * 1000000) break;
+        }
+
+        pool.run([&](int t) {
+            if (desc->deinit) desc->deinit(workmems[t]);
+            if (outs[t]) free_touched(outs[t]);
+        });
+        if (failed)
+        {
+            printf("ERROR: --dthreads decompression of %s with %d threads failed\n", desc->name, nthreads);
+            return;
+        }
+        counters.shared_dspeed[k] = (best && best != UINT64_MAX) ? (double)insize * nthreads * 1000.0 / best : 0;
+    }
+}
+
+
+/*
+ * --load: open-loop server simulation. Requests for the chunks of the test in turn arrive at fixed gaps or as a
+ * Poisson process of --load=# per second whether the workers (-T#) keep up or not, and wait in a FIFO queue for
+ * a free worker with its own workmem. The response time of a request is from its arrival to the end of its call,
+ * so it includes queueing. Compression and decompression requests are two separate runs with the same arrivals.
+ */
+void lzbench_load(lzbench_params_t *params, const compressor_desc_t* desc, lzbench_thread_pool &pool, std::vector<lzbench_thread_t> &thr, std::vector<size_t> &chunk_sizes,
+                  uint8_t *inbuf, uint8_t *compbuf, size_t comprsize, bench_rate_t rate, size_t param1, size_t param2, lzbench_counters_t &counters)
+{
+    size_t requests = params->load_requests, max_size = 0;
+    std::vector<size_t> compr_sizes, coffsets, doffsets;
+    std::vector<uint64_t> arrival(requests), response(requests), busy(thr.size());
+    std::vector<std::vector<uint8_t> > out(thr.size());
+    std::mt19937_64 rng(1);
+    std::exponential_distribution<double> gap(params->load_rate / 1e9);
+    double clock = 0;
+
+    if (chunk_sizes.empty() || lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, thr[0].workmem, NULL) <= 0) return;
+    for (size_t i = 0, cpos = 0, dpos = 0; i < chunk_sizes.size(); cpos += compr_sizes[i], dpos += chunk_sizes[i], i++)
+    {
+        coffsets.push_back(cpos);
+        doffsets.push_back(dpos);
+        max_size = MAX(max_size, chunk_sizes[i]);
+    }
+    for (size_t t = 0; t < thr.size(); t++)
+        out[t].resize(GET_COMPRESS_BOUND(max_size));
+    for (size_t k = 0; k < requests; k++)
+    {
+        clock = params->load_poisson ? clock + gap(rng) : k * 1e9 / params->load_rate;
+        arrival[k] = (uint64_t)clock;
+    }
+
+    for (int d = 0; d < 2; d++)
+    {
+        std::atomic<size_t> next(0);
+        std::atomic<bool> failed(false);
+        bench_timer_t start_ticks;
+        lzbench_histogram hist;
+        uint64_t elapsed = 1, busy_sum = 0;
+
+        std::fill(busy.begin(), busy.end(), 0);
+        GetTime(start_ticks);
+        pool.run([&](int t) {
+            bench_timer_t now_ticks;
+            for (size_t k; (k = next++) < requests; )
+            {
+                size_t i = k % chunk_sizes.size();
+                uint64_t begin, end;
+                int64_t len;
+                do { GetTime(now_ticks); begin = GetDiffTime(rate, start_ticks, now_ticks); } while (begin < arrival[k]); // an idle worker waits for the request
+                if (!d)
+                    len = desc->compress((char*)inbuf + doffsets[i], chunk_sizes[i], (char*)out[t].data(), out[t].size(), param1, param2, thr[t].workmem);
+                else if (compr_sizes[i] == chunk_sizes[i]) // stored
+                    memcpy(out[t].data(), compbuf + coffsets[i], chunk_sizes[i]), len = chunk_sizes[i];
+                else
+                    len = desc->decompress((char*)compbuf + coffsets[i], compr_sizes[i], (char*)out[t].data(), chunk_sizes[i], param1, param2, thr[t].workmem);
+                GetTime(now_ticks);
+                end = GetDiffTime(rate, start_ticks, now_ticks);
+                response[k] = end - arrival[k];
+                busy[t] += end - begin;
+                if (d && len != (int64_t)chunk_sizes[i]) failed = true;
+            }
+        });
+        if (failed)
+        {
+            printf("ERROR: --load decompression of %s failed\n", desc->name);
+            return;
+        }
+
+        for (size_t k = 0; k < requests; k++)
+        {
+            hist.add(response[k]);
+            elapsed = MAX(elapsed, arrival[k] + response[k]);
+        }
+        for (size_t t = 0; t < thr.size(); t++)
+            busy_sum += busy[t];
+        for (int i = 0; i < LATENCY_PERCENTILES; i++)
+            counters.llat[d][i] = hist.percentile(latency_percentiles[i]) / 1000.0;
+        counters.lbusy[d] = 100.0 * busy_sum / elapsed / thr.size();
+    }
+}
+
+
+/* --trace: lines "c|d size [offset]", empty lines and lines starting with # are skipped */
+int lzbench_load_trace(const char* filename, std::vector<lzbench_trace_t> &trace)
+{
+    FILE* f = fopen(filename, "rb");
+    std::string line;
+    int lineno = 0;
+
+    if (!f) { perror(filename); return 1; }
+
+    while (read_line(f, line))
+    {
+        lzbench_trace_t record;
+        char op[16];
+        unsigned long long size, offset;
+        int fields = sscanf(line.c_str(), "%15s %llu %llu", op, &size, &offset);
+
+        lineno++;
+        if (fields <= 0 || op[0] == '#') continue;
+        record.decompress = !strcmp(op, "d") || !strcmp(op, "decompress");
+        if ((!record.decompress && strcmp(op, "c") && strcmp(op, "compress")) || fields < 2 || size == 0)
+        {
+            fprintf(stderr, "%s:%d: wrong trace record: %s\n", filename, lineno, line.c_str());
+            fclose(f);
+            return 1;
+        }
+        record.size = size;
+        record.offset = (fields == 3) ? (int64_t)offset : -1;
+        trace.push_back(record);
+    }
+    fclose(f);
+    if (trace.empty()) { fprintf(stderr, "%s: no trace records\n", filename); return 1; }
+    return 0;
+}
+
+
+/*
+ * --trace: the records are replayed in order by a single thread with the payload taken from the input. A record
+ * longer than a chunk of the test is cut to it, and one that runs past the end of the input is moved back. Data of
+ * decompression records is compressed before the replay.
+ */
+bool lzbench_trace(lzbench_params_t *params, const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize,
+                   uint8_t *decomp, bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    std::vector<lzbench_trace_t> trace = params->trace;
+    std::vector<size_t> coffsets, csizes;
+    std::vector<uint8_t> cdata;
+    lzbench_histogram hist[2];
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t total = 0, time[2] = { 0, 0 }, bytes[2] = { 0, 0 };
+    size_t pos = 0;
+
+    for (size_t k = 0; k < trace.size(); k++)
+    {
+        lzbench_trace_t &r = trace[k];
+        r.size = MIN(r.size, MIN(chunk_size, insize));
+        if (r.offset < 0) r.offset = (pos + r.size <= insize) ? pos : 0;
+        r.offset = MIN((size_t)r.offset, insize - r.size);
+        pos = r.offset + r.size;
+        if (!r.decompress) continue;
+
+        int64_t clen = desc->compress((char*)inbuf + r.offset, r.size, (char*)compbuf, comprsize, param1, param2, workmem);
+        if (clen <= 0 || clen >= (int64_t)r.size) clen = r.size, memcpy(compbuf, inbuf + r.offset, r.size); // stored like lzbench_compress()
+        coffsets.push_back(cdata.size());
+        csizes.push_back(clen);
+        cdata.insert(cdata.end(), compbuf, compbuf + clen);
+    }
+
+    for (size_t k = 0, j = 0; k < trace.size(); k++)
+    {
+        const lzbench_trace_t &r = trace[k];
+        int64_t len;
+
+        if (!r.decompress)
+        {
+            GetTime(start_ticks);
+            len = desc->compress((char*)inbuf + r.offset, r.size, (char*)compbuf, comprsize, param1, param2, workmem);
+            if (len <= 0 || len >= (int64_t)r.size) len = r.size, memcpy(compbuf, inbuf + r.offset, r.size); // stored like lzbench_compress()
+            GetTime(end_ticks);
+        }
+        else
+        {
+            uint8_t *src = cdata.data() + coffsets[j];
+            GetTime(start_ticks);
+            if (csizes[j] == r.size) // stored
+                memcpy(decomp, src, r.size), len = r.size;
+            else
+                len = desc->decompress((char*)src, csizes[j], (char*)decomp, r.size, param1, param2, workmem);
+            GetTime(end_ticks);
+            if (len != (int64_t)r.size || memcmp(decomp, inbuf + r.offset, r.size) != 0)
+            {
+                printf("ERROR: --trace decompression of record %d of %s failed\n", (int)k, desc->name);
+                return false;
+            }
+            j++;
+        }
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        hist[r.decompress].add(nanosec);
+        time[r.decompress] += nanosec;
+        bytes[r.decompress] += r.size;
+        total += nanosec;
+    }
+
+    for (int d = 0; d < 2; d++)
+    {
+        for (int i = 0; i < LATENCY_PERCENTILES; i++)
+            counters.tlat[d][i] = hist[d].size() ? hist[d].percentile(latency_percentiles[i]) / 1000.0 : 0;
+        counters.tspeed[d] = time[d] ? bytes[d] * 1000.0 / time[d] : 0;
+    }
+    counters.trate = trace.size() * 1000000000.0 / (MAX(total, (uint64_t)1));
+    return true;
+}
+
+
+/*
+ * --iovec: the input is scattered over fragments of iovec_min to iovec_max bytes (random sizes) in allocations of
+ * their own that start at odd multiples of iovec_align, like buffer lists of network and storage stacks. Chunks of
+ * -b# are compressed from their fragments by a copy into a contiguous buffer first and, for codecs with a streaming
+ * interface, by feeding the fragments one by one to a stream of the chunk. Decompression goes to a contiguous buffer
+ * that is copied out to fragments, no codec decodes into a buffer list. Contiguous buffers are run in the same
+ * single-threaded loops for comparison, every path is timed by its fastest pass within -t or -u.
+ */
+typedef struct { uint8_t *data; size_t size; } lzbench_fragment_t;
+
+static const char* iovec_paths[IOVEC_PATHS] = { "contiguous compression", "gather copy compression", "stream compression", "contiguous decompression", "scatter decompression" };
+
+bool lzbench_iovec(lzbench_params_t *params, const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp,
+                   bench_rate_t rate, size_t param1, size_t param2, char* workmem, lzbench_counters_t &counters)
+{
+    std::vector<std::vector<lzbench_fragment_t> > in_frags, out_frags; // of every chunk
+    std::vector<void*> blocks;
+    std::vector<size_t> chunk_sizes, compr_sizes, one(1), one_compr;
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> pick(params->iovec_min, params->iovec_max);
+    const stream_desc_t* stream = (desc->stream && desc->stream->begin && desc->compress != lzbench_feed_compress) ? desc->stream : NULL;
+    size_t align = params->iovec_align;
+    bool ok = true;
+
+    for (size_t pos = 0; pos < insize && ok; )
+    {
+        size_t end = pos + MIN(chunk_size, insize - pos);
+        chunk_sizes.push_back(end - pos);
+        in_frags.resize(in_frags.size() + 1);
+        out_frags.resize(out_frags.size() + 1);
+        for (; pos < end; pos += in_frags.back().back().size)
+        {
+            size_t size = pick(rng);
+            size = MIN(size, end - pos);
+            for (int k = 0; k < 2; k++)
+            {
+                uint8_t *block = (uint8_t*)malloc(size + 3 * align);
+                if (!block) { ok = false; break; }
+                blocks.push_back(block);
+                lzbench_fragment_t frag = { (uint8_t*)(((uintptr_t)block + 2 * align - 1) & ~(uintptr_t)(2 * align - 1)) + align, size };
+                (k ? out_frags : in_frags).back().push_back(frag);
+            }
+            if (!ok) break;
+            memcpy(in_frags.back().back().data, inbuf + pos, size);
+        }
+    }
+    size_t max_chunk = chunk_sizes.empty() ? 0 : *std::max_element(chunk_sizes.begin(), chunk_sizes.end());
+    uint8_t *linear = ok ? (uint8_t*)alloc_and_touch(max_chunk + PAD_SIZE, false) : NULL;
+    if (!linear) ok = false;
+
+    // the fastest pass of each path, a failed pass ends it with 0 MB/s
+    auto run = [&](int path, uint32_t min_ms, std::function<bool()> pass) {
+        bench_timer_t start_ticks, end_ticks, loop_ticks;
+        uint64_t best = UINT64_MAX;
+        GetTime(loop_ticks);
+        for (uint32_t k = 0; ok; k++)
+        {
+            GetTime(start_ticks);
+            bool done = pass();
+            GetTime(end_ticks);
+            if (!done) { printf("ERROR: --iovec %s of %s failed\n", iovec_paths[path], desc->name); return; }
+            best = MIN(best, GetDiffTime(rate, start_ticks, end_ticks));
+            if (GetDiffTime(rate, loop_ticks, end_ticks) >= (uint64_t)min_ms * 1000000) break;
+        }
+        if (ok) counters.iov_speed[path] = insize * 1000.0 / (MAX(best, (uint64_t)1));
+    };
+    auto gather = [&](size_t c) {
+        size_t pos = 0;
+        for (size_t f = 0; f < in_frags[c].size(); f++)
+            memcpy(linear + pos, in_frags[c][f].data, in_frags[c][f].size), pos += in_frags[c][f].size;
+    };
+    auto scatter = [&](size_t c, const uint8_t *src) {
+        for (size_t f = 0; f < out_frags[c].size(); f++)
+            memcpy(out_frags[c][f].data, src, out_frags[c][f].size), src += out_frags[c][f].size;
+    };
+
+    run(1, params->cmintime, [&]() -> bool {
+        size_t outpos = 0;
+        for (size_t c = 0; c < chunk_sizes.size(); c++)
+        {
+            gather(c);
+            one[0] = chunk_sizes[c];
+            int64_t clen = lzbench_compress(params, one, desc->compress, one_compr, linear, compbuf + outpos, comprsize - outpos, param1, param2, workmem, NULL);
+            if (clen <= 0) return false;
+            outpos += clen;
+        }
+        return true;
+    });
+
+    if (stream)
+    {
+        compress_func decode = stream->decompress ? stream->decompress : desc->decompress;
+        bool checked = false;
+        run(2, params->cmintime, [&]() -> bool {
+            std::vector<size_t> stream_sizes;
+            size_t outpos = 0, dpos = 0;
+            for (size_t c = 0; c < chunk_sizes.size(); c++)
+            {
+                char* state = stream->begin(param1, param2);
+                int64_t res = 0;
+                if (!state) return false;
+                for (size_t f = 0; f < in_frags[c].size() && res >= 0; f++)
+                    if ((res = stream->feed(state, (char*)in_frags[c][f].data, in_frags[c][f].size, (char*)compbuf + outpos, comprsize - outpos)) >= 0) outpos += res;
+                if (res < 0) { stream->end(state, NULL, 0); return false; }
+                if ((res = stream->end(state, (char*)compbuf + outpos, comprsize - outpos)) < 0) return false;
+                outpos += res;
+                stream_sizes.push_back(outpos);
+            }
+            if (checked) return true;
+            checked = true; // the streams are read back once, out of the timed loop
+            for (size_t c = 0, cpos = 0; c < chunk_sizes.size(); cpos = stream_sizes[c], dpos += chunk_sizes[c], c++)
+                if (decode((char*)compbuf + cpos, stream_sizes[c] - cpos, (char*)decomp + dpos, chunk_sizes[c], param1, param2, workmem) != (int64_t)chunk_sizes[c]
+                    || memcmp(decomp + dpos, inbuf + dpos, chunk_sizes[c]) != 0) return false;
+            return true;
+        });
+    }
+
+    // the contiguous path runs last, its output is decompressed
+    run(0, params->cmintime, [&]() -> bool {
+        return lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, param1, param2, workmem, NULL) > 0;
+    });
+    run(3, params->dmintime, [&]() -> bool {
+        return lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, param1, param2, workmem, NULL) == (int64_t)insize;
+    });
+
+    bool checked = false;
+    run(4, params->dmintime, [&]() -> bool {
+        uint8_t *src = compbuf;
+        for (size_t c = 0; c < chunk_sizes.size(); src += compr_sizes[c++])
+        {
+            if (compr_sizes[c] == chunk_sizes[c]) { scatter(c, src); continue; } // stored
+            if (desc->decompress((char*)src, compr_sizes[c], (char*)linear, chunk_sizes[c], param1, param2, workmem) != (int64_t)chunk_sizes[c]) return false;
+            scatter(c, linear);
+        }
+        if (checked) return true;
+        checked = true;
+        for (size_t c = 0; c < chunk_sizes.size(); c++)
+            for (size_t f = 0; f < out_frags[c].size(); f++)
+                if (memcmp(out_frags[c][f].data, in_frags[c][f].data, in_frags[c][f].size) != 0) return false;
+        return true;
+    });
+
+    for (size_t b = 0; b < blocks.size(); b++) free(blocks[b]);
+    free_touched(linear);
+    if (!linear) printf("Not enough memory for --iovec fragments\n");
+    return ok;
+}
+
+
+/*
+ * --append: the input is a write-ahead log of records of append_size bytes that are compressed into a single
+ * long-lived stream of a codec with stream_desc_t, flushed every append_records records or append_bytes bytes.
+ * Every append and every flush is timed, the stream is decompressed afterwards and compared with the input.
+ */
+bool lzbench_append(lzbench_params_t *params, const compressor_desc_t* desc, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp,
+                    bench_rate_t rate, size_t param1, size_t param2, char* workmem, int64_t oneshot, lzbench_counters_t &counters)
+{
+    const stream_desc_t* stream = desc->stream;
+    lzbench_histogram hist;
+    bench_timer_t start_ticks, end_ticks;
+    size_t inpos = 0, outpos = 0, records = 0, unflushed = 0;
+    uint64_t append_time = 0, flush_time = 0, flushes = 0;
+    int64_t res;
+
+    char* state = stream->begin(param1, param2);
+    if (!state) return false;
+    while (inpos < insize)
+    {
+        size_t part = MIN(params->append_size, insize - inpos);
+        GetTime(start_ticks);
+        res = stream->feed(state, (char*)inbuf + inpos, part, (char*)compbuf + outpos, comprsize - outpos);
+        GetTime(end_ticks);
+        if (res < 0) goto error;
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        hist.add(nanosec);
+        append_time += nanosec;
+        inpos += part;
+        outpos += res;
+        records++;
+        unflushed += part;
+
+        if (stream->flush && ((params->append_records && records % params->append_records == 0) || (params->append_bytes && unflushed >= params->append_bytes)))
+        {
+            GetTime(start_ticks);
+            res = stream->flush(state, (char*)compbuf + outpos, comprsize - outpos);
+            GetTime(end_ticks);
+            if (res < 0) goto error;
+            flush_time += GetDiffTime(rate, start_ticks, end_ticks);
+            flushes++;
+            outpos += res;
+            unflushed = 0;
+        }
+    }
+    if ((res = stream->end(state, (char*)compbuf + outpos, comprsize - outpos)) < 0) return false;
+    outpos += res;
+
+    res = (stream->decompress ? stream->decompress : desc->decompress)((char*)compbuf, outpos, (char*)decomp, insize, param1, param2, workmem);
+    if (res != (int64_t)insize || memcmp(decomp, inbuf, insize) != 0)
+    {
+        printf("ERROR: --append decompression of %s failed\n", desc->name);
+        return false;
+    }
+
+    for (int i = 0; i < LATENCY_PERCENTILES; i++)
+        counters.alat[i] = hist.percentile(latency_percentiles[i]) / 1000.0;
+    counters.aflush = flushes ? flush_time / 1000.0 / flushes : 0;
+    counters.aflush_pct = 100.0 * flush_time / (MAX(append_time + flush_time, (uint64_t)1));
+    counters.aratio = 100.0 * outpos / insize;
+    counters.aoneshot = oneshot > 0 ? 100.0 * outpos / oneshot : 0;
+    return true;
+error:
+    stream->end(state, NULL, 0);
+    printf("ERROR: --append compression of %s failed\n", desc->name);
+    return false;
+}
+
+
+/* type of a file for --breakdown: its extension or, without one, a guess from the first bytes */
+std::string file_type(const char* filename, const uint8_t* buf, size_t size)
+{
+    const char* base = strrchr(filename, '/');
+    const char* ext;
+    std::string type;
+
+    base = base ? base + 1 : filename;
+    if ((ext = strrchr(base, '.')) != NULL && ext != base && ext[1])
+    {
+        for (type = "*."; *++ext; ) type += tolower((unsigned char)*ext);
+        return type;
+    }
+
+    static const struct { const char* magic; size_t len; const char* type; } magics[] = {
+        { "\x1f\x8b", 2, "(gzip)" }, { "\x28\xb5\x2f\xfd", 4, "(zstd)" }, { "BZh", 3, "(bzip2)" }, { "\xfd" "7zXZ", 5, "(xz)" },
+        { "PK\x03\x04", 4, "(zip)" }, { "\x7f" "ELF", 4, "(elf)" }, { "%PDF", 4, "(pdf)" }, { "\x89PNG", 4, "(png)" }, { "\xff\xd8\xff", 3, "(jpeg)" },
+    };
+    for (size_t i = 0; i < sizeof(magics)/sizeof(magics[0]); i++)
+        if (size >= magics[i].len && !memcmp(buf, magics[i].magic, magics[i].len)) return magics[i].type;
+
+    size_t text = 0, n = MIN(size, (size_t)4096);
+    for (size_t i = 0; i < n; i++)
+        if (buf[i] >= 0x20 || buf[i] == '\n' || buf[i] == '\r' || buf[i] == '\t') text++;
+    return (n && text == n) ? "(text)" : "(binary)";
+}
+
+
+void print_breakdown_row(lzbench_params_t *params, string_table_t& row, size_t files)
+{
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"breakdown\",\"name\":");
+        print_json_string(row.col1_algname.c_str());
+        printf(",\"file\":");
+        print_json_string(row.col6_filename.c_str());
+        printf(",\"files\":%llu,\"orig_size\":%llu,\"compr_size\":%llu,\"ctime_ns\":%llu,\"dtime_ns\":%llu}\n", (unsigned long long)files,
+            (unsigned long long)row.col5_origsize, (unsigned long long)row.col4_comprsize, (unsigned long long)row.col2_ctime, (unsigned long long)row.col3_dtime);
+    }
+    else if (params->show_speed)
+        print_speed(params, row);
+    else
+        print_time(params, row);
+}
+
+
+/*
+ * --breakdown of -j: every file is (de)compressed on its own by one thread after the joined run,
+ * the fastest of -i iterations is taken. Rows are printed for every file (--breakdown=file)
+ * and for every file type, i.e. extension or a guess from the content of files without one.
+ */
+void lzbench_breakdown(lzbench_params_t *params, std::vector<size_t> &file_sizes, const compressor_desc_t* desc, const std::string& name, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t chunk_size, size_t param1, size_t param2, char* workmem)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::map<std::string, std::pair<string_table_t, size_t> > types;
+    std::vector<size_t> chunks, compr_sizes;
+    size_t pos = 0;
+
+    for (size_t i = 0; i < file_sizes.size(); pos += file_sizes[i], i++)
+    {
+        size_t size = file_sizes[i];
+        uint64_t ctime = UINT64_MAX, dtime = UINT64_MAX;
+        int64_t clen = 0, dlen = 0;
+
+        if (size == 0) continue;
+        chunks.clear();
+        for (size_t left = size; left > 0; left -= MIN(left, chunk_size))
+            chunks.push_back(MIN(left, chunk_size));
+
+        for (uint32_t k = 0; k < (MAX(params->c_iters, 1u)); k++)
+        {
+            GetTime(start_ticks);
+            clen = lzbench_compress(params, chunks, desc->compress, compr_sizes, inbuf + pos, compbuf, comprsize, param1, param2, workmem, NULL);
+            GetTime(end_ticks);
+            ctime = MIN(ctime, GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        for (uint32_t k = 0; clen > 0 && k < (MAX(params->d_iters, 1u)); k++)
+        {
+            GetTime(start_ticks);
+            dlen = lzbench_decompress(params, chunks, desc->decompress, compr_sizes, compbuf, decomp + pos, param1, param2, workmem, NULL);
+            GetTime(end_ticks);
+            dtime = MIN(dtime, GetDiffTime(rate, start_ticks, end_ticks));
+        }
+        bool error = clen <= 0 || dlen != (int64_t)size || memcmp(inbuf + pos, decomp + pos, size) != 0;
+
+        string_table_t row(name, MAX(ctime, (uint64_t)1), error ? 0 : MAX(dtime, (uint64_t)1), clen > 0 ? clen : size, size, params->file_names[i]);
+        if (params->breakdown == BREAKDOWN_FILE) print_breakdown_row(params, row, 1);
+
+        std::string type = file_type(params->file_names[i].c_str(), inbuf + pos, size);
+        std::map<std::string, std::pair<string_table_t, size_t> >::iterator it = types.find(type);
+        if (it == types.end())
+            it = types.insert(std::make_pair(type, std::make_pair(string_table_t(name, 0, 0, 0, 0, ""), (size_t)0))).first;
+        string_table_t &t = it->second.first;
+        t.col2_ctime += row.col2_ctime;
+        t.col3_dtime = (error || (it->second.second && !t.col3_dtime)) ? 0 : t.col3_dtime + row.col3_dtime; // 0 = ERROR of any file
+        t.col4_comprsize += row.col4_comprsize;
+        t.col5_origsize += size;
+        it->second.second++;
+    }
+
+    for (std::map<std::string, std::pair<string_table_t, size_t> >::iterator it = types.begin(); it != types.end(); it++)
+    {
+        format(it->second.first.col6_filename, "%s %d files", it->first.c_str(), (int)it->second.second);
+        print_breakdown_row(params, it->second.first, it->second.second);
+    }
+}
+
+
+/*
+ * --cache=dir: the compressed chunks of every codec and level are stored in dir together with their sizes
+ * and the times of compression. A file is named by a hash of the input, the codec, its version and level,
+ * -b# and -T#, and it is valid only for the same chunk sizes. With --decompress-only a stored file is loaded
+ * instead of compression, the stored times of compression are reported again.
+ */
+#define CACHE_MAGIC "LZBCACH1"
+
+/* mkdir -p of the directory of --cache, false if it isn't a directory after that */
+bool cache_mkdir(const char* dir)
+{
+    std::string path = dir;
+    for (size_t pos = 1; pos <= path.size(); pos++)
+        if (pos == path.size() || path[pos] == '/' || path[pos] == '\\')
+        {
+#if defined(_WIN32)
+            _mkdir(path.substr(0, pos).c_str());
+#else
+            mkdir(path.substr(0, pos).c_str(), 0755);
+#endif
+        }
+    return UTIL_isDirectory(dir);
+}
+
+uint64_t cache_hash(const uint8_t *buf, size_t size)
+{
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ size, w;
+    size_t i;
+
+    for (i = 0; i + 8 <= size; i += 8)
+    {
+        memcpy(&w, buf + i, 8);
+        h = (h ^ w) * 0x9FB21C651E98DF25ULL;
+        h ^= h >> 28;
+    }
+    for (; i < size; i++)
+        h = (h ^ buf[i]) * 0x100000001B3ULL;
+    return h ^ (h >> 32);
+}
+
+
+std::string cache_path(lzbench_params_t *params, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, size_t chunk_size, int nthreads, bool steal)
+{
+    std::string path, version = desc->version;
+
+    for (size_t i = 0; i < version.size(); i++)
+        if (!isalnum((unsigned char)version[i]) && version[i] != '.' && version[i] != '-') version[i] = '_';
+    format(path, "%s/%016llx-%llu-%s-%s-%d-b%llu-T%d%s.lzc", params->cache_dir, (unsigned long long)cache_hash(inbuf, insize), (unsigned long long)insize,
+        desc->name, version.c_str(), level, (unsigned long long)chunk_size, nthreads, steal ? "-steal" : "");
+    if (desc->compress == lzbench_feed_compress)
+    {
+        std::string feed;
+        format(feed, "-feed%llu-%llu", (unsigned long long)params->feed_write, (unsigned long long)params->feed_flush);
+        path.insert(path.size() - 4, feed);
+    }
+    if (!params->msg_sizes.empty())
+    {
+        std::string msg = params->msg_random ? "-msgr" : "-msg", size;
+        for (size_t i = 0; i < params->msg_sizes.size(); i++)
+        {
+            format(size, "%s%llu", i ? "_" : "", (unsigned long long)params->msg_sizes[i]);
+            msg += size;
+        }
+        path.insert(path.size() - 4, msg);
+    }
+    if (lzbench_dict && (uses_dictionary(desc) || is_delta(desc)))
+    {
+        std::string dict;
+        format(dict, "-dict%016llx", (unsigned long long)cache_hash((const uint8_t*)lzbench_dict, lzbench_dict_size));
+        path.insert(path.size() - 4, dict);
+    }
+    return path;
+}
+
+
+/* rows of --isolate and --results-cache are frames of a size and the fields of lzbench_row_fields() */
+struct lzbench_row_writer
+{
+    std::string data;
+    template <class T> void operator()(T &v) { data.append((const char*)&v, sizeof(v)); }
+    void operator()(std::string &v) { uint64_t n = v.size(); (*this)(n); data.append(v); }
+    template <class T> void operator()(std::vector<T> &v) { uint64_t n = v.size(); (*this)(n); data.append((const char*)v.data(), n * sizeof(T)); }
+    void operator()(const char* &v) { std::string text = v; (*this)(text); }
+};
+
+struct lzbench_row_reader
+{
+    const char *pos, *end;
+    bool ok;
+    template <class T> void operator()(T &v) { if (end - pos < (ptrdiff_t)sizeof(v)) { ok = false; return; } memcpy(&v, pos, sizeof(v)); pos += sizeof(v); }
+    void operator()(std::string &v) { uint64_t n = 0; (*this)(n); if (!ok || (uint64_t)(end - pos) < n) { ok = false; return; } v.assign(pos, n); pos += n; }
+    template <class T> void operator()(std::vector<T> &v)
+    {
+        uint64_t n = 0; (*this)(n);
+        if (!ok || (uint64_t)(end - pos) / sizeof(T) < n) { ok = false; return; }
+        v.resize(n); memcpy(v.data(), pos, n * sizeof(T)); pos += n * sizeof(T);
+    }
+    void operator()(const char* &v)
+    {
+        static std::set<std::string> strings; // the text of a pointer lives as long as lzbench
+        std::string text;
+        (*this)(text);
+        v = strings.insert(text).first->c_str();
+    }
+};
+
+template <class IO> void lzbench_row_fields(IO &io, string_table_t &row)
+{
+    io(row.col1_algname); io(row.col2_ctime); io(row.col3_dtime); io(row.col4_comprsize); io(row.col5_origsize); io(row.col6_filename);
+    io(row.threads); io(row.numa_mode); io(row.pages); io(row.host); io(row.precheck); io(row.precheck_speedup); io(row.page_cache); io(row.isa);
+    io(row.thr_cspeed); io(row.thr_dspeed); io(row.counters); io(row.clat); io(row.dlat); io(row.cold_ctime); io(row.cold_dtime); io(row.memory);
+    io(row.cstddev); io(row.cci); io(row.dstddev); io(row.dci); io(row.name); io(row.version); io(row.level); io(row.chunk_size); io(row.block_size); io(row.core_type); io(row.llc_ways); io(row.buf_offset);
+    io(row.file_sizes); io(row.csamples); io(row.dsamples); io(row.checksum); io(row.unmeasured); io(row.messages);
+}
+
+
+/* --results-cache: the binary itself, a rebuild gets new rows */
+uint64_t binary_id()
+{
+    static uint64_t id = 0;
+    std::string exe;
+
+    if (id) return id;
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/exe", "rb");
+    if (f)
+    {
+        char buf[65536];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0) exe.append(buf, n);
+        fclose(f);
+    }
+#endif
+    if (exe.empty()) exe = PROGVERSION " " __DATE__ " " __TIME__;
+    id = cache_hash((const uint8_t*)exe.data(), exe.size()) | 1;
+    return id;
+}
+
+
+/*
+ * --results-cache: rows of a codec and level are stored in a file named by a hash of everything that changes them:
+ * the input, its size, the chunk size, name, version, level, options and filters of the codec, -T#, the binary and
+ * the options of the command line. The key is stored in the file too and checked when it's read.
+ */
+std::string results_cache_key(lzbench_params_t *params, const compressor_desc_t* desc, int level, size_t insize)
+{
+    std::string key, threads;
+    format(key, "%016llx %llu %llu %s %s %d %s %s %016llx", (unsigned long long)params->input_hash, (unsigned long long)insize, (unsigned long long)params->chunk_size,
+        desc->name, desc->version, level, params->codec_options.c_str(), params->filters.c_str(), (unsigned long long)binary_id());
+    if (params->block_threads)
+    {
+        format(threads, " mt%d", params->block_threads);
+        key += threads;
+    }
+    for (int k=0; k<params->thread_counts_nb; k++)
+    {
+        format(threads, " T%d", params->thread_counts[k]);
+        key += threads;
+    }
+    if (!params->delta_ref.empty() && is_delta(desc))
+    {
+        format(threads, " delta%016llx", (unsigned long long)cache_hash((const uint8_t*)params->delta_ref.data(), params->delta_ref.size()));
+        key += threads;
+    }
+    if (!params->dict.empty() && uses_dictionary(desc))
+    {
+        format(threads, " dict%016llx", (unsigned long long)cache_hash((const uint8_t*)params->dict.data(), params->dict.size()));
+        key += threads;
+    }
+    return key + params->results_settings;
+}
+
+
+std::string results_cache_path(lzbench_params_t *params, const std::string &key)
+{
+    std::string path;
+    format(path, "%s/%016llx.rows", params->results_cache, (unsigned long long)cache_hash((const uint8_t*)key.data(), key.size()));
+    return path;
+}
+
+
+/* rows of the key are added to results and printed, false if there are none */
+bool results_cache_load(lzbench_params_t *params, const std::string &key)
+{
+    FILE* f = fopen(results_cache_path(params, key).c_str(), "rb");
+    std::string data, stored;
+    std::vector<string_table_t> rows;
+    char buf[65536];
+    size_t n;
+
+    if (!f) return false;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    fclose(f);
+
+    lzbench_row_reader in = { data.data(), data.data() + data.size(), true };
+    in(stored);
+    if (!in.ok || stored != key) return false;
+    while (in.ok && in.pos < in.end)
+    {
+        string_table_t row("", 0, 0, 0, 0, "");
+        lzbench_row_fields(in, row);
+        row.col6_filename = params->in_filename; // the same content may come from another file
+        if (in.ok) rows.push_back(row);
+    }
+    if (!in.ok || rows.empty()) return false;
+
+    LZBENCH_PRINT(5, "%s: %d rows of --results-cache\n", rows[0].col1_algname.c_str(), (int)rows.size());
+    for (size_t r=0; r<rows.size(); r++)
+    {
+        params->results.push_back(rows[r]);
+        if (params->merge_parts) continue; // printed by lzbench_merge_parts()
+        if (params->show_speed)
+            print_speed(params, params->results.back());
+        else
+            print_time(params, params->results.back());
+    }
+    return true;
+}
+
+
+void results_cache_store(lzbench_params_t *params, const std::string &key, size_t first)
+{
+    std::string path = results_cache_path(params, key), tmp = path + ".tmp";
+    lzbench_row_writer out;
+    std::string stored = key;
+
+    if (first >= params->results.size()) return;
+    out(stored);
+    for (size_t r=first; r<params->results.size(); r++)
+    {
+        if (!params->results[r].col3_dtime && !params->results[r].checksum) return; // a decompression error is measured again
+        lzbench_row_fields(out, params->results[r]);
+    }
+
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) { LZBENCH_PRINT(2, "cannot write %s\n", tmp.c_str()); return; }
+    bool ok = fwrite(out.data.data(), 1, out.data.size(), f) == out.data.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) remove(tmp.c_str());
+}
+
+
+/*
+ * Decompressed chunks are verified against hashes of the input computed once per test instead of a memcmp()
+ * of the whole buffer, without zstd the chunks are compared. Chunks are at the same offsets in inbuf and decomp.
+ */
+void chunk_hashes(lzbench_thread_pool &pool, std::vector<size_t> &chunk_sizes, const uint8_t *inbuf, std::vector<size_t> &offsets, std::vector<uint64_t> &hashes)
+{
+    std::atomic<size_t> next(0);
+
+    offsets.resize(chunk_sizes.size());
+    for (size_t k=0, pos=0; k<chunk_sizes.size(); pos += chunk_sizes[k], k++)
+        offsets[k] = pos;
+#ifndef BENCH_REMOVE_ZSTD
+    hashes.resize(chunk_sizes.size());
+    pool.run([&](int) {
+        for (size_t k; (k = next++) < chunk_sizes.size(); )
+            hashes[k] = XXH64(inbuf + offsets[k], chunk_sizes[k], 0);
+    });
+#endif
+}
+
+
+/* index of the first chunk of decomp that differs from inbuf or -1, the head and tail of every chunk is inverted
+ * afterwards, so a codec that doesn't write a chunk fails the next check without clearing the whole output */
+int64_t verify_chunks(lzbench_thread_pool &pool, std::vector<size_t> &chunk_sizes, std::vector<size_t> &offsets, std::vector<uint64_t> &hashes,
+    const uint8_t *inbuf, uint8_t *decomp)
+{
+    std::atomic<size_t> next(0);
+    std::atomic<int64_t> failed(INT64_MAX);
+
+    pool.run([&](int) {
+        for (size_t k; (k = next++) < chunk_sizes.size(); )
+        {
+            const uint8_t *in = inbuf + offsets[k];
+            uint8_t *out = decomp + offsets[k];
+            size_t size = chunk_sizes[k], edge = MIN(size, (size_t)64);
+#ifndef BENCH_REMOVE_ZSTD
+            bool ok = hashes.empty() ? memcmp(in, out, size) == 0 : XXH64(out, size, 0) == hashes[k];
+#else
+            bool ok = memcmp(in, out, size) == 0;
+#endif
+            if (!ok)
+            {
+                for (int64_t f = failed; (int64_t)k < f && !failed.compare_exchange_weak(f, k); ) {}
+                continue;
+            }
+            for (size_t j=0; j<edge; j++)
+                out[j] = ~in[j], out[size-1-j] = ~in[size-1-j];
+        }
+    });
+    return failed == INT64_MAX ? -1 : (int64_t)failed;
+}
+
+
+/* sizes of compressed chunks in the order of chunk_sizes, with work stealing they are in chunks */
+void cache_slots(std::vector<lzbench_thread_t> &thr, lzbench_chunks_t *chunks, std::vector<size_t*> &slots)
+{
+    slots.clear();
+    if (chunks)
+    {
+        for (size_t k = 0; k < chunks->compr_sizes.size(); k++) slots.push_back(&chunks->compr_sizes[k]);
+        return;
+    }
+    for (size_t t = 0; t < thr.size(); t++)
+    {
+        thr[t].compr_sizes.resize(thr[t].chunk_sizes.size());
+        for (size_t k = 0; k < thr[t].compr_sizes.size(); k++) slots.push_back(&thr[t].compr_sizes[k]);
+    }
+}
+
+
+/* --sample: mean and 95% confidence interval of the ratios of chunks, every sampled block is at least one chunk */
+void block_ratio_ci(std::vector<lzbench_thread_t> &thr, lzbench_chunks_t *chunks, lzbench_counters_t &counters)
+{
+    double sum = 0, sum2 = 0;
+    size_t n = 0;
+
+    for (size_t t = 0; t < (chunks ? 1 : thr.size()); t++)
+    {
+        std::vector<size_t> &in = chunks ? chunks->chunk_sizes : thr[t].chunk_sizes, &out = chunks ? chunks->compr_sizes : thr[t].compr_sizes;
+        for (size_t k = 0; k < in.size() && k < out.size(); k++)
+        {
+            if (!in[k]) continue;
+            double ratio = out[k] * 100.0 / in[k];
+            sum += ratio;
+            sum2 += ratio * ratio;
+            n++;
+        }
+    }
+    counters.ratio_mean = n ? sum / n : 0;
+    counters.ratio_ci = n > 1 ? 1.96 * sqrt(std::max(0.0, (sum2 - sum * sum / n) / (n - 1)) / n) : 0;
+}
+
+
+/* positions of compressed chunks given their sizes, NULL if they would not fit */
+bool cache_chunks(std::vector<lzbench_thread_t> &thr, lzbench_chunks_t *chunks, uint8_t *steal_compbuf, std::vector<uint8_t*> &ptrs)
+{
+    ptrs.clear();
+    if (chunks)
+    {
+        for (size_t k = 0; k < chunks->compr_sizes.size(); k++)
+        {
+            if (chunks->compr_sizes[k] > chunks->out_bounds[k]) return false;
+            ptrs.push_back(steal_compbuf + chunks->out_offsets[k]);
+        }
+        return true;
+    }
+    for (size_t t = 0; t < thr.size(); t++)
+    {
+        size_t pos = 0;
+        for (size_t k = 0; k < thr[t].compr_sizes.size(); k++)
+        {
+            ptrs.push_back(thr[t].compbuf + pos);
+            pos += thr[t].compr_sizes[k];
+        }
+        if (pos > thr[t].comprsize) return false;
+        thr[t].complen = pos;
+    }
+    return true;
+}
+
+
+bool lzbench_cache_store(const std::string& path, std::vector<size_t> &chunk_sizes, std::vector<lzbench_thread_t> &thr, lzbench_chunks_t *chunks, uint8_t *steal_compbuf, std::vector<uint64_t> &ctime)
+{
+    std::string tmp = path + ".tmp";
+    std::vector<size_t*> slots;
+    std::vector<uint8_t*> ptrs;
+    std::vector<uint64_t> header;
+    bool ok;
+
+    cache_slots(thr, chunks, slots);
+    if (!cache_chunks(thr, chunks, steal_compbuf, ptrs)) return false;
+    header.push_back(chunk_sizes.size());
+    for (size_t k = 0; k < chunk_sizes.size(); k++) header.push_back(chunk_sizes[k]);
+    for (size_t k = 0; k < slots.size(); k++) header.push_back(*slots[k]);
+    header.push_back(ctime.size());
+    header.insert(header.end(), ctime.begin(), ctime.end());
+
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) { perror(tmp.c_str()); return false; }
+    ok = fwrite(CACHE_MAGIC, 1, 8, f) == 8 && fwrite(header.data(), sizeof(uint64_t), header.size(), f) == header.size();
+    for (size_t k = 0; ok && k < ptrs.size(); k++)
+        ok = fwrite(ptrs[k], 1, *slots[k], f) == *slots[k];
+    ok = (fclose(f) == 0) && ok;
+    if (ok) ok = (rename(tmp.c_str(), path.c_str()) == 0); // a file in the cache is always complete
+    if (!ok) { perror(path.c_str()); remove(tmp.c_str()); }
+    return ok;
+}
+
+
+/* returns the total compressed size, 0 if path does not exist or does not match chunk_sizes */
+int64_t lzbench_cache_load(const std::string& path, std::vector<size_t> &chunk_sizes, std::vector<lzbench_thread_t> &thr, lzbench_chunks_t *chunks, uint8_t *steal_compbuf, std::vector<uint64_t> &ctime)
+{
+    std::vector<size_t*> slots;
+    std::vector<uint8_t*> ptrs;
+    char magic[8];
+    uint64_t n, v;
+    int64_t complen = 0;
+    bool ok;
+
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    ok = fread(magic, 1, 8, f) == 8 && !memcmp(magic, CACHE_MAGIC, 8) && fread(&n, sizeof(n), 1, f) == 1 && n == chunk_sizes.size();
+    for (size_t k = 0; ok && k < chunk_sizes.size(); k++)
+        ok = fread(&v, sizeof(v), 1, f) == 1 && v == chunk_sizes[k];
+    cache_slots(thr, chunks, slots);
+    for (size_t k = 0; ok && k < slots.size(); k++)
+        ok = fread(&v, sizeof(v), 1, f) == 1 && (*slots[k] = v) > 0;
+    ok = ok && fread(&n, sizeof(n), 1, f) == 1 && n < (1 << 24);
+    if (ok)
+    {
+        ctime.resize(n);
+        ok = fread(ctime.data(), sizeof(uint64_t), n, f) == n;
+    }
+    ok = ok && cache_chunks(thr, chunks, steal_compbuf, ptrs);
+    for (size_t k = 0; ok && k < ptrs.size(); k++)
+    {
+        ok = fread(ptrs[k], 1, *slots[k], f) == *slots[k];
+        complen += *slots[k];
+    }
+    fclose(f);
+    if (!ok)
+    {
+        fprintf(stderr, "warning: %s does not match the input, it is compressed again\n", path.c_str());
+        ctime.clear();
+        return 0;
+    }
+    return complen;
+}
+
+
+size_t msg_max_size(lzbench_params_t *params)
+{
+    return params->msg_random ? params->msg_sizes[1] : *std::max_element(params->msg_sizes.begin(), params->msg_sizes.end());
+}
+
+
+/* cut every file into messages of --msg, the same sizes for all codecs; none is longer than max_size of the codec */
+void msg_chunk_sizes(lzbench_params_t *params, std::vector<size_t> &file_sizes, size_t max_size, std::vector<size_t> &chunk_sizes)
+{
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<size_t> random_size(params->msg_sizes[0], params->msg_sizes.back());
+    size_t k = 0;
+
+    for (size_t i=0; i<file_sizes.size(); i++)
+        for (size_t left = file_sizes[i]; left > 0; )
+        {
+            size_t size = params->msg_random ? random_size(rng) : params->msg_sizes[k++ % params->msg_sizes.size()];
+            size = MIN(MIN(size, max_size), left);
+            chunk_sizes.push_back(size);
+            left -= size;
+        }
+}
+
+
+/*
+ * -P#: processes of a test wait for each other before the timed loops of compression and decompression,
+ * so their loops run at the same time. The barrier lives in shared memory, it's NULL outside of the children.
+ */
+struct lzbench_process_barrier_t
+{
+    std::atomic<int> count, generation, broken;
+    int parties;
+};
+
+static lzbench_process_barrier_t* process_barrier = NULL;
+
+void process_barrier_wait()
+{
+    lzbench_process_barrier_t* b = process_barrier;
+    if (!b || b->broken) return;
+
+    int generation = b->generation;
+    if (b->count.fetch_add(1) + 1 == b->parties)
+    {
+        b->count = 0;
+        b->generation++;
+        return;
+    }
+    while (b->generation == generation && !b->broken) // a process that died breaks the barrier
+        std::this_thread::yield();
+}
+
+
+/*
+ * --noise: co-runner threads that contend for memory while a codec is timed again, like services that share
+ * a socket with it. Stream reads a half of its buffer into the other half in blocks of 1 MB, paced to a share
+ * of noise_gbs, chase follows a random cycle of 64-byte lines through a buffer larger than the LLC and dirties
+ * every line it visits. They are pinned to the last allowed CPUs (Linux), the test keeps the first ones.
+ */
+#define NOISE_PASSES 5
+#define UNFUSED_PASSES 5 // --consume: passes of decompression followed by the consumer
+
+struct noise_t
+{
+    std::vector<std::thread> threads;
+    std::atomic<bool> stop;
+    std::atomic<uint64_t> bytes;
+    std::chrono::steady_clock::time_point start;
+    noise_t() : stop(false), bytes(0) {}
+};
+
+void noise_run(lzbench_params_t *params, noise_t *noise, int id, int cpu)
+{
+#if defined(__linux__)
+    if (cpu >= 0)
+    {
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        CPU_SET(cpu, &mask);
+        if (sched_setaffinity(0, sizeof(mask), &mask) != 0) LZBENCH_PRINT(5, "sched_setaffinity failed for co-runner %d\n", id);
+    }
+#else
+    (void)cpu;
+#endif
+    const size_t block = 1 << 20;
+    size_t size = MAX(params->noise_size, 2 * block);
+    std::vector<uint64_t> buf(size / sizeof(uint64_t), 1);
+    uint64_t done = 0;
+
+    if (params->noise_mode == NOISE_CHASE)
+    {
+        // Sattolo's shuffle makes a single cycle through all lines, the walk can't be prefetched
+        size_t lines = size / 64, step = 64 / sizeof(uint64_t), pos = 0;
+        std::vector<uint32_t> order(lines);
+        std::mt19937 rng(id + 1);
+        for (size_t i = 0; i < lines; i++) order[i] = i;
+        for (size_t i = lines - 1; i > 0; i--) std::swap(order[i], order[rng() % i]);
+        for (size_t i = 0; i < lines; i++) buf[order[i] * step] = order[(i + 1) % lines];
+        while (!noise->stop.load(std::memory_order_relaxed))
+        {
+            for (int i = 0; i < 4096; i++)
+            {
+                pos = buf[pos * step] & 0xFFFFFFFF;
+                buf[pos * step + 1]++;
+            }
+            done += 4096 * 64;
+            noise->bytes.fetch_add(4096 * 64, std::memory_order_relaxed);
+        }
+        return;
+    }
+
+    uint8_t *data = (uint8_t*)buf.data();
+    double rate = params->noise_gbs * 1e9 / params->noise_threads; // bytes per second of this co-runner, read and written
+    auto start = std::chrono::steady_clock::now();
+    for (size_t off = 0; !noise->stop.load(std::memory_order_relaxed); off = (off + block) % (size / 2 / block * block))
+    {
+        memcpy(data + size / 2 + off, data + off, block);
+        done += 2 * block;
+        noise->bytes.fetch_add(2 * block, std::memory_order_relaxed);
+        if (rate > 0)
+            while (!noise->stop.load(std::memory_order_relaxed) && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * rate < done)
+                std::this_thread::yield();
+    }
+}
+
+void noise_start(lzbench_params_t *params, noise_t &noise, int test_threads)
+{
+    std::vector<int> cpus;
+#if defined(__linux__)
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    sched_getaffinity(0, sizeof(mask), &mask);
+    for (int c = CPU_SETSIZE - 1; c >= 0; c--)
+        if (CPU_ISSET(c, &mask)) cpus.push_back(c);
+#endif
+    static bool warned = false;
+    if (!warned && (int)cpus.size() < test_threads + params->noise_threads)
+        fprintf(stderr, "warning: --noise: %d co-runners and %d test threads share %d CPUs\n", params->noise_threads, test_threads, (int)cpus.size()), warned = true;
+
+    noise.stop = false;
+    noise.bytes = 0;
+    noise.start = std::chrono::steady_clock::now();
+    for (int i = 0; i < params->noise_threads; i++)
+        noise.threads.push_back(std::thread(noise_run, params, &noise, i, cpus.empty() ? -1 : cpus[i % cpus.size()]));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // buffers are filled and the co-runners are at speed
+}
+
+/* GB/s of all co-runners */
+float noise_stop(noise_t &noise)
+{
+    noise.stop = true;
+    for (size_t i = 0; i < noise.threads.size(); i++) noise.threads[i].join();
+    noise.threads.clear();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - noise.start).count();
+    return seconds > 0 ? noise.bytes / seconds / 1e9 : 0;
+}
+
+
+/*
+ * --setup: the life of a context of a request, init, compression and decompression of the first chunk and deinit,
+ * timed SETUP_RUNS times with a new context each. The first run also pays for process-wide lazy initialization
+ * (tables, dictionaries, device setup) of a short-lived process, the median is the cost of a new context in a
+ * process that keeps running. Against the time of a call, it shows whether contexts are worth pooling.
+ */
+#define SETUP_RUNS 5
+
+void lzbench_setup(const compressor_desc_t* desc, size_t chunk_size, uint8_t *inbuf, uint8_t *compbuf, size_t comprsize, uint8_t *decomp,
+                   bench_rate_t rate, size_t param1, size_t param2, lzbench_counters_t &counters)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<uint64_t> times[4]; // init, deinit, compression, decompression
+    size_t outsize = MIN(GET_COMPRESS_BOUND(chunk_size), comprsize);
+
+    for (int run = 0; run < SETUP_RUNS; run++)
+    {
+        char* workmem = NULL;
+        int64_t clen, dlen = 0;
+
+        GetTime(start_ticks);
+        if (desc->init) workmem = desc->init(chunk_size, param1, param2);
+        GetTime(end_ticks);
+        times[0].push_back(GetDiffTime(rate, start_ticks, end_ticks));
+
+        GetTime(start_ticks);
+        clen = desc->compress((char*)inbuf, chunk_size, (char*)compbuf, outsize, param1, param2, workmem);
+        GetTime(end_ticks);
+        times[2].push_back(GetDiffTime(rate, start_ticks, end_ticks));
+
+        GetTime(start_ticks);
+        if (clen > 0 && (size_t)clen != chunk_size) // not stored
+            dlen = desc->decompress((char*)compbuf, clen, (char*)decomp, chunk_size, param1, param2, workmem);
+        GetTime(end_ticks);
+        times[3].push_back(dlen > 0 ? GetDiffTime(rate, start_ticks, end_ticks) : 0);
+
+        GetTime(start_ticks);
+        if (desc->deinit) desc->deinit(workmem);
+        GetTime(end_ticks);
+        times[1].push_back(GetDiffTime(rate, start_ticks, end_ticks));
+    }
+
+    counters.scold_us[0] = times[0][0] / 1000.0;
+    counters.scold_us[1] = times[2][0] / 1000.0;
+    counters.scold_us[2] = times[3][0] / 1000.0;
+    for (int k = 0; k < 4; k++)
+    {
+        std::sort(times[k].begin(), times[k].end());
+        float median = times[k][SETUP_RUNS / 2] / 1000.0;
+        if (k == 0) counters.sinit_us = median;
+        else if (k == 1) counters.sdeinit_us = median;
+        else counters.sfirst_us[k - 2] = median;
+    }
+}
+
+
+/*
+ * --warmup: passes that are run but not recorded before the samples, so that lazy initialization of tables,
+ * page faults of the buffers and cold branch predictors don't get into average or median times. It returns the
+ * time of the first pass, the first-use latency of the codec.
+ */
+uint64_t lzbench_warmup(lzbench_params_t *params, bench_rate_t rate, std::function<uint64_t(bool)> &pass)
+{
+    bench_timer_t start_ticks, end_ticks;
+    uint64_t first = 0;
+
+    GetTime(start_ticks);
+    for (uint32_t k = 0; ; k++)
+    {
+        uint64_t nanosec = pass(false);
+        if (k == 0) first = nanosec;
+        GetTime(end_ticks);
+        if (k + 1 >= params->warmup_passes && GetDiffTime(rate, start_ticks, end_ticks) >= (uint64_t)params->warmup_ms * 1000000) break;
+    }
+    return first;
+}
+
+
+void lzbench_test(lzbench_params_t *params, std::vector<size_t> &file_sizes, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1)
+{
+    float speed;
+    int i, total_c_iters, total_d_iters;
+    bench_timer_t loop_ticks, start_ticks, end_ticks, timer_ticks;
+    int64_t complen=0, decomplen;
+    uint64_t nanosec, total_nanosec;
+    std::vector<uint64_t> ctime, dtime;
+    std::vector<size_t> chunk_sizes, chunk_offsets;
+    std::vector<uint64_t> input_hashes;
+    int64_t bad_chunk;
+    bool decomp_error = false;
+    size_t param2 = desc->additional_param;
+    size_t chunk_size = params->msg_sizes.empty() ? MIN(params->chunk_size, insize) : MIN(msg_max_size(params), insize);
+    int nthreads = (params->threads > 1) ? params->threads : 1;
+    std::vector<lzbench_thread_t> thr(nthreads);
+    lzbench_thread_pool pool(nthreads);
+    bool steal = (params->work_stealing && nthreads > 1);
+    std::vector<lzbench_steal_t> queues(nthreads);
+    lzbench_chunks_t chunks;
+    uint8_t *steal_compbuf = compbuf;
+    uint64_t total_cnanosec = 0, total_dnanosec = 0;
+    lzbench_counters_t counters;
+    std::vector<uint64_t> cold_ctime, cold_dtime;
+    uint64_t cold_loop_nanosec;
+    std::function<uint64_t(bool)> compress_pass, decompress_pass;
+    lzbench_memory_t memory;
+    int64_t mem_start, mem_peak;
+    uint64_t allocs_start, allocs_end, cpasses = 0, dpasses = 0;
+    std::vector<uint64_t> energy_start, energy_end;
+    uint64_t throttle_start = 0;
+    uint64_t timeline_verify;
+    uint64_t cg_periods_start = 0, cg_periods_end;
+    double cg_ms_start = 0, cg_ms_end;
+    bool measure_energy = params->energy && !rapl_files.empty();
+    bool measure_llc = params->llc_mon && !llc_mon_dirs.empty();
+    uint64_t llc_occupancy, mbm_start = UINT64_MAX, mbm_end;
+    bool file_backed = params->in_path && (params->mmap_direct || params->pipeline_dir); // --page-cache applies to this test
+    std::string cache_file;
+    bool cached = false;
+#if defined(__linux__)
+    cpu_set_t main_mask;
+#endif
+
+    LZBENCH_PRINT(5, "*** trying %s insize=%zu comprsize=%zu chunk_size=%zu threads=%d\n", desc->name, insize, comprsize, chunk_size, nthreads);
+
+    memset(&counters, 0, sizeof(counters));
+    if (params->dedup_sweep)
+    {
+        counters.dedup_insize = params->dedup.insize;
+        counters.dedup_recipe = params->dedup.recipe;
+        counters.dedup_ns = params->dedup.dedup_ns;
+        counters.dedup_restore_ns = params->dedup.restore_ns;
+    }
+    memset(&memory, 0, sizeof(memory));
+    for (int t=0; t<nthreads; t++)
+    {
+        thr[t].workmem = NULL;
+        for (int i=0; i<PERF_COUNTERS; i++) thr[t].perf_fd[i] = -1;
+        for (int i=0; i<TOPDOWN_EVENTS; i++) thr[t].td_fd[i] = -1;
+    }
+
+    if (chunk_size > codec_chunk_limit(desc))
+    {
+        chunk_size = codec_chunk_limit(desc);
+        LZBENCH_PRINT(5, "%s chunk_size reduced to %zu, the limit of its API\n", desc->name, chunk_size);
+    }
+    if (!desc->compress || !desc->decompress) goto done;
+    probe_codec = desc->name;
+    probe_level = level;
+    if (is_delta(desc)) lzbench_dict = params->delta_ref.data(), lzbench_dict_size = params->delta_ref.size();
+
+    if (params->setup && desc != comp_desc && !is_checksum(desc) && !params->collect_jobs)
+        lzbench_setup(desc, MIN(chunk_size, insize), inbuf, compbuf, comprsize, decomp, rate, param1, param2, counters); // before the first init of the test
+#ifdef BENCH_HAS_NVCOMP
+    lzbench_cuda_setup_timing(counters.cuda_alloc_ns, counters.cuda_metadata_ns, counters.cuda_pool_hits); // drop the setup of earlier tests
+    counters.cuda_alloc_ns = counters.cuda_metadata_ns = counters.cuda_pool_hits = 0;
+#endif
+
+    lzbench_mem_stats(&mem_start, NULL, NULL);
+    for (int t=0; t<nthreads; t++)
+    {
+        uint64_t timeline_init = timeline_now();
+        if (desc->init) thr[t].workmem = desc->init(chunk_size, param1, param2);
+        timeline_end("init", "init", timeline_init, t);
+    }
+    lzbench_mem_stats(&mem_peak, NULL, NULL);
+    memory.init_bytes = mem_peak - mem_start;
+#if defined(__linux__)
+    for (int t=0; t<nthreads; t++)
+        if (thr[t].workmem) memory.init_bytes += malloc_usable_size(thr[t].workmem); // all init functions return heap memory or NULL
+#endif
+
+    // allocations of the cspeed probe are included, the first call of a codec often allocates its tables
+    lzbench_mem_reset_peak();
+    lzbench_mem_stats(&mem_start, NULL, &allocs_start);
+
+    if (params->cspeed > 0)
+    {
+        size_t part = MIN(100*1024, chunk_size);
+        GetTime(start_ticks);
+        int64_t clen = desc->compress((char*)inbuf, part, (char*)compbuf, GET_COMPRESS_BOUND(part), param1, param2, thr[0].workmem);
+        GetTime(end_ticks);
+        nanosec = GetDiffTime(rate, start_ticks, end_ticks)/1000;
+        if (clen>0 && nanosec>=1000)
+        {
+            part = (part / nanosec); // speed in MB/s
+            if (part < params->cspeed) { LZBENCH_PRINT(7, "%s (100K) slower than %d MB/s nanosec=%d\n", desc->name, (uint32_t)part, (uint32_t)nanosec); params->below_cspeed = 1; goto done; }
+        }
+    }
+
+    if (!params->msg_sizes.empty())
+        msg_chunk_sizes(params, file_sizes, chunk_size, chunk_sizes);
+    else
+    for (int i=0; i<file_sizes.size(); i++) {
+        size_t tmpsize = file_sizes[i];
+        while (tmpsize > 0)
+        {
+            chunk_sizes.push_back(MIN(tmpsize, chunk_size));
+            tmpsize -= MIN(tmpsize, chunk_size);
+        }
+    }
+
+    if (nthreads > 1 && chunk_sizes.size() < nthreads && params->msg_sizes.empty())
+    {
+        // give every thread at least one chunk
+        size_t thr_chunk_size = (insize + nthreads - 1) / nthreads;
+        LZBENCH_PRINT(5, "%s chunk_size reduced to %zu for %d threads\n", desc->name, thr_chunk_size, nthreads);
+        chunk_sizes.clear();
+        for (int i=0; i<file_sizes.size(); i++) {
+            size_t tmpsize = file_sizes[i];
+            while (tmpsize > 0)
+            {
+                chunk_sizes.push_back(MIN(tmpsize, thr_chunk_size));
+                tmpsize -= MIN(tmpsize, thr_chunk_size);
+            }
+        }
+    }
+
+    if (desc->bound)
+    {
+        // an exact bound of every chunk instead of the blanket one, with a pad for calls over the whole input
+        size_t bound = PAD_SIZE;
+        for (size_t k=0; k<chunk_sizes.size(); k++)
+            bound += codec_bound(desc, chunk_sizes[k]);
+        comprsize = MIN(comprsize, bound);
+        LZBENCH_PRINT(5, "%s comprsize=%llu with its bound\n", desc->name, (unsigned long long)comprsize);
+    }
+    lzbench_split_chunks(chunk_sizes, thr, inbuf, insize, compbuf, comprsize, decomp, desc);
+#if defined(__linux__)
+    if (params->pin_mode != PIN_NONE)
+        sched_getaffinity(0, sizeof(main_mask), &main_mask);
+#endif
+    if (params->pin_mode != PIN_NONE || params->numa_mode != NUMA_DEFAULT)
+        pool.run([&](int t) { lzbench_place_thread(params, thr, t); });
+    touch_pages(compbuf, comprsize); // after NUMA placement, pages of earlier codecs are touched already
+    if (params->perf_counters)
+        pool.run([&](int t) { perf_open(params, thr[t]); }); // counters are bound to the thread that opens them
+    for (int t=0; t<nthreads; t++)
+    {
+        thr[t].best_cnanosec = thr[t].best_dnanosec = UINT64_MAX;
+        thr[t].busy_cnanosec = thr[t].busy_dnanosec = 0;
+        thr[t].csteals = thr[t].dsteals = 0;
+        thr[t].cbytes = thr[t].dbytes = 0;
+        memset(&thr[t].cfreq, 0, sizeof(lzbench_freq_t));
+        memset(&thr[t].dfreq, 0, sizeof(lzbench_freq_t));
+        thr[t].chist.rate = thr[t].dhist.rate = rate;
+    }
+
+    if (steal)
+    {
+        // every chunk gets its own bound in the output buffer, allocate a larger one if needed
+        size_t inpos = 0, outpos = 0;
+        chunks.chunk_sizes = chunk_sizes;
+        chunks.compr_sizes.resize(chunk_sizes.size());
+        for (size_t k=0; k<chunk_sizes.size(); k++)
+        {
+            chunks.in_offsets.push_back(inpos);
+            chunks.out_offsets.push_back(outpos);
+            chunks.out_bounds.push_back(codec_bound(desc, chunk_sizes[k]));
+            inpos += chunk_sizes[k];
+            outpos += chunks.out_bounds.back();
+        }
+        if (outpos > comprsize)
+        {
+            LZBENCH_PRINT(5, "%s work stealing needs comprsize=%zu\n", desc->name, (size_t)outpos);
+            steal_compbuf = (uint8_t*)alloc_and_touch(outpos, false);
+            if (!steal_compbuf) { printf("Not enough memory for work stealing!\n"); steal_compbuf = compbuf; goto done; }
+        }
+    }
+
+    LZBENCH_PRINT(5, "%s chunk_sizes=%d\n", desc->name, (int)chunk_sizes.size());
+
+    if (params->cache_dir && desc != comp_desc)
+    {
+        cache_file = cache_path(params, desc, level, inbuf, insize, chunk_size, nthreads, steal);
+        if (params->decompress_only && (complen = lzbench_cache_load(cache_file, chunk_sizes, thr, steal ? &chunks : NULL, steal_compbuf, ctime)) > 0)
+            cached = true;
+        LZBENCH_PRINT(5, "%s cache %s %s\n", desc->name, cache_file.c_str(), cached ? "loaded" : "not loaded");
+    }
+    else if (params->decode_data && chunk_sizes.size() == 1 && params->decode_size <= comprsize)
+    {
+        // lzbench_decode_files(): the compressed file is the only chunk
+        memcpy(thr[0].compbuf, params->decode_data, params->decode_size);
+        thr[0].compr_sizes.assign(1, params->decode_size);
+        complen = params->decode_size;
+        cached = true;
+    }
+
+    // a single timed pass over all chunks, only hot passes are used for counters, latency and per-thread stats
+    if (params->page_cache == PAGECACHE_WARM && file_backed) lzbench_page_cache(params, params->mmap_direct ? inbuf : NULL, insize);
+
+    compress_pass = [&](bool hot) -> uint64_t {
+        cpasses++;
+        if (params->page_cache == PAGECACHE_COLD && params->mmap_direct && params->in_path) lzbench_page_cache(params, inbuf, insize);
+        if (measure_energy && hot) rapl_read(energy_start);
+        if (measure_llc && hot) llc_mon_read(llc_occupancy, mbm_start);
+        precheck_chunks = precheck_skipped = 0;
+#ifdef BENCH_HAS_NVCOMP
+        uint64_t kernel_ns = 0, transfer_ns = 0;
+        lzbench_cuda_timing(kernel_ns, transfer_ns); // drop the time of earlier calls
+        uint64_t gpu_ns[CUDA_DEVICES_MAX] = {0}, gpu_bytes[CUDA_DEVICES_MAX] = {0};
+        lzbench_cuda_device_timing(gpu_ns, gpu_bytes);
+#ifndef BENCH_REMOVE_LZ4
+        lzbench_hybrid_share(kernel_ns);
+#endif
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+        uint64_t zstd_trace[ZSTD_TRACE_COUNTERS] = {0};
+        if (lzbench_zstd_trace) lzbench_zstd_trace_timing(zstd_trace); // drop frames of earlier calls
+#endif
+        uint64_t rusage_start[6];
+        if (params->rusage && hot) rusage_read(rusage_start);
+        GetTime(start_ticks);
+        if (steal) lzbench_reset_queues(queues, thr);
+        pool.run([&](int t) {
+            bench_timer_t thr_start, thr_end;
+            uint64_t perf_start[PERF_COUNTERS], perf_end[PERF_COUNTERS], td_start[TOPDOWN_EVENTS], td_end[TOPDOWN_EVENTS];
+            lzbench_histogram* chist = (params->latency && hot) ? &thr[t].chist : NULL;
+            if (params->perf_counters && hot) perf_read(thr[t], perf_start);
+            if (params->topdown && hot) topdown_read(thr[t], td_start);
+            uint64_t timeline_pass = timeline_now();
+            GetTime(thr_start);
+            if (steal)
+                thr[t].complen = lzbench_compress_steal(params, queues, t, chunks, desc->compress, inbuf, steal_compbuf, param1, param2, thr[t].workmem, thr[t].csteals, thr[t].cbytes, chist);
+            else if (desc->compress_batch && !params->no_batch && !precheck_mode && !chist)
+                thr[t].complen = lzbench_compress_batch(params, thr[t].chunk_sizes, desc, thr[t].compr_sizes, thr[t].inbuf, thr[t].compbuf, thr[t].comprsize, param1, param2, thr[t].workmem);
+            else
+                thr[t].complen = lzbench_compress(params, thr[t].chunk_sizes, desc->compress, thr[t].compr_sizes, thr[t].inbuf, thr[t].compbuf, thr[t].comprsize, param1, param2, thr[t].workmem, chist);
+            GetTime(thr_end);
+            timeline_end(hot ? "compress pass" : "compress pass (not timed)", "pass", timeline_pass);
+            if (!hot) return;
+            thr[t].nanosec = GetDiffTime(rate, thr_start, thr_end);
+            thr[t].busy_cnanosec += thr[t].nanosec;
+            if (params->freq_threshold > 0) freq_add(thr[t].cfreq, freq_read());
+            if (params->perf_counters)
+            {
+                perf_read(thr[t], perf_end);
+                for (int k=0; k<PERF_COUNTERS; k++) thr[t].cperf[k] += perf_end[k] - perf_start[k];
+            }
+            if (params->topdown)
+            {
+                topdown_read(thr[t], td_end);
+                for (int k=0; k<TOPDOWN_EVENTS; k++) thr[t].ctd[k] += td_end[k] - td_start[k];
+            }
+        });
+        GetTime(end_ticks);
+        complen = 0;
+        for (int t=0; t<nthreads; t++)
+            complen += thr[t].complen;
+        if (hot)
+        {
+            if (params->rusage) rusage_add(counters, 0, rusage_start, GetDiffTime(rate, start_ticks, end_ticks));
+            if (measure_energy)
+            {
+                rapl_read(energy_end);
+                counters.cenergy += rapl_diff(energy_start, energy_end);
+                counters.cenergy_ns += GetDiffTime(rate, start_ticks, end_ticks);
+            }
+            if (measure_llc)
+            {
+                llc_mon_read(llc_occupancy, mbm_end);
+                if (llc_occupancy != UINT64_MAX) counters.cllc_bytes = MAX(counters.cllc_bytes, llc_occupancy);
+                if (mbm_start != UINT64_MAX && mbm_end != UINT64_MAX && mbm_end >= mbm_start)
+                {
+                    counters.cmbm_bytes += mbm_end - mbm_start;
+                    counters.cmbm_ns += GetDiffTime(rate, start_ticks, end_ticks);
+                }
+            }
+#ifdef BENCH_HAS_NVCOMP
+            lzbench_cuda_timing(counters.ckernel_ns, counters.ctransfer_ns);
+            lzbench_cuda_device_timing(counters.gpu_ns[0], counters.gpu_bytes[0]);
+#ifndef BENCH_REMOVE_LZ4
+            lzbench_hybrid_share(counters.cgpu_bytes);
+#endif
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+            if (lzbench_zstd_trace) lzbench_zstd_trace_timing(counters.zstd_trace);
+#endif
+            total_cnanosec += GetDiffTime(rate, start_ticks, end_ticks);
+            counters.cbytes += insize;
+            counters.cchunks += precheck_chunks;
+            counters.cskipped += precheck_skipped;
+            for (int t=0; t<nthreads; t++)
+                thr[t].best_cnanosec = MIN(thr[t].best_cnanosec, thr[t].nanosec);
+        }
+        return GetDiffTime(rate, start_ticks, end_ticks);
+    };
+
+    decompress_pass = [&](bool hot) -> uint64_t {
+        dpasses++;
+        if (measure_energy && hot) rapl_read(energy_start);
+        if (measure_llc && hot) llc_mon_read(llc_occupancy, mbm_start);
+#ifdef BENCH_HAS_NVCOMP
+        uint64_t kernel_ns = 0, transfer_ns = 0;
+        lzbench_cuda_timing(kernel_ns, transfer_ns);
+        uint64_t gpu_ns[CUDA_DEVICES_MAX] = {0}, gpu_bytes[CUDA_DEVICES_MAX] = {0};
+        lzbench_cuda_device_timing(gpu_ns, gpu_bytes);
+#ifndef BENCH_REMOVE_LZ4
+        lzbench_hybrid_share(kernel_ns);
+#endif
+#endif
+        if (fresh_output_mode && !drop_pages(decomp, insize))
+        {
+            static bool warned = false;
+            if (!warned) fprintf(stderr, "warning: --fresh-output cannot drop pages of the output (%s), it stays prefaulted\n", strerror(errno));
+            warned = true;
+        }
+        uint64_t rusage_start[6];
+        if (params->rusage && hot) rusage_read(rusage_start);
+        GetTime(start_ticks);
+        if (steal) lzbench_reset_queues(queues, thr);
+        pool.run([&](int t) {
+            bench_timer_t thr_start, thr_end;
+            uint64_t perf_start[PERF_COUNTERS], perf_end[PERF_COUNTERS], td_start[TOPDOWN_EVENTS], td_end[TOPDOWN_EVENTS];
+            lzbench_histogram* dhist = (params->latency && hot) ? &thr[t].dhist : NULL;
+            if (params->perf_counters && hot) perf_read(thr[t], perf_start);
+            if (params->topdown && hot) topdown_read(thr[t], td_start);
+            uint64_t timeline_pass = timeline_now();
+            GetTime(thr_start);
+            if (steal)
+                thr[t].decomplen = lzbench_decompress_steal(params, queues, t, chunks, desc->decompress, steal_compbuf, decomp, param1, param2, thr[t].workmem, thr[t].dsteals, thr[t].dbytes, dhist);
+            else if (desc->decompress_batch && !params->no_batch && !dhist && !params->consumer)
+                thr[t].decomplen = lzbench_decompress_batch(params, thr[t].chunk_sizes, desc, thr[t].compr_sizes, thr[t].compbuf, thr[t].decomp, param1, param2, thr[t].workmem);
+            else
+                thr[t].decomplen = lzbench_decompress(params, thr[t].chunk_sizes, desc->decompress, thr[t].compr_sizes, thr[t].compbuf, thr[t].decomp, param1, param2, thr[t].workmem, dhist);
+            GetTime(thr_end);
+            timeline_end(hot ? "decompress pass" : "decompress pass (not timed)", "pass", timeline_pass);
+            if (!hot) return;
+            thr[t].nanosec = GetDiffTime(rate, thr_start, thr_end);
+            thr[t].busy_dnanosec += thr[t].nanosec;
+            if (params->freq_threshold > 0) freq_add(thr[t].dfreq, freq_read());
+            if (params->perf_counters)
+            {
+                perf_read(thr[t], perf_end);
+                for (int k=0; k<PERF_COUNTERS; k++) thr[t].dperf[k] += perf_end[k] - perf_start[k];
+            }
+            if (params->topdown)
+            {
+                topdown_read(thr[t], td_end);
+                for (int k=0; k<TOPDOWN_EVENTS; k++) thr[t].dtd[k] += td_end[k] - td_start[k];
+            }
+        });
+        GetTime(end_ticks);
+        decomplen = 0;
+        for (int t=0; t<nthreads; t++)
+        {
+            if (thr[t].decomplen < 0 || (thr[t].decomplen == 0 && !steal)) { decomplen = thr[t].decomplen; break; }
+            decomplen += thr[t].decomplen;
+        }
+        if (hot)
+        {
+            if (params->rusage) rusage_add(counters, 1, rusage_start, GetDiffTime(rate, start_ticks, end_ticks));
+            if (measure_energy)
+            {
+                rapl_read(energy_end);
+                counters.denergy += rapl_diff(energy_start, energy_end);
+                counters.denergy_ns += GetDiffTime(rate, start_ticks, end_ticks);
+            }
+            if (measure_llc)
+            {
+                llc_mon_read(llc_occupancy, mbm_end);
+                if (llc_occupancy != UINT64_MAX) counters.dllc_bytes = MAX(counters.dllc_bytes, llc_occupancy);
+                if (mbm_start != UINT64_MAX && mbm_end != UINT64_MAX && mbm_end >= mbm_start)
+                {
+                    counters.dmbm_bytes += mbm_end - mbm_start;
+                    counters.dmbm_ns += GetDiffTime(rate, start_ticks, end_ticks);
+                }
+            }
+#ifdef BENCH_HAS_NVCOMP
+            lzbench_cuda_timing(counters.dkernel_ns, counters.dtransfer_ns);
+            lzbench_cuda_device_timing(counters.gpu_ns[1], counters.gpu_bytes[1]);
+#ifndef BENCH_REMOVE_LZ4
+            lzbench_hybrid_share(counters.dgpu_bytes);
+#endif
+#endif
+            total_dnanosec += GetDiffTime(rate, start_ticks, end_ticks);
+            counters.dbytes += insize;
+            for (int t=0; t<nthreads; t++)
+                thr[t].best_dnanosec = MIN(thr[t].best_dnanosec, thr[t].nanosec);
+        }
+        return GetDiffTime(rate, start_ticks, end_ticks);
+    };
+
+    if (params->freq_threshold > 0) throttle_start = throttle_count();
+    cgroup_throttled(cg_periods_start, cg_ms_start);
+    if (!cached && (params->warmup_passes || params->warmup_ms))
+        counters.cfirst_ns = lzbench_warmup(params, rate, compress_pass);
+    process_barrier_wait();
+    total_c_iters = 0;
+    cold_loop_nanosec = 0;
+    GetTime(timer_ticks);
+    if (!cached)
+    do
+    {
+        i = 0;
+        uint64_t timeline_sleep = timeline_now();
+        uni_sleep(1); // give processor to other processes
+        timeline_end("sleep", "sleep", timeline_sleep);
+        GetTime(loop_ticks);
+        do
+        {
+            nanosec = compress_pass(true);
+            if (nanosec >= 10000) ctime.push_back(nanosec);
+            i++;
+        }
+        while (GetDiffTime(rate, loop_ticks, end_ticks) < params->cloop_time);
+
+        nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
+        ctime.push_back(nanosec/i);
+        speed = (float)insize*i*1000/nanosec;
+        LZBENCH_PRINT(8, "%s nanosec=%llu\n", desc->name, (unsigned long long)nanosec);
+        if (params->cold_mode != COLD_NONE)
+        {
+            // one pass with evicted caches after every loop, not included in hot results nor in the time of -t#
+            bench_timer_t cold_start;
+            GetTime(cold_start);
+            lzbench_evict_caches(params, pool, thr, inbuf, insize, steal_compbuf, steal ? chunks.out_offsets.back() + chunks.out_bounds.back() : comprsize, decomp);
+            uint64_t cold_nanosec = compress_pass(false);
+            if (cold_nanosec >= 10000) cold_ctime.push_back(cold_nanosec);
+            cold_loop_nanosec += GetDiffTime(rate, cold_start, end_ticks);
+        }
+
+        if ((uint32_t)speed < params->cspeed) { LZBENCH_PRINT(7, "%s slower than %d MB/s\n", desc->name, (uint32_t)speed); params->below_cspeed = 1; goto done; }
+
+        total_nanosec = GetDiffTime(rate, timer_ticks, end_ticks) - cold_loop_nanosec;
+        total_c_iters += i;
+        if (params->ci_target > 0)
+        {
+            if ((total_c_iters >= params->c_iters) && ci_reached(params, ctime)) break;
+            if (total_nanosec > ((uint64_t)params->ci_maxtime*1000000)) break;
+        }
+        else if ((total_c_iters >= params->c_iters) && (total_nanosec > ((uint64_t)params->cmintime*1000000))) break;
+        LZBENCH_PRINT(2, "%s compr iter=%d time=%.2fs speed=%.2f MB/s     \r", desc->name, total_c_iters, total_nanosec/1000000000.0, speed);
+        statsd_progress(desc, level, false, total_c_iters, speed);
+    }
+    while (true);
+
+    lzbench_mem_stats(NULL, &mem_peak, &allocs_end);
+    memory.cpeak = mem_peak - mem_start;
+    if (cpasses || params->cspeed > 0) memory.callocs = (float)(allocs_end - allocs_start) / (cpasses * chunk_sizes.size() + (params->cspeed > 0));
+    if (params->cache_dir && !cached && desc != comp_desc)
+        lzbench_cache_store(cache_file, chunk_sizes, thr, steal ? &chunks : NULL, steal_compbuf, ctime);
+
+    timeline_verify = timeline_now();
+    if (!params->compress_only && !is_checksum(desc)) chunk_hashes(pool, chunk_sizes, inbuf, chunk_offsets, input_hashes);
+    timeline_end("hash input", "verify", timeline_verify);
+    lzbench_mem_reset_peak();
+    lzbench_mem_stats(&mem_start, NULL, &allocs_start);
+    if (!params->compress_only && !is_checksum(desc) && (params->warmup_passes || params->warmup_ms))
+        counters.dfirst_ns = lzbench_warmup(params, rate, decompress_pass);
+    process_barrier_wait();
+    total_d_iters = 0;
+    cold_loop_nanosec = 0;
+    GetTime(timer_ticks);
+    if (!params->compress_only && !is_checksum(desc))
+    do
+    {
+        i = 0;
+        uint64_t timeline_sleep = timeline_now();
+        uni_sleep(1); // give processor to other processes
+        timeline_end("sleep", "sleep", timeline_sleep);
+        GetTime(loop_ticks);
+        do
+        {
+            nanosec = decompress_pass(true);
+            if (nanosec >= 10000) dtime.push_back(nanosec);
+            i++;
+        }
+        while (GetDiffTime(rate, loop_ticks, end_ticks) < params->dloop_time);
+
+        nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
+        dtime.push_back(nanosec/i);
+        LZBENCH_PRINT(9, "%s dnanosec=%llu\n", desc->name, (unsigned long long)nanosec);
+        if (params->cold_mode != COLD_NONE)
+        {
+            bench_timer_t cold_start;
+            GetTime(cold_start);
+            lzbench_evict_caches(params, pool, thr, inbuf, insize, steal_compbuf, steal ? chunks.out_offsets.back() + chunks.out_bounds.back() : comprsize, decomp);
+            uint64_t cold_nanosec = decompress_pass(false);
+            if (cold_nanosec >= 10000) cold_dtime.push_back(cold_nanosec);
+            cold_loop_nanosec += GetDiffTime(rate, cold_start, end_ticks);
+        }
+
+        if (insize != decomplen)
+        {
+            decomp_error = true;
+            LZBENCH_PRINT(5, "ERROR: inlen[%d] != outlen[%d]\n", (int32_t)insize, (int32_t)decomplen);
+        }
+
+        timeline_verify = timeline_now();
+        bad_chunk = verify_chunks(pool, chunk_sizes, chunk_offsets, input_hashes, inbuf, decomp);
+        timeline_end("verify", "verify", timeline_verify);
+        if (bad_chunk >= 0)
+        {
+            size_t pos = chunk_offsets[bad_chunk], size = chunk_sizes[bad_chunk];
+            size_t cmn = std::mismatch(inbuf + pos, inbuf + pos + size, decomp + pos).first - (inbuf + pos);
+            decomp_error = true;
+            LZBENCH_PRINT(2, "ERROR in %s: chunk %d of %d at %llu (%d bytes) differs from byte %d\n", desc->name, (int)bad_chunk, (int)chunk_sizes.size(),
+                (unsigned long long)pos, (int)size, (int)cmn);
+
+            if (params->verbose >= 10)
+            {
+                char text[256];
+                snprintf(text, sizeof(text), "%s_failed", desc->name);
+                printf("ERROR: fwrite %llu-%llu to %s\n", (unsigned long long)pos, (unsigned long long)(pos+size), text);
+                FILE *f = fopen(text, "wb");
+                if (f) fwrite(inbuf+pos, 1, size, f), fclose(f);
+                exit(1);
+            }
+        }
+
+        if (decomp_error) break;
+
+        total_nanosec = GetDiffTime(rate, timer_ticks, end_ticks) - cold_loop_nanosec;
+        total_d_iters += i;
+        if (params->ci_target > 0)
+        {
+            if ((total_d_iters >= params->d_iters) && ci_reached(params, dtime)) break;
+            if (total_nanosec > ((uint64_t)params->ci_maxtime*1000000)) break;
+        }
+        else if ((total_d_iters >= params->d_iters) && (total_nanosec > ((uint64_t)params->dmintime*1000000))) break;
+        LZBENCH_PRINT(2, "%s decompr iter=%d time=%.2fs speed=%.2f MB/s     \r", desc->name, total_d_iters, total_nanosec/1000000000.0, (float)insize*i*1000/nanosec);
+        statsd_progress(desc, level, true, total_d_iters, (float)insize*i*1000/nanosec);
+    }
+    while (true);
+
+ //   printf("total_c_iters=%d total_d_iters=%d            \n", total_c_iters, total_d_iters);
+    lzbench_mem_stats(NULL, &mem_peak, &allocs_end);
+    memory.dpeak = mem_peak - mem_start;
+    if (dpasses) memory.dallocs = (float)(allocs_end - allocs_start) / (dpasses * chunk_sizes.size());
+
+    if (params->perf_counters) perf_sum(thr, counters);
+    if (params->consumer && !params->compress_only && !is_checksum(desc) && !decomp_error && !dtime.empty())
+    {
+        // decompression of all chunks and then the consumer over all of them, the data has left the cache
+        consume_func consumer = params->consumer;
+        uint64_t best = UINT64_MAX;
+        for (int k = 0; k < UNFUSED_PASSES; k++)
+        {
+            params->consumer = NULL;
+            uint64_t nanosec = decompress_pass(false);
+            params->consumer = consumer;
+            GetTime(start_ticks);
+            pool.run([&](int t) { consume_chunks(consumer, thr[t].decomp, thr[t].chunk_sizes); });
+            GetTime(end_ticks);
+            nanosec += GetDiffTime(rate, start_ticks, end_ticks);
+            best = MIN(best, nanosec);
+        }
+        counters.dunfused_ns = best;
+    }
+    if (params->noise_mode && desc != comp_desc && !cached && !decomp_error && !ctime.empty())
+    {
+        // the same passes again with co-runners, medians against the quiet ones
+        auto median = [](std::vector<uint64_t> times) { std::sort(times.begin(), times.end()); return times.empty() ? 0 : times[times.size() / 2]; };
+        std::vector<uint64_t> noisy[2];
+        bool decompress = !params->compress_only && !is_checksum(desc) && !dtime.empty();
+        noise_t noise;
+        noise_start(params, noise, nthreads);
+        for (int k = 0; k < NOISE_PASSES; k++)
+        {
+            noisy[0].push_back(compress_pass(false));
+            if (decompress) noisy[1].push_back(decompress_pass(false));
+        }
+        counters.ngbs = noise_stop(noise);
+        uint64_t quiet[2] = { median(ctime), decompress ? median(dtime) : 0 };
+        for (int d = 0; d < 2; d++)
+            if (quiet[d]) counters.nslow[d] = (float)median(noisy[d]) / quiet[d];
+    }
+    if (params->random_reads && !decomp_error && !is_checksum(desc))
+        lzbench_random_reads(params, desc, chunk_sizes, inbuf, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->sstable_block && insize && !decomp_error && !is_checksum(desc))
+        lzbench_sstable(params, desc, inbuf, insize, rate, param1, param2, counters);
+#if defined(__linux__)
+    if (params->sandbox && !chunk_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_sandbox(params, desc, chunk_sizes, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+#endif
+    if (!params->transcode.empty() && desc != comp_desc && !chunk_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_transcode(params, desc, pool, nthreads, chunk_sizes, inbuf, insize, decomp, rate, param1, param2, counters);
+    if (params->zram_page && insize && !decomp_error && !is_checksum(desc))
+        lzbench_zram(params, desc, inbuf, insize, decomp, rate, param1, param2, thr[0].workmem, counters);
+#if defined(__linux__)
+    if (!params->placements.empty() && !chunk_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_placement(params, desc, chunk_sizes, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+#endif
+    if (params->rotate && !chunk_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_rotate(params, desc, chunk_sizes, inbuf, rate, param1, param2, thr[0].workmem, counters);
+    if (params->spsc_depth && !chunk_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_spsc(params, desc, chunk_sizes, inbuf, compbuf, comprsize, rate, param1, param2, thr[0].workmem, counters);
+    if (desc->compress == lzbench_kernel_compress && !chunk_sizes.empty() && !decomp_error)
+        lzbench_kernel_io(params, desc, chunk_sizes, rate, param1, param2, thr[0].workmem, counters);
+    if (!params->ttfb_sizes.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_ttfb(params, desc, chunk_sizes, inbuf, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->fuzz_cases && desc != comp_desc && !decomp_error && !is_checksum(desc))
+        lzbench_fuzz(params, desc, level, chunk_sizes, compbuf, comprsize, inbuf, rate, param1, param2, thr[0].workmem, counters);
+    if (params->lz_stats && !decomp_error)
+        lzbench_lz_stats(params, desc, chunk_sizes, inbuf, compbuf, comprsize, param1, param2, thr[0].workmem, counters);
+    if (params->dthread_counts_nb && !decomp_error && !is_checksum(desc))
+        lzbench_shared_reads(params, desc, chunk_sizes, inbuf, compbuf, comprsize, rate, param1, param2, thr[0].workmem, counters);
+    if (params->inplace && !decomp_error && !is_checksum(desc))
+        lzbench_inplace(params, desc, chunk_sizes, inbuf, compbuf, comprsize, rate, param1, param2, thr[0].workmem, counters);
+    if (desc->compress == lzbench_pdeflate_compress && !decomp_error && !lzbench_pdeflate_check(desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, param1, param2, thr[0].workmem))
+        decomp_error = true;
+#ifndef BENCH_REMOVE_BROTLI
+    if (desc->init == lzbench_brotli_dict_init)
+        counters.dprepare_ms = lzbench_brotli_dict_prepare_ns / 1000000.0, counters.dcall_us = lzbench_brotli_dict_call_ns / 1000.0;
+#endif
+    if (is_interleaved(desc) && !decomp_error)
+        lzbench_interleaved_gain(params, desc, chunk_sizes, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, counters);
+    if (desc->compress == lzbench_blockmt_compress && !decomp_error)
+        lzbench_blockmt_plain(params, chunk_sizes, inbuf, insize, compbuf, comprsize, decomp, rate, param1, counters);
+    if (desc->compress == lzbench_filter_compress && filter_setup.desc && !decomp_error)
+        lzbench_filter_plain(params, chunk_sizes, inbuf, insize, compbuf, comprsize, decomp, rate, param1, counters);
+    if (is_delta(desc) && !decomp_error)
+        lzbench_delta_plain(desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, rate, param1, counters);
+    if (desc->compress == lzbench_xzmt_compress && lzbench_xzmt_threads > 1 && !decomp_error)
+        lzbench_xzmt_scaling(desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->range_reads && (desc->compress == lzbench_zstd_seekable_compress || desc->decompress == lzbench_zlib_gzip_decompress) && !decomp_error)
+        lzbench_range_reads(params, desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->iovec_min && !decomp_error && !is_checksum(desc))
+        lzbench_iovec(params, desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->append_size && desc->stream && desc->stream->begin && desc->compress != lzbench_feed_compress && !decomp_error)
+        lzbench_append(params, desc, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, complen, counters);
+    if (!params->trace.empty() && !decomp_error && !is_checksum(desc))
+        lzbench_trace(params, desc, chunk_size, inbuf, insize, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem, counters);
+    if (params->load_rate > 0 && !decomp_error && !is_checksum(desc))
+        lzbench_load(params, desc, pool, thr, chunk_sizes, inbuf, compbuf, comprsize, rate, param1, param2, counters);
+    if (params->pipeline_dir && params->in_path && !decomp_error && !params->collect_jobs && !is_checksum(desc))
+    {
+        if (params->page_cache == PAGECACHE_COLD) lzbench_page_cache(params, params->mmap_direct ? inbuf : NULL, insize);
+        lzbench_pipeline(params, desc, chunk_size, param1, param2, thr[0].workmem, rate, counters.cpipe, counters.dpipe);
+    }
+    if (cgroup_throttled(cg_periods_end, cg_ms_end))
+        counters.cg_throttled = cg_periods_end - cg_periods_start, counters.cg_throttled_ms = cg_ms_end - cg_ms_start;
+    if (params->freq_threshold > 0)
+    {
+        counters.throttle = throttle_count() - throttle_start;
+        for (int t=0; t<nthreads; t++)
+            freq_merge(counters.cfreq, thr[t].cfreq), freq_merge(counters.dfreq, thr[t].dfreq);
+    }
+    if (params->sample_blocks) block_ratio_ci(thr, steal ? &chunks : NULL, counters);
+#ifdef BENCH_HAS_NVCOMP
+    lzbench_cuda_setup_timing(counters.cuda_alloc_ns, counters.cuda_metadata_ns, counters.cuda_pool_hits);
+#endif
+    print_stats(params, desc, level, ctime, dtime, insize, complen, decomp_error, thr, counters, cold_ctime, cold_dtime, memory, file_sizes, chunk_size, file_backed ? params->page_cache : PAGECACHE_MEM);
+    if (params->breakdown && desc != comp_desc && !is_checksum(desc) && !decomp_error && !params->merge_parts && params->file_names.size() == file_sizes.size())
+        lzbench_breakdown(params, file_sizes, desc, params->results.back().col1_algname, inbuf, compbuf, comprsize, decomp, rate, chunk_size, param1, param2, thr[0].workmem);
+    if (params->chunk_map && desc != comp_desc && !is_checksum(desc) && !decomp_error && !params->merge_parts)
+        lzbench_chunk_map(params, desc, params->results.back().col1_algname, chunk_sizes, inbuf, compbuf, comprsize, decomp, rate, param1, param2, thr[0].workmem);
+    if (steal) print_steal_stats(params, thr, total_cnanosec, total_dnanosec);
+    if (counters.xcount > 1 && params->textformat != JSON && params->textformat != CSV)
+    {
+        printf("xzmt decompression of %u blocks:", counters.xblocks);
+        for (uint32_t i=0; i<counters.xcount; i++)
+            printf(" %u thr %.1f MB/s (%.2fx)%s", counters.xthreads[i], counters.xdspeed[i], counters.xdspeed[i] / counters.xdspeed[0], i + 1 < counters.xcount ? "," : "\n");
+    }
+#ifndef BENCH_REMOVE_BROTLI
+    if (desc->init == lzbench_brotli_dict_init && params->textformat != JSON && params->textformat != CSV)
+        printf("brotli_dict: dictionary of %llu bytes prepared in %.3f ms, attaching it adds %.2f us to every call\n",
+            (unsigned long long)lzbench_brotli_dict_size, counters.dprepare_ms, counters.dcall_us);
+#endif
+    if (counters.delta_plain && params->textformat != JSON && params->textformat != CSV)
+        printf("%s: %llu bytes against a reference of %llu bytes, %.2f%% of %llu bytes of %.*s alone (%.1f MB/s compression, %.1f MB/s decompression)\n",
+            desc->name, (unsigned long long)complen, (unsigned long long)params->delta_ref.size(), complen * 100.0 / counters.delta_plain,
+            (unsigned long long)counters.delta_plain, (int)(strlen(desc->name) - strlen("_delta")), desc->name, counters.delta_cspeed, counters.delta_dspeed);
+    if (counters.ilv_dspeed > 0 && params->textformat != JSON && params->textformat != CSV)
+        printf("%s: %zu chunks decoded %d at a time %.1f MB/s, one after another %.1f MB/s (%+.1f%%) on one core\n", desc->name, chunk_sizes.size(),
+            (int)param2, counters.ilv_dspeed, counters.ilv_seq_dspeed, counters.ilv_dspeed * 100.0 / counters.ilv_seq_dspeed - 100.0);
+    if ((counters.cuda_alloc_ns || counters.cuda_metadata_ns || counters.cuda_pool_hits) && params->textformat != JSON && params->textformat != CSV)
+        printf("%s: GPU setup %.3f ms in cudaMalloc and cudaStreamCreate of init with %llu buffers and streams from the pool, %.3f ms reading metadata\n",
+            desc->name, counters.cuda_alloc_ns / 1e6, (unsigned long long)counters.cuda_pool_hits, counters.cuda_metadata_ns / 1e6);
+    if (counters.filter_plain && params->textformat != JSON && params->textformat != CSV)
+        printf("%s: %llu bytes, %.2f%% of %llu bytes of %s alone (%+.2f%%), filters %.1f MB/s, inverse %.1f MB/s\n",
+            desc->name, (unsigned long long)complen, complen * 100.0 / counters.filter_plain, (unsigned long long)counters.filter_plain,
+            filter_setup.desc->name, complen * 100.0 / counters.filter_plain - 100.0, counters.filter_fspeed, counters.filter_ispeed);
+    if (counters.tc_fused_ns && params->textformat != JSON && params->textformat != CSV)
+    {
+        uint64_t separate = counters.tc_dns + counters.tc_cns;
+        printf("%s: transcode from %s of %zu chunks fused %.1f MB/s (%.3f ms), separate passes %.3f ms decompression + %.3f ms compression = %.3f ms "
+            "(%.1f MB/s, fused %+.1f%%)", desc->name, params->transcode.c_str(), chunk_sizes.size(), insize * 1000.0 / (MAX(counters.tc_fused_ns, (uint64_t)1)),
+            counters.tc_fused_ns / 1e6, counters.tc_dns / 1e6, counters.tc_cns / 1e6, separate / 1e6, insize * 1000.0 / (MAX(separate, (uint64_t)1)),
+            counters.tc_fused_ns * 100.0 / (MAX(separate, (uint64_t)1)) - 100.0);
+        if (counters.tc_threads > 1)
+            printf(", %d threads fused %.1f MB/s with %.3f ms of CPU (%+.1f%%)", counters.tc_threads, insize * 1000.0 / (MAX(counters.tc_mt_ns, (uint64_t)1)),
+                counters.tc_mt_cpu_ns / 1e6, counters.tc_mt_cpu_ns * 100.0 / (MAX(separate, (uint64_t)1)) - 100.0);
+        printf("\n");
+    }
+    if (counters.zpages && params->textformat != JSON && params->textformat != CSV)
+    {
+        const double pages = (double)counters.zpages;
+        printf("%s: %llu pages of %zu KB, %.1f%% zero-filled and %.1f%% same-value elided, %.1f%% stored as they are, store %.0f pages/s (%.1f MB/s), "
+            "load %.0f pages/s (%.1f MB/s), %.2f%% of the input stored\n", desc->name, (unsigned long long)counters.zpages, params->zram_page >> 10,
+            counters.zzero * 100.0 / pages, counters.zsame * 100.0 / pages, counters.zhuge * 100.0 / pages, pages * 1e9 / (MAX(counters.zstore_ns, (uint64_t)1)),
+            insize * 1000.0 / (MAX(counters.zstore_ns, (uint64_t)1)), pages * 1e9 / (MAX(counters.zload_ns, (uint64_t)1)), insize * 1000.0 / (MAX(counters.zload_ns, (uint64_t)1)),
+            counters.zbytes * 100.0 / insize);
+        printf("%s: compressed pages of up to", desc->name);
+        for (int c = 0; c < ZRAM_CLASSES; c++)
+            printf("%s %zu B %.1f%%", c ? "," : "", params->zram_page / ZRAM_CLASSES * (c + 1), counters.zsizes[c] * 100.0 / pages);
+        printf("\n");
+    }
+    if (counters.rot_inputs && params->textformat != JSON && params->textformat != CSV)
+    {
+        double speed[2][2]; // mode, compression and decompression
+        for (int m = 0; m < 2; m++)
+            for (int d = 0; d < 2; d++)
+                speed[m][d] = counters.rot_bytes * 1000.0 / (MAX(d ? counters.rot_dns[m] : counters.rot_cns[m], (uint64_t)1));
+        printf("%s: %u rotated inputs of %zu KB %.1f MB/s (%+.1f%%) and %.1f MB/s (%+.1f%%), one input %.1f MB/s and %.1f MB/s\n", desc->name,
+            counters.rot_inputs, (size_t)(counters.rot_bytes / counters.rot_inputs) >> 10, speed[1][0], (speed[1][0] / speed[0][0] - 1) * 100,
+            speed[1][1], (speed[1][1] / speed[0][1] - 1) * 100, speed[0][0], speed[0][1]);
+    }
+    if (counters.sb_calls && params->textformat != JSON && params->textformat != CSV)
+    {
+        double speed[3];
+        for (int m = 0; m < 3; m++) speed[m] = insize * 1000.0 / (MAX(counters.sb_ns[m], (uint64_t)1));
+        printf("%s: decompression of %u chunks in a sandbox (seccomp %s) %.1f MB/s (%+.1f%%) with a round trip per chunk (%+.2f us per call), "
+            "p50/p99/p99.9 %.2f/%.2f/%.2f us against %.2f/%.2f/%.2f us, %.1f MB/s (%+.1f%%) with one round trip for all; in the process %.1f MB/s\n",
+            desc->name, counters.sb_calls, params->sandbox == SANDBOX_STRICT ? "strict" : "filter", speed[1], (speed[1] / speed[0] - 1) * 100,
+            ((double)counters.sb_ns[1] - (double)counters.sb_ns[0]) / 1000.0 / counters.sb_calls, counters.sb_lat[1][0], counters.sb_lat[1][1], counters.sb_lat[1][2],
+            counters.sb_lat[0][0], counters.sb_lat[0][1], counters.sb_lat[0][2], speed[2], (speed[2] / speed[0] - 1) * 100, speed[0]);
+    }
+    if (counters.ss_blocks && params->textformat != JSON && params->textformat != CSV)
+        printf("%s: SSTable of %u blocks of %zu KB with restarts every %u records, %llu records in %.2f%% of the input with an index of "
+            "%.1f KB (%.2f%% of the file) and restart arrays of %.2f%% of the input, built at %.1f MB/s; lookups %.2f/%.2f/%.2f us "
+            "(p50/p99/p99.9, %.0f/s), scans of %u records %.1f MB/s (%.2f blocks)\n", desc->name, counters.ss_blocks, params->sstable_block >> 10,
+            params->sstable_restart, (unsigned long long)counters.ss_records, counters.ss_file_bytes * 100.0 / insize, counters.ss_index_bytes / 1024.0,
+            counters.ss_index_bytes * 100.0 / (MAX(counters.ss_file_bytes, (uint64_t)1)), counters.ss_restart_bytes * 100.0 / insize,
+            insize * 1000.0 / (MAX(counters.ss_build_ns, (uint64_t)1)), counters.ss_lat[0], counters.ss_lat[1], counters.ss_lat[2], counters.ss_rate,
+            params->sstable_scan, counters.ss_scan_mbs, counters.ss_scan_blocks);
+    if (counters.sp_blocks && params->textformat != JSON && params->textformat != CSV)
+    {
+        double per_block[2] = { counters.sp_local_ns / (double)counters.sp_blocks, counters.sp_remote_ns / (double)counters.sp_blocks };
+        printf("%s: SPSC ring of %d blocks of %u KB, decoder on CPU %d and consumer on CPU %d: %.1f MB/s pipelined, %.1f MB/s decoding alone, "
+            "%.1f MB/s decoding and consuming on one thread; consumer %.0f ns per block on the %s CPU against %.0f ns in cache (%+.2f ns/KB), "
+            "ring full for %.1f%% and empty for %.1f%% of blocks\n", desc->name, params->spsc_depth, counters.sp_slot >> 10,
+            counters.sp_cpus[0], counters.sp_cpus[1] >= 0 ? counters.sp_cpus[1] : counters.sp_cpus[0],
+            counters.sp_bytes * 1000.0 / (MAX(counters.sp_ns, (uint64_t)1)), counters.sp_bytes * 1000.0 / (MAX(counters.sp_decode_ns, (uint64_t)1)),
+            counters.sp_bytes * 1000.0 / (MAX(counters.sp_serial_ns, (uint64_t)1)), per_block[1], counters.sp_cpus[1] >= 0 ? "other" : "same", per_block[0],
+            ((double)counters.sp_remote_ns - (double)counters.sp_local_ns) * 1024 / (MAX(counters.sp_bytes, (uint64_t)1)),
+            counters.sp_full * 100.0 / counters.sp_blocks, counters.sp_empty * 100.0 / counters.sp_blocks);
+    }
+    if (counters.kio_cns && params->textformat != JSON && params->textformat != CSV)
+    {
+        const string_table_t& row = params->results.back();
+        printf("%s: zram I/O path with zero-filled pages %.3f ms of %.3f ms of compression (%.1f%%) and %.3f ms of %.3f ms of decompression (%.1f%%), "
+            "without it %.1f MB/s and %.1f MB/s\n", desc->name, counters.kio_cns / 1e6, row.col2_ctime / 1e6, counters.kio_cns * 100.0 / (MAX(row.col2_ctime, (uint64_t)1)),
+            counters.kio_dns / 1e6, row.col3_dtime / 1e6, counters.kio_dns * 100.0 / (MAX(row.col3_dtime, (uint64_t)1)),
+            row.col2_ctime > counters.kio_cns ? insize * 1000.0 / (row.col2_ctime - counters.kio_cns) : 0.0,
+            row.col3_dtime > counters.kio_dns ? insize * 1000.0 / (row.col3_dtime - counters.kio_dns) : 0.0);
+    }
+    for (uint32_t c = 0; c < counters.pl_count && params->textformat != JSON && params->textformat != CSV; c++)
+    {
+        char label[3][16];
+        for (int b = 0; b < 3; b++)
+            if (params->placements[c*3 + b] < 0) snprintf(label[b], sizeof(label[b]), "-");
+            else snprintf(label[b], sizeof(label[b]), "%d", params->placements[c*3 + b]);
+        printf("%s: input on node %s, compressed on %s, decompressed on %s: compression %.1f MB/s (%+.1f%%), decompression %.1f MB/s (%+.1f%%), "
+            "%.2f us per chunk\n", desc->name, label[0], label[1], label[2], counters.pl_cspeed[c], counters.pl_cspeed[c] * 100.0 / counters.pl_cspeed[0] - 100.0,
+            counters.pl_dspeed[c], counters.pl_dspeed[c] * 100.0 / counters.pl_dspeed[0] - 100.0, counters.pl_dchunk_us[c]);
+    }
+    if (counters.mt_plain && params->textformat != JSON && params->textformat != CSV)
+    {
+        const string_table_t& row = params->results.back();
+        double cms = row.col2_ctime / 1e6 / chunk_sizes.size(), dms = row.col3_dtime / 1e6 / chunk_sizes.size();
+        size_t block = blockmt_block_size(blockmt_setup.desc, chunk_size, blockmt_setup.threads);
+        printf("%s: a chunk of %zu KB in %zu blocks compressed in %.3f ms and decompressed in %.3f ms, %s alone %.3f and %.3f ms (%.2fx, %.2fx), "
+            "%llu bytes (%+.3f%%)\n", desc->name, chunk_size >> 10, (chunk_size + block - 1) / block, cms, dms, blockmt_setup.desc->name, counters.mt_plain_cms,
+            counters.mt_plain_dms, counters.mt_plain_cms / (MAX(cms, 1e-9)), counters.mt_plain_dms / (MAX(dms, 1e-9)), (unsigned long long)complen, complen * 100.0 / counters.mt_plain - 100.0);
+    }
+
+done:
+    if (is_delta(desc)) lzbench_dict = NULL, lzbench_dict_size = 0;
+    if (steal_compbuf != compbuf) free_touched(steal_compbuf);
+    for (int t=0; t<nthreads; t++)
+        perf_close(thr[t]);
+#if defined(__linux__)
+    if (params->pin_mode != PIN_NONE && !chunk_sizes.empty())
+        sched_setaffinity(0, sizeof(main_mask), &main_mask); // the main thread runs as thread 0
+#endif
+    for (int t=0; t<nthreads; t++)
+    {
+        uint64_t timeline_deinit = timeline_now();
+        if (desc->deinit) desc->deinit(thr[t].workmem);
+        timeline_end("deinit", "init", timeline_deinit, t);
+    }
+}
+
+
+/* run lzbench_test for every number of threads given with -T#,#,#, with --contexts=both also with per call setup */
+void lzbench_test_threads(lzbench_params_t *params, std::vector<size_t> &file_sizes, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, size_t param1)
+{
+    const char* needs = NULL;
+    if (!codec_isa(desc, &needs)) {
+        static std::set<std::string> warned;
+        if (warned.insert(desc->name).second) fprintf(stderr, "warning: %s is skipped, it needs %s that this CPU does not support\n", desc->name, needs);
+        return;
+    }
+
+    if (is_delta(desc) && params->delta_ref.empty()) {
+        static bool warned = false;
+        if (!warned) fprintf(stderr, "warning: %s is skipped, delta codecs need --delta=file\n", desc->name);
+        warned = true;
+        return;
+    }
+
+#ifndef BENCH_REMOVE_BROTLI
+    if (desc->init == lzbench_brotli_dict_init) {
+        const std::vector<char> &dict = params->brotli_dict.empty() ? params->dict : params->brotli_dict;
+        static bool warned = false;
+        if (dict.empty()) {
+            if (!warned) fprintf(stderr, "warning: brotli_dict is skipped, it needs --brotli-dict=file or --dict\n");
+            warned = true;
+            return;
+        }
+        lzbench_brotli_dict = dict.data();
+        lzbench_brotli_dict_size = dict.size();
+    }
+#endif
+
+    if (desc->init == lzbench_kernel_init) {
+        static std::map<std::pair<size_t, int>, const char*> checked; // one zram device for every algorithm and level
+        std::pair<size_t, int> key(desc->additional_param, level);
+        bool first = !checked.count(key);
+        if (first) checked[key] = lzbench_kernel_check(level, desc->additional_param);
+        if (checked[key]) {
+            if (first && desc->last_level) fprintf(stderr, "warning: %s -%d is skipped, no zram device with its algorithm and level (%s failed)\n", desc->name, level, checked[key]);
+            else if (first) fprintf(stderr, "warning: %s is skipped, no zram device with its algorithm (%s failed)\n", desc->name, checked[key]);
+            return;
+        }
+    }
+
+    for (size_t k=0; k<params->budget_skip.size(); k++)
+        if (params->budget_skip[k] == std::make_pair(codec_index(desc), level)) {
+            if (params->budget_skip_bytes[k] >= 0) // once for all parts of a file
+                fprintf(stderr, "warning: %s -%d is skipped, its working set of %llu MB per thread doesn't fit --mem-budget=%llu MB\n", desc->name, level,
+                    (unsigned long long)(params->budget_skip_bytes[k] >> 20), (unsigned long long)(params->mem_budget >> 20));
+            params->budget_skip_bytes[k] = -1;
+            return;
+        }
+
+    if (params->collect_jobs && params->block_threads) {
+        static bool warned = false;
+        if (!warned) fprintf(stderr, "warning: mt# of -e is run only without --interleave, --parallel, --isolate and --recommend\n");
+        warned = true;
+        return;
+    }
+
+    if (params->collect_jobs) {
+        params->jobs.push_back(std::make_pair(codec_index(desc), level));
+        params->job_options.push_back(params->codec_options);
+        params->job_filters.push_back(params->filters);
+        return;
+    }
+
+    std::string cache_key;
+    size_t first = params->results.size();
+    if (params->results_cache)
+    {
+        cache_key = results_cache_key(params, desc, level, insize);
+        if (results_cache_load(params, cache_key)) return;
+    }
+
+    compressor_desc_t filtered;
+    std::string filtered_name;
+    if (!params->filters.empty() && lzbench_parse_filters(params->filters, filter_setup.filters))
+    {
+        filtered_name = params->filters + "+" + desc->name;
+        filtered = *desc;
+        filtered.name = filtered_name.c_str();
+        filtered.compress = lzbench_filter_compress;
+        filtered.decompress = lzbench_filter_decompress;
+        filtered.init = lzbench_filter_init;
+        filtered.deinit = lzbench_filter_deinit;
+        filtered.stream = NULL;
+        filtered.bound = NULL;
+        filtered.compress_batch = filtered.decompress_batch = NULL;
+        filter_setup.desc = desc;
+        desc = &filtered;
+    }
+
+    compressor_desc_t blockmt;
+    std::string blockmt_name;
+    if (params->block_threads)
+    {
+        format(blockmt_name, "mt%d:%s", params->block_threads, desc->name);
+        blockmt = *desc;
+        blockmt.name = blockmt_name.c_str();
+        blockmt.max_block_size = 0;
+        blockmt.compress = lzbench_blockmt_compress;
+        blockmt.decompress = lzbench_blockmt_decompress;
+        blockmt.init = lzbench_blockmt_init;
+        blockmt.deinit = lzbench_blockmt_deinit;
+        blockmt.stream = NULL;
+        blockmt.bound = NULL;
+        blockmt.compress_batch = blockmt.decompress_batch = NULL;
+        blockmt_setup.desc = desc;
+        blockmt_setup.threads = params->block_threads;
+        desc = &blockmt;
+    }
+
+    int runs = (params->contexts == CONTEXTS_BOTH && reuses_context(desc)) ? 2 : 1;
+    int allocs = (params->alloc == ALLOC_BOTH && uses_allocator(desc)) ? 2 : 1;
+    int outputs = (params->fresh_output == FRESH_BOTH && !is_checksum(desc)) ? 2 : 1;
+    for (int o=0; o<outputs; o++)
+    for (int a=0; a<allocs; a++)
+    for (int r=0; r<runs; r++)
+    {
+        fresh_output_mode = (params->fresh_output == FRESH_OUTPUT || o == 1) ? 1 : 0;
+        lzbench_mem_arena = (params->alloc == ALLOC_ARENA || a == 1) ? 1 : 0;
+        lzbench_context_reuse = (params->contexts == CONTEXTS_PERCALL || r == 1) ? 0 : 1;
+        for (int k=0; k<params->thread_counts_nb; k++)
+        {
+            params->threads = params->thread_counts[k];
+            // --precheck runs first without it for the speedup
+            for (int p = params->precheck ? 0 : 1; p < 2; p++)
+            {
+                size_t rows = params->results.size();
+                precheck_mode = p ? params->precheck : PRECHECK_NONE;
+                lzbench_test(params, file_sizes, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, param1);
+                params->precheck_base = (!p && params->results.size() > rows) ? params->results.back().col2_ctime : 0;
+            }
+            precheck_mode = PRECHECK_NONE;
+        }
+    }
+    lzbench_context_reuse = params->contexts != CONTEXTS_PERCALL;
+    lzbench_mem_arena = params->alloc == ALLOC_ARENA;
+    fresh_output_mode = params->fresh_output == FRESH_OUTPUT;
+
+    if (params->feed_write && desc->stream && desc->stream->begin)
+    {
+        compressor_desc_t fed = *desc;
+        fed.compress = lzbench_feed_compress;
+        fed.decompress = lzbench_feed_decompress;
+        fed.init = lzbench_feed_init;
+        fed.bound = NULL;
+        fed.compress_batch = fed.decompress_batch = NULL;
+        fed.deinit = lzbench_feed_deinit;
+        feed_setup.desc = desc;
+        feed_setup.write_size = params->feed_write;
+        feed_setup.flush_size = params->feed_flush;
+        for (int k=0; k<params->thread_counts_nb; k++)
+        {
+            params->threads = params->thread_counts[k];
+            lzbench_test(params, file_sizes, &fed, level, inbuf, insize, compbuf, comprsize, decomp, rate, param1);
+        }
+    }
+
+    if (!params->dict.empty() && uses_dictionary(desc))
+    {
+        lzbench_dict = params->dict.data();
+        lzbench_dict_size = params->dict.size();
+        for (int k=0; k<params->thread_counts_nb; k++)
+        {
+            params->threads = params->thread_counts[k];
+            lzbench_test(params, file_sizes, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, param1);
+        }
+        lzbench_dict = NULL;
+        lzbench_dict_size = 0;
+    }
+    params->threads = params->max_threads;
+    if (!cache_key.empty()) results_cache_store(params, cache_key, first);
+}
+
+
+/* -e bestof: candidates "store/lz4/zstd,3" of --bestof, then ":entropy=#,#", ":lz4=#,#" or ":try[=us]" */
+bool lzbench_parse_bestof(const std::string &text, lzbench_bestof_setup_t &setup)
+{
+    size_t colon = text.find(':');
+    std::vector<std::string> names = split(text.substr(0, colon), '/');
+    std::string select = (colon == std::string::npos) ? "try" : text.substr(colon + 1);
+
+    setup.descs.clear();
+    setup.levels.clear();
+    setup.names.clear();
+    setup.thresholds.clear();
+    setup.budget_ns = 0;
+    for (size_t k = 0; k < names.size(); k++)
+    {
+        std::vector<std::string> terms = split(names[k], ',');
+        const compressor_desc_t* desc = NULL;
+        int level = 0;
+        if (istrcmp(terms[0].c_str(), "store") != 0)
+        {
+            for (int i=1; i<codec_count() && !desc; i++)
+                if (istrcmp(codec_desc(i)->name, terms[0].c_str()) == 0) desc = codec_desc(i);
+            if (!desc) { printf("NOT FOUND: %s of --bestof\n", terms[0].c_str()); return false; }
+            level = (terms.size() > 1) ? atoi(terms[1].c_str()) : desc->first_level;
+        }
+        setup.descs.push_back(desc);
+        setup.levels.push_back(level);
+        setup.names.push_back(names[k]);
+    }
+    if (setup.descs.empty() || setup.descs.size() > BESTOF_MAX) { printf("--bestof needs 1 to %d candidates\n", BESTOF_MAX); return false; }
+
+    size_t eq = select.find('=');
+    std::string mode = select.substr(0, eq);
+    std::vector<std::string> values = (eq == std::string::npos) ? std::vector<std::string>() : split(select.substr(eq + 1), ',');
+    if (mode == "try")
+    {
+        setup.select = BESTOF_TRY;
+        if (!values.empty()) setup.budget_ns = atoi(values[0].c_str()) * 1000ULL;
+        return true;
+    }
+    if (mode != "entropy" && mode != "lz4") { printf("Unknown selection %s of --bestof\n", mode.c_str()); return false; }
+    setup.select = (mode == "entropy") ? BESTOF_ENTROPY : BESTOF_LZ4;
+    for (size_t k = 0; k < values.size(); k++) setup.thresholds.push_back(atof(values[k].c_str()));
+    if (setup.thresholds.size() + 1 != setup.descs.size()) { printf("--bestof with %s needs %d thresholds\n", mode.c_str(), (int)setup.descs.size() - 1); return false; }
+    return true;
+}
+
+
+void lzbench_test_bestof(lzbench_params_t *params, std::vector<size_t> &file_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    std::string text = params->bestof.empty() ? "store/lz4/zstd,3" : params->bestof;
+    compressor_desc_t bestof = { "bestof", text.c_str(), 0, 0, 0, 0, lzbench_bestof_compress, lzbench_bestof_decompress, lzbench_bestof_init, lzbench_bestof_deinit, NULL };
+
+    if (params->collect_jobs) { fprintf(stderr, "warning: bestof is run only without --interleave, --parallel, --isolate and --recommend\n"); return; }
+    if (!lzbench_parse_bestof(text, bestof_setup)) return;
+    bestof_setup.rate = rate;
+    for (int k=0; k<params->thread_counts_nb; k++)
+    {
+        for (size_t i=0; i<BESTOF_MAX; i++) bestof_setup.chosen[i] = 0;
+        bestof_setup.decision_ns = bestof_setup.total_ns = 0;
+        params->threads = params->thread_counts[k];
+        lzbench_test(params, file_sizes, &bestof, 0, inbuf, insize, compbuf, comprsize, decomp, rate, 0);
+
+        uint64_t chunks = 0;
+        for (size_t i=0; i<bestof_setup.descs.size(); i++) chunks += bestof_setup.chosen[i];
+        if (params->textformat == JSON || !chunks) continue;
+        printf("bestof chunks:");
+        for (size_t i=0; i<bestof_setup.descs.size(); i++)
+            printf(" %s %.1f%%", bestof_setup.names[i].c_str(), bestof_setup.chosen[i] * 100.0 / chunks);
+        printf(", decision %.1f%% of compression time\n", bestof_setup.decision_ns * 100.0 / (MAX((uint64_t)bestof_setup.total_ns, (uint64_t)1)));
+    }
+    params->threads = params->max_threads;
+}
+
+
+/* the filters of -e "filters+codec" alone, to show their part of the speed of the filtered codec */
+void lzbench_test_filters(lzbench_params_t *params, std::vector<size_t> &file_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    if (!lzbench_parse_filters(params->filters, filter_setup.filters)) return;
+    compressor_desc_t filters = { params->filters.c_str(), lzbench_filter_isa(filter_setup.filters), 0, 0, 0, 0, lzbench_filter_compress, lzbench_filter_decompress, lzbench_filter_init, lzbench_filter_deinit, NULL };
+    filter_setup.desc = NULL;
+    for (int k=0; k<params->thread_counts_nb; k++)
+    {
+        params->threads = params->thread_counts[k];
+        lzbench_test(params, file_sizes, &filters, 0, inbuf, insize, compbuf, comprsize, decomp, rate, 0);
+    }
+    params->threads = params->max_threads;
+}
+
+
+/* codecs whose compression speed does not drop with the level, e.g. lz4fast levels are accelerations */
+static const char* speed_nonmonotonic[] = { "lz4fast", "lzrw", "tornado", NULL };
+
+/* test a level and return true if it was slower than -s# and higher levels of the codec can be skipped */
+bool lzbench_test_level(lzbench_params_t *params, std::vector<size_t> &file_sizes, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    params->below_cspeed = 0;
+    lzbench_test_threads(params, file_sizes, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, level);
+    if (!params->below_cspeed || params->no_prune) return false;
+    for (int i=0; speed_nonmonotonic[i]; i++)
+        if (istrcmp(desc->name, speed_nonmonotonic[i]) == 0) return false;
+    LZBENCH_PRINT(5, "%s -%d slower than %d MB/s, higher levels skipped\n", desc->name, level, params->cspeed);
+    return true;
+}
+
+
+/* a single untimed-loop pass of compression and decompression over the first SEARCH_PROBE_SIZE bytes */
+#define SEARCH_PROBE_SIZE (16*1024*1024)
+bool lzbench_probe(lzbench_params_t *params, const compressor_desc_t* desc, int level, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate, float &ratio, float &cspeed, float &dspeed)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<size_t> chunk_sizes, compr_sizes;
+    size_t size = MIN(insize, SEARCH_PROBE_SIZE);
+    size_t chunk_size = (params->chunk_size > size) ? size : params->chunk_size;
+    size_t param2 = desc->additional_param;
+    int64_t complen, decomplen;
+    uint64_t cnanosec, dnanosec;
+    char* workmem = NULL;
+
+    if (chunk_size > codec_chunk_limit(desc)) chunk_size = codec_chunk_limit(desc);
+    for (size_t tmpsize = size; tmpsize > 0; tmpsize -= MIN(tmpsize, chunk_size))
+        chunk_sizes.push_back(MIN(tmpsize, chunk_size));
+
+    if (desc->init) workmem = desc->init(chunk_size, level, param2);
+    GetTime(start_ticks);
+    complen = lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, inbuf, compbuf, comprsize, level, param2, workmem, NULL);
+    GetTime(end_ticks);
+    cnanosec = GetDiffTime(rate, start_ticks, end_ticks);
+    GetTime(start_ticks);
+    decomplen = (complen > 0) ? lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, level, param2, workmem, NULL) : 0;
+    GetTime(end_ticks);
+    dnanosec = GetDiffTime(rate, start_ticks, end_ticks);
+    if (desc->deinit) desc->deinit(workmem);
+
+    if (complen <= 0 || decomplen != size || memcmp(inbuf, decomp, size) != 0) return false;
+    ratio = complen * 100.0 / size;
+    cspeed = (float)size * 1000 / (MAX(cnanosec, 1));
+    dspeed = (float)size * 1000 / (MAX(dnanosec, 1));
+    LZBENCH_PRINT(5, "%s -%d probe ratio=%.2f cspeed=%.1f dspeed=%.1f\n", desc->name, level, ratio, cspeed, dspeed);
+    return true;
+}
+
+
+/*
+ * Select a level with probes and bisection instead of benchmarking all of them, assuming that ratio improves
+ * and speed drops with the level: the fastest level reaching --search ratio or the highest level above
+ * --search speeds. Returns the level or first_level-1 if none is found.
+ */
+int lzbench_search_level(lzbench_params_t *params, const compressor_desc_t* desc, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    std::map<int, int> probed; // level -> 1 = meets the constraints
+    int lo = desc->first_level, hi = desc->last_level;
+    bool by_ratio = (params->search_ratio > 0);
+
+    auto meets = [&](int level) -> bool {
+        float ratio, cspeed, dspeed;
+        if (!probed.count(level))
+        {
+            bool ok = lzbench_probe(params, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, ratio, cspeed, dspeed);
+            probed[level] = ok && (by_ratio ? ratio <= params->search_ratio : (cspeed >= params->search_cspeed && dspeed >= params->search_dspeed));
+        }
+        return probed[level] != 0;
+    };
+
+    if (by_ratio)
+    {
+        if (!meets(hi)) return desc->first_level - 1;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            if (meets(mid)) hi = mid; else lo = mid + 1;
+        }
+    }
+    else
+    {
+        if (!meets(lo)) return desc->first_level - 1;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo + 1) / 2;
+            if (meets(mid)) lo = mid; else hi = mid - 1;
+        }
+    }
+
+    LZBENCH_PRINT(5, "%s level=%d selected after %d probes\n", desc->name, lo, (int)probed.size());
+    // the fastest level that reaches the ratio must also keep the speeds
+    if (by_ratio && (params->search_cspeed > 0 || params->search_dspeed > 0))
+    {
+        float ratio, cspeed, dspeed;
+        if (!lzbench_probe(params, desc, lo, inbuf, insize, compbuf, comprsize, decomp, rate, ratio, cspeed, dspeed)
+            || cspeed < params->search_cspeed || dspeed < params->search_dspeed) return desc->first_level - 1;
+    }
+    return lo;
+}
+
+
+/*
+ * Options of "-e name,level:key=value:key=value" for a level or "-e name:key=value,level" for all levels.
+ * They are given to the wrappers in lzbench_options and shown after the name of the codec.
+ */
+enum { OPTIONS_ZSTD, OPTIONS_BROTLI, OPTIONS_LZMA, OPTIONS_LZ4HC, OPTIONS_ZSTD_SEEKABLE }; // zstd_seekable takes also the options of zstd
+
+static const struct { const char* key; int codecs; size_t offset; } option_keys[] = {
+    { "wlog", OPTIONS_ZSTD, offsetof(codec_options_t, wlog) }, { "clog", OPTIONS_ZSTD, offsetof(codec_options_t, clog) },
+    { "hlog", OPTIONS_ZSTD, offsetof(codec_options_t, hlog) }, { "slog", OPTIONS_ZSTD, offsetof(codec_options_t, slog) },
+    { "mml", OPTIONS_ZSTD, offsetof(codec_options_t, mml) }, { "tlen", OPTIONS_ZSTD, offsetof(codec_options_t, tlen) },
+    { "strategy", OPTIONS_ZSTD, offsetof(codec_options_t, strategy) },
+    { "lgwin", OPTIONS_BROTLI, offsetof(codec_options_t, lgwin) }, { "lgblock", OPTIONS_BROTLI, offsetof(codec_options_t, lgblock) },
+    { "dict", OPTIONS_LZMA, offsetof(codec_options_t, dict) }, { "dictSize", OPTIONS_LZMA, offsetof(codec_options_t, dict) },
+    { "lc", OPTIONS_LZMA, offsetof(codec_options_t, lc) }, { "lp", OPTIONS_LZMA, offsetof(codec_options_t, lp) },
+    { "pb", OPTIONS_LZMA, offsetof(codec_options_t, pb) }, { "fb", OPTIONS_LZMA, offsetof(codec_options_t, fb) },
+    { "favordec", OPTIONS_LZ4HC, offsetof(codec_options_t, favordec) },
+    { "frame", OPTIONS_ZSTD_SEEKABLE, offsetof(codec_options_t, frame) },
+};
+
+static const char* zstd_strategies[] = { "", "fast", "dfast", "greedy", "lazy", "lazy2", "btlazy2", "btopt", "btultra", "btultra2", NULL };
+
+int option_codecs(const compressor_desc_t* desc)
+{
+    if (desc->compress == lzbench_zstd_compress || desc->compress == lzbench_zstd_LDM_compress || desc->compress == lzbench_zstdmt_compress) return OPTIONS_ZSTD;
+    if (desc->compress == lzbench_brotli_compress) return OPTIONS_BROTLI;
+    if (desc->compress == lzbench_lzma_compress || desc->compress == lzbench_lzmamt_compress || desc->compress == lzbench_xz_compress) return OPTIONS_LZMA;
+    if (desc->compress == lzbench_lz4hc_compress || desc->compress == lzbench_lz4hc_extstate_compress) return OPTIONS_LZ4HC;
+    if (desc->compress == lzbench_zstd_seekable_compress) return OPTIONS_ZSTD_SEEKABLE;
+    return -1;
+}
+
+
+/* sets lzbench_options from "key=value:key=value" (K and M suffixes of values), "" resets them */
+bool lzbench_set_options(lzbench_params_t *params, const compressor_desc_t* desc, const std::string& text)
+{
+    std::vector<std::string> items;
+
+    lzbench_reset_options(&lzbench_options);
+    params->codec_options.clear();
+    if (text.empty()) return true;
+
+    items = split(text, ':');
+    for (size_t i=0; i<items.size(); i++)
+    {
+        size_t eq = items[i].find('=');
+        std::string key = items[i].substr(0, eq), value = (eq == std::string::npos) ? "" : items[i].substr(eq + 1);
+        size_t k, n = sizeof(option_keys)/sizeof(option_keys[0]);
+        char* end;
+
+        if (key.empty()) continue;
+        for (k=0; k<n; k++)
+            if (istrcmp(key.c_str(), option_keys[k].key) == 0) break;
+        int codecs = option_codecs(desc);
+        if (codecs == OPTIONS_ZSTD_SEEKABLE && k < n && option_keys[k].codecs == OPTIONS_ZSTD) codecs = OPTIONS_ZSTD;
+        if (k == n || option_keys[k].codecs != codecs || value.empty()) {
+            printf("Option %s is not supported by %s\n", items[i].c_str(), desc->name);
+            lzbench_reset_options(&lzbench_options);
+            return false;
+        }
+
+        long v = strtol(value.c_str(), &end, 10);
+        if (end == value.c_str() && option_keys[k].offset == offsetof(codec_options_t, strategy)) {
+            for (v=1; zstd_strategies[v] && istrcmp(value.c_str(), zstd_strategies[v]) != 0; v++);
+            if (!zstd_strategies[v]) { printf("Unknown zstd strategy %s\n", value.c_str()); lzbench_reset_options(&lzbench_options); return false; }
+            end = (char*)value.c_str() + value.size();
+        }
+        if (*end == 'K' || *end == 'k') v <<= 10, end++;
+        else if (*end == 'M' || *end == 'm') v <<= 20, end++;
+        if (end == value.c_str() || *end || v < 0) {
+            printf("Invalid value of option %s\n", items[i].c_str());
+            lzbench_reset_options(&lzbench_options);
+            return false;
+        }
+        *(int*)((char*)&lzbench_options + option_keys[k].offset) = (int)v;
+        params->codec_options += (params->codec_options.empty() ? "" : ":") + items[i];
+    }
+    return true;
+}
+
+
+void lzbench_test_with_params(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    std::vector<std::string> cnames, cparams;
+
+    if (!namesWithParams) return;
+
+    LZBENCH_PRINT(5, "*** lzbench_test_with_params insize=%zu comprsize=%zu\n", insize, comprsize);
+
+    cnames = split(namesWithParams, '/');
+
+    for (int k=0; k<cnames.size(); k++)
+        LZBENCH_PRINT(5, "cnames[%d] = %s\n", k, cnames[k].c_str());
+
+    for (int k=0; k<cnames.size(); k++)
+    {
+        if (istrcmp(cnames[k].c_str(), "bestof") == 0)
+        {
+            lzbench_test_bestof(params, file_sizes, inbuf, insize, compbuf, comprsize, decomp, rate);
+            continue;
+        }
+        for (int i=0; i<LZBENCH_ALIASES_COUNT; i++)
+        {
+            if (istrcmp(cnames[k].c_str(), alias_desc[i].name)==0)
+            {
+                lzbench_test_with_params(params, file_sizes, alias_desc[i].params, inbuf, insize, compbuf, comprsize, decomp, rate);
+                goto next_k;
+            }
+        }
+
+        LZBENCH_PRINT(5, "params = %s\n", cnames[k].c_str());
+        if (cnames[k].compare(0, 2, "mt") == 0 && isdigit((unsigned char)cnames[k][2]) && cnames[k].find(':') != std::string::npos)
+        {
+            size_t colon = cnames[k].find(':');
+            params->block_threads = atoi(cnames[k].c_str() + 2);
+            if (params->block_threads < 1 || params->block_threads > 256) { printf("mt# of -e needs 1 to 256 threads: %s\n", cnames[k].c_str()); params->block_threads = 0; goto next_k; }
+            cnames[k].erase(0, colon + 1);
+        }
+        cparams = split(cnames[k].c_str(), ',');
+        if (cparams.size() >= 1)
+        {
+            int j=1, pruned_level=INT_MAX;
+            size_t colon = cparams[0].find(':');
+            std::string name_options = (colon == std::string::npos) ? "" : cparams[0].substr(colon + 1);
+            if (colon != std::string::npos) cparams[0].resize(colon);
+            size_t plus = cparams[0].rfind('+');
+            std::vector<lzbench_filter_t> filters;
+            params->filters = (plus == std::string::npos) ? "" : cparams[0].substr(0, plus);
+            if (plus != std::string::npos) cparams[0].erase(0, plus + 1);
+            if (!lzbench_parse_filters(params->filters, filters)) { params->filters.clear(); goto next_k; }
+            if (!params->filters.empty()) lzbench_test_filters(params, file_sizes, inbuf, insize, compbuf, comprsize, decomp, rate);
+            do {
+                bool found = false;
+                for (int i=1; i<codec_count(); i++)
+                {
+                    if (istrcmp(codec_desc(i)->name, cparams[0].c_str()) == 0)
+                    {
+                        found = true;
+                       // printf("%s %s %s\n", cparams[0].c_str(), codec_desc(i)->version, cparams[j].c_str());
+                        std::string options = name_options;
+                        size_t level_colon = (j < cparams.size()) ? cparams[j].find(':') : std::string::npos;
+                        if (level_colon != std::string::npos)
+                            options += (options.empty() ? "" : ":") + cparams[j].substr(level_colon + 1);
+                        if (!lzbench_set_options(params, codec_desc(i), options)) break;
+                        if (j >= cparams.size() && params->search && codec_desc(i)->compress)
+                        {
+                            int level = lzbench_search_level(params, codec_desc(i), inbuf, insize, compbuf, comprsize, decomp, rate);
+                            if (level >= codec_desc(i)->first_level)
+                                lzbench_test_threads(params, file_sizes, codec_desc(i), level, inbuf, insize, compbuf, comprsize, decomp, rate, level);
+                            else
+                                LZBENCH_PRINT(2, "%s %s: no level meets --search constraints\n", codec_desc(i)->name, codec_desc(i)->version);
+                        }
+                        else if (j >= cparams.size())
+                        {
+                            for (int level=codec_desc(i)->first_level; level<=codec_desc(i)->last_level; level++)
+                                if (lzbench_test_level(params, file_sizes, codec_desc(i), level, inbuf, insize, compbuf, comprsize, decomp, rate)) break;
+                        }
+                        else
+                        {
+                            int level = atoi(cparams[j].c_str());
+                            if (level <= pruned_level && lzbench_test_level(params, file_sizes, codec_desc(i), level, inbuf, insize, compbuf, comprsize, decomp, rate))
+                                pruned_level = level;
+                        }
+                        lzbench_set_options(params, codec_desc(i), "");
+                        break;
+                    }
+                }
+                if (!found) printf("NOT FOUND: %s %s\n", cparams[0].c_str(), (j<cparams.size()) ? cparams[j].c_str() : NULL);
+                j++;
+            }
+            while (j < cparams.size());
+            params->filters.clear();
+            params->block_threads = 0;
+        }
+next_k:
+        continue;
+    }
+}
+
+
+/*
+ * --recommend: all jobs of -e are run with a single iteration on a stratified sample (a slice at a random
+ * position of every 1/16 of the input), those meeting the constraints are ranked by their ratio and the
+ * best ones are benchmarked on the whole input with the normal settings
+ */
+void lzbench_recommend(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    const size_t strata = 16;
+    size_t sample_size = params->recommend_sample ? params->recommend_sample : MAX(insize / strata, (size_t)1 << 20);
+    sample_size = MIN(sample_size, insize);
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (params->jobs.empty() || !sample_size) return;
+
+    uint8_t *sample = (uint8_t*)alloc_and_touch(sample_size + PAD_SIZE, true);
+    if (!sample) { printf("Not enough memory for the --recommend sample\n"); return; }
+    std::mt19937 rng(1);
+    size_t slice = sample_size / strata, pos = 0;
+    for (size_t s=0; s<strata && slice; s++)
+    {
+        size_t stratum = insize / strata, start = s * stratum + (stratum > slice ? rng() % (stratum - slice + 1) : 0);
+        memcpy(sample + pos, inbuf + start, slice);
+        pos += slice;
+    }
+    if (pos < sample_size) memcpy(sample + pos, inbuf + insize - (sample_size - pos), sample_size - pos);
+    std::vector<size_t> sample_sizes(1, sample_size);
+
+    uint32_t cmintime = params->cmintime, dmintime = params->dmintime, c_iters = params->c_iters, d_iters = params->d_iters;
+    float ci_target = params->ci_target;
+    int merge_parts = params->merge_parts, memory = params->memory;
+    size_t first = params->results.size();
+    std::vector<std::pair<size_t, string_table_t> > candidates; // job and its row on the sample
+
+    LZBENCH_PRINT(2, "--recommend: %d jobs on a sample of %.1f MB\n", (int)params->jobs.size(), sample_size / 1048576.0);
+    params->cmintime = params->dmintime = 0;
+    params->c_iters = params->d_iters = 1;
+    params->ci_target = 0;
+    params->merge_parts = 1; // the rows of the sample are not printed
+    if (params->recommend_memory > 0) params->memory = 1;
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        size_t rows = params->results.size();
+        lzbench_set_options(params, desc, params->job_options[k]);
+        params->filters = params->job_filters[k];
+        lzbench_test_threads(params, sample_sizes, desc, params->jobs[k].second, sample, sample_size, compbuf, comprsize, decomp, rate, params->jobs[k].second);
+        lzbench_set_options(params, desc, "");
+        params->filters.clear();
+        for (size_t r=rows; r<params->results.size(); r++)
+        {
+            const string_table_t &row = params->results[r];
+            float cspeed = row.col2_ctime ? row.col5_origsize * 1000.0 / row.col2_ctime : 0, dspeed = row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0;
+            float mem = (row.memory.init_bytes + std::max(row.memory.cpeak, row.memory.dpeak)) / 1048576.0;
+            if (!row.col3_dtime || cspeed < params->recommend_cspeed || dspeed < params->recommend_dspeed) continue;
+            if (params->recommend_memory > 0 && mem > params->recommend_memory) continue;
+            candidates.push_back(std::make_pair(k, row));
+        }
+    }
+    params->results.erase(params->results.begin() + first, params->results.end());
+    params->cmintime = cmintime;
+    params->dmintime = dmintime;
+    params->c_iters = c_iters;
+    params->d_iters = d_iters;
+    params->ci_target = ci_target;
+    params->merge_parts = merge_parts;
+    params->memory = memory;
+    free_touched(sample);
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const std::pair<size_t, string_table_t> &a, const std::pair<size_t, string_table_t> &b) {
+        return a.second.col4_comprsize < b.second.col4_comprsize;
+    });
+    if ((int)candidates.size() > params->recommend_top) candidates.erase(candidates.begin() + params->recommend_top, candidates.end());
+    if (candidates.empty()) { printf("--recommend: no codec meets the constraints on the sample\n"); return; }
+
+    std::vector<size_t> full_rows;
+    for (size_t c=0; c<candidates.size(); c++)
+    {
+        size_t k = candidates[c].first;
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        lzbench_set_options(params, desc, params->job_options[k]);
+        params->filters = params->job_filters[k];
+        lzbench_test_threads(params, file_sizes, desc, params->jobs[k].second, inbuf, insize, compbuf, comprsize, decomp, rate, params->jobs[k].second);
+        lzbench_set_options(params, desc, "");
+        params->filters.clear();
+        full_rows.push_back(params->results.size() - 1);
+    }
+    if (params->textformat == JSON || params->results.size() <= first) return;
+
+    printf("\nRecommended by ratio");
+    if (params->recommend_cspeed > 0) printf(", compression >= %.0f MB/s", params->recommend_cspeed);
+    if (params->recommend_dspeed > 0) printf(", decompression >= %.0f MB/s", params->recommend_dspeed);
+    if (params->recommend_memory > 0) printf(", memory <= %.0f MB", params->recommend_memory);
+    printf(" (ratio of the sample in brackets):\n");
+    for (size_t c=0; c<full_rows.size(); c++)
+    {
+        const string_table_t &row = params->results[full_rows[c]], &probe = candidates[c].second;
+        printf("%2d. %-23s %6.2f%% (%6.2f%%) %8.1f MB/s %8.1f MB/s\n", (int)c + 1, row.col1_algname.c_str(),
+            row.col4_comprsize * 100.0 / row.col5_origsize, probe.col4_comprsize * 100.0 / probe.col5_origsize,
+            row.col2_ctime ? row.col5_origsize * 1000.0 / row.col2_ctime : 0, row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0);
+    }
+}
+
+
+#ifndef BENCH_REMOVE_ZSTD
+/*
+ * --tune: a paramgrill-like search of the compression parameters of zstd around a level. From the parameters of
+ * the level, every step probes all moves of a single parameter by one (targetLength by a factor of 2) and takes the
+ * best ratio among those with compression at least as fast as tune_cspeed, until no move improves the ratio. The
+ * Pareto set of ratio and compression speed of all probes is printed, the level and the best parameters are then
+ * benchmarked on the whole input as "zstd,level:wlog=...".
+ */
+#define TUNE_PARAMS 7
+#define TUNE_PASSES 3 // probes of every set of parameters, the fastest one is taken
+#define TUNE_MAX_PROBES 200
+
+static const struct { const char* key; int min, max; } tune_keys[TUNE_PARAMS] = {
+    { "wlog", 10, 27 }, { "clog", 6, 29 }, { "hlog", 6, 29 }, { "slog", 1, 26 }, { "mml", 3, 7 }, { "tlen", 0, 1 << 17 }, { "strategy", 1, 9 }
+};
+
+struct tune_point_t { std::vector<int> cparams; float ratio, cspeed, dspeed; };
+
+std::string tune_options(const std::vector<int>& cparams)
+{
+    std::string text;
+    for (int i=0; i<TUNE_PARAMS; i++)
+    {
+        std::string item;
+        if (i == TUNE_PARAMS - 1) format(item, "%s=%s", tune_keys[i].key, zstd_strategies[cparams[i]]);
+        else format(item, "%s=%d", tune_keys[i].key, cparams[i]);
+        text += (text.empty() ? "" : ":") + item;
+    }
+    return text;
+}
+
+void lzbench_tune(lzbench_params_t *params, std::vector<size_t> &file_sizes, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    const compressor_desc_t* desc = NULL;
+    std::map<std::vector<int>, tune_point_t> probed;
+    std::vector<int> start(TUNE_PARAMS), best;
+    size_t size = MIN(insize, SEARCH_PROBE_SIZE);
+    int level = params->tune_level, wlog_max = 10;
+    float cspeed_min;
+
+    for (int i=0; i<codec_count() && !desc; i++)
+        if (!strcmp(codec_desc(i)->name, "zstd")) desc = codec_desc(i);
+    if (!desc || !size) return;
+    while (wlog_max < tune_keys[0].max && ((size_t)1 << wlog_max) < size) wlog_max++; // a larger window finds nothing more
+
+    // NULL = the parameters fail, e.g. out of the bounds of this version of zstd
+    auto probe = [&](const std::vector<int>& cparams) -> const tune_point_t* {
+        if (!probed.count(cparams))
+        {
+            tune_point_t point = { cparams, 0, 0, 0 };
+            bool ok = lzbench_set_options(params, desc, tune_options(cparams));
+            for (int k=0; k<TUNE_PASSES && ok; k++)
+            {
+                float ratio, cspeed, dspeed;
+                ok = lzbench_probe(params, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, ratio, cspeed, dspeed);
+                point.ratio = ratio;
+                point.cspeed = std::max(point.cspeed, cspeed);
+                point.dspeed = std::max(point.dspeed, dspeed);
+            }
+            lzbench_set_options(params, desc, "");
+            if (!ok) point.ratio = 0;
+            probed[cparams] = point;
+            LZBENCH_PRINT(3, "--tune: %s %.2f%% %.1f MB/s %.1f MB/s\n", tune_options(cparams).c_str(), point.ratio, point.cspeed, point.dspeed);
+        }
+        const tune_point_t& point = probed[cparams];
+        return point.ratio > 0 ? &point : NULL;
+    };
+
+    lzbench_zstd_cparams(level, size, start.data());
+    const tune_point_t* base = probe(start);
+    if (!base) { printf("--tune: zstd -%d fails on the input\n", level); return; }
+    cspeed_min = params->tune_cspeed > 0 ? params->tune_cspeed : base->cspeed;
+    best = base->ratio > 0 && base->cspeed >= cspeed_min ? start : std::vector<int>();
+
+    std::vector<int> current = start;
+    while (probed.size() < TUNE_MAX_PROBES)
+    {
+        std::vector<int> next;
+        float next_ratio = best.empty() ? 1e9 : probed[best].ratio;
+        for (int i=0; i<TUNE_PARAMS; i++)
+            for (int dir=-1; dir<=1; dir+=2)
+            {
+                std::vector<int> cparams = current;
+                if (i == 5) cparams[i] = dir > 0 ? MAX(cparams[i] * 2, 1) : cparams[i] / 2;
+                else cparams[i] += dir;
+                int max = (i == 0) ? wlog_max : tune_keys[i].max;
+                if (cparams[i] < tune_keys[i].min || cparams[i] > max || cparams == current) continue;
+                const tune_point_t* point = probe(cparams);
+                if (point && point->cspeed >= cspeed_min && point->ratio < next_ratio) { next = cparams; next_ratio = point->ratio; }
+            }
+        if (next.empty()) break;
+        current = best = next;
+    }
+
+    // Pareto set: no other probe has both a better ratio and faster compression
+    std::vector<tune_point_t> pareto;
+    for (auto it = probed.begin(); it != probed.end(); ++it)
+    {
+        const tune_point_t& p = it->second;
+        bool dominated = (p.ratio <= 0);
+        for (auto jt = probed.begin(); jt != probed.end() && !dominated; ++jt)
+        {
+            const tune_point_t& q = jt->second;
+            dominated = q.ratio > 0 && q.ratio <= p.ratio && q.cspeed >= p.cspeed && (q.ratio < p.ratio || q.cspeed > p.cspeed);
+        }
+        if (!dominated) pareto.push_back(p);
+    }
+    std::sort(pareto.begin(), pareto.end(), [](const tune_point_t& a, const tune_point_t& b) { return a.cspeed > b.cspeed; });
+
+    std::string name;
+    format(name, "zstd,%d", level);
+    lzbench_test_with_params(params, file_sizes, name.c_str(), inbuf, insize, compbuf, comprsize, decomp, rate);
+    if (!best.empty() && best != start)
+    {
+        name += ":" + tune_options(best);
+        lzbench_test_with_params(params, file_sizes, name.c_str(), inbuf, insize, compbuf, comprsize, decomp, rate);
+    }
+
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"tune\",\"file\":");
+        fprint_json_string(stdout, params->in_filename);
+        printf(",\"codec\":\"zstd\",\"level\":%d,\"cspeed_min\":%.2f,\"probes\":%d,\"probe_size\":%llu,\"level_options\":\"%s\",\"best\":",
+            level, cspeed_min, (int)probed.size(), (unsigned long long)size, tune_options(start).c_str());
+        if (best.empty()) printf("null"); else printf("\"%s\"", tune_options(best).c_str());
+        printf(",\"pareto\":[");
+        for (size_t k=0; k<pareto.size(); k++)
+            printf("%s{\"options\":\"%s\",\"ratio\":%.4f,\"cspeed\":%.2f,\"dspeed\":%.2f}", k ? "," : "",
+                tune_options(pareto[k].cparams).c_str(), pareto[k].ratio, pareto[k].cspeed, pareto[k].dspeed);
+        printf("]}\n");
+        return;
+    }
+
+    printf("\nzstd -%d tuned with %d probes of %.1f MB for compression >= %.1f MB/s (%s of -%d)\n", level, (int)probed.size(),
+        size / 1048576.0, cspeed_min, tune_options(start).c_str(), level);
+    if (best.empty()) printf("no parameters meet the speed\n");
+    else if (best == start) printf("no move improves the parameters of the level\n");
+    printf("Pareto set of ratio and compression speed of the probes (* = tuned, - = level):\n");
+    for (size_t k=0; k<pareto.size(); k++)
+        printf("%c %6.2f%% %8.1f MB/s %8.1f MB/s  %s\n", pareto[k].cparams == best ? '*' : pareto[k].cparams == start ? '-' : ' ',
+            pareto[k].ratio, pareto[k].cspeed, pareto[k].dspeed, tune_options(pareto[k].cparams).c_str());
+}
+#endif
+
+
+#ifndef BENCH_REMOVE_ZSTD
+/*
+ * --adapt: streaming of the input with zstd in chunks of -b# (default = ADAPT_CHUNK) to a simulated link of
+ * adapt_mbps, like zstd --adapt. Compression of every chunk is timed, its output joins a queue of ADAPT_QUEUE chunks
+ * that the link sends at its speed, and the producer stalls while the queue is full. The controller raises the level
+ * after a stall (the link is the bottleneck) and lowers it when the link has waited for a chunk (compression is).
+ */
+#define ADAPT_CHUNK (1 << 20)
+#define ADAPT_QUEUE 4
+
+void lzbench_adapt(lzbench_params_t *params, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, bench_rate_t rate)
+{
+    const compressor_desc_t* desc = NULL;
+    bench_timer_t start_ticks, end_ticks;
+    size_t chunk = params->chunk_size < insize ? params->chunk_size : ADAPT_CHUNK;
+    double bytes_per_ns = params->adapt_mbps * 1e-3; // MB/s = bytes per us
+    double producer = 0, link = 0, idle = 0, stalled = 0; // ns of the simulation
+    std::vector<double> sent; // ns when the link has sent every chunk
+    std::vector<int> levels;
+    uint64_t compressed = 0, compress_ns = 0;
+    int level = MAX(params->adapt_min, MIN(3, params->adapt_max));
+
+    for (int i=0; i<codec_count() && !desc; i++)
+        if (!strcmp(codec_desc(i)->name, "zstd")) desc = codec_desc(i);
+    if (!desc || !insize) return;
+    chunk = MIN(chunk, insize);
+    char* workmem = desc->init(chunk, level, 0);
+    if (!workmem) { printf("--adapt: zstd init failed\n"); return; }
+    desc->compress((char*)inbuf, chunk, (char*)compbuf, comprsize, level, 0, workmem); // warm-up of the context
+
+    for (size_t pos = 0; pos < insize; pos += chunk)
+    {
+        size_t size = MIN(chunk, insize - pos);
+        size_t n = sent.size();
+        if (n >= ADAPT_QUEUE && sent[n - ADAPT_QUEUE] > producer)
+        {
+            stalled += sent[n - ADAPT_QUEUE] - producer;
+            producer = sent[n - ADAPT_QUEUE];
+            level = MIN(level + 1, params->adapt_max);
+        }
+        levels.push_back(level);
+        GetTime(start_ticks);
+        int64_t complen = desc->compress((char*)inbuf + pos, size, (char*)compbuf, comprsize, level, 0, workmem);
+        GetTime(end_ticks);
+        if (complen <= 0) { printf("--adapt: zstd -%d failed\n", level); desc->deinit(workmem); return; }
+        uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+        compress_ns += nanosec;
+        compressed += complen;
+        producer += nanosec;
+        if (n > 0 && producer > link)
+        {
+            idle += producer - link;
+            level = MAX(level - 1, params->adapt_min);
+        }
+        link = std::max(link, producer) + complen / bytes_per_ns;
+        sent.push_back(link);
+    }
+    desc->deinit(workmem);
+
+    link = std::max(link, 1.0);
+    double throughput = insize * 1000.0 / link, ratio = compressed * 100.0 / insize, average = 0;
+    for (size_t i=0; i<levels.size(); i++) average += levels[i];
+    average /= levels.size();
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"adapt\",\"file\":");
+        fprint_json_string(stdout, params->in_filename);
+        printf(",\"link_mbps\":%.2f,\"chunk_size\":%llu,\"chunks\":%d,\"throughput\":%.2f,\"ratio\":%.4f,\"link_busy\":%.4f,\"stalled\":%.4f,\"compress_ns\":%llu,\"levels\":[",
+            params->adapt_mbps, (unsigned long long)chunk, (int)levels.size(), throughput, ratio, 100.0 * (link - idle) / link,
+            100.0 * stalled / link, (unsigned long long)compress_ns);
+        for (size_t i=0; i<levels.size(); i++) printf("%s%d", i ? "," : "", levels[i]);
+        printf("]}\n");
+        return;
+    }
+
+    printf("\nzstd --adapt to a link of %.1f MB/s (levels %d-%d, %d chunks of %s): %.1f MB/s, ratio %.2f%%, average level %.1f\n",
+        params->adapt_mbps, params->adapt_min, params->adapt_max, (int)levels.size(), size_label(chunk).c_str(), throughput, ratio, average);
+    printf("link busy %.1f%%, producer stalled on a full queue %.1f%% of %.1f ms\n", 100.0 * (link - idle) / link,
+        100.0 * stalled / link, link / 1e6);
+    printf("levels of chunks (level x chunks):");
+    for (size_t i=0, j; i<levels.size(); i=j)
+    {
+        for (j=i; j<levels.size() && levels[j] == levels[i]; j++);
+        printf(" %dx%d", levels[i], (int)(j - i));
+    }
+    printf("\n");
+}
+#endif
+
+
+/* name of a row of a job collected with collect_jobs, as in print_stats() */
+std::string lzbench_job_name(lzbench_params_t *params, size_t k)
+{
+    const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+    std::string prefix = params->job_filters[k].empty() ? "" : params->job_filters[k] + "+";
+    std::string name = row_name(prefix + codec_name(desc), desc, params->jobs[k].second);
+    if (!params->job_options[k].empty()) name += " " + params->job_options[k];
+    return name;
+}
+
+
+/*
+ * --mix: a server that runs several codecs on one core, e.g. lz4 on the hot path, zstd for cold data and a
+ * checksum. Chunks of -b# (default = MIX_CHUNK) are given to the jobs of -e by a smooth weighted round-robin of
+ * --mix=#,#... and every call is timed. Each pass first runs every job alone over its chunks, then all of them in
+ * the order of the chunks, so the difference is the cost of sharing the caches and branch predictors with the
+ * other codecs. The best pass of every job is shown.
+ */
+#define MIX_CHUNK (64 << 10)
+
+void lzbench_mix(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    size_t chunk = params->chunk_size < insize ? params->chunk_size : MIX_CHUNK;
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    size_t n = params->jobs.size();
+    if (n < 2 || !insize) { printf("--mix needs at least two codecs of -e\n"); return; }
+    for (size_t k=0; k<n; k++)
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --mix runs %s without its filters\n", lzbench_job_name(params, k).c_str());
+
+    // smooth weighted round-robin: every chunk goes to the job furthest behind its share
+    std::vector<int> weights(n, 1), credit(n, 0);
+    for (size_t k=0; k<n && k<params->mix_weights.size(); k++) weights[k] = params->mix_weights[k];
+    int total = std::accumulate(weights.begin(), weights.end(), 0);
+    std::vector<size_t> owner, csizes;
+    for (size_t pos = 0; pos < insize; pos += chunk)
+    {
+        size_t best = 0;
+        for (size_t k=0; k<n; k++)
+        {
+            credit[k] += weights[k];
+            if (credit[k] > credit[best]) best = k;
+        }
+        credit[best] -= total;
+        owner.push_back(best);
+    }
+    size_t chunks = owner.size(), slot = GET_COMPRESS_BOUND(chunk);
+    csizes.resize(chunks);
+
+    std::vector<const compressor_desc_t*> descs(n);
+    std::vector<codec_options_t> options(n);
+    std::vector<char*> workmem(n);
+    for (size_t k=0; k<n; k++)
+    {
+        descs[k] = codec_desc(params->jobs[k].first);
+        lzbench_set_options(params, descs[k], params->job_options[k]);
+        options[k] = lzbench_options;
+        workmem[k] = descs[k]->init ? descs[k]->init(chunk, params->jobs[k].second, descs[k]->additional_param) : NULL;
+    }
+    lzbench_set_options(params, descs[0], "");
+    uint8_t *slots = (uint8_t*)alloc_and_touch(chunks * slot + PAD_SIZE, false);
+    if (!slots) { printf("Not enough memory for --mix\n"); return; }
+
+    // one call on chunk i, the time is added to its job
+    auto call = [&](size_t i, bool decompress, std::vector<uint64_t>& ns) -> bool {
+        size_t k = owner[i], pos = i * chunk, size = MIN(chunk, insize - pos);
+        const compressor_desc_t* desc = descs[k];
+        int64_t len;
+        lzbench_options = options[k];
+        GetTime(start_ticks);
+        if (!decompress) len = desc->compress((char*)inbuf + pos, size, (char*)slots + i * slot, slot, params->jobs[k].second, desc->additional_param, workmem[k]);
+        else if (csizes[i] == size) { memcpy(decomp + pos, slots + i * slot, size); len = size; } // stored
+        else len = desc->decompress((char*)slots + i * slot, csizes[i], (char*)decomp + pos, size, params->jobs[k].second, desc->additional_param, workmem[k]);
+        GetTime(end_ticks);
+        ns[k] += GetDiffTime(rate, start_ticks, end_ticks);
+        if (!decompress) csizes[i] = (len <= 0 || (size_t)len >= size) ? size : len;
+        if (!decompress && csizes[i] == size && len != (int64_t)size) memcpy(slots + i * slot, inbuf + pos, size);
+        return !decompress || is_checksum(desc) || len == (int64_t)size;
+    };
+
+    std::vector<uint64_t> best[2][2]; // [alone, mixed][compression, decompression]
+    for (int m=0; m<2; m++) for (int d=0; d<2; d++) best[m][d].assign(n, UINT64_MAX);
+    std::vector<uint64_t> bytes(n, 0), compressed(n, 0);
+    for (size_t i=0; i<chunks; i++) bytes[owner[i]] += MIN(chunk, insize - i * chunk);
+    uint32_t iters = MAX(params->c_iters, params->d_iters), mintime = MAX(params->cmintime, params->dmintime);
+    int passes = 0;
+    bool ok = true;
+    bench_timer_t loop_ticks, now_ticks;
+    GetTime(loop_ticks);
+    for ( ; ok; passes++)
+    {
+        GetTime(now_ticks);
+        if (passes > 0 && passes >= (int)iters && GetDiffTime(rate, loop_ticks, now_ticks) >= (uint64_t)mintime * 1000000) break;
+        for (int d=0; d<2 && ok; d++)
+        {
+            for (size_t k=0; k<n && ok; k++)
+            {
+                std::vector<uint64_t> ns(n, 0);
+                for (size_t i=0; i<chunks && ok; i++)
+                    if (owner[i] == k) ok = call(i, d, ns);
+                best[0][d][k] = MIN(best[0][d][k], ns[k]);
+            }
+            std::vector<uint64_t> ns(n, 0);
+            for (size_t i=0; i<chunks && ok; i++) ok = call(i, d, ns);
+            for (size_t k=0; k<n; k++) best[1][d][k] = MIN(best[1][d][k], ns[k]);
+        }
+    }
+    for (size_t i=0; i<chunks; i++) compressed[owner[i]] += csizes[i];
+    for (size_t k=0; k<n; k++)
+        if (descs[k]->deinit) descs[k]->deinit(workmem[k]);
+    free_touched(slots);
+    lzbench_reset_options(&lzbench_options);
+    for (size_t i=0; i<chunks && ok; i++)
+    {
+        size_t pos = i * chunk;
+        if (!is_checksum(descs[owner[i]]) && memcmp(decomp + pos, inbuf + pos, MIN(chunk, insize - pos)) != 0) ok = false;
+    }
+    if (!ok) { printf("ERROR: --mix decompression failed\n"); return; }
+
+    auto speed = [&](int m, int d, size_t k) -> double { return best[m][d][k] ? bytes[k] * 1000.0 / best[m][d][k] : 0; };
+    if (params->textformat == JSON)
+    {
+        printf("{\"type\":\"mix\",\"file\":");
+        fprint_json_string(stdout, params->in_filename);
+        printf(",\"chunk_size\":%llu,\"chunks\":%d,\"codecs\":[", (unsigned long long)chunk, (int)chunks);
+        for (size_t k=0; k<n; k++)
+        {
+            printf("%s{\"name\":", k ? "," : "");
+            fprint_json_string(stdout, lzbench_job_name(params, k).c_str());
+            printf(",\"weight\":%d,\"orig_size\":%llu,\"compr_size\":%llu,\"alone_cspeed\":%.2f,\"mix_cspeed\":%.2f", weights[k],
+                (unsigned long long)bytes[k], (unsigned long long)compressed[k], speed(0, 0, k), speed(1, 0, k));
+            if (!is_checksum(descs[k])) printf(",\"alone_dspeed\":%.2f,\"mix_dspeed\":%.2f", speed(0, 1, k), speed(1, 1, k));
+            printf("}");
+        }
+        printf("]}\n");
+        return;
+    }
+
+    printf("\n--mix of %d codecs over %d chunks of %s on one core, best of %d passes:\n", (int)n, (int)chunks, size_label(chunk).c_str(), passes);
+    printf("%-27s Weight  Alone C  Mixed C  Change  Alone D  Mixed D  Change\n", "Compressor name");
+    for (size_t k=0; k<n; k++)
+    {
+        printf("%-27s %6d", lzbench_job_name(params, k).c_str(), weights[k]);
+        for (int d=0; d<2; d++)
+        {
+            double alone = speed(0, d, k), mixed = speed(1, d, k);
+            if (d && is_checksum(descs[k])) printf(" %8s %8s %7s", "-", "-", "-");
+            else printf(" %8.0f %8.0f %+6.1f%%", alone, mixed, alone > 0 ? mixed * 100.0 / alone - 100 : 0);
+        }
+        printf("\n");
+    }
+}
+
+
+int64_t process_rss(bool peak);
+
+/*
+ * --streams=#,#...: # streaming contexts of every job of -e are open at once, like the connections of a server, and
+ * writes of --stream-write=# bytes of the input go to contexts picked at random, each followed by a flush. Every
+ * context gets a first write before the timed writes, so the memory it keeps between writes is resident. Shown are
+ * the resident memory per context, contexts per GB, the speed of the random writes and their LLC misses per KB,
+ * which grow once the working set of the contexts no longer fits the caches.
+ */
+void lzbench_streams(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    size_t write = params->stream_write ? params->stream_write : 1024;
+    size_t outsize = GET_COMPRESS_BOUND(write) + (4 << 20);
+    int64_t phys = -1;
+#if defined(__linux__)
+    phys = (int64_t)sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+#endif
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (!insize) return;
+    std::vector<char> out(outsize);
+
+    lzbench_thread_t thr;
+    perf_open(params, thr);
+    bool json_first = true;
+    if (params->textformat == JSON) printf("{\"type\":\"streams\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"write_size\":%llu,\"jobs\":[", (unsigned long long)write);
+    else printf("\n--streams with writes of %s to contexts picked at random, a flush after every write:\n%-27s Streams  KB/ctx  Ctx/GB     MB/s  Change  Ratio  LLC/KB\n", size_label(write).c_str(), "Compressor name");
+
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k);
+        size_t level = params->jobs[k].second;
+        if (!desc->stream) { fprintf(stderr, "warning: --streams skips %s without a streaming interface\n", name.c_str()); continue; }
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --streams runs %s without its filters\n", name.c_str());
+        const stream_desc_t* stream = desc->stream;
+        lzbench_set_options(params, desc, params->job_options[k]);
+        double first_speed = 0;
+        if (params->textformat == JSON) printf("%s{\"name\":", json_first ? "" : ","), fprint_json_string(stdout, name.c_str()), printf(",\"rows\":["), json_first = false;
+
+        for (size_t s=0; s<params->stream_counts.size(); s++)
+        {
+            size_t count = params->stream_counts[s], opened = 0, pos = 0;
+            std::vector<char*> states(count, (char*)NULL);
+            uint64_t in_bytes = 0, out_bytes = 0, perf_start[PERF_COUNTERS], perf_end[PERF_COUNTERS];
+#if defined(__linux__) && defined(__GLIBC__)
+            malloc_trim(0); // the contexts of the previous row would be reused without new resident memory
+#endif
+            int64_t rss0 = process_rss(false), res = 0;
+            const char* fail = NULL;
+
+            // the next write of the input, it wraps around at its end
+            auto next = [&](size_t i) -> int64_t {
+                size_t part = MIN(write, insize - pos);
+                int64_t len = stream->feed(states[i], (char*)inbuf + pos, part, out.data(), outsize), flushed = 0;
+                if (len >= 0 && stream->flush) flushed = stream->flush(states[i], out.data() + len, outsize - len);
+                pos = (pos + part) % insize;
+                in_bytes += part;
+                return (len < 0 || flushed < 0) ? -1 : len + flushed;
+            };
+
+            // resident memory is checked about every 1/64 of RAM that the contexts take
+            for (size_t check = 1; opened < count && !fail; opened++)
+            {
+                if (!(states[opened] = stream->begin(level, desc->additional_param))) fail = "out of memory";
+                else if (next(opened) < 0) fail = "a write failed";
+                else if (phys > 0 && rss0 >= 0 && opened + 1 == check)
+                {
+                    int64_t rss = process_rss(false), per = std::max<int64_t>((rss - rss0) / (int64_t)(opened + 1), 1);
+                    if (rss > phys / 4 * 3) fail = "resident memory over 75% of RAM";
+                    check += std::min<int64_t>(std::max<int64_t>(phys / 64 / per, 1), 256);
+                }
+            }
+            int64_t rss1 = process_rss(false);
+            if (fail) opened -= states[opened-1] ? 0 : 1;
+
+            std::mt19937 rng(1);
+            size_t writes = fail ? 0 : std::max(insize / write, 2 * count);
+            in_bytes = 0;
+            perf_read(thr, perf_start);
+            GetTime(start_ticks);
+            for (size_t w=0; w<writes && res >= 0; w++)
+                if ((res = next(rng() % count)) >= 0) out_bytes += res;
+            GetTime(end_ticks);
+            perf_read(thr, perf_end);
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            for (size_t i=0; i<opened; i++) stream->end(states[i], NULL, 0);
+            if (res < 0) fail = "a write failed";
+
+            double kb_ctx = (rss0 >= 0 && rss1 >= rss0 && opened) ? (rss1 - rss0) / 1024.0 / opened : -1;
+            double speed = nanosec ? in_bytes * 1000.0 / nanosec : 0;
+            double ratio = in_bytes ? out_bytes * 100.0 / in_bytes : 0;
+            double llc = (thr.perf_fd[PERF_LLC_MISSES] >= 0 && in_bytes) ? (perf_end[PERF_LLC_MISSES] - perf_start[PERF_LLC_MISSES]) * 1024.0 / in_bytes : -1;
+            if (s == 0) first_speed = speed;
+
+            if (params->textformat == JSON)
+            {
+                printf("%s{\"streams\":%llu,\"opened\":%llu", s ? "," : "", (unsigned long long)count, (unsigned long long)opened);
+                if (kb_ctx >= 0) printf(",\"kb_per_stream\":%.1f,\"streams_per_gb\":%.0f", kb_ctx, kb_ctx > 0 ? 1048576 / kb_ctx : 0);
+                if (!fail) printf(",\"writes\":%llu,\"speed\":%.2f,\"ratio\":%.2f", (unsigned long long)writes, speed, ratio);
+                if (!fail && llc >= 0) printf(",\"llc_misses_per_kb\":%.1f", llc);
+                if (fail) printf(",\"error\":\"%s\"", fail);
+                printf("}");
+                if (fail) break;
+                continue;
+            }
+            printf("%-27s %7llu", name.c_str(), (unsigned long long)count);
+            if (kb_ctx >= 0) printf(" %7.1f %7.0f", kb_ctx, kb_ctx > 0 ? 1048576 / kb_ctx : 0);
+            else printf(" %7s %7s", "-", "-");
+            if (fail) { printf("  stopped at %llu streams: %s\n", (unsigned long long)opened, fail); break; }
+            printf(" %8.1f %+6.1f%% %5.1f%%", speed, s && first_speed > 0 ? speed * 100.0 / first_speed - 100 : 0, ratio);
+            if (llc >= 0) printf(" %7.1f\n", llc);
+            else printf(" %7s\n", "-");
+        }
+        if (params->textformat == JSON) printf("]}");
+        lzbench_reset_options(&lzbench_options);
+    }
+    if (params->textformat == JSON) printf("]}\n");
+    perf_close(thr);
+}
+
+
+/*
+ * --msg-batch=#,#...: the messages of --msg are compressed # at a time in one call, batches of consecutive messages,
+ * against one call per message. With messages arriving at --msg-batch rate=# per second a message waits for the
+ * rest of its batch, on average (#-1)/2 arrivals and at most #-1, and then for the compression of the batch.
+ */
+void lzbench_msg_batch(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks, loop_ticks;
+    double arrival = params->msg_batch_rate > 0 ? params->msg_batch_rate : 10000;
+    std::vector<size_t> sizes;
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (params->msg_sizes.empty()) params->msg_sizes = { 64, 1024 }, params->msg_random = 1;
+    msg_chunk_sizes(params, file_sizes, SIZE_MAX, sizes);
+    size_t messages = sizes.size();
+    if (!messages) return;
+
+    std::string dist, size;
+    for (size_t i=0; i<params->msg_sizes.size(); i++)
+    {
+        format(size, "%s%llu", i ? (params->msg_random ? "-" : ",") : "", (unsigned long long)params->msg_sizes[i]);
+        dist += size;
+    }
+    if (params->textformat == JSON) printf("{\"type\":\"msg_batch\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"messages\":%llu,\"message_sizes\":\"%s\",\"arrival_rate\":%.0f,\"jobs\":[", (unsigned long long)messages, dist.c_str(), arrival);
+    else printf("\n--msg-batch of %llu messages of %s bytes arriving at %.0f/s, latency from arrival to the compressed batch:\n%-27s  Batch   B/msg  Ratio  C ns/msg  D ns/msg  Lat avg us  Lat max us   CPU\n", (unsigned long long)messages, dist.c_str(), arrival, "Compressor name");
+
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k);
+        size_t level = params->jobs[k].second;
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --msg-batch runs %s without its filters\n", name.c_str());
+        lzbench_set_options(params, desc, params->job_options[k]);
+        if (params->textformat == JSON) printf("%s{\"name\":", k ? "," : ""), fprint_json_string(stdout, name.c_str()), printf(",\"rows\":[");
+
+        for (size_t b=0; b<params->msg_batches.size(); b++)
+        {
+            // batches are consecutive messages, so each one is a contiguous part of the input
+            size_t batch = params->msg_batches[b], largest = 0, bound = 0;
+            std::vector<size_t> starts, lens, slots, csizes;
+            for (size_t i=0, pos=0; i<messages; i+=batch)
+            {
+                size_t len = 0;
+                for (size_t j=i; j<messages && j<i+batch; j++) len += sizes[j];
+                starts.push_back(pos), lens.push_back(len), slots.push_back(bound);
+                pos += len;
+                largest = std::max(largest, len);
+                bound += GET_COMPRESS_BOUND(len);
+            }
+            if (largest > codec_chunk_limit(desc)) { fprintf(stderr, "warning: --msg-batch skips batches of %llu messages over the limit of %s\n", (unsigned long long)batch, name.c_str()); continue; }
+            size_t batches = lens.size();
+            csizes.resize(batches);
+            std::vector<uint8_t> slot(bound + PAD_SIZE);
+            char* workmem = desc->init ? desc->init(largest, level, desc->additional_param) : NULL;
+
+            uint64_t best[2] = { UINT64_MAX, UINT64_MAX };
+            bool ok = true;
+            for (int d=0; d<2 && ok; d++)
+            {
+                uint32_t iters = d ? params->d_iters : params->c_iters;
+                uint64_t mintime = (uint64_t)(d ? params->dmintime : params->cmintime) * 1000000;
+                if (d && is_checksum(desc)) break;
+                GetTime(loop_ticks);
+                for (uint32_t pass = 0; ok; pass++)
+                {
+                    GetTime(start_ticks);
+                    if (pass > 0 && pass >= iters && GetDiffTime(rate, loop_ticks, start_ticks) >= mintime) break;
+                    for (size_t i=0; i<batches && ok; i++)
+                    {
+                        char *in = (char*)inbuf + starts[i], *out = (char*)slot.data() + slots[i];
+                        int64_t len;
+                        if (!d) len = desc->compress(in, lens[i], out, GET_COMPRESS_BOUND(lens[i]), level, desc->additional_param, workmem);
+                        else if (csizes[i] == lens[i]) { memcpy(decomp + starts[i], out, lens[i]); len = lens[i]; } // stored
+                        else len = desc->decompress(out, csizes[i], (char*)decomp + starts[i], lens[i], level, desc->additional_param, workmem);
+                        if (!d) csizes[i] = (len <= 0 || (size_t)len >= lens[i]) ? lens[i] : len;
+                        if (!d && csizes[i] == lens[i]) memcpy(out, in, lens[i]);
+                        if (d && len != (int64_t)lens[i]) ok = false;
+                    }
+                    GetTime(end_ticks);
+                    best[d] = MIN(best[d], GetDiffTime(rate, start_ticks, end_ticks));
+                }
+            }
+            if (desc->deinit) desc->deinit(workmem);
+            if (ok && !is_checksum(desc) && memcmp(decomp, inbuf, starts.back() + lens.back()) != 0) ok = false;
+
+            uint64_t compressed = std::accumulate(csizes.begin(), csizes.end(), (uint64_t)0);
+            double bytes_msg = (double)compressed / messages, ratio = compressed * 100.0 / (starts.back() + lens.back());
+            double cns = (double)best[0] / messages, dns = ok && best[1] != UINT64_MAX ? (double)best[1] / messages : 0;
+            double batch_us = (double)best[0] / batches / 1000, wait_us = (batch - 1) * 1e6 / arrival;
+            double cpu = cns * arrival / 1e7; // % of a core to keep up with the arrivals
+            if (params->textformat == JSON)
+            {
+                printf("%s{\"batch\":%llu,\"bytes_per_msg\":%.2f,\"ratio\":%.2f,\"cns_per_msg\":%.1f", b ? "," : "", (unsigned long long)batch, bytes_msg, ratio, cns);
+                if (dns > 0) printf(",\"dns_per_msg\":%.1f", dns);
+                printf(",\"latency_avg_us\":%.1f,\"latency_max_us\":%.1f,\"cpu\":%.2f%s}", wait_us / 2 + batch_us, wait_us + batch_us, cpu, ok ? "" : ",\"error\":\"decompression failed\"");
+                continue;
+            }
+            printf("%-27s %6llu %7.1f %5.1f%% %9.1f", name.c_str(), (unsigned long long)batch, bytes_msg, ratio, cns);
+            if (!ok) { printf("  ERROR: decompression failed\n"); continue; }
+            if (dns > 0) printf(" %9.1f", dns);
+            else printf(" %9s", "-");
+            printf(" %11.1f %11.1f %4.0f%%\n", wait_us / 2 + batch_us, wait_us + batch_us, cpu);
+        }
+        if (params->textformat == JSON) printf("]}");
+        lzbench_reset_options(&lzbench_options);
+    }
+    if (params->textformat == JSON) printf("]}\n");
+}
+
+
+/*
+ * --ingest=#,#...: chunks of -b# are released to -T# workers by a token bucket of # MB/s with room for one chunk, for
+ * the time of -t# compression. A worker sleeps until the release of its next chunk, so the CPU time from getrusage()
+ * is only the work of the codec at that rate, and cores per GB/s is what capacity planning multiplies with. The
+ * latency of a chunk is from its release to the end of its compression, it grows when the workers fall behind; then
+ * cores per GB/s are of the achieved rate and chunks still waiting after twice the time are dropped.
+ */
+void lzbench_ingest(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    typedef std::chrono::steady_clock clock;
+    size_t chunk = MIN(params->chunk_size, insize);
+    uint64_t duration = std::max<uint64_t>(params->cmintime, 100) * 1000000ULL; // ns
+    int nthreads = MAX(params->threads, 1);
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (!insize) return;
+    std::vector<size_t> offsets;
+    for (size_t pos = 0; pos < insize; pos += chunk) offsets.push_back(pos);
+    lzbench_thread_pool pool(nthreads);
+    std::vector<std::vector<uint8_t> > out(nthreads, std::vector<uint8_t>(GET_COMPRESS_BOUND(chunk)));
+    std::vector<char*> workmem(nthreads);
+
+    if (params->textformat == JSON) printf("{\"type\":\"ingest\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"chunk_size\":%llu,\"threads\":%d,\"jobs\":[", (unsigned long long)chunk, nthreads);
+    else printf("\n--ingest of chunks of %s by %d thread%s for %.1f s, cores from getrusage(), latency from release to compressed:\n%-27s     Rate  Achieved  Cores  Cores per GB/s   p50 ms   p99 ms   max ms\n",
+        size_label(chunk).c_str(), nthreads, nthreads > 1 ? "s" : "", duration / 1e9, "Compressor name");
+
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k);
+        size_t level = params->jobs[k].second;
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --ingest runs %s without its filters\n", name.c_str());
+        lzbench_set_options(params, desc, params->job_options[k]);
+        codec_options_t options = lzbench_options;
+        for (int t=0; t<nthreads; t++)
+            workmem[t] = desc->init ? desc->init(chunk, level, desc->additional_param) : NULL;
+        if (params->textformat == JSON) printf("%s{\"name\":", k ? "," : ""), fprint_json_string(stdout, name.c_str()), printf(",\"rows\":[");
+
+        for (size_t r=0; r<params->ingest_rates.size(); r++)
+        {
+            // the release of every chunk: the bucket gets # MB/s of tokens, a chunk takes its size of them
+            double mbs = params->ingest_rates[r];
+            std::vector<uint64_t> release, latency;
+            uint64_t tokens = 0;
+            for (size_t i = 0; ; i++)
+            {
+                uint64_t at = (uint64_t)(tokens * 1000.0 / mbs);
+                if (at >= duration) break;
+                release.push_back(at);
+                tokens += MIN(chunk, insize - offsets[i % offsets.size()]);
+            }
+            latency.assign(release.size(), UINT64_MAX);
+            std::atomic<size_t> next(0);
+            std::atomic<uint64_t> done(0);
+            std::atomic<bool> failed(false);
+            uint64_t ru_start[6], ru_end[6];
+
+            pool.run([&](int t) { // a warm-up call, its pages of workmem and output aren't counted
+                lzbench_options = options;
+                size_t size = MIN(chunk, insize);
+                desc->compress((char*)inbuf, size, (char*)out[t].data(), out[t].size(), level, desc->additional_param, workmem[t]);
+            });
+            rusage_read(ru_start);
+            clock::time_point start = clock::now();
+            pool.run([&](int t) {
+                for (size_t i; (i = next++) < release.size(); )
+                {
+                    size_t pos = offsets[i % offsets.size()], size = MIN(chunk, insize - pos);
+                    std::this_thread::sleep_until(start + std::chrono::nanoseconds(release[i]));
+                    if (desc->compress((char*)inbuf + pos, size, (char*)out[t].data(), out[t].size(), level, desc->additional_param, workmem[t]) <= 0) failed = true;
+                    latency[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() - release[i];
+                    done += size;
+                    if (release[i] + latency[i] > 2 * duration) break; // the workers fell behind, the rest is dropped
+                }
+            });
+            uint64_t wall = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+            rusage_read(ru_end);
+
+            double cores = wall ? (double)(ru_end[0] - ru_start[0] + ru_end[1] - ru_start[1]) / wall : 0;
+            double achieved = wall ? done * 1000.0 / wall : 0, per_gbs = achieved > 0 ? cores * 1000 / achieved : 0;
+            std::sort(latency.begin(), latency.end());
+            latency.erase(std::lower_bound(latency.begin(), latency.end(), UINT64_MAX), latency.end());
+            auto pct = [&](double p) -> double { return latency.empty() ? 0 : latency[std::min(latency.size() - 1, (size_t)(p / 100 * latency.size()))] / 1e6; };
+            if (params->textformat == JSON)
+            {
+                printf("%s{\"rate\":%.2f,\"speed\":%.2f,\"chunks\":%llu,\"cores\":%.3f,\"cores_per_gbs\":%.3f,\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"max_ms\":%.3f%s}", r ? "," : "",
+                    mbs, achieved, (unsigned long long)latency.size(), cores, per_gbs, pct(50), pct(99), latency.empty() ? 0 : latency.back() / 1e6, failed ? ",\"error\":\"compression failed\"" : "");
+                continue;
+            }
+            if (failed) { printf("%-27s %8.0f  ERROR: compression failed\n", name.c_str(), mbs); continue; }
+            printf("%-27s %8.0f %9.0f %6.2f %15.2f %8.2f %8.2f %8.2f%s\n", name.c_str(), mbs, achieved, cores, per_gbs,
+                pct(50), pct(99), latency.empty() ? 0 : latency.back() / 1e6, achieved < mbs * 0.98 ? "  falls behind" : "");
+        }
+        if (params->textformat == JSON) printf("]}");
+        for (int t=0; t<nthreads; t++)
+            if (desc->deinit) desc->deinit(workmem[t]);
+        lzbench_reset_options(&lzbench_options);
+    }
+    if (params->textformat == JSON) printf("]}\n");
+}
+
+/*
+ * --match-finders: the match finders of matchfinders.c over the chunks of the input, every one is timed alone
+ * over all chunks until -t# ms of compression passed, the fastest pass counts. The window is the one of the
+ * option, reduced to the chunk size rounded up to a power of 2 (libdeflate has 32 KB of deflate).
+ */
+void lzbench_match_finders(lzbench_params_t *params, uint8_t *inbuf, size_t insize, bench_rate_t rate)
+{
+    size_t chunk = MIN(params->chunk_size, insize), window = 1 << 16;
+    while (window < chunk && window < params->mf_window) window <<= 1;
+    window = std::min(window, params->mf_window);
+    if (!insize) return;
+
+    if (params->textformat == JSON) printf("{\"type\":\"match_finders\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"chunk_size\":%llu,\"nice_len\":%u,\"depth\":%u,\"rows\":[", (unsigned long long)chunk, params->mf_nice_len, params->mf_depth);
+    else printf("\n--match-finders over chunks of %s, nice length %u, depth %u, every position searched, lengths capped at nice:\n%-18s   Window   Mpos/s     Matches  Per pos  Found %%  Avg len  Avg dist\n",
+        size_label(chunk).c_str(), params->mf_nice_len, params->mf_depth, "Match finder");
+
+    for (int k=0; k<lzbench_mf_count; k++)
+    {
+        const lzbench_mf_desc_t* mf = &lzbench_mf_desc[k];
+        size_t mf_window = mf->max_window ? mf->max_window : window;
+        void* state = mf->create(chunk, mf_window, params->mf_nice_len, params->mf_depth);
+        lzbench_mf_stats_t stats;
+        bench_timer_t start_ticks, end_ticks;
+        uint64_t best = UINT64_MAX, total = 0;
+        bool failed = !state;
+
+        while (!failed && (best == UINT64_MAX || total < (uint64_t)params->cmintime * 1000000))
+        {
+            memset(&stats, 0, sizeof(stats));
+            GetTime(start_ticks);
+            for (size_t pos = 0; pos < insize && !failed; pos += chunk)
+                failed = mf->run(state, inbuf + pos, MIN(chunk, insize - pos), &stats) != 0;
+            GetTime(end_ticks);
+            uint64_t nanosec = GetDiffTime(rate, start_ticks, end_ticks);
+            best = std::min(best, nanosec);
+            total += nanosec;
+        }
+        if (state) mf->destroy(state);
+
+        double mpos = !failed && best ? stats.positions * 1000.0 / best : 0;
+        double per_pos = stats.positions ? (double)stats.matches / stats.positions : 0, found = stats.positions ? stats.found * 100.0 / stats.positions : 0;
+        double avg_len = stats.found ? (double)stats.length_sum / stats.found : 0, avg_dist = stats.found ? (double)stats.distance_sum / stats.found : 0;
+        if (params->textformat == JSON)
+        {
+            printf("%s{\"name\":\"%s\",\"window\":%llu", k ? "," : "", mf->name, (unsigned long long)mf_window);
+            if (failed) printf(",\"error\":\"no memory\"}");
+            else printf(",\"mpos_per_s\":%.2f,\"positions\":%llu,\"matches\":%llu,\"found\":%llu,\"avg_len\":%.2f,\"avg_dist\":%.0f,\"all_matches\":%s}", mpos, (unsigned long long)stats.positions,
+                (unsigned long long)stats.matches, (unsigned long long)stats.found, avg_len, avg_dist, mf->all_matches ? "true" : "false");
+            continue;
+        }
+        if (failed) { printf("%-18s %8s  ERROR: out of memory or input too large\n", mf->name, size_label(mf_window).c_str()); continue; }
+        printf("%-18s %8s %8.1f %11llu %8.2f %8.1f %8.2f %9.0f\n", mf->name, size_label(mf_window).c_str(), mpos,
+            (unsigned long long)stats.matches, per_pos, found, avg_len, avg_dist);
+    }
+    if (params->textformat == JSON) printf("]}\n");
+    else printf("(Per pos > 1 for the finders that return a match of every length, the others return only the longest one)\n");
+}
+
+
+/*
+ * --soak=#[,#[,#]]: every job of -e runs for # hours on one thread, compressing, decompressing and verifying the
+ * chunks of -b# in turn (at other offsets in every round when the input isn't a multiple of them) with a single
+ * context of init for the whole run. Every interval (default = 60 s) shows its
+ * speeds, the RSS of the process, the heap and allocations of codecs that take allocation functions and the
+ * mismatches; a new context is also created and freed in every interval, so leaks of init and deinit add up. The
+ * first interval is the reference: a speed that is lower by more than # % (default = 10) is drift, an RSS or heap
+ * that is larger by more than # % and 1 MB is growth.
+ */
+void lzbench_soak(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    uint64_t duration = (uint64_t)(params->soak_hours * 3600e9), interval = (uint64_t)(params->soak_interval * 1e9);
+    double threshold = params->soak_threshold / 100;
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (!insize) return;
+
+    if (params->textformat == JSON) printf("{\"type\":\"soak\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"hours\":%.3f,\"interval_s\":%.0f,\"threshold\":%.1f,\"jobs\":[", params->soak_hours, params->soak_interval, params->soak_threshold);
+    else printf("\n--soak for %g h per job, rows every %g s, drift and growth beyond %.1f%% of the first interval:\n", params->soak_hours, params->soak_interval, params->soak_threshold);
+
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k);
+        size_t level = params->jobs[k].second, chunk = MIN(MIN(params->chunk_size, insize), codec_chunk_limit(desc)), next = 0;
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --soak runs %s without its filters\n", name.c_str());
+        lzbench_set_options(params, desc, params->job_options[k]);
+
+        char* workmem = desc->init ? desc->init(chunk, level, desc->additional_param) : NULL;
+        int64_t rss0 = 0, heap0 = 0, rss = 0, heap = 0;
+        double cspeed0 = 0, dspeed0 = 0, cworst = 0, dworst = 0;
+        uint64_t elapsed = 0, total = 0, mismatches = 0, allocs_prev, allocs;
+        bool drift = false, growth = false;
+        lzbench_mem_stats(NULL, NULL, &allocs_prev);
+
+        if (params->textformat == JSON) printf("%s{\"name\":", k ? "," : ""), fprint_json_string(stdout, name.c_str()), printf(",\"chunk_size\":%llu,\"intervals\":[", (unsigned long long)chunk);
+        else printf("%-27s  Minute  C MB/s  D MB/s   RSS MB  Heap MB    Allocs  Errors\n", name.c_str());
+
+        for (int n = 0; elapsed < duration; n++)
+        {
+            bench_timer_t start_ticks, t0, t1, t2;
+            uint64_t ctime = 0, dtime = 0, bytes = 0, errors = 0, now = 0;
+
+            GetTime(start_ticks);
+            if (desc->init && desc->deinit) desc->deinit(desc->init(chunk, level, desc->additional_param));
+            do
+            {
+                size_t pos = (next++ * chunk) % insize, size = MIN(chunk, insize - pos);
+                GetTime(t0);
+                int64_t clen = desc->compress((char*)inbuf + pos, size, (char*)compbuf, comprsize, level, desc->additional_param, workmem);
+                GetTime(t1);
+                bool stored = clen <= 0 || (size_t)clen >= size || is_checksum(desc);
+                int64_t dlen = stored ? (int64_t)size : desc->decompress((char*)compbuf, clen, (char*)decomp + pos, size, level, desc->additional_param, workmem);
+                GetTime(t2);
+                ctime += GetDiffTime(rate, t0, t1);
+                dtime += stored ? 0 : GetDiffTime(rate, t1, t2);
+                bytes += size;
+                if (!stored && (dlen != (int64_t)size || memcmp(decomp + pos, inbuf + pos, size) != 0)) errors++;
+                now = GetDiffTime(rate, start_ticks, t2);
+            } while (now < interval && elapsed + now < duration);
+            elapsed += now;
+            total += bytes;
+            mismatches += errors;
+
+            lzbench_mem_stats(&heap, NULL, &allocs);
+            rss = process_rss(false);
+            double cspeed = ctime ? bytes * 1000.0 / ctime : 0, dspeed = dtime ? bytes * 1000.0 / dtime : 0;
+            if (n == 0) { rss0 = rss; heap0 = heap; cspeed0 = cworst = cspeed; dspeed0 = dworst = dspeed; }
+            cworst = std::min(cworst, cspeed);
+            dworst = std::min(dworst, dspeed);
+            bool slow = cspeed < cspeed0 * (1 - threshold) || dspeed < dspeed0 * (1 - threshold);
+            bool grown = (rss0 > 0 && rss > rss0 * (1 + threshold) + (1 << 20)) || heap > heap0 * (1 + threshold) + (1 << 20);
+            drift |= slow;
+            growth |= grown;
+
+            if (params->textformat == JSON)
+                printf("%s{\"minute\":%.2f,\"cspeed\":%.2f,\"dspeed\":%.2f,\"rss\":%lld,\"heap\":%lld,\"allocs\":%llu,\"mismatches\":%llu,\"drift\":%s,\"growth\":%s}", n ? "," : "",
+                    elapsed / 60e9, cspeed, dspeed, (long long)rss, (long long)heap, (unsigned long long)(allocs - allocs_prev), (unsigned long long)errors, slow ? "true" : "false", grown ? "true" : "false");
+            else
+                printf("%-27s %7.1f %7.1f %7.1f %8.1f %8.1f %9llu %7llu%s%s\n", "", elapsed / 60e9, cspeed, dspeed, rss / 1048576.0, heap / 1048576.0,
+                    (unsigned long long)(allocs - allocs_prev), (unsigned long long)errors, slow ? "  drift" : "", grown ? "  growth" : "");
+            fflush(stdout);
+            allocs_prev = allocs;
+        }
+        if (desc->deinit) desc->deinit(workmem);
+        lzbench_reset_options(&lzbench_options);
+
+        double cdrop = cspeed0 ? (cworst / cspeed0 - 1) * 100 : 0, ddrop = dspeed0 ? (dworst / dspeed0 - 1) * 100 : 0;
+        if (params->textformat == JSON)
+        {
+            printf("],\"gb\":%.3f,\"cspeed_worst\":%.1f,\"dspeed_worst\":%.1f,\"rss_growth\":%lld,\"heap_growth\":%lld,\"mismatches\":%llu,\"drift\":%s,\"growth\":%s}", total / 1e9, cdrop, ddrop,
+                (long long)(rss - rss0), (long long)(heap - heap0), (unsigned long long)mismatches, drift ? "true" : "false", growth ? "true" : "false");
+            continue;
+        }
+        printf("%-27s %.2f GB, worst speed %+.1f%%/%+.1f%%, RSS %+.1f MB, heap %+.1f MB, %llu mismatches: %s%s%s%s\n", name.c_str(), total / 1e9, cdrop, ddrop,
+            (rss - rss0) / 1048576.0, (heap - heap0) / 1048576.0, (unsigned long long)mismatches, drift ? "DRIFT " : "", growth ? "GROWTH " : "", mismatches ? "MISMATCH" : "",
+            drift || growth || mismatches ? "" : "stable");
+    }
+    if (params->textformat == JSON) printf("]}\n");
+}
+
+
+/*
+ * --interop: every encoder of -e that belongs to a family of interop_desc compresses the input once in chunks of -b#
+ * and every row of the family that was built decodes it, with the level of the encoder within its own levels.
+ * A pair is verified against the input and its decompression speed is the best pass over -u# ms.
+ */
+void lzbench_interop(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    int last = -1;
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (!insize) return;
+
+    if (params->textformat == JSON) printf("{\"type\":\"interop\",\"file\":"), fprint_json_string(stdout, params->in_filename), printf(",\"rows\":[");
+    else printf("\n--interop: decompression speed in MB/s of every encoder (rows) with every decoder of its family (columns), * = fastest\n");
+
+    for (size_t k=0, rows=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* enc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k);
+        size_t level = params->jobs[k].second;
+        std::vector<const compressor_desc_t*> decoders;
+        int family = -1;
+        for (int f=0; f<LZBENCH_INTEROP_COUNT && family < 0; f++)
+        {
+            std::vector<std::string> names = split(interop_desc[f].codecs, '/');
+            if (std::find(names.begin(), names.end(), enc->name) == names.end()) continue;
+            family = f;
+            for (size_t n=0; n<names.size(); n++)
+                for (int i=0; i<LZBENCH_COMPRESSOR_COUNT; i++)
+                    if (names[n] == comp_desc[i].name && comp_desc[i].decompress) decoders.push_back(&comp_desc[i]);
+        }
+        if (family < 0)
+        {
+            if (k == 0 || params->jobs[k-1].first != params->jobs[k].first) fprintf(stderr, "warning: --interop: %s is in no family of a common format\n", enc->name);
+            continue;
+        }
+        if (!params->job_filters[k].empty()) fprintf(stderr, "warning: --interop runs %s without its filters\n", name.c_str());
+
+        // chunks of -b# that every decoder of the family takes
+        size_t chunk = MIN(params->chunk_size, codec_chunk_limit(enc));
+        for (size_t d=0; d<decoders.size(); d++) chunk = MIN(chunk, codec_chunk_limit(decoders[d]));
+        std::vector<size_t> chunk_sizes, compr_sizes;
+        for (size_t i=0; i<file_sizes.size(); i++)
+            for (size_t left = file_sizes[i]; left > 0; left -= MIN(chunk, left))
+                chunk_sizes.push_back(MIN(chunk, left));
+
+        lzbench_set_options(params, enc, params->job_options[k]);
+        char* workmem = enc->init ? enc->init(chunk, level, enc->additional_param) : NULL;
+        int64_t complen = lzbench_compress(params, chunk_sizes, enc->compress, compr_sizes, inbuf, compbuf, comprsize, level, enc->additional_param, workmem, NULL);
+        if (enc->deinit) enc->deinit(workmem);
+
+        if (family != last && params->textformat != JSON)
+        {
+            printf("\n%-27s %7s", interop_desc[family].family, "Ratio");
+            for (size_t d=0; d<decoders.size(); d++) printf(" %15.15s", decoders[d]->name);
+            printf("\n");
+            last = family;
+        }
+        if (params->textformat == JSON) printf("%s{\"family\":\"%s\",\"encoder\":", rows++ ? "," : "", interop_desc[family].family), fprint_json_string(stdout, name.c_str()), printf(",\"ratio\":%.2f,\"decoders\":[", complen * 100.0 / insize);
+        else printf("%-27s %6.2f%%", name.c_str(), complen * 100.0 / insize);
+        if (complen <= 0)
+        {
+            if (params->textformat == JSON) printf("],\"error\":\"compression failed\"}");
+            else printf("  ERROR: compression failed\n");
+            lzbench_reset_options(&lzbench_options);
+            continue;
+        }
+
+        std::vector<double> speeds(decoders.size(), 0);
+        for (size_t d=0; d<decoders.size(); d++)
+        {
+            const compressor_desc_t* dec = decoders[d];
+            size_t dlevel = MIN(MAX(level, (size_t)dec->first_level), (size_t)dec->last_level);
+            char* dworkmem = dec->init ? dec->init(chunk, dlevel, dec->additional_param) : NULL;
+            bench_timer_t start_ticks, end_ticks;
+            uint64_t best = UINT64_MAX, total = 0;
+            bool ok = true;
+            while (ok && (best == UINT64_MAX || total < (uint64_t)params->dmintime * 1000000))
+            {
+                GetTime(start_ticks);
+                int64_t dlen = lzbench_decompress(params, chunk_sizes, dec->decompress, compr_sizes, compbuf, decomp, dlevel, dec->additional_param, dworkmem, NULL);
+                GetTime(end_ticks);
+                ok = dlen == (int64_t)insize && memcmp(decomp, inbuf, insize) == 0;
+                best = std::min(best, (uint64_t)GetDiffTime(rate, start_ticks, end_ticks));
+                total += GetDiffTime(rate, start_ticks, end_ticks);
+            }
+            if (dec->deinit) dec->deinit(dworkmem);
+            speeds[d] = ok && best ? insize * 1000.0 / best : -1;
+        }
+        size_t fastest = std::max_element(speeds.begin(), speeds.end()) - speeds.begin();
+        for (size_t d=0; d<decoders.size(); d++)
+        {
+            if (params->textformat == JSON)
+            {
+                printf("%s{\"name\":\"%s\",", d ? "," : "", decoders[d]->name);
+                if (speeds[d] < 0) printf("\"verified\":false}");
+                else printf("\"verified\":true,\"dspeed\":%.2f}", speeds[d]);
+            }
+            else if (speeds[d] < 0) printf(" %15s", "FAIL");
+            else printf(" %14.1f%c", speeds[d], d == fastest ? '*' : ' ');
+        }
+        if (params->textformat == JSON) printf("]}");
+        else printf("\n");
+        lzbench_reset_options(&lzbench_options);
+    }
+    if (params->textformat == JSON) printf("]}\n");
+    else printf("(FAIL = the decoder rejected the stream or its output differs from the input)\n");
+}
+
+
+
+#if !defined(_WIN32)
+bool write_all(int fd, const char* buf, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, buf, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        size -= n;
+    }
+    return true;
+}
+
+
+/*
+ * --isolate: every job is run in a forked process, a crash or a hang of a codec costs only its own row. Rows of a job
+ * are sent over a pipe when it's done, a job that is killed by a signal, exits with an error or runs longer than
+ * isolate_timeout gets a failed row. Every job starts with the heap of lzbench and its peak RSS is shown, it
+ * writes to output buffers of its own so that no copy-on-write faults are timed.
+ */
+void lzbench_isolate(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        int fds[2];
+        if (pipe(fds) != 0) { perror("pipe"); return; }
+
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid < 0) { perror("fork"); close(fds[0]); close(fds[1]); return; }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            // the output buffers are copy-on-write after fork(), the job gets touched buffers of its own like lzbench
+            uint8_t *jcompbuf = (uint8_t*)alloc_and_touch(comprsize, false), *jdecomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+            if (jcompbuf && jdecomp) compbuf = jcompbuf, decomp = jdecomp;
+            size_t first = params->results.size();
+            params->merge_parts = 1; // rows are printed by lzbench
+            lzbench_set_options(params, desc, params->job_options[k]);
+            params->filters = params->job_filters[k];
+            lzbench_test_threads(params, file_sizes, desc, params->jobs[k].second, inbuf, insize, compbuf, comprsize, decomp, rate, params->jobs[k].second);
+            for (size_t r=first; r<params->results.size(); r++)
+            {
+                lzbench_row_writer out;
+                lzbench_row_fields(out, params->results[r]);
+                uint64_t size = out.data.size();
+                if (!write_all(fds[1], (const char*)&size, sizeof(size)) || !write_all(fds[1], out.data.data(), out.data.size())) break;
+            }
+            fflush(stdout);
+            _exit(0);
+        }
+
+        close(fds[1]);
+        std::string data;
+        std::vector<string_table_t> rows;
+        bench_timer_t start_ticks, end_ticks;
+        bool timeout = false;
+        GetTime(start_ticks);
+        while (true)
+        {
+            int wait_ms = -1;
+            if (params->isolate_timeout)
+            {
+                GetTime(end_ticks);
+                int64_t left = (int64_t)params->isolate_timeout * 1000 - (int64_t)(GetDiffTime(rate, start_ticks, end_ticks) / 1000000);
+                if (left <= 0) { timeout = true; break; }
+                wait_ms = (int)left;
+            }
+            struct pollfd pfd = { fds[0], POLLIN, 0 };
+            int ready = poll(&pfd, 1, wait_ms);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready == 0) continue; // the timeout is checked above
+            char buf[65536];
+            ssize_t n = read(fds[0], buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            data.append(buf, n);
+
+            uint64_t size;
+            while (data.size() >= sizeof(size) && (memcpy(&size, data.data(), sizeof(size)), data.size() - sizeof(size) >= size))
+            {
+                string_table_t row("", 0, 0, 0, 0, "");
+                lzbench_row_reader in = { data.data() + sizeof(size), data.data() + sizeof(size) + size, true };
+                lzbench_row_fields(in, row);
+                if (in.ok) rows.push_back(row);
+                data.erase(0, sizeof(size) + size);
+            }
+        }
+        if (timeout) kill(pid, SIGKILL);
+        close(fds[0]);
+
+        int status = 0;
+        struct rusage usage;
+        memset(&usage, 0, sizeof(usage));
+        while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR);
+
+        std::string failure;
+        if (timeout)
+            format(failure, "timeout %us", params->isolate_timeout);
+        else if (WIFSIGNALED(status))
+            failure = strsignal(WTERMSIG(status));
+        else if (WIFEXITED(status) && WEXITSTATUS(status) != 0)
+            format(failure, "exit %d", WEXITSTATUS(status));
+        if (!failure.empty())
+        {
+            string_table_t row(lzbench_job_name(params, k), 0, 0, 0, insize, params->in_filename);
+            row.level = params->jobs[k].second;
+            row.name = codec_name(desc);
+            row.version = desc->version;
+            row.failure = failure;
+            rows.push_back(row);
+            fprintf(stderr, "%s: %s\n", row.col1_algname.c_str(), failure.c_str());
+        }
+
+        for (size_t r=0; r<rows.size(); r++)
+        {
+            rows[r].max_rss_kb = usage.ru_maxrss; // KB on Linux
+            params->results.push_back(rows[r]);
+            if (params->merge_parts) continue; // printed by lzbench_merge_parts()
+            if (params->show_speed)
+                print_speed(params, params->results.back());
+            else
+                print_time(params, params->results.back());
+        }
+    }
+}
+#if defined(__linux__)
+/*
+ * --cold-start: the child, lzbench --cold-start-child fd size codec level options, maps the input from fd, calls
+ * init, compress and decompress once and writes their times in ns, the compressed size and 1 if the data matches
+ * to stdout. It runs before any setup of main(), so the time of the process is exec, dynamic linking, static
+ * initializers of all codecs and first-call page faults.
+ */
+int lzbench_cold_child(char** argv, bench_rate_t rate)
+{
+    bench_timer_t t0, t1, t2, t3;
+    lzbench_params_t params;
+    const compressor_desc_t* desc = NULL;
+    int fd = atoi(argv[0]), level = atoi(argv[3]);
+    size_t size = strtoull(argv[1], NULL, 10);
+
+    for (int i=0; i<codec_count() && !desc; i++)
+        if (!strcmp(codec_desc(i)->name, argv[2])) desc = codec_desc(i);
+    if (!desc || !size || !lzbench_set_options(&params, desc, argv[4])) return 1;
+    char* in = (char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    size_t bound = codec_bound(desc, size);
+    char* out = (char*)malloc(bound + PAD_SIZE);
+    char* dec = (char*)malloc(size + PAD_SIZE);
+    if (in == MAP_FAILED || !out || !dec) return 1;
+
+    GetTime(t0);
+    char* workmem = desc->init ? desc->init(size, level, desc->additional_param) : NULL;
+    GetTime(t1);
+    int64_t clen = desc->compress(in, size, out, bound, level, desc->additional_param, workmem);
+    GetTime(t2);
+    int64_t dlen = (clen > 0 && !is_checksum(desc)) ? desc->decompress(out, clen, dec, size, level, desc->additional_param, workmem) : 0;
+    GetTime(t3);
+    if (desc->deinit) desc->deinit(workmem);
+    bool ok = clen > 0 && (is_checksum(desc) || (dlen == (int64_t)size && memcmp(in, dec, size) == 0));
+    printf("%llu %llu %llu %lld %d\n", (unsigned long long)GetDiffTime(rate, t0, t1), (unsigned long long)GetDiffTime(rate, t1, t2),
+        (unsigned long long)GetDiffTime(rate, t2, t3), (long long)clen, ok ? 1 : 0);
+    return ok ? 0 : 2;
+}
+
+
+/*
+ * --cold-start=#: the latency of a CLI or a serverless function that handles one request, every job is run # times
+ * in a fresh process spawned from the binary of lzbench on the first chunk of -b#. The wall time from posix_spawn()
+ * to the exit of the child is split into the start of the process and its first init, compress and decompress.
+ */
+void lzbench_cold_start(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+
+    size_t size = MIN(params->chunk_size, insize);
+    char exe[4096];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    FILE* tmp = tmpfile();
+    if (len <= 0 || !tmp || !size || fwrite(inbuf, 1, size, tmp) != size || fflush(tmp) != 0)
+    {
+        fprintf(stderr, "--cold-start: cannot write the input for the child processes\n");
+        if (tmp) fclose(tmp);
+        return;
+    }
+    exe[len] = 0;
+    int fd = fileno(tmp);
+    fcntl(fd, F_SETFD, 0); // inherited by the children
+    std::string fd_arg = std::to_string(fd), size_arg = std::to_string(size);
+
+    if (params->textformat != JSON)
+    {
+        printf("\n--cold-start: %d fresh processes per codec on %s of %s, wall time from spawn to exit in ms:\n", params->cold_start, size_label(size).c_str(), params->in_filename);
+        printf("%-27s     Min  Median     P90     Max   Start    Init   Comp  Decomp\n", "Compressor name");
+    }
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::string name = lzbench_job_name(params, k), level_arg = std::to_string(params->jobs[k].second);
+        if (params->jobs[k].first >= LZBENCH_COMPRESSOR_COUNT || !params->job_filters[k].empty())
+        {
+            fprintf(stderr, "warning: --cold-start skips %s, the child runs bundled codecs without filters\n", name.c_str());
+            continue;
+        }
+
+        std::vector<uint64_t> total, init, comp, dec;
+        std::string failure;
+        for (int r=0; r<params->cold_start && failure.empty(); r++)
+        {
+            const char* argv[] = { exe, "--cold-start-child", fd_arg.c_str(), size_arg.c_str(), desc->name, level_arg.c_str(), params->job_options[k].c_str(), NULL };
+            int fds[2];
+            posix_spawn_file_actions_t actions;
+            pid_t pid;
+            bench_timer_t start_ticks, end_ticks;
+            if (pipe(fds) != 0) { perror("pipe"); break; }
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, fds[1], 1);
+            posix_spawn_file_actions_addclose(&actions, fds[0]);
+            fflush(stdout);
+            GetTime(start_ticks);
+            int err = posix_spawn(&pid, exe, &actions, NULL, (char* const*)argv, environ);
+            posix_spawn_file_actions_destroy(&actions);
+            close(fds[1]);
+            if (err) { close(fds[0]); failure = strerror(err); break; }
+            std::string line;
+            char buf[256];
+            ssize_t n;
+            while ((n = read(fds[0], buf, sizeof(buf))) != 0)
+                if (n > 0) line.append(buf, n); else if (errno != EINTR) break;
+            close(fds[0]);
+            int status = 0;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR);
+            GetTime(end_ticks);
+
+            unsigned long long t[3];
+            long long clen;
+            int ok = 0;
+            if (!WIFEXITED(status) || sscanf(line.c_str(), "%llu %llu %llu %lld %d", &t[0], &t[1], &t[2], &clen, &ok) != 5 || !ok)
+            {
+                failure = WIFSIGNALED(status) ? strsignal(WTERMSIG(status)) : "failed";
+                break;
+            }
+            total.push_back(GetDiffTime(rate, start_ticks, end_ticks));
+            init.push_back(t[0]);
+            comp.push_back(t[1]);
+            dec.push_back(t[2]);
+        }
+        if (!failure.empty())
+        {
+            fprintf(stderr, "%s: --cold-start child %s\n", name.c_str(), failure.c_str());
+            continue;
+        }
+
+        // medians of the parts of a start, the start of the process is what the codec calls leave of the total
+        std::vector<uint64_t> start(total.size());
+        for (size_t r=0; r<total.size(); r++)
+            start[r] = total[r] - MIN(total[r], init[r] + comp[r] + dec[r]);
+        auto at = [](std::vector<uint64_t> v, double q) { std::sort(v.begin(), v.end()); return v[MIN((size_t)(q * v.size()), v.size() - 1)] / 1e6; };
+        if (params->textformat == JSON)
+        {
+            printf("{\"type\":\"cold_start\",\"name\":");
+            fprint_json_string(stdout, name.c_str());
+            printf(",\"file\":");
+            fprint_json_string(stdout, params->in_filename);
+            printf(",\"size\":%llu,\"runs\":%d,\"total_ms\":[", (unsigned long long)size, (int)total.size());
+            for (size_t r=0; r<total.size(); r++) printf("%s%.3f", r ? "," : "", total[r] / 1e6);
+            printf("],\"start_ms\":%.3f,\"init_ms\":%.3f,\"compress_ms\":%.3f,\"decompress_ms\":%.3f}\n", at(start, 0.5), at(init, 0.5), at(comp, 0.5), at(dec, 0.5));
+            continue;
+        }
+        printf("%-27s %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %6.2f %7.2f\n", name.c_str(), at(total, 0), at(total, 0.5), at(total, 0.9), at(total, 1),
+            at(start, 0.5), at(init, 0.5), at(comp, 0.5), at(dec, 0.5));
+    }
+    fclose(tmp);
+}
+#endif
+
+
+/*
+ * -P#: every job is run by # forked processes at once, each (de)compresses its own contiguous part of the chunks
+ * of an input that is mapped from one shared-memory segment, with compbuf, decomp and the heap of its own.
+ * Rows of the processes are summed into one row with the aggregate MB/s, to be compared with -T# where threads
+ * share one heap and the allocator of the process.
+ */
+void lzbench_processes(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    int nprocs = params->processes;
+    size_t chunk_size = (params->chunk_size > insize) ? insize : params->chunk_size;
+    size_t chunks = (insize + chunk_size - 1) / chunk_size;
+    std::vector<size_t> starts(nprocs + 1, insize);
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (params->jobs.empty() || !insize) return;
+
+    if (chunks < (size_t)nprocs)
+        chunk_size = (insize + nprocs - 1) / nprocs, chunks = (insize + chunk_size - 1) / chunk_size; // every process gets a chunk
+    for (int p=0; p<nprocs; p++)
+        starts[p] = MIN(chunks * p / nprocs * chunk_size, insize);
+
+    uint8_t* shared = (uint8_t*)mmap(NULL, insize + PAD_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    lzbench_process_barrier_t* barrier = (lzbench_process_barrier_t*)mmap(NULL, sizeof(lzbench_process_barrier_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED || barrier == MAP_FAILED)
+    {
+        perror("mmap");
+        if (shared != MAP_FAILED) munmap(shared, insize + PAD_SIZE);
+        if (barrier != MAP_FAILED) munmap(barrier, sizeof(lzbench_process_barrier_t));
+        return;
+    }
+    memcpy(shared, inbuf, insize);
+    memset(shared + insize, 0, PAD_SIZE);
+
+    if (nprocs > lzbench_cpus())
+        fprintf(stderr, "warning: -P%d runs more processes than CPUs, their passes are timed while others wait\n", nprocs);
+    LZBENCH_PRINT(2, "-P%d: %d jobs, %llu chunks of the input in shared memory\n", nprocs, (int)params->jobs.size(), (unsigned long long)chunks);
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        std::vector<pid_t> pids(nprocs, -1);
+        std::vector<int> fds(nprocs, -1);
+        std::vector<std::string> data(nprocs);
+        std::vector<std::vector<string_table_t> > rows(nprocs);
+
+        barrier->count = 0;
+        barrier->generation = 0;
+        barrier->broken = 0;
+        barrier->parties = nprocs;
+        fflush(stdout);
+        for (int p=0; p<nprocs; p++)
+        {
+            int pipefd[2];
+            if (pipe(pipefd) != 0) { perror("pipe"); barrier->parties = p; break; }
+            pids[p] = fork();
+            if (pids[p] < 0) { perror("fork"); close(pipefd[0]); close(pipefd[1]); barrier->parties = p; break; }
+            if (pids[p] == 0)
+            {
+                close(pipefd[0]);
+                for (int q=0; q<p; q++) close(fds[q]);
+                size_t partsize = starts[p+1] - starts[p];
+                size_t partcompr = partsize + (comprsize - insize); // compbuf keeps the margin over the input of the whole file
+                std::vector<size_t> part_sizes(1, partsize);
+                uint8_t* pcompbuf = (uint8_t*)alloc_untouched(partcompr);
+                uint8_t* pdecomp = (uint8_t*)alloc_and_touch(partsize + PAD_SIZE, true);
+                if (!pcompbuf || !pdecomp) { printf("Not enough memory for -P process %d\n", p); barrier->broken = 1; _exit(1); }
+
+                process_barrier = barrier;
+                params->merge_parts = 1; // rows are printed by lzbench
+                params->results_cache = NULL; // parts have keys of their own, a hit in one process would leave the others at the barrier
+                if (p > 0) params->verbose = MIN(params->verbose, 1); // progress lines of processes would overwrite each other
+                params->chunk_size = MIN(params->chunk_size, partsize);
+                size_t first = params->results.size();
+                lzbench_set_options(params, desc, params->job_options[k]);
+                params->filters = params->job_filters[k];
+                lzbench_test_threads(params, part_sizes, desc, params->jobs[k].second, shared + starts[p], partsize, pcompbuf, partcompr, pdecomp, rate, params->jobs[k].second);
+                for (size_t r=first; r<params->results.size(); r++)
+                {
+                    lzbench_row_writer out;
+                    lzbench_row_fields(out, params->results[r]);
+                    uint64_t size = out.data.size();
+                    if (!write_all(pipefd[1], (const char*)&size, sizeof(size)) || !write_all(pipefd[1], out.data.data(), out.data.size())) break;
+                }
+                fflush(stdout);
+                _exit(0);
+            }
+            close(pipefd[1]);
+            fds[p] = pipefd[0];
+        }
+
+        // rows are read from all pipes at once, a process that waits to write its rows would hold up the others
+        int open_fds = 0;
+        for (int p=0; p<nprocs; p++) if (fds[p] >= 0) open_fds++;
+        while (open_fds > 0)
+        {
+            std::vector<struct pollfd> pfds;
+            std::vector<int> owners;
+            for (int p=0; p<nprocs; p++)
+                if (fds[p] >= 0) { struct pollfd pfd = { fds[p], POLLIN, 0 }; pfds.push_back(pfd); owners.push_back(p); }
+            int ready = poll(pfds.data(), pfds.size(), -1);
+            if (ready < 0 && errno == EINTR) continue;
+            if (ready < 0) { perror("poll"); break; }
+            for (size_t i=0; i<pfds.size(); i++)
+            {
+                if (!pfds[i].revents) continue;
+                int p = owners[i];
+                char buf[65536];
+                ssize_t n = read(fds[p], buf, sizeof(buf));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0)
+                {
+                    close(fds[p]);
+                    fds[p] = -1;
+                    open_fds--;
+                    int status = 0;
+                    while (waitpid(pids[p], &status, 0) < 0 && errno == EINTR);
+                    pids[p] = -1;
+                    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                    {
+                        barrier->broken = 1;
+                        fprintf(stderr, "-P: process %d of %s failed\n", p, lzbench_job_name(params, k).c_str());
+                        rows[p].clear();
+                    }
+                    continue;
+                }
+                data[p].append(buf, n);
+
+                uint64_t size;
+                while (data[p].size() >= sizeof(size) && (memcpy(&size, data[p].data(), sizeof(size)), data[p].size() - sizeof(size) >= size))
+                {
+                    string_table_t row("", 0, 0, 0, 0, "");
+                    lzbench_row_reader in = { data[p].data() + sizeof(size), data[p].data() + sizeof(size) + size, true };
+                    lzbench_row_fields(in, row);
+                    if (in.ok) rows[p].push_back(row);
+                    data[p].erase(0, sizeof(size) + size);
+                }
+            }
+        }
+        for (int p=0; p<nprocs; p++)
+            if (pids[p] > 0) while (waitpid(pids[p], NULL, 0) < 0 && errno == EINTR);
+
+        // the processes ran the same tests, so their rows come in the same order
+        size_t nrows = rows[0].size();
+        for (int p=1; p<nprocs; p++) nrows = MIN(nrows, rows[p].size());
+        for (size_t r=0; r<nrows; r++)
+        {
+            // like -T#, a pass over the input takes as long as the slowest process takes for its part
+            string_table_t row = rows[0][r];
+            row.col4_comprsize = row.col5_origsize = 0;
+            for (int p=0; p<nprocs; p++)
+            {
+                string_table_t &part = rows[p][r];
+                row.col4_comprsize += part.col4_comprsize;
+                row.col5_origsize += part.col5_origsize;
+                row.col2_ctime = (MAX(row.col2_ctime, part.col2_ctime));
+                row.col3_dtime = (MAX(row.col3_dtime, part.col3_dtime));
+            }
+            row.col6_filename = params->in_filename;
+            row.file_sizes = file_sizes;
+            format(row.col1_algname, "%s P%d", rows[0][r].col1_algname.c_str(), nprocs);
+            params->results.push_back(row);
+            if (params->merge_parts) continue; // printed by lzbench_merge_parts()
+            if (params->show_speed)
+                print_speed(params, params->results.back());
+            else
+                print_time(params, params->results.back());
+        }
+    }
+
+    munmap(barrier, sizeof(lzbench_process_barrier_t));
+    munmap(shared, insize + PAD_SIZE);
+}
+#endif
+
+
+/*
+ * --parallel: jobs of -e are taken in turn by workers pinned to cores of their own, every worker has
+ * its own copy of params and its own buffers, only the input is shared. Rows are printed in the order of -e
+ * after all jobs are done. Filters keep their setup in a global, so jobs with filters run afterwards one by one.
+ */
+void lzbench_parallel(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+    if (params->jobs.empty()) return;
+
+    std::vector<int> cores;
+#if defined(__linux__)
+    cores = parallel_cores(params);
+    if (cores.empty()) { printf("--parallel: no cores left\n"); return; }
+#endif
+    int workers = (params->parallel > 0) ? params->parallel : cores.empty() ? lzbench_cpus() : MIN((int)cores.size(), lzbench_cpus());
+    if (!cores.empty()) workers = MIN(workers, (int)cores.size());
+    workers = MAX(MIN(workers, (int)params->jobs.size()), 1);
+
+    std::vector<std::vector<string_table_t> > rows(params->jobs.size());
+    std::vector<lzbench_params_t> copies(workers, *params);
+    std::vector<std::thread> threads;
+    std::atomic<size_t> next(0);
+    std::mutex alloc_mutex; // maps of alloc_and_touch()
+
+    LZBENCH_PRINT(2, "--parallel: %d jobs on %d workers\n", (int)params->jobs.size(), workers);
+    for (int w=0; w<workers; w++)
+        threads.push_back(std::thread([&, w]() {
+            lzbench_params_t *p = &copies[w];
+            uint8_t *wcompbuf = compbuf, *wdecomp = decomp;
+#if defined(__linux__)
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(cores[w], &mask);
+            if (sched_setaffinity(0, sizeof(mask), &mask) != 0)
+                LZBENCH_PRINT(5, "sched_setaffinity failed for worker %d\n", w);
+#endif
+            p->verbose = MIN(p->verbose, 1); // progress lines of workers would overwrite each other
+            p->merge_parts = 1; // rows are printed in the order of -e after all workers are done
+            if (w > 0)
+            {
+                // allocated after pinning, so pages are local to the core of the worker
+                std::lock_guard<std::mutex> lock(alloc_mutex);
+                wcompbuf = (uint8_t*)alloc_untouched(comprsize);
+                wdecomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+                if (!wcompbuf || !wdecomp) { printf("Not enough memory for --parallel worker %d\n", w); return; }
+            }
+            for (size_t k; (k = next++) < p->jobs.size(); )
+            {
+                if (!p->job_filters[k].empty()) continue;
+                const compressor_desc_t* desc = codec_desc(p->jobs[k].first);
+                p->results.clear();
+                lzbench_set_options(p, desc, p->job_options[k]);
+                lzbench_test_threads(p, file_sizes, desc, p->jobs[k].second, inbuf, insize, wcompbuf, comprsize, wdecomp, rate, p->jobs[k].second);
+                lzbench_set_options(p, desc, "");
+                rows[k] = p->results;
+            }
+            if (w > 0)
+            {
+                std::lock_guard<std::mutex> lock(alloc_mutex);
+                if (wcompbuf) free_touched(wcompbuf);
+                if (wdecomp) free_touched(wdecomp);
+            }
+        }));
+    for (int w=0; w<workers; w++)
+        threads[w].join();
+
+    int merge_parts = params->merge_parts;
+    params->merge_parts = 1;
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        if (params->job_filters[k].empty()) continue;
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        size_t first = params->results.size();
+        lzbench_set_options(params, desc, params->job_options[k]);
+        params->filters = params->job_filters[k];
+        lzbench_test_threads(params, file_sizes, desc, params->jobs[k].second, inbuf, insize, compbuf, comprsize, decomp, rate, params->jobs[k].second);
+        lzbench_set_options(params, desc, "");
+        params->filters.clear();
+        rows[k].assign(params->results.begin() + first, params->results.end());
+        params->results.erase(params->results.begin() + first, params->results.end());
+    }
+    params->merge_parts = merge_parts;
+
+    for (size_t k=0; k<rows.size(); k++)
+        for (size_t r=0; r<rows[k].size(); r++)
+        {
+            params->results.push_back(rows[k][r]);
+            if (params->merge_parts) continue; // printed by lzbench_merge_parts()
+            if (params->show_speed)
+                print_speed(params, params->results.back());
+            else
+                print_time(params, params->results.back());
+        }
+}
+
+
+/*
+ * Run all compressors one after another or with --interleave in --rounds=# short slices of the
+ * minimal time and iterations, every round runs each codec once, so no codec gets a cold or a hot CPU only
+ */
+void lzbench_run_tests(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    if ((params->dedup_size || params->long_range_block) && !params->dedup_sweep)
+    {
+        // dedup or the long-range pre-pass of every file or part once, the tests get its unique chunks or its residual as one file
+        uint8_t *unique = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+        if (!unique) { printf("Not enough memory, please use -m option!\n"); return; }
+        size_t unique_size = params->dedup_size ? lzbench_dedup(params, inbuf, insize, unique, rate) : lzbench_long_range(params, inbuf, insize, unique, rate);
+        std::vector<size_t> unique_sizes(1, unique_size);
+        if (params->dedup_size) print_dedup(params); else print_long_range(params);
+        if (params->dedup_size && params->long_range_block) fprintf(stderr, "warning: --long-range is not used with --dedup\n");
+        params->dedup_sweep = 1;
+        lzbench_run_tests(params, unique_sizes, namesWithParams, unique, unique_size, compbuf, comprsize, decomp, rate);
+        params->dedup_sweep = 0;
+        free_touched(unique);
+        return;
+    }
+    if (params->results_cache) params->input_hash = cache_hash(inbuf, insize);
+    if (params->per_core_type && !params->core_sweep)
+    {
+        // the loaded input is reused for the CPUs of every core type
+        params->core_sweep = 1;
+        for (size_t k=0; k<core_types.size(); k++)
+        {
+            core_type_pin(params, k);
+            lzbench_run_tests(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        }
+        core_type_pin(params, -1);
+        params->core_sweep = 0;
+        return;
+    }
+    if (!params->llc_ways.empty() && !params->llc_sweep)
+    {
+        // the loaded input is reused for every slice of the L3 cache of --llc-ways
+        params->llc_sweep = 1;
+        for (size_t k=0; k<params->llc_ways.size(); k++)
+            if (resctrl_set(params->llc_ways[k]))
+                lzbench_run_tests(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        resctrl_set(0);
+        params->llc_sweep = 0;
+        return;
+    }
+    if (!params->buf_offsets.empty() && !params->offset_sweep)
+    {
+        // input, compressed and decompressed data start # bytes past a page boundary, buffers of the loaded input are page-aligned
+        size_t slack = *std::max_element(params->buf_offsets.begin(), params->buf_offsets.end());
+        uint8_t *oinbuf = (uint8_t*)alloc_and_touch(insize + slack + PAD_SIZE, false);
+        uint8_t *ocompbuf = (uint8_t*)alloc_untouched(comprsize + slack);
+        uint8_t *odecomp = (uint8_t*)alloc_and_touch(insize + slack + PAD_SIZE, true);
+        if (!oinbuf || !ocompbuf || !odecomp) { printf("Not enough memory, please use -m option!\n"); free_touched(oinbuf); free_touched(ocompbuf); free_touched(odecomp); return; }
+        params->offset_sweep = 1;
+        for (size_t k=0; k<params->buf_offsets.size(); k++)
+        {
+            size_t off = params->buf_offsets[k];
+            params->buf_offset = off;
+            memcpy(oinbuf + off, inbuf, insize);
+            lzbench_run_tests(params, file_sizes, namesWithParams, oinbuf + off, insize, ocompbuf + off, comprsize, odecomp + off, rate);
+        }
+        params->buf_offset = 0;
+        params->offset_sweep = 0;
+        free_touched(oinbuf);
+        free_touched(ocompbuf);
+        free_touched(odecomp);
+        return;
+    }
+    if (params->block_sizes.size() > 1 && !params->block_sweep)
+    {
+        // the loaded input is reused for every chunk size of -b#,#,...
+        params->block_sweep = 1;
+        for (size_t b=0; b<params->block_sizes.size(); b++)
+        {
+            params->chunk_size = params->block_sizes[b];
+            lzbench_run_tests(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        }
+        params->chunk_size = params->block_sizes[0];
+        params->block_sweep = 0;
+        return;
+    }
+#ifndef BENCH_REMOVE_ZSTD
+    if (params->adapt_mbps > 0)
+    {
+        lzbench_adapt(params, inbuf, insize, compbuf, comprsize, rate);
+        return;
+    }
+    if (params->tune_level)
+    {
+        lzbench_tune(params, file_sizes, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+#endif
+    if (params->mix)
+    {
+        lzbench_mix(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (params->match_finders)
+    {
+        lzbench_match_finders(params, inbuf, insize, rate);
+        return;
+    }
+    if (params->soak_hours > 0)
+    {
+        lzbench_soak(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (params->interop)
+    {
+        lzbench_interop(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (!params->stream_counts.empty())
+    {
+        lzbench_streams(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (!params->msg_batches.empty())
+    {
+        lzbench_msg_batch(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (!params->ingest_rates.empty())
+    {
+        lzbench_ingest(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (params->recommend)
+    {
+        lzbench_recommend(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+#if defined(__linux__)
+    if (params->cold_start)
+    {
+        lzbench_cold_start(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+#endif
+#if !defined(_WIN32)
+    if (params->processes > 1)
+    {
+        lzbench_processes(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (params->isolate)
+    {
+        lzbench_isolate(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+#endif
+    if (params->parallel)
+    {
+        lzbench_parallel(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+    if (!params->interleave)
+    {
+        lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+        return;
+    }
+
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, inbuf, insize, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
+
+    uint32_t cmintime = params->cmintime, dmintime = params->dmintime, c_iters = params->c_iters, d_iters = params->d_iters;
+    float ci_target = params->ci_target;
+    int merge_parts = params->merge_parts;
+    size_t first = params->results.size();
+    int rounds = MAX(params->rounds, 1);
+    std::vector<size_t> order(params->jobs.size());
+    std::mt19937 rng((uint32_t)time(NULL));
+
+    std::map<std::string, size_t> job_index; // rows in the order of -e, keyed by the names print_stats() gave them
+    std::iota(order.begin(), order.end(), 0);
+    params->cmintime = (params->cmintime + rounds - 1) / rounds;
+    params->dmintime = (params->dmintime + rounds - 1) / rounds;
+    params->c_iters = (params->c_iters + rounds - 1) / rounds;
+    params->d_iters = (params->d_iters + rounds - 1) / rounds;
+    params->ci_target = 0;
+    params->merge_parts = 1;
+    for (int r=0; r<rounds; r++)
+    {
+        if (params->interleave == 2) std::shuffle(order.begin(), order.end(), rng);
+        LZBENCH_PRINT(5, "*** round %d of %d\n", r+1, rounds);
+        for (size_t k=0; k<order.size(); k++)
+        {
+            const compressor_desc_t* desc = codec_desc(params->jobs[order[k]].first);
+            int level = params->jobs[order[k]].second;
+            lzbench_set_options(params, desc, params->job_options[order[k]]);
+            params->filters = params->job_filters[order[k]];
+            size_t rows = params->results.size();
+            lzbench_test_threads(params, file_sizes, desc, level, inbuf, insize, compbuf, comprsize, decomp, rate, level);
+            for (size_t i=rows; i<params->results.size(); i++)
+                if (!job_index.count(params->results[i].col1_algname)) job_index[params->results[i].col1_algname] = order[k];
+            lzbench_set_options(params, desc, "");
+            params->filters.clear();
+        }
+    }
+    params->cmintime = cmintime;
+    params->dmintime = dmintime;
+    params->c_iters = c_iters;
+    params->d_iters = d_iters;
+    params->ci_target = ci_target;
+    params->merge_parts = merge_parts;
+
+    std::stable_sort(params->results.begin() + first, params->results.end(), [&](const string_table_t &a, const string_table_t &b) {
+        return job_index[a.col1_algname] < job_index[b.col1_algname];
+    });
+    lzbench_merge_rounds(params, first, !params->merge_parts);
+}
+
+
+/* map a file followed by PAD_SIZE of zeroed memory, codecs may read a bit past the end of the input */
+uint8_t* lzbench_mmap_file(lzbench_params_t *params, const char* filename, size_t size, size_t *mapsize)
+{
+#if !defined(_WIN32)
+    size_t page = sysconf(_SC_PAGESIZE);
+    int fd;
+    uint8_t* map;
+
+    *mapsize = ((size + page - 1) & ~(page - 1)) + ((PAD_SIZE + page - 1) & ~(page - 1));
+    map = (uint8_t*)mmap(NULL, *mapsize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) { perror("mmap"); return NULL; }
+    if (size == 0) return map;
+
+    if ((fd = open(filename, O_RDONLY)) < 0) { perror(filename); munmap(map, *mapsize); return NULL; }
+    int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+    if (params->mmap_mode == MMAP_POPULATE) flags |= MAP_POPULATE;
+#endif
+    if (mmap(map, size, PROT_READ, flags, fd, 0) == MAP_FAILED) { perror(filename); close(fd); munmap(map, *mapsize); return NULL; }
+    close(fd);
+    if (params->mmap_mode == MMAP_WILLNEED) madvise(map, size, MADV_WILLNEED);
+    if (params->readahead) madvise(map, size, params->readahead == READAHEAD_SEQUENTIAL ? MADV_SEQUENTIAL : params->readahead == READAHEAD_RANDOM ? MADV_RANDOM : MADV_NORMAL);
+    return map;
+#else
+    fprintf(stderr, "warning: --mmap is not supported on this platform (%s)\n", filename);
+    return NULL;
+#endif
+}
+
+
+void lzbench_munmap_file(uint8_t* map, size_t mapsize)
+{
+#if !defined(_WIN32)
+    if (map) munmap(map, mapsize);
+#endif
+}
+
+
+/* read the next part of a file with fread() or copy it from the mapping, with --mmap-direct the mapping is used in place */
+size_t lzbench_read_input(lzbench_params_t *params, FILE* in, uint8_t* map, size_t filesize, size_t &pos, uint8_t* &buf, size_t size)
+{
+    uint64_t timeline_read = timeline_now();
+    if (!map)
+    {
+        size = fread(buf, 1, size, in);
+        timeline_end("read", "io", timeline_read, -1, size, false);
+        return size;
+    }
+
+    size = MIN(size, filesize - pos);
+    if (params->mmap_direct)
+        buf = map + pos;
+    else
+        memcpy(buf, map + pos, size);
+    pos += size;
+    timeline_end(params->mmap_direct ? "map" : "read", "io", timeline_read, -1, size, false);
+    return size;
+}
+
+
+/*
+ * Files of -j are checked and read by a pool of --load-threads. Every file is read to its offset in inbuf
+ * computed from the sizes, so millions of small files are loaded in parallel.
+ */
+void lzbench_stat_files(lzbench_thread_pool &pool, const char** inFileNames, unsigned ifnIdx, std::vector<int64_t> &sizes)
+{
+    std::atomic<unsigned> next(0);
+
+    sizes.assign(ifnIdx, -1);
+    pool.run([&](int t) {
+        for (unsigned i; (i = next++) < ifnIdx; )
+        {
+            struct stat st;
+            if (stat(inFileNames[i], &st) != 0)
+                perror(inFileNames[i]);
+            else if (S_ISDIR(st.st_mode))
+                fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+            else
+                sizes[i] = st.st_size;
+        }
+    });
+}
+
+
+/* sizes[i] becomes the number of bytes read at offsets[i] or -1 when the file could not be read */
+void lzbench_load_files(lzbench_params_t* params, lzbench_thread_pool &pool, const char** inFileNames, unsigned ifnIdx, std::vector<int64_t> &sizes, std::vector<size_t> &offsets, uint8_t *inbuf)
+{
+    std::atomic<unsigned> next(0);
+
+    pool.run([&](int t) {
+        for (unsigned i; (i = next++) < ifnIdx; )
+        {
+            if (sizes[i] < 0) continue;
+
+            FILE* in = fopen(inFileNames[i], "rb");
+            if (!in) { perror(inFileNames[i]); sizes[i] = -1; continue; }
+
+            uint8_t *map = NULL, *dst = inbuf + offsets[i];
+            size_t mapsize = 0, mappos = 0;
+            if (params->mmap_mode != MMAP_NONE && !(map = lzbench_mmap_file(params, inFileNames[i], sizes[i], &mapsize))) {
+                fclose(in);
+                sizes[i] = -1;
+                continue;
+            }
+            sizes[i] = lzbench_read_input(params, in, map, sizes[i], mappos, dst, sizes[i]);
+            lzbench_munmap_file(map, mapsize);
+            fclose(in);
+        }
+    });
+}
+
+
+/*
+ * --archive: the regular files of tar (ustar, GNU and pax) and zip archives are files of -j. An archive is read
+ * whole, a .gz or .zst one is decompressed first, and its members are copied to inbuf without extracting them.
+ */
+struct lzbench_member_t
+{
+    const uint8_t* data; // in the archive or inflated
+    size_t size;
+    std::string name; // "archive:member"
+    uint8_t* inflated; // malloc() of a deflated member of zip
+};
+
+struct lzbench_archive_t
+{
+    uint8_t* data; // malloc() of the archive, decompressed
+    size_t size;
+    std::vector<lzbench_member_t> members;
+};
+
+static uint16_t read_le16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint64_t read_le64(const uint8_t* p)
+{
+    return read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
+
+/* octal field of a tar header or base-256 of GNU tar when the high bit is set */
+static uint64_t tar_number(const uint8_t* field, size_t len)
+{
+    uint64_t value = 0;
+    size_t i = 0;
+    if (field[0] & 0x80)
+    {
+        for (value = field[0] & 0x3f, i = 1; i < len; i++) value = (value << 8) | field[i];
+        return value;
+    }
+    while (i < len && field[i] == ' ') i++;
+    for (; i < len && field[i] >= '0' && field[i] <= '7'; i++) value = (value << 3) | (field[i] - '0');
+    return value;
+}
+
+/* the checksum of a header counts its own field as spaces, a block of zeros that ends the archive does not match */
+static bool tar_header(const uint8_t* h)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < 512; i++) sum += (i >= 148 && i < 156) ? ' ' : h[i];
+    return sum == tar_number(h + 148, 8);
+}
+
+static void tar_members(lzbench_archive_t &a, const char* filename)
+{
+    std::string long_name;
+    uint64_t pax_size = UINT64_MAX;
+    size_t pos = 0;
+
+    while (pos + 512 <= a.size && tar_header(a.data + pos))
+    {
+        const uint8_t* h = a.data + pos;
+        char type = h[156];
+        bool extension = type == 'L' || type == 'K' || type == 'x' || type == 'g';
+        uint64_t size = (!extension && pax_size != UINT64_MAX) ? pax_size : tar_number(h + 124, 12);
+        pos += 512;
+        if (size > a.size - pos) {
+            fprintf(stderr, "warning: %s is truncated\n", filename);
+            size = a.size - pos;
+        }
+
+        const char* data = (const char*)a.data + pos;
+        if (type == 'L') // GNU long name of the next header
+            long_name.assign(data, strnlen(data, size));
+        else if (type == 'x') // pax records "length key=value\n"
+        {
+            for (size_t r = 0; r < size; )
+            {
+                const char* rec = data + r;
+                size_t len = 0;
+                for (size_t i = 0; i < size - r && rec[i] >= '0' && rec[i] <= '9' && len <= size; i++) len = len * 10 + (rec[i] - '0');
+                if (!len || len > size - r) break;
+                const char* key = (const char*)memchr(rec, ' ', len);
+                const char* value = key ? (const char*)memchr(key, '=', rec + len - key) : NULL;
+                if (!value || value >= rec + len - 1) break; // the value is followed by '\n' within the record
+                if (!strncmp(key + 1, "path=", 5)) long_name.assign(value + 1, rec + len - 1 - (value + 1));
+                if (!strncmp(key + 1, "size=", 5))
+                {
+                    pax_size = 0;
+                    for (const char* v = value + 1; v < rec + len - 1 && *v >= '0' && *v <= '9'; v++) pax_size = pax_size * 10 + (*v - '0');
+                }
+                r += len;
+            }
+        }
+        else if (type == '0' || type == '\0' || type == '7')
+        {
+            std::string name = long_name;
+            if (name.empty())
+            {
+                name.assign((const char*)h, strnlen((const char*)h, 100));
+                if (!memcmp(h + 257, "ustar\0", 6) && h[345]) // POSIX prefix, GNU tar keeps other fields there
+                    name = std::string((const char*)h + 345, strnlen((const char*)h + 345, 155)) + "/" + name;
+            }
+            lzbench_member_t m = { a.data + pos, (size_t)size, std::string(filename) + ":" + name, NULL };
+            a.members.push_back(m);
+        }
+        if (!extension) { long_name.clear(); pax_size = UINT64_MAX; }
+        pos += (size + 511) & ~(uint64_t)511;
+    }
+}
+
+/* members of the central directory, stored or deflated, with the 64-bit sizes and offsets of zip64 */
+static void zip_members(lzbench_archive_t &a, const char* filename)
+{
+    const uint8_t* d = a.data;
+    size_t n = a.size, eocd = SIZE_MAX;
+
+    for (size_t back = 22; back <= n && back <= 22 + 65535; back++) // the end record is followed only by its comment
+        if (read_le32(d + n - back) == 0x06054b50) { eocd = n - back; break; }
+    if (eocd == SIZE_MAX) { fprintf(stderr, "warning: %s has no central directory of zip\n", filename); return; }
+
+    uint64_t count = read_le16(d + eocd + 10), p = read_le32(d + eocd + 16);
+    if (eocd >= 20 && read_le32(d + eocd - 20) == 0x07064b50) // zip64 locator
+    {
+        uint64_t end64 = read_le64(d + eocd - 12);
+        if (n >= 56 && end64 <= n - 56 && read_le32(d + end64) == 0x06064b50) { count = read_le64(d + end64 + 32); p = read_le64(d + end64 + 48); }
+    }
+
+    for (uint64_t k = 0; k < count; k++)
+    {
+        if (p > n || n - p < 46 || read_le32(d + p) != 0x02014b50) { fprintf(stderr, "warning: %s has a broken central directory\n", filename); break; }
+        unsigned flags = read_le16(d + p + 8), method = read_le16(d + p + 10);
+        size_t nlen = read_le16(d + p + 28), elen = read_le16(d + p + 30), clen = read_le16(d + p + 32);
+        uint64_t csize = read_le32(d + p + 20), usize = read_le32(d + p + 24), local = read_le32(d + p + 42);
+        if (46 + nlen + elen + clen > n - p) break;
+        std::string name((const char*)d + p + 46, nlen);
+        for (size_t e = p + 46 + nlen; e + 4 <= p + 46 + nlen + elen; e += 4 + read_le16(d + e + 2))
+        {
+            size_t f = e + 4, end = MIN(f + read_le16(d + e + 2), p + 46 + nlen + elen);
+            if (read_le16(d + e) != 1) continue; // zip64 extra field: the 64-bit values of the fields set to 0xFFFFFFFF
+            if (usize == 0xFFFFFFFF && f + 8 <= end) usize = read_le64(d + f), f += 8;
+            if (csize == 0xFFFFFFFF && f + 8 <= end) csize = read_le64(d + f), f += 8;
+            if (local == 0xFFFFFFFF && f + 8 <= end) local = read_le64(d + f), f += 8;
+        }
+        p += 46 + nlen + elen + clen;
+        if (!name.empty() && name[name.size() - 1] == '/') continue; // directory
+
+        bool header = local <= n && n - local >= 30;
+        uint64_t start = header ? local + 30 + read_le16(d + local + 26) + read_le16(d + local + 28) : n + 1;
+        if (!header || read_le32(d + local) != 0x04034b50 || start > n || csize > n - start) {
+            fprintf(stderr, "warning: %s:%s is truncated\n", filename, name.c_str());
+            continue;
+        }
+        if ((flags & 1) || (method != 0 && method != 8)) {
+            fprintf(stderr, "warning: %s:%s is %s, it was skipped\n", filename, name.c_str(), (flags & 1) ? "encrypted" : "not stored or deflated");
+            continue;
+        }
+
+        lzbench_member_t m = { d + start, (size_t)csize, std::string(filename) + ":" + name, NULL };
+        if (method == 8)
+        {
+#ifndef BENCH_REMOVE_ZLIB
+            m.inflated = (uint8_t*)lzbench_zlib_unwrap((const char*)d + start, csize, -15, &m.size);
+#endif
+            if (!m.inflated) { fprintf(stderr, "warning: %s could not be inflated\n", m.name.c_str()); continue; }
+            if (m.size != usize) fprintf(stderr, "warning: %s has %llu bytes instead of %llu\n", m.name.c_str(), (unsigned long long)m.size, (unsigned long long)usize);
+            m.data = m.inflated;
+        }
+        a.members.push_back(m);
+    }
+}
+
+void lzbench_free_archives(std::vector<lzbench_archive_t> &archives)
+{
+    for (size_t i = 0; i < archives.size(); i++)
+    {
+        for (size_t j = 0; j < archives[i].members.size(); j++) free(archives[i].members[j].inflated);
+        free(archives[i].data);
+    }
+    archives.clear();
+}
+
+/* reads an archive, false when it could not be read, a file that is not an archive is a single member */
+bool lzbench_read_archive(const char* filename, lzbench_archive_t &a)
+{
+    struct stat st;
+    FILE* in = fopen(filename, "rb");
+    a.data = NULL;
+    if (!in || stat(filename, &st) != 0 || !(a.data = (uint8_t*)malloc(st.st_size + 1))) {
+        perror(filename);
+        if (in) fclose(in);
+        return false;
+    }
+    a.size = fread(a.data, 1, st.st_size, in);
+    fclose(in);
+
+    char* plain = NULL;
+    size_t plain_size = 0;
+#ifndef BENCH_REMOVE_ZLIB
+    if (a.size >= 18 && a.data[0] == 0x1f && a.data[1] == 0x8b && !(plain = lzbench_zlib_unwrap((const char*)a.data, a.size, 0, &plain_size)))
+        fprintf(stderr, "warning: %s is not a valid gzip file, it is read as it is\n", filename);
+#endif
+#ifndef BENCH_REMOVE_ZSTD
+    if (a.size >= 4 && read_le32(a.data) == 0xFD2FB528 && !(plain = lzbench_zstd_unwrap((const char*)a.data, a.size, &plain_size)))
+        fprintf(stderr, "warning: %s is not a valid zstd file, it is read as it is\n", filename);
+#endif
+    if (plain)
+    {
+        free(a.data);
+        a.data = (uint8_t*)plain;
+        a.size = plain_size;
+    }
+
+    if (a.size >= 512 && tar_header(a.data))
+        tar_members(a, filename);
+    else if (a.size >= 22 && (read_le32(a.data) == 0x04034b50 || read_le32(a.data) == 0x06054b50))
+        zip_members(a, filename);
+    else
+    {
+        lzbench_member_t m = { a.data, a.size, filename, NULL };
+        a.members.push_back(m);
+    }
+    return true;
+}
+
+
+#define DICT_MIN_SAMPLES 7 // ZDICT trains on 3/4 of the samples, at least 5, and tests on the rest
+
+/*
+ * --dict: every k-th file is copied to the samples so that they are at most 100 times the dictionary,
+ * the time of ZDICT_trainFromBuffer() is reported apart from the benchmarks.
+ */
+void lzbench_train_dict(lzbench_params_t* params, std::vector<size_t> &file_sizes, uint8_t *inbuf, size_t totalsize, bench_rate_t rate)
+{
+    bench_timer_t start_ticks, end_ticks;
+    std::vector<char> samples;
+    std::vector<size_t> sample_sizes;
+    size_t limit = 100 * params->dict_size, step = (totalsize + limit - 1) / limit, pos = 0;
+
+    if (!lzbench_zstd_train_dict) { fprintf(stderr, "warning: --dict needs zstd, it was not built\n"); return; }
+    for (size_t i = 0; i < file_sizes.size(); pos += file_sizes[i], i++)
+    {
+        if (i % step || file_sizes[i] == 0) continue;
+        samples.insert(samples.end(), inbuf + pos, inbuf + pos + file_sizes[i]);
+        sample_sizes.push_back(file_sizes[i]);
+    }
+
+    if (sample_sizes.size() < DICT_MIN_SAMPLES)
+    {
+        fprintf(stderr, "warning: too few samples for --dict: %d files, at least %d are needed\n", (int)sample_sizes.size(), DICT_MIN_SAMPLES);
+        params->dict.clear();
+        return;
+    }
+    params->dict.resize(params->dict_size);
+    GetTime(start_ticks);
+    size_t size = sample_sizes.empty() ? 0 : lzbench_zstd_train_dict(params->dict.data(), params->dict.size(), samples.data(), sample_sizes.data(), sample_sizes.size());
+    GetTime(end_ticks);
+    params->dict.resize(size);
+    params->dict_ms = GetDiffTime(rate, start_ticks, end_ticks) / 1000000.0;
+    params->dict_samples = sample_sizes.size();
+    if (size && params->textformat != JSON)
+        LZBENCH_PRINT(2, "Trained a dictionary of %llu bytes from %d files (%llu KB) in %.3f s\n", (unsigned long long)size, params->dict_samples, (unsigned long long)(samples.size() >> 10), params->dict_ms / 1000);
+}
+
+
+/* the memcpy row and all codecs of -e on the files of a buffer of -j or --sample */
+void lzbench_bench_buffer(lzbench_params_t* params, std::vector<size_t> &file_sizes, char* encoder_list, uint8_t *inbuf, size_t totalsize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+{
+    lzbench_params_t params_memcpy = *params; // not memcpy(), it would share the vectors of params
+
+    if (params->bandwidth) lzbench_bandwidth(params, inbuf, totalsize, decomp, rate);
+    if (params->dict_size) lzbench_train_dict(params, file_sizes, inbuf, totalsize, rate);
+
+    print_header(params);
+    params_memcpy.cmintime = params_memcpy.dmintime = 0;
+    params_memcpy.c_iters = params_memcpy.d_iters = 0;
+    params_memcpy.cloop_time = params_memcpy.dloop_time = DEFAULT_LOOP_TIME;
+    lzbench_test(&params_memcpy, file_sizes, &comp_desc[0], 0, inbuf, totalsize, compbuf, comprsize, decomp, rate, 0);
+    if (params->bandwidth) print_bandwidth(params);
+
+    lzbench_run_tests(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, totalsize, compbuf, comprsize, decomp, rate);
+}
+
+
+/* -J: ratio and speed of every codec on files compressed independently and as one stream of solid blocks */
+void print_solid_summary(lzbench_params_t *params, size_t first, const std::string &files, const std::string &solid)
+{
+    std::vector<string_table_t> &res = params->results;
+
+    printf("\nSolid blocks against independent files (ratio, compression and decompression speed in MB/s):\n");
+    if (params->textformat == CSV)
+        printf("Compressor name,Ratio of files,Ratio of solid blocks,Solid gain,Compression speed of files,Compression speed of solid blocks,Decompression speed of files,Decompression speed of solid blocks\n");
+    else
+        printf("%-23s %8s %8s %6s %9s %9s %9s %9s\n", "Compressor name", "Files", "Solid", "Gain", "C files", "C solid", "D files", "D solid");
+
+    for (size_t i=first; i<res.size(); i++)
+    {
+        if (res[i].col6_filename != files) continue;
+        size_t j = first;
+        while (j < res.size() && (res[j].col6_filename != solid || res[j].col1_algname != res[i].col1_algname || res[j].threads != res[i].threads)) j++;
+        if (j == res.size() || !res[i].col5_origsize || !res[j].col4_comprsize) continue;
+
+        float ratio[2], cspeed[2], dspeed[2];
+        for (int k=0; k<2; k++)
+        {
+            string_table_t &row = res[k ? j : i];
+            ratio[k] = row.col4_comprsize * 100.0 / row.col5_origsize;
+            cspeed[k] = row.col2_ctime ? row.col5_origsize * 1000.0 / row.col2_ctime : 0;
+            dspeed[k] = row.col3_dtime ? row.col5_origsize * 1000.0 / row.col3_dtime : 0;
+        }
+        float gain = (float)res[i].col4_comprsize / res[j].col4_comprsize;
+        if (params->textformat == CSV)
+            printf("%s,%.2f,%.2f,%.3f,%.2f,%.2f,%.2f,%.2f\n", res[i].col1_algname.c_str(), ratio[0], ratio[1], gain, cspeed[0], cspeed[1], dspeed[0], dspeed[1]);
+        else
+            printf("%-23s %7.2f%% %7.2f%% %5.2fx %9.1f %9.1f %9.1f %9.1f\n", res[i].col1_algname.c_str(), ratio[0], ratio[1], gain, cspeed[0], cspeed[1], dspeed[0], dspeed[1]);
+    }
+}
+
+
+/* -J1: extension of a file for sorting, "" without one */
+std::string file_extension(const char* filename)
+{
+    const char* base = strrchr(filename, '/');
+    const char* ext;
+    base = base ? base + 1 : filename;
+    ext = strrchr(base, '.');
+    return (ext && ext != base) ? ext + 1 : "";
+}
+
+
+int lzbench_join(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
+{
+    bench_rate_t rate;
+    bench_timer_t load_start, load_end;
+    size_t comprsize, inpos, totalsize;
+    uint8_t *inbuf, *compbuf, *decomp;
+    std::vector<size_t> file_sizes, offsets(ifnIdx);
+    std::vector<int64_t> sizes;
+    std::string text, solid_text;
+    std::vector<const char*> names(inFileNames, inFileNames + ifnIdx);
+    std::vector<lzbench_archive_t> archives;
+    std::vector<const lzbench_member_t*> members;
+    lzbench_thread_pool pool(params->load_threads);
+
+    if (params->solid == 2) // files of a type next to each other in the solid blocks
+        std::stable_sort(names.begin(), names.end(), [](const char* a, const char* b) { return file_extension(a) < file_extension(b); });
+    inFileNames = names.data();
+
+    InitTimer(rate);
+    GetTime(load_start);
+    totalsize = 0;
+    if (params->archive)
+    {
+        std::atomic<unsigned> next(0);
+        archives.resize(ifnIdx);
+        pool.run([&](int t) {
+            for (unsigned i; (i = next++) < ifnIdx; )
+                lzbench_read_archive(inFileNames[i], archives[i]);
+        });
+        for (size_t i = 0; i < archives.size(); i++)
+            for (size_t j = 0; j < archives[i].members.size(); j++)
+            {
+                members.push_back(&archives[i].members[j]);
+                totalsize += archives[i].members[j].size;
+            }
+        if (params->solid == 2)
+            std::stable_sort(members.begin(), members.end(), [](const lzbench_member_t* a, const lzbench_member_t* b) { return file_extension(a->name.c_str()) < file_extension(b->name.c_str()); });
+    }
+    else
+    {
+        lzbench_stat_files(pool, inFileNames, ifnIdx, sizes);
+        for (unsigned i=0; i<ifnIdx; i++)
+        {
+            offsets[i] = totalsize;
+            if (sizes[i] > 0) totalsize += sizes[i];
+        }
+    }
+    if (totalsize == 0) {
+        printf("Could not find input files\n");
+        lzbench_free_archives(archives);
+        return 1;
+    }
+
+    comprsize = GET_COMPRESS_BOUND(totalsize) + (params->max_threads-1)*PAD_SIZE; // every thread has its own bound
+    inbuf = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, false);
+    compbuf = (uint8_t*)alloc_untouched(comprsize);
+    decomp = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, true);
+
+    if (!inbuf || !compbuf || !decomp)
+    {
+        printf("Not enough memory, please use -m option!\n");
+        lzbench_free_archives(archives);
+        return 1;
+    }
+
+    if (params->mmap_direct) {
+        fprintf(stderr, "warning: --mmap-direct is ignored with -j, all files are copied to a single buffer\n");
+        params->mmap_direct = 0;
+    }
+
+    inpos = 0;
+    params->file_names.clear();
+    if (params->archive)
+    {
+        for (size_t i = 0; i < members.size(); i++)
+        {
+            memcpy(inbuf + inpos, members[i]->data, members[i]->size);
+            file_sizes.push_back(members[i]->size);
+            params->file_names.push_back(members[i]->name);
+            inpos += members[i]->size;
+        }
+        lzbench_free_archives(archives);
+    }
+    else
+    {
+        lzbench_load_files(params, pool, inFileNames, ifnIdx, sizes, offsets, inbuf);
+        for (unsigned i=0; i<ifnIdx; i++)
+        {
+            if (sizes[i] < 0) continue;
+            if (offsets[i] != inpos) memmove(inbuf + inpos, inbuf + offsets[i], sizes[i]); // a file was shorter than its stat()
+            file_sizes.push_back(sizes[i]);
+            params->file_names.push_back(inFileNames[i]);
+            inpos += sizes[i];
+        }
+    }
+    GetTime(load_end);
+    params->load_ms = GetDiffTime(rate, load_start, load_end) / 1000000.0;
+    if (params->textformat != JSON && params->archive)
+    {
+        LZBENCH_PRINT(2, "Loaded %d files of %d archives (%llu MB) in %.3f s with %d threads\n", (int)file_sizes.size(), (int)ifnIdx, (unsigned long long)(inpos >> 20), params->load_ms / 1000, params->load_threads);
+    }
+    else if (params->textformat != JSON)
+    {
+        LZBENCH_PRINT(2, "Loaded %d files (%llu MB) in %.3f s with %d threads\n", (int)file_sizes.size(), (unsigned long long)(inpos >> 20), params->load_ms / 1000, params->load_threads);
+    }
+
+    if (file_sizes.size() == 0) 
+        goto _clean;
+
+    format(text, "%d files", file_sizes.size());
+    params->in_filename = text.c_str();
+
+    LZBENCH_PRINT(5, "totalsize=%zu comprsize=%zu inpos=%zu\n", totalsize, comprsize, (size_t)inpos);
+    {
+        size_t first = params->results.size();
+        lzbench_bench_buffer(params, file_sizes, encoder_list, inbuf, inpos, compbuf, comprsize, decomp, rate);
+        if (params->solid)
+        {
+            // the same buffer as a single file, chunks of -b# go over file boundaries
+            std::vector<size_t> solid_sizes(1, inpos);
+            format(solid_text, "%d files solid%s", file_sizes.size(), params->solid == 2 ? " by ext" : "");
+            params->in_filename = solid_text.c_str();
+            lzbench_run_tests(params, solid_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, inpos, compbuf, comprsize, decomp, rate);
+            if (params->textformat != JSON) print_solid_summary(params, first, text, solid_text);
+        }
+    }
+
+_clean:
+    free_touched(inbuf);
+    free_touched(compbuf);
+    free_touched(decomp);
+
+    return 0;
+}
+
+
+/*
+ * --sample=K: K blocks of chunk_size are read from all files, every file gets a share of them proportional to its size.
+ * A file is split into as many strata of whole blocks as its share and a block at a random position of every stratum
+ * is taken, so the sample covers all parts of it. The blocks are benchmarked together as files of a buffer of -j,
+ * the mean ratio of blocks gets a 95% confidence interval and --stats gives one of speeds from the iterations.
+ */
+int lzbench_sample(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
+{
+    bench_rate_t rate;
+    size_t comprsize, totalsize = 0, filessize = 0, block = params->chunk_size;
+    uint8_t *inbuf, *compbuf, *decomp;
+    std::vector<int64_t> sizes;
+    std::vector<size_t> positions(ifnIdx), shares(ifnIdx), order, file_sizes;
+    std::vector<std::vector<uint64_t> > offsets(ifnIdx);
+    std::mt19937 rng(params->sample_seed);
+    std::atomic<unsigned> next(0);
+    std::string text;
+    lzbench_thread_pool pool(params->load_threads);
+    unsigned files = 0, blocks = 0;
+
+    if (block == NO_LIMIT) { fprintf(stderr, "--sample: -b0 has no size of blocks\n"); return 1; }
+    InitTimer(rate);
+    lzbench_stat_files(pool, inFileNames, ifnIdx, sizes);
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        if (sizes[i] <= 0) continue;
+        positions[i] = std::max((size_t)sizes[i] / block, (size_t)1); // a file shorter than a block is a single block
+        filessize += sizes[i];
+        files++;
+    }
+    if (filessize == 0) {
+        printf("Could not find input files\n");
+        return 1;
+    }
+
+    // largest remainder: the integer part of the proportional share first, then one more for the largest fractions
+    std::vector<std::pair<double, unsigned> > fractions;
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        if (sizes[i] <= 0) continue;
+        double share = (double)params->sample_blocks * sizes[i] / filessize;
+        shares[i] = MIN((size_t)share, positions[i]);
+        blocks += shares[i];
+        fractions.push_back(std::make_pair(share - shares[i], i));
+    }
+    std::stable_sort(fractions.begin(), fractions.end(), [](const std::pair<double, unsigned> &a, const std::pair<double, unsigned> &b) { return a.first > b.first; });
+    for (bool added = true; blocks < params->sample_blocks && added; )
+    {
+        added = false;
+        for (size_t k = 0; k < fractions.size() && blocks < params->sample_blocks; k++)
+        {
+            unsigned i = fractions[k].second;
+            if (shares[i] < positions[i]) shares[i]++, blocks++, added = true;
+        }
+    }
+
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        for (size_t j = 0; j < shares[i]; j++)
+        {
+            size_t lo = j * positions[i] / shares[i], hi = (j + 1) * positions[i] / shares[i];
+            size_t size = MIN(block, (size_t)sizes[i]);
+            offsets[i].push_back((uint64_t)(lo + rng() % (hi - lo)) * block);
+            totalsize += size;
+        }
+    }
+
+    comprsize = GET_COMPRESS_BOUND(totalsize) + (params->max_threads-1)*PAD_SIZE; // every thread has its own bound
+    inbuf = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, false);
+    compbuf = (uint8_t*)alloc_untouched(comprsize);
+    decomp = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, true);
+
+    if (!inbuf || !compbuf || !decomp)
+    {
+        printf("Not enough memory, please use a smaller --sample or -b#!\n");
+        return 1;
+    }
+
+    if (params->mmap_direct) {
+        fprintf(stderr, "warning: --mmap-direct is ignored with --sample, all blocks are copied to a single buffer\n");
+        params->mmap_direct = 0;
+    }
+
+    // every file is read to its position in inbuf, a block that is read short is dropped from the sample
+    std::vector<size_t> starts(ifnIdx + 1, 0);
+    std::vector<std::vector<size_t> > got(ifnIdx);
+    for (unsigned i=0; i<ifnIdx; i++)
+        starts[i+1] = starts[i] + (shares[i] ? shares[i] * MIN(block, (size_t)sizes[i]) : 0);
+    pool.run([&](int t) {
+        for (unsigned i; (i = next++) < ifnIdx; )
+        {
+            if (!shares[i]) continue;
+
+            FILE* in = fopen(inFileNames[i], "rb");
+            if (!in) { perror(inFileNames[i]); continue; }
+            for (size_t j = 0; j < offsets[i].size(); j++)
+            {
+                uint8_t *dst = inbuf + starts[i] + j * MIN(block, (size_t)sizes[i]);
+                size_t mappos = 0;
+                if (fseeko(in, offsets[i][j], SEEK_SET) != 0) { got[i].push_back(0); continue; }
+                got[i].push_back(lzbench_read_input(params, in, NULL, sizes[i], mappos, dst, MIN(block, (size_t)sizes[i])));
+            }
+            fclose(in);
+        }
+    });
+
+    totalsize = 0;
+    for (unsigned i=0; i<ifnIdx; i++)
+    {
+        for (size_t j = 0; j < got[i].size(); j++)
+        {
+            size_t from = starts[i] + j * MIN(block, (size_t)sizes[i]);
+            if (!got[i][j]) continue;
+            if (from != totalsize) memmove(inbuf + totalsize, inbuf + from, got[i][j]);
+            file_sizes.push_back(got[i][j]);
+            totalsize += got[i][j];
         }
-        while (GetDiffTime(rate, loop_ticks, end_ticks) < params->dloop_time);
+    }
+    params->file_names.clear(); // blocks are not files, no --breakdown
 
-        nanosec = GetDiffTime(rate, loop_ticks, end_ticks);
-        dtime.push_back(nanosec/i);
-        LZBENCH_PRINT(9, "%s dnanosec=%d\n", desc->name, (int)nanosec);
+    if (params->textformat != JSON)
+        LZBENCH_PRINT(2, "Sampled %d blocks of %d KB from %u files (%.2f%% of %llu MB) with seed %u\n", (int)file_sizes.size(), (int)(block >> 10),
+            files, totalsize * 100.0 / filessize, (unsigned long long)(filessize >> 20), params->sample_seed);
 
-        if (insize != decomplen)
+    if (file_sizes.size() == 0)
+        goto _clean;
+
+    format(text, "%d blocks of %u files", (int)file_sizes.size(), files);
+    params->in_filename = text.c_str();
+    lzbench_bench_buffer(params, file_sizes, encoder_list, inbuf, totalsize, compbuf, comprsize, decomp, rate);
+
+_clean:
+    free_touched(inbuf);
+    free_touched(compbuf);
+    free_touched(decomp);
+
+    return 0;
+}
+
+
+/*
+ * Input "-": stdin is read in pieces of chunk_size (at most 64 MB) into a growing buffer until its end
+ * or until limit bytes. With -m# it is not read here, the parts of -m# are windows of stdin instead.
+ */
+uint8_t* lzbench_read_stdin(lzbench_params_t *params, size_t limit, size_t &size)
+{
+    size_t capacity = 0, piece = MIN(params->chunk_size, (size_t)64 << 20);
+    uint8_t *buf = NULL;
+
+    size = 0;
+    while (size < limit)
+    {
+        size_t want = MIN(piece, limit - size), got;
+        if (size + want + PAD_SIZE > capacity)
         {
-            decomp_error = true;
-            LZBENCH_PRINT(5, "ERROR: inlen[%d] != outlen[%d]\n", (int32_t)insize, (int32_t)decomplen);
+            capacity = MAX(2 * capacity, size + want + PAD_SIZE);
+            uint8_t *tmp = (uint8_t*)realloc(buf, capacity);
+            if (!tmp) { free(buf); printf("Not enough memory for stdin, please use -m option!\n"); return NULL; }
+            buf = tmp;
         }
+        size += (got = fread(buf + size, 1, want, stdin));
+        if (got < want) break;
+    }
+    if (ferror(stdin)) perror("stdin");
+    return buf;
+}
 
-        if (memcmp(inbuf, decomp, insize) != 0)
-        {
-            decomp_error = true;
 
-            size_t cmn = common(inbuf, decomp);
-            LZBENCH_PRINT(5, "ERROR in %s: common=%d/%d\n", desc->name, (int32_t)cmn, (int32_t)insize);
+/*
+ * --gen: synthetic inputs of a fixed seed that are the same on every host, only mt19937_64 is used with conversions
+ * of its own because the std distributions differ between standard libraries. lz: literals of # bits of entropy
+ * and matches of exponential length and offset, as many that an ideal LZ reaches the target ratio (like lzdatagen),
+ * text: words of a Zipf-distributed vocabulary in sentences and lines, numeric: blocks of 4096 rows of columns of
+ * 64-bit integers (a row id, timestamps, a random walk, one of 16 categories and random values).
+ */
+enum { GEN_LZ, GEN_TEXT, GEN_NUMERIC };
 
-            if (params->verbose >= 10)
-            {
-                char text[256];
-                snprintf(text, sizeof(text), "%s_failed", desc->name);
-                cmn /= chunk_size;
-                size_t err_size = MIN(insize, (cmn+1)*chunk_size);
-                err_size -= cmn*chunk_size;
-                printf("ERROR: fwrite %d-%d to %s\n", (int32_t)(cmn*chunk_size), (int32_t)(cmn*chunk_size+err_size), text);
-                FILE *f = fopen(text, "wb");
-                if (f) fwrite(inbuf+cmn*chunk_size, 1, err_size, f), fclose(f);
-                exit(1);
-            }
-        }
+#define GEN_MATCH_COST 3.0 // bytes of a match with an entropy coder
 
-        memset(decomp, 0, insize); // clear output buffer
+typedef struct
+{
+    int mode;
+    size_t size;
+    double ratio, entropy, len, off; // lz: target ratio, bits per literal, mean match length and mean offset
+    uint64_t seed;
+} gen_spec_t;
 
-        if (decomp_error) break;
+bool gen_parse(const char* spec, gen_spec_t &gen)
+{
+    std::vector<std::string> terms = split(spec, ',');
 
-        total_nanosec = GetDiffTime(rate, timer_ticks, end_ticks);
-        total_d_iters += i;
-        if ((total_d_iters >= params->d_iters) && (total_nanosec > ((uint64_t)params->dmintime*1000000))) break;
-        LZBENCH_PRINT(2, "%s decompr iter=%d time=%.2fs speed=%.2f MB/s     \r", desc->name, total_d_iters, total_nanosec/1000000000.0, (float)insize*i*1000/nanosec);
+    gen.mode = GEN_LZ;
+    gen.size = 16 << 20;
+    gen.ratio = 3;
+    gen.entropy = 8;
+    gen.len = 16;
+    gen.off = 4096;
+    gen.seed = 1;
+    for (size_t k=0; k<terms.size(); k++)
+    {
+        size_t eq = terms[k].find('=');
+        if (eq == std::string::npos)
+        {
+            if (terms[k] == "lz") gen.mode = GEN_LZ;
+            else if (terms[k] == "text") gen.mode = GEN_TEXT;
+            else if (terms[k] == "numeric") gen.mode = GEN_NUMERIC;
+            else return false;
+            continue;
+        }
+        std::string key = terms[k].substr(0, eq);
+        const char* value = terms[k].c_str() + eq + 1;
+        if (key == "size") gen.size = (size_t)(atof(value) * (1 << 20));
+        else if (key == "ratio") gen.ratio = atof(value);
+        else if (key == "entropy") gen.entropy = atof(value);
+        else if (key == "len") gen.len = atof(value);
+        else if (key == "off") gen.off = atof(value);
+        else if (key == "seed") gen.seed = strtoull(value, NULL, 10);
+        else return false;
     }
-    while (true);
+    return gen.size > 0 && gen.ratio >= 1 && gen.entropy > 0 && gen.entropy <= 8 && gen.len >= 4 && gen.off >= 1;
+}
 
- //   printf("total_c_iters=%d total_d_iters=%d            \n", total_c_iters, total_d_iters);
-    print_stats(params, desc, level, ctime, dtime, insize, complen, decomp_error);
 
-done:
-    if (desc->deinit) desc->deinit(workmem);
+/* [0, 1) of the top 53 bits */
+static inline double gen_uniform(std::mt19937_64 &rng)
+{
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
 }
 
 
-void lzbench_test_with_params(lzbench_params_t *params, std::vector<size_t> &file_sizes, const char *namesWithParams, uint8_t *inbuf, size_t insize, uint8_t *compbuf, size_t comprsize, uint8_t *decomp, bench_rate_t rate)
+static inline size_t gen_exponential(std::mt19937_64 &rng, double mean)
 {
-    std::vector<std::string> cnames, cparams;
-
-    if (!namesWithParams) return;
+    return (size_t)(-log(1.0 - gen_uniform(rng)) * mean);
+}
 
-    LZBENCH_PRINT(5, "*** lzbench_test_with_params insize=%d comprsize=%d\n", (int)insize, (int)comprsize);
 
-    cnames = split(namesWithParams, '/');
+uint8_t* lzbench_generate(const char* spec, size_t &size)
+{
+    gen_spec_t gen;
+    if (!gen_parse(spec, gen)) { fprintf(stderr, "wrong --gen: %s\n", spec); return NULL; }
 
-    for (int k=0; k<cnames.size(); k++)
-        LZBENCH_PRINT(5, "cnames[%d] = %s\n", k, cnames[k].c_str());
+    uint8_t *buf = (uint8_t*)alloc_and_touch(gen.size + PAD_SIZE, false);
+    if (!buf) { printf("Not enough memory for --gen=%s!\n", spec); return NULL; }
 
-    for (int k=0; k<cnames.size(); k++)
+    std::mt19937_64 rng(gen.seed);
+    size_t pos = 0;
+    size = gen.size;
+    switch (gen.mode)
     {
-        for (int i=0; i<LZBENCH_ALIASES_COUNT; i++)
+        case GEN_LZ:
         {
-            if (istrcmp(cnames[k].c_str(), alias_desc[i].name)==0)
+            // literals cost entropy/8 of their size and a match about GEN_MATCH_COST bytes, the share of bytes in matches follows
+            double alphabet = pow(2.0, gen.entropy), lit_cost = gen.entropy / 8, match_cost = GEN_MATCH_COST / gen.len;
+            double matched = lit_cost > match_cost ? (lit_cost - 1 / gen.ratio) / (lit_cost - match_cost) : 0;
+            matched = MIN(MAX(matched, 0.0), 0.999);
+            if (1 / gen.ratio < match_cost) fprintf(stderr, "warning: --gen=%s: ratio %g needs a mean match length over %g\n", spec, gen.ratio, GEN_MATCH_COST * gen.ratio);
+            double lit_mean = matched > 0 ? gen.len * (1 - matched) / matched : (double)size;
+            while (pos < size)
             {
-                lzbench_test_with_params(params, file_sizes, alias_desc[i].params, inbuf, insize, compbuf, comprsize, decomp, rate);
-                goto next_k;
+                for (size_t lit = gen_exponential(rng, lit_mean) + (pos == 0); lit > 0 && pos < size; lit--)
+                    buf[pos++] = (uint8_t)(gen_uniform(rng) * alphabet);
+                if (matched == 0 || pos == 0) continue;
+                size_t len = 4 + gen_exponential(rng, gen.len - 4), off = 1 + gen_exponential(rng, gen.off - 1);
+                if (off > pos) off = pos;
+                for (; len > 0 && pos < size; len--, pos++) buf[pos] = buf[pos - off];
             }
+            break;
         }
-
-        LZBENCH_PRINT(5, "params = %s\n", cnames[k].c_str());
-        cparams = split(cnames[k].c_str(), ',');
-        if (cparams.size() >= 1)
+        case GEN_TEXT:
         {
-            int j=1;
-            do {
-                bool found = false;
-                for (int i=1; i<LZBENCH_COMPRESSOR_COUNT; i++)
+            std::vector<std::string> words(8192);
+            std::vector<double> cdf(words.size());
+            double sum = 0;
+            for (size_t w = 0; w < words.size(); w++)
+            {
+                size_t n = 1 + gen_exponential(rng, 4);
+                for (n = MIN(n, (size_t)12); n > 0; n--) words[w] += (char)('a' + rng() % 26);
+                cdf[w] = (sum += 1.0 / (w + 1));
+            }
+            size_t line = 0, sentence = 0;
+            while (pos < size)
+            {
+                size_t w = std::lower_bound(cdf.begin(), cdf.end(), gen_uniform(rng) * sum) - cdf.begin();
+                std::string word = words[MIN(w, words.size() - 1)];
+                if (sentence == 0) word[0] = toupper(word[0]);
+                if (++sentence >= 5 + rng() % 16) word += '.', sentence = 0;
+                else if (rng() % 12 == 0) word += ',';
+                line += word.size() + 1;
+                word += line > 72 ? '\n' : ' ';
+                if (line > 72) line = 0;
+                for (size_t j = 0; j < word.size() && pos < size; j++) buf[pos++] = word[j];
+            }
+            break;
+        }
+        default:
+        {
+            const size_t rows = 4096;
+            uint64_t id = 0, time = 1700000000000ULL, walk = 1000000, categories[16], column[rows];
+            for (int c = 0; c < 16; c++) categories[c] = rng() >> 40;
+            while (pos < size)
+            {
+                for (int col = 0; col < 5 && pos < size; col++)
                 {
-                    if (istrcmp(comp_desc[i].name, cparams[0].c_str()) == 0)
-                    {
-                        found = true;
-                       // printf("%s %s %s\n", cparams[0].c_str(), comp_desc[i].version, cparams[j].c_str());
-                        if (j >= cparams.size())
+                    for (size_t r = 0; r < rows; r++)
+                        switch (col)
                         {
-                            for (int level=comp_desc[i].first_level; level<=comp_desc[i].last_level; level++)
-                                lzbench_test(params, file_sizes, &comp_desc[i], level, inbuf, insize, compbuf, comprsize, decomp, rate, level);
+                            case 0: column[r] = id + r; break;
+                            case 1: column[r] = (time += gen_exponential(rng, 100)); break;
+                            case 2: column[r] = (walk += rng() % 201 - 100); break;
+                            case 3: column[r] = categories[rng() % 16]; break;
+                            default: column[r] = rng(); break;
                         }
-                        else
-                            lzbench_test(params, file_sizes, &comp_desc[i], atoi(cparams[j].c_str()), inbuf, insize, compbuf, comprsize, decomp, rate, atoi(cparams[j].c_str()));
-                        break;
-                    }
+                    size_t part = MIN(sizeof(column), size - pos);
+                    memcpy(buf + pos, column, part);
+                    pos += part;
                 }
-                if (!found) printf("NOT FOUND: %s %s\n", cparams[0].c_str(), (j<cparams.size()) ? cparams[j].c_str() : NULL);
-                j++;
+                id += rows;
             }
-            while (j < cparams.size());
+            break;
         }
-next_k:
-        continue;
     }
+    return buf;
 }
 
 
-int lzbench_join(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx, char* encoder_list)
+/* the format of a compressed file of --decompress-only by its magic bytes, brotli has none and is known by .br */
+const char* compressed_format(const char* filename, const uint8_t* buf, size_t size)
+{
+    const char* ext = strrchr(filename, '.');
+    if (size >= 3 && buf[0] == 0x1F && buf[1] == 0x8B && buf[2] == 8) return "gzip";
+    if (size >= 4 && !memcmp(buf, "\x28\xB5\x2F\xFD", 4)) return "zstd";
+    if (size >= 6 && !memcmp(buf, "\xFD" "7zXZ\0", 6)) return "xz";
+    if (size >= 4 && !memcmp(buf, "\x04\x22\x4D\x18", 4)) return "lz4";
+    if (size >= 4 && !memcmp(buf, "BZh", 3) && buf[3] >= '1' && buf[3] <= '9') return "bzip2";
+    if (size >= 2 && (buf[0] & 0x0F) == 8 && (buf[0] >> 4) <= 7 && ((buf[0] << 8) | buf[1]) % 31 == 0) return "zlib";
+    if (ext && !strcmp(ext, ".br")) return "br";
+    return NULL;
+}
+
+/* decompression of compressed files made by other tools (--decompress-only without --cache): every decoder of the
+   format is run on the whole file as a single chunk, the output of the first one is the reference for all of them */
+int lzbench_decode_files(lzbench_params_t* params, const char** inFileNames, unsigned ifnIdx)
 {
     bench_rate_t rate;
-    size_t comprsize, insize, inpos, totalsize;
-    uint8_t *inbuf, *compbuf, *decomp;
     std::vector<size_t> file_sizes;
-    std::string text;
-    FILE* in;
-    const char* pch;
-
-    totalsize = UTIL_getTotalFileSize(inFileNames, ifnIdx);
-    if (totalsize == 0) {
-        printf("Could not find input files\n");
-        return 1;
-    }
+    lzbench_params_t saved = *params;
+    bool header = false;
 
-    comprsize = GET_COMPRESS_BOUND(totalsize);
-    inbuf = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, false);
-    compbuf = (uint8_t*)alloc_and_touch(comprsize, false);
-    decomp = (uint8_t*)alloc_and_touch(totalsize + PAD_SIZE, true);
+    params->threads = 1;
+    params->random_reads = 0;
+    params->lz_stats = 0;
+    params->pipeline_dir = NULL;
+    params->breakdown = BREAKDOWN_NONE;
+    InitTimer(rate);
 
-    if (!inbuf || !compbuf || !decomp)
+    for (unsigned i=0; i<ifnIdx; i++)
     {
-        printf("Not enough memory, please use -m option!\n");
-        return 1;
-    }
+        std::vector<uint8_t> packed;
+        FILE* in = fopen(inFileNames[i], "rb");
+        if (!in) { perror(inFileNames[i]); continue; }
+        uint8_t tmp[1 << 16];
+        size_t n;
+        while ((n = fread(tmp, 1, sizeof(tmp), in)) > 0) packed.insert(packed.end(), tmp, tmp + n);
+        fclose(in);
 
-    InitTimer(rate);
-    inpos = 0;
+        const char* format = compressed_format(inFileNames[i], packed.data(), packed.size());
+        if (!format) { fprintf(stderr, "warning: %s is not gzip, zlib, zstd, xz, lz4, bzip2 or .br\n", inFileNames[i]); continue; }
 
-    for (int i=0; i<ifnIdx; i++)
-    {
-        if (UTIL_isDirectory(inFileNames[i])) {
-            fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
+        // the reference decompression into a buffer that grows until the whole output fits
+        const compressor_desc_t* ref = NULL;
+        for (int k=0; k<LZBENCH_DECODER_COUNT && !ref; k++)
+            if (!strcmp(decode_desc[k].format, format) && decode_desc[k].desc.decompress) ref = &decode_desc[k].desc;
+        if (!ref) { fprintf(stderr, "warning: %s: lzbench was built without decoders of %s\n", inFileNames[i], format); continue; }
+
+        size_t bufsize = MAX(packed.size() * 4, (size_t)1 << 20);
+        int64_t insize = 0;
+        uint8_t* inbuf = NULL;
+        for ( ; ; bufsize *= 2)
+        {
+            free_touched(inbuf);
+            if (!(inbuf = (uint8_t*)alloc_and_touch(bufsize + PAD_SIZE, false))) break;
+            char* workmem = ref->init ? ref->init(bufsize, 0, 0) : NULL;
+            insize = ref->decompress((char*)packed.data(), packed.size(), (char*)inbuf, bufsize, 0, 0, workmem);
+            if (ref->deinit) ref->deinit(workmem);
+            if ((insize > 0 && (size_t)insize < bufsize) || bufsize > ((size_t)1 << 40) / 2) break;
+        }
+        if (!inbuf || insize <= 0 || (size_t)insize >= bufsize)
+        {
+            fprintf(stderr, "warning: %s is not valid %s or too large\n", inFileNames[i], format);
+            free_touched(inbuf);
             continue;
-        } 
+        }
 
-        if (!(in=fopen(inFileNames[i], "rb"))) {
-            perror(inFileNames[i]);
+        size_t comprsize = MAX(GET_COMPRESS_BOUND(insize), packed.size()) + PAD_SIZE;
+        uint8_t* compbuf = (uint8_t*)alloc_untouched(comprsize);
+        uint8_t* decomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+        if (!compbuf || !decomp)
+        {
+            printf("Not enough memory for %s!\n", inFileNames[i]);
+            free_touched(inbuf); free_touched(compbuf); free_touched(decomp);
             continue;
-        } 
+        }
 
-        fseeko(in, 0L, SEEK_END);
-        insize = ftello(in);
-        rewind(in);
+        const char* pch = strrchr(inFileNames[i], '/');
+        params->in_filename = pch ? pch+1 : inFileNames[i];
+        params->in_path = NULL;
+        params->chunk_size = insize;
+        params->decode_data = packed.data();
+        params->decode_size = packed.size();
+        params->codec_options = format;
+        if (!header) print_header(params), header = true;
+        file_sizes.assign(1, insize);
+        for (int k=0; k<LZBENCH_DECODER_COUNT; k++)
+            if (!strcmp(decode_desc[k].format, format) && decode_desc[k].desc.decompress)
+                lzbench_test(params, file_sizes, &decode_desc[k].desc, 0, inbuf, insize, compbuf, comprsize, decomp, rate, 0);
 
-        if (inpos + insize > totalsize) { printf("inpos + insize > totalsize\n"); goto _clean; };
-        insize = fread(inbuf+inpos, 1, insize, in);
-        file_sizes.push_back(insize);
-        inpos += insize;
-        fclose(in);
+        free_touched(inbuf);
+        free_touched(compbuf);
+        free_touched(decomp);
     }
 
-    if (file_sizes.size() == 0) 
-        goto _clean;
+    params->threads = saved.threads;
+    params->random_reads = saved.random_reads;
+    params->lz_stats = saved.lz_stats;
+    params->pipeline_dir = saved.pipeline_dir;
+    params->breakdown = saved.breakdown;
+    params->chunk_size = saved.chunk_size;
+    params->decode_data = NULL;
+    params->decode_size = 0;
+    params->codec_options.clear();
+    return 0;
+}
+
+
+/* --mem-budget: resident memory of the process in bytes or, with peak, its peak since reset_peak_rss(), -1 = unknown */
+int64_t process_rss(bool peak)
+{
+    int64_t kb = -1;
+#if defined(__linux__)
+    const char* key = peak ? "VmHWM:" : "VmRSS:";
+    char line[256];
+    FILE* f = fopen("/proc/self/status", "r");
+    while (f && fgets(line, sizeof(line), f))
+        if (!strncmp(line, key, 6)) { kb = atoll(line + 6); break; }
+    if (f) fclose(f);
+#else
+    (void)peak;
+#endif
+    return kb < 0 ? -1 : kb << 10;
+}
+
+
+bool reset_peak_rss()
+{
+#if defined(__linux__)
+    FILE* f = fopen("/proc/self/clear_refs", "w");
+    if (!f) return false;
+    bool ok = fputs("5", f) >= 0;
+    return fclose(f) == 0 && ok;
+#else
+    return false;
+#endif
+}
 
-    format(text, "%d files", file_sizes.size());
-    params->in_filename = text.c_str();
 
-    LZBENCH_PRINT(5, "totalsize=%d comprsize=%d inpos=%d\n", (int)totalsize, (int)comprsize, (int)inpos);
-    totalsize = inpos;
+/*
+ * --mem-budget: working set of a codec for chunks of size bytes, the growth of the peak RSS of the process during
+ * init, compression and decompression of a sample (the counting allocator and workmem where the peak can't be reset)
+ */
+int64_t lzbench_probe_memory(lzbench_params_t *params, const compressor_desc_t* desc, int level, uint8_t *sample, size_t size, uint8_t *compbuf, size_t comprsize, uint8_t *decomp)
+{
+    std::vector<size_t> chunk_sizes, compr_sizes;
+    size_t chunk = MIN(size, codec_chunk_limit(desc));
+    int64_t base = -1, mem_start, mem_peak;
+
+    for (size_t pos = 0; pos < size; pos += chunk) chunk_sizes.push_back(MIN(chunk, size - pos));
+#if defined(__linux__) && defined(__GLIBC__)
+    malloc_trim(0); // memory that malloc keeps from earlier probes would hide allocations
+#endif
+    if (reset_peak_rss()) base = process_rss(false);
+    lzbench_mem_reset_peak();
+    lzbench_mem_stats(&mem_start, NULL, NULL);
+
+    char* workmem = desc->init ? desc->init(chunk, level, desc->additional_param) : NULL;
+    if (lzbench_compress(params, chunk_sizes, desc->compress, compr_sizes, sample, compbuf, comprsize, level, desc->additional_param, workmem, NULL) > 0)
+        lzbench_decompress(params, chunk_sizes, desc->decompress, compr_sizes, compbuf, decomp, level, desc->additional_param, workmem, NULL);
 
+    lzbench_mem_stats(NULL, &mem_peak, NULL);
+    int64_t peak = base >= 0 ? process_rss(true) : -1, ws = peak - base;
+    if (base < 0 || peak < 0)
     {
-        std::vector<size_t> single_file;
-        lzbench_params_t params_memcpy;
+        ws = mem_peak - mem_start;
+#if defined(__linux__)
+        if (workmem) ws += malloc_usable_size(workmem);
+#endif
+    }
+    if (desc->deinit) desc->deinit(workmem);
+    return MAX(ws, (int64_t)0);
+}
 
-        print_header(params);
-        memcpy(&params_memcpy, params, sizeof(lzbench_params_t));
-        params_memcpy.cmintime = params_memcpy.dmintime = 0;
-        params_memcpy.c_iters = params_memcpy.d_iters = 0;
-        params_memcpy.cloop_time = params_memcpy.dloop_time = DEFAULT_LOOP_TIME;
-        single_file.push_back(totalsize);
-        lzbench_test(&params_memcpy, file_sizes, &comp_desc[0], 0, inbuf, totalsize, compbuf, totalsize, decomp, rate, 0);
+
+/*
+ * --mem-budget: working set of a job as a function of the chunk size, measured with samples that double from 1 MB
+ * until it stops growing (the window of the codec is reached), the chunk or MEM_BUDGET_SAMPLE is reached. Beyond
+ * the last sample it's flat or extrapolated linearly from the last two samples.
+ */
+#define MEM_BUDGET_SAMPLE (32 << 20)
+
+typedef struct
+{
+    std::vector<size_t> sizes;
+    std::vector<int64_t> bytes;
+    bool flat;
+} lzbench_mem_curve_t;
+
+int64_t mem_curve_at(const lzbench_mem_curve_t &curve, size_t size)
+{
+    size_t n = curve.sizes.size();
+    if (size <= curve.sizes[0]) return curve.bytes[0];
+    for (size_t k=1; k<n; k++)
+        if (size <= curve.sizes[k])
+            return curve.bytes[k-1] + (int64_t)((double)(curve.bytes[k] - curve.bytes[k-1]) * (size - curve.sizes[k-1]) / (curve.sizes[k] - curve.sizes[k-1]));
+    if (curve.flat || n < 2) return curve.bytes[n-1];
+    double slope = MAX((double)(curve.bytes[n-1] - curve.bytes[n-2]) / (curve.sizes[n-1] - curve.sizes[n-2]), 0.0);
+    return curve.bytes[n-1] + (int64_t)(slope * (size - curve.sizes[n-1]));
+}
+
+
+/* memory of the process with base bytes of lzbench itself for parts of size bytes: inbuf, compbuf, decomp, the buffer of --stream and the working sets of the threads */
+int64_t mem_budget_need(lzbench_params_t *params, size_t size, size_t chunk, const lzbench_mem_curve_t &curve, int64_t base)
+{
+    int64_t buffers = 2 * (size + PAD_SIZE) + GET_COMPRESS_BOUND(size) + (params->max_threads-1)*PAD_SIZE;
+    if (params->stream) buffers += size + PAD_SIZE;
+    return base + buffers + params->max_threads * mem_curve_at(curve, MIN(chunk, size));
+}
+
+
+/*
+ * --mem-budget: before a file is read, every job of -e is probed on the start of the file and the largest part that
+ * keeps all of them within the budget sets mem_limit as with -m#. Jobs that don't fit with parts of 1 MB are skipped.
+ */
+void lzbench_mem_budget(lzbench_params_t *params, const char *namesWithParams, FILE* in, size_t real_insize, bench_rate_t rate)
+{
+    static std::map<std::string, lzbench_mem_curve_t> curves; // of jobs, for later files
+    size_t chunk = params->chunk_size, min_part = MIN(real_insize, (size_t)1 << 20), part = real_insize;
+    for (size_t b=0; b<params->block_sizes.size(); b++) chunk = MAX(chunk, params->block_sizes[b]);
+    size_t sample_size = MIN(MIN(real_insize, chunk), (size_t)MEM_BUDGET_SAMPLE);
+    std::vector<size_t> file_sizes(1, real_insize);
+    std::string worst;
+    int64_t worst_bytes = 0, base = MAX(process_rss(false), (int64_t)0);
+
+    params->budget_skip.clear();
+    params->budget_skip_bytes.clear();
+    if (!real_insize) return;
+
+    uint8_t *sample = (uint8_t*)alloc_and_touch(sample_size + PAD_SIZE, false);
+    size_t comprsize = GET_COMPRESS_BOUND(sample_size) + PAD_SIZE;
+    uint8_t *compbuf = (uint8_t*)alloc_and_touch(comprsize, false);
+    uint8_t *decomp = (uint8_t*)alloc_and_touch(sample_size + PAD_SIZE, true);
+    if (!sample || !compbuf || !decomp || fread(sample, 1, sample_size, in) != sample_size)
+    {
+        fprintf(stderr, "warning: --mem-budget cannot probe %s, -m# is used\n", params->in_filename);
+        free_touched(sample); free_touched(compbuf); free_touched(decomp);
+        rewind(in);
+        return;
     }
+    rewind(in);
 
-    lzbench_test_with_params(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, totalsize, compbuf, comprsize, decomp, rate);
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    params->collect_jobs = 1;
+    lzbench_test_with_params(params, file_sizes, namesWithParams, sample, sample_size, compbuf, comprsize, decomp, rate);
+    params->collect_jobs = 0;
 
-_clean:
-    free(inbuf);
-    free(compbuf);
-    free(decomp);
+    for (size_t k=0; k<params->jobs.size(); k++)
+    {
+        const compressor_desc_t* desc = codec_desc(params->jobs[k].first);
+        int level = params->jobs[k].second;
+        std::string key;
+        format(key, "%s -%d%s%s", desc->name, level, params->job_options[k].empty() ? "" : ",", params->job_options[k].c_str());
+        if (!desc->compress || !desc->decompress || is_checksum(desc) || is_delta(desc)) continue;
 
-    return 0;
+        lzbench_mem_curve_t &curve = curves[key];
+        if (curve.sizes.empty() || (!curve.flat && curve.sizes.back() < sample_size))
+        {
+            LZBENCH_PRINT(2, "%s memory probe     \r", desc->name);
+            lzbench_set_options(params, desc, params->job_options[k]);
+            curve.sizes.clear();
+            curve.bytes.clear();
+            curve.flat = false;
+            for (size_t n = MIN(sample_size, (size_t)1 << 20); ; n = MIN(2 * n, sample_size))
+            {
+                int64_t bytes = lzbench_probe_memory(params, desc, level, sample, n, compbuf, comprsize, decomp);
+                curve.flat = !curve.bytes.empty() && bytes <= curve.bytes.back() + curve.bytes.back() / 20 + (1 << 20);
+                curve.sizes.push_back(n);
+                curve.bytes.push_back(bytes);
+                if (curve.flat || n == sample_size) break;
+            }
+            lzbench_set_options(params, desc, "");
+        }
+
+        if (mem_budget_need(params, min_part, chunk, curve, base) > (int64_t)params->mem_budget)
+        {
+            params->budget_skip.push_back(params->jobs[k]);
+            params->budget_skip_bytes.push_back(mem_curve_at(curve, MIN(chunk, min_part)));
+            continue;
+        }
+        if (mem_budget_need(params, part, chunk, curve, base) > (int64_t)params->mem_budget)
+        {
+            size_t lo = min_part, hi = part; // need(lo) fits, need(hi) doesn't
+            while (hi - lo > 1)
+            {
+                size_t mid = lo + (hi - lo) / 2;
+                if (mem_budget_need(params, mid, chunk, curve, base) <= (int64_t)params->mem_budget) lo = mid; else hi = mid;
+            }
+            part = lo;
+        }
+        int64_t bytes = mem_curve_at(curve, MIN(chunk, part));
+        if (bytes >= worst_bytes) worst_bytes = bytes, worst = key;
+    }
+    params->jobs.clear();
+    params->job_options.clear();
+    params->job_filters.clear();
+    free_touched(sample);
+    free_touched(compbuf);
+    free_touched(decomp);
+#if defined(__linux__) && defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+
+    if (part < real_insize && part >= (1 << 20)) part &= ~(size_t)((1 << 20) - 1);
+    if (part < real_insize && (!params->mem_limit || part < params->mem_limit)) params->mem_limit = part;
+    if (params->mem_limit && params->mem_limit < real_insize)
+        LZBENCH_PRINT(2, "--mem-budget: %s in parts of %llu KB, the largest working set is %llu KB per thread (%s)\n", params->in_filename,
+            (unsigned long long)(params->mem_limit >> 10), (unsigned long long)(worst_bytes >> 10), worst.c_str());
 }
 
 
@@ -628,37 +15458,82 @@ int lzbench_main(lzbench_params_t* params, const char** inFileNames, unsigned if
     std::vector<size_t> file_sizes;
     FILE* in;
     const char* pch;
+    uint8_t *map;
+    size_t mapsize, mappos;
+    size_t mem_limit = params->mem_limit; // of -m#, --mem-budget lowers it for a file
 
     for (int i=0; i<ifnIdx; i++)
     {
-        if (UTIL_isDirectory(inFileNames[i])) {
+        bool from_stdin = !strcmp(inFileNames[i], "-"), generated = params->gen_inputs.count(inFileNames[i]) > 0;
+        uint8_t *stdin_buf = NULL; // also the input of --gen
+
+        if (from_stdin) {
+#ifdef WIN32
+            _setmode(_fileno(stdin), _O_BINARY);
+#endif
+            in = stdin;
+        } else if (generated) {
+            in = NULL;
+        } else if (UTIL_isDirectory(inFileNames[i])) {
             fprintf(stderr, "warning: use -r to process directories (%s)\n", inFileNames[i]);
             continue;
-        } 
-
-        if (!(in=fopen(inFileNames[i], "rb"))) {
+        } else if (!(in=fopen(inFileNames[i], "rb"))) {
             perror(inFileNames[i]);
             continue;
-        } 
+        }
 
         pch = strrchr(inFileNames[i], '\\');
-        params->in_filename = pch ? pch+1 : inFileNames[i];
+        params->in_filename = from_stdin ? "stdin" : pch ? pch+1 : inFileNames[i];
 
         InitTimer(rate);
 
-        fseeko(in, 0L, SEEK_END);
-        real_insize = ftello(in);
-        rewind(in);
+        if (from_stdin || generated) {
+            if (params->mmap_mode != MMAP_NONE || params->random_read) {
+                fprintf(stderr, "warning: --mmap and -R are not used with stdin and --gen\n");
+                params->mmap_mode = MMAP_NONE;
+                params->mmap_direct = params->random_read = 0;
+            }
+        }
+        if (generated) {
+            if (!(stdin_buf = lzbench_generate(inFileNames[i] + 4, real_insize)))
+                return 1;
+        } else if (from_stdin) {
+            if (params->mem_limit)
+                real_insize = SIZE_MAX; // windows of -m# until the end of stdin
+            else if (!(stdin_buf = lzbench_read_stdin(params, params->stdin_size ? params->stdin_size : SIZE_MAX, real_insize)))
+                return 1;
+        } else {
+            fseeko(in, 0L, SEEK_END);
+            real_insize = ftello(in);
+            rewind(in);
+        }
+
+        params->mem_limit = generated ? 0 : mem_limit; // the size of --gen is given
+        if (params->mem_budget && (from_stdin || generated))
+            fprintf(stderr, "warning: --mem-budget is not used with stdin and --gen, use -m# or size=\n");
+        else if (params->mem_budget)
+            lzbench_mem_budget(params, encoder_list?encoder_list:alias_desc[0].params, in, real_insize, rate);
+
+        // --pipeline reads the file itself, what makes sense only if it is benchmarked as a whole
+        params->in_path = (params->mem_limit && real_insize > params->mem_limit) || params->random_read || from_stdin || generated ? NULL : inFileNames[i];
+        if (params->pipeline_dir && !params->in_path) fprintf(stderr, "warning: --pipeline is not used with -m# parts or -R (%s)\n", inFileNames[i]);
 
         if (params->mem_limit && real_insize > params->mem_limit)
             insize = params->mem_limit;
         else
             insize = real_insize;
 
-        comprsize = GET_COMPRESS_BOUND(insize);
+        map = NULL;
+        mappos = 0;
+        if (params->mmap_mode != MMAP_NONE && !(map = lzbench_mmap_file(params, inFileNames[i], real_insize, &mapsize))) {
+            fclose(in);
+            continue;
+        }
+
+        comprsize = GET_COMPRESS_BOUND(insize) + (params->max_threads-1)*PAD_SIZE; // every thread has its own bound
     	// printf("insize=%llu comprsize=%llu %llu\n", insize, comprsize, MAX(MEMCPY_BUFFER_SIZE, insize));
-        inbuf = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, false);
-        compbuf = (uint8_t*)alloc_and_touch(comprsize, false);
+        inbuf = stdin_buf ? stdin_buf : (map && params->mmap_direct) ? map : (uint8_t*)alloc_and_touch(insize + PAD_SIZE, false);
+        compbuf = (uint8_t*)alloc_untouched(comprsize);
         decomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
 
         if (!inbuf || !compbuf || !decomp)
@@ -673,85 +15548,520 @@ int lzbench_main(lzbench_params_t* params, const char** inFileNames, unsigned if
           if (params->chunk_size < real_insize){
             pos = (rand() % (real_insize / params->chunk_size)) * params->chunk_size;
             insize = params->chunk_size;
-            fseeko(in, pos, SEEK_SET);
+            if (map) mappos = pos; else fseeko(in, pos, SEEK_SET);
           } else {
             insize = real_insize;
           }
           printf("Seeking to: %llu %llu %llu\n", pos, (unsigned long long)params->chunk_size, (unsigned long long)insize);
         }
 
-        insize = fread(inbuf, 1, insize, in);
+        if (!stdin_buf) insize = lzbench_read_input(params, in, map, real_insize, mappos, inbuf, insize);
 
         if (i == 0)
         {
+            if (params->bandwidth) lzbench_bandwidth(params, inbuf, insize, decomp, rate);
             print_header(params);
 
-            lzbench_params_t params_memcpy;
-            memcpy(&params_memcpy, params, sizeof(lzbench_params_t));
+            lzbench_params_t params_memcpy = *params; // not memcpy(), it would share the vectors of params
             params_memcpy.cmintime = params_memcpy.dmintime = 0;
             params_memcpy.c_iters = params_memcpy.d_iters = 0;
             params_memcpy.cloop_time = params_memcpy.dloop_time = DEFAULT_LOOP_TIME;
             file_sizes.push_back(insize);
-            lzbench_test(&params_memcpy, file_sizes, &comp_desc[0], 0, inbuf, insize, compbuf, insize, decomp, rate, 0);
+            lzbench_test(&params_memcpy, file_sizes, &comp_desc[0], 0, inbuf, insize, compbuf, comprsize, decomp, rate, 0);
             file_sizes.clear();
+            if (params->bandwidth) print_bandwidth(params);
         }
+        if (params->predict) lzbench_predict_input(params, inbuf, insize);
 
         if (params->mem_limit && real_insize > params->mem_limit)
         {
             int i;
             std::string partname;
             const char* filename = params->in_filename;
+            if (params->stream)
+            {
+                // double buffering, a reader thread fills the second buffer with the next part
+                size_t first = params->results.size(), partsize = insize, nextsize = 0;
+                uint8_t *stream_buf = (map && params->mmap_direct) ? NULL : (uint8_t*)alloc_and_touch(insize + PAD_SIZE, false);
+                uint8_t *buf = inbuf, *next = stream_buf;
+                if (!stream_buf && !(map && params->mmap_direct)) { printf("Not enough memory, please use -m option!"); return 1; }
+
+                params->merge_parts = 1;
+                for (i=1; insize > 0; i++)
+                {
+                    std::thread reader([&]() { nextsize = lzbench_read_input(params, in, map, real_insize, mappos, next, partsize); });
+                    format(partname, "%s part %d", filename, i);
+                    params->in_filename = partname.c_str();
+                    file_sizes.push_back(insize);
+                    lzbench_run_tests(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, buf, insize, compbuf, comprsize, decomp, rate);
+                    file_sizes.clear();
+                    reader.join();
+                    std::swap(buf, next);
+                    insize = nextsize;
+                }
+                params->merge_parts = 0;
+                format(partname, "%s %d parts", filename, i-1);
+                lzbench_merge_parts(params, first, partname.c_str());
+                free_touched(stream_buf);
+            }
+            else
             for (i=1; insize > 0; i++)
             {
                 format(partname, "%s part %d", filename, i);
                 params->in_filename = partname.c_str();
                 file_sizes.push_back(insize);
-                lzbench_test_with_params(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, compbuf, comprsize, decomp, rate);
+                lzbench_run_tests(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, compbuf, comprsize, decomp, rate);
                 file_sizes.clear();
-                insize = fread(inbuf, 1, insize, in);
+                insize = lzbench_read_input(params, in, map, real_insize, mappos, inbuf, insize);
             }
         }
         else
         {
             file_sizes.push_back(insize);
-            lzbench_test_with_params(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, compbuf, comprsize, decomp, rate);
+            lzbench_run_tests(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, compbuf, comprsize, decomp, rate);
             file_sizes.clear();
         }
 
-        fclose(in);
-        free(inbuf);
-        free(compbuf);
-        free(decomp);
+        if (in && !from_stdin) fclose(in);
+        if (!map || !params->mmap_direct) free_touched(inbuf);
+        lzbench_munmap_file(map, mapsize);
+        free_touched(compbuf);
+        free_touched(decomp);
+    }
+
+    return 0;
+}
+
+
+/*
+ * --pathological: generated inputs that degrade match finders, long hash chains or deep binary trees of zero
+ * runs and short periods, many nearly equal candidates of near-duplicates and a de Bruijn sequence where every
+ * 6-gram occurs once, so there are only short matches to try. They are benchmarked like files after the files.
+ */
+void pathological_input(int kind, uint8_t *buf, size_t size)
+{
+    std::mt19937 rng(1);
+    switch (kind)
+    {
+        case 0:
+            memset(buf, 0, size);
+            break;
+        case 1:
+            for (size_t i = 0; i < size; i++) buf[i] = i < 7 ? (uint8_t)rng() : buf[i - 7];
+            break;
+        case 2: // copies of a random block of 4 KB with 16 random bytes changed in each
+            for (size_t i = 0; i < size; i++) buf[i] = i < 4096 ? (uint8_t)rng() : buf[i - 4096];
+            for (size_t i = 4096; i < size; i += 4096)
+                for (int k = 0; k < 16; k++) buf[i + rng() % MIN((size_t)4096, size - i)] = rng();
+            break;
+        default: // B(16, 6) by concatenating the Lyndon words of lengths dividing 6 in lexicographic order
+        {
+            const int k = 16, n = 6;
+            std::vector<int> w(1, -1);
+            size_t pos = 0;
+            while (!w.empty() && pos < size)
+            {
+                w.back()++;
+                size_t m = w.size();
+                if (n % m == 0)
+                    for (size_t j = 0; j < m && pos < size; j++) buf[pos++] = 'a' + w[j];
+                while (w.size() < (size_t)n) w.push_back(w[w.size() - m]);
+                while (!w.empty() && w.back() == k - 1) w.pop_back();
+            }
+            for (; pos < size; pos++) buf[pos] = buf[pos % (1 << 24)]; // longer than 16^6 bytes
+            break;
+        }
+    }
+}
+
+
+int lzbench_pathological(lzbench_params_t* params, char* encoder_list)
+{
+    bench_rate_t rate;
+    std::vector<size_t> file_sizes;
+    size_t insize = params->pathological_size, comprsize = GET_COMPRESS_BOUND(insize) + (params->max_threads-1)*PAD_SIZE;
+    uint8_t *inbuf = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, false);
+    uint8_t *compbuf = (uint8_t*)alloc_untouched(comprsize);
+    uint8_t *decomp = (uint8_t*)alloc_and_touch(insize + PAD_SIZE, true);
+
+    if (!inbuf || !compbuf || !decomp)
+    {
+        printf("Not enough memory for --pathological inputs of %llu MB!", (unsigned long long)(insize >> 20));
+        return 1;
+    }
+
+    InitTimer(rate);
+    if (params->results.empty()) print_header(params);
+    params->in_path = NULL;
+    for (int kind = 0; kind < PATHOLOGICAL_INPUTS; kind++)
+    {
+        pathological_input(kind, inbuf, insize);
+        params->in_filename = pathological_names[kind];
+        file_sizes.push_back(insize);
+        lzbench_run_tests(params, file_sizes, encoder_list?encoder_list:alias_desc[0].params, inbuf, insize, compbuf, comprsize, decomp, rate);
+        file_sizes.clear();
     }
 
+    free_touched(inbuf);
+    free_touched(compbuf);
+    free_touched(decomp);
     return 0;
 }
 
 
 void usage(lzbench_params_t* params)
 {
-    fprintf(stderr, "usage: " PROGNAME " [options] input [input2] [input3]\n\nwhere [input] is a file or a directory and [options] are:\n");
+    fprintf(stderr, "usage: " PROGNAME " [options] input [input2] [input3]\n\nwhere [input] is a file, a directory or - for stdin and [options] are:\n");
     fprintf(stderr, " -b#   set block/chunk size to # KB (default = MIN(filesize,%d KB))\n", (int)(params->chunk_size>>10));
+    fprintf(stderr, " -bX,Y,Z run every compressor with chunks of X, Y and Z KB of the same loaded input and print\n");
+    fprintf(stderr, "       a matrix of ratio and speed of every compressor at every chunk size\n");
+    fprintf(stderr, " -b0   the whole input in one chunk, codecs get chunks of the largest size their API takes (2 or 4 GB)\n");
     fprintf(stderr, " -c#   sort results by column # (1=algname, 2=ctime, 3=dtime, 4=comprsize)\n");
     fprintf(stderr, " -e#   #=compressors separated by '/' with parameters specified after ',' (deflt=fast)\n");
+    fprintf(stderr, "      options of zstd (wlog, clog, hlog, slog, mml, tlen, strategy), brotli (lgwin, lgblock),\n");
+    fprintf(stderr, "      lzma/xz (dict, lc, lp, pb, fb), lz4hc (favordec) and zstd_seekable (frame, default = 64K)\n");
+    fprintf(stderr, "      follow a level or a name after ':'\n");
+    fprintf(stderr, "      filters shuffle#, bitshuffle[#] and delta# of # byte elements and BCJ filters of executables\n");
+    fprintf(stderr, "      bcj_x86, bcj_arm, bcj_armthumb, bcj_arm64, bcj_powerpc, bcj_sparc and bcj_riscv precede a name with '+'\n");
+    fprintf(stderr, "      mt#: before a name cuts every chunk into # blocks (at least 64 KB) compressed and decompressed by # threads\n");
+    fprintf(stderr, "      and compares the latency of a chunk and the ratio with the codec alone\n");
     fprintf(stderr, " -iX,Y set min. number of compression and decompression iterations (default = %d, %d)\n", params->c_iters, params->d_iters);
     fprintf(stderr, " -j    join files in memory but compress them independently (for many small files)\n");
+    fprintf(stderr, " -J    join files and run every compressor also on them as one stream cut into blocks of -b# over file\n");
+    fprintf(stderr, "       boundaries (solid), then compare ratios of files and solid blocks, -J1 = files sorted by extension\n");
     fprintf(stderr, " -l    list of available compressors and aliases\n");
     fprintf(stderr, " -R    read block/chunk size from random blocks (to estimate for large files)\n");
     fprintf(stderr, " -m#   set memory limit to # MB (default = no limit)\n");
-    fprintf(stderr, " -o#   output text format 1=Markdown, 2=text, 3=text+origSize, 4=CSV (default = %d)\n", params->textformat);
+    fprintf(stderr, " -o#   output text format 1=Markdown, 2=text, 3=text+origSize, 4=CSV, 7=JSON (default = %d)\n", params->textformat);
     fprintf(stderr, " -p#   print time for all iterations: 1=fastest 2=average 3=median (default = %d)\n", params->timetype);
+    fprintf(stderr, " -P#   run every compressor in # processes at once, each (de)compresses its own part of chunks of the\n");
+    fprintf(stderr, "       input in shared memory with buffers and a heap of its own, MB/s are those of all processes\n");
 #ifdef UTIL_HAS_CREATEFILELIST
     fprintf(stderr, " -r    operate recursively on directories\n");
 #endif
     fprintf(stderr, " -s#   use only compressors with compression speed over # MB (default = %d MB)\n", params->cspeed);
     fprintf(stderr, " -tX,Y set min. time in seconds for compression and decompression (default = %.0f, %.0f)\n", params->cmintime/1000.0, params->dmintime/1000.0);
+    fprintf(stderr, " -T#   set number of threads, each (de)compresses its own part of chunks (default = %d)\n", params->threads);
+    fprintf(stderr, " -TX,Y,Z run every compressor with X, Y and Z threads and print a thread scaling table\n");
     fprintf(stderr, " -v    disable progress information\n");
     fprintf(stderr, " -x    disable real-time process priority\n");
     fprintf(stderr, " -z    show (de)compression times instead of speed\n");
+    fprintf(stderr, " --adapt=#[,#-#]    stream the input with zstd in chunks of -b# (default = 1 MB) to a link of # MB/s with a queue\n");
+    fprintf(stderr, "                    of 4 chunks, raising the level after the producer waited for the link and lowering it after the\n");
+    fprintf(stderr, "                    link waited for a chunk (levels 1-19 by default); shows throughput, ratio and levels of chunks\n");
+    fprintf(stderr, " --alloc=malloc|arena|both  codecs that take allocation functions (zstd, zlib, brotli, bzip2, lzma, xz,\n");
+    fprintf(stderr, "                    lzham) allocate with malloc (default), from an arena of the thread that is rewound when all\n");
+    fprintf(stderr, "                    of its blocks are freed or are run both ways; use it with --contexts=percall to compare the\n");
+    fprintf(stderr, "                    cost of allocation in every call\n");
+    fprintf(stderr, " --append=#[,#[,#]] write-ahead log: run codecs with a streaming interface also over the input as records\n");
+    fprintf(stderr, "                    of # bytes appended to a single stream that is flushed every # records and every # bytes\n");
+    fprintf(stderr, "                    (default = only at the end), show p50/p99/p99.9 latency of an append, mean time of a flush\n");
+    fprintf(stderr, "                    and its share, the ratio and the size in %% of one-shot compression of the test\n");
+    fprintf(stderr, " --archive          -j with the regular files of tar and zip archives (stored or deflated) as files, without\n");
+    fprintf(stderr, "                    extracting them; .gz and .zst archives are decompressed on load, other inputs are files\n");
+    fprintf(stderr, " --baseline=file    compare results with a previous run written with -o4 or -o7 and exit with 2\n");
+    fprintf(stderr, "                    if speed drops more than --threshold=#%% (default = %.0f%%) or ratio gets worse\n", params->speed_threshold);
+    fprintf(stderr, "                    more than --ratio-threshold=#%% (default = %.1f%%)\n", params->ratio_threshold);
+    fprintf(stderr, " --bestof=#/#[:entropy=#,#|:lz4=#,#|:try[=us]] candidates of -ebestof, a meta-codec that compresses every chunk\n");
+    fprintf(stderr, "                    with one of them (default = store/lz4/zstd,3), chosen by sampled entropy in bits per byte or\n");
+    fprintf(stderr, "                    lz4 ratio in %% at or over the thresholds (one less than candidates) or by trying them in turn\n");
+    fprintf(stderr, "                    within # us (default = all) for the smallest output, shows the share of chunks of each candidate\n");
+    fprintf(stderr, "                    and the time of decisions in %% of compression time\n");
+    fprintf(stderr, " --block=#[,#...]   chunk sizes in bytes, like -b# in KB\n");
+    fprintf(stderr, " --bandwidth        measure read, write, copy and non-temporal write and copy bandwidth of memory\n");
+    fprintf(stderr, "                    for every -T# after memcpy and show speed of codecs in %% of the copy bandwidth\n");
+    fprintf(stderr, " --breakdown[=file] with -j show ratio and speed of every file type (extension or a guess from\n");
+    fprintf(stderr, "                    the content) and with =file also of every file, all measured single threaded\n");
+    fprintf(stderr, " --brotli-dict=file a raw dictionary of brotli_dict (like a previous version of a resource for shared-dictionary\n");
+    fprintf(stderr, "                    content encoding), otherwise brotli_dict uses the one of --dict; the time of its preparation\n");
+    fprintf(stderr, "                    and the time that attaching it adds to every call are shown apart from compression\n");
+    fprintf(stderr, " --cache=dir        store compressed data of every compressor and level in dir, the stored data\n");
+    fprintf(stderr, "                    is used instead of compression with --decompress-only\n");
+    fprintf(stderr, " --calibrate[=memcpy|alu] measure single-core memcpy speed, pointer chase latency and an integer ALU\n");
+    fprintf(stderr, "                    score at startup, print them with the run and show speed of codecs in %% of the\n");
+    fprintf(stderr, "                    calibrated memcpy (default) or in MB per 10^9 ops of the ALU score\n");
+    fprintf(stderr, " --chunk-map=file   write offset, size, compressed size and the best of 3 compression and decompression times\n");
+    fprintf(stderr, "                    in ns of every chunk of every test to a file, as CSV or JSON Lines for a name ending with .jsonl\n");
+    fprintf(stderr, " --ci=#             adaptive stopping: iterate until the 95%% confidence interval is below #%% of the mean\n");
+    fprintf(stderr, "                    or --ci-max=# seconds (default = %d) pass, replaces -t and -u (implies --stats)\n", params->ci_maxtime/1000);
+    fprintf(stderr, " --cold[=sweep|flush] add a pass with evicted caches after every -t# or -u# loop by reading a buffer\n");
+    fprintf(stderr, "                    of --cold-size=# MB (default = %d MB) or by clflush of all buffers\n", (int)(params->cold_size>>20));
+    fprintf(stderr, " --cold-start[=#]   run every codec # times (default = 10) in a fresh process that compresses and decompresses\n");
+    fprintf(stderr, "                    the first chunk of -b# once and show the wall time from spawn to exit, split into the start\n");
+    fprintf(stderr, "                    of the process and its first init, compress and decompress (Linux)\n");
+    fprintf(stderr, " --consume=xxh64|scan|path  run a consumer on every chunk right after its decompression while it is in cache:\n");
+    fprintf(stderr, "                    XXH64 of the chunk, a scan for line ends or lzbench_consume() of a shared object (plugin.h),\n");
+    fprintf(stderr, "                    the decompression speed is fused, also shows MB/s and the gain over decompressing all chunks\n");
+    fprintf(stderr, "                    followed by the consumer over the whole output\n");
+    fprintf(stderr, " --contexts=reuse|percall|both  codecs with init/deinit of their states (zlib, brotli, lzham...)\n");
+    fprintf(stderr, "                    reuse them (default), set them up in every call or are run both ways\n");
+    fprintf(stderr, " --core-types       run every test on the CPUs of each core type of a hybrid processor in turn (Linux: Intel\n");
+    fprintf(stderr, "                    P/E-cores by perf PMUs or CPUID, ARM big.LITTLE by cpu_capacity), print speed on every type\n");
+    fprintf(stderr, "                    and speed on the fastest type over speed on the slowest one\n");
+    fprintf(stderr, " --cost=#[,#]       $ per GB stored or shipped and $ per core-hour of CPU time, adds $ per TB of input\n");
+    fprintf(stderr, "                    to the report of --transfer (implies it)\n");
+    fprintf(stderr, " --cpb[=GHz]        show cycles per byte at the given clock frequency or at the TSC frequency on x86\n");
+    fprintf(stderr, " --decompress-only  benchmark only decompression of data stored with --cache, compression times\n");
+    fprintf(stderr, "                    are those of the run that stored it, data missing in the cache is compressed\n");
+    fprintf(stderr, "                    without --cache the input files are .gz, zlib, .zst, .xz, .lz4, .bz2 or .br files of other\n");
+    fprintf(stderr, "                    tools, each is decompressed by all decoders of its format (e.g. zlib and libdeflate)\n");
+    fprintf(stderr, " --dedup[=#]        deduplicate the input before the codecs: FastCDC chunks of # KB on average (default = 8)\n");
+    fprintf(stderr, "                    fingerprinted by XXH64, the codecs get the unique chunks, show chunking and dedup MB/s,\n");
+    fprintf(stderr, "                    the dedup ratio and the effective ratio and speed of dedup and the codec together\n");
+    fprintf(stderr, " --delta=file       reference (like the previous version of the input) that zstd_delta (ZSTD_CCtx_refPrefix()\n");
+    fprintf(stderr, "                    with a window over both), brotli_delta (compound dictionary, levels 2-11) and lz4_delta (its last 64 KB)\n");
+    fprintf(stderr, "                    compress the input against, the size and speed without the reference are shown after the row\n");
+    fprintf(stderr, " --dict[=#]         with -j train a dictionary of # KB (default = 110 KB) from a sample of the files\n");
+    fprintf(stderr, "                    and run also brotli, lz4 and zstd with it on every file\n");
+    fprintf(stderr, " --dthreads=#[,#...] decompression-only scaling of a read path apart from -T#: # threads decode all chunks\n");
+    fprintf(stderr, "                    of the same shared read-only compbuf into private outputs, MB/s of all of them for every #\n");
+    fprintf(stderr, " --energy           show package energy in J/GB and average power in W from RAPL counters\n");
+    fprintf(stderr, "                    of /sys/class/powercap (Linux, usually needs root)\n");
+    fprintf(stderr, " --feed=#[,#]       also run codecs with a streaming interface (brotli, lz4, xz, zlib, zstd) with\n");
+    fprintf(stderr, "                    input fed in writes of # bytes and a flush every # bytes (default = no flush)\n");
+    fprintf(stderr, " --fresh-output[=both] drop the pages of the output buffer (MADV_DONTNEED) before every decompression pass,\n");
+    fprintf(stderr, "                    so page faults and zeroing of a newly allocated buffer are timed (Linux), both = run every\n");
+    fprintf(stderr, "                    codec with prefaulted and with fresh output to see what pooling of output buffers saves\n");
+    fprintf(stderr, " --freq[=#]         show average core frequency from cpufreq, its spread and thermal throttle events,\n");
+    fprintf(stderr, "                    warn when the frequency moves more than #%% (default = 10%%) or the CPU throttles\n");
+    fprintf(stderr, " --fuzz[=#[,ms]]    decode # mutated compressed chunks (default = 1000) with bit flips, truncation, huge lengths\n");
+    fprintf(stderr, "                    and random bytes in forked processes and show the slowest decode, its slowdown against the\n");
+    fprintf(stderr, "                    intact chunk, crashes, hangs over ms (default = 1000) and output-size anomalies\n");
+    fprintf(stderr, " --gen[=mode][,size=#][,ratio=#][,entropy=#][,len=#][,off=#][,seed=#] add a generated input of # MB\n");
+    fprintf(stderr, "                    (default = 16) that is the same on every host for a seed (default = 1), lz (default): literals\n");
+    fprintf(stderr, "                    of # bits (default = 8) and matches of exponential length and offset with means len and\n");
+    fprintf(stderr, "                    off (default = 16 and 4096) that reach a ratio of # (default = 3) with an ideal LZ, text:\n");
+    fprintf(stderr, "                    words of a Zipf vocabulary, numeric: 64-bit columns of ids, timestamps, a random walk,\n");
+    fprintf(stderr, "                    categories and random values, it can be given more than once\n");
+    fprintf(stderr, " --hugepages[=thp|hugetlb|both] back the benchmark buffers with transparent huge pages\n");
+    fprintf(stderr, "                    or MAP_HUGETLB, both = run all tests with 4 KB and with THP pages (Linux)\n");
+    fprintf(stderr, " --ingest=#[,#...]  feed chunks of -b# to -T# threads at # MB/s by a token bucket for the time of -t# compression\n");
+    fprintf(stderr, "                    and show the cores used by the codec (getrusage), cores per GB/s of ingest and the latency\n");
+    fprintf(stderr, "                    of chunks from release to compressed, p50, p99 and max\n");
+    fprintf(stderr, " --inplace          decompress every chunk with its compressed data at the tail of the output buffer, show the\n");
+    fprintf(stderr, "                    largest margin needed behind the output and MB/s (lz4 and zstd decoders, '-' for others)\n");
+    fprintf(stderr, " --interleave[=random] run all compressors in --rounds=# (default = %d) round-robin slices\n", params->rounds);
+    fprintf(stderr, "                    of -t, -u and -i divided by rounds, optionally in random order in every round\n");
+    fprintf(stderr, " --interop          decode the output of every compressor of -e (e.g. -edeflate/zlib/lz4hc) with all rows\n");
+    fprintf(stderr, "                    of the same format (deflate, zlib, gzip, xz, lzma2, lz4, lz4frame, snappy), show a matrix of\n");
+    fprintf(stderr, "                    verified decompression speeds with FAIL for streams a decoder rejects or gets wrong\n");
+    fprintf(stderr, " --iovec[=#[-#][,#]] scatter/gather: the input and output are split into fragments of # to # bytes (default\n");
+    fprintf(stderr, "                    = 4096-65536) that start at odd multiples of # bytes (default = 64, 1 = odd addresses), show MB/s\n");
+    fprintf(stderr, "                    of compression from contiguous input, gathered by a copy and streamed (codecs with a streaming\n");
+    fprintf(stderr, "                    interface), of decompression to contiguous and scattered output and the cost of the best\n");
+    fprintf(stderr, "                    scattered path in %% (single thread)\n");
+    fprintf(stderr, " --isa              show the instruction set of every codec selected for this CPU at runtime\n");
+    fprintf(stderr, " --isolate[=#]      run every codec and level in a process of its own, a crash, an error exit or a run\n");
+    fprintf(stderr, "                    longer than # seconds (default = no limit) gives a failed row instead of ending lzbench,\n");
+    fprintf(stderr, "                    show the peak RSS of the process\n");
+    fprintf(stderr, " --latency          show p50/p99/p99.9 latency of (de)compression of a single chunk (use with -b#)\n");
+    fprintf(stderr, " --llc-mon          show L3 occupancy in MB and DRAM bandwidth in GB/s of (de)compression from resctrl\n");
+    fprintf(stderr, "                    monitoring (Intel CMT/MBM, AMD L3 QoS, Linux, root)\n");
+    fprintf(stderr, " --llc-ways=#[,#...] run every test in a resctrl group (Intel CAT, Linux, root) with # ways of the L3 cache\n");
+    fprintf(stderr, "                    of every domain in turn and print a matrix of ratio and speed at every slice of the cache\n");
+    fprintf(stderr, " --load=#[,fixed|poisson][,#] open-loop server simulation: requests for the chunks of the test arrive\n");
+    fprintf(stderr, "                    at # per second with Poisson (default) or fixed gaps, -T# workers serve them in\n");
+    fprintf(stderr, "                    order, show p50/p99/p99.9 response time including queueing and busy time of workers\n");
+    fprintf(stderr, "                    for # (default = 10000) compression and as many decompression requests\n");
+    fprintf(stderr, " --load-threads=#   number of threads that read the files of -j (default = number of CPUs)\n");
+    fprintf(stderr, " --long-range[=#[,#]] rzip-style pre-pass before the codecs: repeats up to # MB (default = 4096) back\n");
+    fprintf(stderr, "                    found by a rolling hash of # bytes (default = 64) become references, the codecs get\n");
+    fprintf(stderr, "                    the residual, show pre-pass MB/s and memory and the effective ratio and speed\n");
+    fprintf(stderr, " --match-finders[=#[,#[,#]]] time only the match finders of libdeflate (ht, hc, bt), LZMA (hc4, hc5, bt2-4,\n");
+    fprintf(stderr, "                    bt4mt), xz (hc3, hc4, bt2-4) and fast-lzma2 (radix) at every position of each chunk: nice\n");
+    fprintf(stderr, "                    length (default = 32), depth (default = 32) and window in MB (default = 16), show positions/s,\n");
+    fprintf(stderr, "                    matches and their average length, -e is not used\n");
+    fprintf(stderr, " --mem-budget=#     keep the whole process within # MB: every codec and level of -e is probed on the start\n");
+    fprintf(stderr, "                    of each file, the file is run in the largest parts (as -m#) for which the buffers and the\n");
+    fprintf(stderr, "                    working sets of -T# threads of all of them fit, codecs that don't fit with 1 MB parts are skipped\n");
+    fprintf(stderr, " --memory           show memory of init, peak memory and allocations per call of (de)compression\n");
+    fprintf(stderr, "                    (only codecs with allocation hooks: brotli, bzip2, lzma, zlib, zstd)\n");
+    fprintf(stderr, " --mix[=#,#...]     give chunks of -b# (default = 64 KB) to all codecs of -e in turn, # chunks of each per turn\n");
+    fprintf(stderr, "                    (default = 1), in one timed loop on one core and show the speed of every codec next to its\n");
+    fprintf(stderr, "                    speed alone over the same chunks, the cost of sharing caches with the other codecs\n");
+    fprintf(stderr, " --mmap[=populate|willneed] read input files through mmap, optionally prefaulted\n");
+    fprintf(stderr, "                    with MAP_POPULATE or madvise(MADV_WILLNEED)\n");
+    fprintf(stderr, " --mmap-direct      benchmark straight from the page cache backed mapping (implies --mmap)\n");
+    fprintf(stderr, " --msg=#[,#...]|#-# small-message mode: the input is cut into messages of # bytes in turn or of uniformly\n");
+    fprintf(stderr, "                    random sizes in a range, each is a call with reused contexts, show ops/s, ns/op and\n");
+    fprintf(stderr, "                    compressed bytes/op, a pass over all messages is timed at once (replaces -b#)\n");
+    fprintf(stderr, " --msg-batch[=#,#...][,rate=#] compress the messages of --msg (default = 64-1024) # at a time in one\n");
+    fprintf(stderr, "                    call (default = 1,4,16,64), show compressed bytes and CPU ns per message and the\n");
+    fprintf(stderr, "                    latency added by waiting for the batch at an arrival rate of # messages/s (default\n");
+    fprintf(stderr, "                    = 10000) with the CPU share of a core that keeps up with it\n");
+    fprintf(stderr, " --no-batch         call compress and decompress for every chunk also for codecs with a batch entry point\n");
+    fprintf(stderr, "                    (lz4, zstd, nvcomp_lz4_batch), which otherwise get all chunks of a thread in one call\n");
+    fprintf(stderr, "                    (not with --latency, its percentiles are of single calls)\n");
+    fprintf(stderr, " --noise=stream|chase[,threads=#][,gbs=#][,size=#] time every test again with co-runner threads on the\n");
+    fprintf(stderr, "                    last CPUs (default = all that -T# leaves): stream copies a buffer of # MB (default = 64) at\n");
+    fprintf(stderr, "                    # GB/s of all of them (default = as fast as they go), chase follows random pointers through it\n");
+    fprintf(stderr, "                    and dirties the lines (LLC pollution), show the slowdown of the median pass against the quiet run\n");
+    fprintf(stderr, " --no-prune         with -s# test also higher levels of a codec after a level that was too slow\n");
+    fprintf(stderr, "                    (always done for lz4fast, lzrw and tornado)\n");
+    fprintf(stderr, " --offsets[=#,#...] run every test with input, compressed and decompressed data # bytes past a page boundary\n");
+    fprintf(stderr, "                    in turn and print a table of speed per offset (default = 0,1,2,3,4,8,16,32,63,4095)\n");
+    fprintf(stderr, " --page-cache=cold|warm drop pages of the input file from the page cache before every read of it\n");
+    fprintf(stderr, "                    by --mmap-direct or --pipeline or read all of them before, shown as Cache\n");
+    fprintf(stderr, " --pipeline=dir     show speed of reading the file, compression and writing to dir and of reading\n");
+    fprintf(stderr, "                    back, decompression and writing, synced to storage (--pipeline-direct = O_DIRECT)\n");
+    fprintf(stderr, " --parallel[=#][,nosmt][,spare] run different codecs and levels at once on # workers (default = one per\n");
+    fprintf(stderr, "                    core) pinned to their own cores with their own buffers, nosmt = one CPU of every core,\n");
+    fprintf(stderr, "                    spare = leave the first core of every package idle, rows are printed when all are done\n");
+    fprintf(stderr, " --pareto[=#]       print the rows not beaten in both ratio and (de)compression speed by any other row,\n");
+    fprintf(stderr, "                    with # (0-1) also for time = #*compression time + (1-#)*decompression time\n");
+    fprintf(stderr, " --pathological[=#] also benchmark generated inputs of # MB (default = 16) that degrade match finders: zero\n");
+    fprintf(stderr, "                    runs, a period of 7 bytes, near-duplicate 4 KB blocks and a de Bruijn sequence, and print\n");
+    fprintf(stderr, "                    their speed next to the speed of the files and the slowest compression against the files\n");
+    fprintf(stderr, "                    (the input files can be left out)\n");
+    fprintf(stderr, " --perf             show hardware counters per byte: cycles, IPC, LLC, branch and dTLB misses per KB\n");
+    fprintf(stderr, " --pinned[=alloc|register|both] page-lock the benchmark buffers for CUDA codecs with cudaMallocHost\n");
+    fprintf(stderr, "                    or cudaHostRegister, both = run all tests with pageable and pinned memory\n");
+    fprintf(stderr, " --plugin=path      load compressors from a shared object exporting lzbench_plugin() of plugin.h,\n");
+    fprintf(stderr, "                    they are used with -e and listed by -l given after it\n");
+    fprintf(stderr, "                    (make lzbench-system.so builds zstd[system] etc. of the shared libraries of the OS)\n");
+    fprintf(stderr, " --precheck[=entropy|lz4][,#] run every codec also with a test of samples of each chunk that stores\n");
+    fprintf(stderr, "                    it when the order-0 entropy is # bits per byte (default = 7.8) or the lz4 ratio\n");
+    fprintf(stderr, "                    is #%% (default = 97) or more, show skipped chunks and the compression speedup\n");
+    fprintf(stderr, " --predict[=file[,run]] show features of samples of every file (entropy, matches, text), with -o7 they are\n");
+    fprintf(stderr, "                    written for a model; with the -o7 output of such a run as file predict ratio and speed of\n");
+    fprintf(stderr, "                    its codecs from the nearest files without running codecs, run = also run and compare them\n");
+    fprintf(stderr, " --quiesce[=#]      noise-isolated runs (Linux): pin to CPU # (default = the last allowed one) with SCHED_FIFO\n");
+    fprintf(stderr, "                    and mlockall(), report busy SMT siblings, interrupts served by the CPU and a governor other\n");
+    fprintf(stderr, "                    than performance, the state is printed before the results and in the JSON run record\n");
+    fprintf(stderr, " --random-reads[=#] compress once into chunks of -b# and show latency and reads per second of\n");
+    fprintf(stderr, "                    decompression of # (default = 100000) chunks at random positions\n");
+    fprintf(stderr, " --range-reads[=#][,#...] compress the input up to a chunk of -b# with zstd_seekable or deflate_indexed as\n");
+    fprintf(stderr, "                    one object and show p50/p99 latency and read amplification (compressed bytes fetched per byte)\n");
+    fprintf(stderr, "                    of # (default = 10000) reads through its seek table or zran index of ranges of each size in KB\n");
+    fprintf(stderr, "                    (default = 4,64,1024), with the size of the index and the time to build it\n");
+    fprintf(stderr, " --results-cache=dir store rows of every compressor and level in dir and print the stored ones instead of\n");
+    fprintf(stderr, "                    running them again for the same input, chunk size, codec, level, options and lzbench binary\n");
+    fprintf(stderr, " --readahead=normal|sequential|random  readahead of --mmap and --pipeline (fadvise/madvise)\n");
+    fprintf(stderr, " --ratio-only[=verify] survey of ratios: a single compression pass of every codec and level without timing\n");
+    fprintf(stderr, "                    loops (and with =verify a single decompression that is checked), tests run in parallel on all\n");
+    fprintf(stderr, "                    cores (--parallel) unless -T# or a mode that needs the cores is given, speeds are shown as -\n");
+    fprintf(stderr, " --recommend[=cspeed=#,dspeed=#,mem=#,top=#,sample=#] run all codecs of -e once on a sample of\n");
+    fprintf(stderr, "                    # MB (default = 1/16 of the input) from all parts of it, then benchmark the # (default = 5)\n");
+    fprintf(stderr, "                    with the best ratio and speeds in MB/s and memory in MB within the limits\n");
+    fprintf(stderr, " --rotate=#         every call of a pass takes the next of # distinct chunks of -b# from the input instead of\n");
+    fprintf(stderr, "                    the same one, so branch predictors and prefetchers can't learn it, and show the change of speed\n");
+    fprintf(stderr, " --rusage           show CPU time of (de)compression passes from getrusage() including threads of MT codecs:\n");
+    fprintf(stderr, "                    cores busy, MB/s per core, kernel time in %%, minor faults per MB, major faults and voluntary\n");
+    fprintf(stderr, "                    and involuntary context switches per pass\n");
+    fprintf(stderr, " --sample=#[,seed]  benchmark # blocks of -b# from all files together, spread over files by size\n");
+    fprintf(stderr, "                    and over strata of every file at offsets chosen with seed (default = 1),\n");
+    fprintf(stderr, "                    show the 95%% confidence interval of the ratio of blocks (implies --stats)\n");
+    fprintf(stderr, " --sandbox[=strict|filter] also decompress the chunks of -b# in a child process locked in by seccomp\n");
+    fprintf(stderr, "                    strict mode (default) or a filter that allows memory allocation (Linux), with shared buffers\n");
+    fprintf(stderr, "                    and a round trip through pipes per chunk and for all chunks, show MB/s and per-call latency\n");
+    fprintf(stderr, "                    against the same calls in the process\n");
+    fprintf(stderr, " --search=cspeed=#,dspeed=#  for compressors without levels find by bisection of quick probes\n");
+    fprintf(stderr, "                    the highest level with compression and decompression speed over # MB/s\n");
+    fprintf(stderr, " --search=ratio=#   find the fastest level with ratio below #%% (may be combined with speeds)\n");
+    fprintf(stderr, " --setup            show the median time of init and deinit of a new context and of the first compression and\n");
+    fprintf(stderr, "                    decompression of a chunk with it (of 5 contexts of the codec, the first one is also in the\n");
+    fprintf(stderr, "                    CSV and JSON output as cold, with lazy initialization of a new process), to decide on pooling\n");
+    fprintf(stderr, " --soak=#[,#[,#]]   run every compressor for # hours (e.g. 0.5) on one thread over chunks of -b# in turn with\n");
+    fprintf(stderr, "                    verification and one context, every # s (default = 60) show speeds, RSS, heap and allocations\n");
+    fprintf(stderr, "                    of codecs with allocation functions and mismatches; flag drift of speeds and growth of memory\n");
+    fprintf(stderr, "                    beyond # %% (default = 10) of the first interval\n");
+    fprintf(stderr, " --spsc[=#]         a decoder thread decompresses chunks of -b# into a lock-free ring of # (default = 8) blocks\n");
+    fprintf(stderr, "                    and a consumer thread on another CPU runs --consume (default scan) on them, show pipelined\n");
+    fprintf(stderr, "                    MB/s against one thread and the cost of moving blocks between cores\n");
+    fprintf(stderr, " --sstable[=#[,#[,#]]] build a file of sorted records from lines of the input in blocks of # KB (default = 4)\n");
+    fprintf(stderr, "                    with restart points every # records (default = 16) and an index, compressed block by block,\n");
+    fprintf(stderr, "                    show p50/p99/p99.9 latency of point lookups, MB/s of scans of # records (default = 100)\n");
+    fprintf(stderr, "                    that decompress only the blocks they need and the size of the index\n");
+    fprintf(stderr, " --stream           with -m# read the next part while the current one is benchmarked\n");
+    fprintf(stderr, "                    and print one row for all parts of a file\n");
+    fprintf(stderr, " --streams=#[,#...] keep # streaming contexts (brotli, lz4, xz, zlib, zstd) of every job open at once\n");
+    fprintf(stderr, "                    (1k = 1000) and feed writes of --stream-write=# bytes (default = 1024) with a flush\n");
+    fprintf(stderr, "                    to contexts picked at random, show resident KB per context, contexts per GB, MB/s\n");
+    fprintf(stderr, "                    and LLC misses per KB as the number of contexts grows\n");
+    fprintf(stderr, " --stats            show standard deviation and 95%% confidence interval of iterations in %%,\n");
+    fprintf(stderr, "                    slow outliers are rejected also for -p2 and -p3\n");
+    fprintf(stderr, " --statsd=host[:port][,prefix] push progress (iterations and MB/s of the running codec and level) and\n");
+    fprintf(stderr, "                    results (MB/s and ratio) as StatsD gauges with DogStatsD tags over UDP (default port = 8125,\n");
+    fprintf(stderr, "                    prefix = lzbench) to watch long runs while they go\n");
+    fprintf(stderr, " --stdin-size=#     read only # MB of input - (stdin) and benchmark them, without it stdin is read\n");
+    fprintf(stderr, "                    until its end, with -m# every # MB of stdin are benchmarked as a part\n");
+    fprintf(stderr, " --summary          after the results print every compressor over all files: total ratio, MB/s of the total\n");
+    fprintf(stderr, "                    size (size-weighted), geometric mean of MB/s of the files and MB/s of the slowest file\n");
+    fprintf(stderr, " --timeline=file    write Chrome trace events (chrome://tracing, ui.perfetto.dev) of every compress and decompress\n");
+    fprintf(stderr, "                    call of a chunk and every pass per thread, init and deinit, verification, sleeps and reads of\n");
+    fprintf(stderr, "                    inputs, a timeline of stalls, imbalance and overlap of threads (up to 4M events)\n");
+    fprintf(stderr, " --timer=tsc|clock  time with the invariant TSC on x86 or CNTVCT_EL0 on aarch64 calibrated at startup\n");
+    fprintf(stderr, "                    instead of clock_gettime(CLOCK_MONOTONIC) (default = clock)\n");
+    fprintf(stderr, " --topdown          with --perf also the top-down breakdown of the slots of the core in %% (frontend bound,\n");
+    fprintf(stderr, "                    bad speculation, memory and core bound, retiring) on Intel Skylake to Sapphire Rapids\n");
+    fprintf(stderr, "                    and AMD Zen 4/5\n");
+    fprintf(stderr, " --trace=file       replay records \"c|d size [offset]\" of a file in order: compression or decompression of\n");
+    fprintf(stderr, "                    size bytes of the input at offset or after the previous record, records are cut to -b#,\n");
+    fprintf(stderr, "                    show records/s, MB/s and p50/p99/p99.9 latency of both operations\n");
+    fprintf(stderr, " --transcode=codec[,#] also decompress the output of codec (level #) and compress it again with every\n");
+    fprintf(stderr, "                    compressor of -e, as separate passes and fused chunk by chunk on one and on -T# threads,\n");
+    fprintf(stderr, "                    show MB/s of the input and the CPU time of fused against separate passes\n");
+    fprintf(stderr, " --transfer[=#,...] after the results print the time of compression, sending the compressed data over links\n");
+    fprintf(stderr, "                    of # Gbit/s and decompression for every row and for the uncompressed input, the fastest row\n");
+    fprintf(stderr, "                    of every link is marked by * (default = 1,10,100)\n");
+    fprintf(stderr, " --ttfb[=#,...]     time to first byte of streaming decompression (brotli, lz4, lz4frame, xz, zlib, zstd):\n");
+    fprintf(stderr, "                    median over chunks of -b# of the time from the first compressed byte until # KB of output\n");
+    fprintf(stderr, "                    exist (default = 4,64), codecs with big headers or a whole-block entropy stage stand out\n");
+    fprintf(stderr, " --tune=zstd[,#[,#]] search compression parameters of zstd (wlog, clog, hlog, slog, mml, tlen and\n");
+    fprintf(stderr, "                    strategy) around level # (default = 3) with moves of one parameter at a time, taking the best\n");
+    fprintf(stderr, "                    ratio at compression speed >= # MB/s (default = that of the level), in probes of the first 16 MB;\n");
+    fprintf(stderr, "                    prints the Pareto set of ratio and speed of the probes and benchmarks the level and the best ones\n");
+    fprintf(stderr, " --uring[=#]        --pipeline with io_uring (Linux), # reads are kept in flight and as many\n");
+    fprintf(stderr, "                    writes overlap (de)compression (default = 8)\n");
+    fprintf(stderr, " --warmup=#[ms]     run # passes or passes for # ms of compression and of decompression that aren't recorded\n");
+    fprintf(stderr, "                    before the samples and show the time of the first pass (first-use latency)\n");
+    fprintf(stderr, " --zram[=#]         also store the input like zram and zswap in pages of # KB (default = 4): zero-filled and\n");
+    fprintf(stderr, "                    same-value pages are elided, the others compressed one by one, show pages/s of stores\n");
+    fprintf(stderr, "                    and loads and the sizes of compressed pages (e.g. -ezram on a core dump)\n");
+    fprintf(stderr, " --steal            threads steal chunks from each other (default with -j, --no-steal disables)\n");
+    fprintf(stderr, " --pin=core|node    pin threads to single cores or to all cores of a NUMA node\n");
+    fprintf(stderr, " --numa=local|interleave|remote  move slices of buffers to the node of a thread,\n");
+    fprintf(stderr, "                    interleave them over all nodes or move them to the next node\n");
+    fprintf(stderr, " --placement[=#:#:#,...] also run the chunks on one thread with the input, compressed and decompressed\n");
+    fprintf(stderr, "                    buffers on the memory nodes # (- = left where they are, CPU-less CXL or HBM nodes too),\n");
+    fprintf(stderr, "                    show MB/s and us per chunk of every combination (default = all of the memory nodes)\n");
+    fprintf(stderr, " --blosclzmt=#[,#[,#[,#]]] threads of blosclzmt (default = number of CPUs), element size (default = 4),\n");
+    fprintf(stderr, "                    shuffle 0=none 1=byte 2=bit (default = 1) and block size in KB (default = by level)\n");
+    fprintf(stderr, " --pbzip2=#         threads of pbzip2 (default = number of CPUs)\n");
+    fprintf(stderr, " --pdeflate=#[,#]   threads of pdeflate and pdeflate_pigz (default = number of CPUs) and block size in KB\n");
+    fprintf(stderr, "                    (default = 128, at least 32), the output is checked with the gzip decoder of zlib\n");
+    fprintf(stderr, " --cuda-streams=#[,#] run nvcomp_lz4 in slices of # MB (default = 4) pipelined over # CUDA streams,\n");
+    fprintf(stderr, "                    uploads overlap kernels and downloads, show kernel and transfer speed\n");
+    fprintf(stderr, " --gpus=#|all       split the chunks of each batch of nvcomp_lz4_batch over # CUDA devices, each with its\n");
+    fprintf(stderr, "                    own stream and buffers, show the slowest and the fastest device, list their peer links\n");
+    fprintf(stderr, " --hybrid=#         lz4 threads of nvcomp_lz4_hybrid next to the GPU (default = number of CPUs - 1)\n");
+    fprintf(stderr, "                    and show the share of the input done by the GPU\n");
+    fprintf(stderr, " --offload-depth=#  jobs of a batch of qpl_deflate in flight on the accelerator (default = 16),\n");
+    fprintf(stderr, "                    with --no-batch every chunk is submitted and waited for alone, the CPU time of the\n");
+    fprintf(stderr, "                    host is shown by --rusage or --ingest\n");
+    fprintf(stderr, " --offload-decoder=native|libdeflate|zlib decoder of the deflate streams of qpl_deflate and qatzip\n");
+    fprintf(stderr, "                    (default = native, the accelerator)\n");
+    fprintf(stderr, " --fastlzma2mt=#    threads of fastlzma2mt compression and decompression (default = number of CPUs)\n");
+    fprintf(stderr, " --lz-stats         show the LZ77 parse of lz4, lz4fast, lz4hc and zstd codecs after the results: literal bytes\n");
+    fprintf(stderr, "                    in %% of the input, number and mean length of matches, matches at one of the 3 previous offsets\n");
+    fprintf(stderr, "                    (repeats) and distributions of match lengths and offsets\n");
+    fprintf(stderr, " --lz4-block=#      size in KB of linked blocks of lz4stream, lz4frame and lz4framecrc (default = 64)\n");
+    fprintf(stderr, " --lzhammt=#        helper threads of lzhammt compression (default = number of CPUs - 1)\n");
+    fprintf(stderr, " --lzmamt=#[,#]     block threads of lzmamt (default = 1, only the match finder thread) and block\n");
+    fprintf(stderr, "                    size in MB (default = input split between the threads)\n");
+    fprintf(stderr, " --xzmt=#[,#]       threads of xzmt (default = number of CPUs) and block size in MB (default = xz), blocks\n");
+    fprintf(stderr, "                    are decompressed in parallel too and the scaling of decompression is shown\n");
+    fprintf(stderr, " --zran=#           MB of output between access points of the zran index of gzip streams of --range-reads\n");
+    fprintf(stderr, "                    (deflate_indexed, or a gzip file with --decompress-only), default = 1\n");
+    fprintf(stderr, " --zstd-trace       split the time of compression of zstd frames into match finding, Huffman coding of literals,\n");
+    fprintf(stderr, "                    FSE coding of sequences and the rest (setup, headers, raw blocks) in %% with hooks of zstd_trace.h\n");
+    fprintf(stderr, " --zstdmt=#[,#[,#]] workers of zstdmt (default = 4), job size in MB and overlap log 0-9 (default = zstd)\n");
     fprintf(stderr,"\nExample usage:\n");
     fprintf(stderr,"  " PROGNAME " -ezstd filename = selects all levels of zstd\n");
     fprintf(stderr,"  " PROGNAME " -ebrotli,2,5/zstd filename = selects levels 2 & 5 of brotli and zstd\n");
+    fprintf(stderr,"  " PROGNAME " -ezstd,19:wlog=27:strategy=btultra2 filename = zstd -19 with options\n");
+    fprintf(stderr,"  " PROGNAME " -edelta4+bitshuffle+lz4/shuffle4+zstd,3 filename = codecs after filters, also filters alone\n");
+    fprintf(stderr,"  " PROGNAME " -emt8:brotli,7 -b0 filename = brotli -7 on 8 threads for one chunk, against brotli -7 alone\n");
     fprintf(stderr,"  " PROGNAME " -t3 -u5 fname = 3 sec compression and 5 sec decompression loops\n");
     fprintf(stderr,"  " PROGNAME " -t0 -u0 -i3 -j5 -ezstd fname = 3 compression and 5 decompression iter.\n");
     fprintf(stderr,"  " PROGNAME " -t0u0i3j5 -ezstd fname = the same as above with aggregated parameters\n");
@@ -786,17 +16096,159 @@ char* cpu_brand_string(void)
 }
 
 
+void lzbench_default_params(lzbench_params_t* params)
+{
+    *params = lzbench_params_t(); // zeroed, not memset() because of the strings and vectors
+    params->timetype = FASTEST;
+    params->textformat = TEXT;
+    params->show_speed = 1;
+    params->verbose = 2;
+    params->chunk_size = LIMIT_2G;
+    params->cspeed = 0;
+    params->c_iters = params->d_iters = 1;
+    params->cmintime = 10*DEFAULT_LOOP_TIME/1000000; // 1 sec
+    params->dmintime = 20*DEFAULT_LOOP_TIME/1000000; // 2 sec
+    params->cloop_time = params->dloop_time = DEFAULT_LOOP_TIME;
+    params->threads = params->max_threads = 1;
+    params->cold_size = 256 << 20;
+    params->recommend_top = 5;
+    cgroup_init();
+    params->load_threads = lzbench_cpus();
+#if defined(BENCH_HAS_NVCOMP) && !defined(BENCH_REMOVE_LZ4)
+    lzbench_hybrid_threads = MAX(params->load_threads - 1, 1);
+#endif
+#ifndef BENCH_REMOVE_BLOSCLZ
+    lzbench_blosclzmt_threads = params->load_threads;
+#endif
+#ifndef BENCH_REMOVE_BZIP2
+    lzbench_pbzip2_threads = params->load_threads;
+#endif
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+    lzbench_pdeflate_threads = params->load_threads;
+#endif
+#ifndef BENCH_REMOVE_XZ
+    lzbench_xzmt_threads = params->load_threads;
+#endif
+#ifndef BENCH_REMOVE_FASTLZMA2
+    lzbench_fastlzma2mt_threads = params->load_threads;
+#endif
+#ifndef BENCH_REMOVE_LZHAM
+    lzbench_lzhammt_threads = MAX(params->load_threads - 1, 1);
+#endif
+    params->ci_maxtime = 30*1000; // 30 sec
+    params->speed_threshold = 5;
+    params->pareto_weight = -1;
+    params->rounds = 5;
+    params->ratio_threshold = 0.1;
+    params->thread_counts[0] = 1;
+    params->thread_counts_nb = 1;
+}
+
+
+/* liblzbench.h */
+extern "C" void lzbench_bench_defaults(lzbench_bench_params_t* bench)
+{
+    lzbench_params_t params;
+    lzbench_default_params(&params);
+    bench->c_iters = params.c_iters;
+    bench->d_iters = params.d_iters;
+    bench->cmintime_ms = params.cmintime;
+    bench->dmintime_ms = params.dmintime;
+    bench->chunk_size = params.chunk_size;
+    bench->threads = 1;
+    bench->timetype = params.timetype;
+    bench->verbose = 0;
+}
+
+
+extern "C" int lzbench_bench(const void* data, size_t size, const char* codecs, const lzbench_bench_params_t* bench, lzbench_result_t* results, size_t max_results)
+{
+    lzbench_params_t lzparams, *params = &lzparams;
+    lzbench_bench_params_t defaults;
+    bench_rate_t rate;
+    std::vector<size_t> file_sizes(1, size);
+
+    if (!bench) lzbench_bench_defaults(&defaults), bench = &defaults;
+    lzbench_default_params(params);
+    params->library = 1;
+    params->verbose = bench->verbose;
+    params->c_iters = MAX(bench->c_iters, 1u);
+    params->d_iters = MAX(bench->d_iters, 1u);
+    params->cmintime = bench->cmintime_ms;
+    params->dmintime = bench->dmintime_ms;
+    params->cloop_time = params->cmintime ? DEFAULT_LOOP_TIME : 0;
+    params->dloop_time = params->dmintime ? DEFAULT_LOOP_TIME : 0;
+    params->chunk_size = bench->chunk_size ? bench->chunk_size : NO_LIMIT;
+    params->threads = params->max_threads = params->thread_counts[0] = MIN(MAX(bench->threads, 1), MAX_THREADS);
+    if (bench->timetype >= FASTEST && bench->timetype <= MEDIAN) params->timetype = (timetype_e)bench->timetype;
+    params->in_filename = "memory";
+
+    size_t comprsize = GET_COMPRESS_BOUND(size) + (params->max_threads-1)*PAD_SIZE;
+    uint8_t *inbuf = (uint8_t*)alloc_and_touch(size + PAD_SIZE, false);
+    uint8_t *compbuf = (uint8_t*)alloc_untouched(comprsize);
+    uint8_t *decomp = (uint8_t*)alloc_and_touch(size + PAD_SIZE, true);
+    if (!inbuf || !compbuf || !decomp)
+    {
+        free_touched(inbuf); free_touched(compbuf); free_touched(decomp);
+        return -1;
+    }
+    memcpy(inbuf, data, size); // the codecs get the padding of lzbench after the input
+
+    InitTimer(rate);
+    lzbench_run_tests(params, file_sizes, codecs ? codecs : alias_desc[0].params, inbuf, size, compbuf, comprsize, decomp, rate);
+    free_touched(inbuf);
+    free_touched(compbuf);
+    free_touched(decomp);
+
+    std::vector<string_table_t> &res = params->results;
+    for (size_t i=0; i<res.size() && i<max_results; i++)
+    {
+        lzbench_result_t &r = results[i];
+        memset(&r, 0, sizeof(r));
+        snprintf(r.name, sizeof(r.name), "%s", res[i].col1_algname.c_str());
+        snprintf(r.codec, sizeof(r.codec), "%s", res[i].name.c_str());
+        snprintf(r.version, sizeof(r.version), "%s", res[i].version.c_str());
+        r.level = res[i].level;
+        r.insize = res[i].col5_origsize;
+        r.outsize = res[i].col4_comprsize;
+        r.ctime_ns = res[i].col2_ctime;
+        r.dtime_ns = res[i].col3_dtime;
+        r.cspeed = r.ctime_ns ? r.insize * 1000.0 / r.ctime_ns : 0;
+        r.dspeed = r.dtime_ns ? r.insize * 1000.0 / r.dtime_ns : 0;
+        r.error = !res[i].checksum && !res[i].unmeasured && !r.dtime_ns;
+    }
+    int count = (int)res.size();
+    res.clear();
+    return count;
+}
+
+
+extern "C" int lzbench_codecs(lzbench_codec_t* codecs, size_t max_codecs)
+{
+    for (int i=0; i<codec_count() && (size_t)i<max_codecs; i++)
+    {
+        codecs[i].name = codec_desc(i)->name;
+        codecs[i].version = codec_desc(i)->version;
+        codecs[i].first_level = codec_desc(i)->first_level;
+        codecs[i].last_level = codec_desc(i)->last_level;
+    }
+    return codec_count();
+}
+
+
+#ifndef LZBENCH_LIBRARY
 int main( int argc, char** argv)
 {
-    FILE *in;
     char* encoder_list = NULL;
     int result = 0, sort_col = 0, real_time = 1;
+    std::vector<string_table_t> baseline;
     lzbench_params_t lzparams;
     lzbench_params_t* params = &lzparams;
     const char** inFileNames = (const char**) calloc(argc, sizeof(char*));
     unsigned ifnIdx = 0;
     bool join = false;
-    char* cpu_brand;
+    char* cpu_brand = NULL;
+    bench_rate_t rate;
 #ifdef UTIL_HAS_CREATEFILELIST
     const char** extendedFileList = NULL;
     char* fileNamesBuf = NULL;
@@ -808,22 +16260,630 @@ int main( int argc, char** argv)
         return 1;
     }
 
-    memset(params, 0, sizeof(lzbench_params_t));
-    params->timetype = FASTEST;
-    params->textformat = TEXT;
-    params->show_speed = 1;
-    params->verbose = 2;
-    params->chunk_size = (1ULL << 31) - (1ULL << 31)/6;
-    params->cspeed = 0;
-    params->c_iters = params->d_iters = 1;
-    params->cmintime = 10*DEFAULT_LOOP_TIME/1000000; // 1 sec
-    params->dmintime = 20*DEFAULT_LOOP_TIME/1000000; // 2 sec
-    params->cloop_time = params->dloop_time = DEFAULT_LOOP_TIME;
+    InitTimer(rate);
+#if defined(__linux__)
+    if (argc == 7 && !strcmp(argv[1], "--cold-start-child")) return lzbench_cold_child(argv + 2, rate);
+#endif
+    lzbench_default_params(params);
 
 
-    while ((argc>1) && (argv[1][0]=='-')) {
+    while ((argc>1) && (argv[1][0]=='-') && argv[1][1]) { // "-" is stdin
     char* argument = argv[1]+1;
+    if (!strchr("eocv", argument[0]) && strncmp(argument, "-results-cache=", 15) && strncmp(argument, "-statsd=", 8) && strncmp(argument, "-baseline=", 10) && strncmp(argument, "-predict", 8))
+        params->results_settings += std::string(" ") + argv[1]; // options that change results are a part of the key of --results-cache
     if (!strcmp(argument, "-compress-only")) params->compress_only = 1;
+    else if (!strcmp(argument, "-decompress-only")) params->decompress_only = 1;
+    else if (!strncmp(argument, "-cache=", 7)) params->cache_dir = argument+7;
+    else if (!strncmp(argument, "-results-cache=", 15)) params->results_cache = argument+15;
+    else if (!strcmp(argument, "-perf")) params->perf_counters = 1;
+    else if (!strcmp(argument, "-topdown")) params->perf_counters = params->topdown = 1;
+    else if (!strcmp(argument, "-rusage")) params->rusage = 1;
+    else if (!strcmp(argument, "-bandwidth")) params->bandwidth = 1;
+    else if (!strcmp(argument, "-calibrate") || !strcmp(argument, "-calibrate=memcpy")) params->calibrate = CALIBRATE_MEMCPY;
+    else if (!strcmp(argument, "-calibrate=alu")) params->calibrate = CALIBRATE_ALU;
+    else if (!strcmp(argument, "-energy")) params->energy = 1;
+    else if (!strcmp(argument, "-llc-mon")) params->llc_mon = 1;
+    else if (!strncmp(argument, "-pipeline=", 10)) params->pipeline_dir = argument+10;
+    else if (!strcmp(argument, "-pipeline-direct")) params->pipeline_direct = 1;
+    else if (!strcmp(argument, "-uring")) params->uring_depth = 8;
+    else if (!strncmp(argument, "-uring=", 7)) params->uring_depth = MAX(atoi(argument+7), 1);
+    else if (!strcmp(argument, "-quiesce")) params->quiesce = 1, params->quiesce_cpu = -1;
+    else if (!strncmp(argument, "-quiesce=", 9)) params->quiesce = 1, params->quiesce_cpu = atoi(argument+9);
+    else if (!strcmp(argument, "-fuzz")) params->fuzz_cases = 1000, params->fuzz_timeout_ms = 1000;
+    else if (!strncmp(argument, "-fuzz=", 6))
+    {
+        std::vector<std::string> terms = split(argument+6, ',');
+        params->fuzz_cases = atoi(terms[0].c_str());
+        params->fuzz_timeout_ms = terms.size() > 1 ? atoi(terms[1].c_str()) : 1000;
+        if (!params->fuzz_cases || !params->fuzz_timeout_ms) { fprintf(stderr, "wrong --fuzz: %s\n", argument+6); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-freq")) params->freq_threshold = 10;
+    else if (!strncmp(argument, "-freq=", 6)) params->freq_threshold = atof(argument+6);
+    else if (!strcmp(argument, "-cold-start") || !strncmp(argument, "-cold-start=", 12))
+    {
+#if defined(__linux__)
+        params->cold_start = argument[11] ? MAX(atoi(argument+12), 1) : 10;
+#else
+        fprintf(stderr, "warning: --cold-start is supported only on Linux\n");
+#endif
+    }
+    else if (!strcmp(argument, "-isolate")) params->isolate = 1;
+    else if (!strncmp(argument, "-isolate=", 9)) { params->isolate = 1; params->isolate_timeout = atoi(argument+9); }
+    else if (!strncmp(argument, "-parallel", 9) && (!argument[9] || argument[9] == '=' || argument[9] == ','))
+    {
+        std::vector<std::string> terms = split(argument[9] ? argument+10 : "", ',');
+        params->parallel = -1;
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (terms[k].empty()) continue;
+            else if (terms[k] == "nosmt") params->parallel_nosmt = true;
+            else if (terms[k] == "spare") params->parallel_spare = true;
+            else if (atoi(terms[k].c_str()) > 0) params->parallel = atoi(terms[k].c_str());
+            else { fprintf(stderr, "wrong --parallel: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+        }
+    }
+    else if (!strcmp(argument, "-mix") || !strncmp(argument, "-mix=", 5)) {
+        std::vector<std::string> terms = split(argument[4] ? argument+5 : "", ',');
+        params->mix = 1;
+        params->mix_weights.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (terms[k].empty() && terms.size() == 1) break;
+            int w = atoi(terms[k].c_str());
+            if (w < 1) { fprintf(stderr, "wrong --mix weight: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->mix_weights.push_back(w);
+        }
+    }
+    else if (!strncmp(argument, "-streams=", 9)) {
+        std::vector<std::string> terms = split(argument+9, ',');
+        params->stream_counts.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            char* end;
+            unsigned long long n = strtoull(terms[k].c_str(), &end, 10);
+            if (*end == 'k' || *end == 'K') n *= 1000, end++;
+            if (!n || *end) { fprintf(stderr, "wrong --streams: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->stream_counts.push_back(n);
+        }
+    }
+    else if (!strncmp(argument, "-stream-write=", 14)) params->stream_write = MAX(atoi(argument+14), 1);
+    else if (!strcmp(argument, "-interleave")) params->interleave = 1;
+    else if (!strcmp(argument, "-isa")) params->show_isa = 1;
+    else if (!strncmp(argument, "-plugin=", 8)) { if (!lzbench_load_plugin(argument+8)) { result = 1; goto _clean; } }
+    else if (!strcmp(argument, "-interleave=random")) params->interleave = 2;
+    else if (!strncmp(argument, "-rounds=", 8)) params->rounds = atoi(argument+8);
+    else if (!strcmp(argument, "-latency")) params->latency = 1;
+    else if (!strncmp(argument, "-mem-budget=", 12)) {
+        params->mem_budget = (size_t)atoi(argument+12) << 20;
+        if (params->textformat == TEXT) params->textformat = TEXT_FULL; // as -m#
+    }
+    else if (!strcmp(argument, "-memory")) params->memory = 1;
+    else if (!strcmp(argument, "-mmap")) params->mmap_mode = MMAP_READ;
+    else if (!strcmp(argument, "-hugepages") || !strcmp(argument, "-hugepages=thp")) params->hugepages = HUGE_THP;
+    else if (!strcmp(argument, "-hugepages=hugetlb")) params->hugepages = HUGE_TLB;
+    else if (!strncmp(argument, "-precheck", 9) && (argument[9] == 0 || argument[9] == '=')) {
+        const char* arg = argument[9] ? argument+10 : "entropy";
+        params->precheck = !strncmp(arg, "lz4", 3) ? PRECHECK_LZ4 : PRECHECK_ENTROPY;
+        params->precheck_threshold = params->precheck == PRECHECK_LZ4 ? 97 : 7.8f;
+        if ((arg = strchr(arg, ','))) params->precheck_threshold = atof(arg+1);
+#ifdef BENCH_REMOVE_LZ4
+        if (params->precheck == PRECHECK_LZ4) { fprintf(stderr, "--precheck=lz4 needs lz4\n"); params->precheck = PRECHECK_NONE; }
+#endif
+    }
+    else if (!strcmp(argument, "-hugepages=both")) { params->hugepages = HUGE_THP; params->hugepages_both = 1; }
+#ifdef BENCH_HAS_CUDA
+    else if (!strcmp(argument, "-pinned") || !strcmp(argument, "-pinned=alloc")) params->pinned = HOST_PINNED;
+    else if (!strcmp(argument, "-pinned=register")) params->pinned = HOST_REGISTERED;
+    else if (!strcmp(argument, "-pinned=both")) { params->pinned = HOST_PINNED; params->pinned_both = 1; }
+#endif
+    else if (!strcmp(argument, "-mmap=populate")) params->mmap_mode = MMAP_POPULATE;
+    else if (!strcmp(argument, "-mmap=willneed")) params->mmap_mode = MMAP_WILLNEED;
+    else if (!strcmp(argument, "-mmap-direct")) params->mmap_direct = 1;
+    else if (!strcmp(argument, "-iovec")) params->iovec_min = 4096, params->iovec_max = 65536, params->iovec_align = 64;
+    else if (!strncmp(argument, "-iovec=", 7)) {
+        std::vector<std::string> terms = split(argument+7, ',');
+        const char* dash = strchr(terms[0].c_str(), '-');
+        params->iovec_min = MAX(atoll(terms[0].c_str()), 1);
+        params->iovec_max = dash ? MAX((size_t)atoll(dash+1), params->iovec_min) : params->iovec_min;
+        params->iovec_align = terms.size() > 1 ? atoll(terms[1].c_str()) : 64;
+        if (!params->iovec_align || (params->iovec_align & (params->iovec_align - 1))) { fprintf(stderr, "wrong --iovec alignment: %s\n", terms[1].c_str()); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-append=", 8)) {
+        std::vector<std::string> terms = split(argument+8, ',');
+        params->append_size = MAX(atoi(terms[0].c_str()), 1);
+        params->append_records = terms.size() > 1 ? atoi(terms[1].c_str()) : 0;
+        params->append_bytes = terms.size() > 2 ? atoi(terms[2].c_str()) : 0;
+    }
+    else if (!strncmp(argument, "-bestof=", 8)) params->bestof = argument+8;
+    else if (!strncmp(argument, "-feed=", 6)) {
+        params->feed_write = MAX(atoi(argument+6), 1);
+        const char* flush = strchr(argument+6, ',');
+        params->feed_flush = flush ? atoi(flush+1) : 0;
+    }
+    else if (!strcmp(argument, "-alloc=malloc")) params->alloc = ALLOC_MALLOC;
+    else if (!strcmp(argument, "-fresh-output")) params->fresh_output = FRESH_OUTPUT, fresh_output_mode = 1;
+    else if (!strcmp(argument, "-fresh-output=both")) params->fresh_output = FRESH_BOTH;
+    else if (!strcmp(argument, "-alloc=arena")) params->alloc = ALLOC_ARENA, lzbench_mem_arena = 1;
+    else if (!strcmp(argument, "-alloc=both")) params->alloc = ALLOC_BOTH;
+    else if (!strcmp(argument, "-contexts=reuse")) params->contexts = CONTEXTS_REUSE;
+    else if (!strcmp(argument, "-contexts=percall")) params->contexts = CONTEXTS_PERCALL, lzbench_context_reuse = 0;
+    else if (!strcmp(argument, "-contexts=both")) params->contexts = CONTEXTS_BOTH;
+    else if (!strcmp(argument, "-page-cache=cold")) params->page_cache = PAGECACHE_COLD;
+    else if (!strcmp(argument, "-page-cache=warm")) params->page_cache = PAGECACHE_WARM;
+    else if (!strcmp(argument, "-readahead=normal")) params->readahead = READAHEAD_NORMAL;
+    else if (!strcmp(argument, "-readahead=sequential") || !strcmp(argument, "-readahead=seq")) params->readahead = READAHEAD_SEQUENTIAL;
+    else if (!strcmp(argument, "-readahead=random")) params->readahead = READAHEAD_RANDOM;
+    else if (!strcmp(argument, "-stream")) params->stream = 1;
+    else if (!strcmp(argument, "-stats")) params->stats = 1;
+    else if (!strcmp(argument, "-timer=tsc")) params->timer_tsc = 1;
+    else if (!strncmp(argument, "-search=", 8))
+    {
+        std::vector<std::string> terms = split(argument+8, ',');
+        params->search = 1;
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (!strncmp(terms[k].c_str(), "cspeed=", 7)) params->search_cspeed = atof(terms[k].c_str()+7);
+            else if (!strncmp(terms[k].c_str(), "dspeed=", 7)) params->search_dspeed = atof(terms[k].c_str()+7);
+            else if (!strncmp(terms[k].c_str(), "ratio=", 6)) params->search_ratio = atof(terms[k].c_str()+6);
+            else { fprintf(stderr, "unknown --search constraint: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+        }
+    }
+    else if (!strcmp(argument, "-ratio-only")) params->ratio_only = 1;
+    else if (!strcmp(argument, "-ratio-only=verify")) params->ratio_only = 2;
+    else if (!strcmp(argument, "-recommend") || !strncmp(argument, "-recommend=", 11))
+    {
+        std::vector<std::string> terms = split(argument[10] ? argument+11 : "", ',');
+        params->recommend = 1;
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (!strncmp(terms[k].c_str(), "cspeed=", 7)) params->recommend_cspeed = atof(terms[k].c_str()+7);
+            else if (!strncmp(terms[k].c_str(), "dspeed=", 7)) params->recommend_dspeed = atof(terms[k].c_str()+7);
+            else if (!strncmp(terms[k].c_str(), "mem=", 4)) params->recommend_memory = atof(terms[k].c_str()+4);
+            else if (!strncmp(terms[k].c_str(), "top=", 4)) params->recommend_top = MAX(atoi(terms[k].c_str()+4), 1);
+            else if (!strncmp(terms[k].c_str(), "sample=", 7)) params->recommend_sample = (size_t)(atof(terms[k].c_str()+7) * (1 << 20));
+            else if (!terms[k].empty()) { fprintf(stderr, "unknown --recommend constraint: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+        }
+    }
+    else if (!strncmp(argument, "-sample=", 8))
+    {
+        const char* arg = strchr(argument+8, ',');
+        params->sample_blocks = MAX(atoi(argument+8), 1);
+        params->sample_seed = arg ? strtoul(arg+1, NULL, 10) : 1;
+        params->stats = 1;
+    }
+    else if (!strcmp(argument, "-core-types")) params->per_core_type = 1;
+    else if (!strncmp(argument, "-llc-ways=", 10))
+    {
+        std::vector<std::string> terms = split(argument+10, ',');
+        params->llc_ways.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (atoi(terms[k].c_str()) < 1) { fprintf(stderr, "wrong --llc-ways: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->llc_ways.push_back(atoi(terms[k].c_str()));
+        }
+    }
+    else if (!strcmp(argument, "-offsets") || !strncmp(argument, "-offsets=", 9))
+    {
+        std::vector<std::string> terms = split(argument[8] ? argument+9 : "0,1,2,3,4,8,16,32,63,4095", ',');
+        params->buf_offsets.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            char* end;
+            unsigned long long off = strtoull(terms[k].c_str(), &end, 10);
+            if (terms[k].empty() || *end || off > (1 << 20)) { fprintf(stderr, "wrong --offsets: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            if (std::find(params->buf_offsets.begin(), params->buf_offsets.end(), off) == params->buf_offsets.end()) params->buf_offsets.push_back(off);
+        }
+    }
+    else if (!strncmp(argument, "-dthreads=", 10))
+    {
+        std::vector<std::string> terms = split(argument+10, ',');
+        params->dthread_counts_nb = 0;
+        for (size_t k=0; k<terms.size() && params->dthread_counts_nb < MAX_THREAD_COUNTS; k++)
+        {
+            int count = atoi(terms[k].c_str());
+            if (count < 1 || count > MAX_THREADS) { fprintf(stderr, "wrong --dthreads count: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->dthread_counts[params->dthread_counts_nb++] = count;
+        }
+    }
+    else if (!strcmp(argument, "-no-prune")) params->no_prune = 1;
+    else if (!strcmp(argument, "-no-batch")) params->no_batch = 1;
+    else if (!strcmp(argument, "-gen") || !strncmp(argument, "-gen=", 5))
+    {
+        gen_spec_t gen;
+        std::string name = std::string("gen:") + (argument[4] ? argument+5 : "lz");
+        if (!gen_parse(name.c_str()+4, gen)) { fprintf(stderr, "wrong --gen: %s\n", name.c_str()+4); result = 1; goto _clean; }
+        inFileNames[ifnIdx++] = params->gen_inputs.insert(name).first->c_str(); // before the files
+    }
+    else if (!strcmp(argument, "-pathological")) params->pathological_size = 16 << 20;
+    else if (!strncmp(argument, "-pathological=", 14))
+    {
+        params->pathological_size = (size_t)atoi(argument+14) << 20;
+        if (!params->pathological_size) { fprintf(stderr, "wrong --pathological: %s\n", argument+14); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-pareto")) params->pareto = 1;
+    else if (!strncmp(argument, "-pareto=", 8)) { params->pareto = 1; params->pareto_weight = MIN(1, MAX(0, atof(argument+8))); }
+    else if (!strcmp(argument, "-summary")) params->summary = 1;
+    else if (!strcmp(argument, "-transfer") || !strncmp(argument, "-transfer=", 10) || !strncmp(argument, "-cost=", 6))
+    {
+        std::vector<std::string> terms;
+        if (argument[1] == 'c')
+        {
+            std::vector<std::string> costs = split(argument+6, ',');
+            params->cost_gb = atof(costs[0].c_str());
+            params->cost_core_hour = costs.size() > 1 ? atof(costs[1].c_str()) : 0;
+        }
+        else
+        {
+            params->link_gbits.clear();
+            if (argument[9]) terms = split(argument+10, ',');
+        }
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (atof(terms[k].c_str()) <= 0) { fprintf(stderr, "wrong link speed: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->link_gbits.push_back(atof(terms[k].c_str()));
+        }
+        if (params->link_gbits.empty()) params->link_gbits = { 1, 10, 100 };
+    }
+    else if (!strncmp(argument, "-baseline=", 10)) params->baseline_file = argument+10;
+    else if (!strcmp(argument, "-predict")) params->predict = PREDICT_FEATURES;
+    else if (!strncmp(argument, "-predict=", 9)) {
+        char* run = strrchr(argument+9, ',');
+        params->predict = (run && !strcmp(run, ",run")) ? PREDICT_RUN : PREDICT_ONLY;
+        if (run && params->predict == PREDICT_RUN) *run = 0;
+        params->predict_model = argument+9;
+    }
+    else if (!strncmp(argument, "-trace=", 7)) params->trace_file = argument+7;
+    else if (!strncmp(argument, "-timeline=", 10))
+    {
+        if (params->timeline) fclose(params->timeline);
+        params->timeline = fopen(argument+10, "w");
+        if (!params->timeline) { perror(argument+10); result = 1; goto _clean; }
+        timeline_on = true;
+        timeline_buffer.events.reserve(4096); // the main thread is tid 0
+    }
+    else if (!strncmp(argument, "-chunk-map=", 11))
+    {
+        size_t len = strlen(argument+11);
+        params->chunk_map_json = len >= 6 && !strcmp(argument+11+len-6, ".jsonl");
+        if (params->chunk_map) fclose(params->chunk_map);
+        params->chunk_map = fopen(argument+11, "w");
+        if (!params->chunk_map) { perror(argument+11); result = 1; goto _clean; }
+        if (!params->chunk_map_json)
+            fprintf(params->chunk_map, "Compressor name,Filename,Offset,Size,Compressed size,Compression time in ns,Decompression time in ns\n");
+    }
+    else if (!strncmp(argument, "-statsd=", 8))
+    {
+        if (!statsd_open(argument+8)) { fprintf(stderr, "cannot send to StatsD at %s\n", argument+8); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-threshold=", 11)) params->speed_threshold = atof(argument+11);
+    else if (!strncmp(argument, "-ratio-threshold=", 17)) params->ratio_threshold = atof(argument+17);
+    else if (!strcmp(argument, "-timer=clock")) params->timer_tsc = 0;
+    else if (!strncmp(argument, "-msg=", 5))
+    {
+        std::vector<std::string> terms = split(argument+5, strchr(argument+5, '-') ? '-' : ',');
+        params->msg_sizes.clear();
+        params->msg_random = terms.size() == 2 && strchr(argument+5, '-');
+        for (size_t k=0; k<terms.size(); k++)
+            if (atoll(terms[k].c_str()) > 0) params->msg_sizes.push_back(atoll(terms[k].c_str()));
+        if (params->msg_sizes.size() != terms.size() || (params->msg_random && params->msg_sizes[0] > params->msg_sizes[1]) || (strchr(argument+5, '-') && !params->msg_random))
+            { fprintf(stderr, "wrong message sizes: %s\n", argument+5); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-msg-batch") || !strncmp(argument, "-msg-batch=", 11))
+    {
+        std::vector<std::string> terms = split(argument[10] ? argument+11 : "", ',');
+        params->msg_batches.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (terms[k].empty() && terms.size() == 1) break;
+            if (!strncmp(terms[k].c_str(), "rate=", 5) && atof(terms[k].c_str()+5) > 0) params->msg_batch_rate = atof(terms[k].c_str()+5);
+            else if (atoi(terms[k].c_str()) > 0) params->msg_batches.push_back(atoi(terms[k].c_str()));
+            else { fprintf(stderr, "wrong --msg-batch: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+        }
+        if (params->msg_batches.empty()) params->msg_batches = { 1, 4, 16, 64 };
+    }
+    else if (!strcmp(argument, "-match-finders") || !strncmp(argument, "-match-finders=", 15))
+    {
+        std::vector<std::string> terms = split(argument[14] ? argument+15 : "", ',');
+        params->match_finders = 1;
+        params->mf_nice_len = terms.size() > 0 && atoi(terms[0].c_str()) > 0 ? atoi(terms[0].c_str()) : 32;
+        params->mf_depth = terms.size() > 1 && atoi(terms[1].c_str()) > 0 ? atoi(terms[1].c_str()) : 32;
+        params->mf_window = (size_t)(terms.size() > 2 && atoi(terms[2].c_str()) > 0 ? MIN(atoi(terms[2].c_str()), 1024) : 16) << 20;
+        if (terms.size() > 3) { fprintf(stderr, "wrong --match-finders: %s\n", argument+15); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-soak=", 6))
+    {
+        std::vector<std::string> terms = split(argument+6, ',');
+        params->soak_hours = terms.size() > 0 ? atof(terms[0].c_str()) : 0;
+        params->soak_interval = terms.size() > 1 && atof(terms[1].c_str()) > 0 ? atof(terms[1].c_str()) : 60;
+        params->soak_threshold = terms.size() > 2 && atof(terms[2].c_str()) > 0 ? atof(terms[2].c_str()) : 10;
+        if (!(params->soak_hours > 0) || terms.size() > 3) { fprintf(stderr, "wrong --soak: %s\n", argument+6); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-ingest=", 8))
+    {
+        std::vector<std::string> terms = split(argument+8, ',');
+        params->ingest_rates.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (!(atof(terms[k].c_str()) > 0)) { fprintf(stderr, "wrong --ingest: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->ingest_rates.push_back(atof(terms[k].c_str()));
+        }
+    }
+    else if (!strncmp(argument, "-block=", 7))
+    {
+        std::vector<std::string> terms = split(argument+7, ',');
+        params->block_sizes.clear();
+        for (size_t k=0; k<terms.size(); k++)
+        {
+            if (atoll(terms[k].c_str()) <= 0) { fprintf(stderr, "wrong block size: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+            params->block_sizes.push_back(atoll(terms[k].c_str()));
+        }
+        params->chunk_size = params->block_sizes[0];
+    }
+    else if (!strncmp(argument, "-consume=", 9))
+    {
+        params->consume_name = argument+9;
+        if (!strcmp(argument+9, "xxh64")) params->consumer = consume_xxh64;
+        else if (!strcmp(argument+9, "scan")) params->consumer = consume_scan;
+        else if (!(params->consumer = lzbench_load_consumer(argument+9))) { result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-cpb")) params->cpb_ghz = -1;
+    else if (!strncmp(argument, "-cpb=", 5)) params->cpb_ghz = atof(argument+5);
+    else if (!strncmp(argument, "-ci=", 4)) { params->ci_target = atof(argument+4); params->stats = 1; }
+    else if (!strncmp(argument, "-ci-max=", 8)) params->ci_maxtime = 1000*atoi(argument+8);
+    else if (!strcmp(argument, "-cold") || !strcmp(argument, "-cold=sweep")) params->cold_mode = COLD_SWEEP;
+    else if (!strcmp(argument, "-cold=flush")) params->cold_mode = COLD_FLUSH;
+    else if (!strncmp(argument, "-stdin-size=", 12)) params->stdin_size = (size_t)atoi(argument+12) << 20;
+    else if (!strncmp(argument, "-load=", 6))
+    {
+        std::vector<std::string> terms = split(argument+6, ',');
+        params->load_rate = atof(terms[0].c_str());
+        params->load_poisson = 1;
+        params->load_requests = 10000;
+        for (size_t k=1; k<terms.size(); k++)
+        {
+            if (terms[k] == "fixed") params->load_poisson = 0;
+            else if (terms[k] == "poisson") params->load_poisson = 1;
+            else if (atoi(terms[k].c_str()) > 0) params->load_requests = atoi(terms[k].c_str());
+            else { fprintf(stderr, "unknown --load option: %s\n", terms[k].c_str()); result = 1; goto _clean; }
+        }
+        if (!(params->load_rate > 0)) { fprintf(stderr, "wrong rate of --load: %s\n", argument+6); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-setup")) params->setup = 1;
+    else if (!strncmp(argument, "-noise=", 7))
+    {
+        std::vector<std::string> terms = split(argument+7, ',');
+        params->noise_mode = (terms[0] == "stream") ? NOISE_STREAM : (terms[0] == "chase") ? NOISE_CHASE : NOISE_NONE;
+        for (size_t k=1; k<terms.size() && params->noise_mode; k++)
+        {
+            if (!strncmp(terms[k].c_str(), "threads=", 8)) params->noise_threads = atoi(terms[k].c_str()+8);
+            else if (!strncmp(terms[k].c_str(), "gbs=", 4)) params->noise_gbs = atof(terms[k].c_str()+4);
+            else if (!strncmp(terms[k].c_str(), "size=", 5)) params->noise_size = (size_t)atoi(terms[k].c_str()+5) << 20;
+            else params->noise_mode = NOISE_NONE;
+        }
+        if (!params->noise_mode) { fprintf(stderr, "wrong --noise: %s\n", argument+7); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-warmup=", 8))
+    {
+        const char* unit = argument+8+strspn(argument+8, "0123456789");
+        if (!strcmp(unit, "ms")) params->warmup_ms = atoi(argument+8);
+        else if (!*unit) params->warmup_passes = atoi(argument+8);
+        else { fprintf(stderr, "wrong --warmup: %s\n", argument+8); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-inplace")) params->inplace = 1;
+    else if (!strcmp(argument, "-interop")) params->interop = 1;
+    else if (!strcmp(argument, "-random-reads")) params->random_reads = 100000;
+    else if (!strcmp(argument, "-spsc")) params->spsc_depth = 8;
+    else if (!strcmp(argument, "-sandbox") || !strcmp(argument, "-sandbox=strict")) params->sandbox = SANDBOX_STRICT;
+    else if (!strcmp(argument, "-sandbox=filter")) params->sandbox = SANDBOX_FILTER;
+    else if (!strcmp(argument, "-sstable") || !strncmp(argument, "-sstable=", 9))
+    {
+        std::vector<std::string> terms = split(argument[8] ? argument+9 : "", ',');
+        params->sstable_block = (terms.size() > 0 && !terms[0].empty() ? atoi(terms[0].c_str()) : 4) << 10;
+        params->sstable_restart = terms.size() > 1 ? atoi(terms[1].c_str()) : 16;
+        params->sstable_scan = terms.size() > 2 ? atoi(terms[2].c_str()) : 100;
+        if ((int)params->sstable_block < 1024 || (int)params->sstable_restart < 1 || (int)params->sstable_scan < 1) { fprintf(stderr, "wrong --sstable: %s\n", argument+8); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-spsc=", 6))
+    {
+        params->spsc_depth = atoi(argument+6);
+        if (params->spsc_depth < 1) { fprintf(stderr, "wrong --spsc: %s\n", argument+6); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-rotate=", 8))
+    {
+        params->rotate = atoi(argument+8);
+        if (params->rotate < 2) { fprintf(stderr, "wrong --rotate: %s, at least 2 inputs\n", argument+8); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-random-reads=", 14)) params->random_reads = MAX(atoi(argument+14), 1);
+    else if (!strncmp(argument, "-range-reads", 12) && (argument[12] == 0 || argument[12] == '=')) {
+        std::vector<std::string> terms = split(argument[12] ? argument+13 : "", ',');
+        params->range_reads = (terms.empty() || terms[0].empty()) ? 10000 : (MAX(atoi(terms[0].c_str()), 1));
+        params->range_sizes.clear();
+        for (size_t k=1; k<terms.size(); k++) params->range_sizes.push_back((size_t)(MAX(atoi(terms[k].c_str()), 1)) << 10);
+        if (params->range_sizes.empty()) params->range_sizes = { 4 << 10, 64 << 10, 1 << 20 };
+        if (params->range_sizes.size() > RANGE_SIZES_MAX) { fprintf(stderr, "--range-reads takes up to %d sizes\n", RANGE_SIZES_MAX); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-transcode=", 11)) params->transcode = argument + 11;
+    else if (!strncmp(argument, "-placement", 10) && (argument[10] == 0 || argument[10] == '=')) {
+#if defined(__linux__)
+        std::vector<int> memory = numa_memory_nodes();
+        std::vector<std::string> terms = split(argument[10] ? argument+11 : "", ',');
+        params->placements.clear();
+        if (terms.empty() || terms[0].empty()) // every combination of the memory nodes
+            for (size_t k=0; k<memory.size()*memory.size()*memory.size() && k<PLACEMENTS_MAX; k++)
+                for (size_t b=0, v=k; b<3; b++, v/=memory.size()) params->placements.push_back(memory[v % memory.size()]);
+        for (size_t k=0; k<terms.size() && !terms[k].empty(); k++)
+        {
+            std::vector<std::string> nodes = split(terms[k], ':');
+            for (size_t b=0; b<3; b++)
+            {
+                int node = (b < nodes.size() && nodes[b] != "-") ? atoi(nodes[b].c_str()) : -1;
+                if (node >= 0 && (node >= 64 || std::find(memory.begin(), memory.end(), node) == memory.end())) { fprintf(stderr, "--placement: node %d has no memory\n", node); result = 1; goto _clean; }
+                params->placements.push_back(node);
+            }
+        }
+        if (params->placements.size() > PLACEMENTS_MAX * 3) { fprintf(stderr, "--placement takes up to %d combinations\n", PLACEMENTS_MAX); result = 1; goto _clean; }
+#else
+        fprintf(stderr, "warning: --placement is supported only on Linux\n");
+#endif
+    }
+    else if (!strncmp(argument, "-zram", 5) && (argument[5] == 0 || argument[5] == '=')) {
+        size_t kb = argument[5] ? atoi(argument + 6) : 4;
+        if (kb < 1 || kb > 1024 || (kb & (kb - 1))) { fprintf(stderr, "--zram takes a page size in KB of a power of 2 up to 1024\n"); result = 1; goto _clean; }
+        params->zram_page = kb << 10;
+    }
+    else if (!strncmp(argument, "-ttfb", 5) && (argument[5] == 0 || argument[5] == '=')) {
+        std::vector<std::string> terms = split(argument[5] ? argument+6 : "", ',');
+        params->ttfb_sizes.clear();
+        for (size_t k=0; k<terms.size(); k++)
+            if (!terms[k].empty()) params->ttfb_sizes.push_back((size_t)(MAX(atoi(terms[k].c_str()), 1)) << 10);
+        if (params->ttfb_sizes.empty()) params->ttfb_sizes = { 4 << 10, 64 << 10 };
+        if (params->ttfb_sizes.size() > TTFB_SIZES_MAX) { fprintf(stderr, "--ttfb takes up to %d sizes\n", TTFB_SIZES_MAX); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-breakdown")) params->breakdown = BREAKDOWN_TYPE;
+    else if (!strcmp(argument, "-breakdown=file")) params->breakdown = BREAKDOWN_FILE;
+#ifndef BENCH_REMOVE_BLOSCLZ
+    else if (!strncmp(argument, "-blosclzmt=", 11)) {
+        const char* arg = argument+11;
+        lzbench_blosclzmt_threads = MAX(atoi(arg), 1);
+        if ((arg = strchr(arg, ','))) lzbench_blosclzmt_typesize = atoi(++arg);
+        if (arg && (arg = strchr(arg, ','))) lzbench_blosclzmt_shuffle = atoi(++arg);
+        if (arg && (arg = strchr(arg, ','))) lzbench_blosclzmt_block_size = (size_t)atoi(++arg) << 10;
+        lzbench_blosclzmt_typesize = MIN(MAX(lzbench_blosclzmt_typesize, 1), FILTER_MAX_WIDTH);
+        lzbench_blosclzmt_shuffle = MIN(MAX(lzbench_blosclzmt_shuffle, 0), 2);
+    }
+#endif
+#ifdef BENCH_HAS_NVCOMP
+#ifndef BENCH_REMOVE_LZ4
+    else if (!strncmp(argument, "-hybrid=", 8)) { lzbench_hybrid_threads = MAX(atoi(argument+8), 0); params->hybrid = 1; }
+#endif
+    else if (!strncmp(argument, "-cuda-streams=", 14)) {
+        const char* arg = argument+14;
+        params->cuda_streams = lzbench_cuda_streams = MIN(MAX(atoi(arg), 1), 16);
+        if ((arg = strchr(arg, ','))) lzbench_cuda_slice_size = (size_t)(MAX(atoi(++arg), 1)) << 20;
+    }
+    else if (!strncmp(argument, "-gpus=", 6)) {
+        int count = lzbench_cuda_topology(true);
+        int gpus = strcmp(argument+6, "all") ? atoi(argument+6) : count;
+        if (gpus < 1 || gpus > count) { fprintf(stderr, "wrong --gpus: %s, %d CUDA devices are visible\n", argument+6, count); result = 1; goto _clean; }
+        if (gpus > CUDA_DEVICES_MAX) fprintf(stderr, "--gpus: using the first %d of %d devices\n", CUDA_DEVICES_MAX, gpus);
+        params->gpus = lzbench_cuda_devices = MIN(gpus, CUDA_DEVICES_MAX);
+    }
+#endif
+#ifndef BENCH_REMOVE_FASTLZMA2
+    else if (!strncmp(argument, "-fastlzma2mt=", 13)) lzbench_fastlzma2mt_threads = MAX(atoi(argument+13), 1);
+#endif
+#ifndef BENCH_REMOVE_LZ4
+    else if (!strcmp(argument, "-lz-stats")) params->lz_stats = 1;
+    else if (!strncmp(argument, "-lz4-block=", 11)) lzbench_lz4_block_size = (size_t)(MAX(atoi(argument+11), 1)) << 10;
+#endif
+#ifndef BENCH_REMOVE_LZHAM
+    else if (!strncmp(argument, "-lzhammt=", 9)) lzbench_lzhammt_threads = MAX(atoi(argument+9), 1);
+#endif
+#ifndef BENCH_REMOVE_LZMA
+    else if (!strncmp(argument, "-lzmamt=", 8)) {
+        const char* arg = argument+8;
+        lzbench_lzmamt_threads = MAX(atoi(arg), 1);
+        if ((arg = strchr(arg, ','))) lzbench_lzmamt_block_size = (size_t)atoi(++arg) << 20;
+    }
+#endif
+#ifndef BENCH_REMOVE_XZ
+    else if (!strncmp(argument, "-xzmt=", 6)) {
+        const char* arg = argument+6;
+        lzbench_xzmt_threads = MAX(atoi(arg), 1);
+        if ((arg = strchr(arg, ','))) lzbench_xzmt_block_size = (size_t)atoi(++arg) << 20;
+    }
+#endif
+#ifndef BENCH_REMOVE_BZIP2
+    else if (!strncmp(argument, "-pbzip2=", 8)) lzbench_pbzip2_threads = MAX(atoi(argument+8), 1);
+#endif
+#if !defined(BENCH_REMOVE_LIBDEFLATE) && !defined(BENCH_REMOVE_ZLIB)
+    else if (!strncmp(argument, "-pdeflate=", 10)) {
+        const char* arg = argument+10;
+        lzbench_pdeflate_threads = MAX(atoi(arg), 1);
+        if ((arg = strchr(arg, ','))) lzbench_pdeflate_block_size = (size_t)(MAX(atoi(++arg), 32)) << 10;
+    }
+#endif
+    else if (!strncmp(argument, "-offload-depth=", 15)) {
+        lzbench_offload_depth = MIN(MAX(atoi(argument+15), 1), 1024);
+    }
+    else if (!strncmp(argument, "-offload-decoder=", 17)) {
+        const char* arg = argument+17;
+        if (!strcmp(arg, "native")) lzbench_offload_decoder = OFFLOAD_DECODER_NATIVE;
+        else if (!strcmp(arg, "libdeflate")) lzbench_offload_decoder = OFFLOAD_DECODER_LIBDEFLATE;
+        else if (!strcmp(arg, "zlib")) lzbench_offload_decoder = OFFLOAD_DECODER_ZLIB;
+        else { fprintf(stderr, "wrong --offload-decoder: %s\n", arg); result = 1; goto _clean; }
+    }
+#ifndef BENCH_REMOVE_ZSTD
+    else if (!strncmp(argument, "-adapt=", 7)) {
+        params->adapt_mbps = atof(argument+7);
+        params->adapt_min = 1;
+        params->adapt_max = 19;
+        const char* arg = strchr(argument+7, ',');
+        if (arg && sscanf(arg+1, "%d-%d", &params->adapt_min, &params->adapt_max) != 2) params->adapt_min = -1;
+        if (params->adapt_mbps <= 0 || params->adapt_min < 1 || params->adapt_max > 22 || params->adapt_min > params->adapt_max)
+            { fprintf(stderr, "wrong --adapt: %s\n", argument+7); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-tune=", 6)) {
+        std::vector<std::string> terms = split(argument+6, ',');
+        params->tune_level = terms.size() > 1 && !terms[1].empty() ? atoi(terms[1].c_str()) : 3;
+        params->tune_cspeed = terms.size() > 2 ? atof(terms[2].c_str()) : 0;
+        if (terms.empty() || terms[0] != "zstd" || terms.size() > 3 || params->tune_level < 1 || params->tune_level > 22)
+            { fprintf(stderr, "wrong --tune: %s (only zstd,1-22[,MB/s])\n", argument+6); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-zstd-trace")) lzbench_zstd_trace = 1;
+#ifndef BENCH_REMOVE_ZLIB
+    else if (!strncmp(argument, "-zran=", 6)) {
+        double mb = atof(argument+6);
+        if (mb <= 0) { fprintf(stderr, "wrong --zran: %s\n", argument+6); result = 1; goto _clean; }
+        lzbench_zran_span = (size_t)(mb * (1 << 20));
+    }
+#endif
+    else if (!strncmp(argument, "-zstdmt=", 8)) {
+        const char* arg = argument+8;
+        lzbench_zstdmt_workers = MAX(atoi(arg), 1);
+        if ((arg = strchr(arg, ','))) lzbench_zstdmt_job_size = (size_t)atoi(++arg) << 20;
+        if (arg && (arg = strchr(arg, ','))) lzbench_zstdmt_overlap = atoi(++arg);
+    }
+#endif
+    else if (!strcmp(argument, "-dict")) params->dict_size = 110 << 10;
+    else if (!strncmp(argument, "-delta=", 7)) {
+        FILE* f = fopen(argument+7, "rb");
+        if (!f) { perror(argument+7); result = 1; goto _clean; }
+        char buf[1 << 16];
+        for (size_t len; (len = fread(buf, 1, sizeof(buf), f)) > 0; ) params->delta_ref.insert(params->delta_ref.end(), buf, buf + len);
+        fclose(f);
+        if (params->delta_ref.empty()) { fprintf(stderr, "%s: empty reference\n", argument+7); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-brotli-dict=", 13)) {
+        FILE* f = fopen(argument+13, "rb");
+        if (!f) { perror(argument+13); result = 1; goto _clean; }
+        char buf[1 << 16];
+        for (size_t len; (len = fread(buf, 1, sizeof(buf), f)) > 0; ) params->brotli_dict.insert(params->brotli_dict.end(), buf, buf + len);
+        fclose(f);
+        if (params->brotli_dict.empty()) { fprintf(stderr, "%s: empty dictionary\n", argument+13); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-dedup")) params->dedup_size = 8 << 10;
+    else if (!strncmp(argument, "-dedup=", 7)) {
+        params->dedup_size = (size_t)atoi(argument+7) << 10;
+        if (params->dedup_size < 1024 || params->dedup_size > (64 << 20)) { fprintf(stderr, "wrong --dedup: %s, the average chunk size is 1 KB to 64 MB\n", argument+7); result = 1; goto _clean; }
+    }
+    else if (!strcmp(argument, "-long-range") || !strncmp(argument, "-long-range=", 12)) {
+        std::vector<std::string> terms = split(argument[11] ? argument+12 : "", ',');
+        params->long_range_window = (size_t)(terms.size() > 0 && !terms[0].empty() ? atoll(terms[0].c_str()) : 4096) << 20;
+        params->long_range_block = terms.size() > 1 ? atoi(terms[1].c_str()) : 64;
+        if (!params->long_range_window || params->long_range_block < 16 || params->long_range_block > (1 << 20)) { fprintf(stderr, "wrong --long-range: %s\n", argument+11); result = 1; goto _clean; }
+    }
+    else if (!strncmp(argument, "-dict=", 6)) params->dict_size = (size_t)(MAX(atoi(argument+6), 1)) << 10;
+    else if (!strcmp(argument, "-archive")) params->archive = 1;
+    else if (!strncmp(argument, "-load-threads=", 14)) params->load_threads = MAX(atoi(argument+14), 1);
+    else if (!strncmp(argument, "-cold-size=", 11)) params->cold_size = (size_t)atoi(argument+11) << 20;
+    else if (!strcmp(argument, "-steal")) params->work_stealing = 1;
+    else if (!strcmp(argument, "-no-steal")) params->work_stealing = -1;
+    else if (!strcmp(argument, "-pin=core")) params->pin_mode = PIN_CORE;
+    else if (!strcmp(argument, "-pin=node")) params->pin_mode = PIN_NODE;
+    else if (!strcmp(argument, "-numa=local")) params->numa_mode = NUMA_LOCAL;
+    else if (!strcmp(argument, "-numa=interleave")) params->numa_mode = NUMA_INTERLEAVE;
+    else if (!strcmp(argument, "-numa=remote")) params->numa_mode = NUMA_REMOTE;
     else while (argument[0] != 0) {
         char* numPtr = argument + 1;
         unsigned number = 0;
@@ -831,7 +16891,16 @@ int main( int argc, char** argv)
         switch (argument[0])
         {
         case 'b':
-            params->chunk_size = number << 10;
+            params->block_sizes.clear();
+            while (true)
+            {
+                params->block_sizes.push_back(number ? (size_t)number << 10 : NO_LIMIT); // -b0 = the whole input
+                if (*numPtr != ',') break;
+                numPtr++;
+                number = 0;
+                while ((*numPtr >='0') && (*numPtr <='9')) { number *= 10;  number += *numPtr - '0'; numPtr++; }
+            }
+            params->chunk_size = params->block_sizes[0];
             break;
         case 'c':
             sort_col = number;
@@ -853,13 +16922,17 @@ int main( int argc, char** argv)
         case 'j':
             join = true;
             break;
+        case 'J':
+            join = true;
+            params->solid = number ? 2 : 1;
+            break;
         case 'm':
             params->mem_limit = number << 18; /*  total memory usage = mem_limit * 4  */
             if (params->textformat == TEXT) params->textformat = TEXT_FULL;
             break;
         case 'o':
             params->textformat = (textformat_e)number;
-            if (params->textformat == CSV) params->verbose = 0;
+            if (params->textformat == CSV || params->textformat == JSON) params->verbose = 0;
             break;
         case 'p':
             params->timetype = (timetype_e)number;
@@ -888,6 +16961,21 @@ int main( int argc, char** argv)
                 params->dloop_time = (params->dmintime)?DEFAULT_LOOP_TIME:0;
             }
             break;
+        case 'P':
+            params->processes = (number < 1) ? 1 : (number > MAX_THREADS) ? MAX_THREADS : number;
+            break;
+        case 'T':
+            params->thread_counts_nb = 0;
+            while (true)
+            {
+                if (params->thread_counts_nb < MAX_THREAD_COUNTS)
+                    params->thread_counts[params->thread_counts_nb++] = (number < 1) ? 1 : (number > MAX_THREADS) ? MAX_THREADS : number;
+                if (*numPtr != ',') break;
+                numPtr++;
+                number = 0;
+                while ((*numPtr >='0') && (*numPtr <='9')) { number *= 10;  number += *numPtr - '0'; numPtr++; }
+            }
+            break;
         case 'u':
             params->dmintime = 1000*number;
             params->dloop_time = (params->dmintime)?DEFAULT_LOOP_TIME:0;
@@ -912,14 +17000,18 @@ int main( int argc, char** argv)
             printf("opt - compressors with optimal parsing (slow compression, fast decompression)\n");
             printf("lzo / ucl - aliases for all levels of given compressors\n");
             printf("cuda - alias for all CUDA-based compressors\n");
-            for (int i=1; i<LZBENCH_COMPRESSOR_COUNT; i++)
+            printf("zram - alias for the compressors of zram and zswap (lzo1x, lz4, lz4hc, zstd), see --zram\n");
+            printf("integers - alias for the integer codecs of posting lists and IDs with lz4 and zstd\n");
+            printf("floats - alias for the codecs of float64 time series with byte shuffle + zstd and zstd\n");
+            printf("kernel - alias for the codecs of the kernel through zram next to lzo1x, lz4 and zstd\n");
+            for (int i=1; i<codec_count(); i++)
             {
-                if (comp_desc[i].compress)
+                if (codec_desc(i)->compress)
                 {
-                    if (comp_desc[i].first_level < comp_desc[i].last_level)
-                        printf("%s %s [%d-%d]\n", comp_desc[i].name, comp_desc[i].version, comp_desc[i].first_level, comp_desc[i].last_level);
+                    if (codec_desc(i)->first_level < codec_desc(i)->last_level)
+                        printf("%s %s [%d-%d]\n", codec_desc(i)->name, codec_desc(i)->version, codec_desc(i)->first_level, codec_desc(i)->last_level);
                     else
-                        printf("%s %s\n", comp_desc[i].name, comp_desc[i].version);
+                        printf("%s %s\n", codec_desc(i)->name, codec_desc(i)->version);
                 }
             }
             return 0;
@@ -933,6 +17025,97 @@ int main( int argc, char** argv)
     argc--;
     }
 
+    for (int k=0; k<params->thread_counts_nb; k++)
+        params->max_threads = MAX(params->max_threads, params->thread_counts[k]);
+    params->threads = params->max_threads;
+    if (params->mmap_direct && params->mmap_mode == MMAP_NONE) params->mmap_mode = MMAP_READ;
+#ifdef BENCH_HAS_TICKS
+    if (params->timer_tsc || params->cpb_ghz < 0)
+    {
+        double tick_ns = bench_calibrate_ticks();
+        if (!tick_ns) fprintf(stderr, "warning: no cycle counter on this CPU, --timer=tsc is ignored\n");
+        else if (params->timer_tsc) bench_tick_ns = tick_ns;
+    #if defined(__x86_64__) || defined(__i386__)
+        if (params->cpb_ghz < 0 && tick_ns) params->cpb_ghz = 1 / tick_ns; // TSC runs at the nominal frequency
+    #endif
+        LZBENCH_PRINT(5, "timer tick=%.4f ns\n", tick_ns);
+    }
+#else
+    if (params->timer_tsc) fprintf(stderr, "warning: --timer=tsc is not supported on this platform\n");
+#endif
+    if (params->cpb_ghz < 0) { fprintf(stderr, "warning: clock frequency is unknown, use --cpb=GHz\n"); params->cpb_ghz = 0; }
+#if defined(_WIN32)
+    if (params->isolate) { fprintf(stderr, "warning: --isolate is not supported on this platform\n"); params->isolate = 0; }
+    if (params->processes > 1) { fprintf(stderr, "warning: -P# is not supported on this platform\n"); params->processes = 1; }
+#endif
+    if (params->ratio_only)
+    {
+        // a single pass without timing loops, tests run at once on all cores unless a mode needs them
+        params->cmintime = params->dmintime = 0;
+        params->cloop_time = params->dloop_time = 0;
+        params->c_iters = params->d_iters = 1;
+        params->ci_target = 0;
+        params->cspeed = 0;
+        if (params->ratio_only == 1) params->compress_only = 1;
+        if (!params->parallel && params->processes <= 1 && !params->isolate && params->thread_counts_nb <= 1 && params->thread_counts[0] <= 1
+            && params->pin_mode == PIN_NONE && params->cold_mode == COLD_NONE && !params->memory && !params->energy && !params->llc_mon && params->precheck == PRECHECK_NONE
+            && !params->interleave && !params->recommend)
+            params->parallel = -1;
+    }
+    if (params->noise_mode)
+    {
+        if (params->noise_size == 0) params->noise_size = 64 << 20;
+        if (params->noise_threads <= 0)
+            params->noise_threads = MAX(lzbench_cpus() - params->max_threads, 1);
+    }
+    if (params->per_core_type && (params->pin_mode != PIN_NONE || params->parallel || params->quiesce))
+    {
+        fprintf(stderr, "--core-types pins the tests to the CPUs of a type and doesn't go with --pin, --parallel and --quiesce\n");
+        result = 1; goto _clean;
+    }
+    if (params->processes > 1 && (params->isolate || params->parallel || params->interleave || params->recommend))
+    {
+        fprintf(stderr, "-P# doesn't go with --isolate, --parallel, --interleave and --recommend\n");
+        result = 1; goto _clean;
+    }
+    if (params->cache_dir && !cache_mkdir(params->cache_dir))
+    {
+        fprintf(stderr, "--cache=%s: can't create the directory (%s)\n", params->cache_dir, strerror(errno));
+        result = 1; goto _clean;
+    }
+    if (params->isolate && (params->parallel || params->interleave || params->recommend))
+    {
+        fprintf(stderr, "--isolate doesn't go with --parallel, --interleave and --recommend\n");
+        result = 1; goto _clean;
+    }
+    if (params->parallel && (params->thread_counts_nb > 1 || params->thread_counts[0] > 1 || params->pin_mode != PIN_NONE || params->cold_mode != COLD_NONE
+        || params->memory || params->energy || params->llc_mon || params->precheck != PRECHECK_NONE || params->interleave || params->recommend))
+    {
+        fprintf(stderr, "--parallel runs every test with a single thread and doesn't go with -T#, --pin, --cold, --memory, --energy, --llc-mon, --precheck, --interleave and --recommend\n");
+        result = 1; goto _clean;
+    }
+#if defined(__linux__)
+    if (params->pin_mode != PIN_NONE || params->numa_mode != NUMA_DEFAULT)
+    {
+        numa_init();
+        if (params->numa_mode == NUMA_REMOTE && params->pin_mode == PIN_NONE) params->pin_mode = PIN_NODE; // remote is relative to the node of a thread
+        LZBENCH_PRINT(5, "NUMA nodes=%d\n", (int)numa_nodes.size());
+    }
+#endif
+    if (params->energy) rapl_init();
+    if (params->freq_threshold > 0 && !freq_read()) fprintf(stderr, "warning: core frequency is not available (check /sys/devices/system/cpu/cpu*/cpufreq/scaling_cur_freq)\n");
+
+    if (params->cold_mode == COLD_SWEEP
+#if !defined(__SSE2__)
+        || params->cold_mode == COLD_FLUSH
+#endif
+        )
+    {
+        params->cold_mode = COLD_SWEEP;
+        params->cold_buf = (char*)alloc_and_touch(params->cold_size, true);
+        if (!params->cold_buf) { printf("Not enough memory for --cold-size!\n"); return 1; }
+    }
+
     while (argc > 1) {
         inFileNames[ifnIdx++] = argv[1];
         argv++;
@@ -940,10 +17123,11 @@ int main( int argc, char** argv)
     }
 
     cpu_brand = cpu_brand_string();
+    params->cpu_brand = cpu_brand;
     LZBENCH_PRINT(2, PROGNAME " " PROGVERSION " (%d-bit " PROGOS ")  %s\nAssembled by P.Skibinski\n\n", (uint32_t)(8 * sizeof(uint8_t*)), cpu_brand);
-    LZBENCH_PRINT(5, "params: chunk_size=%d c_iters=%d d_iters=%d cspeed=%d cmintime=%d dmintime=%d encoder_list=%s\n", (int)params->chunk_size, params->c_iters, params->d_iters, params->cspeed, params->cmintime, params->dmintime, encoder_list);
+    LZBENCH_PRINT(5, "params: chunk_size=%zu c_iters=%d d_iters=%d cspeed=%d cmintime=%d dmintime=%d encoder_list=%s\n", params->chunk_size, params->c_iters, params->d_iters, params->cspeed, params->cmintime, params->dmintime, encoder_list);
 
-    if (ifnIdx < 1)  { usage(params); goto _clean; }
+    if (ifnIdx < 1 && !params->pathological_size)  { usage(params); goto _clean; }
 
     if (real_time)
     {
@@ -951,6 +17135,22 @@ int main( int argc, char** argv)
     } else {
         LZBENCH_PRINT(2, "The real-time process priority disabled%c\n", ' ');
     }
+    if (cgroup_cpus > 0)
+        LZBENCH_PRINT(2, "cgroup CPU quota: %.2f CPUs, default threads = %d\n", cgroup_cpus, lzbench_cpus());
+    if (params->quiesce) lzbench_quiesce(params);
+    if (params->per_core_type) core_types_init(params);
+    if (!params->llc_ways.empty())
+    {
+        if (!resctrl_init(params)) { result = 1; goto _clean; }
+        for (size_t k=0; k<params->llc_ways.size(); k++)
+            if (params->llc_ways[k] < llc_min_ways || params->llc_ways[k] > llc_total_ways)
+            {
+                fprintf(stderr, "wrong --llc-ways: %d, the L3 cache has %d ways, at least %d of them\n", params->llc_ways[k], llc_total_ways, llc_min_ways);
+                result = 1; goto _clean;
+            }
+    }
+    if (params->llc_mon) llc_mon_init(params); // in the group of --llc-ways if there is one
+    if (params->calibrate) lzbench_calibrate(params, rate);
 
 
 #ifdef UTIL_HAS_CREATEFILELIST
@@ -966,21 +17166,67 @@ int main( int argc, char** argv)
     }
 #endif
 
+    if (params->baseline_file && lzbench_load_baseline(params->baseline_file, baseline) != 0) { result = 1; goto _clean; }
+    if (params->predict_model && lzbench_load_model(params->predict_model) != 0) { result = 1; goto _clean; }
+    if (params->trace_file && lzbench_load_trace(params->trace_file, params->trace) != 0) { result = 1; goto _clean; }
+
     /* Main function */
-    if (join)
-        result = lzbench_join(params, inFileNames, ifnIdx, encoder_list);
-    else
-        result = lzbench_main(params, inFileNames, ifnIdx, encoder_list);
+    if (params->archive) join = true;
+    if (!join && params->breakdown) fprintf(stderr, "warning: --breakdown is used only with -j\n");
+    if (!join && !params->sample_blocks && params->dict_size) fprintf(stderr, "warning: --dict is used only with -j or --sample\n");
+    if (params->page_cache && !params->mmap_direct && !params->pipeline_dir) fprintf(stderr, "warning: --page-cache is used only with --mmap-direct or --pipeline\n");
+    if (join && params->work_stealing == 0) params->work_stealing = 1; // files of different sizes are not split evenly
+    if (params->work_stealing < 0) params->work_stealing = 0;
+    for (int pass = params->hugepages_both ? 0 : 1; pass < 2 && result == 0; pass++)
+    for (int host = params->pinned_both ? 0 : 1; host < 2 && result == 0; host++)
+    {
+        huge_pages = pass ? params->hugepages : HUGE_NONE; // --hugepages=both runs first with base pages
+        host_memory = host ? params->pinned : HOST_PAGEABLE; // --pinned=both runs first with pageable memory
+        if (pass && host == !params->pinned_both && params->hugepages_both && params->textformat != JSON) printf("\nThe same with huge pages:\n");
+        if (host && params->pinned_both && params->textformat != JSON) printf("\nThe same with %s host memory:\n", host_memory_names[params->pinned]);
+        if (params->predict == PREDICT_ONLY)
+            result = lzbench_predict_files(params, inFileNames, ifnIdx);
+        else if (params->decompress_only && !params->cache_dir)
+            result = lzbench_decode_files(params, inFileNames, ifnIdx);
+        else if (params->sample_blocks)
+            result = lzbench_sample(params, inFileNames, ifnIdx, encoder_list);
+        else if (join)
+            result = lzbench_join(params, inFileNames, ifnIdx, encoder_list);
+        else
+            result = lzbench_main(params, inFileNames, ifnIdx, encoder_list);
+    }
+
+    if (params->pathological_size && result == 0) result = lzbench_pathological(params, encoder_list);
 
-    if (params->chunk_size > 10 * (1<<20)) {
-        LZBENCH_PRINT(2, "done... (cIters=%d dIters=%d cTime=%.1f dTime=%.1f chunkSize=%dMB cSpeed=%dMB)\n", params->c_iters, params->d_iters, params->cmintime/1000.0, params->dmintime/1000.0, (int)(params->chunk_size >> 20), params->cspeed);
+    if (params->chunk_size == NO_LIMIT) {
+        LZBENCH_PRINT(2, "done... (cIters=%d dIters=%d cTime=%.1f dTime=%.1f chunkSize=whole cSpeed=%dMB)\n", params->c_iters, params->d_iters, params->cmintime/1000.0, params->dmintime/1000.0, params->cspeed);
+    } else if (params->chunk_size > 10 * (1<<20)) {
+        LZBENCH_PRINT(2, "done... (cIters=%d dIters=%d cTime=%.1f dTime=%.1f chunkSize=%lluMB cSpeed=%dMB)\n", params->c_iters, params->d_iters, params->cmintime/1000.0, params->dmintime/1000.0, (unsigned long long)(params->chunk_size >> 20), params->cspeed);
     } else {
         LZBENCH_PRINT(2, "done... (cIters=%d dIters=%d cTime=%.1f dTime=%.1f chunkSize=%dKB cSpeed=%dMB)\n", params->c_iters, params->d_iters, params->cmintime/1000.0, params->dmintime/1000.0, (int)(params->chunk_size >> 10), params->cspeed);
     }
 
+    if (params->thread_counts_nb > 1 && params->textformat != JSON) print_scaling(params); // JSON has the raw numbers
+    if (params->block_sizes.size() > 1 && params->textformat != JSON) print_block_matrix(params);
+    if (params->llc_ways.size() > 1 && params->textformat != JSON) print_llc_matrix(params);
+    if (params->buf_offsets.size() > 1 && params->textformat != JSON) print_offset_matrix(params);
+    if (params->per_core_type && params->textformat != JSON) print_core_matrix(params);
+    if (params->lz_stats && params->textformat != JSON) print_lz_stats(params);
+    if (params->pareto)
+    {
+        print_pareto_frontier(params, 0);
+        print_pareto_frontier(params, 1);
+        if (params->pareto_weight >= 0) print_pareto_frontier(params, 2);
+    }
+    if (params->summary) print_summary(params);
+    if (params->pathological_size) print_pathological(params);
+    if (!params->link_gbits.empty()) print_transfer(params);
+    if (params->predict == PREDICT_RUN && result == 0) lzbench_compare_prediction(params);
+    if (params->baseline_file && result == 0 && lzbench_compare_baseline(params, baseline) > 0) result = 2;
+
     if (sort_col <= 0) goto _clean;
 
-    printf("\nThe results sorted by column number %d:\n", sort_col);
+    if (params->textformat != JSON) printf("\nThe results sorted by column number %d:\n", sort_col);
     print_header(params);
 
     switch (sort_col)
@@ -1002,15 +17248,27 @@ int main( int argc, char** argv)
     }
 
 _clean:
+    llc_mon_exit();
+    resctrl_exit();
     if (encoder_list)
         free(encoder_list);
+    if (params->cold_buf)
+        free_touched(params->cold_buf);
 #ifdef UTIL_HAS_CREATEFILELIST
     if (extendedFileList)
         UTIL_freeFileList(extendedFileList, fileNamesBuf);
     else
 #endif
     free((void*)inFileNames);
+    if (params->chunk_map)
+        fclose(params->chunk_map);
+    if (params->timeline)
+    {
+        timeline_write(params->timeline);
+        fclose(params->timeline);
+    }
     if (cpu_brand)
         free(cpu_brand);
     return result;
 }
+#endif
@@ -6,12 +6,17 @@
 
 #include <vector>
 #include <string>
+#include <set>
 #include "compressors.h"
+#include "plugin.h"
 
 #define PROGNAME "lzbench"
 #define PROGVERSION "1.8"
 #define PAD_SIZE (16*1024)
+#define MAX_THREADS 256
+#define MAX_THREAD_COUNTS 32  // max. number of thread counts in -T#,#,#
 #define MIN_PAGE_SIZE 4096  // smallest page size we expect, if it's wrong the first algorithm might be a bit slower
+#define HUGE_PAGE_SIZE (2*1024*1024)  // transparent and hugetlbfs pages of x86-64 and aarch64
 #define DEFAULT_LOOP_TIME (100*1000000)  // 1/10 of a second
 #define GET_COMPRESS_BOUND(insize) (insize + insize/6 + PAD_SIZE)  // for pithy
 #define LZBENCH_PRINT(level, fmt, ...) if (params->verbose >= level) printf(fmt, __VA_ARGS__)
@@ -69,36 +74,439 @@
 	#define GetDiffTime(rate, start_ticks, end_ticks) ((end_ticks - start_ticks) * (uint64_t)rate.numer) / ((uint64_t)rate.denom)
 	#define PROGOS "MacOS"
 #else
+	#if defined(__x86_64__) || defined(__i386__)
+		#include <x86intrin.h> // __rdtsc
+		#include <cpuid.h>
+	#endif
+	#include <stdio.h>
 	typedef struct timespec bench_rate_t;
-    typedef struct timespec bench_timer_t;
+	typedef struct { struct timespec ts; uint64_t ticks; } bench_timer_t;
+	static double bench_tick_ns = 0; // nanoseconds per tick of the cycle counter selected with --timer=tsc, 0 = clock_gettime
 	#define InitTimer(rate)
-	#define GetTime(now) if (clock_gettime(CLOCK_MONOTONIC, &now) == -1 ){ printf("clock_gettime error"); };
-	#define GetDiffTime(rate, start_ticks, end_ticks) (1000000000ULL*( end_ticks.tv_sec - start_ticks.tv_sec ) + ( end_ticks.tv_nsec - start_ticks.tv_nsec ))
+	#define GetTime(now) do { if (bench_tick_ns) now.ticks = bench_read_ticks(); else if (clock_gettime(CLOCK_MONOTONIC, &now.ts) == -1 ){ printf("clock_gettime error"); } } while (0)
+	#define GetDiffTime(rate, start_ticks, end_ticks) (bench_tick_ns ? (uint64_t)((end_ticks.ticks - start_ticks.ticks) * bench_tick_ns) : (1000000000ULL*( end_ticks.ts.tv_sec - start_ticks.ts.tv_sec ) + ( end_ticks.ts.tv_nsec - start_ticks.ts.tv_nsec )))
 	#define PROGOS "Linux"
+
+	/* invariant TSC on x86, virtual counter CNTVCT_EL0 on aarch64 */
+	static inline uint64_t bench_read_ticks()
+	{
+	#if defined(__x86_64__) || defined(__i386__)
+		_mm_lfence(); // don't let rdtsc run ahead of the timed code
+		return __rdtsc();
+	#elif defined(__aarch64__)
+		uint64_t ticks;
+		asm volatile("isb; mrs %0, cntvct_el0" : "=r"(ticks));
+		return ticks;
+	#else
+		return 0;
+	#endif
+	}
+
+	/* nanoseconds per tick of bench_read_ticks() or 0 if there is no usable counter */
+	double bench_calibrate_ticks()
+	{
+	#if defined(__x86_64__) || defined(__i386__)
+		unsigned int a, b, c, d;
+		if (!__get_cpuid(0x80000007, &a, &b, &c, &d) || !(d & (1 << 8)))
+			fprintf(stderr, "warning: TSC is not invariant, results depend on the clock frequency\n");
+		struct timespec ts0, ts1;
+		uint64_t t0, t1;
+		clock_gettime(CLOCK_MONOTONIC, &ts0);
+		t0 = bench_read_ticks();
+		do clock_gettime(CLOCK_MONOTONIC, &ts1); while (1000000000ULL*(ts1.tv_sec - ts0.tv_sec) + (ts1.tv_nsec - ts0.tv_nsec) < 50000000); // 50 ms
+		t1 = bench_read_ticks();
+		return (1000000000.0*(ts1.tv_sec - ts0.tv_sec) + (ts1.tv_nsec - ts0.tv_nsec)) / (t1 - t0);
+	#elif defined(__aarch64__)
+		uint64_t freq;
+		asm volatile("mrs %0, cntfrq_el0" : "=r"(freq));
+		return freq ? 1000000000.0 / freq : 0;
+	#else
+		return 0;
+	#endif
+	}
+	#define BENCH_HAS_TICKS
 #endif
 #endif
 
 
+#define LATENCY_PERCENTILES 3  // p50, p99, p99.9
+#define LZ_STAT_BUCKETS 6  // --lz-stats: buckets of match lengths and of offsets
+#define IOVEC_PATHS 5 // --iovec: compression from contiguous input, gathered by a copy and streamed, decompression to contiguous and scattered output
+enum perfcounter_e { PERF_CYCLES=0, PERF_INSTRUCTIONS, PERF_LLC_MISSES, PERF_BRANCH_MISSES, PERF_DTLB_MISSES, PERF_COUNTERS };
+enum topdown_e { TD_CYCLES=0, TD_FRONTEND, TD_SLOT_A, TD_SLOT_B, TD_SLOT_C, TD_MEM_STALLS, TD_ALL_STALLS, TOPDOWN_EVENTS }; // --topdown, raw events by core
+
+/* core frequency in MHz sampled after passes */
+typedef struct
+{
+    double sum;
+    float min, max;
+    uint32_t count;
+} lzbench_freq_t;
+
+#define RANGE_SIZES_MAX 8
+#define XZ_SCALING_MAX 8
+#define TTFB_SIZES_MAX 4
+#define ZRAM_CLASSES 8 // --zram: sizes of compressed pages in eighths of a page
+#define PREDICT_FEATURES_NB 6 // --predict: order-0 and order-1 entropy, match coverage, text, zero and high bytes
+#define PREDICT_SAMPLES 16 // --predict: samples of 64 KB spread over a file
+#define PREDICT_NEIGHBORS 3 // --predict: nearest files of the model in the prediction
+#define PLACEMENTS_MAX 27 // --placement: combinations of buffers and memory nodes, all of 3 nodes
+
+/*
+ * --dedup: content-defined chunking, fingerprints and index of the input, best of DEDUP_PASSES,
+ * --long-range: the references of the pre-pass replace the recipe and its residual the unique chunks
+ */
+typedef struct
+{
+    size_t insize, unique_size; // bytes of the input and of its unique chunks
+    size_t chunks, unique; // number of chunks and of unique chunks
+    size_t recipe; // bytes of the list of chunks needed to rebuild the input, 4 bytes per chunk and per unique chunk
+    uint64_t chunk_ns; // gear hash and cut points alone
+    uint64_t dedup_ns; // chunking, fingerprints, index and the copy of unique chunks
+    uint64_t restore_ns; // rebuild of the input from the unique chunks
+    size_t matches, memory; // --long-range: number of references and bytes of the hash table
+} lzbench_dedup_t;
+
+/* hardware counters summed over all threads and iterations, a value of UINT64_MAX means unavailable */
+
+typedef struct
+{
+    uint64_t cvalues[PERF_COUNTERS], dvalues[PERF_COUNTERS];
+    uint64_t ctopdown[TOPDOWN_EVENTS], dtopdown[TOPDOWN_EVENTS]; // --topdown
+    uint64_t cbytes, dbytes;
+    uint64_t cenergy, denergy; // RAPL package energy in microjoules
+    uint64_t cenergy_ns, denergy_ns; // time of passes with energy, 0 = unavailable
+    lzbench_freq_t cfreq, dfreq;
+    uint64_t throttle; // thermal throttle events of all CPUs during the test
+    uint64_t cg_throttled; float cg_throttled_ms; // periods in which the CFS quota of the cgroup throttled lzbench during the test and the time
+    float cpipe, dpipe; // MB/s of --pipeline from and to files, 0 = not measured
+    uint64_t ckernel_ns, ctransfer_ns, dkernel_ns, dtransfer_ns; // --cuda-streams: time of kernels and of transfers measured by events
+    uint64_t cuda_alloc_ns, cuda_metadata_ns, cuda_pool_hits; // nvcomp: time of allocations of init and of reading metadata, buffers and streams reused from the pool
+    uint64_t cgpu_bytes, dgpu_bytes; // --hybrid: input bytes of nvcomp_lz4_hybrid processed by the GPU
+    uint64_t dedup_insize, dedup_recipe, dedup_ns, dedup_restore_ns; // --dedup: of the input before dedup, 0 = not deduplicated
+    uint64_t zstd_trace[ZSTD_TRACE_COUNTERS]; // --zstd-trace: frames and ns of frames, match finding, literals and sequences of compression
+    uint64_t gpu_ns[2][CUDA_DEVICES_MAX], gpu_bytes[2][CUDA_DEVICES_MAX]; // --gpus: busy time and uncompressed bytes of every device
+    uint64_t ru_user_ns[2], ru_sys_ns[2], ru_wall_ns[2], ru_passes[2]; // --rusage: CPU time of all threads in user and kernel mode and wall time of (de)compression passes
+    uint64_t ru_minflt[2], ru_majflt[2], ru_nvcsw[2], ru_nivcsw[2]; // --rusage: minor and major page faults, voluntary and involuntary context switches
+    uint64_t cchunks, cskipped; // --precheck: compressed chunks and chunks stored without running the codec
+    float ratio_mean, ratio_ci; // --sample: mean ratio of blocks in % and the half-width of its 95% confidence interval
+    float rlat[LATENCY_PERCENTILES], rmean, rrate; // --random-reads: latency of a read in us and reads per second
+    float shared_dspeed[MAX_THREAD_COUNTS]; // --dthreads: MB/s of all threads decoding the same compbuf with each count
+    int lz_parsed; // --lz-stats: the parse below was taken
+    uint64_t lz_matches; // --lz-stats: number of matches
+    float lz_literals, lz_mean_len, lz_repeats; // --lz-stats: literal bytes in % of the input, mean match length, matches at one of the 3 previous offsets in %
+    float lz_len[LZ_STAT_BUCKETS], lz_off[LZ_STAT_BUCKETS]; // --lz-stats: matches in % by length and by offset in buckets of lz_len_limits[] and lz_off_limits[]
+    int64_t imargin; // --inplace: largest margin of a chunk in bytes, -1 = the decoder can't decompress in place
+    float ispeed; // --inplace: MB/s of in-place decompression
+    float iov_speed[IOVEC_PATHS]; // --iovec: MB/s of every path of iovec_paths[], 0 = not run
+    float llat[2][LATENCY_PERCENTILES], lbusy[2]; // --load: response time in us of compression and decompression requests and % of time workers were busy
+    float tlat[2][LATENCY_PERCENTILES], tspeed[2], trate; // --trace: latency in us and MB/s of compression and decompression records, records per second
+    uint64_t dunfused_ns; // --consume: best pass of decompression of all chunks followed by the consumer over all of them
+    float ttfb_us[TTFB_SIZES_MAX]; // --ttfb: median over chunks of the time to the first bytes of output of streaming decompression, 0 = not measured
+    float nslow[2], ngbs; // --noise: median time of (de)compression passes with co-runners over the quiet median, GB/s of the co-runners
+    float sinit_us, sdeinit_us, sfirst_us[2], scold_us[3]; // --setup: median of init, deinit and the first compression and decompression of a new context, init and the first calls in a new process
+    uint64_t cfirst_ns, dfirst_ns; // --warmup: the first (de)compression pass with lazy initialization, page faults and cold caches
+    uint32_t fcases, frejected, fcrashes, fhangs, fanomalies; // --fuzz: mutated chunks decoded, rejected by the decoder, crashes, hangs and output-size anomalies
+    float fworst_us, fworst_x; // --fuzz: slowest decode of a mutated chunk in us and its time against the decode of the intact chunk
+    float alat[LATENCY_PERCENTILES], aflush, aflush_pct, aratio, aoneshot; // --append: latency of an append and mean of a flush in us, % of time in flushes, ratio in % and size in % of one-shot compression
+    float slat[RANGE_SIZES_MAX][2], samp[RANGE_SIZES_MAX], sdecoded[RANGE_SIZES_MAX]; // --range-reads: p50 and p99 of a read in us, compressed and decompressed bytes per byte read
+    uint64_t sindex_bytes, sindex_ns; // --range-reads: size of the seek table or zran index and time to build it from the compressed object
+    float dprepare_ms, dcall_us; // brotli_dict: preparation of the dictionary and the time it adds to every call
+    uint32_t xblocks, xthreads[XZ_SCALING_MAX], xcount; // xzmt: blocks of the stream and thread counts of the decompression scaling
+    float xdspeed[XZ_SCALING_MAX]; // xzmt: MB/s of block-parallel decompression with xthreads
+    uint64_t delta_plain; // --delta: size of the input compressed by the codec without the reference
+    float delta_cspeed, delta_dspeed; // --delta: MB/s of compression and decompression without the reference
+    uint64_t filter_plain; // -e "filters+codec": size of the input compressed by the codec without the filters
+    float filter_fspeed, filter_ispeed; // -e "filters+codec": MB/s of the filters and of their inverse alone
+    uint64_t mt_plain; // -e "mt#:codec": size of the input compressed by the codec alone without the blocks
+    float mt_plain_cms, mt_plain_dms; // -e "mt#:codec": ms to compress and decompress a chunk by the codec alone on one thread
+    float ilv_dspeed, ilv_seq_dspeed; // lz4_ilv#, snappy_ilv#: MB/s of batches decoded interleaved and one chunk after another
+    uint64_t zpages, zzero, zsame, zhuge, zbytes; // --zram: pages, zero-filled and other same-value pages, pages stored as they are, bytes stored
+    uint64_t zstore_ns, zload_ns; // --zram: best pass of storing and loading all pages
+    uint64_t zsizes[ZRAM_CLASSES]; // --zram: compressed pages by eighths of a page
+    uint64_t tc_dns, tc_cns, tc_fused_ns; // --transcode: best pass of decompression by the source codec, of compression and of both fused
+    uint64_t tc_mt_ns, tc_mt_cpu_ns; // --transcode: best fused pass on the threads of the test and the busy time of its threads
+    int tc_threads;
+    uint64_t kio_cns, kio_dns; // kernel_#: best pass of compression and decompression of zero-filled chunks through the same zram path
+    uint32_t pl_count; // --placement: combinations measured
+    float pl_cspeed[PLACEMENTS_MAX], pl_dspeed[PLACEMENTS_MAX], pl_dchunk_us[PLACEMENTS_MAX]; // --placement: MB/s of compression and decompression and us to decompress a chunk
+    uint64_t cllc_bytes, dllc_bytes; // --llc-mon: highest L3 occupancy at the end of a pass, 0 = unavailable
+    uint64_t cmbm_bytes, dmbm_bytes; // --llc-mon: bytes read and written to memory by passes
+    uint64_t cmbm_ns, dmbm_ns; // time of passes with memory bandwidth, 0 = unavailable
+    uint32_t rot_inputs; // --rotate: distinct chunks of a pass, 0 = not measured
+    uint64_t rot_bytes; // --rotate: bytes of a pass
+    uint64_t rot_cns[2], rot_dns[2]; // --rotate: best pass of compression and decompression of the first chunk and of rotated chunks
+    uint32_t sp_blocks, sp_slot; // --spsc: blocks of a pass, 0 = not measured, and bytes of a slot of the ring
+    int sp_cpus[2]; // --spsc: CPUs of the decoder and the consumer, -1 = not pinned
+    uint64_t sp_bytes, sp_ns, sp_decode_ns, sp_serial_ns; // --spsc: best pass through the ring, of decompression alone and of both on one thread
+    uint64_t sp_local_ns, sp_remote_ns; // --spsc: busy time of the consumer on the decoder's thread and on the other CPU
+    uint64_t sp_full, sp_empty; // --spsc: blocks that found the ring full (decoder) or empty (consumer)
+    uint32_t ss_blocks; // --sstable: blocks of the file, 0 = not measured
+    uint64_t ss_records, ss_file_bytes, ss_index_bytes, ss_restart_bytes, ss_build_ns; // --sstable: the file with its index and the time to build it
+    float ss_lat[LATENCY_PERCENTILES], ss_rate; // --sstable: latency of a point lookup in us and lookups per second
+    float ss_scan_mbs, ss_scan_blocks; // --sstable: MB/s of values of scans and blocks decompressed by a scan
+    uint32_t sb_calls; // --sandbox: chunks of a pass, 0 = not measured
+    uint64_t sb_ns[3]; // --sandbox: best pass in the process, with a round trip per chunk and with one for all chunks
+    float sb_lat[2][LATENCY_PERCENTILES]; // --sandbox: latency of a chunk in us in the process and with a round trip
+} lzbench_counters_t;
+
+/* memory of a codec seen by the counting allocator and malloc_usable_size() of workmem */
+typedef struct
+{
+    uint64_t init_bytes; // allocated by desc->init for all threads
+    uint64_t cpeak, dpeak; // peak bytes allocated on top of init during compression and decompression
+    float callocs, dallocs; // allocations per compress and decompress call
+} lzbench_memory_t;
+
+/* a record of --trace: compression or decompression of size bytes of the input at offset */
+typedef struct
+{
+    bool decompress;
+    size_t size;
+    int64_t offset; // -1 = after the previous record
+} lzbench_trace_t;
+
 typedef struct string_table
 {
     std::string col1_algname;
     uint64_t col2_ctime, col3_dtime, col4_comprsize, col5_origsize;
     std::string col6_filename;
-    string_table(std::string c1, uint64_t c2, uint64_t c3, uint64_t c4, uint64_t c5, std::string filename) : col1_algname(c1), col2_ctime(c2), col3_dtime(c3), col4_comprsize(c4), col5_origsize(c5), col6_filename(filename) {}
+    int threads, numa_mode;
+    int pages; // hugepage_e of the benchmark buffers
+    int host; // hostmem_e of the benchmark buffers
+    int precheck; // precheck_e of the compression
+    float precheck_speedup; // compression speed with --precheck divided by the speed without it, 0 = unknown
+    int page_cache; // pagecache_e when the input file was read
+    const char* isa; // instruction set of the path of the codec on this CPU, see codec_isa()
+    float thr_cspeed, thr_dspeed; // average speed of a single thread in MB/s
+    lzbench_counters_t counters;
+    float clat[LATENCY_PERCENTILES], dlat[LATENCY_PERCENTILES]; // per-chunk latency in us
+    uint64_t cold_ctime, cold_dtime; // time of a pass with evicted caches
+    lzbench_memory_t memory;
+    float cstddev, cci, dstddev, dci; // standard deviation and half-width of 95% confidence interval in % of the mean
+    std::string name, version; // filled only for JSON output
+    int level;
+    size_t chunk_size;
+    size_t block_size; // -b# of the test, chunk_size is what the codec got
+    int core_type; // --core-types: index of the type of the CPUs of the test, -1 = any CPU
+    int llc_ways; // --llc-ways: L3 ways of the resctrl group of the test, 0 = all of the cache
+    size_t buf_offset; // --offsets: bytes of the buffers of the test past a page boundary
+    std::vector<size_t> file_sizes;
+    std::vector<uint64_t> csamples, dsamples; // raw times of iterations in ns
+    bool checksum; // a row of is_checksum(), it has no decompression
+    bool unmeasured; // --ratio-only: no times were taken, speeds are shown as -
+    uint64_t messages; // --msg: calls of a compression or decompression pass, 0 = not used
+    std::string failure; // --isolate: how the process of the test ended when it failed (signal, exit code or timeout)
+    uint64_t max_rss_kb; // --isolate: peak resident memory of the process of the test
+    string_table(std::string c1, uint64_t c2, uint64_t c3, uint64_t c4, uint64_t c5, std::string filename) : col1_algname(c1), col2_ctime(c2), col3_dtime(c3), col4_comprsize(c4), col5_origsize(c5), col6_filename(filename), threads(1), numa_mode(0), pages(0), host(0), precheck(0), precheck_speedup(0), page_cache(0), isa(""), thr_cspeed(0), thr_dspeed(0), counters(), clat(), dlat(), cold_ctime(0), cold_dtime(0), memory(), cstddev(0), cci(0), dstddev(0), dci(0), level(0), chunk_size(0), block_size(0), core_type(-1), llc_ways(0), buf_offset(0), checksum(false), unmeasured(false), messages(0), max_rss_kb(0) {}
 } string_table_t;
 
-enum textformat_e { MARKDOWN=1, TEXT, TEXT_FULL, CSV, TURBOBENCH, MARKDOWN2 };
+enum textformat_e { MARKDOWN=1, TEXT, TEXT_FULL, CSV, TURBOBENCH, MARKDOWN2, JSON };
 enum timetype_e { FASTEST=1, AVERAGE, MEDIAN };
+enum pinmode_e { PIN_NONE=0, PIN_CORE, PIN_NODE };
+enum numamode_e { NUMA_DEFAULT=0, NUMA_LOCAL, NUMA_INTERLEAVE, NUMA_REMOTE };
+enum coldmode_e { COLD_NONE=0, COLD_SWEEP, COLD_FLUSH };
+enum mmapmode_e { MMAP_NONE=0, MMAP_READ, MMAP_POPULATE, MMAP_WILLNEED };
+enum hugepage_e { HUGE_NONE=0, HUGE_THP, HUGE_TLB };
+enum hostmem_e { HOST_PAGEABLE=0, HOST_PINNED, HOST_REGISTERED };
+enum precheck_e { PRECHECK_NONE=0, PRECHECK_ENTROPY, PRECHECK_LZ4 };
+enum breakdown_e { BREAKDOWN_NONE=0, BREAKDOWN_TYPE, BREAKDOWN_FILE };
+enum pagecache_e { PAGECACHE_ANY=0, PAGECACHE_COLD, PAGECACHE_WARM, PAGECACHE_MEM };
+enum readahead_e { READAHEAD_DEFAULT=0, READAHEAD_NORMAL, READAHEAD_SEQUENTIAL, READAHEAD_RANDOM };
+enum predict_e { PREDICT_NONE=0, PREDICT_FEATURES, PREDICT_ONLY, PREDICT_RUN };
+enum sandbox_e { SANDBOX_NONE=0, SANDBOX_STRICT, SANDBOX_FILTER };
+enum contexts_e { CONTEXTS_REUSE=0, CONTEXTS_PERCALL, CONTEXTS_BOTH };
+enum alloc_e { ALLOC_MALLOC=0, ALLOC_ARENA, ALLOC_BOTH };
+enum freshout_e { FRESH_NONE=0, FRESH_OUTPUT, FRESH_BOTH };
+enum bandwidth_e { BW_READ=0, BW_WRITE, BW_COPY, BW_WRITE_NT, BW_COPY_NT, BW_KERNELS };
+enum noise_e { NOISE_NONE=0, NOISE_STREAM, NOISE_CHASE };
+enum calibrate_e { CALIBRATE_NONE=0, CALIBRATE_MEMCPY, CALIBRATE_ALU };
 
 typedef struct
 {
     int show_speed, compress_only;
+    int decompress_only; // load compressed data of --cache instead of compression
+    const uint8_t* decode_data; // --decompress-only of a compressed file: its content is the compressed data of the test
+    size_t decode_size;
+    const char* cache_dir; // compressed data of all codecs and levels is stored here
+    const char* results_cache; // --results-cache: rows of every codec and level are stored here and reused by later runs
+    std::string results_settings; // --results-cache: options of the command line that change results
+    uint64_t input_hash; // --results-cache: hash of the input of lzbench_run_tests()
     timetype_e timetype;
     textformat_e textformat;
     size_t chunk_size;
     uint32_t c_iters, d_iters, cspeed, verbose, cmintime, dmintime, cloop_time, dloop_time;
     size_t mem_limit;
+    size_t mem_budget; // --mem-budget: memory of the whole process in bytes that sets mem_limit of every file, 0 = not used
+    std::vector<std::pair<int, int> > budget_skip; // --mem-budget: comp_desc index and level of jobs that don't fit
+    std::vector<int64_t> budget_skip_bytes; // and their working set per thread
     int random_read;
+    int threads, max_threads; // current and the highest number of threads
+    int thread_counts[MAX_THREAD_COUNTS], thread_counts_nb;
+    pinmode_e pin_mode;
+    numamode_e numa_mode;
+    int work_stealing;
+    int load_threads; // pool that reads the files of -j
+    int archive; // --archive: members of tar and zip files are the files of -j
+    double load_ms; // time of reading them
+    size_t dict_size; // --dict: capacity of the trained dictionary, 0 = not used
+    std::vector<char> dict;
+    std::vector<char> brotli_dict; // --brotli-dict: custom dictionary of brotli_dict, otherwise the one of --dict
+    std::vector<char> delta_ref; // --delta: reference (version N-1) that delta codecs compress the input against
+    double dict_ms; // time of training
+    int dict_samples; // number of files it was trained from
+    breakdown_e breakdown;
+    uint32_t random_reads; // number of decompressions of random chunks
+    int sandbox; // --sandbox: sandbox_e
+    size_t sstable_block; // --sstable: bytes of a block of the file of records, 0 = off
+    uint32_t sstable_restart, sstable_scan; // --sstable: records between restart points and of a scan
+    int spsc_depth; // --spsc=#: blocks of the ring between the decoder and the consumer thread, 0 = off
+    int rotate; // --rotate=#: distinct chunks of the input taken in turn by calls of a pass, 0 = off
+    int dthread_counts[MAX_THREAD_COUNTS], dthread_counts_nb; // --dthreads: decompression-only scaling with a shared compbuf
+    FILE* chunk_map; // --chunk-map: offset, sizes and times of every chunk of every test
+    int chunk_map_json; // --chunk-map: JSON Lines instead of CSV
+    FILE* timeline; // --timeline: Chrome trace events written at exit
+    int lz_stats; // --lz-stats: literals, match lengths and offsets of the LZ77 parse of lz4 and zstd codecs
+    int inplace; // --inplace: decompress every chunk from the tail of its own output buffer
+    size_t iovec_min, iovec_max, iovec_align; // --iovec: sizes of fragments of the input and output in bytes and alignment of their starts, 0 = not used
+    uint32_t range_reads; // --range-reads: reads of random ranges of every size of range_sizes through the seek table of zstd_seekable or the zran index of deflate_indexed
+    std::vector<size_t> range_sizes;
+    int noise_mode, noise_threads; // --noise: noise_e co-runners, their number (0 = the CPUs that the test leaves)
+    float noise_gbs; // --noise: target GB/s of all stream co-runners, 0 = as fast as they go
+    size_t noise_size; // --noise: buffer of every co-runner
+    consume_func consumer; // --consume: run on every chunk right after its decompression, NULL = none
+    const char* consume_name;
+    std::vector<size_t> ttfb_sizes; // --ttfb: bytes of output of the time to first bytes
+    size_t zram_page; // --zram: bytes of a page, 0 = off
+    std::string transcode; // --transcode: source codec "name[,level]" of the codecs of -e
+    std::vector<int> placements; // --placement: memory nodes of inbuf, compbuf and decomp of every combination, -1 = where the test left them
+    int setup; // --setup: time init, deinit and the first calls of new contexts
+    uint32_t warmup_passes, warmup_ms; // --warmup: unrecorded passes before compression and decompression, at least # passes and # ms
+    double load_rate; // --load: requests per second, 0 = no load test
+    std::vector<double> ingest_rates; // --ingest: MB/s of chunks released to the workers, empty = none
+    int match_finders; // --match-finders: time the match finders of matchfinders.c instead of the codecs
+    unsigned mf_nice_len, mf_depth; // --match-finders: nice match length and search depth (chain steps or tree nodes)
+    size_t mf_window; // --match-finders: history of the finders of LZMA, xz and fast-lzma2
+    double soak_hours, soak_interval, soak_threshold; // --soak: duration of a job, seconds of a row and % of drift and growth
+    int interop; // --interop: every encoder of -e decoded by all rows of its family of interop_desc
+    int load_poisson; // --load: exponential gaps between arrivals instead of fixed ones
+    uint32_t load_requests; // --load: requests of compression and of decompression
+    size_t append_size, append_records, append_bytes; // --append: size of records, flush every # records and every # bytes, 0 = never
+    const char* trace_file; // --trace: records of operations to replay
+    std::vector<lzbench_trace_t> trace;
+    size_t stdin_size; // bytes of input "-" to read, 0 = until the end
+    std::vector<std::string> file_names; // of file_sizes of -j for --breakdown
+    int solid; // -J: the joined files are run also as one stream cut into chunks across file boundaries, 2 = files sorted by extension
+    std::string bestof; // --bestof: candidates and selection of the meta-codec bestof of -e
+    int perf_counters;
+    int topdown; // --topdown: shares of the top-down method of the slots of (de)compression, implies --perf
+    int rusage; // --rusage: CPU time, page faults and context switches of (de)compression passes
+    int latency;
+    coldmode_e cold_mode;
+    size_t cold_size;
+    char* cold_buf; // eviction buffer for COLD_SWEEP
+    int memory;
+    mmapmode_e mmap_mode;
+    hugepage_e hugepages; // page size of inbuf, compbuf and decomp, --hugepages=both runs also HUGE_NONE first
+    int hugepages_both;
+    hostmem_e pinned; // --pinned: host memory of inbuf, compbuf and decomp for CUDA codecs, --pinned=both runs also HOST_PAGEABLE first
+    int pinned_both;
+    int mmap_direct; // use the mapping of a file as the input buffer
+    pagecache_e page_cache; // of the input file before it is read during a test
+    readahead_e readahead;
+    size_t feed_write, feed_flush; // --feed: bytes of a write and between flushes of streaming, 0 = not used
+    contexts_e contexts; // reuse of states of codecs from context_reuse[], see lzbench_context_reuse
+    alloc_e alloc; // allocator of codecs from allocator_aware[], see lzbench_mem_arena
+    freshout_e fresh_output; // decompression into pages dropped before every pass, --fresh-output=both runs also prefaulted decomp first
+    int stream; // read the next -m# part while the current one is benchmarked
+    int merge_parts; // rows of parts are printed merged by lzbench_merge_parts()
+    int stats; // show spread of iterations and reject slow outliers
+    float ci_target; // adaptive stopping when the 95% confidence interval is below ci_target % of the mean
+    uint32_t ci_maxtime; // time limit of adaptive stopping in ms
+    int timer_tsc;
+    const char* cpu_brand;
+    const char* baseline_file; // results of a previous run written with -o4 or -o7
+    int predict; // --predict: predict_e
+    const char* predict_model; // --predict=file: results and features of a previous run written with --predict -o7
+    float speed_threshold, ratio_threshold; // regressions in %
+    int pareto;
+    int energy;
+    int llc_mon; // --llc-mon: L3 occupancy and memory bandwidth of resctrl monitoring
+    const char* pipeline_dir; // --pipeline writes compressed and decompressed files here
+    int pipeline_direct; // O_DIRECT for all files of --pipeline
+    int uring_depth; // io_uring queue depth of --pipeline, 0 = synchronous I/O
+    int cuda_streams; // --cuda-streams: streams of the pipelined nvcomp_lz4, 0 = not pipelined
+    int hybrid; // --hybrid: show the share of the GPU of nvcomp_lz4_hybrid
+    int gpus; // --gpus: devices of nvcomp_lz4_batch, 0 = only the current one
+    precheck_e precheck; // --precheck: test of chunks that are stored without compression, every codec is run also without it
+    float precheck_threshold; // bits per byte of PRECHECK_ENTROPY or % of PRECHECK_LZ4 from which a chunk is stored
+    uint64_t precheck_base; // compression time of the run without --precheck, 0 = unknown
+    const char* in_path; // the input file when it is benchmarked as a whole, otherwise NULL
+    float freq_threshold; // warn when the frequency moves more than # %, 0 = don't monitor
+    int interleave, rounds; // 1 = round robin, 2 = random order of codecs in every round
+    int parallel; // --parallel: workers that run different jobs at once on their own cores, -1 = one per core
+    int quiesce, quiesce_cpu; // --quiesce: run on a single CPU with SCHED_FIFO and mlockall(), -1 = the last allowed CPU
+    std::string quiesce_state; // --quiesce: what was applied and measured, printed with the results
+    bool parallel_nosmt, parallel_spare; // --parallel: one CPU of every core, leave the first core of every package idle
+    int isolate; // --isolate: every job runs in a process of its own
+    int cold_start; // --cold-start: fresh processes of lzbench per job that compress and decompress the first chunk once, 0 = none
+    int processes; // -P#: every test is run by # forked processes at once, each on its own part of a shared input
+    uint32_t isolate_timeout; // --isolate: seconds after which the process of a job is killed, 0 = never
+    std::set<std::string> gen_inputs; // --gen: names of generated inputs in the list of files, "gen:" and the spec
+    size_t pathological_size; // --pathological: size of every generated input in bytes, 0 = none
+    uint32_t fuzz_cases, fuzz_timeout_ms; // --fuzz: mutated chunks decoded per codec and ms after which a decode is a hang
+    int collect_jobs; // lzbench_test_threads() only adds to jobs
+    int library; // lzbench_bench() of liblzbench.h: rows are only kept in results, nothing is printed
+    std::vector<std::pair<int, int> > jobs; // comp_desc index and level
+    std::vector<std::string> job_options; // options of -e of every job
+    std::vector<std::string> job_filters; // filters of -e of every job
+    std::string codec_options; // options of -e of the current codec and level, see lzbench_set_options()
+    std::string filters; // chain of pre-filters of -e of the current codec, e.g. "delta8+bitshuffle"
+    int block_threads; // -e "mt#:codec": threads of the block-parallel wrapper of the current codec, 0 = none
+    int no_prune, below_cspeed; // skip higher levels of a codec after a level slower than -s#
+    int no_batch; // --no-batch: compress and decompress of every chunk also for codecs with compress_batch
+    int search;
+    float search_cspeed, search_dspeed, search_ratio; // constraints of level search in MB/s and %
+    int ratio_only; // --ratio-only: a single compression pass for the size of every test, 2 = and a single verifying decompression
+    int recommend, recommend_top; // --recommend: probe all jobs on a sample, then benchmark the best recommend_top of them
+    float recommend_cspeed, recommend_dspeed, recommend_memory; // constraints of --recommend in MB/s and MB, 0 = none
+    size_t recommend_sample; // bytes of the sample, 0 = 1/16 of the input (at least 1 MB)
+    float adapt_mbps; // --adapt: MB/s of the simulated output link of adaptive-level streaming of zstd, 0 = none
+    int adapt_min, adapt_max; // range of levels of the controller of --adapt
+    int mix; // --mix: chunks go to the codecs of -e in turn in one timed loop, compared with each codec alone
+    std::vector<int> mix_weights; // chunks of every codec per turn of --mix, empty = 1 each
+    std::vector<size_t> stream_counts; // --streams: numbers of concurrent streaming contexts per job, empty = none
+    size_t stream_write; // bytes of every write to one of the contexts of --streams
+    int tune_level; // --tune: level of zstd around which its compression parameters are searched, 0 = none
+    float tune_cspeed; // compression speed in MB/s of the tuned parameters, 0 = that of the level
+    int show_isa; // --isa: show the instruction set of every codec
+    uint32_t sample_blocks, sample_seed; // --sample: blocks of -b# spread over all inputs and the seed of their offsets
+    float pareto_weight; // weight of compression time in the combined Pareto frontier, < 0 = not printed
+    int summary; // --summary: aggregate of every compressor over all files after the results
+    std::vector<double> link_gbits; // --transfer: speeds of links in Gbit/s of the transfer time report
+    double cost_gb, cost_core_hour; // --cost: $ per GB stored or shipped and per core-hour of CPU time, 0 = not shown
+    double cpb_ghz; // clock frequency used for cycles per byte, 0 = don't show
+    std::vector<size_t> block_sizes; // -b#,#,... or --block=#,#,...: every test is run with each chunk size in turn
+    int block_sweep; // lzbench_run_tests() is running the tests of one of block_sizes
+    int per_core_type; // --core-types: every test is run on the CPUs of each core type in turn
+    int core_sweep; // lzbench_run_tests() is running the tests of one of the core types
+    std::vector<int> llc_ways; // --llc-ways=#,#,...: every test is run with # ways of the L3 cache in turn
+    int llc_sweep; // lzbench_run_tests() is running the tests of one of llc_ways
+    std::vector<size_t> buf_offsets; // --offsets=#,#,...: every test is run with its buffers # bytes past a page boundary in turn
+    int offset_sweep; // lzbench_run_tests() is running the tests of one of buf_offsets
+    size_t buf_offset; // --offsets: the offset of the buffers of the running tests
+    std::vector<size_t> msg_sizes; // --msg: sizes in bytes of messages cut from the input in turn, empty = chunks of -b#
+    int msg_random; // --msg=min-max: msg_sizes holds the range of uniformly random sizes
+    std::vector<size_t> msg_batches; // --msg-batch: messages per compress call, empty = none
+    double msg_batch_rate; // arrival rate of messages per second of --msg-batch, 0 = 10000
+    size_t dedup_size; // --dedup: average size of content-defined chunks, 0 = the codecs get the input itself
+    lzbench_dedup_t dedup; // --dedup: the pre-stage of the current input, the codecs get its unique chunks
+    size_t long_range_window, long_range_block; // --long-range: window and block size of the pre-pass, 0 = none
+    int dedup_sweep; // lzbench_run_tests() is running the tests of the unique chunks of dedup or of the residual of --long-range
+    int bandwidth;
+    std::vector<std::vector<float> > bandwidth_mbs; // --bandwidth of every kernel for every entry of thread_counts
+    int calibrate; // --calibrate: calibrate_e basis of the normalised speed columns
+    float cal_memcpy_mbs, cal_chase_ns, cal_alu_mops; // --calibrate: single-core memcpy, latency of a dependent load, integer ALU ops
     std::vector<string_table_t> results;
     const char* in_filename;
 } lzbench_params_t;
@@ -109,23 +517,6 @@ struct less_using_3rd_column { inline bool operator() (const string_table_t& str
 struct less_using_4th_column { inline bool operator() (const string_table_t& struct1, const string_table_t& struct2) {  return (struct1.col4_comprsize < struct2.col4_comprsize); } };
 struct less_using_5th_column { inline bool operator() (const string_table_t& struct1, const string_table_t& struct2) {  return (struct1.col5_origsize < struct2.col5_origsize); } };
 
-typedef int64_t (*compress_func)(char *in, size_t insize, char *out, size_t outsize, size_t, size_t, char*);
-typedef char* (*init_func)(size_t insize, size_t, size_t);
-typedef void (*deinit_func)(char* workmem);
-
-typedef struct
-{
-    const char* name;
-    const char* version;
-    int first_level;
-    int last_level;
-    int additional_param;
-    int max_block_size;
-    compress_func compress;
-    compress_func decompress;
-    init_func init;
-    deinit_func deinit;
-} compressor_desc_t;
 
 
 typedef struct
@@ -136,37 +527,108 @@ typedef struct
 
 
 
-#define LZBENCH_COMPRESSOR_COUNT 72
+#define LZBENCH_COMPRESSOR_COUNT 165
+
+static const stream_desc_t brotli_stream = { lzbench_brotli_stream_begin, lzbench_brotli_stream_feed, lzbench_brotli_stream_flush, lzbench_brotli_stream_end, NULL };
+static const stream_desc_t lz4_stream = { lzbench_lz4_stream_begin, lzbench_lz4_stream_feed, NULL, lzbench_lz4_stream_end, lzbench_lz4_stream_decompress };
+static const stream_desc_t xz_stream = { lzbench_xz_stream_begin, lzbench_xz_stream_feed, NULL, lzbench_xz_stream_end, NULL };
+static const stream_desc_t zlib_stream = { lzbench_zlib_stream_begin, lzbench_zlib_stream_feed, lzbench_zlib_stream_flush, lzbench_zlib_stream_end, NULL };
+static const stream_desc_t zstd_stream = { lzbench_zstd_stream_begin, lzbench_zstd_stream_feed, lzbench_zstd_stream_flush, lzbench_zstd_stream_end, NULL };
+
+/* --ttfb: streaming decoders of codecs by their decompress function, they stop when outsize bytes of output exist */
+static const struct { compress_func decompress, first_bytes; } ttfb_decoders[] =
+{
+    { lzbench_brotli_decompress, lzbench_brotli_first_bytes },
+    { lzbench_lz4_decompress, lzbench_lz4_first_bytes },
+    { lzbench_lz4frame_decompress, lzbench_lz4frame_first_bytes },
+    { lzbench_xz_decompress, lzbench_xz_first_bytes },
+    { lzbench_xzmt_decompress, lzbench_xzmt_first_bytes },
+    { lzbench_zlib_decompress, lzbench_zlib_first_bytes },
+    { lzbench_zstd_decompress, lzbench_zstd_first_bytes },
+};
 
 static const compressor_desc_t comp_desc[LZBENCH_COMPRESSOR_COUNT] =
 {
-    { "memcpy",     "",            0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy,                NULL,                    NULL },
+    { "memcpy",     "",            0,   0,    0, NO_LIMIT, lzbench_return_0,            lzbench_memcpy,                NULL,                    NULL, NULL, lzbench_copy_bound },
+    { "memcpy_movsb", "",          0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy_movsb,          NULL,                    NULL },
+    { "memcpy_avx2", "",           0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy_avx2,           NULL,                    NULL },
+    { "memcpy_avx2nt", "",         0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy_avx2nt,         NULL,                    NULL },
+    { "memcpy_avx512", "",         0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy_avx512,         NULL,                    NULL },
+    { "memcpy_avx512nt", "",       0,   0,    0,       0, lzbench_return_0,            lzbench_memcpy_avx512nt,       NULL,                    NULL },
+    { "memcpy_short", "",          1,  64,    0,       0, lzbench_return_0,            lzbench_memcpy_short,          NULL,                    NULL },
+    { "memcpy_fastcopy", "2.9.3",  0,  64,    0,       0, lzbench_return_0,            lzbench_memcpy_fastcopy,       NULL,                    NULL },
     { "blosclz",    "2.9.3",       1,   9,    0, 64*1024, lzbench_blosclz_compress,    lzbench_blosclz_decompress,    NULL,                    NULL },
+    { "blosclzmt",  "2.9.3",       1,   9,    0,       0, lzbench_blosclzmt_compress,  lzbench_blosclzmt_decompress,  NULL,                    NULL },
     { "brieflz",    "1.3.0",       1,   9,    0,       0, lzbench_brieflz_compress,    lzbench_brieflz_decompress,    lzbench_brieflz_init,    lzbench_brieflz_deinit },
-    { "brotli",     "1.1.0",       0,  11,    0,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "brotli22",   "1.1.0",       0,  11,   22,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "brotli24",   "1.1.0",       0,  11,   24,       0, lzbench_brotli_compress,     lzbench_brotli_decompress,     NULL,                    NULL },
-    { "bzip2",      "1.0.8",       1,   9,    0,       0, lzbench_bzip2_compress,      lzbench_bzip2_decompress,      NULL,                    NULL },
+    { "brotli",     "1.1.0",       0,  11,    0, NO_LIMIT, lzbench_brotli_compress,     lzbench_brotli_decompress,     lzbench_brotli_init,     lzbench_brotli_deinit, &brotli_stream, lzbench_brotli_bound },
+    { "brotli22",   "1.1.0",       0,  11,   22, NO_LIMIT, lzbench_brotli_compress,     lzbench_brotli_decompress,     lzbench_brotli_init,     lzbench_brotli_deinit, &brotli_stream, lzbench_brotli_bound },
+    { "brotli24",   "1.1.0",       0,  11,   24, NO_LIMIT, lzbench_brotli_compress,     lzbench_brotli_decompress,     lzbench_brotli_init,     lzbench_brotli_deinit, &brotli_stream, lzbench_brotli_bound },
+    { "brotli_dict", "1.1.0",      2,  11,    0, NO_LIMIT, lzbench_brotli_dict_compress, lzbench_brotli_decompress,    lzbench_brotli_dict_init, lzbench_brotli_deinit }, // levels 0-1 ignore a prepared dictionary
+    { "brotli_delta", "1.1.0",     2,  11,    0, NO_LIMIT, lzbench_brotli_compress,     lzbench_brotli_decompress,     lzbench_brotli_init,     lzbench_brotli_deinit }, // --delta: compound dictionary
+    { "bzip2",      "1.0.8",       1,   9,    0, LIMIT_4G, lzbench_bzip2_compress,      lzbench_bzip2_decompress,      lzbench_bzip2_init,      lzbench_bzip2_deinit },
+    { "pbzip2",     "1.0.8",       1,   9,    0, LIMIT_4G, lzbench_pbzip2_compress,     lzbench_pbzip2_decompress,     lzbench_pbzip2_init,     lzbench_pbzip2_deinit },
     { "crush",      "1.0",         0,   2,    0,       0, lzbench_crush_compress,      lzbench_crush_decompress,      NULL,                    NULL },
     { "csc",        "2016-10-13",  1,   5,    0,       0, lzbench_csc_compress,        lzbench_csc_decompress,        NULL,                    NULL },
     { "density",    "0.14.2",      1,   3,    0,       0, lzbench_density_compress,    lzbench_density_decompress,    lzbench_density_init,    lzbench_density_deinit },
     { "fastlz",     "0.5.0",       1,   2,    0,       0, lzbench_fastlz_compress,     lzbench_fastlz_decompress,     NULL,                    NULL },
     { "fastlzma2",   "1.0.1",      1,  10,    0,       0, lzbench_fastlzma2_compress,  lzbench_fastlzma2_decompress,  NULL,                    NULL },
-    { "gipfeli",    "2016-07-13",  0,   0,    0,       0, lzbench_gipfeli_compress,    lzbench_gipfeli_decompress,    NULL,                    NULL },
+    { "fastlzma2_asm", "1.0.1",    1,  10,    0,       0, lzbench_fastlzma2_compress,  lzbench_fastlzma2_asm_decompress, NULL,                  NULL }, // x86-64 assembly decoder
+    { "fastlzma2mt", "1.0.1",      1,  10,    0,       0, lzbench_fastlzma2mt_compress, lzbench_fastlzma2mt_decompress, lzbench_fastlzma2mt_init, lzbench_fastlzma2mt_deinit },
+    { "fpc32",      "",            1,   4,    4,       0, lzbench_fpc_compress,        lzbench_fpc_decompress,        lzbench_fpc_init,        lzbench_fpc_deinit }, // level # = tables of 2^(4+4#) entries, float32 elements
+    { "fpc64",      "",            1,   4,    8,       0, lzbench_fpc_compress,        lzbench_fpc_decompress,        lzbench_fpc_init,        lzbench_fpc_deinit }, // float64 elements
+    { "gipfeli",    "2016-07-13",  0,   0,    0,       0, lzbench_gipfeli_compress,    lzbench_gipfeli_decompress,    lzbench_gipfeli_init,    lzbench_gipfeli_deinit },
     { "glza",       "0.8",         0,   0,    0,       0, lzbench_glza_compress,       lzbench_glza_decompress,       NULL,                    NULL },
-    { "libdeflate", "1.20",        1,  12,    0,       0, lzbench_libdeflate_compress, lzbench_libdeflate_decompress, NULL,                    NULL },
-    { "lz4",        "1.9.4",       0,   0,    0,       0, lzbench_lz4_compress,        lzbench_lz4_decompress,        NULL,                    NULL },
-    { "lz4fast",    "1.9.4",       1,  99,    0,       0, lzbench_lz4fast_compress,    lzbench_lz4_decompress,        NULL,                    NULL },
-    { "lz4hc",      "1.9.4",       1,  12,    0,       0, lzbench_lz4hc_compress,      lzbench_lz4_decompress,        NULL,                    NULL },
+    { "gorilla32",  "",            0,   0,    4,       0, lzbench_gorilla_compress,    lzbench_gorilla_decompress,    NULL,                    NULL }, // XOR with the previous float32 element
+    { "gorilla64",  "",            0,   0,    8,       0, lzbench_gorilla_compress,    lzbench_gorilla_decompress,    NULL,                    NULL },
+    { "intpack8",   "",            0,   1,    1,       0, lzbench_intpack_compress,    lzbench_intpack_decompress,    NULL,                    NULL }, // level 0 = frame of reference, 1 = delta, elements of 1 byte
+    { "intpack16",  "",            0,   1,    2,       0, lzbench_intpack_compress,    lzbench_intpack_decompress,    NULL,                    NULL },
+    { "intpack32",  "",            0,   1,    4,       0, lzbench_intpack_compress,    lzbench_intpack_decompress,    NULL,                    NULL },
+    { "intpack64",  "",            0,   1,    8,       0, lzbench_intpack_compress,    lzbench_intpack_decompress,    NULL,                    NULL },
+    { "kernel_lzo", "",            0,   0,    0, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit }, // zram device of the kernel, additional param = algorithm
+    { "kernel_lzorle", "",         0,   0,    1, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "kernel_lz4", "",            0,   0,    2, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "kernel_lz4hc", "",          1,  12,    3, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "kernel_zstd", "",           1,  22,    4, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "kernel_deflate", "",        1,   9,    5, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "kernel_842", "",            0,   0,    6, LIMIT_4G, lzbench_kernel_compress,     lzbench_kernel_decompress,     lzbench_kernel_init,     lzbench_kernel_deinit },
+    { "libdeflate", "1.20",        1,  12,    0, NO_LIMIT, lzbench_libdeflate_compress, lzbench_libdeflate_decompress, lzbench_libdeflate_init, lzbench_libdeflate_deinit, NULL, lzbench_libdeflate_bound },
+    { "igzip",      "",            0,   3,    0, LIMIT_4G, lzbench_igzip_compress,      lzbench_igzip_decompress,      lzbench_igzip_init,      lzbench_igzip_deinit },
+    { "igzip_gzip", "",            0,   3,    1, LIMIT_4G, lzbench_igzip_compress,      lzbench_igzip_decompress,      lzbench_igzip_init,      lzbench_igzip_deinit },
+    { "libdeflate_gzip", "1.20",   1,  12,    0, NO_LIMIT, lzbench_libdeflate_gzip_compress, lzbench_libdeflate_gzip_decompress, lzbench_libdeflate_init, lzbench_libdeflate_deinit, NULL, lzbench_libdeflate_gzip_bound },
+    { "libdeflate_zlib", "1.20",   1,  12,    0, NO_LIMIT, lzbench_libdeflate_zlib_compress, lzbench_libdeflate_zlib_decompress, lzbench_libdeflate_init, lzbench_libdeflate_deinit, NULL, lzbench_libdeflate_zlib_bound },
+    { "pdeflate",   "1.20",        1,  12,    0,       0, lzbench_pdeflate_compress,   lzbench_pdeflate_decompress,   lzbench_pdeflate_init,   lzbench_pdeflate_deinit },
+    { "pdeflate_pigz", "1.3.1",    1,   9,    1,       0, lzbench_pdeflate_compress,   lzbench_pdeflate_decompress,   lzbench_pdeflate_init,   lzbench_pdeflate_deinit },
+    { "lz4",        "1.9.4",       0,   0,    0,       0, lzbench_lz4_compress,        lzbench_lz4_decompress,        lzbench_lz4_init,        lzbench_lz4_deinit, &lz4_stream, lzbench_lz4_bound, lzbench_lz4_compress_batch, lzbench_lz4_decompress_batch },
+    { "lz4_delta",  "1.9.4",       0,   0,    0,       0, lzbench_lz4_compress,        lzbench_lz4_decompress,        lzbench_lz4_init,        lzbench_lz4_deinit }, // --delta: LZ4_loadDict()
+    { "lz4fast",    "1.9.4",       1,  99,    0,       0, lzbench_lz4fast_compress,    lzbench_lz4_decompress,        NULL,                    NULL, NULL, lzbench_lz4_bound },
+    { "lz4_unsafe", "1.9.4",       0,   0,    0,       0, lzbench_lz4_compress,        lzbench_lz4_decompress_fast,   lzbench_lz4_init,        lzbench_lz4_deinit, NULL, lzbench_lz4_bound },
+    { "lz4_extstate", "1.9.4",     0,   0,    0,       0, lzbench_lz4_extstate_compress, lzbench_lz4_decompress,      lzbench_lz4_extstate_init, lzbench_lz4_extstate_deinit, NULL, lzbench_lz4_bound }, // state of init reset per chunk
+    { "lz4hc",      "1.9.4",       1,  12,    0,       0, lzbench_lz4hc_compress,      lzbench_lz4_decompress,        NULL,                    NULL, NULL, lzbench_lz4_bound },
+    { "lz4hc_extstate", "1.9.4",   1,  12,    0,       0, lzbench_lz4hc_extstate_compress, lzbench_lz4_decompress,    lzbench_lz4hc_extstate_init, lzbench_lz4hc_extstate_deinit, NULL, lzbench_lz4_bound }, // state of init reset per chunk
+    { "lz4_m12",    "1.9.4",       0,   0,    0,       0, lzbench_lz4_m12_compress,    lzbench_lz4_decompress,        lzbench_lz4_mem_init,    lzbench_lz4_mem_deinit, NULL, lzbench_lz4_bound }, // LZ4_MEMORY_USAGE=12
+    { "lz4_m14",    "1.9.4",       0,   0,    0,       0, lzbench_lz4_m14_compress,    lzbench_lz4_decompress,        lzbench_lz4_mem_init,    lzbench_lz4_mem_deinit, NULL, lzbench_lz4_bound }, // LZ4_MEMORY_USAGE=14
+    { "lz4_m16",    "1.9.4",       0,   0,    0,       0, lzbench_lz4_m16_compress,    lzbench_lz4_decompress,        lzbench_lz4_mem_init,    lzbench_lz4_mem_deinit, NULL, lzbench_lz4_bound }, // LZ4_MEMORY_USAGE=16
+    { "lz4_m18",    "1.9.4",       0,   0,    0,       0, lzbench_lz4_m18_compress,    lzbench_lz4_decompress,        lzbench_lz4_mem_init,    lzbench_lz4_mem_deinit, NULL, lzbench_lz4_bound }, // LZ4_MEMORY_USAGE=18
+    { "lz4_m20",    "1.9.4",       0,   0,    0,       0, lzbench_lz4_m20_compress,    lzbench_lz4_decompress,        lzbench_lz4_mem_init,    lzbench_lz4_mem_deinit, NULL, lzbench_lz4_bound }, // LZ4_MEMORY_USAGE=20
+    { "lz4_ilv2",   "1.9.4",       0,   0,    2,       0, lzbench_lz4_compress,        lzbench_lz4_interleaved_decompress, NULL,               NULL, NULL, lzbench_lz4_bound, NULL, lzbench_lz4_interleaved_decompress_batch }, // 2 chunks of a batch decoded at once
+    { "lz4_ilv4",   "1.9.4",       0,   0,    4,       0, lzbench_lz4_compress,        lzbench_lz4_interleaved_decompress, NULL,               NULL, NULL, lzbench_lz4_bound, NULL, lzbench_lz4_interleaved_decompress_batch }, // 4 chunks of a batch decoded at once
+    { "lz4stream",  "1.9.4",       0,  12,    0,       0, lzbench_lz4stream_compress,  lzbench_lz4_stream_decompress, lzbench_lz4linked_init,  lzbench_lz4linked_deinit },
+    { "lz4frame",   "1.9.4",       0,  12,    0,       0, lzbench_lz4frame_compress,   lzbench_lz4frame_decompress,   lzbench_lz4linked_init,  lzbench_lz4linked_deinit },
+    { "lz4framecrc", "1.9.4",      0,  12,    0,       0, lzbench_lz4framecrc_compress, lzbench_lz4frame_decompress,   lzbench_lz4linked_init,  lzbench_lz4linked_deinit },
     { "lzf",        "3.6",         0,   1,    0,       0, lzbench_lzf_compress,        lzbench_lzf_decompress,        NULL,                    NULL },
     { "lzfse",      "2017-03-08",  0,   0,    0,       0, lzbench_lzfse_compress,      lzbench_lzfse_decompress,      lzbench_lzfse_init,      lzbench_lzfse_deinit },
+    { "lzfse_fse",  "2017-03-08",  0,   0,    0,       0, lzbench_lzfse_fse_compress,  lzbench_lzfse_fse_decompress,  lzbench_lzfse_fse_init,  lzbench_lzfse_fse_deinit }, // only the literal coder
     { "lzg",        "1.0.10",      1,   9,    0,       0, lzbench_lzg_compress,        lzbench_lzg_decompress,        NULL,                    NULL },
-    { "lzham",      "1.0 -d26",    0,   4,    0,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
-    { "lzham22",    "1.0",         0,   4,   22,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
-    { "lzham24",    "1.0",         0,   4,   24,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      NULL,                    NULL },
+    { "lzham",      "1.0 -d26",    0,   4,    0,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      lzbench_lzham_init,      lzbench_lzham_deinit },
+    { "lzham22",    "1.0",         0,   4,   22,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      lzbench_lzham_init,      lzbench_lzham_deinit },
+    { "lzham24",    "1.0",         0,   4,   24,       0, lzbench_lzham_compress,      lzbench_lzham_decompress,      lzbench_lzham_init,      lzbench_lzham_deinit },
+    { "lzhammt",    "1.0 -d26",    0,   4,    0,       0, lzbench_lzhammt_compress,    lzbench_lzham_decompress,      lzbench_lzhammt_init,    lzbench_lzham_deinit },
+    { "lzhammt22",  "1.0",         0,   4,   22,       0, lzbench_lzhammt_compress,    lzbench_lzham_decompress,      lzbench_lzhammt_init,    lzbench_lzham_deinit },
+    { "lzhammt24",  "1.0",         0,   4,   24,       0, lzbench_lzhammt_compress,    lzbench_lzham_decompress,      lzbench_lzhammt_init,    lzbench_lzham_deinit },
     { "lzjb",       "2010",        0,   0,    0,       0, lzbench_lzjb_compress,       lzbench_lzjb_decompress,       NULL,                    NULL },
     { "lzlib",      "1.14",        0,   9,    0,       0, lzbench_lzlib_compress,      lzbench_lzlib_decompress,      NULL,                    NULL },
     { "lzma",       "23.01",       0,   9,    0,       0, lzbench_lzma_compress,       lzbench_lzma_decompress,       NULL,                    NULL },
+    { "lzmamt",     "23.01",       0,   9,    0,       0, lzbench_lzmamt_compress,     lzbench_lzmamt_decompress,     NULL,                    NULL },
     { "lzmat",      "1.01",        0,   0,    0,       0, lzbench_lzmat_compress,      lzbench_lzmat_decompress,      NULL,                    NULL }, // decompression error (returns 0) and SEGFAULT (?)
     { "lzo1",       "2.10",        1,   1,    0,       0, lzbench_lzo1_compress,       lzbench_lzo1_decompress,       lzbench_lzo_init,        lzbench_lzo_deinit },
     { "lzo1a",      "2.10",        1,   1,    0,       0, lzbench_lzo1a_compress,      lzbench_lzo1a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
@@ -177,6 +639,13 @@ static const compressor_desc_t comp_desc[LZBENCH_COMPRESSOR_COUNT] =
     { "lzo1y",      "2.10",        1,   1,    0,       0, lzbench_lzo1y_compress,      lzbench_lzo1y_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
     { "lzo1z",      "2.10",      999, 999,    0,       0, lzbench_lzo1z_compress,      lzbench_lzo1z_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
     { "lzo2a",      "2.10",      999, 999,    0,       0, lzbench_lzo2a_compress,      lzbench_lzo2a_decompress,      lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1b_safe", "2.10",        1,   1,    0,       0, lzbench_lzo1b_compress,      lzbench_lzo1b_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1c_safe", "2.10",        1,   1,    0,       0, lzbench_lzo1c_compress,      lzbench_lzo1c_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1f_safe", "2.10",        1,   1,    0,       0, lzbench_lzo1f_compress,      lzbench_lzo1f_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1x_safe", "2.10",        1,   1,    0,       0, lzbench_lzo1x_compress,      lzbench_lzo1x_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1y_safe", "2.10",        1,   1,    0,       0, lzbench_lzo1y_compress,      lzbench_lzo1y_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo1z_safe", "2.10",      999, 999,    0,       0, lzbench_lzo1z_compress,      lzbench_lzo1z_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
+    { "lzo2a_safe", "2.10",      999, 999,    0,       0, lzbench_lzo2a_compress,      lzbench_lzo2a_decompress_safe, lzbench_lzo_init,        lzbench_lzo_deinit },
     { "lzrw",       "15-Jul-1991", 1,   5,    0,       0, lzbench_lzrw_compress,       lzbench_lzrw_decompress,       lzbench_lzrw_init,       lzbench_lzrw_deinit },
     { "lzsse2",     "2019-04-18",  0,  17,    0,       0, lzbench_lzsse2_compress,     lzbench_lzsse2_decompress,     lzbench_lzsse2_init,     lzbench_lzsse2_deinit },
     { "lzsse4",     "2019-04-18",  0,  17,    0,       0, lzbench_lzsse4_compress,     lzbench_lzsse4_decompress,     lzbench_lzsse4_init,     lzbench_lzsse4_deinit },
@@ -188,35 +657,118 @@ static const compressor_desc_t comp_desc[LZBENCH_COMPRESSOR_COUNT] =
     { "quicklz",    "1.5.0",       1,   3,    0,       0, lzbench_quicklz_compress,    lzbench_quicklz_decompress,    NULL,                    NULL },
     { "shrinker",   "0.1",         0,   0,    0, 128<<20, lzbench_shrinker_compress,   lzbench_shrinker_decompress,   NULL,                    NULL },
     { "slz_deflate","1.2.0",       1,   3,    2,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "slz_gzip",   "1.2.0",       1,   3,    1,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "slz_zlib",   "1.2.0",       1,   3,    0,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
-    { "snappy",     "1.2.0",       0,   0,    0,       0, lzbench_snappy_compress,     lzbench_snappy_decompress,     NULL,                    NULL },
+    { "slz_gzip",   "1.2.0",       1,   3,    0,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
+    { "slz_zlib",   "1.2.0",       1,   3,    1,       0, lzbench_slz_compress,        lzbench_slz_decompress,        NULL,                    NULL },
+    { "snappy",     "1.2.0",       0,   0,    0,       0, lzbench_snappy_compress,     lzbench_snappy_decompress,     NULL,                    NULL, NULL, lzbench_snappy_bound },
+    { "snappy_ilv2", "1.2.0",      0,   0,    2,       0, lzbench_snappy_compress,     lzbench_snappy_interleaved_decompress, NULL,            NULL, NULL, lzbench_snappy_bound, NULL, lzbench_snappy_interleaved_decompress_batch },
+    { "snappy_ilv4", "1.2.0",      0,   0,    4,       0, lzbench_snappy_compress,     lzbench_snappy_interleaved_decompress, NULL,            NULL, NULL, lzbench_snappy_bound, NULL, lzbench_snappy_interleaved_decompress_batch },
+    { "streamvbyte", "",           0,   1,    0,       0, lzbench_streamvbyte_compress, lzbench_streamvbyte_decompress, NULL,                 NULL }, // level 1 = delta, elements of 4 bytes
     { "tornado",    "0.6a",        1,  16,    0,       0, lzbench_tornado_compress,    lzbench_tornado_decompress,    NULL,                    NULL },
     { "ucl_nrv2b",  "1.03",        1,   9,    0,       0, lzbench_ucl_nrv2b_compress,  lzbench_ucl_nrv2b_decompress,  NULL,                    NULL },
     { "ucl_nrv2d",  "1.03",        1,   9,    0,       0, lzbench_ucl_nrv2d_compress,  lzbench_ucl_nrv2d_decompress,  NULL,                    NULL },
     { "ucl_nrv2e",  "1.03",        1,   9,    0,       0, lzbench_ucl_nrv2e_compress,  lzbench_ucl_nrv2e_decompress,  NULL,                    NULL },
     { "wflz",       "2015-09-16",  0,   0,    0,       0, lzbench_wflz_compress,       lzbench_wflz_decompress,       lzbench_wflz_init,       lzbench_wflz_deinit }, // SEGFAULT on decompressiom with gcc 4.9+ -O3 on Ubuntu
     { "xpack",      "2016-06-02",  1,   9,    0,   1<<19, lzbench_xpack_compress,      lzbench_xpack_decompress,      lzbench_xpack_init,      lzbench_xpack_deinit },
-    { "xz",         "5.2.12",      0,   9,    0,       0, lzbench_xz_compress,         lzbench_xz_decompress,         NULL,                    NULL },
+    { "xz",         "5.2.12",      0,   9,    0, NO_LIMIT, lzbench_xz_compress,         lzbench_xz_decompress,         NULL,                    NULL, &xz_stream },
+    { "xzmt",       "5.2.12",      0,   9,    0,       0, lzbench_xzmt_compress,       lzbench_xzmt_decompress,       lzbench_xzmt_init,       lzbench_xzmt_deinit },
+    { "xzcrc64",    "5.2.12",      0,   9,    4,       0, lzbench_xzcheck_compress,    lzbench_xzmt_decompress,       NULL,                    NULL }, // LZMA_CHECK_CRC64
+    { "xzsha256",   "5.2.12",      0,   9,   10,       0, lzbench_xzcheck_compress,    lzbench_xzmt_decompress,       NULL,                    NULL }, // LZMA_CHECK_SHA256
     { "yalz77",     "2015-09-19",  1,  12,    0,       0, lzbench_yalz77_compress,     lzbench_yalz77_decompress,     NULL,                    NULL },
     { "yappy",      "2014-03-22",  0,  99,    0,       0, lzbench_yappy_compress,      lzbench_yappy_decompress,      lzbench_yappy_init,      NULL },
-    { "zlib",       "1.3.1",       1,   9,    0,       0, lzbench_zlib_compress,       lzbench_zlib_decompress,       NULL,                    NULL },
+    { "zlib",       "1.3.1",       1,   9,    0, LIMIT_4G, lzbench_zlib_compress,       lzbench_zlib_decompress,       lzbench_zlib_init,       lzbench_zlib_deinit, &zlib_stream, lzbench_zlib_bound },
+    { "zlib-ng",    "",            1,   9,    0, LIMIT_4G, lzbench_zlibng_compress,     lzbench_zlibng_decompress,     NULL,                    NULL },
+    { "zlib-ng_gzip", "",          1,   9,    1, LIMIT_4G, lzbench_zlibng_compress,     lzbench_zlibng_decompress,     NULL,                    NULL },
     { "zling",      "2018-10-12",  0,   4,    0,       0, lzbench_zling_compress,      lzbench_zling_decompress,      NULL,                    NULL },
-    { "zstd",       "1.5.6",       1,  22,    0,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd_fast",  "1.5.6",       -5, -1,    0,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd22",     "1.5.6",       1,  22,   22,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstd24",     "1.5.6",       1,  22,   24,       0, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit },
-    { "zstdLDM",    "1.5.6",       1,  22,    0,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
-    { "zstd22LDM",  "1.5.6",       1,  22,   22,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
-    { "zstd24LDM",  "1.5.6",       1,  22,   24,       0, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit },
+    { "zstd",       "1.5.6",       1,  22,    0, NO_LIMIT, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit, &zstd_stream, lzbench_zstd_bound, lzbench_zstd_compress_batch, lzbench_zstd_decompress_batch },
+    { "zstd_delta", "1.5.6",       1,  22,    0, NO_LIMIT, lzbench_zstd_delta_compress, lzbench_zstd_delta_decompress, lzbench_zstd_delta_init, lzbench_zstd_deinit }, // --delta: ZSTD_CCtx_refPrefix()
+    { "huff0_1x",   "1.5.6",       0,   0,    1,       0, lzbench_huff0_compress,      lzbench_huff0_decompress,      lzbench_zstd_entropy_init, lzbench_zstd_entropy_deinit }, // only the entropy stage of zstd
+    { "huff0_4x",   "1.5.6",       0,   0,    4,       0, lzbench_huff0_compress,      lzbench_huff0_decompress,      lzbench_zstd_entropy_init, lzbench_zstd_entropy_deinit },
+    { "fse",        "1.5.6",       0,   0,    0,       0, lzbench_fse_compress,        lzbench_fse_decompress,        lzbench_zstd_entropy_init, lzbench_zstd_entropy_deinit },
+    { "zstd_fast",  "1.5.6",       -5, -1,    0, NO_LIMIT, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit, NULL, lzbench_zstd_bound, lzbench_zstd_compress_batch, lzbench_zstd_decompress_batch },
+    { "zstdcrc",    "1.5.6",       1,  22,    0, NO_LIMIT, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstdcrc_init,    lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstd22",     "1.5.6",       1,  22,   22, NO_LIMIT, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstd24",     "1.5.6",       1,  22,   24, NO_LIMIT, lzbench_zstd_compress,       lzbench_zstd_decompress,       lzbench_zstd_init,       lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstdLDM",    "1.5.6",       1,  22,    0, NO_LIMIT, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstd22LDM",  "1.5.6",       1,  22,   22, NO_LIMIT, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstd24LDM",  "1.5.6",       1,  22,   24, NO_LIMIT, lzbench_zstd_LDM_compress,   lzbench_zstd_decompress,       lzbench_zstd_LDM_init,   lzbench_zstd_deinit, NULL, lzbench_zstd_bound },
+    { "zstdmt",     "1.5.6",       1,  22,    0, NO_LIMIT, lzbench_zstdmt_compress,     lzbench_zstd_decompress,       lzbench_zstdmt_init,     lzbench_zstd_deinit },
+    { "zstd_seekable", "1.5.6",    1,  22,    0,       0, lzbench_zstd_seekable_compress, lzbench_zstd_decompress,    lzbench_zstd_init,       lzbench_zstd_deinit },
+    { "deflate_indexed", "1.3.1",  1,   9,    0,       0, lzbench_gzip_compress,       lzbench_zlib_gzip_decompress,  NULL,                    NULL, NULL, lzbench_gzip_bound }, // --range-reads through a zran index
+    { "crc32_libdeflate", "1.20",  0,   0,    0,       0, lzbench_crc32_libdeflate_hash, lzbench_return_0,          NULL,                    NULL },
+    { "adler32_libdeflate", "1.20", 0,  0,    0,       0, lzbench_adler32_libdeflate_hash, lzbench_return_0,        NULL,                    NULL },
+    { "crc32_zlib", "1.3.1",       0,   0,    0,       0, lzbench_crc32_zlib_hash,     lzbench_return_0,              NULL,                    NULL },
+    { "adler32_zlib", "1.3.1",     0,   0,    0,       0, lzbench_adler32_zlib_hash,   lzbench_return_0,              NULL,                    NULL },
+    { "crc32_xz",   "5.2.12",      0,   0,    0,       0, lzbench_crc32_xz_hash,       lzbench_return_0,              NULL,                    NULL },
+    { "crc64_xz",   "5.2.12",      0,   0,    0,       0, lzbench_crc64_xz_hash,       lzbench_return_0,              NULL,                    NULL },
+    { "xxh32",      "1.5.6",       0,   0,    0,       0, lzbench_xxh32_hash,          lzbench_return_0,              NULL,                    NULL },
+    { "xxh64",      "1.5.6",       0,   0,    0,       0, lzbench_xxh64_hash,          lzbench_return_0,              NULL,                    NULL },
     { "nakamichi",  "okamigan",    0,   0,    0,       0, lzbench_nakamichi_compress,  lzbench_nakamichi_decompress,  NULL,                    NULL },
     { "cudaMemcpy", "",            0,   0,    0,       0, lzbench_cuda_return_0,       lzbench_cuda_memcpy,           lzbench_cuda_init,       lzbench_cuda_deinit },
     { "nvcomp_lz4", "1.2.2",       0,   5,    0,       0, lzbench_nvcomp_compress,     lzbench_nvcomp_decompress,     lzbench_nvcomp_init,     lzbench_nvcomp_deinit },
+    { "nvcomp_lz4_batch", "1.2.2", 0,   5,    0,       0, lzbench_nvcomp_batch_compress, lzbench_nvcomp_batch_decompress, lzbench_nvcomp_batch_init, lzbench_nvcomp_batch_deinit, NULL, NULL, lzbench_nvcomp_batch_compress_batch, lzbench_nvcomp_batch_decompress_batch },
+    { "nvcomp_lz4_hybrid", "1.2.2", 0,  5,    0,       0, lzbench_nvcomp_hybrid_compress, lzbench_nvcomp_hybrid_decompress, lzbench_nvcomp_hybrid_init, lzbench_nvcomp_hybrid_deinit },
+    { "nvcomp_cascaded8",    "1.2.2", 0,   9,    1, 1<<30, lzbench_nvcomp_cascaded_compress, lzbench_nvcomp_cascaded_decompress, lzbench_nvcomp_cascaded_init, lzbench_nvcomp_cascaded_deinit },
+    { "nvcomp_cascaded16",   "1.2.2", 0,   9,    2, 1<<30, lzbench_nvcomp_cascaded_compress, lzbench_nvcomp_cascaded_decompress, lzbench_nvcomp_cascaded_init, lzbench_nvcomp_cascaded_deinit },
+    { "nvcomp_cascaded32",   "1.2.2", 0,   9,    4, 1<<30, lzbench_nvcomp_cascaded_compress, lzbench_nvcomp_cascaded_decompress, lzbench_nvcomp_cascaded_init, lzbench_nvcomp_cascaded_deinit },
+    { "nvcomp_cascaded64",   "1.2.2", 0,   9,    8, 1<<30, lzbench_nvcomp_cascaded_compress, lzbench_nvcomp_cascaded_decompress, lzbench_nvcomp_cascaded_init, lzbench_nvcomp_cascaded_deinit },
+    { "qpl_deflate",    "",        1,   2,    0, LIMIT_4G, lzbench_qpl_compress,   lzbench_qpl_decompress,   lzbench_qpl_init,   lzbench_qpl_deinit, NULL, NULL, lzbench_qpl_compress_batch, lzbench_qpl_decompress_batch },
+    { "qpl_deflate_sw", "",        1,   2,    1, LIMIT_4G, lzbench_qpl_compress,   lzbench_qpl_decompress,   lzbench_qpl_init,   lzbench_qpl_deinit, NULL, NULL, lzbench_qpl_compress_batch, lzbench_qpl_decompress_batch },
+    { "qatzip",         "",        1,   9,    0, LIMIT_4G, lzbench_qatzip_compress, lzbench_qatzip_decompress, lzbench_qatzip_init, lzbench_qatzip_deinit },
+};
+
+
+
+typedef struct
+{
+    const char* format; // of compressed_format()
+    compressor_desc_t desc;
+} decoder_desc_t;
+
+#define LZBENCH_DECODER_COUNT 12
+
+// decoders of --decompress-only for compressed files of other tools, the first one of a format makes the reference output
+static const decoder_desc_t decode_desc[LZBENCH_DECODER_COUNT] =
+{
+    { "gzip",  { "zlib",       "1.3.1",  0, 0, 0, 0, lzbench_return_0, lzbench_zlib_gzip_decompress,       NULL,                    NULL } },
+    { "gzip",  { "libdeflate", "1.20",   0, 0, 0, 0, lzbench_return_0, lzbench_libdeflate_gzip_decompress, lzbench_libdeflate_init, lzbench_libdeflate_deinit } },
+    { "gzip",  { "zlib-ng",    "",       0, 0, 0, 0, lzbench_return_0, lzbench_zlibng_gzip_decompress,     NULL,                    NULL } },
+    { "gzip",  { "igzip",      "",       0, 0, 0, 0, lzbench_return_0, lzbench_igzip_gzip_decompress,      NULL,                    NULL } },
+    { "zlib",  { "zlib",       "1.3.1",  0, 0, 0, 0, lzbench_return_0, lzbench_zlib_decompress,            lzbench_zlib_init,       lzbench_zlib_deinit } },
+    { "zlib",  { "libdeflate", "1.20",   0, 0, 0, 0, lzbench_return_0, lzbench_libdeflate_zlib_decompress, lzbench_libdeflate_init, lzbench_libdeflate_deinit } },
+    { "zlib",  { "zlib-ng",    "",       0, 0, 0, 0, lzbench_return_0, lzbench_zlibng_decompress,          NULL,                    NULL } },
+    { "zstd",  { "zstd",       "1.5.6",  0, 0, 0, 0, lzbench_return_0, lzbench_zstd_decompress,            lzbench_zstd_init,       lzbench_zstd_deinit } },
+    { "xz",    { "xz",         "5.2.12", 0, 0, 0, 0, lzbench_return_0, lzbench_xzmt_decompress,            NULL,                    NULL } },
+    { "lz4",   { "lz4frame",   "1.9.4",  0, 0, 0, 0, lzbench_return_0, lzbench_lz4frame_decompress,        NULL,                    NULL } },
+    { "bzip2", { "bzip2",      "1.0.8",  0, 0, 0, 0, lzbench_return_0, lzbench_bzip2_decompress,           NULL,                    NULL } },
+    { "br",    { "brotli",     "1.1.0",  0, 0, 0, 0, lzbench_return_0, lzbench_brotli_decompress,          NULL,                    NULL } },
+};
+
+
+
+typedef struct
+{
+    const char* family;
+    const char* codecs; // rows that write and read the format, every encoder of -e among them is decoded by all of them
+} interop_desc_t;
+
+#define LZBENCH_INTEROP_COUNT 8
+
+// --interop: families of rows with a common wire format, lzma (raw), xz (.lzma), lzlib (.lz) and xzmt (.xz) share only the coder
+static const interop_desc_t interop_desc[LZBENCH_INTEROP_COUNT] =
+{
+    { "deflate",  "libdeflate/igzip/slz_deflate/qpl_deflate/qpl_deflate_sw/qatzip" },
+    { "zlib",     "zlib/zlib-ng/libdeflate_zlib/slz_zlib" },
+    { "gzip",     "libdeflate_gzip/igzip_gzip/zlib-ng_gzip/slz_gzip/deflate_indexed" },
+    { "xz",       "xzmt/xzcrc64/xzsha256" },
+    { "lzma2",    "fastlzma2/fastlzma2_asm/fastlzma2mt" },
+    { "lz4",      "lz4/lz4fast/lz4hc/lz4_unsafe/lz4_extstate/lz4hc_extstate/lz4_m12/lz4_m14/lz4_m16/lz4_m18/lz4_m20/lz4_ilv2/lz4_ilv4" },
+    { "lz4frame", "lz4frame/lz4framecrc" },
+    { "snappy",   "snappy/snappy_ilv2/snappy_ilv4" },
 };
 
 
 
-#define LZBENCH_ALIASES_COUNT 13
+#define LZBENCH_ALIASES_COUNT 24
 
 static const alias_desc_t alias_desc[LZBENCH_ALIASES_COUNT] =
 {
@@ -248,7 +800,18 @@ static const alias_desc_t alias_desc[LZBENCH_ALIASES_COUNT] =
     { "lzo1y", "lzo1y,1,999" },
     { "lzo",   "lzo1/lzo1a/lzo1b/lzo1c/lzo1f/lzo1x/lzo1y/lzo1z/lzo2a" },
     { "ucl",   "ucl_nrv2b/ucl_nrv2d/ucl_nrv2e" },
-    { "cuda",  "cudaMemcpy/nvcomp_lz4,0,1,3,5" },
+    { "safe",  "lz4/lz4_unsafe/lzo1b,1/lzo1b_safe,1/lzo1c,1/lzo1c_safe,1/lzo1f,1/lzo1f_safe,1/lzo1x,1/lzo1x_safe,1/lzo1y,1/lzo1y_safe,1/lzo1z,999/lzo1z_safe,999/lzo2a,999/lzo2a_safe,999" },
+    { "lz4mem", "lz4_m12/lz4_m14/lz4_m16/lz4_m18/lz4_m20" },
+    { "copy",  "memcpy_movsb/memcpy_avx2/memcpy_avx2nt/memcpy_avx512/memcpy_avx512nt/memcpy_fastcopy,0,8,16,32,64/memcpy_short,8,16,32,64" },
+    { "checksums", "crc32_libdeflate/adler32_libdeflate/crc32_zlib/adler32_zlib/crc32_xz/crc64_xz/xxh32/xxh64" },
+    { "entropy", "huff0_1x/huff0_4x/fse/lzfse_fse" },
+    { "zram",  "lzo1x,1/lz4/lz4hc,9/zstd,1,3" },
+    { "integers", "intpack32,0,1/streamvbyte,0,1/lz4/zstd,1" },
+    { "floats", "gorilla64/fpc64,1,4/shuffle8+zstd,3/zstd,3" },
+    { "kernel", "kernel_lzo/lzo1x,1/kernel_lzorle/kernel_lz4/lz4/kernel_zstd,1,3/zstd,1,3" },
+    { "cuda",  "cudaMemcpy/nvcomp_lz4,0,1,3,5/nvcomp_lz4_batch,1/nvcomp_lz4_hybrid,1/nvcomp_cascaded32,0,1,5" },
+    { "deflate", "zlib,1,6,9/zlib-ng,1,6,9/libdeflate,1,6,9,12/igzip,0,1,2,3/slz_deflate" },
+    { "offload", "qpl_deflate,1,2/qpl_deflate_sw,1,2/qatzip,1,6,9/libdeflate,1,6,9" },
 };
 
 #endif
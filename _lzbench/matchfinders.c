@@ -0,0 +1,447 @@
+/*
+ * --match-finders: the match finders of the codecs called directly over a chunk, see matchfinders.h.
+ * The libraries define their own MIN, MAX, likely and integer types, so every section undefines what the
+ * headers of the next one define again.
+ */
+#include "matchfinders.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MF_MIN_LENGTH 3
+#define MF_MAX_NICE 273 // match_len_max of LZMA
+
+static void mf_count(lzbench_mf_stats_t* stats, unsigned nice_len, uint64_t pairs, uint32_t len, uint32_t dist)
+{
+    stats->positions++;
+    stats->matches += pairs;
+    if (len < MF_MIN_LENGTH) return;
+    stats->found++;
+    stats->length_sum += len < nice_len ? len : nice_len;
+    stats->distance_sum += dist;
+}
+
+static unsigned mf_clamp(unsigned value, unsigned low, unsigned high)
+{
+    return value < low ? low : value > high ? high : value;
+}
+
+
+#ifndef BENCH_REMOVE_LIBDEFLATE
+#define MATCHFINDER_WINDOW_ORDER 15 // of deflate
+#define bsr32 deflate_bsr32 // tuklib_integer.h of xz has its own
+#define bsf32 deflate_bsf32
+#include "libdeflate/lib/hc_matchfinder.h"
+#include "libdeflate/lib/ht_matchfinder.h"
+#include "libdeflate/lib/bt_matchfinder.h"
+
+#define DEFLATE_MAX_LENGTH 258
+
+typedef struct
+{
+    void* base; // of malloc(), mf is aligned to MATCHFINDER_MEM_ALIGNMENT
+    void* mf;
+    unsigned nice_len, depth;
+} mf_deflate_t;
+
+static void* mf_deflate_create(size_t size, unsigned nice_len, unsigned depth)
+{
+    mf_deflate_t* s = (mf_deflate_t*) calloc(1, sizeof(mf_deflate_t));
+    if (!s) return NULL;
+    s->base = malloc(size + MATCHFINDER_MEM_ALIGNMENT);
+    if (!s->base) { free(s); return NULL; }
+    s->mf = (void*)(((uintptr_t)s->base + MATCHFINDER_MEM_ALIGNMENT - 1) & ~(uintptr_t)(MATCHFINDER_MEM_ALIGNMENT - 1));
+    s->nice_len = mf_clamp(nice_len, MF_MIN_LENGTH, DEFLATE_MAX_LENGTH);
+    s->depth = depth ? depth : 1;
+    return s;
+}
+
+static void mf_deflate_destroy(void* state)
+{
+    mf_deflate_t* s = (mf_deflate_t*) state;
+    free(s->base);
+    free(s);
+}
+
+static void* mf_deflate_hc_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth)
+{
+    (void)chunk; (void)window;
+    return mf_deflate_create(sizeof(struct hc_matchfinder), nice_len, depth);
+}
+
+static void* mf_deflate_ht_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth)
+{
+    (void)chunk; (void)window;
+    return mf_deflate_create(sizeof(struct ht_matchfinder), nice_len, depth);
+}
+
+static void* mf_deflate_bt_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth)
+{
+    (void)chunk; (void)window;
+    return mf_deflate_create(sizeof(struct bt_matchfinder), nice_len, depth);
+}
+
+// the hash chains of the lazy levels of libdeflate (5-9)
+static int mf_deflate_hc_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_deflate_t* s = (mf_deflate_t*) state;
+    struct hc_matchfinder* mf = (struct hc_matchfinder*) s->mf;
+    const u8* in_base = in;
+    const u8* in_end = in + size;
+    u32 next_hashes[2] = { 0, 0 };
+
+    hc_matchfinder_init(mf);
+    for (const u8* in_next = in; in_next < in_end; in_next++)
+    {
+        u32 max_len = (u32)MIN(in_end - in_next, DEFLATE_MAX_LENGTH);
+        u32 offset = 0;
+        u32 len = hc_matchfinder_longest_match(mf, &in_base, in_next, MF_MIN_LENGTH - 1, max_len, MIN(s->nice_len, max_len), s->depth, next_hashes, &offset);
+        mf_count(stats, s->nice_len, len >= MF_MIN_LENGTH, len, offset);
+    }
+    return 0;
+}
+
+// the hash table of one entry per bucket of the fastest level of libdeflate (1)
+static int mf_deflate_ht_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_deflate_t* s = (mf_deflate_t*) state;
+    struct ht_matchfinder* mf = (struct ht_matchfinder*) s->mf;
+    const u8* in_base = in;
+    const u8* in_end = in + size;
+    u32 next_hash = 0;
+
+    ht_matchfinder_init(mf);
+    for (const u8* in_next = in; in_next < in_end; in_next++)
+    {
+        u32 max_len = (u32)MIN(in_end - in_next, DEFLATE_MAX_LENGTH);
+        u32 offset = 0, len = 0;
+        if (max_len >= HT_MATCHFINDER_REQUIRED_NBYTES)
+            len = ht_matchfinder_longest_match(mf, &in_base, in_next, max_len, MIN(s->nice_len, max_len), &next_hash, &offset);
+        mf_count(stats, s->nice_len, len >= MF_MIN_LENGTH, len, offset);
+    }
+    return 0;
+}
+
+// the binary trees of the near-optimal levels of libdeflate (10-12), the window slides like in deflate_compress.c
+static int mf_deflate_bt_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_deflate_t* s = (mf_deflate_t*) state;
+    struct bt_matchfinder* mf = (struct bt_matchfinder*) s->mf;
+    const u8* in_cur_base = in;
+    const u8* in_end = in + size;
+    const u8* in_next_slide = in + MIN(size, MATCHFINDER_WINDOW_SIZE);
+    u32 next_hashes[2] = { 0, 0 };
+    struct lz_match matches[DEFLATE_MAX_LENGTH];
+
+    bt_matchfinder_init(mf);
+    for (const u8* in_next = in; in_next < in_end; in_next++)
+    {
+        size_t remaining = in_end - in_next;
+        u32 max_len = (u32)MIN(remaining, DEFLATE_MAX_LENGTH);
+        struct lz_match* end = matches;
+        if (in_next == in_next_slide)
+        {
+            bt_matchfinder_slide_window(mf);
+            in_cur_base = in_next;
+            in_next_slide = in_next + MIN(remaining, MATCHFINDER_WINDOW_SIZE);
+        }
+        if (max_len >= BT_MATCHFINDER_REQUIRED_NBYTES)
+            end = bt_matchfinder_get_matches(mf, in_cur_base, in_next - in_cur_base, max_len, MIN(s->nice_len, max_len), s->depth, next_hashes, matches);
+        if (end > matches)
+            mf_count(stats, s->nice_len, end - matches, end[-1].length, end[-1].offset);
+        else
+            mf_count(stats, s->nice_len, 0, 0, 0);
+    }
+    return 0;
+}
+#undef MIN
+#undef MAX
+#undef likely
+#undef unlikely
+#undef forceinline
+#undef STATIC_ASSERT
+#undef ARRAY_LEN
+#undef bsr32
+#undef bsf32
+#endif // BENCH_REMOVE_LIBDEFLATE
+
+
+#ifndef BENCH_REMOVE_LZMA
+#include "lzma/LzFind.h"
+#include "lzma/LzFindMt.h"
+
+typedef struct
+{
+    CMatchFinder mf;
+    CMatchFinderMt mt;
+    IMatchFinder2 vt;
+    int is_mt;
+    unsigned nice_len;
+    UInt32 distances[2 * (MF_MAX_NICE + 1)];
+} mf_lzma_t;
+
+static void* mf_lzma_alloc(ISzAllocPtr p, size_t size) { (void)p; return malloc(size); }
+static void mf_lzma_free(ISzAllocPtr p, void* address) { (void)p; free(address); }
+static const ISzAlloc mf_lzma_allocator = { mf_lzma_alloc, mf_lzma_free };
+
+static void mf_lzma_destroy(void* state)
+{
+    mf_lzma_t* s = (mf_lzma_t*) state;
+#ifndef Z7_ST
+    if (s->is_mt) MatchFinderMt_Destruct(&s->mt, &mf_lzma_allocator);
+#endif
+    MatchFinder_Free(&s->mf, &mf_lzma_allocator);
+    free(s);
+}
+
+// set up like LzmaEnc_Alloc() of LzmaEnc.c over an input buffer (MatchFinder_SET_DIRECT_INPUT_BUF)
+static void* mf_lzma_create(int bt, int hash_bytes, int mt, size_t chunk, size_t window, unsigned nice_len, unsigned depth)
+{
+    mf_lzma_t* s = (mf_lzma_t*) calloc(1, sizeof(mf_lzma_t));
+    UInt32 dict = (UInt32)(window < ((size_t)1 << 30) ? window : ((size_t)1 << 30));
+    if (!s) return NULL;
+    s->nice_len = mf_clamp(nice_len, 5, MF_MAX_NICE);
+    MatchFinder_Construct(&s->mf);
+    s->mf.btMode = (Byte)bt;
+    s->mf.numHashBytes = hash_bytes;
+    s->mf.cutValue = depth ? depth : 1;
+    s->mf.bigHash = (Byte)(dict > ((UInt32)1 << 24));
+    s->mf.expectedDataSize = chunk;
+    MatchFinder_SET_DIRECT_INPUT_BUF(&s->mf, NULL, 0)
+#ifndef Z7_ST
+    if (mt)
+    {
+        s->mt.MatchFinder = &s->mf;
+        MatchFinderMt_Construct(&s->mt);
+        s->is_mt = 1;
+        if (MatchFinderMt_Create(&s->mt, dict, 1 << 12, s->nice_len, MF_MAX_NICE + 1, &mf_lzma_allocator) != SZ_OK) { mf_lzma_destroy(s); return NULL; }
+        MatchFinderMt_CreateVTable(&s->mt, &s->vt);
+        return s;
+    }
+#else
+    if (mt) { free(s); return NULL; }
+#endif
+    if (!MatchFinder_Create(&s->mf, dict, 1 << 12, s->nice_len, MF_MAX_NICE + 1, &mf_lzma_allocator)) { mf_lzma_destroy(s); return NULL; }
+    MatchFinder_CreateVTable(&s->mf, &s->vt);
+    return s;
+}
+
+static int mf_lzma_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_lzma_t* s = (mf_lzma_t*) state;
+    void* obj = s->is_mt ? (void*)&s->mt : (void*)&s->mf;
+    MatchFinder_SET_DIRECT_INPUT_BUF(&s->mf, in, size)
+#ifndef Z7_ST
+    if (s->is_mt && MatchFinderMt_InitMt(&s->mt) != SZ_OK) return -1;
+#endif
+    s->vt.Init(obj);
+    for (size_t i = 0; i < size; i++)
+    {
+        // pairs of (length, distance - 1) by increasing length, like ReadMatchDistances() of LzmaEnc.c
+        s->vt.GetNumAvailableBytes(obj);
+        UInt32 pairs = (UInt32)(s->vt.GetMatches(obj, s->distances) - s->distances) / 2;
+        if (pairs)
+            mf_count(stats, s->nice_len, pairs, s->distances[2 * pairs - 2], s->distances[2 * pairs - 1] + 1);
+        else
+            mf_count(stats, s->nice_len, 0, 0, 0);
+    }
+#ifndef Z7_ST
+    if (s->is_mt) MatchFinderMt_ReleaseStream(&s->mt);
+#endif
+    return 0;
+}
+
+static void* mf_lzma_hc4_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(0, 4, 0, chunk, window, nice_len, depth); }
+static void* mf_lzma_hc5_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(0, 5, 0, chunk, window, nice_len, depth); }
+static void* mf_lzma_bt2_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(1, 2, 0, chunk, window, nice_len, depth); }
+static void* mf_lzma_bt3_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(1, 3, 0, chunk, window, nice_len, depth); }
+static void* mf_lzma_bt4_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(1, 4, 0, chunk, window, nice_len, depth); }
+static void* mf_lzma_bt4mt_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { return mf_lzma_create(1, 4, 1, chunk, window, nice_len, depth); }
+#endif // BENCH_REMOVE_LZMA
+
+
+#ifndef BENCH_REMOVE_XZ
+#include "lz_encoder.h"
+#include "lz_encoder_hash.h"
+
+typedef struct
+{
+    lzma_mf mf;
+    lzma_match matches[MF_MAX_NICE + 1];
+} mf_xz_t;
+
+static void mf_xz_destroy(void* state)
+{
+    mf_xz_t* s = (mf_xz_t*) state;
+    free(s->mf.hash);
+    free(s->mf.son);
+    free(s);
+}
+
+// the sizes of lz_encoder_prepare() of lz_encoder.c, the input buffer is the whole history (no move_window())
+static void* mf_xz_create(lzma_match_finder finder, size_t window, unsigned nice_len, unsigned depth)
+{
+    mf_xz_t* s = (mf_xz_t*) calloc(1, sizeof(mf_xz_t));
+    uint32_t hash_bytes = finder & 0x0F, dict = (uint32_t)(window < ((size_t)3 << 29) ? window : ((size_t)3 << 29));
+    uint32_t hs;
+    if (!s) return NULL;
+    switch (finder)
+    {
+        case LZMA_MF_HC3: s->mf.find = &lzma_mf_hc3_find; s->mf.skip = &lzma_mf_hc3_skip; break;
+        case LZMA_MF_HC4: s->mf.find = &lzma_mf_hc4_find; s->mf.skip = &lzma_mf_hc4_skip; break;
+        case LZMA_MF_BT2: s->mf.find = &lzma_mf_bt2_find; s->mf.skip = &lzma_mf_bt2_skip; break;
+        case LZMA_MF_BT3: s->mf.find = &lzma_mf_bt3_find; s->mf.skip = &lzma_mf_bt3_skip; break;
+        default: s->mf.find = &lzma_mf_bt4_find; s->mf.skip = &lzma_mf_bt4_skip; break;
+    }
+    s->mf.nice_len = mf_clamp(nice_len, hash_bytes, MF_MAX_NICE);
+    s->mf.match_len_max = MF_MAX_NICE;
+    s->mf.depth = depth;
+    s->mf.cyclic_size = dict + 1;
+    if (hash_bytes == 2)
+        hs = 0xFFFF;
+    else
+    {
+        hs = dict - 1;
+        hs |= hs >> 1;
+        hs |= hs >> 2;
+        hs |= hs >> 4;
+        hs |= hs >> 8;
+        hs >>= 1;
+        hs |= 0xFFFF;
+        if (hs > (UINT32_C(1) << 24))
+            hs = hash_bytes == 3 ? (UINT32_C(1) << 24) - 1 : hs >> 1;
+    }
+    s->mf.hash_mask = hs;
+    s->mf.hash_count = hs + 1 + (hash_bytes > 2 ? HASH_2_SIZE : 0) + (hash_bytes > 3 ? HASH_3_SIZE : 0);
+    s->mf.sons_count = s->mf.cyclic_size * ((finder & 0x10) ? 2 : 1);
+    s->mf.hash = (uint32_t*) malloc(s->mf.hash_count * sizeof(uint32_t));
+    s->mf.son = (uint32_t*) malloc(s->mf.sons_count * sizeof(uint32_t));
+    if (!s->mf.hash || !s->mf.son) { mf_xz_destroy(s); return NULL; }
+    return s;
+}
+
+static int mf_xz_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_xz_t* s = (mf_xz_t*) state;
+    lzma_mf* mf = &s->mf;
+    if (size >= UINT32_MAX - mf->cyclic_size) return -1;
+    // like lz_encoder_init(): positions start at cyclic_size, so an empty hash entry (0) is never in the window
+    memset(mf->hash, 0, mf->hash_count * sizeof(uint32_t));
+    mf->buffer = (uint8_t*) in;
+    mf->size = mf->write_pos = mf->read_limit = (uint32_t)size;
+    mf->read_pos = mf->read_ahead = mf->pending = mf->cyclic_pos = 0;
+    mf->offset = mf->cyclic_size;
+    mf->action = LZMA_FINISH;
+    for (size_t i = 0; i < size; i++)
+    {
+        uint32_t count = mf->find(mf, s->matches);
+        if (count)
+            mf_count(stats, mf->nice_len, count, s->matches[count - 1].len, s->matches[count - 1].dist + 1);
+        else
+            mf_count(stats, mf->nice_len, 0, 0, 0);
+    }
+    return 0;
+}
+
+static void* mf_xz_hc3_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { (void)chunk; return mf_xz_create(LZMA_MF_HC3, window, nice_len, depth); }
+static void* mf_xz_hc4_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { (void)chunk; return mf_xz_create(LZMA_MF_HC4, window, nice_len, depth); }
+static void* mf_xz_bt2_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { (void)chunk; return mf_xz_create(LZMA_MF_BT2, window, nice_len, depth); }
+static void* mf_xz_bt3_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { (void)chunk; return mf_xz_create(LZMA_MF_BT3, window, nice_len, depth); }
+static void* mf_xz_bt4_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth) { (void)chunk; return mf_xz_create(LZMA_MF_BT4, window, nice_len, depth); }
+#undef likely
+#undef unlikely
+#undef my_min
+#undef my_max
+#endif // BENCH_REMOVE_XZ
+
+
+#ifndef BENCH_REMOVE_FASTLZMA2
+#include "fast-lzma2/fl2_internal.h"
+#include "fast-lzma2/radix_internal.h"
+#define kMatchLenMax MF_MAX_NICE // of lzma2_enc.c, radix_get.h extends matches up to it
+#include "fast-lzma2/radix_get.h"
+
+typedef struct
+{
+    FL2_matchTable* tbl;
+    unsigned nice_len;
+} mf_radix_t;
+
+static void* mf_radix_create(size_t chunk, size_t window, unsigned nice_len, unsigned depth)
+{
+    mf_radix_t* s = (mf_radix_t*) calloc(1, sizeof(mf_radix_t));
+    RMF_parameters params;
+    if (!s) return NULL;
+    memset(&params, 0, sizeof(params));
+    params.dictionary_size = window;
+    params.match_buffer_resize = FL2_BUFFER_RESIZE_DEFAULT;
+    params.divide_and_conquer = 1;
+    params.depth = depth;
+    s->tbl = RMF_createMatchTable(&params, chunk, 1);
+    s->nice_len = mf_clamp(nice_len, MF_MIN_LENGTH, MF_MAX_NICE);
+    if (!s->tbl) { free(s); return NULL; }
+    return s;
+}
+
+static void mf_radix_destroy(void* state)
+{
+    mf_radix_t* s = (mf_radix_t*) state;
+    RMF_freeMatchTable(s->tbl);
+    free(s);
+}
+
+// the table of a block of the dictionary size is built by one thread, then the match of every position is read
+// from it like in lzma2_enc.c; blocks don't overlap
+static int mf_radix_run(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats)
+{
+    mf_radix_t* s = (mf_radix_t*) state;
+    FL2_matchTable* tbl = s->tbl;
+    size_t block_size = tbl->params.dictionary_size;
+    for (size_t start = 0; start < size; start += block_size)
+    {
+        FL2_dataBlock block;
+        block.data = in + start;
+        block.start = 0;
+        block.end = size - start < block_size ? size - start : block_size;
+        RMF_initProgress(tbl);
+        RMF_initTable(tbl, block.data, block.end);
+        if (RMF_buildTable(tbl, 0, 0, block)) return -1;
+        for (size_t pos = 0; pos < block.end; pos++)
+        {
+            RMF_match match = RMF_getMatch(block, tbl, tbl->params.depth, tbl->is_struct, pos);
+            mf_count(stats, s->nice_len, match.length > 0, match.length, match.dist + 1);
+        }
+    }
+    return 0;
+}
+#endif // BENCH_REMOVE_FASTLZMA2
+
+
+const lzbench_mf_desc_t lzbench_mf_desc[] =
+{
+#ifndef BENCH_REMOVE_LIBDEFLATE
+    { "libdeflate/ht",    1 << 15, 0, mf_deflate_ht_create, mf_deflate_ht_run, mf_deflate_destroy },
+    { "libdeflate/hc",    1 << 15, 0, mf_deflate_hc_create, mf_deflate_hc_run, mf_deflate_destroy },
+    { "libdeflate/bt",    1 << 15, 1, mf_deflate_bt_create, mf_deflate_bt_run, mf_deflate_destroy },
+#endif
+#ifndef BENCH_REMOVE_LZMA
+    { "lzma/hc4",         0, 1, mf_lzma_hc4_create,   mf_lzma_run,   mf_lzma_destroy },
+    { "lzma/hc5",         0, 1, mf_lzma_hc5_create,   mf_lzma_run,   mf_lzma_destroy },
+    { "lzma/bt2",         0, 1, mf_lzma_bt2_create,   mf_lzma_run,   mf_lzma_destroy },
+    { "lzma/bt3",         0, 1, mf_lzma_bt3_create,   mf_lzma_run,   mf_lzma_destroy },
+    { "lzma/bt4",         0, 1, mf_lzma_bt4_create,   mf_lzma_run,   mf_lzma_destroy },
+    { "lzma/bt4mt",       0, 1, mf_lzma_bt4mt_create, mf_lzma_run,   mf_lzma_destroy },
+#endif
+#ifndef BENCH_REMOVE_XZ
+    { "xz/hc3",           0, 1, mf_xz_hc3_create,     mf_xz_run,     mf_xz_destroy },
+    { "xz/hc4",           0, 1, mf_xz_hc4_create,     mf_xz_run,     mf_xz_destroy },
+    { "xz/bt2",           0, 1, mf_xz_bt2_create,     mf_xz_run,     mf_xz_destroy },
+    { "xz/bt3",           0, 1, mf_xz_bt3_create,     mf_xz_run,     mf_xz_destroy },
+    { "xz/bt4",           0, 1, mf_xz_bt4_create,     mf_xz_run,     mf_xz_destroy },
+#endif
+#ifndef BENCH_REMOVE_FASTLZMA2
+    { "fast-lzma2/radix", 0, 0, mf_radix_create,      mf_radix_run,  mf_radix_destroy },
+#endif
+    { NULL, 0, 0, NULL, NULL, NULL }
+};
+
+const int lzbench_mf_count = sizeof(lzbench_mf_desc) / sizeof(lzbench_mf_desc[0]) - 1;
@@ -0,0 +1,43 @@
+#ifndef LZBENCH_MATCHFINDERS_H
+#define LZBENCH_MATCHFINDERS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * --match-finders: the match finders of libdeflate, LZMA, xz and fast-lzma2 without their parsers and entropy
+ * coders. Every position of a chunk is searched (the radix match finder builds its table of a block and reads it
+ * for every position), there is no lazy evaluation and no skipping.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint64_t positions; // searched positions
+    uint64_t matches; // length-distance pairs returned, at most one per position for finders of the longest match
+    uint64_t found; // positions with a match of at least 3 bytes
+    uint64_t length_sum; // of the longest match of the found positions, capped at nice_len
+    uint64_t distance_sum; // of the longest match of the found positions
+} lzbench_mf_stats_t;
+
+typedef struct
+{
+    const char* name; // "library/finder"
+    size_t max_window; // 0 = any --match-finders window
+    int all_matches; // the finder returns a match of every length it passes, not only the longest
+    void* (*create)(size_t chunk, size_t window, unsigned nice_len, unsigned depth); // NULL = no memory
+    int (*run)(void* state, const uint8_t* in, size_t size, lzbench_mf_stats_t* stats); // 0 = done, the stats are added
+    void (*destroy)(void* state);
+} lzbench_mf_desc_t;
+
+extern const lzbench_mf_desc_t lzbench_mf_desc[];
+extern const int lzbench_mf_count;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
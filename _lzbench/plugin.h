@@ -0,0 +1,85 @@
+#ifndef LZBENCH_PLUGIN_H
+#define LZBENCH_PLUGIN_H
+
+#include <stddef.h>
+#include <stdint.h> // int64_t
+
+/*
+ * The interface of compressors, also of those in shared objects loaded with --plugin=path. A plugin includes only
+ * this header and exports lzbench_plugin(), which returns an array of *count compressors that stay valid until exit,
+ * or NULL if abi is not the LZBENCH_PLUGIN_ABI it was built with. Its compressors are used with -e name like the
+ * bundled ones, a compressor with the name of one that is already known is skipped.
+ */
+#define LZBENCH_PLUGIN_ABI 4
+
+/*
+ * max_block_size of a compressor is the largest chunk that its API takes, larger chunks of -b# are split in chunks
+ * of this size. 0 = LIMIT_2G of APIs with int sizes, below which also the compress bound of a chunk fits in an int.
+ */
+#define LIMIT_2G ((size_t)((1ULL << 31) - (1ULL << 31)/6))
+#define LIMIT_4G ((size_t)((1ULL << 32) - (1ULL << 32)/6)) // unsigned int sizes
+#define NO_LIMIT SIZE_MAX // size_t sizes end to end
+
+typedef int64_t (*compress_func)(char *in, size_t insize, char *out, size_t outsize, size_t, size_t, char*);
+typedef char* (*init_func)(size_t insize, size_t, size_t);
+typedef void (*deinit_func)(char* workmem);
+typedef size_t (*bound_func)(size_t insize);
+
+/*
+ * Optional batch interface: n chunks in one call, chunk i of insize[i] bytes at in[i] is written to out[i] of
+ * outsize[i] bytes and sizes[i] gets the number of bytes written, 0 or less if the chunk failed (a chunk that
+ * fails to compress is stored). It returns 0 or -1 when the whole batch failed.
+ */
+typedef int64_t (*batch_func)(size_t n, char **in, const size_t *insize, char **out, const size_t *outsize, int64_t *sizes, size_t, size_t, char*);
+
+/*
+ * Optional streaming interface used by --feed. begin returns the state of a new stream or NULL, feed and flush
+ * return the number of bytes written to out or -1, end finishes the stream and frees the state (only frees it
+ * when out is NULL).
+ */
+typedef char* (*stream_begin_func)(size_t level, size_t);
+typedef int64_t (*stream_feed_func)(char* state, char *in, size_t insize, char *out, size_t outsize);
+typedef int64_t (*stream_end_func)(char* state, char *out, size_t outsize);
+
+typedef struct
+{
+    stream_begin_func begin;
+    stream_feed_func feed;
+    stream_end_func flush; // NULL = the format has no flush
+    stream_end_func end;
+    compress_func decompress; // NULL = the stream is read by decompress of the codec
+} stream_desc_t;
+
+typedef struct
+{
+    const char* name;
+    const char* version;
+    int first_level;
+    int last_level;
+    int additional_param;
+    size_t max_block_size; // LIMIT_4G, NO_LIMIT or a smaller limit of the format, 0 = LIMIT_2G
+    compress_func compress;
+    compress_func decompress;
+    init_func init;
+    deinit_func deinit;
+    const stream_desc_t* stream; // NULL = only one-shot calls
+    bound_func bound; // worst case size of compress of insize bytes, NULL = insize + insize/6 + 16 KB
+    batch_func compress_batch; // NULL = compress is called for every chunk
+    batch_func decompress_batch; // NULL = decompress is called for every chunk
+} compressor_desc_t;
+
+/*
+ * A consumer of decompressed data for --consume=path: a shared object exporting lzbench_consume(), which is called
+ * with every chunk right after its decompression and returns a value depending on the data, e.g. a hash or a count.
+ */
+typedef uint64_t (*consume_func)(const char *data, size_t size);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+typedef const compressor_desc_t* (*lzbench_plugin_func)(int abi, int* count);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * A --plugin with the codecs of the shared libraries installed on the system, built by "make lzbench-system.so" for
+ * those whose headers are found (SYSTEM_HAS_ZSTD, SYSTEM_HAS_ZLIB, SYSTEM_HAS_LZ4, SYSTEM_HAS_BROTLI). They are named
+ * zstd[system], zlib[system], lz4[system] and brotli[system] and the bundled ones are shown as zstd[bundled] etc.
+ * It includes only plugin.h of lzbench and the system headers, never the bundled copies of the libraries.
+ */
+#include "plugin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#ifdef SYSTEM_HAS_ZSTD
+#include <zstd.h>
+
+typedef struct
+{
+    ZSTD_CCtx* cctx;
+    ZSTD_DCtx* dctx;
+} system_zstd_s;
+
+static char* system_zstd_init(size_t, size_t, size_t)
+{
+    system_zstd_s* state = (system_zstd_s*) calloc(1, sizeof(system_zstd_s));
+    if (!state) return NULL;
+    state->cctx = ZSTD_createCCtx();
+    state->dctx = ZSTD_createDCtx();
+    return (char*) state;
+}
+
+static void system_zstd_deinit(char* workmem)
+{
+    system_zstd_s* state = (system_zstd_s*) workmem;
+    if (!state) return;
+    ZSTD_freeCCtx(state->cctx);
+    ZSTD_freeDCtx(state->dctx);
+    free(workmem);
+}
+
+static int64_t system_zstd_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char* workmem)
+{
+    system_zstd_s* state = (system_zstd_s*) workmem;
+    if (!state || !state->cctx) return 0;
+    size_t res = ZSTD_compressCCtx(state->cctx, outbuf, outsize, inbuf, insize, (int)level);
+    return ZSTD_isError(res) ? 0 : res;
+}
+
+static size_t system_zstd_bound(size_t insize)
+{
+    return ZSTD_compressBound(insize);
+}
+
+static int64_t system_zstd_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    system_zstd_s* state = (system_zstd_s*) workmem;
+    if (!state || !state->dctx) return 0;
+    size_t res = ZSTD_decompressDCtx(state->dctx, outbuf, outsize, inbuf, insize);
+    return ZSTD_isError(res) ? 0 : res;
+}
+#endif
+
+#ifdef SYSTEM_HAS_ZLIB
+#include <zlib.h>
+
+// like the bundled zlib with reused contexts: streams initialized once, deflateReset() and inflateReset() before every call
+typedef struct
+{
+    z_stream cstream, dstream;
+    bool cinit, dinit;
+} system_zlib_s;
+
+static char* system_zlib_init(size_t, size_t level, size_t)
+{
+    system_zlib_s* state = (system_zlib_s*) calloc(1, sizeof(system_zlib_s));
+    if (!state) return NULL;
+    state->cinit = deflateInit(&state->cstream, (int)level) == Z_OK;
+    state->dinit = inflateInit(&state->dstream) == Z_OK;
+    return (char*) state;
+}
+
+static void system_zlib_deinit(char* workmem)
+{
+    system_zlib_s* state = (system_zlib_s*) workmem;
+    if (!state) return;
+    if (state->cinit) deflateEnd(&state->cstream);
+    if (state->dinit) inflateEnd(&state->dstream);
+    free(workmem);
+}
+
+static int64_t system_zlib_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    system_zlib_s* state = (system_zlib_s*) workmem;
+    if (!state || !state->cinit || deflateReset(&state->cstream) != Z_OK) return 0;
+    z_stream* stream = &state->cstream;
+    stream->next_in = (Bytef*)inbuf;
+    stream->avail_in = (uInt)insize;
+    stream->next_out = (Bytef*)outbuf;
+    stream->avail_out = (uInt)outsize;
+    if (deflate(stream, Z_FINISH) != Z_STREAM_END) return 0;
+    return stream->total_out;
+}
+
+static size_t system_zlib_bound(size_t insize)
+{
+    return compressBound((uLong)insize);
+}
+
+static int64_t system_zlib_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char* workmem)
+{
+    system_zlib_s* state = (system_zlib_s*) workmem;
+    if (!state || !state->dinit || inflateReset(&state->dstream) != Z_OK) return 0;
+    z_stream* stream = &state->dstream;
+    stream->next_in = (Bytef*)inbuf;
+    stream->avail_in = (uInt)insize;
+    stream->next_out = (Bytef*)outbuf;
+    stream->avail_out = (uInt)outsize;
+    if (inflate(stream, Z_FINISH) != Z_STREAM_END) return 0;
+    return stream->total_out;
+}
+#endif
+
+#ifdef SYSTEM_HAS_LZ4
+#include <lz4.h>
+
+static int64_t system_lz4_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    return LZ4_compress_default(inbuf, outbuf, (int)insize, (int)outsize);
+}
+
+static size_t system_lz4_bound(size_t insize)
+{
+    return insize > LZ4_MAX_INPUT_SIZE ? 0 : LZ4_compressBound((int)insize);
+}
+
+static int64_t system_lz4_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    int res = LZ4_decompress_safe(inbuf, outbuf, (int)insize, (int)outsize);
+    return res < 0 ? 0 : res;
+}
+#endif
+
+#ifdef SYSTEM_HAS_BROTLI
+#include <brotli/encode.h>
+#include <brotli/decode.h>
+
+static int64_t system_brotli_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, char*)
+{
+    size_t actual_osize = outsize;
+    if (!BrotliEncoderCompress((int)level, BROTLI_DEFAULT_WINDOW, BROTLI_DEFAULT_MODE, insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf)) return 0;
+    return actual_osize;
+}
+
+static size_t system_brotli_bound(size_t insize)
+{
+    return BrotliEncoderMaxCompressedSize(insize);
+}
+
+static int64_t system_brotli_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t, size_t, char*)
+{
+    size_t actual_osize = outsize;
+    if (BrotliDecoderDecompress(insize, (const uint8_t*)inbuf, &actual_osize, (uint8_t*)outbuf) != BROTLI_DECODER_RESULT_SUCCESS) return 0;
+    return actual_osize;
+}
+
+static char brotli_version[16];
+#endif
+
+static std::vector<compressor_desc_t> system_desc;
+
+extern "C"
+#ifdef _WIN32
+__declspec(dllexport)
+#else
+__attribute__((visibility("default")))
+#endif
+const compressor_desc_t* lzbench_plugin(int abi, int* count)
+{
+    if (abi != LZBENCH_PLUGIN_ABI) return NULL;
+    if (system_desc.empty())
+    {
+        // the versions are those of the libraries loaded at runtime, not of the headers
+#ifdef SYSTEM_HAS_BROTLI
+        uint32_t v = BrotliEncoderVersion();
+        snprintf(brotli_version, sizeof(brotli_version), "%u.%u.%u", v >> 24, (v >> 12) & 0xFFF, v & 0xFFF);
+        system_desc.push_back({ "brotli[system]", brotli_version, 0, 11, 0, NO_LIMIT, system_brotli_compress, system_brotli_decompress, NULL, NULL, NULL, system_brotli_bound });
+#endif
+#ifdef SYSTEM_HAS_LZ4
+        system_desc.push_back({ "lz4[system]", LZ4_versionString(), 0, 0, 0, 0, system_lz4_compress, system_lz4_decompress, NULL, NULL, NULL, system_lz4_bound });
+#endif
+#ifdef SYSTEM_HAS_ZLIB
+        system_desc.push_back({ "zlib[system]", zlibVersion(), 1, 9, 0, 0, system_zlib_compress, system_zlib_decompress, system_zlib_init, system_zlib_deinit, NULL, system_zlib_bound });
+#endif
+#ifdef SYSTEM_HAS_ZSTD
+        system_desc.push_back({ "zstd[system]", ZSTD_versionString(), 1, 22, 0, NO_LIMIT, system_zstd_compress, system_zstd_decompress, system_zstd_init, system_zstd_deinit, NULL, system_zstd_bound });
+#endif
+    }
+    *count = (int)system_desc.size();
+    return system_desc.empty() ? NULL : system_desc.data();
+}
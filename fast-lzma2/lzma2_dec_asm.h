@@ -0,0 +1,47 @@
+/*
+ * lzbench builds fl2_decompress.c and lzma2_dec.c a second time as fl2_decompress_asm.o and lzma2_dec_asm.o
+ * with -DLZMA2_DEC_OPT, so LZMA_decodeReal_3() of lzma_dec_x86_64.S decodes the symbols. This header is
+ * included first to rename their functions, the C decoder stays under the original names.
+ */
+#ifndef LZMA2_DEC_ASM_H
+#define LZMA2_DEC_ASM_H
+
+#define FL2_cancelDStream FL2_asm_cancelDStream
+#define FL2_createDCtx FL2_asm_createDCtx
+#define FL2_createDCtxMt FL2_asm_createDCtxMt
+#define FL2_createDStream FL2_asm_createDStream
+#define FL2_createDStreamMt FL2_asm_createDStreamMt
+#define FL2_decompress FL2_asm_decompress
+#define FL2_decompressDCtx FL2_asm_decompressDCtx
+#define FL2_decompressMt FL2_asm_decompressMt
+#define FL2_decompressStream FL2_asm_decompressStream
+#define FL2_estimateDCtxSize FL2_asm_estimateDCtxSize
+#define FL2_estimateDStreamSize FL2_asm_estimateDStreamSize
+#define FL2_findDecompressedSize FL2_asm_findDecompressedSize
+#define FL2_freeDCtx FL2_asm_freeDCtx
+#define FL2_freeDStream FL2_asm_freeDStream
+#define FL2_getDCtxThreadCount FL2_asm_getDCtxThreadCount
+#define FL2_getDStreamProgress FL2_asm_getDStreamProgress
+#define FL2_getDictSizeFromProp FL2_asm_getDictSizeFromProp
+#define FL2_initDCtx FL2_asm_initDCtx
+#define FL2_initDStream FL2_asm_initDStream
+#define FL2_initDStream_withProp FL2_asm_initDStream_withProp
+#define FL2_setDStreamMemoryLimitMt FL2_asm_setDStreamMemoryLimitMt
+#define FL2_setDStreamTimeout FL2_asm_setDStreamTimeout
+#define FL2_waitDStream FL2_asm_waitDStream
+
+#define LZMA_constructDCtx LZMA_asm_constructDCtx
+#define LZMA_destructDCtx LZMA_asm_destructDCtx
+#define LZMA2_decMemoryUsage LZMA2_asm_decMemoryUsage
+#define LZMA2_decodeToBuf LZMA2_asm_decodeToBuf
+#define LZMA2_decodeToDic LZMA2_asm_decodeToDic
+#define LZMA2_getDictSizeFromProp LZMA2_asm_getDictSizeFromProp
+#define LZMA2_getUnpackSize LZMA2_asm_getUnpackSize
+#define LZMA2_initDecoder LZMA2_asm_initDecoder
+#define LZMA2_parseInput LZMA2_asm_parseInput
+
+#ifndef LZMA2_DEC_OPT
+#define LZMA2_DEC_OPT
+#endif
+
+#endif /* LZMA2_DEC_ASM_H */
@@ -0,0 +1,60 @@
+/*
+ * lzbench builds lz4.c again for every lz4_m## codec as lz4/lz4_m##.o with -DLZ4_MEMORY_USAGE=## (hash table of
+ * 2^## bytes). This header is included first to rename its functions to LZ4_m##_*, lz4.o keeps the original names.
+ */
+#ifndef LZ4_MEM_H
+#define LZ4_MEM_H
+
+#define LZ4_MEM_CAT(a,b,c) a##b##c
+#define LZ4_MEM_NAME(m,n) LZ4_MEM_CAT(LZ4_m,m,n)
+
+#define LZ4_attach_dictionary LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _attach_dictionary)
+#define LZ4_compress LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress)
+#define LZ4_compressBound LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compressBound)
+#define LZ4_compress_continue LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_continue)
+#define LZ4_compress_default LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_default)
+#define LZ4_compress_destSize LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_destSize)
+#define LZ4_compress_fast LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_fast)
+#define LZ4_compress_fast_continue LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_fast_continue)
+#define LZ4_compress_fast_extState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_fast_extState)
+#define LZ4_compress_fast_extState_fastReset LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_fast_extState_fastReset)
+#define LZ4_compress_forceExtDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_forceExtDict)
+#define LZ4_compress_limitedOutput LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_limitedOutput)
+#define LZ4_compress_limitedOutput_continue LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_limitedOutput_continue)
+#define LZ4_compress_limitedOutput_withState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_limitedOutput_withState)
+#define LZ4_compress_withState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _compress_withState)
+#define LZ4_create LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _create)
+#define LZ4_createStream LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _createStream)
+#define LZ4_createStreamDecode LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _createStreamDecode)
+#define LZ4_decoderRingBufferSize LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decoderRingBufferSize)
+#define LZ4_decompress_fast LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_fast)
+#define LZ4_decompress_fast_continue LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_fast_continue)
+#define LZ4_decompress_fast_usingDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_fast_usingDict)
+#define LZ4_decompress_fast_withPrefix64k LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_fast_withPrefix64k)
+#define LZ4_decompress_safe LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe)
+#define LZ4_decompress_safe_continue LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_continue)
+#define LZ4_decompress_safe_forceExtDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_forceExtDict)
+#define LZ4_decompress_safe_partial LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_partial)
+#define LZ4_decompress_safe_partial_forceExtDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_partial_forceExtDict)
+#define LZ4_decompress_safe_partial_usingDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_partial_usingDict)
+#define LZ4_decompress_safe_usingDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_usingDict)
+#define LZ4_decompress_safe_withPrefix64k LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _decompress_safe_withPrefix64k)
+#define LZ4_freeStream LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _freeStream)
+#define LZ4_freeStreamDecode LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _freeStreamDecode)
+#define LZ4_initStream LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _initStream)
+#define LZ4_loadDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _loadDict)
+#define LZ4_resetStream LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _resetStream)
+#define LZ4_resetStreamState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _resetStreamState)
+#define LZ4_resetStream_fast LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _resetStream_fast)
+#define LZ4_saveDict LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _saveDict)
+#define LZ4_setStreamDecode LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _setStreamDecode)
+#define LZ4_sizeofState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _sizeofState)
+#define LZ4_sizeofStreamState LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _sizeofStreamState)
+#define LZ4_slideInputBuffer LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _slideInputBuffer)
+#define LZ4_uncompress LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _uncompress)
+#define LZ4_uncompress_unknownOutputSize LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _uncompress_unknownOutputSize)
+#define LZ4_versionNumber LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _versionNumber)
+#define LZ4_versionString LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _versionString)
+#define read_long_length_no_check LZ4_MEM_NAME(LZ4_MEMORY_USAGE, _read_long_length_no_check)
+
+#endif /* LZ4_MEM_H */
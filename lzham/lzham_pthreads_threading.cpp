@@ -0,0 +1,275 @@
+// File: lzham_pthreads_threading.cpp
+// See Copyright Notice and license at the end of include/lzham.h
+#include "lzham_core.h"
+#include "lzham_threading.h"
+
+#if LZHAM_USE_PTHREADS_API
+
+#include <unistd.h>
+#include <errno.h>
+#include <sys/time.h>
+
+namespace lzham
+{
+   semaphore::semaphore(long initialCount, long maximumCount, const char* pName) :
+      m_count(initialCount),
+      m_max_count(maximumCount)
+   {
+      (void)pName;
+      pthread_mutex_init(&m_mutex, NULL);
+      pthread_cond_init(&m_cond, NULL);
+   }
+
+   semaphore::~semaphore()
+   {
+      pthread_cond_destroy(&m_cond);
+      pthread_mutex_destroy(&m_mutex);
+   }
+
+   void semaphore::release(long releaseCount, long *pPreviousCount)
+   {
+      pthread_mutex_lock(&m_mutex);
+      if (pPreviousCount)
+         *pPreviousCount = m_count;
+      m_count = LZHAM_MIN(m_count + releaseCount, m_max_count);
+      pthread_cond_broadcast(&m_cond);
+      pthread_mutex_unlock(&m_mutex);
+   }
+
+   bool semaphore::wait(uint32 milliseconds)
+   {
+      bool signaled = true;
+
+      pthread_mutex_lock(&m_mutex);
+      if (milliseconds == UINT32_MAX)
+      {
+         while (m_count <= 0)
+            pthread_cond_wait(&m_cond, &m_mutex);
+      }
+      else
+      {
+         struct timeval now;
+         struct timespec deadline;
+         gettimeofday(&now, NULL);
+         uint64 nsec = (uint64)now.tv_usec * 1000U + (uint64)milliseconds * 1000000U;
+         deadline.tv_sec = now.tv_sec + (time_t)(nsec / 1000000000U);
+         deadline.tv_nsec = (long)(nsec % 1000000000U);
+
+         while ((m_count <= 0) && (signaled))
+            signaled = pthread_cond_timedwait(&m_cond, &m_mutex, &deadline) != ETIMEDOUT;
+         signaled = m_count > 0;
+      }
+      if (signaled)
+         m_count--;
+      pthread_mutex_unlock(&m_mutex);
+
+      return signaled;
+   }
+
+   task_pool::task_pool() :
+      m_num_threads(0),
+      m_num_outstanding_tasks(0),
+      m_exit_flag(false)
+   {
+      pthread_mutex_init(&m_mutex, NULL);
+      pthread_cond_init(&m_task_cond, NULL);
+      pthread_cond_init(&m_done_cond, NULL);
+   }
+
+   task_pool::task_pool(uint num_threads) :
+      m_num_threads(0),
+      m_num_outstanding_tasks(0),
+      m_exit_flag(false)
+   {
+      pthread_mutex_init(&m_mutex, NULL);
+      pthread_cond_init(&m_task_cond, NULL);
+      pthread_cond_init(&m_done_cond, NULL);
+
+      bool status = init(num_threads);
+      LZHAM_VERIFY(status);
+   }
+
+   task_pool::~task_pool()
+   {
+      deinit();
+
+      pthread_cond_destroy(&m_done_cond);
+      pthread_cond_destroy(&m_task_cond);
+      pthread_mutex_destroy(&m_mutex);
+   }
+
+   bool task_pool::init(uint num_threads)
+   {
+      LZHAM_ASSERT(num_threads <= cMaxThreads);
+      num_threads = LZHAM_MIN(num_threads, (uint)cMaxThreads);
+
+      deinit();
+
+      bool succeeded = true;
+
+      m_num_threads = 0;
+      while (m_num_threads < num_threads)
+      {
+         if (pthread_create(&m_threads[m_num_threads], NULL, thread_func, this))
+         {
+            succeeded = false;
+            break;
+         }
+
+         m_num_threads++;
+      }
+
+      if (!succeeded)
+      {
+         deinit();
+         return false;
+      }
+
+      return true;
+   }
+
+   void task_pool::deinit()
+   {
+      if (m_num_threads)
+      {
+         join();
+
+         pthread_mutex_lock(&m_mutex);
+         m_exit_flag = true;
+         pthread_cond_broadcast(&m_task_cond);
+         pthread_mutex_unlock(&m_mutex);
+
+         for (uint i = 0; i < m_num_threads; i++)
+            pthread_join(m_threads[i], NULL);
+
+         m_num_threads = 0;
+         m_exit_flag = false;
+      }
+
+      m_tasks.clear();
+      m_num_outstanding_tasks = 0;
+   }
+
+   bool task_pool::push(const task& tsk)
+   {
+      pthread_mutex_lock(&m_mutex);
+      bool status = m_tasks.try_push_back(tsk);
+      if (status)
+      {
+         m_num_outstanding_tasks++;
+         pthread_cond_signal(&m_task_cond);
+      }
+      pthread_mutex_unlock(&m_mutex);
+      return status;
+   }
+
+   // The caller holds m_mutex.
+   bool task_pool::pop(task& tsk)
+   {
+      if (m_tasks.empty())
+         return false;
+      tsk = m_tasks.back();
+      m_tasks.pop_back();
+      return true;
+   }
+
+   bool task_pool::queue_task(task_callback_func pFunc, uint64 data, void* pData_ptr)
+   {
+      LZHAM_ASSERT(pFunc);
+
+      task tsk;
+      tsk.m_callback = pFunc;
+      tsk.m_pObj = NULL;
+      tsk.m_data = data;
+      tsk.m_pData_ptr = pData_ptr;
+
+      return push(tsk);
+   }
+
+   bool task_pool::queue_task(executable_task* pObj, uint64 data, void* pData_ptr)
+   {
+      LZHAM_ASSERT(pObj);
+
+      task tsk;
+      tsk.m_callback = NULL;
+      tsk.m_pObj = pObj;
+      tsk.m_data = data;
+      tsk.m_pData_ptr = pData_ptr;
+
+      return push(tsk);
+   }
+
+   void task_pool::process_task(task& tsk)
+   {
+      if (tsk.m_pObj)
+         tsk.m_pObj->execute_task(tsk.m_data, tsk.m_pData_ptr);
+      else
+         tsk.m_callback(tsk.m_data, tsk.m_pData_ptr);
+
+      pthread_mutex_lock(&m_mutex);
+      if (--m_num_outstanding_tasks == 0)
+         pthread_cond_broadcast(&m_done_cond);
+      pthread_mutex_unlock(&m_mutex);
+   }
+
+   void task_pool::join()
+   {
+      task tsk;
+
+      pthread_mutex_lock(&m_mutex);
+      for ( ; ; )
+      {
+         if (pop(tsk))
+         {
+            pthread_mutex_unlock(&m_mutex);
+            process_task(tsk);
+            pthread_mutex_lock(&m_mutex);
+         }
+         else if (m_num_outstanding_tasks)
+            pthread_cond_wait(&m_done_cond, &m_mutex);
+         else
+            break;
+      }
+      pthread_mutex_unlock(&m_mutex);
+   }
+
+   void* task_pool::thread_func(void *pContext)
+   {
+      task_pool* pPool = static_cast<task_pool*>(pContext);
+      task tsk;
+
+      pthread_mutex_lock(&pPool->m_mutex);
+      for ( ; ; )
+      {
+         if (pPool->pop(tsk))
+         {
+            pthread_mutex_unlock(&pPool->m_mutex);
+            pPool->process_task(tsk);
+            pthread_mutex_lock(&pPool->m_mutex);
+         }
+         else if (pPool->m_exit_flag)
+            break;
+         else
+            pthread_cond_wait(&pPool->m_task_cond, &pPool->m_mutex);
+      }
+      pthread_mutex_unlock(&pPool->m_mutex);
+
+      return NULL;
+   }
+
+   void lzham_sleep(unsigned int milliseconds)
+   {
+      usleep(milliseconds * 1000U);
+   }
+
+   uint lzham_get_max_helper_threads()
+   {
+      long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+      if (num_cpus <= 1)
+         return 0;
+      return static_cast<uint>(LZHAM_MIN(num_cpus - 1, (long)LZHAM_MAX_HELPER_THREADS));
+   }
+
+} // namespace lzham
+
+#endif // LZHAM_USE_PTHREADS_API
@@ -1,7 +1,40 @@
 #include "common.h"
 #include "alone.h"
 
+/* allocation functions of xz_set_allocator(), NULL = liblzma uses malloc and free */
+static void *(*xz_alloc_fn)(size_t) = NULL;
+static void (*xz_free_fn)(void *) = NULL;
+
+static void *xz_alloc(void *opaque, size_t nmemb, size_t size)
+{
+    (void)opaque;
+    return xz_alloc_fn(nmemb * size);
+}
+
+static void xz_free(void *opaque, void *ptr)
+{
+    (void)opaque;
+    xz_free_fn(ptr);
+}
+
+static const lzma_allocator xz_hooks = { xz_alloc, xz_free, NULL };
+#define XZ_ALLOCATOR (xz_alloc_fn ? &xz_hooks : NULL)
+
+void xz_set_allocator(void *(*alloc)(size_t), void (*release)(void *))
+{
+    xz_alloc_fn = alloc;
+    xz_free_fn = release;
+}
+
+
 int64_t xz_alone_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t x, size_t y)
+{
+	return xz_alone_compress_options(inbuf, insize, outbuf, outsize, level, 0, -1, -1, -1, -1);
+}
+
+
+/* dict_size = 0 and lc, lp, pb, nice_len < 0 keep the values of the preset */
+int64_t xz_alone_compress_options(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, uint32_t dict_size, int lc, int lp, int pb, int nice_len)
 {
     lzma_options_lzma opt_lzma;
     lzma_stream strm = LZMA_STREAM_INIT;
@@ -9,7 +42,13 @@ int64_t xz_alone_compress(char *inbuf, size_t insize, char *outbuf, size_t outsi
 
 	if (lzma_lzma_preset(&opt_lzma, preset))
 		return 0;
+	if (dict_size) opt_lzma.dict_size = dict_size;
+	if (lc >= 0) opt_lzma.lc = lc;
+	if (lp >= 0) opt_lzma.lp = lp;
+	if (pb >= 0) opt_lzma.pb = pb;
+	if (nice_len >= 0) opt_lzma.nice_len = nice_len;
 
+	strm.allocator = XZ_ALLOCATOR;
 	lzma_ret ret = lzma_alone_encoder(&strm, &opt_lzma);
 	if (ret != LZMA_OK)
 		return 0;
@@ -36,10 +75,222 @@ int64_t xz_alone_compress(char *inbuf, size_t insize, char *outbuf, size_t outsi
 }
 
 
+/*
+ * xzmt: a .xz stream of lzma_stream_encoder_mt(). The lzma_stream is kept between calls,
+ * so its worker threads are reused when it's initialized again with the same number of threads.
+ */
+void* xz_mt_init()
+{
+    lzma_stream *strm = (lzma_stream*)malloc(sizeof(lzma_stream));
+    lzma_stream init = LZMA_STREAM_INIT;
+
+    if (strm)
+        *strm = init;
+    return strm;
+}
+
+
+int64_t xz_mt_compress(void *state, char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, uint32_t threads, uint64_t block_size)
+{
+    lzma_stream *strm = (lzma_stream*)state;
+    lzma_mt mt;
+    lzma_ret ret;
+
+    memset(&mt, 0, sizeof(mt));
+    mt.threads = threads;
+    mt.block_size = block_size;
+    mt.preset = level;
+    mt.check = LZMA_CHECK_CRC64; // as xz -T0
+    if (lzma_stream_encoder_mt(strm, &mt) != LZMA_OK)
+        return 0;
+
+    strm->next_in = (const uint8_t*)inbuf;
+    strm->avail_in = insize;
+    strm->next_out = (uint8_t*)outbuf;
+    strm->avail_out = outsize;
+    do {
+        ret = lzma_code(strm, LZMA_FINISH);
+    } while (ret == LZMA_OK && strm->avail_out);
+    if (ret != LZMA_STREAM_END)
+        return 0;
+
+    return (char*)strm->next_out - outbuf;
+}
+
+
+/* a .xz stream of a single block with the integrity check of xz --check=crc64|sha256, decoded by xz_mt_decompress() */
+int64_t xz_check_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, int check)
+{
+    size_t out_pos = 0;
+
+    if (lzma_easy_buffer_encode(level, (lzma_check)check, XZ_ALLOCATOR, (const uint8_t*)inbuf, insize, (uint8_t*)outbuf, &out_pos, outsize) != LZMA_OK)
+        return 0;
+    return out_pos;
+}
+
+
+/* blocks of the stream are decoded one after another, liblzma 5.2 has no threaded decoder */
+int64_t xz_mt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize)
+{
+    uint64_t memlimit = UINT64_MAX;
+    size_t in_pos = 0, out_pos = 0;
+
+    if (lzma_stream_buffer_decode(&memlimit, 0, XZ_ALLOCATOR, (const uint8_t*)inbuf, &in_pos, insize, (uint8_t*)outbuf, &out_pos, outsize) != LZMA_OK)
+        return 0;
+    return out_pos;
+}
+
+
+/* --ttfb: a .lzma (alone) or .xz stream is decoded until outsize bytes of output exist */
+int64_t xz_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, int alone)
+{
+    lzma_stream strm = LZMA_STREAM_INIT;
+    lzma_ret ret;
+
+    strm.allocator = XZ_ALLOCATOR;
+    if ((alone ? lzma_alone_decoder(&strm, UINT64_MAX) : lzma_stream_decoder(&strm, UINT64_MAX, 0)) != LZMA_OK)
+        return 0;
+    strm.next_in = (const uint8_t*)inbuf;
+    strm.avail_in = insize;
+    strm.next_out = (uint8_t*)outbuf;
+    strm.avail_out = outsize;
+    do ret = lzma_code(&strm, LZMA_RUN);
+    while (ret == LZMA_OK && strm.avail_out && strm.avail_in);
+    lzma_end(&strm);
+    if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+        return 0;
+    return (char*)strm.next_out - outbuf;
+}
+
+
+/*
+ * blocks of a .xz stream from its index for decoding them in parallel, 0 = not a single stream
+ * with an index of at least one block. Stream padding after the footer is skipped.
+ */
+size_t xz_stream_blocks(const char *inbuf, size_t insize, xz_block_t *blocks, size_t max_blocks, int *check)
+{
+    const uint8_t *in = (const uint8_t*)inbuf;
+    lzma_stream_flags footer;
+    lzma_index *idx = NULL;
+    lzma_index_iter iter;
+    uint64_t memlimit = UINT64_MAX;
+    size_t in_pos, count = 0;
+
+    while (insize >= 4 && !in[insize - 1] && !in[insize - 2] && !in[insize - 3] && !in[insize - 4])
+        insize -= 4;
+    if (insize < 2 * LZMA_STREAM_HEADER_SIZE || lzma_stream_footer_decode(&footer, in + insize - LZMA_STREAM_HEADER_SIZE) != LZMA_OK
+        || footer.backward_size > insize - 2 * LZMA_STREAM_HEADER_SIZE)
+        return 0;
+    in_pos = insize - LZMA_STREAM_HEADER_SIZE - footer.backward_size;
+    if (lzma_index_buffer_decode(&idx, &memlimit, NULL, in, &in_pos, insize - LZMA_STREAM_HEADER_SIZE) != LZMA_OK)
+        return 0;
+    if (lzma_index_stream_flags(idx, &footer) != LZMA_OK || lzma_index_file_size(idx) != insize) {
+        lzma_index_end(idx, NULL);
+        return 0;
+    }
+
+    lzma_index_iter_init(&iter, idx);
+    while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+        if (count < max_blocks) {
+            blocks[count].in_offset = iter.block.compressed_file_offset;
+            blocks[count].in_size = iter.block.total_size;
+            blocks[count].out_offset = iter.block.uncompressed_file_offset;
+            blocks[count].out_size = iter.block.uncompressed_size;
+        }
+        count++;
+    }
+    *check = footer.check;
+    lzma_index_end(idx, NULL);
+    return count;
+}
+
+
+/* a block of xz_stream_blocks() on its own with the integrity check of the stream */
+int64_t xz_block_decompress(const char *inbuf, size_t insize, int check, char *outbuf, size_t outsize)
+{
+    const uint8_t *in = (const uint8_t*)inbuf;
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    lzma_block block;
+    size_t in_pos, out_pos = 0, i;
+    lzma_ret ret;
+
+    if (!insize)
+        return -1;
+    memset(&block, 0, sizeof(block));
+    block.version = 1;
+    block.check = (lzma_check)check;
+    block.filters = filters;
+    block.header_size = lzma_block_header_size_decode(in[0]);
+    if (block.header_size > insize || lzma_block_header_decode(&block, NULL, in) != LZMA_OK)
+        return -1;
+
+    in_pos = block.header_size;
+    ret = lzma_block_buffer_decode(&block, XZ_ALLOCATOR, in, &in_pos, insize, (uint8_t*)outbuf, &out_pos, outsize);
+    for (i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+        free(filters[i].options);
+    return ret == LZMA_OK ? (int64_t)out_pos : -1;
+}
+
+
+void xz_mt_end(void *state)
+{
+    if (!state)
+        return;
+    lzma_end((lzma_stream*)state);
+    free(state);
+}
+
+
+/* streaming of --feed: action is LZMA_RUN or LZMA_FINISH, the .lzma format has no LZMA_SYNC_FLUSH */
+void* xz_alone_stream_begin(size_t level)
+{
+    lzma_options_lzma opt_lzma;
+    lzma_stream *strm = (lzma_stream*)malloc(sizeof(lzma_stream));
+    lzma_stream init = LZMA_STREAM_INIT;
+
+    if (!strm)
+        return NULL;
+    *strm = init;
+    if (lzma_lzma_preset(&opt_lzma, level) || lzma_alone_encoder(strm, &opt_lzma) != LZMA_OK) {
+        free(strm);
+        return NULL;
+    }
+    return strm;
+}
+
+
+int64_t xz_alone_stream_code(void *state, char *inbuf, size_t insize, char *outbuf, size_t outsize, int finish)
+{
+    lzma_stream *strm = (lzma_stream*)state;
+    lzma_ret ret;
+
+    strm->next_in = (const uint8_t*)inbuf;
+    strm->avail_in = insize;
+    strm->next_out = (uint8_t*)outbuf;
+    strm->avail_out = outsize;
+    do {
+        ret = lzma_code(strm, finish ? LZMA_FINISH : LZMA_RUN);
+        if (ret != LZMA_OK && ret != LZMA_STREAM_END)
+            return -1;
+        if (finish ? ret == LZMA_STREAM_END : strm->avail_in == 0)
+            return (char*)strm->next_out - outbuf;
+    } while (strm->avail_out);
+    return -1;
+}
+
+
+void xz_alone_stream_end(void *state)
+{
+    lzma_end((lzma_stream*)state);
+    free(state);
+}
+
+
 int64_t xz_alone_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t x, size_t y)
 {
     lzma_stream strm = LZMA_STREAM_INIT;
 
+	strm.allocator = XZ_ALLOCATOR;
 	lzma_ret ret = lzma_alone_decoder(&strm, UINT64_MAX);
 	if (ret != LZMA_OK)
 		return 0;
@@ -60,3 +311,15 @@ int64_t xz_alone_decompress(char *inbuf, size_t insize, char *outbuf, size_t out
     
     return (char*)strm.next_out - outbuf;
 }
+
+
+uint32_t xz_crc32(const char *buf, size_t size)
+{
+    return lzma_crc32((const uint8_t*)buf, size, 0);
+}
+
+
+uint64_t xz_crc64(const char *buf, size_t size)
+{
+    return lzma_crc64((const uint8_t*)buf, size, 0);
+}
@@ -5,8 +5,28 @@
 extern "C"
 {
 #endif
+    typedef struct
+    {
+        uint64_t in_offset, in_size, out_offset, out_size;
+    } xz_block_t;
+
+    void xz_set_allocator(void *(*alloc)(size_t), void (*release)(void *));
     int64_t xz_alone_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t, size_t);
+    int64_t xz_alone_compress_options(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, uint32_t dict_size, int lc, int lp, int pb, int nice_len);
     int64_t xz_alone_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, size_t x, size_t y);
+    void* xz_alone_stream_begin(size_t level);
+    int64_t xz_alone_stream_code(void *state, char *inbuf, size_t insize, char *outbuf, size_t outsize, int finish);
+    void xz_alone_stream_end(void *state);
+    void* xz_mt_init();
+    int64_t xz_mt_compress(void *state, char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, uint32_t threads, uint64_t block_size);
+    int64_t xz_check_compress(char *inbuf, size_t insize, char *outbuf, size_t outsize, size_t level, int check);
+    int64_t xz_mt_decompress(char *inbuf, size_t insize, char *outbuf, size_t outsize);
+    int64_t xz_first_bytes(char *inbuf, size_t insize, char *outbuf, size_t outsize, int alone);
+    size_t xz_stream_blocks(const char *inbuf, size_t insize, xz_block_t *blocks, size_t max_blocks, int *check);
+    int64_t xz_block_decompress(const char *inbuf, size_t insize, int check, char *outbuf, size_t outsize);
+    void xz_mt_end(void *state);
+    uint32_t xz_crc32(const char *buf, size_t size);
+    uint64_t xz_crc64(const char *buf, size_t size);
 #if defined (__cplusplus) 
 }
 #endif
@@ -14,8 +14,14 @@
 #include "filter_common.h"
 #include "lzma_decoder.h"
 #include "lzma2_decoder.h"
-#include "simple_decoder.h"
-#include "delta_decoder.h"
+// only lzma/ and lz/ are bundled, the headers of the BCJ and delta filters are not
+#if defined(HAVE_DECODER_X86) || defined(HAVE_DECODER_POWERPC) || defined(HAVE_DECODER_IA64) \
+		|| defined(HAVE_DECODER_ARM) || defined(HAVE_DECODER_ARMTHUMB) || defined(HAVE_DECODER_SPARC)
+#	include "simple_decoder.h"
+#endif
+#ifdef HAVE_DECODER_DELTA
+#	include "delta_decoder.h"
+#endif
 
 
 typedef struct {
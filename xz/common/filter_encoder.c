@@ -14,8 +14,14 @@
 #include "filter_common.h"
 #include "lzma_encoder.h"
 #include "lzma2_encoder.h"
-#include "simple_encoder.h"
-#include "delta_encoder.h"
+// only lzma/ and lz/ are bundled, the headers of the BCJ and delta filters are not
+#if defined(HAVE_ENCODER_X86) || defined(HAVE_ENCODER_POWERPC) || defined(HAVE_ENCODER_IA64) \
+		|| defined(HAVE_ENCODER_ARM) || defined(HAVE_ENCODER_ARMTHUMB) || defined(HAVE_ENCODER_SPARC)
+#	include "simple_encoder.h"
+#endif
+#ifdef HAVE_ENCODER_DELTA
+#	include "delta_encoder.h"
+#endif
 
 
 typedef struct {
@@ -154,6 +154,24 @@ ZSTD_WEAK_ATTR void ZSTD_trace_decompress_end(
     ZSTD_TraceCtx ctx,
     ZSTD_Trace const* trace);
 
+/**
+ * Stages of compression reported by ZSTD_trace_compress_stage() (an lzbench
+ * addition): begin starts the match finding of a block and the others end
+ * the stage they name, so the time between two calls belongs to the latter.
+ */
+typedef enum {
+    ZSTD_trace_stage_begin,
+    ZSTD_trace_stage_match,      /* match finding up to the seqStore */
+    ZSTD_trace_stage_literals,   /* Huffman coding of literals */
+    ZSTD_trace_stage_sequences   /* FSE tables and bitstream of sequences */
+} ZSTD_TraceStage;
+
+/**
+ * Trace a stage of the compression of a block, called with tracing enabled
+ * or not, so it should return at once when not tracing.
+ */
+ZSTD_WEAK_ATTR void ZSTD_trace_compress_stage(ZSTD_TraceStage stage);
+
 #endif /* ZSTD_TRACE */
 
 #if defined (__cplusplus)
@@ -2867,6 +2867,12 @@ ZSTD_buildSequencesStatistics(
     return stats;
 }
 
+#if ZSTD_TRACE
+#  define ZSTD_TRACE_STAGE(stage) do { if (ZSTD_trace_compress_stage != NULL) ZSTD_trace_compress_stage(stage); } while (0)
+#else
+#  define ZSTD_TRACE_STAGE(stage) do { } while (0)
+#endif
+
 /* ZSTD_entropyCompressSeqStore_internal():
  * compresses both literals and sequences
  * Returns compressed size of block, or a zstd error.
@@ -2902,6 +2908,7 @@ ZSTD_entropyCompressSeqStore_internal(
     entropyWkspSize -= (MaxSeq + 1) * sizeof(*count);
 
     DEBUGLOG(5, "ZSTD_entropyCompressSeqStore_internal (nbSeq=%zu, dstCapacity=%zu)", nbSeq, dstCapacity);
+    ZSTD_TRACE_STAGE(ZSTD_trace_stage_match);
     ZSTD_STATIC_ASSERT(HUF_WORKSPACE_SIZE >= (1<<MAX(MLFSELog,LLFSELog)));
     assert(entropyWkspSize >= HUF_WORKSPACE_SIZE);
 
@@ -2924,6 +2931,7 @@ ZSTD_entropyCompressSeqStore_internal(
         FORWARD_IF_ERROR(cSize, "ZSTD_compressLiterals failed");
         assert(cSize <= dstCapacity);
         op += cSize;
+        ZSTD_TRACE_STAGE(ZSTD_trace_stage_literals);
     }
 
     /* Sequences Header */
@@ -3007,6 +3015,7 @@ ZSTD_entropyCompressSeqStore(
                             seqStorePtr, prevEntropy, nextEntropy, cctxParams,
                             dst, dstCapacity,
                             entropyWorkspace, entropyWkspSize, bmi2);
+    ZSTD_TRACE_STAGE(ZSTD_trace_stage_sequences);
     if (cSize == 0) return 0;
     /* When srcSize <= dstCapacity, there is enough space to write a raw uncompressed block.
      * Since we ran out of space, block must be not compressible, so fall back to raw uncompressed block.
@@ -3203,6 +3212,7 @@ static size_t ZSTD_buildSeqStore(ZSTD_CCtx* zc, const void* src, size_t srcSize)
 {
     ZSTD_matchState_t* const ms = &zc->blockState.matchState;
     DEBUGLOG(5, "ZSTD_buildSeqStore (srcSize=%zu)", srcSize);
+    ZSTD_TRACE_STAGE(ZSTD_trace_stage_begin);
     assert(srcSize <= ZSTD_BLOCKSIZE_MAX);
     /* Assert that we have correctly flushed the ctx params into the ms's copy */
     ZSTD_assertEqualCParams(zc->appliedParams.cParams, ms->cParams);